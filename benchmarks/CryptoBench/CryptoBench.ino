@@ -0,0 +1,320 @@
+/**
+ * @file CryptoBench.ino
+ * @brief Timing benchmark of the cryptographic primitives used by the wallet.
+ *
+ * Times AES-256 (key setup, single blocks and CBC as done by the secure
+ * channel), SHA-256, SHA-512, HMAC-SHA256, the RNG and the secp256r1
+ * operations of micro-ecc, then prints one CSV line per primitive:
+ *
+ *     BENCH,<board>,<primitive>,<bytes>,<samples>,<min>,<mean>,<max>,<unit>
+ *
+ * On Cortex-M3/M4/M7/M33 the unit is CPU cycles, read from the DWT cycle
+ * counter; on other cores, or when the counter does not run, it is
+ * microseconds from micros(). Needs only the Crypto and micro-ecc libraries.
+ * See benchmarks/README.md.
+ */
+
+#include <Crypto.h>
+#include <AES.h>
+#include <SHA256.h>
+#include <SHA512.h>
+#include <HMACKey.h>
+#include <RNG.h>
+#include <uECC.h>
+
+/** @brief Samples per fast primitive (bounded by RAM, 4 bytes each). */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS        16
+#endif
+
+/** @brief Samples per elliptic curve operation. */
+#ifndef BENCH_ECC_ITERATIONS
+#define BENCH_ECC_ITERATIONS    4
+#endif
+
+#ifdef ARDUINO_BOARD
+#define BENCH_BOARD_NAME        ARDUINO_BOARD
+#else
+#define BENCH_BOARD_NAME        "unknown"
+#endif
+
+#define BENCH_RNG_TAG           "CryptoBench"
+#define BENCH_BUFFER_SIZE       1024U
+#define BENCH_CBC_SIZE          64U     /* typical secure channel APDU payload */
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define BENCH_HAVE_DWT          1
+/* ARMv7-M / ARMv8-M debug registers, not every core exposes CMSIS names */
+#define BENCH_DEMCR             (*(volatile uint32_t*)0xE000EDFCUL)
+#define BENCH_DWT_CTRL          (*(volatile uint32_t*)0xE0001000UL)
+#define BENCH_DWT_CYCCNT        (*(volatile uint32_t*)0xE0001004UL)
+#define BENCH_DEMCR_TRCENA      (1UL << 24)
+#define BENCH_DWT_CYCCNTENA     (1UL << 0)
+#else
+#define BENCH_HAVE_DWT          0
+#endif
+
+/** @brief Operation under test, called `repeat` times per sample. */
+typedef void (*BenchFunction)(void);
+
+static uint32_t samples[BENCH_ITERATIONS];
+static bool useCycles = false;
+
+static uint8_t buffer[BENCH_BUFFER_SIZE];
+static uint8_t key[32];
+static uint8_t block[16];
+static uint8_t digest[64];
+
+static AES256 aes;
+static SHA256 sha256;
+static SHA512 sha512;
+static HMACKey<SHA256> hmacKey;
+
+static const uECC_Curve_t* benchCurve;
+static uint8_t privateKey[32];
+static uint8_t publicKey[64];
+static uint8_t peerPrivateKey[32];
+static uint8_t peerPublicKey[64];
+static uint8_t secret[32];
+static uint8_t signature[64];
+
+/**
+ * @brief Start the DWT cycle counter when the core has one.
+ *
+ * @return true if CYCCNT is running, false to fall back to micros().
+ */
+static bool startCycleCounter() {
+#if BENCH_HAVE_DWT
+    uint32_t before;
+
+    BENCH_DEMCR |= BENCH_DEMCR_TRCENA;
+    BENCH_DWT_CYCCNT = 0UL;
+    BENCH_DWT_CTRL |= BENCH_DWT_CYCCNTENA;
+
+    /* Some parts keep the DWT locked or unimplemented: check it counts */
+    before = BENCH_DWT_CYCCNT;
+    delayMicroseconds(10);
+    return (BENCH_DWT_CYCCNT != before);
+#else
+    return false;
+#endif
+}
+
+static inline uint32_t benchNow() {
+#if BENCH_HAVE_DWT
+    if (useCycles) {
+        return BENCH_DWT_CYCCNT;
+    }
+#endif
+    return micros();
+}
+
+/**
+ * @brief Sample an operation, then print the CSV summary line.
+ *
+ * @param primitive Primitive name.
+ * @param bytes Bytes processed per call, 0 when not meaningful.
+ * @param function Operation under test.
+ * @param count Number of samples, at most BENCH_ITERATIONS.
+ * @param repeat Calls per sample; each sample is the mean of one call.
+ */
+static void bench(const __FlashStringHelper* primitive, uint16_t bytes, BenchFunction function,
+                  uint8_t count, uint8_t repeat) {
+    uint32_t total = 0UL;
+    uint32_t minimum = 0xFFFFFFFFUL;
+    uint32_t maximum = 0UL;
+    uint8_t i;
+    uint8_t r;
+
+    for (i = 0U; i < count; i++) {
+        uint32_t start = benchNow();
+        for (r = 0U; r < repeat; r++) {
+            function();
+        }
+        samples[i] = (benchNow() - start) / repeat;
+    }
+    for (i = 0U; i < count; i++) {
+        total += samples[i];
+        if (samples[i] < minimum) {
+            minimum = samples[i];
+        }
+        if (samples[i] > maximum) {
+            maximum = samples[i];
+        }
+    }
+
+    Serial.print(F("BENCH," BENCH_BOARD_NAME ","));
+    Serial.print(primitive);
+    Serial.print(F(","));
+    Serial.print(bytes);
+    Serial.print(F(","));
+    Serial.print(count);
+    Serial.print(F(","));
+    Serial.print(minimum);
+    Serial.print(F(","));
+    Serial.print(total / count);
+    Serial.print(F(","));
+    Serial.print(maximum);
+    Serial.println(useCycles ? F(",cycles") : F(",us"));
+}
+
+/* Operations under test */
+
+static void aesSetKey() {
+    aes.setKey(key, sizeof(key));
+}
+
+static void aesEncryptBlock() {
+    aes.encryptBlock(block, block);
+}
+
+static void aesDecryptBlock() {
+    aes.decryptBlock(block, block);
+}
+
+/* AES-CBC in place with the IV in `block`, as the secure channel does */
+static void aesCbcEncrypt() {
+    uint16_t offset;
+    uint8_t i;
+
+    for (offset = 0U; offset < BENCH_CBC_SIZE; offset += sizeof(block)) {
+        for (i = 0U; i < sizeof(block); i++) {
+            block[i] ^= buffer[offset + i];
+        }
+        aes.encryptBlock(block, block);
+        memcpy(buffer + offset, block, sizeof(block));
+    }
+}
+
+static void sha256Small() {
+    sha256.reset();
+    sha256.update(buffer, 64U);
+    sha256.finalize(digest, 32U);
+}
+
+static void sha256Large() {
+    sha256.reset();
+    sha256.update(buffer, BENCH_BUFFER_SIZE);
+    sha256.finalize(digest, 32U);
+}
+
+static void sha512Small() {
+    sha512.reset();
+    sha512.update(buffer, 64U);
+    sha512.finalize(digest, 64U);
+}
+
+static void sha512Large() {
+    sha512.reset();
+    sha512.update(buffer, BENCH_BUFFER_SIZE);
+    sha512.finalize(digest, 64U);
+}
+
+static void hmacSha256() {
+    sha256.resetHMAC(key, sizeof(key));
+    sha256.update(buffer, 64U);
+    sha256.finalizeHMAC(key, sizeof(key), digest, 32U);
+}
+
+static void hmacSha256Cached() {
+    hmacKey.mac(digest, 32U, buffer, 64U);
+}
+
+static void rngRand() {
+    RNG.rand(digest, 32U);
+}
+
+static void eccMakeKey() {
+    uECC_make_key(publicKey, privateKey, benchCurve);
+}
+
+static void eccSharedSecret() {
+    uECC_shared_secret(peerPublicKey, privateKey, secret, benchCurve);
+}
+
+static void eccVerify() {
+    uECC_verify(publicKey, digest, 32U, signature, benchCurve);
+}
+
+/**
+ * @brief RNG callback used by micro-ecc, same source as the wallet.
+ */
+static int benchRng(uint8_t* dest, unsigned size) {
+    RNG.rand(dest, size);
+    return 1;
+}
+
+void setup() {
+    uint16_t i;
+
+    Serial.begin(115200);
+    delay(1000);
+
+    useCycles = startCycleCounter();
+    RNG.begin(BENCH_RNG_TAG);
+    uECC_set_rng(&benchRng);
+    benchCurve = uECC_secp256r1();
+
+    /* Fixed, non-zero inputs so every build hashes and encrypts the same data */
+    for (i = 0U; i < BENCH_BUFFER_SIZE; i++) {
+        buffer[i] = (uint8_t)(i * 7U + 1U);
+    }
+    for (i = 0U; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(0xA5U ^ i);
+    }
+    memset(block, 0, sizeof(block));
+
+    Serial.print(F("# F_CPU="));
+#ifdef F_CPU
+    Serial.println((uint32_t)F_CPU);
+#else
+    Serial.println(F("unknown"));
+#endif
+    Serial.println(F("# compiler=" __VERSION__));
+#if defined(__OPTIMIZE_SIZE__)
+    Serial.println(F("# optimization=size"));
+#elif defined(__OPTIMIZE__)
+    Serial.println(F("# optimization=speed"));
+#else
+    Serial.println(F("# optimization=none"));
+#endif
+    Serial.println(F("# BENCH,board,primitive,bytes,samples,min,mean,max,unit"));
+}
+
+void loop() {
+    bench(F("aes256_set_key"), 32U, aesSetKey, BENCH_ITERATIONS, 4U);
+    bench(F("aes256_encrypt_block"), 16U, aesEncryptBlock, BENCH_ITERATIONS, 8U);
+    bench(F("aes256_decrypt_block"), 16U, aesDecryptBlock, BENCH_ITERATIONS, 8U);
+    bench(F("aes256_cbc_encrypt"), BENCH_CBC_SIZE, aesCbcEncrypt, BENCH_ITERATIONS, 2U);
+
+    bench(F("sha256"), 64U, sha256Small, BENCH_ITERATIONS, 4U);
+    bench(F("sha256"), BENCH_BUFFER_SIZE, sha256Large, BENCH_ITERATIONS, 1U);
+    bench(F("sha512"), 64U, sha512Small, BENCH_ITERATIONS, 4U);
+    bench(F("sha512"), BENCH_BUFFER_SIZE, sha512Large, BENCH_ITERATIONS, 1U);
+
+    bench(F("hmac_sha256"), 64U, hmacSha256, BENCH_ITERATIONS, 2U);
+    hmacKey.setKey(key, sizeof(key));
+    bench(F("hmac_sha256_cached_key"), 64U, hmacSha256Cached, BENCH_ITERATIONS, 2U);
+
+    bench(F("rng_rand"), 32U, rngRand, BENCH_ITERATIONS, 2U);
+
+    /* ECC: the peer key and the signature are prepared untimed */
+    bench(F("uecc_make_key"), 0U, eccMakeKey, BENCH_ECC_ITERATIONS, 1U);
+    uECC_make_key(peerPublicKey, peerPrivateKey, benchCurve);
+    bench(F("uecc_shared_secret"), 0U, eccSharedSecret, BENCH_ECC_ITERATIONS, 1U);
+    sha256Small();
+    if (uECC_sign(privateKey, digest, 32U, signature, benchCurve) &&
+        uECC_verify(publicKey, digest, 32U, signature, benchCurve)) {
+        bench(F("uecc_verify"), 32U, eccVerify, BENCH_ECC_ITERATIONS, 1U);
+    }
+    else {
+        Serial.println(F("BENCH," BENCH_BOARD_NAME ",error,uecc_sign"));
+    }
+
+    aes.clear();
+    hmacKey.clear();
+    memset(privateKey, 0, sizeof(privateKey));
+    memset(peerPrivateKey, 0, sizeof(peerPrivateKey));
+    Serial.println(F("# done"));
+    while (1);
+}
@@ -0,0 +1,194 @@
+/**
+ * @file HandshakeBench.ino
+ * @brief Timing benchmark of the Cryptnox wallet handshake on one PN532 bus.
+ *
+ * Runs BENCH_ITERATIONS of SELECT, GET CARD CERTIFICATE, OPEN SECURE CHANNEL
+ * and a full processCard() with a card held on the reader, then prints one
+ * CSV line per operation:
+ *
+ *     BENCH,<bus>,<operation>,<samples>,<min_us>,<mean_us>,<p95_us>,<max_us>
+ *
+ * Select the bus with BENCH_BUS. Build with CRYPTNOX_LOG_LEVEL=0 so the SDK
+ * traces do not end up in the measurements. See benchmarks/README.md.
+ */
+
+#include <Wire.h>
+#include <SPI.h>
+#include "CryptnoxWallet.h"
+
+#define BENCH_BUS_I2C       0
+#define BENCH_BUS_HW_SPI    1
+#define BENCH_BUS_SOFT_SPI  2
+#define BENCH_BUS_UART      3
+
+#ifndef BENCH_BUS
+#define BENCH_BUS           BENCH_BUS_HW_SPI
+#endif
+
+/** @brief Samples per operation (bounded by RAM, 4 bytes each). */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    20
+#endif
+
+/* Wiring, see the README hardware setup */
+#define PN532_IRQ           (2)
+#define PN532_RESET         (3)
+#define PN532_SS            (10)
+#define PN532_SCK           (13)
+#define PN532_MISO          (12)
+#define PN532_MOSI          (11)
+
+#if BENCH_BUS == BENCH_BUS_I2C
+#define BENCH_BUS_NAME      "i2c"
+CryptnoxWallet wallet(PN532_IRQ, PN532_RESET, &Wire);
+#elif BENCH_BUS == BENCH_BUS_HW_SPI
+#define BENCH_BUS_NAME      "hwspi"
+CryptnoxWallet wallet(PN532_SS, &SPI);
+#elif BENCH_BUS == BENCH_BUS_SOFT_SPI
+#define BENCH_BUS_NAME      "softspi"
+CryptnoxWallet wallet(PN532_SCK, PN532_MISO, PN532_MOSI, PN532_SS);
+#elif BENCH_BUS == BENCH_BUS_UART
+#define BENCH_BUS_NAME      "uart"
+CryptnoxWallet wallet(PN532_RESET, &Serial1);
+#else
+#error "Unknown BENCH_BUS"
+#endif
+
+/** @brief P-256 curve used by the handshake. */
+static const uECC_Curve_t* benchCurve;
+
+static uint32_t samples[BENCH_ITERATIONS];
+
+/**
+ * @brief Sort the samples and print the CSV summary line of one operation.
+ *
+ * @param operation Operation name.
+ * @param count Number of valid samples.
+ */
+static void report(const __FlashStringHelper* operation, uint8_t count) {
+    uint32_t total = 0UL;
+    uint8_t i;
+    uint8_t j;
+
+    /* Insertion sort, the sample count is small */
+    for (i = 1U; i < count; i++) {
+        uint32_t value = samples[i];
+        j = i;
+        while ((j > 0U) && (samples[j - 1U] > value)) {
+            samples[j] = samples[j - 1U];
+            j--;
+        }
+        samples[j] = value;
+    }
+    for (i = 0U; i < count; i++) {
+        total += samples[i];
+    }
+
+    Serial.print(F("BENCH," BENCH_BUS_NAME ","));
+    Serial.print(operation);
+    Serial.print(F(","));
+    Serial.print(count);
+    if (count == 0U) {
+        Serial.println(F(",0,0,0,0"));
+    }
+    else {
+        Serial.print(F(","));
+        Serial.print(samples[0]);
+        Serial.print(F(","));
+        Serial.print(total / count);
+        Serial.print(F(","));
+        Serial.print(samples[((uint16_t)count * 95U) / 100U]);
+        Serial.print(F(","));
+        Serial.println(samples[count - 1U]);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+#if BENCH_BUS == BENCH_BUS_I2C
+    Wire.begin();
+#elif BENCH_BUS == BENCH_BUS_HW_SPI
+    SPI.begin();
+#endif
+
+    if (!wallet.begin()) {
+        Serial.println(F("BENCH," BENCH_BUS_NAME ",error,pn532_init"));
+        while (1);
+    }
+    benchCurve = uECC_secp256r1();
+
+    Serial.println(F("# Hold a Cryptnox card on the reader"));
+    Serial.println(F("# BENCH,bus,operation,samples,min_us,mean_us,p95_us,max_us"));
+}
+
+void loop() {
+    uint8_t certificate[CARD_CERTIFICATE_MAX_SIZE + 2U];  /* room for SW1 SW2 */
+    uint8_t certificateLength = 0U;
+    uint8_t salt[32];
+    uint8_t clientPublicKey[64];
+    uint8_t clientPrivateKey[32];
+    uint8_t count;
+    uint8_t i;
+
+    /* Activate the card; also gives the first processCard() sample */
+    if (!wallet.processCard()) {
+        delay(500);
+        return;
+    }
+
+    /* SELECT */
+    count = 0U;
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        uint32_t start = micros();
+        if (wallet.selectApdu()) {
+            samples[count++] = micros() - start;
+        }
+    }
+    report(F("select"), count);
+
+    /* GET CARD CERTIFICATE */
+    count = 0U;
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        uint32_t start = micros();
+        certificateLength = sizeof(certificate);
+        if (wallet.getCardCertificate(certificate, certificateLength)) {
+            samples[count++] = micros() - start;
+        }
+    }
+    report(F("get_card_certificate"), count);
+
+    /* OPEN SECURE CHANNEL, the key pool is not refilled so uECC_make_key() is included */
+    count = 0U;
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        /* The card expects SELECT and GET CARD CERTIFICATE first, untimed */
+        certificateLength = sizeof(certificate);
+        if (!wallet.selectApdu() || !wallet.getCardCertificate(certificate, certificateLength)) {
+            continue;
+        }
+
+        uint32_t start = micros();
+        if (wallet.openSecureChannel(salt, clientPublicKey, clientPrivateKey, benchCurve)) {
+            samples[count++] = micros() - start;
+        }
+    }
+    report(F("open_secure_channel"), count);
+
+    /* Full processCard(): activation, SELECT, certificate, ECDH, MUTUALLY AUTHENTICATE */
+    count = 0U;
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        /* Untimed: otherwise the presence check keeps the session of the held card */
+        wallet.closeSession();
+
+        uint32_t start = micros();
+        if (wallet.processCard()) {
+            samples[count++] = micros() - start;
+        }
+    }
+    report(F("process_card"), count);
+
+    memset(clientPrivateKey, 0, sizeof(clientPrivateKey));
+    Serial.println(F("# done"));
+    while (1);
+}
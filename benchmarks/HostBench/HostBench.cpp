@@ -0,0 +1,128 @@
+/**
+ * @file HostBench.cpp
+ * @brief Host build of the Cryptnox wallet handshake against a replayed PN532.
+ *
+ * Runs processCard() BENCH_ITERATIONS times (or the count given on the
+ * command line) on a CryptnoxReplayLink fed with a capture dumped by
+ * CryptnoxTrace, rewinding the capture before each round, then prints the
+ * same CSV line as HandshakeBench:
+ *
+ *     BENCH,host,process_card,<samples>,<min_us>,<mean_us>,<p95_us>,<max_us>
+ *
+ * Usage: hostbench <capture.pcap> [iterations] [exchange_latency_us|recorded]
+ *
+ * Every round is timed, successful or not: replayed handshakes stop at the
+ * checks tied to the host's own randomness (see CryptnoxReplayLink.h). The
+ * build command is in benchmarks/README.md.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "CryptnoxWallet.h"
+#include "CryptnoxReplayLink.h"
+
+#if PN532_TRANSPORT != PN532_TRANSPORT_MOCK
+#error "Build HostBench with -DPN532_TRANSPORT=PN532_TRANSPORT_MOCK"
+#endif
+
+/** @brief Rounds when the command line does not give a count. */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    100
+#endif
+
+static bool loadFile(const char* path, std::vector<uint8_t> &contents) {
+    bool ret = false;
+    FILE* file = fopen(path, "rb");
+
+    if (file != nullptr) {
+        uint8_t chunk[4096];
+        size_t length;
+
+        while ((length = fread(chunk, 1U, sizeof(chunk), file)) > 0U) {
+            contents.insert(contents.end(), chunk, chunk + length);
+        }
+        ret = (ferror(file) == 0);
+        fclose(file);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Print the CSV summary line of one operation.
+ *
+ * @param operation Operation name.
+ * @param samples Durations in microseconds, sorted in place.
+ */
+static void report(const char* operation, std::vector<uint32_t> &samples) {
+    uint64_t total = 0U;
+    size_t count = samples.size();
+
+    std::sort(samples.begin(), samples.end());
+    for (uint32_t sample : samples) {
+        total += sample;
+    }
+
+    if (count == 0U) {
+        printf("BENCH,host,%s,0,0,0,0,0\n", operation);
+    }
+    else {
+        printf("BENCH,host,%s,%zu,%u,%llu,%u,%u\n", operation, count,
+               (unsigned)samples[0], (unsigned long long)(total / count),
+               (unsigned)samples[(count * 95U) / 100U], (unsigned)samples[count - 1U]);
+    }
+}
+
+int main(int argc, char** argv) {
+    static CryptnoxReplayLink link;
+    static CryptnoxWallet wallet(&link);
+    std::vector<uint8_t> capture;
+    std::vector<uint32_t> samples;
+    unsigned long iterations = BENCH_ITERATIONS;
+    uint16_t succeeded = 0U;
+    unsigned long i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <capture.pcap> [iterations] [exchange_latency_us|recorded]\n", argv[0]);
+        return 2;
+    }
+    if ((loadFile(argv[1], capture) == false) || (link.load(capture.data(), capture.size()) == false)) {
+        fprintf(stderr, "%s: not a CryptnoxTrace capture\n", argv[1]);
+        return 1;
+    }
+    if (argc > 2) {
+        iterations = strtoul(argv[2], nullptr, 10);
+    }
+    if (argc > 3) {
+        link.setLatency(0UL, (strcmp(argv[3], "recorded") == 0) ? CRYPTNOX_REPLAY_RECORDED_LATENCY
+                                                                 : (uint32_t)strtoul(argv[3], nullptr, 10));
+    }
+
+    if (wallet.begin() == false) {
+        fprintf(stderr, "wallet.begin() failed\n");
+        return 1;
+    }
+
+    printf("# BENCH,bus,operation,samples,min_us,mean_us,p95_us,max_us\n");
+    samples.reserve(iterations);
+    for (i = 0U; i < iterations; i++) {
+        uint32_t start;
+
+        link.rewind();
+        wallet.closeSession();
+        start = micros();
+        if (wallet.processCard()) {
+            succeeded++;
+        }
+        samples.push_back(micros() - start);
+    }
+    report("process_card", samples);
+
+    printf("# %u of %lu handshakes succeeded, %u responses replayed per round, %u command mismatches\n",
+           (unsigned)succeeded, iterations, (unsigned)link.replayed(), (unsigned)link.mismatches());
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file ReceiptStoreTest.cpp
+ * @brief Host test of CryptnoxReceiptStore on the Uno R4 EEPROM backend.
+ *
+ * Runs the store on the RAM EEPROM of host/EEPROM.h and checks that losing
+ * the index header, as a power cut in the middle of a format or a bad header
+ * CRC would, never makes the store seal two records under the same nonce,
+ * and what poll() and erase() cost in bytes programmed. Prints one PASS or
+ * FAIL line per check and exits non-zero on failure. The build command is in
+ * benchmarks/README.md.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <EEPROM.h>
+#include <RNG.h>
+#include "CryptnoxReceiptStore.h"
+
+static const uint8_t testKey[CRYPTNOX_RECEIPT_STORE_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F
+};
+
+static const uint8_t testReceipt[] = "receipt 0001, signed";
+
+/** @brief Tag and ciphertext of a record, after its header. */
+#define SEALED_SIZE     (CRYPTNOX_RECEIPT_RECORD_SIZE - CRYPTNOX_RECEIPT_HEADER_SIZE)
+
+static int failures = 0;
+
+static void check(const char* name, bool passed) {
+    printf("%s %s\n", passed ? "PASS" : "FAIL", name);
+    if (passed == false) {
+        ++failures;
+    }
+}
+
+/** @brief EEPROM bytes of a record slot, 0 for the index header. */
+static uint8_t* slotBytes(uint32_t slot) {
+    return EEPROM.bytes + CRYPTNOX_RECEIPT_STORE_OFFSET + (slot * CRYPTNOX_RECEIPT_RECORD_SIZE);
+}
+
+/** @brief Ciphertext and tag of a record slot. */
+static void copySealed(uint32_t slot, uint8_t* sealed) {
+    memcpy(sealed, slotBytes(slot) + CRYPTNOX_RECEIPT_HEADER_SIZE, SEALED_SIZE);
+}
+
+/** @brief Append the test receipt and program it. */
+static bool store(CryptnoxReceiptStore &receipts) {
+    return receipts.append(testReceipt, sizeof(testReceipt)) && receipts.flush();
+}
+
+/** @brief Read record 0 back and compare it with the test receipt. */
+static bool readsBack(CryptnoxReceiptStore &receipts, uint32_t expectedSequence) {
+    uint8_t data[CRYPTNOX_RECEIPT_PAYLOAD_SIZE];
+    uint16_t length = 0U;
+    uint32_t sequence = 0UL;
+
+    return receipts.read(0UL, data, &length, &sequence) &&
+           (length == sizeof(testReceipt)) &&
+           (memcmp(data, testReceipt, length) == 0) &&
+           (sequence == expectedSequence);
+}
+
+int main() {
+    uint8_t first[SEALED_SIZE];
+    uint8_t again[SEALED_SIZE];
+    unsigned long programmed;
+
+    RNG.begin("ReceiptStoreTest");
+
+    {
+        CryptnoxReceiptStore receipts;
+        check("begin formats a blank region", receipts.begin(testKey) && (receipts.count() == 0UL));
+        check("first record stored", store(receipts) && (receipts.count() == 1UL));
+        check("first record reads back", readsBack(receipts, 0UL));
+        copySealed(1UL, first);
+    }
+
+    /* Power cut between the erase and the header program of a format */
+    memset(slotBytes(0UL), 0xFF, CRYPTNOX_RECEIPT_RECORD_SIZE);
+    {
+        CryptnoxReceiptStore receipts;
+        check("begin after header loss", receipts.begin(testKey));
+        check("old records are not counted", receipts.count() == 0UL);
+        check("same sequence stored again", store(receipts) && readsBack(receipts, 0UL));
+        copySealed(1UL, again);
+        check("new salt gives a new nonce after header loss",
+              memcmp(first, again, SEALED_SIZE) != 0);
+    }
+
+    /* Header with a bad CRC */
+    slotBytes(0UL)[6] ^= 0x01U;
+    memcpy(first, again, sizeof(first));
+    {
+        CryptnoxReceiptStore receipts;
+        check("begin after header CRC error", receipts.begin(testKey) && (receipts.count() == 0UL));
+        check("same sequence stored again", store(receipts) && readsBack(receipts, 0UL));
+        copySealed(1UL, again);
+        check("new salt gives a new nonce after CRC error",
+              memcmp(first, again, SEALED_SIZE) != 0);
+
+        programmed = EEPROM.programmed;
+        check("second record stored", store(receipts) && (receipts.count() == 2UL));
+        check("poll programs at most one record",
+              (EEPROM.programmed - programmed) <= CRYPTNOX_RECEIPT_RECORD_SIZE);
+
+        programmed = EEPROM.programmed;
+        check("erase", receipts.erase() && (receipts.count() == 0UL));
+        check("erase programs only the header", (EEPROM.programmed - programmed) <= 24UL);
+        check("sequence carries on after erase", store(receipts) && readsBack(receipts, 2UL));
+    }
+
+    {
+        CryptnoxReceiptStore receipts;
+        check("reopen finds the log", receipts.begin(testKey) && (receipts.count() == 1UL));
+        check("reopened record reads back", readsBack(receipts, 2UL));
+    }
+
+    printf("%s\n", (failures == 0) ? "All tests passed" : "Some tests failed");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+#include "SPI.h"
+#include "Wire.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+unsigned long millis(void) {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros(void) {
+    /* Wraps at 32 bits like on the boards */
+    return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void) {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
+
+/* Idle level of the PN532 IRQ line */
+int digitalRead(uint8_t pin) {
+    (void)pin;
+    return HIGH;
+}
+
+int analogRead(uint8_t pin) {
+    (void)pin;
+    return 0;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+    (void)interrupt;
+    (void)handler;
+    (void)mode;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    (void)interrupt;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t ret = 0U;
+
+    while (ret < size) {
+        if (write(buffer[ret]) == 0U) {
+            break;
+        }
+        ret++;
+    }
+
+    return ret;
+}
+
+size_t Print::write(const char* text) {
+    return (text == nullptr) ? 0U : write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+    return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const char* text) {
+    return write(text);
+}
+
+size_t Print::print(char value) {
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(long value, int base) {
+    size_t ret = 0U;
+
+    if ((value < 0) && (base == DEC)) {
+        ret = write((uint8_t)'-');
+        ret += printNumber((unsigned long)-value, base);
+    }
+    else {
+        ret = printNumber((unsigned long)value, base);
+    }
+
+    return ret;
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[32];
+
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::println(void) {
+    return write((const uint8_t*)"\r\n", 2U);
+}
+
+size_t Print::printNumber(unsigned long value, int base) {
+    char text[8U * sizeof(unsigned long) + 1U];
+    char* digit = &text[sizeof(text) - 1U];
+
+    if (base < 2) {
+        base = DEC;
+    }
+    *digit = '\0';
+    do {
+        unsigned long rest = value % (unsigned long)base;
+        value /= (unsigned long)base;
+        *--digit = (char)((rest < 10U) ? ('0' + rest) : ('A' + rest - 10U));
+    } while (value != 0U);
+
+    return write(digit);
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    return (fputc(value, stdout) == EOF) ? 0U : 1U;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1U, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
@@ -0,0 +1,145 @@
+#ifndef HOSTBENCH_ARDUINO_H
+#define HOSTBENCH_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief Smallest Arduino core the SDK needs to run on a PC (HostBench).
+ *
+ * Time comes from the host monotonic clock, Serial writes to stdout and the
+ * pins do nothing: the only PN532 reachable from a host build is a mock
+ * link (PN532_TRANSPORT_MOCK).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define pgm_read_byte(p)        (*(const uint8_t*)(p))
+#define pgm_read_word(p)        (*(const uint16_t*)(p))
+#define pgm_read_dword(p)       (*(const uint32_t*)(p))
+#define memcpy_P                memcpy
+#define strlen_P                strlen
+
+#define interrupts()
+#define noInterrupts()
+#define digitalPinToInterrupt(pin)   (pin)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+typedef enum {
+    LSBFIRST = 0,
+    MSBFIRST = 1
+} BitOrder;
+
+/** @brief Flash strings are plain strings on the host. */
+class __FlashStringHelper;
+#define F(s)                    (reinterpret_cast<const __FlashStringHelper*>(s))
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+/**
+ * @class Print
+ * @brief Text and binary output, as in the Arduino core.
+ */
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text);
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper* text);
+    size_t print(const char* text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(void);
+    template <typename T>
+    size_t println(T value) {
+        size_t ret = print(value);
+        return ret + println();
+    }
+    template <typename T>
+    size_t println(T value, int format) {
+        size_t ret = print(value, format);
+        return ret + println();
+    }
+
+private:
+    size_t printNumber(unsigned long value, int base);
+};
+
+/**
+ * @class Stream
+ * @brief Print with input, as in the Arduino core.
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+/**
+ * @class HardwareSerial
+ * @brief UART of the board: stdout on the host, nothing to read.
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#ifdef __cplusplus
+template <typename T, typename U>
+static inline auto min(T a, U b) -> decltype(a < b ? a : b) { return (a < b) ? a : b; }
+template <typename T, typename U>
+static inline auto max(T a, U b) -> decltype(a > b ? a : b) { return (a > b) ? a : b; }
+#endif
+
+#endif // HOSTBENCH_ARDUINO_H
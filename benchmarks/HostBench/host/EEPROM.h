@@ -0,0 +1,63 @@
+#ifndef HOSTBENCH_EEPROM_H
+#define HOSTBENCH_EEPROM_H
+
+/**
+ * @file EEPROM.h
+ * @brief Uno R4 EEPROM library held in RAM, for the host tests.
+ *
+ * Same 8 KB size and byte-wise update() as the core's emulation of the data
+ * flash. It starts erased, and counts the bytes it actually rewrites so that
+ * a test can check what an operation costs in flash programs.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class EEPROMClass {
+public:
+    EEPROMClass() : programmed(0UL) {
+        memset(bytes, 0xFF, sizeof(bytes));
+    }
+
+    uint8_t read(int idx) const {
+        return bytes[idx];
+    }
+
+    void write(int idx, uint8_t val) {
+        bytes[idx] = val;
+        ++programmed;
+    }
+
+    void update(int idx, uint8_t val) {
+        if (bytes[idx] != val) {
+            write(idx, val);
+        }
+    }
+
+    template <typename T>
+    T &get(int idx, T &t) const {
+        memcpy(&t, bytes + idx, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int idx, const T &t) {
+        const uint8_t* ptr = (const uint8_t*)&t;
+        for (size_t posn = 0U; posn < sizeof(T); ++posn) {
+            update(idx + (int)posn, ptr[posn]);
+        }
+        return t;
+    }
+
+    uint16_t length() const {
+        return (uint16_t)sizeof(bytes);
+    }
+
+    uint8_t bytes[8192];            /**< Contents, open to the tests */
+    unsigned long programmed;       /**< Bytes rewritten since start */
+};
+
+inline EEPROMClass EEPROM;
+
+#endif // HOSTBENCH_EEPROM_H
@@ -0,0 +1,39 @@
+#ifndef HOSTBENCH_SPI_H
+#define HOSTBENCH_SPI_H
+
+/**
+ * @file SPI.h
+ * @brief SPI bus of the host shim: links, never talks to a device.
+ */
+
+#include "Arduino.h"
+
+#define SPI_MODE0       0x00
+#define SPI_MODE1       0x01
+#define SPI_MODE2       0x02
+#define SPI_MODE3       0x03
+
+class SPISettings {
+public:
+    SPISettings() : clock(1000000UL), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+    SPISettings(uint32_t clock, BitOrder bitOrder, uint8_t dataMode)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+    uint32_t clock;
+    BitOrder bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings settings) { (void)settings; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t value) { (void)value; return 0xFFU; }
+    void transfer(void* buffer, size_t size) { memset(buffer, 0xFF, size); }
+};
+
+extern SPIClass SPI;
+
+#endif // HOSTBENCH_SPI_H
@@ -0,0 +1,35 @@
+#ifndef HOSTBENCH_WIRE_H
+#define HOSTBENCH_WIRE_H
+
+/**
+ * @file Wire.h
+ * @brief I2C bus of the host shim: links, every address NACKs.
+ */
+
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH   32
+
+class TwoWire : public Stream {
+public:
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t clock) { (void)clock; }
+    void beginTransmission(uint8_t address) { (void)address; }
+    uint8_t endTransmission(bool stop = true) { (void)stop; return 2U; }
+    size_t requestFrom(uint8_t address, size_t quantity, bool stop = true) {
+        (void)address;
+        (void)quantity;
+        (void)stop;
+        return 0U;
+    }
+    size_t write(uint8_t value) override { (void)value; return 1U; }
+    size_t write(const uint8_t* buffer, size_t size) override { (void)buffer; return size; }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif // HOSTBENCH_WIRE_H
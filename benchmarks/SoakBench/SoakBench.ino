@@ -0,0 +1,391 @@
+/**
+ * @file SoakBench.ino
+ * @brief Long-running throughput and reliability test of full Cryptnox sessions.
+ *
+ * With a card held on the reader, loops complete sessions for hours:
+ * processCard() (detection, SELECT, certificate, secure channel), then
+ * SOAK_COMMANDS secure-messaging commands through runBatch(), then
+ * closeSession() so that the next round runs the whole handshake again.
+ * Every SOAK_REPORT_INTERVAL_MS it prints two CSV lines, one for the last
+ * interval and one since the start:
+ *
+ *     SOAK,<scope>,<uptime_s>,<sessions>,<failures>,<no_card>,<sessions_per_min>,
+ *          <failure_permille>,<min_us>,<mean_us>,<p50_us>,<p95_us>,<p99_us>,<max_us>,
+ *          <heap_peak>,<stack_peak>,<scratch_peak>
+ *
+ * Latencies cover the successful sessions, from processCard() to the last
+ * command. The interval percentiles are exact over its first SOAK_SAMPLES;
+ * the run percentiles are CryptnoxHistogram bucket bounds (within a factor
+ * of two). A round without a card counts as no_card, not as a failure. The
+ * memory columns are high-water marks in bytes since power-up, 0 where the
+ * platform gives no measure. Select the bus with BENCH_BUS as for
+ * HandshakeBench. See benchmarks/README.md.
+ */
+
+#include <Wire.h>
+#include <SPI.h>
+#include <stdlib.h>
+#include "CryptnoxWallet.h"
+#include "CryptnoxHistogram.h"
+
+#if defined(__arm__) && defined(__NEWLIB__)
+#include <malloc.h>
+#endif
+
+#define BENCH_BUS_I2C       0
+#define BENCH_BUS_HW_SPI    1
+#define BENCH_BUS_SOFT_SPI  2
+#define BENCH_BUS_UART      3
+
+#ifndef BENCH_BUS
+#define BENCH_BUS           BENCH_BUS_HW_SPI
+#endif
+
+/** @brief Secure-messaging commands sent after each handshake (at most CRYPTNOX_BATCH_MAX_COMMANDS). */
+#ifndef SOAK_COMMANDS
+#define SOAK_COMMANDS       3
+#endif
+
+/** @brief Instruction of the secure-messaging command, GET CARD INFO by default. */
+#ifndef SOAK_COMMAND_INS
+#define SOAK_COMMAND_INS    0xFA
+#endif
+
+/** @brief Time between two summaries. */
+#ifndef SOAK_REPORT_INTERVAL_MS
+#define SOAK_REPORT_INTERVAL_MS    60000UL
+#endif
+
+/** @brief Stop after this many minutes, 0 to run until reset. */
+#ifndef SOAK_DURATION_MIN
+#define SOAK_DURATION_MIN   0UL
+#endif
+
+/** @brief Sessions per interval kept for exact percentiles (4 bytes each). */
+#ifndef SOAK_SAMPLES
+#if defined(__AVR__)
+#define SOAK_SAMPLES        32
+#else
+#define SOAK_SAMPLES        256
+#endif
+#endif
+
+/**
+ * @brief Stack bytes painted below setup() to measure the stack high-water.
+ *
+ * Must be smaller than the free stack below setup(), 0 to disable. On AVR
+ * the painted area is also kept clear of the heap.
+ */
+#ifndef SOAK_STACK_PAINT_SIZE
+#if defined(__AVR__)
+#define SOAK_STACK_PAINT_SIZE      768
+#else
+#define SOAK_STACK_PAINT_SIZE      2048
+#endif
+#endif
+
+/** @brief Bytes left untouched between the painting frame and the painted area. */
+#define SOAK_STACK_PAINT_MARGIN    64U
+#define SOAK_STACK_PAINT_PATTERN   0xA5U
+
+/* Wiring, see the README hardware setup */
+#define PN532_IRQ           (2)
+#define PN532_RESET         (3)
+#define PN532_SS            (10)
+#define PN532_SCK           (13)
+#define PN532_MISO          (12)
+#define PN532_MOSI          (11)
+
+#if BENCH_BUS == BENCH_BUS_I2C
+CryptnoxWallet wallet(PN532_IRQ, PN532_RESET, &Wire);
+#elif BENCH_BUS == BENCH_BUS_HW_SPI
+CryptnoxWallet wallet(PN532_SS, &SPI);
+#elif BENCH_BUS == BENCH_BUS_SOFT_SPI
+CryptnoxWallet wallet(PN532_SCK, PN532_MISO, PN532_MOSI, PN532_SS);
+#elif BENCH_BUS == BENCH_BUS_UART
+CryptnoxWallet wallet(PN532_RESET, &Serial1);
+#else
+#error "Unknown BENCH_BUS"
+#endif
+
+#if (SOAK_COMMANDS < 1) || (SOAK_COMMANDS > CRYPTNOX_BATCH_MAX_COMMANDS)
+#error "SOAK_COMMANDS must be between 1 and CRYPTNOX_BATCH_MAX_COMMANDS"
+#endif
+
+/**
+ * @struct SoakCounters
+ * @brief Session outcomes and latencies over one scope (interval or run).
+ */
+struct SoakCounters {
+    uint32_t sessions;      /**< Rounds with a card, successful or not */
+    uint32_t failures;      /**< Failed handshakes or commands */
+    uint32_t noCard;        /**< Rounds without a card */
+    uint32_t min;           /**< Shortest successful session */
+    uint32_t max;           /**< Longest successful session */
+    uint64_t total;         /**< Sum of the successful sessions */
+    uint32_t start;         /**< millis() at the start of the scope */
+};
+
+static CryptnoxCommandBatch batch;
+static uint8_t commandResponse[128];
+
+static SoakCounters interval;
+static SoakCounters run;
+static CryptnoxHistogram runHistogram;
+static uint32_t samples[SOAK_SAMPLES];
+static uint16_t sampleCount;
+
+static uint32_t lastReport;
+static size_t heapPeak;
+static uint8_t* stackPaintStart;
+static size_t stackPaintSize;
+
+#if defined(__AVR__)
+extern char __heap_start;
+extern char* __brkval;
+#endif
+
+/**
+ * @brief Top of the heap on AVR, heap in use elsewhere with newlib, 0 otherwise.
+ */
+static size_t heapLevel() {
+    size_t ret = 0U;
+
+#if defined(__AVR__)
+    ret = (size_t)((__brkval == nullptr) ? &__heap_start : __brkval) - (size_t)&__heap_start;
+#elif defined(__arm__) && defined(__NEWLIB__)
+    ret = (size_t)mallinfo().uordblks;
+#endif
+
+    return ret;
+}
+
+/**
+ * @brief Fill the free stack below the caller with a pattern.
+ *
+ * Kept out of line so that its frame is the lowest one in use while painting.
+ */
+static void __attribute__((noinline)) paintStack() {
+    uint8_t* top = (uint8_t*)__builtin_frame_address(0);
+    size_t size = SOAK_STACK_PAINT_SIZE;
+
+    if (size > 0U) {
+        top -= SOAK_STACK_PAINT_MARGIN;
+#if defined(__AVR__)
+        {
+            uint8_t* heapTop = (uint8_t*)((__brkval == nullptr) ? &__heap_start : __brkval) + SOAK_STACK_PAINT_MARGIN;
+            if (top < (heapTop + size)) {
+                size = (top > heapTop) ? (size_t)(top - heapTop) : 0U;
+            }
+        }
+#endif
+        stackPaintStart = top - size;
+        stackPaintSize = size;
+        memset(stackPaintStart, SOAK_STACK_PAINT_PATTERN, size);
+    }
+}
+
+/**
+ * @brief Painted stack bytes overwritten since paintStack(), the deepest first.
+ *
+ * Equal to the painted size when the stack went past the painted area.
+ */
+static size_t stackPeak() {
+    size_t intact = 0U;
+
+    while ((intact < stackPaintSize) && (stackPaintStart[intact] == SOAK_STACK_PAINT_PATTERN)) {
+        intact++;
+    }
+
+    return stackPaintSize - intact;
+}
+
+static void resetCounters(SoakCounters &counters, uint32_t now) {
+    memset(&counters, 0, sizeof(counters));
+    counters.min = 0xFFFFFFFFUL;
+    counters.start = now;
+}
+
+/**
+ * @brief One percentile of the interval samples, once sortSamples() has run.
+ *
+ * @param percent Percentile, 0 to 100.
+ * @return Sample at that rank, 0 if there is none.
+ */
+static uint32_t samplePercentile(uint8_t percent) {
+    uint32_t ret = 0U;
+
+    if (sampleCount > 0U) {
+        uint16_t rank = (uint16_t)(((uint32_t)sampleCount * percent) / 100U);
+        ret = samples[(rank < sampleCount) ? rank : (sampleCount - 1U)];
+    }
+
+    return ret;
+}
+
+static void sortSamples() {
+    uint16_t i;
+    uint16_t j;
+
+    /* Insertion sort, once per interval */
+    for (i = 1U; i < sampleCount; i++) {
+        uint32_t value = samples[i];
+        j = i;
+        while ((j > 0U) && (samples[j - 1U] > value)) {
+            samples[j] = samples[j - 1U];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+/**
+ * @brief Print the CSV summary line of one scope.
+ *
+ * @param scope "interval" or "run".
+ * @param counters Counters of the scope.
+ * @param now millis() of the report.
+ * @param p50 Median session, in microseconds.
+ * @param p95 95th percentile.
+ * @param p99 99th percentile.
+ */
+static void report(const __FlashStringHelper* scope, const SoakCounters &counters, uint32_t now,
+                   uint32_t p50, uint32_t p95, uint32_t p99) {
+    uint32_t elapsed = now - counters.start;
+    uint32_t succeeded = counters.sessions - counters.failures;
+
+    Serial.print(F("SOAK,"));
+    Serial.print(scope);
+    Serial.print(F(","));
+    Serial.print(now / 1000UL);
+    Serial.print(F(","));
+    Serial.print(counters.sessions);
+    Serial.print(F(","));
+    Serial.print(counters.failures);
+    Serial.print(F(","));
+    Serial.print(counters.noCard);
+    Serial.print(F(","));
+    Serial.print((elapsed == 0UL) ? 0.0 : ((double)counters.sessions * 60000.0) / (double)elapsed, 2);
+    Serial.print(F(","));
+    Serial.print((counters.sessions == 0UL) ? 0UL : (uint32_t)(((uint64_t)counters.failures * 1000U) / counters.sessions));
+    Serial.print(F(","));
+    Serial.print((succeeded == 0UL) ? 0UL : counters.min);
+    Serial.print(F(","));
+    Serial.print((succeeded == 0UL) ? 0UL : (uint32_t)(counters.total / succeeded));
+    Serial.print(F(","));
+    Serial.print(p50);
+    Serial.print(F(","));
+    Serial.print(p95);
+    Serial.print(F(","));
+    Serial.print(p99);
+    Serial.print(F(","));
+    Serial.print((succeeded == 0UL) ? 0UL : counters.max);
+    Serial.print(F(","));
+    Serial.print((unsigned long)heapPeak);
+    Serial.print(F(","));
+    Serial.print((unsigned long)stackPeak());
+    Serial.print(F(","));
+    Serial.println((unsigned long)wallet.getScratchPeak());
+}
+
+static void count(SoakCounters &counters, bool ok, uint32_t duration) {
+    counters.sessions++;
+    if (ok == false) {
+        counters.failures++;
+    }
+    else {
+        counters.total += duration;
+        if (duration < counters.min) {
+            counters.min = duration;
+        }
+        if (duration > counters.max) {
+            counters.max = duration;
+        }
+    }
+}
+
+void setup() {
+    uint8_t i;
+
+    Serial.begin(115200);
+    delay(1000);
+    paintStack();
+
+#if BENCH_BUS == BENCH_BUS_I2C
+    Wire.begin();
+#elif BENCH_BUS == BENCH_BUS_HW_SPI
+    SPI.begin();
+#endif
+
+    if (!wallet.begin()) {
+        Serial.println(F("SOAK,error,pn532_init"));
+        while (1);
+    }
+
+    for (i = 0U; i < SOAK_COMMANDS; i++) {
+        (void)batch.add(0x80U, SOAK_COMMAND_INS, 0x00U, 0x00U, nullptr, 0U,
+                        commandResponse, sizeof(commandResponse));
+    }
+
+    lastReport = millis();
+    resetCounters(interval, lastReport);
+    resetCounters(run, lastReport);
+
+    Serial.println(F("# Hold a Cryptnox card on the reader"));
+    Serial.print(F("# commands per session "));
+    Serial.print(SOAK_COMMANDS);
+    Serial.print(F(", stack painted "));
+    Serial.println((unsigned long)stackPaintSize);
+    Serial.println(F("# SOAK,scope,uptime_s,sessions,failures,no_card,sessions_per_min,failure_permille,"
+                     "min_us,mean_us,p50_us,p95_us,p99_us,max_us,heap_peak,stack_peak,scratch_peak"));
+}
+
+void loop() {
+    uint32_t start = micros();
+    uint32_t now;
+    bool ok = wallet.processCard();
+
+    if ((ok == false) && (wallet.getLastError() == CRYPTNOX_ERROR_NO_CARD)) {
+        interval.noCard++;
+        run.noCard++;
+        wallet.idle();
+    }
+    else {
+        uint32_t duration;
+
+        if (ok == true) {
+            ok = wallet.runBatch(batch);
+        }
+        duration = micros() - start;
+        wallet.closeSession();
+
+        count(interval, ok, duration);
+        count(run, ok, duration);
+        if (ok == true) {
+            runHistogram.record(duration);
+            if (sampleCount < SOAK_SAMPLES) {
+                samples[sampleCount++] = duration;
+            }
+        }
+    }
+
+    if (heapLevel() > heapPeak) {
+        heapPeak = heapLevel();
+    }
+
+    now = millis();
+    if ((now - lastReport) >= SOAK_REPORT_INTERVAL_MS) {
+        lastReport = now;
+        sortSamples();
+        report(F("interval"), interval, now, samplePercentile(50U), samplePercentile(95U), samplePercentile(99U));
+        report(F("run"), run, now, runHistogram.percentileBound(50U),
+               runHistogram.percentileBound(95U), runHistogram.percentileBound(99U));
+        resetCounters(interval, now);
+        sampleCount = 0U;
+
+        if ((SOAK_DURATION_MIN > 0UL) && ((now - run.start) >= (SOAK_DURATION_MIN * 60000UL))) {
+            Serial.println(F("# done"));
+            while (1);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include <Arduino.h>
+#include "CardCertificateView.h"
+
+#define DER_SEQUENCE_TAG                0x30U
+#define DER_HEADER_SIZE                 2U
+#define UNCOMPRESSED_KEY_PREFIX         0x04U
+#define DER_INTEGER_TAG                 0x02U
+#define RAW_COMPONENT_SIZE              32U
+
+CardCertificateView::CardCertificateView()
+    : base(nullptr), sigLength(0U) {
+}
+
+/**
+ * @brief Validate a certificate and point the view at it.
+ *
+ * @param data Certificate bytes (response without SW1 SW2).
+ * @param length Certificate length in bytes.
+ * @return true if the layout is valid, false otherwise.
+ */
+bool CardCertificateView::parse(const uint8_t* data, size_t length) {
+    bool ret = false;
+
+    base = nullptr;
+    sigLength = 0U;
+
+    if ((data != nullptr) && (length >= (CARD_CERTIFICATE_SIGNATURE_OFFSET + DER_HEADER_SIZE)) &&
+        (data[CARD_CERTIFICATE_FORMAT_OFFSET] == CARD_CERTIFICATE_FORMAT) &&
+        (data[CARD_CERTIFICATE_KEY_OFFSET] == UNCOMPRESSED_KEY_PREFIX) &&
+        (data[CARD_CERTIFICATE_SIGNATURE_OFFSET] == DER_SEQUENCE_TAG)) {
+        /* Short-form DER length, always the case for P-256 signatures */
+        size_t derLength = DER_HEADER_SIZE + (size_t)data[CARD_CERTIFICATE_SIGNATURE_OFFSET + 1U];
+
+        if ((derLength <= CARD_CERTIFICATE_SIGNATURE_MAX_SIZE) &&
+            (derLength <= (length - CARD_CERTIFICATE_SIGNATURE_OFFSET))) {
+            base = data;
+            sigLength = derLength;
+            ret = true;
+        }
+    }
+
+    return ret;
+}
+
+bool CardCertificateView::isValid() const {
+    return (base != nullptr);
+}
+
+const uint8_t* CardCertificateView::nonce() const {
+    return (base != nullptr) ? (base + CARD_CERTIFICATE_NONCE_OFFSET) : nullptr;
+}
+
+const uint8_t* CardCertificateView::sessionPublicKey() const {
+    return (base != nullptr) ? (base + CARD_CERTIFICATE_KEY_OFFSET) : nullptr;
+}
+
+const uint8_t* CardCertificateView::sessionPublicKeyXY() const {
+    return (base != nullptr) ? (base + CARD_CERTIFICATE_KEY_OFFSET + 1U) : nullptr;
+}
+
+const uint8_t* CardCertificateView::signedData() const {
+    return base;
+}
+
+size_t CardCertificateView::signedDataLength() const {
+    return (base != nullptr) ? CARD_CERTIFICATE_SIGNATURE_OFFSET : 0U;
+}
+
+const uint8_t* CardCertificateView::signature() const {
+    return (base != nullptr) ? (base + CARD_CERTIFICATE_SIGNATURE_OFFSET) : nullptr;
+}
+
+size_t CardCertificateView::signatureLength() const {
+    return sigLength;
+}
+
+/**
+ * @brief Decode the DER signature SEQUENCE { INTEGER r, INTEGER s } into r||s.
+ *
+ * @param[out] rs Buffer of CARD_CERTIFICATE_RAW_SIGNATURE_SIZE bytes.
+ * @return true if the signature was decoded, false otherwise.
+ */
+bool CardCertificateView::rawSignature(uint8_t* rs) const {
+    bool ret = (base != nullptr) && (rs != nullptr);
+    const uint8_t* der = signature();
+    size_t offset = DER_HEADER_SIZE;
+    uint8_t component;
+
+    for (component = 0U; (ret == true) && (component < 2U); component++) {
+        uint8_t* out = rs + ((size_t)component * RAW_COMPONENT_SIZE);
+        size_t length;
+
+        if (((offset + DER_HEADER_SIZE) > sigLength) || (der[offset] != DER_INTEGER_TAG)) {
+            ret = false;
+        }
+        else {
+            length = der[offset + 1U];
+            offset += DER_HEADER_SIZE;
+
+            /* Drop the sign padding byte of positive integers */
+            while ((length > 0U) && (der[offset] == 0x00U) && ((offset + length) <= sigLength)) {
+                offset++;
+                length--;
+            }
+
+            if ((length > RAW_COMPONENT_SIZE) || ((offset + length) > sigLength)) {
+                ret = false;
+            }
+            else {
+                memset(out, 0, RAW_COMPONENT_SIZE - length);
+                memcpy(out + (RAW_COMPONENT_SIZE - length), der + offset, length);
+                offset += length;
+            }
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,86 @@
+#ifndef CARDCERTIFICATEVIEW_H
+#define CARDCERTIFICATEVIEW_H
+
+#include <Arduino.h>
+
+/* GET CARD CERTIFICATE response layout */
+#define CARD_CERTIFICATE_FORMAT               0x43U   /* 'C' */
+#define CARD_CERTIFICATE_FORMAT_OFFSET        0U
+#define CARD_CERTIFICATE_NONCE_OFFSET         1U
+#define CARD_CERTIFICATE_NONCE_SIZE           8U
+#define CARD_CERTIFICATE_KEY_OFFSET           (CARD_CERTIFICATE_NONCE_OFFSET + CARD_CERTIFICATE_NONCE_SIZE)
+#define CARD_CERTIFICATE_KEY_SIZE             65U     /* 0x04 || X || Y */
+#define CARD_CERTIFICATE_SIGNATURE_OFFSET     (CARD_CERTIFICATE_KEY_OFFSET + CARD_CERTIFICATE_KEY_SIZE)
+#define CARD_CERTIFICATE_SIGNATURE_MAX_SIZE   72U     /* DER ECDSA P-256 */
+#define CARD_CERTIFICATE_RAW_SIGNATURE_SIZE 64U     /* r || s */
+#define CARD_CERTIFICATE_MAX_SIZE             (CARD_CERTIFICATE_SIGNATURE_OFFSET + CARD_CERTIFICATE_SIGNATURE_MAX_SIZE)
+
+/**
+ * @class CardCertificateView
+ * @brief Bounds-checked, read-only view of a GET CARD CERTIFICATE response.
+ *
+ * | Field               | Size          | Offset |
+ * |---------------------|---------------|--------|
+ * | 'C'                 | 1 byte        | 0      |
+ * | Nonce               | 8 bytes       | 1–8    |
+ * | Session public key  | 65 bytes      | 9–73   |
+ * | ASN.1 DER signature | 70–72 bytes   | 74+    |
+ *
+ * The view only stores a pointer to the response buffer: no field is copied,
+ * and the buffer must stay valid and unchanged while the view is used.
+ */
+class CardCertificateView {
+public:
+    /** @brief Construct an empty (invalid) view. */
+    CardCertificateView();
+
+    /**
+     * @brief Validate a certificate and point the view at it.
+     *
+     * Checks the format byte, the uncompressed key prefix and that the DER
+     * signature SEQUENCE fits in the given length.
+     *
+     * @param data Certificate bytes (response without SW1 SW2).
+     * @param length Certificate length in bytes.
+     * @return true if the layout is valid, false otherwise (the view is then empty).
+     */
+    bool parse(const uint8_t* data, size_t length);
+
+    /** @brief true once parse() accepted a certificate. */
+    bool isValid() const;
+
+    /** @brief 8-byte nonce echoed by the card. */
+    const uint8_t* nonce() const;
+
+    /** @brief 65-byte session public key including the 0x04 prefix. */
+    const uint8_t* sessionPublicKey() const;
+
+    /** @brief 64-byte session public key X||Y, as expected by uECC_shared_secret(). */
+    const uint8_t* sessionPublicKeyXY() const;
+
+    /** @brief Bytes covered by the card signature ('C' || nonce || session key). */
+    const uint8_t* signedData() const;
+
+    /** @brief Length of signedData() in bytes. */
+    size_t signedDataLength() const;
+
+    /** @brief DER encoded ECDSA signature. */
+    const uint8_t* signature() const;
+
+    /** @brief Length of signature() in bytes. */
+    size_t signatureLength() const;
+
+    /**
+     * @brief Decode the DER signature into the raw r||s form used by uECC_verify().
+     *
+     * @param[out] rs Buffer of CARD_CERTIFICATE_RAW_SIGNATURE_SIZE bytes.
+     * @return true if both INTEGERs were well-formed and fit in 32 bytes, false otherwise.
+     */
+    bool rawSignature(uint8_t* rs) const;
+
+private:
+    const uint8_t* base;        /**< Start of the certificate, nullptr when invalid */
+    size_t sigLength;           /**< DER signature length */
+};
+
+#endif // CARDCERTIFICATEVIEW_H
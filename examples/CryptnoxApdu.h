@@ -0,0 +1,58 @@
+#ifndef CRYPTNOXAPDU_H
+#define CRYPTNOXAPDU_H
+
+#include <Arduino.h>
+
+/* Short APDU command header: CLA INS P1 P2 Lc */
+#define CRYPTNOX_APDU_HEADER_SIZE    5U
+
+/**
+ * @class CryptnoxApdu
+ * @brief Compile-time layout of a short command APDU with a constant header.
+ *
+ * The header bytes are template arguments, so write() stores them as
+ * immediate values: no header template is kept in RAM and no memcpy is
+ * needed. The command data slot starts at DATA_OFFSET and SIZE is the total
+ * length, both usable as array bounds.
+ *
+ * @code
+ * typedef CryptnoxApdu<0x80, 0xF8, 0x00, 0x00, 8> GetCardCertificate;
+ * uint8_t apdu[GetCardCertificate::SIZE];
+ * uint8_t* nonce = GetCardCertificate::write(apdu);
+ * @endcode
+ *
+ * @tparam Cla Class byte.
+ * @tparam Ins Instruction byte.
+ * @tparam P1 First parameter byte.
+ * @tparam P2 Second parameter byte.
+ * @tparam Lc Length of the command data (0 to 255).
+ */
+template <uint8_t Cla, uint8_t Ins, uint8_t P1, uint8_t P2, uint8_t Lc>
+class CryptnoxApdu {
+public:
+    /** @brief Offset of the command data. */
+    static const uint8_t DATA_OFFSET = CRYPTNOX_APDU_HEADER_SIZE;
+
+    /** @brief Length of the command data. */
+    static const uint8_t DATA_SIZE = Lc;
+
+    /** @brief Total APDU length (header and data). */
+    static const size_t SIZE = CRYPTNOX_APDU_HEADER_SIZE + Lc;
+
+    /**
+     * @brief Write the header at the start of a frame.
+     *
+     * @param frame Buffer of at least SIZE bytes.
+     * @return Pointer to the data slot, to be filled by the caller.
+     */
+    static uint8_t* write(uint8_t* frame) {
+        frame[0] = Cla;
+        frame[1] = Ins;
+        frame[2] = P1;
+        frame[3] = P2;
+        frame[4] = Lc;
+        return frame + DATA_OFFSET;
+    }
+};
+
+#endif // CRYPTNOXAPDU_H
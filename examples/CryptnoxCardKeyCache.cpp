@@ -0,0 +1,112 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxCardKeyCache.h"
+
+CryptnoxCardKeyCache::CryptnoxCardKeyCache(const uECC_Curve_t* curve)
+    : curve(curve), provider(nullptr), providerContext(nullptr), clock(0U) {
+    clear();
+}
+
+void CryptnoxCardKeyCache::setProvider(CryptnoxCardKeyProvider provider, void* context) {
+    this->provider = provider;
+    providerContext = context;
+}
+
+bool CryptnoxCardKeyCache::hasProvider() const {
+    return (provider != nullptr);
+}
+
+/**
+ * @brief Get the validated public key of a card, asking the provider on a miss.
+ *
+ * @param uid Card identifier.
+ * @param uidLength Length of the identifier in bytes.
+ * @return Pointer to the loaded key, nullptr if unknown or invalid.
+ */
+const uECC_PublicKey* CryptnoxCardKeyCache::get(const uint8_t* uid, uint8_t uidLength) {
+    const uECC_PublicKey* ret = nullptr;
+    uint8_t index = find(uid, uidLength);
+
+    if (index < CRYPTNOX_CARD_KEY_CACHE_SIZE) {
+        touch(index);
+        ret = &entries[index].publicKey;
+    }
+    else if ((provider != nullptr) && (uid != nullptr) &&
+             (uidLength > 0U) && (uidLength <= CRYPTNOX_CARD_UID_MAX_SIZE)) {
+        uint8_t key[CRYPTNOX_CARD_KEY_SIZE];
+        uint8_t keyLength = 0U;
+        uECC_PublicKey loaded;
+        bool valid = false;
+
+        if (provider(uid, uidLength, key, keyLength, providerContext)) {
+            if (keyLength == CRYPTNOX_CARD_KEY_COMPRESSED_SIZE) {
+                uint8_t compressed[CRYPTNOX_CARD_KEY_COMPRESSED_SIZE];
+
+                memcpy(compressed, key, sizeof(compressed));
+                uECC_decompress(compressed, key, curve);
+                keyLength = CRYPTNOX_CARD_KEY_SIZE;
+            }
+            valid = (keyLength == CRYPTNOX_CARD_KEY_SIZE) && (uECC_public_key_load(&loaded, key, curve) != 0);
+        }
+
+        if (valid) {
+            uint8_t i;
+
+            /* Free slot first, otherwise the least recently used one */
+            index = 0U;
+            for (i = 0U; i < CRYPTNOX_CARD_KEY_CACHE_SIZE; i++) {
+                if (entries[i].uidLength == 0U) {
+                    index = i;
+                    break;
+                }
+                if ((clock - entries[i].lastUse) > (clock - entries[index].lastUse)) {
+                    index = i;
+                }
+            }
+
+            memcpy(entries[index].uid, uid, uidLength);
+            entries[index].uidLength = uidLength;
+            entries[index].publicKey = loaded;
+            touch(index);
+            ret = &entries[index].publicKey;
+        }
+    }
+    else {
+        /* Unknown card and no provider */
+    }
+
+    return ret;
+}
+
+void CryptnoxCardKeyCache::remove(const uint8_t* uid, uint8_t uidLength) {
+    uint8_t index = find(uid, uidLength);
+
+    if (index < CRYPTNOX_CARD_KEY_CACHE_SIZE) {
+        clean(&entries[index], sizeof(Entry));
+    }
+}
+
+void CryptnoxCardKeyCache::clear() {
+    clean(entries, sizeof(entries));
+}
+
+uint8_t CryptnoxCardKeyCache::find(const uint8_t* uid, uint8_t uidLength) const {
+    uint8_t ret = CRYPTNOX_CARD_KEY_CACHE_SIZE;
+    uint8_t i;
+
+    if ((uid != nullptr) && (uidLength > 0U)) {
+        for (i = 0U; i < CRYPTNOX_CARD_KEY_CACHE_SIZE; i++) {
+            if ((entries[i].uidLength == uidLength) && (memcmp(entries[i].uid, uid, uidLength) == 0)) {
+                ret = i;
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+void CryptnoxCardKeyCache::touch(uint8_t index) {
+    clock++;
+    entries[index].lastUse = clock;
+}
@@ -0,0 +1,105 @@
+#ifndef CRYPTNOXCARDKEYCACHE_H
+#define CRYPTNOXCARDKEYCACHE_H
+
+#include <Arduino.h>
+#include "uECC.h"
+
+/**
+ * @def CRYPTNOX_CARD_KEY_CACHE_SIZE
+ * @brief Number of validated card public keys kept in RAM (about 150 bytes each).
+ */
+#ifndef CRYPTNOX_CARD_KEY_CACHE_SIZE
+#define CRYPTNOX_CARD_KEY_CACHE_SIZE       8
+#endif
+
+#define CRYPTNOX_CARD_KEY_SIZE             64    /**< Uncompressed X||Y */
+#define CRYPTNOX_CARD_KEY_COMPRESSED_SIZE  33    /**< 0x02/0x03 || X */
+#define CRYPTNOX_CARD_UID_MAX_SIZE         10
+
+/**
+ * @brief Supplies the permanent public key of a card on a cache miss.
+ *
+ * The key may be written uncompressed (64 bytes, X||Y) or compressed
+ * (33 bytes); it is decompressed and validated before being cached.
+ *
+ * @param uid Card identifier (NFCID).
+ * @param uidLength Length of the identifier in bytes.
+ * @param[out] publicKey Buffer of CRYPTNOX_CARD_KEY_SIZE bytes.
+ * @param[out] publicKeyLength CRYPTNOX_CARD_KEY_SIZE or CRYPTNOX_CARD_KEY_COMPRESSED_SIZE.
+ * @param context User pointer given at registration.
+ * @return true if the card is known, false otherwise.
+ */
+typedef bool (*CryptnoxCardKeyProvider)(const uint8_t* uid, uint8_t uidLength,
+                                        uint8_t* publicKey, uint8_t &publicKeyLength,
+                                        void* context);
+
+/**
+ * @class CryptnoxCardKeyCache
+ * @brief Least-recently-used cache of validated card public keys, keyed by UID.
+ *
+ * Keys are stored as uECC_PublicKey objects: decompressed, validated and
+ * with G + Q precomputed once at load, so repeat taps only pay for the
+ * verification ladder.
+ */
+class CryptnoxCardKeyCache {
+public:
+    /**
+     * @brief Construct an empty cache for the given curve.
+     * @param curve ECC curve of the card keys (e.g., uECC_secp256r1()).
+     */
+    explicit CryptnoxCardKeyCache(const uECC_Curve_t* curve);
+
+    /**
+     * @brief Register the source of card keys used on cache misses.
+     * @param provider Lookup callback, nullptr to disable.
+     * @param context User pointer passed to the callback.
+     */
+    void setProvider(CryptnoxCardKeyProvider provider, void* context = nullptr);
+
+    /** @brief true if a provider is registered. */
+    bool hasProvider() const;
+
+    /**
+     * @brief Get the validated public key of a card.
+     *
+     * Looks the UID up in the cache; on a miss, asks the provider, validates
+     * the key and stores it in place of the least recently used entry.
+     *
+     * @param uid Card identifier.
+     * @param uidLength Length of the identifier in bytes.
+     * @return Pointer to the loaded key (valid until the next call), nullptr if unknown or invalid.
+     */
+    const uECC_PublicKey* get(const uint8_t* uid, uint8_t uidLength);
+
+    /**
+     * @brief Drop the entry of one card, e.g. after a failed verification.
+     * @param uid Card identifier.
+     * @param uidLength Length of the identifier in bytes.
+     */
+    void remove(const uint8_t* uid, uint8_t uidLength);
+
+    /** @brief Drop all entries. */
+    void clear();
+
+private:
+    struct Entry {
+        uint8_t uid[CRYPTNOX_CARD_UID_MAX_SIZE];    /**< Card identifier */
+        uint8_t uidLength;                          /**< 0 when the slot is free */
+        uECC_PublicKey publicKey;                   /**< Validated key, ready for uECC_verify_loaded() */
+        uint32_t lastUse;                           /**< Age stamp for LRU */
+    };
+
+    Entry entries[CRYPTNOX_CARD_KEY_CACHE_SIZE];    /**< Cache slots */
+    const uECC_Curve_t* curve;                      /**< Curve of the keys */
+    CryptnoxCardKeyProvider provider;               /**< Miss handler */
+    void* providerContext;                          /**< Miss handler argument */
+    uint32_t clock;                                 /**< Age stamp counter */
+
+    /** @brief Index of the entry of a card, or CRYPTNOX_CARD_KEY_CACHE_SIZE. */
+    uint8_t find(const uint8_t* uid, uint8_t uidLength) const;
+
+    /** @brief Mark an entry as most recently used. */
+    void touch(uint8_t index);
+};
+
+#endif // CRYPTNOXCARDKEYCACHE_H
@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include "CryptnoxCommandBatch.h"
+
+CryptnoxCommandBatch::CryptnoxCommandBatch()
+    : queued(0U), done(0U) {
+    memset(commands, 0, sizeof(commands));
+}
+
+/**
+ * @brief Queue a command with its response slot.
+ *
+ * @return true if queued, false if the batch is full or the arguments are inconsistent.
+ */
+bool CryptnoxCommandBatch::add(uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                               const uint8_t* data, uint8_t dataLength,
+                               uint8_t* response, uint8_t responseSize, bool secure) {
+    bool ret = false;
+
+    if ((queued < CRYPTNOX_BATCH_MAX_COMMANDS) &&
+        ((data != nullptr) || (dataLength == 0U)) &&
+        ((response != nullptr) || (responseSize == 0U))) {
+        CryptnoxBatchCommand &command = commands[queued];
+
+        command.header[0] = cla;
+        command.header[1] = ins;
+        command.header[2] = p1;
+        command.header[3] = p2;
+        command.data = data;
+        command.dataLength = dataLength;
+        command.secure = secure;
+        command.response = response;
+        command.responseSize = responseSize;
+        command.responseLength = 0U;
+        command.statusWord = CRYPTNOX_BATCH_SW_NOT_RUN;
+        queued++;
+        ret = true;
+    }
+
+    return ret;
+}
+
+void CryptnoxCommandBatch::clear() {
+    memset(commands, 0, sizeof(commands));
+    queued = 0U;
+    done = 0U;
+}
+
+void CryptnoxCommandBatch::rewind() {
+    uint8_t i;
+
+    for (i = 0U; i < queued; i++) {
+        commands[i].responseLength = 0U;
+        commands[i].statusWord = CRYPTNOX_BATCH_SW_NOT_RUN;
+    }
+    done = 0U;
+}
+
+uint8_t CryptnoxCommandBatch::count() const {
+    return queued;
+}
+
+uint8_t CryptnoxCommandBatch::completed() const {
+    return done;
+}
+
+const CryptnoxBatchCommand& CryptnoxCommandBatch::get(uint8_t index) const {
+    return commands[(index < queued) ? index : 0U];
+}
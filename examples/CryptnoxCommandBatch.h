@@ -0,0 +1,90 @@
+#ifndef CRYPTNOXCOMMANDBATCH_H
+#define CRYPTNOXCOMMANDBATCH_H
+
+#include <Arduino.h>
+
+/**
+ * @def CRYPTNOX_BATCH_MAX_COMMANDS
+ * @brief Capacity of a CryptnoxCommandBatch.
+ */
+#ifndef CRYPTNOX_BATCH_MAX_COMMANDS
+#define CRYPTNOX_BATCH_MAX_COMMANDS     8
+#endif
+
+/** @brief Status word recorded for commands that were not run. */
+#define CRYPTNOX_BATCH_SW_NOT_RUN       0x0000U
+
+/**
+ * @struct CryptnoxBatchCommand
+ * @brief One queued command and its preallocated response slot.
+ */
+struct CryptnoxBatchCommand {
+    uint8_t header[4];          /**< CLA INS P1 P2 */
+    const uint8_t* data;        /**< Command data, may be nullptr if dataLength is 0 */
+    uint8_t dataLength;         /**< Command data length in bytes */
+    bool secure;                /**< Sent through the secure channel */
+    uint8_t* response;          /**< Response slot, may be nullptr if responseSize is 0 */
+    uint8_t responseSize;       /**< Size of the response slot in bytes */
+    uint8_t responseLength;     /**< Response data length, status word excluded */
+    uint16_t statusWord;        /**< SW1 SW2 returned by the card */
+};
+
+/**
+ * @class CryptnoxCommandBatch
+ * @brief Fixed-size queue of wallet commands run back-to-back in one card presence.
+ *
+ * Commands and response slots are set up once by the caller; the wallet then
+ * exchanges them in order with a single work buffer and stops at the first
+ * status word other than 90 00. See CryptnoxWallet::runBatch().
+ */
+class CryptnoxCommandBatch {
+public:
+    /** @brief Construct an empty batch. */
+    CryptnoxCommandBatch();
+
+    /**
+     * @brief Queue a command.
+     *
+     * @param cla Class byte.
+     * @param ins Instruction byte.
+     * @param p1 Parameter 1.
+     * @param p2 Parameter 2.
+     * @param data Command data, must stay valid until the batch has run.
+     * @param dataLength Command data length in bytes.
+     * @param response Response slot receiving the data without status word.
+     * @param responseSize Size of the response slot in bytes.
+     * @param secure true to protect the command with the secure channel.
+     * @return true if queued, false if the batch is full.
+     */
+    bool add(uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+             const uint8_t* data, uint8_t dataLength,
+             uint8_t* response, uint8_t responseSize, bool secure = true);
+
+    /** @brief Remove all commands. */
+    void clear();
+
+    /** @brief Reset the results so the same commands can run again. */
+    void rewind();
+
+    /** @brief Number of queued commands. */
+    uint8_t count() const;
+
+    /** @brief Number of commands that completed with 90 00 in the last run. */
+    uint8_t completed() const;
+
+    /**
+     * @brief Access a queued command and its result.
+     * @param index Command index, lower than count().
+     * @return Reference to the command.
+     */
+    const CryptnoxBatchCommand& get(uint8_t index) const;
+
+private:
+    friend class CryptnoxWallet;
+
+    CryptnoxBatchCommand commands[CRYPTNOX_BATCH_MAX_COMMANDS];   /**< Queued commands */
+    uint8_t queued;                                             /**< Number of queued commands */
+    uint8_t done;                                               /**< Commands completed with 90 00 */
+};
+
+#endif // CRYPTNOXCOMMANDBATCH_H
@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include <RNG.h>
+#include "CryptnoxCryptoWorker.h"
+
+#if CRYPTNOX_DUAL_CORE
+
+SemaphoreHandle_t CryptnoxCryptoWorker::rngMutex = nullptr;
+
+CryptnoxCryptoWorker::CryptnoxCryptoWorker()
+    : task(nullptr), nextTicket(0U) {
+}
+
+CryptnoxCryptoWorker::~CryptnoxCryptoWorker() {
+    if (task != nullptr) {
+        vTaskDelete(task);
+        task = nullptr;
+    }
+}
+
+/**
+ * @brief Create the RNG mutex and the worker task on the other core.
+ *
+ * @return true if the task is running.
+ */
+bool CryptnoxCryptoWorker::begin() {
+    if (rngMutex == nullptr) {
+        rngMutex = xSemaphoreCreateMutex();
+    }
+
+    if ((task == nullptr) && (rngMutex != nullptr)) {
+        BaseType_t core = (xPortGetCoreID() == 0) ? 1 : 0;
+
+        if (xTaskCreatePinnedToCore(&taskEntry, "cryptnox-ecc", CRYPTNOX_WORKER_STACK_SIZE, this,
+                                    CRYPTNOX_WORKER_PRIORITY, &task, core) != pdPASS) {
+            task = nullptr;
+        }
+    }
+
+    return (task != nullptr);
+}
+
+bool CryptnoxCryptoWorker::running() const {
+    return (task != nullptr);
+}
+
+bool CryptnoxCryptoWorker::takeKeyPair(uint8_t* publicKey, uint8_t* privateKey) {
+    bool ret = false;
+    KeyPair keyPair;
+
+    if (keyPairs.pop(keyPair)) {
+        memcpy(publicKey, keyPair.publicKey, sizeof(keyPair.publicKey));
+        memcpy(privateKey, keyPair.privateKey, sizeof(keyPair.privateKey));
+        clean(keyPair);
+        /* A slot is free again: wake the worker to refill it */
+        xTaskNotifyGive(task);
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Queue an ECDH computation and wake the worker.
+ *
+ * @param cardPublicKey 64-byte card ephemeral key X||Y.
+ * @param privateKey 32-byte client private key.
+ * @return Ticket of the request, 0 if the queue is full.
+ */
+uint8_t CryptnoxCryptoWorker::requestSharedSecret(const uint8_t* cardPublicKey, const uint8_t* privateKey) {
+    uint8_t ret = 0U;
+    EcdhRequest request;
+    EcdhResult stale;
+
+    /* Results of aborted handshakes would otherwise hold the queue */
+    while (results.pop(stale)) {
+    }
+    clean(stale);
+
+    /* Ticket 0 is the failure value */
+    request.ticket = (uint8_t)(nextTicket + 1U);
+    if (request.ticket == 0U) {
+        request.ticket = 1U;
+    }
+    memcpy(request.cardPublicKey, cardPublicKey, sizeof(request.cardPublicKey));
+    memcpy(request.privateKey, privateKey, sizeof(request.privateKey));
+
+    if (requests.push(request)) {
+        nextTicket = request.ticket;
+        xTaskNotifyGive(task);
+        ret = request.ticket;
+    }
+    clean(request);
+
+    return ret;
+}
+
+/**
+ * @brief Collect an ECDH result, dropping results of older tickets.
+ *
+ * @param ticket Value returned by requestSharedSecret().
+ * @param[out] sharedSecret Buffer for the 32-byte secret.
+ * @param[out] ok Whether the ECDH succeeded.
+ * @param[out] elapsedUs Time the worker spent on it.
+ * @return false while the result is not there yet.
+ */
+bool CryptnoxCryptoWorker::takeSharedSecret(uint8_t ticket, uint8_t* sharedSecret, bool &ok, uint32_t &elapsedUs) {
+    bool ret = false;
+    EcdhResult result;
+
+    while ((ret == false) && results.pop(result)) {
+        if (result.ticket == ticket) {
+            memcpy(sharedSecret, result.sharedSecret, sizeof(result.sharedSecret));
+            ok = result.ok;
+            elapsedUs = result.elapsedUs;
+            ret = true;
+        }
+    }
+    clean(result);
+
+    return ret;
+}
+
+void CryptnoxCryptoWorker::lockRng() {
+    if (rngMutex != nullptr) {
+        (void)xSemaphoreTake(rngMutex, portMAX_DELAY);
+    }
+}
+
+void CryptnoxCryptoWorker::unlockRng() {
+    if (rngMutex != nullptr) {
+        (void)xSemaphoreGive(rngMutex);
+    }
+}
+
+void CryptnoxCryptoWorker::taskEntry(void* context) {
+    static_cast<CryptnoxCryptoWorker*>(context)->run();
+}
+
+/* uECC RNG of the worker: the shared Crypto RNG, under its mutex */
+int CryptnoxCryptoWorker::workerRng(uint8_t* dest, unsigned size) {
+    if (dest != nullptr) {
+        lockRng();
+        RNG.rand(dest, size);
+        unlockRng();
+    }
+
+    return 1;
+}
+
+/* Worker loop: ECDH requests first, then keep the keypair queue full, then sleep */
+void CryptnoxCryptoWorker::run() {
+    const uECC_Context ecc = { uECC_secp256r1(), &workerRng };
+    EcdhRequest request;
+    EcdhResult result;
+    KeyPair keyPair;
+
+    for (;;) {
+        if (requests.pop(request)) {
+            uint32_t start = (uint32_t)micros();
+
+            result.ticket = request.ticket;
+            result.ok = (uECC_shared_secret_ctx(&ecc, request.cardPublicKey, request.privateKey,
+                                                result.sharedSecret) != 0);
+            result.elapsedUs = (uint32_t)micros() - start;
+            clean(request);
+            /* The loop drains stale results before each request, so there is room */
+            (void)results.push(result);
+            clean(result);
+        }
+        else if (keyPairs.full() == false) {
+            if (uECC_make_key_ctx(&ecc, keyPair.publicKey, keyPair.privateKey) != 0) {
+                (void)keyPairs.push(keyPair);
+            }
+            clean(keyPair);
+        }
+        else {
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+#endif // CRYPTNOX_DUAL_CORE
@@ -0,0 +1,160 @@
+#ifndef CRYPTNOXCRYPTOWORKER_H
+#define CRYPTNOXCRYPTOWORKER_H
+
+#include <Arduino.h>
+#include "uECC.h"
+
+/**
+ * @def CRYPTNOX_DUAL_CORE
+ * @brief Set to 1 on a dual-core ESP32 to run the ECC work in its own task.
+ *
+ * The Arduino loop task keeps the PN532 bus; a worker task pinned to the other
+ * core generates ephemeral keypairs ahead of time and computes the ECDH shared
+ * secret of CryptnoxWallet::poll(). See CryptnoxCryptoWorker.
+ */
+#ifndef CRYPTNOX_DUAL_CORE
+#define CRYPTNOX_DUAL_CORE              0
+#endif
+
+#if CRYPTNOX_DUAL_CORE
+
+#if !defined(ESP32)
+#error "CRYPTNOX_DUAL_CORE needs an ESP32"
+#endif
+
+#if uECC_LOW_STACK
+#error "CRYPTNOX_DUAL_CORE needs uECC_LOW_STACK 0: the uECC scratch arena is shared by all tasks"
+#endif
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "CryptnoxSpscQueue.h"
+
+/** @brief Keypairs the worker keeps ready, a power of two. */
+#ifndef CRYPTNOX_WORKER_KEYPAIRS
+#define CRYPTNOX_WORKER_KEYPAIRS        2U
+#endif
+
+/** @brief Stack of the worker task, in bytes. */
+#ifndef CRYPTNOX_WORKER_STACK_SIZE
+#define CRYPTNOX_WORKER_STACK_SIZE      6144U
+#endif
+
+/** @brief FreeRTOS priority of the worker task. */
+#ifndef CRYPTNOX_WORKER_PRIORITY
+#define CRYPTNOX_WORKER_PRIORITY        1U
+#endif
+
+/**
+ * @class CryptnoxCryptoWorker
+ * @brief P-256 work on the second ESP32 core, fed through lock-free queues.
+ *
+ * The task owning the PN532 (the Arduino loop) is the only producer of
+ * requests and the only consumer of results; the worker task is the other end
+ * of each queue. Keypairs for the next card are generated while the current
+ * card is on the RF field, and the ECDH of a handshake runs while the loop
+ * stays free for the bus. The worker sleeps on a task notification when it has
+ * nothing to do.
+ *
+ * The Crypto library RNG is not reentrant: while the worker runs, every RNG
+ * call of either task goes through lockRng()/unlockRng(), a short mutex held
+ * for one RNG.rand() or RNG.loop().
+ */
+class CryptnoxCryptoWorker {
+public:
+    CryptnoxCryptoWorker();
+
+    /** @brief Stop the task and wipe the queues. */
+    ~CryptnoxCryptoWorker();
+
+    /**
+     * @brief Start the worker task on the core the caller is not running on.
+     *
+     * Call once the RNG is started.
+     *
+     * @return true if the task is running.
+     */
+    bool begin();
+
+    /** @brief Check whether the worker task is running. */
+    bool running() const;
+
+    /**
+     * @brief Pop a ready P-256 keypair.
+     *
+     * @param[out] publicKey Buffer for the 64-byte public key.
+     * @param[out] privateKey Buffer for the 32-byte private key.
+     * @return false if none is ready.
+     */
+    bool takeKeyPair(uint8_t* publicKey, uint8_t* privateKey);
+
+    /**
+     * @brief Queue an ECDH computation.
+     *
+     * @param cardPublicKey 64-byte card ephemeral key X||Y.
+     * @param privateKey 32-byte client private key, may be wiped on return.
+     * @return Ticket of the request to pass to takeSharedSecret(), 0 if the queue is full.
+     */
+    uint8_t requestSharedSecret(const uint8_t* cardPublicKey, const uint8_t* privateKey);
+
+    /**
+     * @brief Collect the result of a requestSharedSecret() call without waiting.
+     *
+     * Results of older tickets, left behind by an aborted handshake, are dropped.
+     *
+     * @param ticket Value returned by requestSharedSecret().
+     * @param[out] sharedSecret Buffer for the 32-byte secret.
+     * @param[out] ok Whether the ECDH succeeded.
+     * @param[out] elapsedUs Time the worker spent on it.
+     * @return false while the result is not there yet.
+     */
+    bool takeSharedSecret(uint8_t ticket, uint8_t* sharedSecret, bool &ok, uint32_t &elapsedUs);
+
+    /** @brief Take the RNG mutex; does nothing before begin(). */
+    static void lockRng();
+
+    /** @brief Release the RNG mutex. */
+    static void unlockRng();
+
+private:
+    /** @brief One ready keypair. */
+    struct KeyPair {
+        uint8_t publicKey[64];          /**< X||Y */
+        uint8_t privateKey[32];         /**< Scalar */
+    };
+
+    /** @brief ECDH request. */
+    struct EcdhRequest {
+        uint8_t ticket;                 /**< Request number, never 0 */
+        uint8_t cardPublicKey[64];      /**< Card ephemeral key X||Y */
+        uint8_t privateKey[32];         /**< Client private key */
+    };
+
+    /** @brief ECDH result. */
+    struct EcdhResult {
+        uint8_t ticket;                 /**< Number of the request */
+        bool ok;                        /**< uECC_shared_secret_ctx() succeeded */
+        uint32_t elapsedUs;             /**< Computation time */
+        uint8_t sharedSecret[32];       /**< Result */
+    };
+
+    static void taskEntry(void* context);
+    static int workerRng(uint8_t* dest, unsigned size);
+    void run();
+
+    TaskHandle_t task;                                          /**< Worker task */
+    uint8_t nextTicket;                                         /**< Last ticket handed out */
+    CryptnoxSpscQueue<KeyPair, CRYPTNOX_WORKER_KEYPAIRS> keyPairs;   /**< Worker to loop */
+    CryptnoxSpscQueue<EcdhRequest, 1U> requests;                /**< Loop to worker */
+    CryptnoxSpscQueue<EcdhResult, 2U> results;                  /**< Worker to loop */
+
+    static SemaphoreHandle_t rngMutex;                          /**< Guards the Crypto RNG */
+
+    CryptnoxCryptoWorker(const CryptnoxCryptoWorker&);
+    CryptnoxCryptoWorker& operator=(const CryptnoxCryptoWorker&);
+};
+
+#endif // CRYPTNOX_DUAL_CORE
+
+#endif // CRYPTNOXCRYPTOWORKER_H
@@ -0,0 +1,120 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxHashContext.h"
+
+#define HMAC_INNER_PAD    0x36U
+#define HMAC_OUTER_PAD    0x5cU
+
+CryptnoxHashContext::CryptnoxHashContext()
+    : keyValid(false) {
+    binding.uECC.init_hash = initHash;
+    binding.uECC.update_hash = updateHash;
+    binding.uECC.finish_hash = finishHash;
+    binding.uECC.block_size = CRYPTNOX_HASH_BLOCK_SIZE;
+    binding.uECC.result_size = CRYPTNOX_HASH_RESULT_SIZE;
+    binding.uECC.tmp = tmp;
+    binding.uECC.hmac_init = hmacInit;
+    binding.uECC.hmac_finish = hmacFinish;
+    binding.owner = this;
+    clean(key, sizeof(key));
+    clean(tmp, sizeof(tmp));
+}
+
+CryptnoxHashContext::~CryptnoxHashContext() {
+    clear();
+}
+
+const uECC_HashContext* CryptnoxHashContext::get() const {
+    return &binding.uECC;
+}
+
+/**
+ * @brief Wipe the running hash, the cached key states and the work buffer.
+ */
+void CryptnoxHashContext::clear() {
+    sha.clear();
+    inner.clear();
+    outer.clear();
+    clean(key, sizeof(key));
+    clean(tmp, sizeof(tmp));
+    keyValid = false;
+}
+
+CryptnoxHashContext* CryptnoxHashContext::from(const uECC_HashContext* context) {
+    return reinterpret_cast<const Binding*>(context)->owner;
+}
+
+void CryptnoxHashContext::initHash(const uECC_HashContext* context) {
+    from(context)->sha.reset();
+}
+
+void CryptnoxHashContext::updateHash(const uECC_HashContext* context, const uint8_t* message, unsigned messageSize) {
+    from(context)->sha.update(message, messageSize);
+}
+
+void CryptnoxHashContext::finishHash(const uECC_HashContext* context, uint8_t* hashResult) {
+    from(context)->sha.finalize(hashResult, CRYPTNOX_HASH_RESULT_SIZE);
+}
+
+/**
+ * @brief Start HMAC(K, .) from the cached inner state.
+ *
+ * @param context uECC view of the adapter.
+ * @param K HMAC key, CRYPTNOX_HASH_RESULT_SIZE bytes.
+ */
+void CryptnoxHashContext::hmacInit(const uECC_HashContext* context, const uint8_t* K) {
+    CryptnoxHashContext* self = from(context);
+
+    self->loadKey(K);
+    self->sha = self->inner;
+}
+
+/**
+ * @brief Finish HMAC(K, .) from the cached outer state.
+ *
+ * @param context uECC view of the adapter.
+ * @param K HMAC key, CRYPTNOX_HASH_RESULT_SIZE bytes.
+ * @param result Output buffer of CRYPTNOX_HASH_RESULT_SIZE bytes, may be K.
+ */
+void CryptnoxHashContext::hmacFinish(const uECC_HashContext* context, const uint8_t* K, uint8_t* result) {
+    CryptnoxHashContext* self = from(context);
+    uint8_t innerHash[CRYPTNOX_HASH_RESULT_SIZE];
+
+    /* K is read before result is written, as result may alias it */
+    self->loadKey(K);
+    self->sha.finalize(innerHash, sizeof(innerHash));
+    self->sha = self->outer;
+    self->sha.update(innerHash, sizeof(innerHash));
+    self->sha.finalize(result, CRYPTNOX_HASH_RESULT_SIZE);
+    clean(innerHash, sizeof(innerHash));
+}
+
+/**
+ * @brief Recompute the padded key states if K differs from the cached key.
+ *
+ * @param K HMAC key, CRYPTNOX_HASH_RESULT_SIZE bytes.
+ */
+void CryptnoxHashContext::loadKey(const uint8_t* K) {
+    if ((keyValid == false) || (memcmp(key, K, sizeof(key)) != 0)) {
+        uint8_t* pad = tmp + 2U * CRYPTNOX_HASH_RESULT_SIZE;
+        uint8_t i;
+
+        memcpy(key, K, sizeof(key));
+        for (i = 0U; i < CRYPTNOX_HASH_RESULT_SIZE; i++) {
+            pad[i] = key[i] ^ HMAC_INNER_PAD;
+        }
+        memset(pad + CRYPTNOX_HASH_RESULT_SIZE, HMAC_INNER_PAD, CRYPTNOX_HASH_BLOCK_SIZE - CRYPTNOX_HASH_RESULT_SIZE);
+        inner.reset();
+        inner.update(pad, CRYPTNOX_HASH_BLOCK_SIZE);
+
+        for (i = 0U; i < CRYPTNOX_HASH_RESULT_SIZE; i++) {
+            pad[i] = key[i] ^ HMAC_OUTER_PAD;
+        }
+        memset(pad + CRYPTNOX_HASH_RESULT_SIZE, HMAC_OUTER_PAD, CRYPTNOX_HASH_BLOCK_SIZE - CRYPTNOX_HASH_RESULT_SIZE);
+        outer.reset();
+        outer.update(pad, CRYPTNOX_HASH_BLOCK_SIZE);
+
+        clean(pad, CRYPTNOX_HASH_BLOCK_SIZE);
+        keyValid = true;
+    }
+}
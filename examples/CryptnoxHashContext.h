@@ -0,0 +1,64 @@
+#ifndef CRYPTNOXHASHCONTEXT_H
+#define CRYPTNOXHASHCONTEXT_H
+
+#include <Arduino.h>
+#include <SHA256.h>
+#include "uECC.h"
+
+#define CRYPTNOX_HASH_BLOCK_SIZE     64U
+#define CRYPTNOX_HASH_RESULT_SIZE    32U
+
+/**
+ * @class CryptnoxHashContext
+ * @brief SHA-256 of the Crypto library bound to uECC_HashContext.
+ *
+ * Pass get() to uECC_sign_deterministic(). RFC 6979 computes a series of
+ * HMACs under the same K: the adapter keeps the SHA-256 states reached after
+ * the inner (K ^ 0x36) and outer (K ^ 0x5c) padded key blocks, and starts
+ * each HMAC by copying them while K is unchanged, which saves two of the four
+ * compression calls of a short HMAC. The states are recomputed when K changes.
+ *
+ * @code
+ * CryptnoxHashContext hash;
+ * uECC_sign_deterministic(privateKey, digest, sizeof(digest), hash.get(), signature, uECC_secp256r1());
+ * @endcode
+ */
+class CryptnoxHashContext {
+public:
+    CryptnoxHashContext();
+
+    /** @brief Wipe the hash and cached key states. */
+    ~CryptnoxHashContext();
+
+    /** @brief Context to pass to uECC_sign_deterministic(). */
+    const uECC_HashContext* get() const;
+
+    /** @brief Wipe the hash and cached key states. */
+    void clear();
+
+private:
+    /** uECC view of the adapter, kept standard-layout so the callbacks can cast back */
+    struct Binding {
+        uECC_HashContext uECC;          /**< Must stay first */
+        CryptnoxHashContext* owner;     /**< Adapter holding the hash states */
+    };
+
+    static CryptnoxHashContext* from(const uECC_HashContext* context);
+    static void initHash(const uECC_HashContext* context);
+    static void updateHash(const uECC_HashContext* context, const uint8_t* message, unsigned messageSize);
+    static void finishHash(const uECC_HashContext* context, uint8_t* hashResult);
+    static void hmacInit(const uECC_HashContext* context, const uint8_t* K);
+    static void hmacFinish(const uECC_HashContext* context, const uint8_t* K, uint8_t* result);
+
+    void loadKey(const uint8_t* K);
+
+    Binding binding;
+    SHA256 sha;                 /**< Running hash */
+    SHA256 inner;               /**< State after the K ^ 0x36 block */
+    SHA256 outer;               /**< State after the K ^ 0x5c block */
+    uint8_t key[CRYPTNOX_HASH_RESULT_SIZE]; /**< K of the cached states */
+    bool keyValid;              /**< Whether inner and outer match key */
+    uint8_t tmp[2U * CRYPTNOX_HASH_RESULT_SIZE + CRYPTNOX_HASH_BLOCK_SIZE]; /**< uECC work buffer */
+};
+
+#endif // CRYPTNOXHASHCONTEXT_H
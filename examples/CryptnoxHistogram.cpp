@@ -0,0 +1,90 @@
+#include <Arduino.h>
+#include "CryptnoxHistogram.h"
+
+static_assert(CRYPTNOX_HISTOGRAM_FIRST_SHIFT + CRYPTNOX_HISTOGRAM_BUCKETS <= 33U,
+              "Histogram buckets must fit 32-bit durations");
+
+CryptnoxHistogram::CryptnoxHistogram() {
+    reset();
+}
+
+void CryptnoxHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+}
+
+/* Bit length of the duration, offset by the first bucket: one count leading zeros */
+uint8_t CryptnoxHistogram::bucketOf(uint32_t duration) {
+    uint8_t ret = 0U;
+
+    if (duration != 0U) {
+        uint8_t bits = (uint8_t)((8U * sizeof(unsigned long)) - (unsigned)__builtin_clzl((unsigned long)duration));
+
+        if (bits > CRYPTNOX_HISTOGRAM_FIRST_SHIFT) {
+            ret = bits - CRYPTNOX_HISTOGRAM_FIRST_SHIFT;
+        }
+        if (ret >= CRYPTNOX_HISTOGRAM_BUCKETS) {
+            ret = CRYPTNOX_HISTOGRAM_BUCKETS - 1U;
+        }
+    }
+
+    return ret;
+}
+
+uint32_t CryptnoxHistogram::upperBound(uint8_t bucket) {
+    uint32_t ret = 0xFFFFFFFFUL;
+
+    if (bucket < (CRYPTNOX_HISTOGRAM_BUCKETS - 1U)) {
+        ret = 1UL << (CRYPTNOX_HISTOGRAM_FIRST_SHIFT + bucket);
+    }
+
+    return ret;
+}
+
+void CryptnoxHistogram::record(uint32_t duration) {
+    uint16_t &bucket = buckets[bucketOf(duration)];
+
+    if (bucket < CRYPTNOX_HISTOGRAM_COUNT_MAX) {
+        bucket++;
+    }
+}
+
+uint16_t CryptnoxHistogram::count(uint8_t bucket) const {
+    return (bucket < CRYPTNOX_HISTOGRAM_BUCKETS) ? buckets[bucket] : 0U;
+}
+
+uint32_t CryptnoxHistogram::samples() const {
+    uint32_t ret = 0U;
+    uint8_t i;
+
+    for (i = 0U; i < CRYPTNOX_HISTOGRAM_BUCKETS; i++) {
+        ret += buckets[i];
+    }
+
+    return ret;
+}
+
+/* Walk the buckets up to the rank of the percentile, integer arithmetic only */
+uint32_t CryptnoxHistogram::percentileBound(uint8_t percent) const {
+    uint32_t ret = 0U;
+    uint32_t total = samples();
+
+    if (total != 0U) {
+        /* Rank of the sample, 1-based, rounded up */
+        uint32_t rank = ((total * (uint32_t)((percent > 100U) ? 100U : percent)) + 99U) / 100U;
+        uint32_t seen = 0U;
+        uint8_t i;
+
+        if (rank == 0U) {
+            rank = 1U;
+        }
+        for (i = 0U; i < CRYPTNOX_HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                ret = upperBound(i);
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
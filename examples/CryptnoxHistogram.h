@@ -0,0 +1,86 @@
+#ifndef CRYPTNOXHISTOGRAM_H
+#define CRYPTNOXHISTOGRAM_H
+
+#include <Arduino.h>
+
+/**
+ * @def CRYPTNOX_HISTOGRAM_BUCKETS
+ * @brief Buckets per histogram, two bytes each.
+ */
+#ifndef CRYPTNOX_HISTOGRAM_BUCKETS
+#define CRYPTNOX_HISTOGRAM_BUCKETS        16U
+#endif
+
+/**
+ * @def CRYPTNOX_HISTOGRAM_FIRST_SHIFT
+ * @brief Bucket 0 holds durations below 2^CRYPTNOX_HISTOGRAM_FIRST_SHIFT us.
+ *
+ * Each following bucket doubles the range: with the defaults, 64 us, 128 us,
+ * ... up to 2^21 us, the last bucket holding everything above 2 s.
+ */
+#ifndef CRYPTNOX_HISTOGRAM_FIRST_SHIFT
+#define CRYPTNOX_HISTOGRAM_FIRST_SHIFT    6U
+#endif
+
+/** @brief Saturated bucket count. */
+#define CRYPTNOX_HISTOGRAM_COUNT_MAX      0xFFFFU
+
+/**
+ * @class CryptnoxHistogram
+ * @brief Log2-scaled latency histogram with fixed buckets.
+ *
+ * A sample costs a bit-length count and one increment, with no floats and
+ * no division. Bucket i > 0 holds [2^(FIRST_SHIFT + i - 1), 2^(FIRST_SHIFT + i))
+ * microseconds; counts saturate at CRYPTNOX_HISTOGRAM_COUNT_MAX.
+ */
+class CryptnoxHistogram {
+public:
+    /** @brief Construct with all buckets empty. */
+    CryptnoxHistogram();
+
+    /** @brief Empty all buckets. */
+    void reset();
+
+    /**
+     * @brief Add one sample.
+     * @param duration Duration in microseconds.
+     */
+    void record(uint32_t duration);
+
+    /**
+     * @brief Number of samples in a bucket.
+     * @param bucket Bucket index, lower than CRYPTNOX_HISTOGRAM_BUCKETS.
+     * @return Sample count, 0 if out of range.
+     */
+    uint16_t count(uint8_t bucket) const;
+
+    /** @brief Number of samples in all buckets, saturated ones counted at their cap. */
+    uint32_t samples() const;
+
+    /**
+     * @brief Upper bound of the bucket holding a percentile, e.g. 95 for p95.
+     * @param percent Percentile, 0 to 100.
+     * @return Exclusive upper bound in microseconds, 0 if the histogram is
+     *         empty, 0xFFFFFFFF for the open last bucket.
+     */
+    uint32_t percentileBound(uint8_t percent) const;
+
+    /**
+     * @brief Bucket of a duration.
+     * @param duration Duration in microseconds.
+     * @return Bucket index.
+     */
+    static uint8_t bucketOf(uint32_t duration);
+
+    /**
+     * @brief Exclusive upper bound of a bucket.
+     * @param bucket Bucket index.
+     * @return Bound in microseconds, 0xFFFFFFFF for the last bucket.
+     */
+    static uint32_t upperBound(uint8_t bucket);
+
+private:
+    uint16_t buckets[CRYPTNOX_HISTOGRAM_BUCKETS];   /**< Sample counts */
+};
+
+#endif // CRYPTNOXHISTOGRAM_H
@@ -0,0 +1,143 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxKeyPool.h"
+
+CryptnoxKeyPool::CryptnoxKeyPool(const uECC_Curve_t* curve, uECC_RNG_Function rng)
+    : count(0U),
+      generating(false) {
+    context.curve = curve;
+    context.rng = rng;
+    clean(&pending, sizeof(pending));
+    clean(privateKeys, sizeof(privateKeys));
+    clean(publicKeys, sizeof(publicKeys));
+}
+
+CryptnoxKeyPool::~CryptnoxKeyPool() {
+    clear();
+}
+
+/**
+ * @brief Generate at most one keypair if the pool is not full.
+ *
+ * @return true if a keypair was added, false if the pool is full or generation failed.
+ */
+bool CryptnoxKeyPool::refill() {
+    bool ret = false;
+
+    if (count < CRYPTNOX_KEYPOOL_SIZE) {
+        if (uECC_make_key_ctx(&context, publicKeys[count], privateKeys[count]) != 0) {
+            count++;
+            ret = true;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Run one slice of the next keypair, starting it if the pool is not full.
+ *
+ * @param maxBits Scalar bits per call.
+ * @return true if this call completed and added a keypair.
+ */
+bool CryptnoxKeyPool::refillStep(unsigned maxBits) {
+    bool ret = false;
+
+    if ((generating == false) && (count < CRYPTNOX_KEYPOOL_SIZE)) {
+        generating = (uECC_make_key_start(&pending, &context) != 0);
+    }
+
+    if ((generating == true) && (uECC_mult_step(&pending, maxBits) != 0)) {
+        generating = false;
+        /* refill() may have taken the last free slot meanwhile */
+        if ((count < CRYPTNOX_KEYPOOL_SIZE) &&
+            (uECC_make_key_finish(&pending, publicKeys[count], privateKeys[count]) != 0)) {
+            count++;
+            ret = true;
+        }
+        else {
+            clean(&pending, sizeof(pending));
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Fill every free slot with one batch generation.
+ *
+ * @return true if the pool is full, false if generation failed.
+ */
+bool CryptnoxKeyPool::refillAll() {
+    bool ret = true;
+
+    if (count < CRYPTNOX_KEYPOOL_SIZE) {
+        /* Free slots are contiguous and, for 256-bit curves, match the packed batch layout */
+        if ((uECC_curve_private_key_size(context.curve) == CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE) &&
+            (uECC_curve_public_key_size(context.curve) == CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE)) {
+            ret = (uECC_make_keys_batch(&context, CRYPTNOX_KEYPOOL_SIZE - count,
+                                        publicKeys[count], privateKeys[count]) != 0);
+            if (ret == true) {
+                count = CRYPTNOX_KEYPOOL_SIZE;
+            }
+            else {
+                clean(publicKeys[count], (CRYPTNOX_KEYPOOL_SIZE - count) * CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE);
+                clean(privateKeys[count], (CRYPTNOX_KEYPOOL_SIZE - count) * CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE);
+            }
+        }
+        else {
+            while ((ret == true) && (count < CRYPTNOX_KEYPOOL_SIZE)) {
+                ret = refill();
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Pop a ready keypair and wipe its slot.
+ *
+ * @param[out] publicKey Buffer for the 64-byte public key.
+ * @param[out] privateKey Buffer for the 32-byte private key.
+ * @return true if a keypair was available, false if the pool is empty.
+ */
+bool CryptnoxKeyPool::take(uint8_t* publicKey, uint8_t* privateKey) {
+    bool ret = false;
+
+    if ((count > 0U) && (publicKey != nullptr) && (privateKey != nullptr)) {
+        count--;
+        memcpy(publicKey, publicKeys[count], CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE);
+        memcpy(privateKey, privateKeys[count], CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE);
+
+        /* Single-use: wipe the slot as soon as the key leaves the pool */
+        clean(publicKeys[count], CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE);
+        clean(privateKeys[count], CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE);
+        ret = true;
+    }
+
+    return ret;
+}
+
+const uECC_Curve_t* CryptnoxKeyPool::getCurve() const {
+    return context.curve;
+}
+
+uint8_t CryptnoxKeyPool::available() const {
+    return count;
+}
+
+bool CryptnoxKeyPool::isFull() const {
+    return (count >= CRYPTNOX_KEYPOOL_SIZE);
+}
+
+/**
+ * @brief Wipe all pooled keys.
+ */
+void CryptnoxKeyPool::clear() {
+    clean(privateKeys, sizeof(privateKeys));
+    clean(publicKeys, sizeof(publicKeys));
+    clean(&pending, sizeof(pending));
+    count = 0U;
+    generating = false;
+}
@@ -0,0 +1,102 @@
+#ifndef CRYPTNOXKEYPOOL_H
+#define CRYPTNOXKEYPOOL_H
+
+#include <Arduino.h>
+#include "uECC.h"
+
+/**
+ * @def CRYPTNOX_KEYPOOL_SIZE
+ * @brief Number of pre-generated ephemeral keypairs kept ready for the handshake.
+ */
+#ifndef CRYPTNOX_KEYPOOL_SIZE
+#define CRYPTNOX_KEYPOOL_SIZE               2
+#endif
+
+#define CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE  32
+#define CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE   64
+
+/**
+ * @class CryptnoxKeyPool
+ * @brief Small pool of pre-computed ephemeral ECDH keypairs.
+ *
+ * Keypairs are generated one at a time from idle time (no card present) so the
+ * scalar multiplication of uECC_make_key() is not paid in the tap-to-result path.
+ * Idle hooks that must return quickly use refillStep(), which runs the ladder of
+ * the next keypair in slices.
+ * Each keypair is handed out once and its slot is wiped immediately.
+ */
+class CryptnoxKeyPool {
+public:
+    /**
+     * @brief Construct an empty pool for the given curve.
+     * @param curve ECC curve used for key generation (e.g., uECC_secp256r1()).
+     * @param rng Random source of the private keys, used instead of the uECC_set_rng() one.
+     */
+    CryptnoxKeyPool(const uECC_Curve_t* curve, uECC_RNG_Function rng);
+
+    /** @brief Wipe all pooled keys. */
+    ~CryptnoxKeyPool();
+
+    /**
+     * @brief Generate at most one keypair if the pool is not full.
+     *
+     * Intended to be called repeatedly from idle time.
+     *
+     * @return true if a keypair was added, false if the pool is full or generation failed.
+     */
+    bool refill();
+
+    /**
+     * @brief Run one slice of the next keypair, starting it if the pool is not full.
+     *
+     * Each call runs at most @p maxBits bits of the uECC_make_key_start() ladder,
+     * so it costs a fraction of refill(); the slice that completes the keypair
+     * also pays the final inversion.
+     *
+     * @param maxBits Scalar bits per call, see uECC_mult_step().
+     * @return true if this call completed and added a keypair.
+     */
+    bool refillStep(unsigned maxBits);
+
+    /**
+     * @brief Fill every free slot at once.
+     *
+     * Uses uECC_make_keys_batch(), so the keys share one modular inversion
+     * instead of paying one each. Blocks for the whole batch: call it when a
+     * longer pause is acceptable (e.g. from setup()), refill() otherwise.
+     *
+     * @return true if the pool is full, false if generation failed.
+     */
+    bool refillAll();
+
+    /**
+     * @brief Pop a ready keypair and wipe its slot.
+     *
+     * @param[out] publicKey Buffer for the 64-byte public key.
+     * @param[out] privateKey Buffer for the 32-byte private key.
+     * @return true if a keypair was available, false if the pool is empty.
+     */
+    bool take(uint8_t* publicKey, uint8_t* privateKey);
+
+    /** @brief Curve of the pooled keypairs. */
+    const uECC_Curve_t* getCurve() const;
+
+    /** @brief Number of ready keypairs. */
+    uint8_t available() const;
+
+    /** @brief Check whether no more keypairs can be added. */
+    bool isFull() const;
+
+    /** @brief Wipe all pooled keys. */
+    void clear();
+
+private:
+    uECC_Context context;      /**< Curve and RNG of the pooled keys */
+    uint8_t count;             /**< Number of ready keypairs */
+    bool generating;           /**< A refillStep() keypair is in progress */
+    uECC_mult_ctx pending;     /**< Ladder of the refillStep() keypair */
+    uint8_t privateKeys[CRYPTNOX_KEYPOOL_SIZE][CRYPTNOX_KEYPOOL_PRIVATE_KEY_SIZE]; /**< Private keys */
+    uint8_t publicKeys[CRYPTNOX_KEYPOOL_SIZE][CRYPTNOX_KEYPOOL_PUBLIC_KEY_SIZE];   /**< Public keys */
+};
+
+#endif // CRYPTNOXKEYPOOL_H
@@ -0,0 +1,140 @@
+#include <Arduino.h>
+#include "CryptnoxLog.h"
+
+#define LOG_HEX_BYTES_PER_LINE    16U
+
+/**
+ * @brief Print a labelled hex dump in the SDK format (0xXX, 16 bytes per line).
+ */
+static void printHex(const __FlashStringHelper* label, const uint8_t* data, size_t length) {
+    size_t i;
+
+    Serial.print(label);
+    Serial.println(F(": "));
+    for (i = 0U; i < length; i++) {
+        Serial.print(F("0x"));
+        if (data[i] < 16U) {
+            Serial.print(F("0"));
+        }
+        Serial.print(data[i], HEX);
+        Serial.print(F(" "));
+
+        /* Wrap line every 16 bytes */
+        if ((((i + 1U) % LOG_HEX_BYTES_PER_LINE) == 0U) && ((i + 1U) != length)) {
+            Serial.println();
+        }
+    }
+    Serial.println();
+}
+
+#ifdef CRYPTNOX_LOG_DEFERRED
+
+#define LOG_ENTRY_TEXT    0x00U
+#define LOG_ENTRY_HEX     0x01U
+/* kind, message address, dump length */
+#define LOG_ENTRY_HEADER  (1U + sizeof(const __FlashStringHelper*) + 1U)
+
+static uint8_t ring[CRYPTNOX_LOG_RING_SIZE];
+static size_t head = 0U;    /**< Next byte to write */
+static size_t tail = 0U;    /**< Next byte to read */
+static size_t used = 0U;    /**< Bytes queued */
+static uint16_t droppedEntries = 0U;
+
+static void ringPut(const uint8_t* data, size_t length) {
+    size_t i;
+
+    for (i = 0U; i < length; i++) {
+        ring[head] = data[i];
+        head = (head + 1U) % CRYPTNOX_LOG_RING_SIZE;
+    }
+    used += length;
+}
+
+static void ringGet(uint8_t* data, size_t length) {
+    size_t i;
+
+    for (i = 0U; i < length; i++) {
+        data[i] = ring[tail];
+        tail = (tail + 1U) % CRYPTNOX_LOG_RING_SIZE;
+    }
+    used -= length;
+}
+
+/**
+ * @brief Queue one entry; hex dumps are truncated to 255 bytes.
+ */
+static void enqueue(uint8_t kind, const __FlashStringHelper* message, const uint8_t* data, size_t length) {
+    uint8_t dumpLength = (length > 0xFFU) ? 0xFFU : (uint8_t)length;
+
+    if ((LOG_ENTRY_HEADER + dumpLength) > (CRYPTNOX_LOG_RING_SIZE - used)) {
+        droppedEntries++;
+    }
+    else {
+        ringPut(&kind, 1U);
+        ringPut((const uint8_t*)&message, sizeof(message));
+        ringPut(&dumpLength, 1U);
+        ringPut(data, dumpLength);
+    }
+}
+
+void CryptnoxLog::text(const __FlashStringHelper* message) {
+    enqueue(LOG_ENTRY_TEXT, message, nullptr, 0U);
+}
+
+void CryptnoxLog::hex(const __FlashStringHelper* label, const uint8_t* data, size_t length) {
+    enqueue(LOG_ENTRY_HEX, label, data, length);
+}
+
+/**
+ * @brief Print and remove every queued entry.
+ */
+void CryptnoxLog::flush() {
+    uint8_t dump[0xFFU];
+
+    while (used >= LOG_ENTRY_HEADER) {
+        uint8_t kind;
+        const __FlashStringHelper* message;
+        uint8_t dumpLength;
+
+        ringGet(&kind, 1U);
+        ringGet((uint8_t*)&message, sizeof(message));
+        ringGet(&dumpLength, 1U);
+        ringGet(dump, dumpLength);
+
+        if (kind == LOG_ENTRY_HEX) {
+            printHex(message, dump, dumpLength);
+        }
+        else {
+            Serial.println(message);
+        }
+    }
+
+    if (droppedEntries != 0U) {
+        Serial.print(F("Log entries dropped: "));
+        Serial.println(droppedEntries);
+        droppedEntries = 0U;
+    }
+}
+
+uint16_t CryptnoxLog::dropped() {
+    return droppedEntries;
+}
+
+#else
+
+void CryptnoxLog::text(const __FlashStringHelper* message) {
+    Serial.println(message);
+}
+
+void CryptnoxLog::hex(const __FlashStringHelper* label, const uint8_t* data, size_t length) {
+    printHex(label, data, length);
+}
+
+void CryptnoxLog::flush() {
+}
+
+uint16_t CryptnoxLog::dropped() {
+    return 0U;
+}
+
+#endif /* CRYPTNOX_LOG_DEFERRED */
@@ -0,0 +1,90 @@
+#ifndef CRYPTNOXLOG_H
+#define CRYPTNOXLOG_H
+
+#include <Arduino.h>
+
+/**
+ * @file CryptnoxLog.h
+ * @brief Compile-time filtered tracing used by CryptnoxWallet and PN532Base.
+ *
+ * Set CRYPTNOX_LOG_LEVEL with a build flag (or change the default below) to
+ * choose what is compiled in. Arduino builds every .cpp on its own, so a
+ * #define in the sketch does not reach the SDK sources.
+ * - CRYPTNOX_LOG_LEVEL_NONE  : no tracing code and no strings at all
+ * - CRYPTNOX_LOG_LEVEL_ERROR : failures only
+ * - CRYPTNOX_LOG_LEVEL_INFO  : failures and protocol progress
+ * - CRYPTNOX_LOG_LEVEL_DEBUG : everything, including APDU hex dumps (default)
+ *
+ * Define CRYPTNOX_LOG_DEFERRED to queue messages in a RAM ring instead of
+ * printing them during the exchange; CryptnoxLog::flush() then prints them,
+ * typically from loop().
+ */
+
+#define CRYPTNOX_LOG_LEVEL_NONE     0
+#define CRYPTNOX_LOG_LEVEL_ERROR    1
+#define CRYPTNOX_LOG_LEVEL_INFO     2
+#define CRYPTNOX_LOG_LEVEL_DEBUG    3
+
+#ifndef CRYPTNOX_LOG_LEVEL
+#define CRYPTNOX_LOG_LEVEL          CRYPTNOX_LOG_LEVEL_DEBUG
+#endif
+
+/** @brief Size in bytes of the deferred log ring. */
+#ifndef CRYPTNOX_LOG_RING_SIZE
+#define CRYPTNOX_LOG_RING_SIZE      256
+#endif
+
+/**
+ * @class CryptnoxLog
+ * @brief Serial sink behind the CRYPTNOX_LOG_* macros.
+ *
+ * Messages are flash strings, so only their address is stored in deferred
+ * mode; hex dumps copy their bytes into the ring. When the ring is full the
+ * new entry is dropped and counted.
+ */
+class CryptnoxLog {
+public:
+    /**
+     * @brief Log one line of text.
+     * @param message Flash string created with F().
+     */
+    static void text(const __FlashStringHelper* message);
+
+    /**
+     * @brief Log a labelled hex dump, 16 bytes per line.
+     * @param label Flash string created with F().
+     * @param data Bytes to dump.
+     * @param length Number of bytes to dump.
+     */
+    static void hex(const __FlashStringHelper* label, const uint8_t* data, size_t length);
+
+    /** @brief Print the queued messages (deferred mode only, no-op otherwise). */
+    static void flush();
+
+    /** @brief Number of entries dropped because the ring was full. */
+    static uint16_t dropped();
+};
+
+#if CRYPTNOX_LOG_LEVEL >= CRYPTNOX_LOG_LEVEL_ERROR
+#define CRYPTNOX_LOG_ERROR(message)             CryptnoxLog::text(message)
+#else
+#define CRYPTNOX_LOG_ERROR(message)             do { } while (0)
+#endif
+
+#if CRYPTNOX_LOG_LEVEL >= CRYPTNOX_LOG_LEVEL_INFO
+#define CRYPTNOX_LOG_INFO(message)              CryptnoxLog::text(message)
+#define CRYPTNOX_LOG_INFO_HEX(label, data, length) CryptnoxLog::hex((label), (data), (length))
+#else
+#define CRYPTNOX_LOG_INFO(message)              do { } while (0)
+#define CRYPTNOX_LOG_INFO_HEX(label, data, length) do { } while (0)
+#endif
+
+#if CRYPTNOX_LOG_LEVEL >= CRYPTNOX_LOG_LEVEL_DEBUG
+#define CRYPTNOX_LOG_DEBUG(message)             CryptnoxLog::text(message)
+#define CRYPTNOX_LOG_HEX(label, data, length)   CryptnoxLog::hex((label), (data), (length))
+#else
+#define CRYPTNOX_LOG_DEBUG(message)             do { } while (0)
+#define CRYPTNOX_LOG_HEX(label, data, length)   do { } while (0)
+#endif
+
+#endif // CRYPTNOXLOG_H
@@ -0,0 +1,231 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include <string.h>
+#include "CryptnoxPairingStore.h"
+
+#if defined(ESP32)
+/* One blob in the NVS partition */
+#define PAIRING_STORE_NVS 1
+#include <nvs.h>
+#elif defined(__AVR__)
+#define PAIRING_STORE_AVR_EEPROM 1
+#include <avr/eeprom.h>
+#elif defined(ARDUINO_ARCH_RENESAS_UNO) && defined(__has_include)
+#if __has_include(<EEPROM.h>)
+/* The core's EEPROM library emulates EEPROM in the RA4M1 data flash */
+#define PAIRING_STORE_EEPROM_LIB 1
+#include <EEPROM.h>
+#endif
+#elif defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED) && defined(__has_include)
+#if __has_include(<EEPROM.h>)
+/* Flash emulation, same size as the RNG seed storage asks for */
+#define PAIRING_STORE_EEPROM_LIB 1
+#define PAIRING_STORE_EEPROM_LIB_SIZE 4096
+#include <EEPROM.h>
+#endif
+#endif
+
+#define CRYPTNOX_PAIRING_STORE_MAGIC    0x31535043UL    /* "CPS1" */
+#define PAIRING_CRC_TAG                 'P'
+#define PAIRING_NVS_NAMESPACE           "cryptnox"
+#define PAIRING_NVS_KEY                 "pairings"
+
+/* Imported from Crypto.cpp, which uses it for the RNG seed */
+extern uint8_t crypto_crc8(uint8_t tag, const void* data, unsigned size);
+
+CryptnoxPairingStore::CryptnoxPairingStore() {
+    clean(entries, sizeof(entries));
+}
+
+CryptnoxPairingStore::~CryptnoxPairingStore() {
+    clean(entries, sizeof(entries));
+}
+
+/**
+ * @brief Load the table from storage into RAM.
+ *
+ * @return true if a storage backend exists.
+ */
+bool CryptnoxPairingStore::begin() {
+    Image image;
+    bool ret = storageRead(image);
+
+    clean(entries, sizeof(entries));
+    if ((ret == true) &&
+        (image.magic == CRYPTNOX_PAIRING_STORE_MAGIC) &&
+        (image.size == CRYPTNOX_PAIRING_STORE_SIZE) &&
+        (image.crc == crypto_crc8(PAIRING_CRC_TAG, image.entries, sizeof(image.entries)))) {
+        memcpy(entries, image.entries, sizeof(entries));
+    }
+    clean(image);
+
+    return ret;
+}
+
+const CryptnoxPairing* CryptnoxPairingStore::find(const uint8_t* uid, uint8_t uidLength) const {
+    const CryptnoxPairing* ret = nullptr;
+    uint8_t index = indexOf(uid, uidLength);
+
+    if (index < CRYPTNOX_PAIRING_STORE_SIZE) {
+        ret = &entries[index];
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Add or replace the pairing of a card and save the table.
+ *
+ * @param uid Card identifier.
+ * @param uidLength Length of the identifier in bytes.
+ * @param slot Pairing slot on the card.
+ * @param key Pairing key.
+ * @return false if the UID is invalid, the table is full or the save failed.
+ */
+bool CryptnoxPairingStore::add(const uint8_t* uid, uint8_t uidLength, uint8_t slot, const uint8_t* key) {
+    bool ret = false;
+
+    if ((uid != nullptr) && (key != nullptr) &&
+        (uidLength > 0U) && (uidLength <= CRYPTNOX_PAIRING_UID_MAX_SIZE)) {
+        uint8_t index = indexOf(uid, uidLength);
+
+        /* Known card: replace its entry, otherwise take a free one */
+        if (index >= CRYPTNOX_PAIRING_STORE_SIZE) {
+            for (index = 0U; index < CRYPTNOX_PAIRING_STORE_SIZE; index++) {
+                if (entries[index].uidLength == 0U) {
+                    break;
+                }
+            }
+        }
+
+        if (index < CRYPTNOX_PAIRING_STORE_SIZE) {
+            clean(&entries[index], sizeof(CryptnoxPairing));
+            memcpy(entries[index].uid, uid, uidLength);
+            entries[index].uidLength = uidLength;
+            entries[index].slot = slot;
+            memcpy(entries[index].key, key, CRYPTNOX_PAIRING_KEY_SIZE);
+            ret = save();
+        }
+    }
+
+    return ret;
+}
+
+bool CryptnoxPairingStore::remove(const uint8_t* uid, uint8_t uidLength) {
+    bool ret = true;
+    uint8_t index = indexOf(uid, uidLength);
+
+    if (index < CRYPTNOX_PAIRING_STORE_SIZE) {
+        clean(&entries[index], sizeof(CryptnoxPairing));
+        ret = save();
+    }
+
+    return ret;
+}
+
+bool CryptnoxPairingStore::clear() {
+    clean(entries, sizeof(entries));
+    return save();
+}
+
+uint8_t CryptnoxPairingStore::count() const {
+    uint8_t ret = 0U;
+    uint8_t i;
+
+    for (i = 0U; i < CRYPTNOX_PAIRING_STORE_SIZE; i++) {
+        if (entries[i].uidLength != 0U) {
+            ret++;
+        }
+    }
+
+    return ret;
+}
+
+uint8_t CryptnoxPairingStore::indexOf(const uint8_t* uid, uint8_t uidLength) const {
+    uint8_t i = CRYPTNOX_PAIRING_STORE_SIZE;
+
+    if ((uid != nullptr) && (uidLength > 0U)) {
+        for (i = 0U; i < CRYPTNOX_PAIRING_STORE_SIZE; i++) {
+            if ((entries[i].uidLength == uidLength) && (memcmp(entries[i].uid, uid, uidLength) == 0)) {
+                break;
+            }
+        }
+    }
+
+    return i;
+}
+
+/* Write the RAM table back, sealed with its magic and CRC */
+bool CryptnoxPairingStore::save() {
+    Image image;
+    bool ret;
+
+    image.magic = CRYPTNOX_PAIRING_STORE_MAGIC;
+    image.size = CRYPTNOX_PAIRING_STORE_SIZE;
+    image.reserved[0] = 0U;
+    image.reserved[1] = 0U;
+    memcpy(image.entries, entries, sizeof(image.entries));
+    image.crc = crypto_crc8(PAIRING_CRC_TAG, image.entries, sizeof(image.entries));
+    ret = storageWrite(image);
+    clean(image);
+
+    return ret;
+}
+
+bool CryptnoxPairingStore::storageRead(Image &image) {
+    bool ret = false;
+
+    memset(&image, 0, sizeof(image));
+#if PAIRING_STORE_NVS
+    nvs_handle handle = 0;
+    size_t length = sizeof(image);
+
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        /* An absent or resized blob reads as an empty table */
+        (void)nvs_get_blob(handle, PAIRING_NVS_KEY, &image, &length);
+        nvs_close(handle);
+    }
+    /* The namespace only exists once something was saved */
+    ret = true;
+#elif PAIRING_STORE_AVR_EEPROM
+    eeprom_read_block(&image, (const void*)CRYPTNOX_PAIRING_STORE_ADDRESS, sizeof(image));
+    ret = true;
+#elif PAIRING_STORE_EEPROM_LIB
+#if defined(PAIRING_STORE_EEPROM_LIB_SIZE)
+    EEPROM.begin(PAIRING_STORE_EEPROM_LIB_SIZE);
+#endif
+    EEPROM.get(CRYPTNOX_PAIRING_STORE_ADDRESS, image);
+    ret = true;
+#endif
+
+    return ret;
+}
+
+bool CryptnoxPairingStore::storageWrite(const Image &image) {
+    bool ret = false;
+
+#if PAIRING_STORE_NVS
+    nvs_handle handle = 0;
+
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        ret = (nvs_set_blob(handle, PAIRING_NVS_KEY, &image, sizeof(image)) == ESP_OK) &&
+              (nvs_commit(handle) == ESP_OK);
+        nvs_close(handle);
+    }
+#elif PAIRING_STORE_AVR_EEPROM
+    /* update only rewrites the bytes that changed */
+    eeprom_update_block(&image, (void*)CRYPTNOX_PAIRING_STORE_ADDRESS, sizeof(image));
+    ret = true;
+#elif PAIRING_STORE_EEPROM_LIB
+    EEPROM.put(CRYPTNOX_PAIRING_STORE_ADDRESS, image);
+#if defined(PAIRING_STORE_EEPROM_LIB_SIZE)
+    ret = EEPROM.commit();
+#else
+    ret = true;
+#endif
+#else
+    (void)image;
+#endif
+
+    return ret;
+}
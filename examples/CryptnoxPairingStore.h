@@ -0,0 +1,130 @@
+#ifndef CRYPTNOXPAIRINGSTORE_H
+#define CRYPTNOXPAIRINGSTORE_H
+
+#include <Arduino.h>
+
+/**
+ * @def CRYPTNOX_PAIRING_STORE_SIZE
+ * @brief Number of paired cards kept (44 bytes each in RAM and in storage).
+ */
+#ifndef CRYPTNOX_PAIRING_STORE_SIZE
+#define CRYPTNOX_PAIRING_STORE_SIZE        4U
+#endif
+
+/**
+ * @def CRYPTNOX_PAIRING_STORE_ADDRESS
+ * @brief EEPROM boards: offset of the store in the EEPROM.
+ *
+ * The RNG seed sits at the end of the EEPROM, so the start is free.
+ */
+#ifndef CRYPTNOX_PAIRING_STORE_ADDRESS
+#define CRYPTNOX_PAIRING_STORE_ADDRESS     0
+#endif
+
+#define CRYPTNOX_PAIRING_KEY_SIZE          32U   /**< Pairing key, the size of the common pairing data */
+#define CRYPTNOX_PAIRING_UID_MAX_SIZE      10U   /**< Longest card UID (NFCID1) */
+#define CRYPTNOX_PAIRING_SLOT_COMMON       0xFFU /**< OPEN SECURE CHANNEL slot of unpaired cards */
+
+/**
+ * @brief Pairing of one card: OPEN SECURE CHANNEL slot and pairing key.
+ */
+struct CryptnoxPairing {
+    uint8_t uid[CRYPTNOX_PAIRING_UID_MAX_SIZE];     /**< Card identifier */
+    uint8_t uidLength;                              /**< 0 when the entry is free */
+    uint8_t slot;                                   /**< Pairing slot on the card (P1) */
+    uint8_t key[CRYPTNOX_PAIRING_KEY_SIZE];         /**< Pairing key fed to the session KDF */
+};
+
+/**
+ * @class CryptnoxPairingStore
+ * @brief Pairing keys of the paired cards, keyed by UID.
+ *
+ * The whole table is read from non-volatile storage once by begin() and then
+ * served from RAM: find() returns a pointer into the table, so a tap costs a
+ * UID compare and no storage access. add() and remove() write the table back.
+ *
+ * Backends: the NVS namespace "cryptnox" on ESP32, the EEPROM on AVR, and the
+ * core EEPROM library (data flash emulation) on Uno R4 and RP2040. Elsewhere
+ * the table lives in RAM only and begin() returns false.
+ *
+ * The keys are stored in the clear: the storage must be as trusted as the
+ * firmware itself (ESP32 flash and NVS encryption, locked debug port).
+ */
+class CryptnoxPairingStore {
+public:
+    CryptnoxPairingStore();
+
+    /** @brief Wipe the table from RAM. */
+    ~CryptnoxPairingStore();
+
+    /**
+     * @brief Load the table from storage into RAM.
+     *
+     * A missing or corrupted table leaves the store empty.
+     *
+     * @return true if a storage backend exists, false if the store is RAM only.
+     */
+    bool begin();
+
+    /**
+     * @brief Look a card up.
+     *
+     * @param uid Card identifier.
+     * @param uidLength Length of the identifier in bytes.
+     * @return Pointer to the pairing in RAM (valid until the next add(),
+     *         remove() or clear()), nullptr if the card is not paired.
+     */
+    const CryptnoxPairing* find(const uint8_t* uid, uint8_t uidLength) const;
+
+    /**
+     * @brief Add or replace the pairing of a card and save the table.
+     *
+     * @param uid Card identifier.
+     * @param uidLength Length of the identifier, at most CRYPTNOX_PAIRING_UID_MAX_SIZE.
+     * @param slot Pairing slot returned by the card's PAIR command.
+     * @param key CRYPTNOX_PAIRING_KEY_SIZE-byte pairing key.
+     * @return false if the UID is invalid, the table is full or the save failed.
+     */
+    bool add(const uint8_t* uid, uint8_t uidLength, uint8_t slot, const uint8_t* key);
+
+    /**
+     * @brief Forget the pairing of a card and save the table.
+     *
+     * @param uid Card identifier.
+     * @param uidLength Length of the identifier in bytes.
+     * @return false if the save failed.
+     */
+    bool remove(const uint8_t* uid, uint8_t uidLength);
+
+    /**
+     * @brief Forget every pairing, in RAM and in storage.
+     * @return false if the save failed.
+     */
+    bool clear();
+
+    /** @brief Number of paired cards. */
+    uint8_t count() const;
+
+private:
+    /** @brief Table image in storage. */
+    struct Image {
+        uint32_t magic;                                     /**< CRYPTNOX_PAIRING_STORE_MAGIC */
+        uint8_t size;                                       /**< CRYPTNOX_PAIRING_STORE_SIZE */
+        uint8_t crc;                                        /**< CRC-8 over the entries */
+        uint8_t reserved[2];                                /**< Zero */
+        CryptnoxPairing entries[CRYPTNOX_PAIRING_STORE_SIZE];   /**< Pairings, free ones zeroed */
+    };
+
+    /** @brief Index of the entry of a card, or CRYPTNOX_PAIRING_STORE_SIZE. */
+    uint8_t indexOf(const uint8_t* uid, uint8_t uidLength) const;
+
+    /** @brief Write the table to storage. */
+    bool save();
+
+    bool storageRead(Image &image);
+    bool storageWrite(const Image &image);
+
+    CryptnoxPairing entries[CRYPTNOX_PAIRING_STORE_SIZE];   /**< Table served to the handshake */
+};
+
+#endif // CRYPTNOXPAIRINGSTORE_H
@@ -0,0 +1,52 @@
+#ifndef CRYPTNOXPOWER_H
+#define CRYPTNOXPOWER_H
+
+#include <Arduino.h>
+
+/**
+ * @def CRYPTNOX_POWER_HOOKS
+ * @brief Set to 1 to report RF, CPU and idle intervals to a power hook.
+ *
+ * Meant for energy profiling of battery readers: the hook samples a power
+ * monitor (an INA219 on the board, or a trigger line for a bench meter) at
+ * every interval boundary, so the charge drawn can be split between RF
+ * exchanges, ECC/SHA work and idle time. Compiled out by default.
+ */
+#ifndef CRYPTNOX_POWER_HOOKS
+#define CRYPTNOX_POWER_HOOKS           0
+#endif
+
+/**
+ * @enum CryptnoxPowerPhase
+ * @brief Intervals reported to the power hook.
+ *
+ * Intervals may nest: key pre-generation run from the detection idle hook is
+ * a CPU interval inside an RF one, and idle() work is a CPU interval inside
+ * an IDLE one.
+ */
+enum CryptnoxPowerPhase : uint8_t {
+    CRYPTNOX_POWER_RF = 0,        /**< PN532 drives the field: detection or APDU exchange */
+    CRYPTNOX_POWER_CPU,           /**< Host busy with ECC or SHA */
+    CRYPTNOX_POWER_IDLE           /**< Between two CryptnoxWallet::processCard() calls */
+};
+
+/**
+ * @brief Called at the start and at the end of each interval.
+ *
+ * Runs in the caller's context, between two bus transactions: keep it short
+ * (read a sensor, toggle a pin, store a sample).
+ *
+ * @param phase Interval kind.
+ * @param enter true when the interval starts (RF on, CPU busy, idle), false when it ends.
+ * @param context User pointer given at registration.
+ */
+typedef void (*CryptnoxPowerHook)(CryptnoxPowerPhase phase, bool enter, void* context);
+
+#if CRYPTNOX_POWER_HOOKS
+/** @brief Report an interval boundary through the hook registered in a PN532Base. */
+#define CRYPTNOX_POWER_MARK(driver, phase, enter)   (driver).markPower((phase), (enter))
+#else
+#define CRYPTNOX_POWER_MARK(driver, phase, enter)   do { } while (0)
+#endif
+
+#endif // CRYPTNOXPOWER_H
@@ -0,0 +1,179 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxReceiptLog.h"
+
+#define FLASH_CMD_WRITE_ENABLE      0x06U
+#define FLASH_CMD_READ_STATUS       0x05U
+#define FLASH_CMD_READ              0x03U
+#define FLASH_CMD_PAGE_PROGRAM      0x02U
+#define FLASH_CMD_SECTOR_ERASE      0x20U
+#define FLASH_STATUS_WIP            0x01U
+
+CryptnoxReceiptLog::CryptnoxReceiptLog(Adafruit_SPIDevice* flash, uint32_t baseAddress, uint32_t sectorCount)
+    : flash(flash),
+      baseAddress(baseAddress),
+      sectorCount(sectorCount),
+      pendingAddress(0UL),
+      state(STATE_IDLE) {
+    clean(staging, sizeof(staging));
+}
+
+CryptnoxReceiptLog::~CryptnoxReceiptLog() {
+    clear();
+}
+
+/**
+ * @brief Start the SPI device and load the XTS key.
+ *
+ * @param key CRYPTNOX_RECEIPT_KEY_SIZE-byte key (data key, then tweak key).
+ * @return true on success.
+ */
+bool CryptnoxReceiptLog::begin(const uint8_t* key) {
+    bool ret = false;
+
+    if (flash->begin() && xts.setSectorSize(CRYPTNOX_RECEIPT_SECTOR_SIZE)) {
+        ret = xts.setKey(key, CRYPTNOX_RECEIPT_KEY_SIZE);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Encrypt one sector into the staging buffer and queue it.
+ *
+ * @param sector Sector number.
+ * @param data CRYPTNOX_RECEIPT_SECTOR_SIZE bytes of plaintext.
+ * @return false if a write is pending or the sector is out of range.
+ */
+bool CryptnoxReceiptLog::write(uint32_t sector, const uint8_t* data) {
+    bool ret = false;
+
+    if ((state == STATE_IDLE) && (sector < sectorCount)) {
+        xts.encryptSectors(staging, data, sector, 1U);
+        pendingAddress = baseAddress + (sector * CRYPTNOX_RECEIPT_SECTOR_SIZE);
+        state = ((pendingAddress % CRYPTNOX_RECEIPT_ERASE_SIZE) == 0UL) ? STATE_ERASE : STATE_PROGRAM;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Advance the pending write by at most one flash command.
+ *
+ * @return true when no write is pending anymore.
+ */
+bool CryptnoxReceiptLog::poll() {
+    switch (state) {
+        case STATE_ERASE:
+            if (command(FLASH_CMD_SECTOR_ERASE, pendingAddress, nullptr, 0U)) {
+                state = STATE_ERASING;
+            }
+            break;
+        case STATE_ERASING:
+            if (!flashBusy()) {
+                state = STATE_PROGRAM;
+            }
+            break;
+        case STATE_PROGRAM:
+            if (command(FLASH_CMD_PAGE_PROGRAM, pendingAddress, staging, sizeof(staging))) {
+                state = STATE_PROGRAMMING;
+            }
+            break;
+        case STATE_PROGRAMMING:
+            if (!flashBusy()) {
+                clean(staging, sizeof(staging));
+                state = STATE_IDLE;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return (state == STATE_IDLE);
+}
+
+bool CryptnoxReceiptLog::busy() const {
+    return (state != STATE_IDLE);
+}
+
+/**
+ * @brief Read consecutive sectors in one flash read and decrypt them in place.
+ *
+ * @param sector First sector number.
+ * @param[out] data Buffer of count * CRYPTNOX_RECEIPT_SECTOR_SIZE bytes.
+ * @param count Number of sectors.
+ * @return false if a write is pending or the range is out of the log.
+ */
+bool CryptnoxReceiptLog::read(uint32_t sector, uint8_t* data, uint16_t count) {
+    bool ret = false;
+    uint32_t address = baseAddress + (sector * CRYPTNOX_RECEIPT_SECTOR_SIZE);
+    uint8_t header[4] = {
+        FLASH_CMD_READ,
+        (uint8_t)(address >> 16),
+        (uint8_t)(address >> 8),
+        (uint8_t)address
+    };
+
+    if ((state == STATE_IDLE) && (sector < sectorCount) && (count <= (sectorCount - sector))) {
+        ret = flash->write_then_read(header, sizeof(header), data, (size_t)count * CRYPTNOX_RECEIPT_SECTOR_SIZE);
+        if (ret == true) {
+            xts.decryptSectors(data, data, sector, count);
+        }
+    }
+
+    return ret;
+}
+
+void CryptnoxReceiptLog::clear() {
+    xts.clear();
+    clean(staging, sizeof(staging));
+    state = STATE_IDLE;
+}
+
+/**
+ * @brief Read the flash status register.
+ *
+ * @return true while an erase or program is in progress, or if the read failed.
+ */
+bool CryptnoxReceiptLog::flashBusy() {
+    uint8_t opcode = FLASH_CMD_READ_STATUS;
+    uint8_t status = FLASH_STATUS_WIP;
+
+    if (!flash->write_then_read(&opcode, 1U, &status, 1U)) {
+        status = FLASH_STATUS_WIP;
+    }
+
+    return ((status & FLASH_STATUS_WIP) != 0U);
+}
+
+/**
+ * @brief Send WRITE ENABLE, then one addressed command with optional data.
+ *
+ * @param opcode Erase or program opcode.
+ * @param address 24-bit flash address.
+ * @param data Data sent after the address, or nullptr.
+ * @param length Data length in bytes.
+ * @return true if both transfers succeeded.
+ */
+bool CryptnoxReceiptLog::command(uint8_t opcode, uint32_t address, const uint8_t* data, size_t length) {
+    uint8_t enable = FLASH_CMD_WRITE_ENABLE;
+    uint8_t header[4] = {
+        opcode,
+        (uint8_t)(address >> 16),
+        (uint8_t)(address >> 8),
+        (uint8_t)address
+    };
+    bool ret = flash->write(&enable, 1U);
+
+    if (ret == true) {
+        if (data != nullptr) {
+            ret = flash->write(data, length, header, sizeof(header));
+        }
+        else {
+            ret = flash->write(header, sizeof(header));
+        }
+    }
+
+    return ret;
+}
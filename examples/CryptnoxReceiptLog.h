@@ -0,0 +1,111 @@
+#ifndef CRYPTNOXRECEIPTLOG_H
+#define CRYPTNOXRECEIPTLOG_H
+
+#include <Arduino.h>
+#include <Adafruit_SPIDevice.h>
+#include <AES.h>
+#include <XTS.h>
+
+/**
+ * @def CRYPTNOX_RECEIPT_SECTOR_SIZE
+ * @brief Bytes per encrypted sector; one SPI NOR page so a sector is one program command.
+ */
+#ifndef CRYPTNOX_RECEIPT_SECTOR_SIZE
+#define CRYPTNOX_RECEIPT_SECTOR_SIZE        256U
+#endif
+
+/** @brief Smallest erasable block of the SPI NOR flash, in bytes. */
+#define CRYPTNOX_RECEIPT_ERASE_SIZE         4096UL
+
+/** @brief XTS-AES-128 key size: data key followed by tweak key. */
+#define CRYPTNOX_RECEIPT_KEY_SIZE           32U
+
+/**
+ * @class CryptnoxReceiptLog
+ * @brief XTS-AES-128 encrypted sector log on an external SPI NOR flash.
+ *
+ * Each sector is encrypted with its sector number as XTS tweak, so any sector
+ * can be read back and decrypted on its own. Writes do not block: write()
+ * encrypts the sector into a staging buffer and poll(), called from the main
+ * loop, issues at most one flash command per call and never waits on the
+ * flash busy flag. Sectors are meant to be written in increasing order: the
+ * erase block is erased when a write reaches its first sector.
+ *
+ * Flash commands are the common JEDEC set (WREN 06h, RDSR 05h, READ 03h,
+ * PP 02h, SE 20h) with 3-byte addresses.
+ */
+class CryptnoxReceiptLog {
+public:
+    /**
+     * @brief Construct a log over a range of the flash.
+     * @param flash SPI device of the flash chip.
+     * @param baseAddress Flash address of sector 0, erase block aligned.
+     * @param sectorCount Number of sectors in the log.
+     */
+    CryptnoxReceiptLog(Adafruit_SPIDevice* flash, uint32_t baseAddress, uint32_t sectorCount);
+
+    /** @brief Wipe the keys and the staging buffer. */
+    ~CryptnoxReceiptLog();
+
+    /**
+     * @brief Start the SPI device and load the XTS key.
+     * @param key CRYPTNOX_RECEIPT_KEY_SIZE-byte key (data key, then tweak key).
+     * @return true on success.
+     */
+    bool begin(const uint8_t* key);
+
+    /**
+     * @brief Encrypt one sector and queue it for programming.
+     * @param sector Sector number.
+     * @param data CRYPTNOX_RECEIPT_SECTOR_SIZE bytes of plaintext, free to reuse on return.
+     * @return false if a previous write is still running or the sector is out of range.
+     */
+    bool write(uint32_t sector, const uint8_t* data);
+
+    /**
+     * @brief Advance the pending write by at most one flash command.
+     * @return true when no write is pending anymore.
+     */
+    bool poll();
+
+    /** @brief Check whether a write is still pending. */
+    bool busy() const;
+
+    /**
+     * @brief Read and decrypt consecutive sectors in one flash read.
+     *
+     * The ciphertext is read straight into @p data and decrypted in place.
+     *
+     * @param sector First sector number.
+     * @param[out] data Buffer of count * CRYPTNOX_RECEIPT_SECTOR_SIZE bytes.
+     * @param count Number of sectors.
+     * @return false if a write is pending or the range is out of the log.
+     */
+    bool read(uint32_t sector, uint8_t* data, uint16_t count = 1U);
+
+    /** @brief Wipe the keys and the staging buffer, dropping any pending write. */
+    void clear();
+
+private:
+    /** @brief Steps of a pending write. */
+    enum State : uint8_t {
+        STATE_IDLE = 0,
+        STATE_ERASE,            /**< Erase command to send */
+        STATE_ERASING,          /**< Waiting for the erase to finish */
+        STATE_PROGRAM,          /**< Page program command to send */
+        STATE_PROGRAMMING       /**< Waiting for the program to finish */
+    };
+
+    bool flashBusy();
+    bool command(uint8_t opcode, uint32_t address, const uint8_t* data, size_t length);
+
+    Adafruit_SPIDevice* flash;      /**< Flash chip */
+    uint32_t baseAddress;           /**< Flash address of sector 0 */
+    uint32_t sectorCount;           /**< Sectors in the log */
+    uint32_t pendingAddress;        /**< Flash address of the pending write */
+    State state;                    /**< Pending write step */
+    XTS<AES128> xts;                /**< Sector cipher */
+    uint8_t staging[CRYPTNOX_RECEIPT_SECTOR_SIZE];  /**< Ciphertext of the pending write */
+};
+
+#endif // CRYPTNOXRECEIPTLOG_H
@@ -0,0 +1,438 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include <RNG.h>
+#include <string.h>
+#include "CryptnoxReceiptStore.h"
+#include "CryptnoxCryptoWorker.h"
+
+#if defined(ESP32)
+/* A data partition, mapped into the data address space */
+#define RECEIPT_STORE_ESP32 1
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#elif defined(ARDUINO_ARCH_RENESAS_UNO) && defined(__has_include)
+#if __has_include(<EEPROM.h>)
+/* The core's EEPROM library owns the RA4M1 data flash; share it with the
+   pairing store and the RNG seed */
+#define RECEIPT_STORE_EEPROM_LIB 1
+#include <EEPROM.h>
+#include "CryptnoxPairingStore.h"
+#endif
+#endif
+
+#define CRYPTNOX_RECEIPT_STORE_MAGIC    0x32535243UL    /* "CRS2" */
+#define RECEIPT_ERASED_WORD             0xFFFFFFFFUL
+#define RECEIPT_CRC_TAG                 'R'
+#define RECEIPT_HEADER_CRC_TAG          'H'
+#define RECEIPT_NONCE_SIZE              8U
+#define RECEIPT_AAD_SIZE                10U             /* sequence, salt and length */
+#define RECEIPT_HEADER_CRC_SIZE         12U             /* capacity, first sequence and salt */
+#define RECEIPT_EEPROM_SIZE             8192UL          /* RA4M1 data flash */
+#define RECEIPT_EEPROM_SEED_RESERVE     1024UL          /* RNG seed slots at the end */
+#define RECEIPT_ERASED_BYTE             0xFFU
+
+/* Imported from Crypto.cpp, which uses it for the RNG seed */
+extern uint8_t crypto_crc8(uint8_t tag, const void* data, unsigned size);
+
+#if RECEIPT_STORE_ESP32
+#if ESP_IDF_VERSION_MAJOR >= 5
+typedef esp_partition_mmap_handle_t ReceiptMapHandle;
+#define RECEIPT_MMAP_DATA               ESP_PARTITION_MMAP_DATA
+#else
+typedef spi_flash_mmap_handle_t ReceiptMapHandle;
+#define RECEIPT_MMAP_DATA               SPI_FLASH_MMAP_DATA
+#endif
+/* One partition per firmware: the mapping is shared by every store object */
+static const esp_partition_t* storePartition = nullptr;
+static ReceiptMapHandle storeMapHandle;
+static const void* storeMapped = nullptr;
+#elif RECEIPT_STORE_EEPROM_LIB
+/* Keep clear of the other users of the EEPROM, see CRYPTNOX_RECEIPT_STORE_OFFSET */
+static_assert(CRYPTNOX_RECEIPT_STORE_OFFSET >=
+              (CRYPTNOX_PAIRING_STORE_ADDRESS + 8UL +
+               (CRYPTNOX_PAIRING_STORE_SIZE * sizeof(CryptnoxPairing))),
+              "Receipt store overlaps the pairing store");
+static_assert((CRYPTNOX_RECEIPT_STORE_OFFSET + CRYPTNOX_RECEIPT_STORE_SIZE) <=
+              (RECEIPT_EEPROM_SIZE - RECEIPT_EEPROM_SEED_RESERVE),
+              "Receipt store overlaps the RNG seed slots");
+#endif
+
+CryptnoxReceiptStore::CryptnoxReceiptStore()
+    : opened(false),
+      regionSize(0UL),
+      slots(0UL),
+      firstSequence(0UL),
+      salt(RECEIPT_ERASED_WORD),
+      stored(0UL),
+      queueHead(0U),
+      queued(0U) {
+    static_assert(sizeof(Record) == CRYPTNOX_RECEIPT_RECORD_SIZE, "Record must fill one slot");
+    static_assert(sizeof(Header) <= CRYPTNOX_RECEIPT_RECORD_SIZE, "Header must fit in slot 0");
+    clean(queue, sizeof(queue));
+}
+
+CryptnoxReceiptStore::~CryptnoxReceiptStore() {
+    clear();
+}
+
+/**
+ * @brief Open the region, load the key and find the end of the log.
+ *
+ * @param key CRYPTNOX_RECEIPT_STORE_KEY_SIZE-byte ChaChaPoly key.
+ * @return true if the store is ready.
+ */
+bool CryptnoxReceiptStore::begin(const uint8_t* key) {
+    bool ret = false;
+
+    if (regionOpen() && (regionSize >= (2UL * CRYPTNOX_RECEIPT_RECORD_SIZE))) {
+        Header header;
+        regionRead(0UL, &header, sizeof(header));
+        slots = (regionSize / CRYPTNOX_RECEIPT_RECORD_SIZE) - 1UL;
+
+        if ((header.magic == CRYPTNOX_RECEIPT_STORE_MAGIC) &&
+            (header.recordSize == CRYPTNOX_RECEIPT_RECORD_SIZE) &&
+            (header.capacity == slots) &&
+            (header.crc == crypto_crc8(RECEIPT_HEADER_CRC_TAG, &header.capacity,
+                                       RECEIPT_HEADER_CRC_SIZE))) {
+            firstSequence = header.firstSequence;
+            salt = header.salt;
+            ret = true;
+        }
+        else {
+            ret = format(0UL);
+        }
+    }
+
+    if (ret == true) {
+        /* Slots of the current salt fill from the front, so the first other
+           one splits the region in two */
+        uint32_t low = 0UL;
+        uint32_t high = slots;
+        while (low < high) {
+            uint32_t middle = low + ((high - low) / 2UL);
+            if (slotUsed(middle)) {
+                low = middle + 1UL;
+            }
+            else {
+                high = middle;
+            }
+        }
+        stored = low;
+        queueHead = 0U;
+        queued = 0U;
+        ret = cipher.setKey(key, CRYPTNOX_RECEIPT_STORE_KEY_SIZE);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Seal a receipt into the next free queue entry.
+ *
+ * @param data Receipt bytes.
+ * @param length At most CRYPTNOX_RECEIPT_PAYLOAD_SIZE bytes.
+ * @return false if the receipt is too long, the queue is full or the region is full.
+ */
+bool CryptnoxReceiptStore::append(const uint8_t* data, uint16_t length) {
+    bool ret = false;
+
+    if ((opened == true) && (length <= CRYPTNOX_RECEIPT_PAYLOAD_SIZE) &&
+        (queued < CRYPTNOX_RECEIPT_QUEUE_SIZE) && ((stored + queued) < slots)) {
+        Record* record = &queue[(queueHead + queued) % CRYPTNOX_RECEIPT_QUEUE_SIZE];
+
+        record->sequence = firstSequence + stored + queued;
+        record->salt = salt;
+        record->length = length;
+        record->reserved = 0U;
+        memcpy(record->payload, data, length);
+        memset(record->payload + length, 0, CRYPTNOX_RECEIPT_PAYLOAD_SIZE - length);
+
+        setNonce(record->sequence);
+        cipher.addAuthData(record, RECEIPT_AAD_SIZE);
+        cipher.encrypt(record->payload, record->payload, length);
+        cipher.computeTag(record->tag, CRYPTNOX_RECEIPT_TAG_SIZE);
+        record->crc = crypto_crc8(RECEIPT_CRC_TAG, record->tag,
+                                  CRYPTNOX_RECEIPT_TAG_SIZE + CRYPTNOX_RECEIPT_PAYLOAD_SIZE);
+        ++queued;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Program the oldest queued record, if any.
+ *
+ * @return true when the queue is empty.
+ */
+bool CryptnoxReceiptStore::poll() {
+    if (queued > 0U) {
+        Record* record = &queue[queueHead];
+        uint32_t offset = (stored + 1UL) * CRYPTNOX_RECEIPT_RECORD_SIZE;
+
+        if (regionWrite(offset, *record)) {
+            clean(record, sizeof(Record));
+            queueHead = (uint8_t)((queueHead + 1U) % CRYPTNOX_RECEIPT_QUEUE_SIZE);
+            --queued;
+            ++stored;
+        }
+    }
+
+    return (queued == 0U);
+}
+
+bool CryptnoxReceiptStore::flush() {
+    bool ret = true;
+
+    while ((queued > 0U) && (ret == true)) {
+        uint8_t before = queued;
+        poll();
+        ret = (queued < before);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Check the CRC, then authenticate and decrypt a record read from flash.
+ *
+ * @param index Record index.
+ * @param[out] data Buffer of CRYPTNOX_RECEIPT_PAYLOAD_SIZE bytes, wiped on failure.
+ * @param[out] length Receipt length.
+ * @param[out] sequence Sequence number of the record, or nullptr.
+ * @return false if the index is not stored, or the CRC or tag does not match.
+ */
+bool CryptnoxReceiptStore::read(uint32_t index, uint8_t* data, uint16_t* length, uint32_t* sequence) {
+    bool ret = false;
+
+    if (index < stored) {
+        Record copy;
+        const Record* record = &copy;
+        regionRead((index + 1UL) * CRYPTNOX_RECEIPT_RECORD_SIZE, &copy, sizeof(copy));
+
+        if ((record->sequence == (firstSequence + index)) &&
+            (record->salt == salt) &&
+            (record->length <= CRYPTNOX_RECEIPT_PAYLOAD_SIZE) &&
+            (record->crc == crypto_crc8(RECEIPT_CRC_TAG, record->tag,
+                                        CRYPTNOX_RECEIPT_TAG_SIZE + CRYPTNOX_RECEIPT_PAYLOAD_SIZE))) {
+            setNonce(record->sequence);
+            cipher.addAuthData(record, RECEIPT_AAD_SIZE);
+            cipher.decrypt(data, record->payload, record->length);
+            ret = cipher.checkTag(record->tag, CRYPTNOX_RECEIPT_TAG_SIZE);
+            if (ret == true) {
+                *length = record->length;
+                if (sequence != nullptr) {
+                    *sequence = record->sequence;
+                }
+            }
+            else {
+                clean(data, record->length);
+            }
+        }
+    }
+
+    return ret;
+}
+
+bool CryptnoxReceiptStore::erase() {
+    bool ret = false;
+
+    if (opened == true) {
+        ret = format(firstSequence + stored + queued);
+        if (ret == true) {
+            clean(queue, sizeof(queue));
+            stored = 0UL;
+            queueHead = 0U;
+            queued = 0U;
+        }
+    }
+
+    return ret;
+}
+
+uint32_t CryptnoxReceiptStore::count() const {
+    return stored;
+}
+
+uint32_t CryptnoxReceiptStore::capacity() const {
+    return slots;
+}
+
+uint8_t CryptnoxReceiptStore::pending() const {
+    return queued;
+}
+
+void CryptnoxReceiptStore::clear() {
+    cipher.clear();
+    clean(queue, sizeof(queue));
+    queueHead = 0U;
+    queued = 0U;
+}
+
+/**
+ * @brief Draw a new salt, erase the region and program a fresh index header.
+ *
+ * The salt differs from the old one and from the erased word, so neither the
+ * records of the old log nor erased slots pass for records of the new one.
+ *
+ * @param sequence Sequence number of the first record of the new log.
+ * @return true on success.
+ */
+bool CryptnoxReceiptStore::format(uint32_t sequence) {
+    Header header;
+    bool ret = false;
+
+    header.magic = CRYPTNOX_RECEIPT_STORE_MAGIC;
+    header.recordSize = CRYPTNOX_RECEIPT_RECORD_SIZE;
+    header.reserved = 0U;
+    header.capacity = slots;
+    header.firstSequence = sequence;
+    do {
+#if CRYPTNOX_DUAL_CORE
+        /* Shared with the worker task */
+        CryptnoxCryptoWorker::lockRng();
+        RNG.rand((uint8_t*)&header.salt, sizeof(header.salt));
+        CryptnoxCryptoWorker::unlockRng();
+#else
+        RNG.rand((uint8_t*)&header.salt, sizeof(header.salt));
+#endif
+    } while ((header.salt == salt) || (header.salt == RECEIPT_ERASED_WORD));
+    header.crc = crypto_crc8(RECEIPT_HEADER_CRC_TAG, &header.capacity, RECEIPT_HEADER_CRC_SIZE);
+
+    if (regionErase() && regionWrite(0UL, header)) {
+        firstSequence = sequence;
+        salt = header.salt;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Check whether a slot holds a record of the current log.
+ *
+ * Erased flash reads as all ones, which no salt takes; a record left over
+ * from an older log has another salt.
+ */
+bool CryptnoxReceiptStore::slotUsed(uint32_t index) const {
+    uint32_t stamp[2];
+
+    regionRead((index + 1UL) * CRYPTNOX_RECEIPT_RECORD_SIZE, stamp, sizeof(stamp));
+    return ((stamp[0] == (firstSequence + index)) && (stamp[1] == salt));
+}
+
+/**
+ * @brief Start a ChaChaPoly operation with the nonce of a sequence number.
+ *
+ * The nonce is the sequence number followed by the salt of the log.
+ */
+void CryptnoxReceiptStore::setNonce(uint32_t sequence) {
+    uint8_t nonce[RECEIPT_NONCE_SIZE] = {
+        (uint8_t)sequence,
+        (uint8_t)(sequence >> 8),
+        (uint8_t)(sequence >> 16),
+        (uint8_t)(sequence >> 24),
+        (uint8_t)salt,
+        (uint8_t)(salt >> 8),
+        (uint8_t)(salt >> 16),
+        (uint8_t)(salt >> 24)
+    };
+
+    cipher.setIV(nonce, sizeof(nonce));
+}
+
+/**
+ * @brief Find the flash region of the current board.
+ *
+ * @return true if @c opened and @c regionSize are set.
+ */
+bool CryptnoxReceiptStore::regionOpen() {
+#if RECEIPT_STORE_ESP32
+    if (storePartition == nullptr) {
+        const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                    ESP_PARTITION_SUBTYPE_ANY,
+                                                                    CRYPTNOX_RECEIPT_STORE_PARTITION);
+        if ((partition != nullptr) &&
+            (esp_partition_mmap(partition, 0U, partition->size, RECEIPT_MMAP_DATA,
+                                &storeMapped, &storeMapHandle) == ESP_OK)) {
+            storePartition = partition;
+        }
+    }
+    if (storePartition != nullptr) {
+        regionSize = storePartition->size;
+        opened = true;
+    }
+#elif RECEIPT_STORE_EEPROM_LIB
+    if ((CRYPTNOX_RECEIPT_STORE_OFFSET + CRYPTNOX_RECEIPT_STORE_SIZE) <=
+        ((uint32_t)EEPROM.length() - RECEIPT_EEPROM_SEED_RESERVE)) {
+        regionSize = CRYPTNOX_RECEIPT_STORE_SIZE;
+        opened = true;
+    }
+#endif
+
+    return opened;
+}
+
+/**
+ * @brief Copy bytes out of the region.
+ *
+ * @param offset Offset in the region.
+ * @param[out] data Destination.
+ * @param length Number of bytes.
+ */
+void CryptnoxReceiptStore::regionRead(uint32_t offset, void* data, size_t length) const {
+#if RECEIPT_STORE_ESP32
+    memcpy(data, (const uint8_t*)storeMapped + offset, length);
+#elif RECEIPT_STORE_EEPROM_LIB
+    uint8_t* bytes = (uint8_t*)data;
+    for (size_t posn = 0U; posn < length; ++posn) {
+        bytes[posn] = EEPROM.read((int)(CRYPTNOX_RECEIPT_STORE_OFFSET + offset + posn));
+    }
+#else
+    (void)offset;
+    memset(data, RECEIPT_ERASED_BYTE, length);
+#endif
+}
+
+/**
+ * @brief Program a record or the index header; blocks until the program is done.
+ *
+ * @param offset Offset in the region.
+ * @param value Record or header to program, in one write.
+ * @return true on success.
+ */
+template <typename T>
+bool CryptnoxReceiptStore::regionWrite(uint32_t offset, const T& value) {
+    bool ret = false;
+
+#if RECEIPT_STORE_ESP32
+    ret = (esp_partition_write(storePartition, offset, &value, sizeof(value)) == ESP_OK);
+#elif RECEIPT_STORE_EEPROM_LIB
+    EEPROM.put((int)(CRYPTNOX_RECEIPT_STORE_OFFSET + offset), value);
+    ret = true;
+#else
+    (void)offset;
+    (void)value;
+#endif
+
+    return ret;
+}
+
+/**
+ * @brief Make the region ready for a new index header.
+ *
+ * Flash on ESP32 must be erased before it is programmed again. The Uno R4
+ * EEPROM rewrites in place, so nothing is erased there: the salt of the new
+ * header alone retires the old records.
+ */
+bool CryptnoxReceiptStore::regionErase() {
+    bool ret = false;
+
+#if RECEIPT_STORE_ESP32
+    ret = (esp_partition_erase_range(storePartition, 0U, storePartition->size) == ESP_OK);
+#elif RECEIPT_STORE_EEPROM_LIB
+    ret = true;
+#endif
+
+    return ret;
+}
@@ -0,0 +1,226 @@
+#ifndef CRYPTNOXRECEIPTSTORE_H
+#define CRYPTNOXRECEIPTSTORE_H
+
+#include <Arduino.h>
+#include <ChaChaPoly.h>
+
+/**
+ * @def CRYPTNOX_RECEIPT_RECORD_SIZE
+ * @brief Bytes per record slot in flash; the index header takes slot 0.
+ */
+#ifndef CRYPTNOX_RECEIPT_RECORD_SIZE
+#define CRYPTNOX_RECEIPT_RECORD_SIZE        128U
+#endif
+
+/**
+ * @def CRYPTNOX_RECEIPT_QUEUE_SIZE
+ * @brief Encrypted records held in RAM until poll() or flush() programs them.
+ */
+#ifndef CRYPTNOX_RECEIPT_QUEUE_SIZE
+#define CRYPTNOX_RECEIPT_QUEUE_SIZE         4U
+#endif
+
+/**
+ * @def CRYPTNOX_RECEIPT_STORE_PARTITION
+ * @brief ESP32: label of the data partition holding the store.
+ */
+#ifndef CRYPTNOX_RECEIPT_STORE_PARTITION
+#define CRYPTNOX_RECEIPT_STORE_PARTITION    "receipts"
+#endif
+
+/**
+ * @def CRYPTNOX_RECEIPT_STORE_OFFSET
+ * @brief Uno R4: offset of the store in the core EEPROM library.
+ *
+ * The EEPROM emulation covers the whole 8 KB data flash, so the store goes
+ * through it as well, in the range left free by the other users:
+ *
+ * | Offset      | Contents                                              |
+ * |-------------|-------------------------------------------------------|
+ * | 0           | CryptnoxPairingStore (CRYPTNOX_PAIRING_STORE_ADDRESS)  |
+ * | 1024        | Receipt store, CRYPTNOX_RECEIPT_STORE_SIZE bytes       |
+ * | 7168        | Reserved for the RNG seed slots at the end             |
+ *
+ * CryptnoxReceiptStore.cpp checks the range against this layout at compile time.
+ */
+#ifndef CRYPTNOX_RECEIPT_STORE_OFFSET
+#define CRYPTNOX_RECEIPT_STORE_OFFSET       1024UL
+#endif
+
+/** @def CRYPTNOX_RECEIPT_STORE_SIZE
+ *  @brief Uno R4: size of the store in the EEPROM, whole record slots. */
+#ifndef CRYPTNOX_RECEIPT_STORE_SIZE
+#define CRYPTNOX_RECEIPT_STORE_SIZE         6144UL
+#endif
+
+/** @brief ChaChaPoly key size. */
+#define CRYPTNOX_RECEIPT_STORE_KEY_SIZE     32U
+
+/** @brief Authentication tag stored with each record. */
+#define CRYPTNOX_RECEIPT_TAG_SIZE           16U
+
+/** @brief Record header: sequence, salt, length, CRC-8 and a reserved byte. */
+#define CRYPTNOX_RECEIPT_HEADER_SIZE        12U
+
+/** @brief Largest receipt that fits in one record. */
+#define CRYPTNOX_RECEIPT_PAYLOAD_SIZE       (CRYPTNOX_RECEIPT_RECORD_SIZE - CRYPTNOX_RECEIPT_HEADER_SIZE - CRYPTNOX_RECEIPT_TAG_SIZE)
+
+/**
+ * @class CryptnoxReceiptStore
+ * @brief Encrypted append-only receipt log in internal flash.
+ *
+ * Meant for signed results kept for a later upload. The region starts with an
+ * index header (magic, record size, capacity, first sequence number, salt)
+ * followed by fixed-size records, each sealed with ChaChaPoly and checked by
+ * a CRC-8 against torn writes.
+ *
+ * The nonce of a record is its sequence number followed by the salt, drawn
+ * from the RNG each time the region is formatted. Sequence numbers carry on
+ * across erase(); if the header is lost (power cut during a format, bad CRC)
+ * the count restarts from zero under a fresh salt, so the key never sees a
+ * nonce twice either way. Records carry the salt they were sealed under, and
+ * those of an older salt count as free slots.
+ *
+ * append() only encrypts into a RAM queue; poll() programs at most one record
+ * per call and flush() drains the whole queue back to back for idle time.
+ * Once the region is full, append() fails until erase().
+ *
+ * Backends:
+ * - ESP32: a data partition labelled CRYPTNOX_RECEIPT_STORE_PARTITION
+ *   (esp_partition mmap/write/erase, read straight from the mapping). poll()
+ *   costs one 128-byte flash program; erase() erases the whole partition.
+ * - Uno R4: a range of the core EEPROM library, which owns the data flash
+ *   driver. poll() costs one EEPROM.put() of the slot, which the emulation
+ *   programs byte by byte, skipping the bytes that do not change; count
+ *   milliseconds, not microseconds, and keep it out of card processing when
+ *   timing matters. erase() only rewrites the index header with a new salt:
+ *   the old records stay in place and are overwritten as the log grows.
+ *
+ * Elsewhere begin() fails.
+ */
+class CryptnoxReceiptStore {
+public:
+    CryptnoxReceiptStore();
+
+    /** @brief Wipe the key and the queued records. */
+    ~CryptnoxReceiptStore();
+
+    /**
+     * @brief Open the flash region, load the key and find the end of the log.
+     *
+     * A region without a valid index header is formatted under a new salt,
+     * so the RNG must be running (CryptnoxWallet::begin() starts it). The end
+     * of the log is found by a binary search over the slots.
+     *
+     * @param key CRYPTNOX_RECEIPT_STORE_KEY_SIZE-byte ChaChaPoly key.
+     * @return true if the store is ready.
+     */
+    bool begin(const uint8_t* key);
+
+    /**
+     * @brief Encrypt a receipt into the RAM queue.
+     *
+     * Constant time in the log length; no flash access.
+     *
+     * @param data Receipt bytes, free to reuse on return.
+     * @param length At most CRYPTNOX_RECEIPT_PAYLOAD_SIZE bytes.
+     * @return false if the receipt is too long, the queue is full or the
+     *         region has no free slot left.
+     */
+    bool append(const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief Program at most one queued record.
+     * @return true when the queue is empty.
+     */
+    bool poll();
+
+    /**
+     * @brief Program every queued record.
+     *
+     * Blocks for one record program per queued record; call it from idle time.
+     *
+     * @return false if a program failed; the failed record stays queued.
+     */
+    bool flush();
+
+    /**
+     * @brief Authenticate and decrypt a stored record.
+     *
+     * @param index Record index, 0 for the oldest.
+     * @param[out] data Buffer of CRYPTNOX_RECEIPT_PAYLOAD_SIZE bytes.
+     * @param[out] length Receipt length.
+     * @param[out] sequence Sequence number of the record, or nullptr.
+     * @return false if the index is not stored, or the CRC or tag does not match.
+     */
+    bool read(uint32_t index, uint8_t* data, uint16_t* length, uint32_t* sequence = nullptr);
+
+    /**
+     * @brief Drop every record once the receipts are uploaded.
+     *
+     * Sequence numbers carry on from the old log under a new salt. On ESP32
+     * it blocks for the whole partition erase; never call it during card
+     * processing.
+     *
+     * @return false if the erase or the header program failed.
+     */
+    bool erase();
+
+    /** @brief Number of records in flash. */
+    uint32_t count() const;
+
+    /** @brief Number of record slots in the region. */
+    uint32_t capacity() const;
+
+    /** @brief Number of records waiting in the queue. */
+    uint8_t pending() const;
+
+    /** @brief Wipe the key and the queued records. */
+    void clear();
+
+private:
+    /** @brief One record slot, as laid out in flash. */
+    struct Record {
+        uint32_t sequence;          /**< First half of the nonce */
+        uint32_t salt;              /**< Header salt the record was sealed under */
+        uint16_t length;            /**< Receipt length */
+        uint8_t crc;                /**< CRC-8 over tag and payload */
+        uint8_t reserved;           /**< Zero */
+        uint8_t tag[CRYPTNOX_RECEIPT_TAG_SIZE];         /**< ChaChaPoly tag */
+        uint8_t payload[CRYPTNOX_RECEIPT_PAYLOAD_SIZE]; /**< Ciphertext */
+    };
+
+    /** @brief Index header in slot 0. */
+    struct Header {
+        uint32_t magic;             /**< CRYPTNOX_RECEIPT_STORE_MAGIC */
+        uint16_t recordSize;        /**< CRYPTNOX_RECEIPT_RECORD_SIZE */
+        uint8_t crc;                /**< CRC-8 over the fields below */
+        uint8_t reserved;           /**< Zero */
+        uint32_t capacity;          /**< Record slots after the header */
+        uint32_t firstSequence;     /**< Sequence number of record 0 */
+        uint32_t salt;              /**< Random, second half of every nonce */
+    };
+
+    bool format(uint32_t firstSequence);
+    bool slotUsed(uint32_t index) const;
+    void setNonce(uint32_t sequence);
+
+    bool regionOpen();
+    void regionRead(uint32_t offset, void* data, size_t length) const;
+    template <typename T>
+    bool regionWrite(uint32_t offset, const T& value);
+    bool regionErase();
+
+    bool opened;                    /**< Region found by regionOpen() */
+    uint32_t regionSize;            /**< Region size in bytes */
+    uint32_t slots;                 /**< Record slots after the header */
+    uint32_t firstSequence;         /**< Sequence number of record 0 */
+    uint32_t salt;                  /**< Salt of the current index header */
+    uint32_t stored;                /**< Records in flash */
+    uint8_t queueHead;              /**< Oldest queued record */
+    uint8_t queued;                 /**< Records in the queue */
+    ChaChaPoly cipher;              /**< Record AEAD */
+    Record queue[CRYPTNOX_RECEIPT_QUEUE_SIZE];      /**< Sealed records to program */
+};
+
+#endif // CRYPTNOXRECEIPTSTORE_H
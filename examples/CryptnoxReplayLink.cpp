@@ -0,0 +1,475 @@
+#include <Arduino.h>
+#include <string.h>
+#include "CryptnoxReplayLink.h"
+#include "CryptnoxTrace.h"
+
+#define PCAP_MAGIC               0xA1B2C3D4UL
+#define PCAP_LINKTYPE_USER0      147UL
+#define PCAP_GLOBAL_HEADER       24U
+#define PCAP_LINKTYPE_OFFSET     20U
+#define PCAP_RECORD_HEADER       16U
+#define MICROS_PER_SECOND        1000000UL
+/* direction, status, original length in front of each packet */
+#define TRACE_PSEUDO_HEADER      4U
+
+/* Preamble, start code, LEN, LCS, then DCS and postamble */
+#define FRAME_HEADER             5U
+#define FRAME_TRAILER            2U
+#define ACK_FRAME_SIZE           6U
+/* InDataExchange data per response frame: the whole frame (TFI, code and
+   status included) must fit the driver packet buffer */
+#define REPLAY_FRAME_DATA_MAX    (PN532_PACKBUFFSIZ - FRAME_HEADER - FRAME_TRAILER - 3U)
+/* Answer data of any other command: TFI and code complete the frame */
+#define REPLAY_ANSWER_MAX        (PN532_PACKBUFFSIZ - FRAME_HEADER - FRAME_TRAILER - 2U)
+
+#define EMULATED_TARGET          0x01U
+#define EMULATED_SEL_RES         0x20U   /* ISO-DEP */
+
+static const uint8_t ackFrame[ACK_FRAME_SIZE] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+/* PN532 v1.6, ISO14443A/B and ISO18092 */
+static const uint8_t firmwareVersion[] = {0x32, 0x01, 0x06, 0x07};
+/* TL, T0 (TA, TB and TC follow, FSCI 8), TA(1) 106 kbps only, TB(1), TC(1) */
+static const uint8_t emulatedAts[] = {0x05, 0x78, 0x00, 0x81, 0x02};
+static const uint8_t defaultUid[] = {0x04, 0x43, 0x52, 0x59, 0x50, 0x54, 0x58};
+
+static uint32_t readU32(const uint8_t* data) {
+    uint32_t value;
+
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+CryptnoxReplayLink::CryptnoxReplayLink()
+    : trace(nullptr), traceLength(0U), cursor(0U), replayCount(0U), mismatchCount(0U),
+      commandLatency(0UL), exchangeLatency(0UL), uidLength(0U), inCommand(false),
+      pendingOffset(0U), inboxLength(0U), outboxLength(0U), outboxRead(0U), ackLength(0U),
+      answerStart(0UL), answerLatency(0UL) {
+    memset(&pending, 0, sizeof(pending));
+    (void)setUid(defaultUid, sizeof(defaultUid));
+}
+
+/**
+ * @brief Use a capture written by CryptnoxTrace::dump().
+ *
+ * @param pcap File contents, kept by pointer.
+ * @param length File size in bytes.
+ * @return false if the magic or the link type is not the one of CryptnoxTrace.
+ */
+bool CryptnoxReplayLink::load(const uint8_t* pcap, size_t length) {
+    bool ret = false;
+
+    trace = nullptr;
+    traceLength = 0U;
+    if ((pcap != nullptr) && (length >= PCAP_GLOBAL_HEADER) &&
+        (readU32(pcap) == PCAP_MAGIC) &&
+        (readU32(&pcap[PCAP_LINKTYPE_OFFSET]) == PCAP_LINKTYPE_USER0)) {
+        trace = pcap;
+        traceLength = length;
+        ret = true;
+    }
+    rewind();
+
+    return ret;
+}
+
+void CryptnoxReplayLink::rewind() {
+    cursor = PCAP_GLOBAL_HEADER;
+    replayCount = 0U;
+    mismatchCount = 0U;
+    inCommand = false;
+    pendingOffset = pending.length;
+}
+
+void CryptnoxReplayLink::setLatency(uint32_t commandMicros, uint32_t exchangeMicros) {
+    commandLatency = commandMicros;
+    exchangeLatency = exchangeMicros;
+}
+
+bool CryptnoxReplayLink::setUid(const uint8_t* uid, uint8_t uidLength) {
+    bool ret = false;
+
+    if ((uid != nullptr) && ((uidLength == 4U) || (uidLength == 7U) || (uidLength == 10U))) {
+        memcpy(this->uid, uid, uidLength);
+        this->uidLength = uidLength;
+        ret = true;
+    }
+
+    return ret;
+}
+
+uint16_t CryptnoxReplayLink::replayed() const {
+    return replayCount;
+}
+
+uint16_t CryptnoxReplayLink::mismatches() const {
+    return mismatchCount;
+}
+
+bool CryptnoxReplayLink::exhausted() const {
+    return (trace == nullptr) || ((cursor + PCAP_RECORD_HEADER) > traceLength);
+}
+
+void CryptnoxReplayLink::begin(void) {
+    inboxLength = 0U;
+    outboxLength = 0U;
+    outboxRead = 0U;
+    ackLength = 0U;
+    inCommand = false;
+}
+
+/**
+ * @brief Take host bytes and answer each complete frame.
+ *
+ * The driver writes a command frame in three pieces (header, command,
+ * trailer); an ACK frame from the host aborts the command in progress.
+ */
+void CryptnoxReplayLink::write(const uint8_t *data, size_t len) {
+    if ((inboxLength + len) > sizeof(inbox)) {
+        /* Not a frame the driver can send: start over */
+        inboxLength = 0U;
+        len = (len > sizeof(inbox)) ? sizeof(inbox) : len;
+    }
+    memcpy(&inbox[inboxLength], data, len);
+    inboxLength += (uint16_t)len;
+
+    while (inboxLength >= FRAME_HEADER) {
+        uint16_t start = 0U;
+        uint16_t end;
+        uint8_t length;
+
+        /* Start code 00 FF, the preamble before it is optional */
+        while (((start + 1U) < inboxLength) && ((inbox[start] != 0x00U) || (inbox[start + 1U] != 0xFFU))) {
+            start++;
+        }
+        if ((start + 4U) > inboxLength) {
+            /* Keep a possible start of frame only */
+            memmove(inbox, &inbox[start], inboxLength - start);
+            inboxLength -= start;
+            break;
+        }
+        length = inbox[start + 2U];
+
+        if ((length == 0x00U) && (inbox[start + 3U] == 0xFFU)) {
+            /* ACK frame: forget the answer being prepared */
+            end = start + 5U;
+            outboxLength = 0U;
+            outboxRead = 0U;
+            ackLength = 0U;
+            inCommand = false;
+        }
+        else if ((uint8_t)(length + inbox[start + 3U]) != 0U) {
+            /* Bad LCS: drop the start code and look further */
+            end = start + 2U;
+        }
+        else {
+            end = start + 4U + length + FRAME_TRAILER;
+            if (end > inboxLength) {
+                break;
+            }
+            handleFrame(&inbox[start + 4U], length);
+        }
+
+        end = (end > inboxLength) ? inboxLength : end;
+        memmove(inbox, &inbox[end], inboxLength - end);
+        inboxLength -= end;
+    }
+}
+
+/**
+ * @brief Number of PN532 bytes the host may read.
+ *
+ * The ACK is available at once, the response once its latency has elapsed.
+ */
+int CryptnoxReplayLink::available(void) {
+    int ret = 0;
+
+    if (outboxRead < ackLength) {
+        ret = (int)(ackLength - outboxRead);
+    }
+    else if ((outboxRead < outboxLength) && ((uint32_t)(micros() - answerStart) >= answerLatency)) {
+        ret = (int)(outboxLength - outboxRead);
+    }
+
+    return ret;
+}
+
+int CryptnoxReplayLink::read(void) {
+    int ret = -1;
+
+    if (available() > 0) {
+        ret = outbox[outboxRead];
+        outboxRead++;
+    }
+
+    return ret;
+}
+
+/* Next record of one direction, the records of the other one are skipped */
+bool CryptnoxReplayLink::nextRecord(uint8_t direction, Record &record) {
+    bool ret = false;
+
+    while ((ret == false) && (exhausted() == false)) {
+        const uint8_t* header = &trace[cursor];
+        uint32_t captured = readU32(&header[8]);
+
+        if ((cursor + PCAP_RECORD_HEADER + captured) > traceLength) {
+            /* Truncated file */
+            cursor = traceLength;
+        }
+        else {
+            const uint8_t* packet = &header[PCAP_RECORD_HEADER];
+
+            cursor += PCAP_RECORD_HEADER + captured;
+            if ((captured >= TRACE_PSEUDO_HEADER) && (packet[0] == direction)) {
+                record.micros = (readU32(header) * MICROS_PER_SECOND) + readU32(&header[4]);
+                record.direction = packet[0];
+                record.status = packet[1];
+                record.length = (uint16_t)(((uint16_t)packet[2] << 8) | packet[3]);
+                record.data = &packet[TRACE_PSEUDO_HEADER];
+                record.captured = (uint16_t)(captured - TRACE_PSEUDO_HEADER);
+                ret = true;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Answer one host frame: the ACK, then the response of the command.
+ *
+ * @param data TFI, command code and parameters.
+ * @param length Number of bytes (LEN).
+ */
+void CryptnoxReplayLink::handleFrame(const uint8_t* data, uint8_t length) {
+    uint8_t answer[PN532_PACKBUFFSIZ];
+    uint8_t answerLength = 0U;
+    const uint8_t* params = &data[2];
+    uint8_t paramsLength = (uint8_t)(length - 2U);
+    uint8_t command;
+
+    if ((length < 2U) || (data[0] != PN532_HOSTTOPN532)) {
+        return;
+    }
+
+    memcpy(outbox, ackFrame, sizeof(ackFrame));
+    outboxLength = sizeof(ackFrame);
+    outboxRead = 0U;
+    ackLength = sizeof(ackFrame);
+    command = data[1];
+
+    switch (command) {
+        case PN532_COMMAND_GETFIRMWAREVERSION:
+            memcpy(answer, firmwareVersion, sizeof(firmwareVersion));
+            answerLength = sizeof(firmwareVersion);
+            break;
+
+        case PN532_COMMAND_READREGISTER:
+            /* Two address bytes per register, every register reads 0 */
+            answerLength = (uint8_t)(paramsLength / 2U);
+            memset(answer, 0, answerLength);
+            break;
+
+        case PN532_COMMAND_READGPIO:
+            /* P3, P7, I0I1 */
+            answerLength = 3U;
+            memset(answer, 0, answerLength);
+            break;
+
+        case PN532_COMMAND_POWERDOWN:
+        case PN532_COMMAND_INPSL:
+        case PN532_COMMAND_INDESELECT:
+        case PN532_COMMAND_INRELEASE:
+        case PN532_COMMAND_INSELECT:
+            answer[0] = 0x00U;
+            answerLength = 1U;
+            break;
+
+        case PN532_COMMAND_DIAGNOSE:
+            if ((paramsLength > 0U) && (paramsLength <= REPLAY_ANSWER_MAX) && (params[0] == PN532_DIAGNOSE_LINE)) {
+                /* Echo of the test number and data */
+                memcpy(answer, params, paramsLength);
+                answerLength = paramsLength;
+            }
+            else {
+                /* The card is reported gone, so every tap runs a full handshake; the antenna is fine */
+                answer[0] = ((paramsLength > 0U) && (params[0] == PN532_DIAGNOSE_PRESENCE)) ? PN532_STATUS_TIMEOUT : 0x00U;
+                answerLength = 1U;
+            }
+            break;
+
+        case PN532_COMMAND_INLISTPASSIVETARGET:
+            answer[0] = 0U;
+            answerLength = 1U;
+            if (exhausted() == false) {
+                answer[0] = 1U;
+                answerLength += putTarget(&answer[1]);
+            }
+            break;
+
+        case PN532_COMMAND_INAUTOPOLL:
+            answer[0] = 0U;
+            answerLength = 1U;
+            if (exhausted() == false) {
+                answer[0] = 1U;
+                answer[1] = PN532_AUTOPOLL_TYPE_ISO14443_4A;
+                answer[2] = putTarget(&answer[3]);
+                answerLength = (uint8_t)(3U + answer[2]);
+            }
+            break;
+
+        case PN532_COMMAND_INDATAEXCHANGE:
+            handleDataExchange(params, paramsLength);
+            return;
+
+        default:
+            /* SAMConfiguration, RFConfiguration, WriteRegister... answer without data */
+            break;
+    }
+
+    respond(command, answer, answerLength, commandLatency);
+}
+
+/**
+ * @brief Answer one InDataExchange frame.
+ *
+ * Chained command frames (MI bit in Tg) get an empty answer; the last one
+ * gets the next recorded response, split in frames with the MI bit set when
+ * it does not fit one. An empty frame fetches the next part.
+ */
+void CryptnoxReplayLink::handleDataExchange(const uint8_t* data, uint8_t length) {
+    static const uint8_t statusOk = 0x00U;
+    uint8_t tg;
+    uint8_t apduLength;
+
+    if (length < 1U) {
+        uint8_t status = PN532_STATUS_TIMEOUT;
+        respond(PN532_COMMAND_INDATAEXCHANGE, &status, 1U, commandLatency);
+        return;
+    }
+    tg = data[0];
+    apduLength = (uint8_t)(length - 1U);
+
+    if ((inCommand == false) && (apduLength == 0U) && (pendingOffset < pending.length)) {
+        serveResponseChunk((exchangeLatency == CRYPTNOX_REPLAY_RECORDED_LATENCY) ? 0UL : exchangeLatency);
+    }
+    else {
+        if (inCommand == false) {
+            memset(commandHeader, 0, sizeof(commandHeader));
+            memcpy(commandHeader, &data[1], (apduLength < sizeof(commandHeader)) ? apduLength : sizeof(commandHeader));
+        }
+        pendingOffset = pending.length;
+
+        if ((tg & PN532_DATAEXCHANGE_MI) != 0U) {
+            inCommand = true;
+            respond(PN532_COMMAND_INDATAEXCHANGE, &statusOk, 1U, commandLatency);
+        }
+        else {
+            inCommand = false;
+            replayResponse();
+        }
+    }
+}
+
+/* Pair the APDU just received with the next command and response records */
+void CryptnoxReplayLink::replayResponse() {
+    Record command;
+    uint8_t status = PN532_STATUS_TIMEOUT;
+    uint32_t latency = exchangeLatency;
+
+    if ((nextRecord(CRYPTNOX_TRACE_COMMAND, command) == true) &&
+        (nextRecord(CRYPTNOX_TRACE_RESPONSE, pending) == true)) {
+        replayCount++;
+        if ((command.captured >= sizeof(commandHeader)) &&
+            (memcmp(command.data, commandHeader, sizeof(commandHeader)) != 0)) {
+            mismatchCount++;
+        }
+        if (latency == CRYPTNOX_REPLAY_RECORDED_LATENCY) {
+            latency = pending.micros - command.micros;
+        }
+
+        /* A wrong status word was recorded alone; a lost card or link error without data */
+        if ((pending.status == PN532_EXCHANGE_OK) || (pending.status == PN532_EXCHANGE_STATUS)) {
+            pendingOffset = 0U;
+            serveResponseChunk(latency);
+            return;
+        }
+    }
+    else {
+        /* Nothing left to replay: the card is gone */
+        cursor = traceLength;
+        if (latency == CRYPTNOX_REPLAY_RECORDED_LATENCY) {
+            latency = 0UL;
+        }
+    }
+
+    pendingOffset = pending.length;
+    respond(PN532_COMMAND_INDATAEXCHANGE, &status, 1U, latency);
+}
+
+void CryptnoxReplayLink::serveResponseChunk(uint32_t latency) {
+    uint8_t payload[1U + REPLAY_FRAME_DATA_MAX];
+    uint16_t remaining = pending.length - pendingOffset;
+    uint8_t chunk = (remaining > REPLAY_FRAME_DATA_MAX) ? (uint8_t)REPLAY_FRAME_DATA_MAX : (uint8_t)remaining;
+    uint8_t i;
+
+    payload[0] = (remaining > chunk) ? PN532_DATAEXCHANGE_MI : 0x00U;
+    for (i = 0U; i < chunk; i++) {
+        uint16_t offset = pendingOffset + i;
+        /* Bytes beyond the capture size were not recorded */
+        payload[1U + i] = (offset < pending.captured) ? pending.data[offset] : 0x00U;
+    }
+    pendingOffset += chunk;
+
+    respond(PN532_COMMAND_INDATAEXCHANGE, payload, (uint8_t)(1U + chunk), latency);
+}
+
+/* Tg, SENS_RES, SEL_RES, NFCID length, NFCID and ATS of the emulated card */
+uint8_t CryptnoxReplayLink::putTarget(uint8_t* out) const {
+    uint8_t length = 0U;
+
+    out[length++] = EMULATED_TARGET;
+    out[length++] = 0x00U;
+    out[length++] = (uidLength == 4U) ? 0x04U : 0x44U;
+    out[length++] = EMULATED_SEL_RES;
+    out[length++] = uidLength;
+    memcpy(&out[length], uid, uidLength);
+    length += uidLength;
+    memcpy(&out[length], emulatedAts, sizeof(emulatedAts));
+    length += sizeof(emulatedAts);
+
+    return length;
+}
+
+/**
+ * @brief Queue a response frame behind the ACK.
+ *
+ * @param command Command answered, the response code is command + 1.
+ * @param data Response data.
+ * @param length Number of data bytes.
+ * @param latency Time before the frame becomes available, in microseconds.
+ */
+void CryptnoxReplayLink::respond(uint8_t command, const uint8_t* data, uint8_t length, uint32_t latency) {
+    uint8_t* frame = &outbox[outboxLength];
+    uint8_t frameLength = (uint8_t)(length + 2U);
+    uint8_t sum = (uint8_t)(PN532_PN532TOHOST + command + 1U);
+    uint8_t i;
+
+    frame[0] = PN532_PREAMBLE;
+    frame[1] = PN532_STARTCODE1;
+    frame[2] = PN532_STARTCODE2;
+    frame[3] = frameLength;
+    frame[4] = (uint8_t)(~frameLength + 1U);
+    frame[5] = PN532_PN532TOHOST;
+    frame[6] = (uint8_t)(command + 1U);
+    for (i = 0U; i < length; i++) {
+        frame[7U + i] = data[i];
+        sum += data[i];
+    }
+    frame[7U + length] = (uint8_t)(~sum + 1U);
+    frame[8U + length] = PN532_POSTAMBLE;
+
+    outboxLength += (uint16_t)(FRAME_HEADER + frameLength + FRAME_TRAILER);
+    answerStart = (uint32_t)micros();
+    answerLatency = latency;
+}
@@ -0,0 +1,138 @@
+#ifndef CRYPTNOXREPLAYLINK_H
+#define CRYPTNOXREPLAYLINK_H
+
+#include <Arduino.h>
+#include "Adafruit_PN532.h"
+
+/**
+ * @file CryptnoxReplayLink.h
+ * @brief PN532 emulator replaying a CryptnoxTrace capture, for host builds.
+ *
+ * Plugged into the wallet through the mock link constructor, it answers the
+ * PN532 commands of begin() and card detection itself (one ISO-DEP card,
+ * 106 kbps only) and serves each APDU the response recorded at the same
+ * rank in a pcap file written by CryptnoxTrace::dump(). The wallet code
+ * above the driver runs unchanged, so its CPU cost can be profiled on a PC.
+ *
+ * The card is not emulated: responses are not computed from the commands.
+ * The host's nonces and ephemeral keys differ from the recorded ones, so
+ * the checks tied to them (card certificate signature against a card key
+ * provider, MUTUALLY AUTHENTICATE MAC) fail as with a wrong card, after the
+ * same amount of work. Record with CRYPTNOX_TRACE_CAPTURE_SIZE=255: longer
+ * responses are replayed with their missing bytes set to zero.
+ */
+
+/** @brief setLatency() value replaying the command-to-response gaps of the capture. */
+#define CRYPTNOX_REPLAY_RECORDED_LATENCY   0xFFFFFFFFUL
+
+#define CRYPTNOX_REPLAY_UID_MAX_SIZE       10U
+
+/** @brief Longest host frame: packet buffer plus framing. */
+#define CRYPTNOX_REPLAY_INBOX_SIZE         (PN532_PACKBUFFSIZ + 8U)
+/** @brief ACK frame followed by the longest response frame. */
+#define CRYPTNOX_REPLAY_OUTBOX_SIZE        (6U + PN532_PACKBUFFSIZ)
+
+/**
+ * @class CryptnoxReplayLink
+ * @brief Mock PN532 link replaying recorded card responses.
+ */
+class CryptnoxReplayLink : public Adafruit_PN532_MockLink {
+public:
+    CryptnoxReplayLink();
+
+    /**
+     * @brief Use a capture written by CryptnoxTrace::dump().
+     *
+     * The data is not copied and must stay valid while the link is in use.
+     * Replay starts at the first record.
+     *
+     * @param pcap File contents.
+     * @param length File size in bytes.
+     * @return false if this is not a CryptnoxTrace pcap file.
+     */
+    bool load(const uint8_t* pcap, size_t length);
+
+    /** @brief Replay from the first record again, e.g. before each benchmark round. */
+    void rewind();
+
+    /**
+     * @brief Set the time the emulated PN532 takes to answer.
+     *
+     * The ACK frame is always available at once.
+     *
+     * @param commandMicros Delay of the answers to non-APDU commands (configuration, detection).
+     * @param exchangeMicros Delay of the APDU responses, CRYPTNOX_REPLAY_RECORDED_LATENCY
+     *        to reproduce the gaps of the capture.
+     */
+    void setLatency(uint32_t commandMicros, uint32_t exchangeMicros);
+
+    /**
+     * @brief Set the NFCID of the emulated card (7-byte default).
+     *
+     * @param uid Card identifier.
+     * @param uidLength 4, 7 or 10 bytes.
+     * @return false if the length is not supported.
+     */
+    bool setUid(const uint8_t* uid, uint8_t uidLength);
+
+    /** @brief Number of APDU responses replayed since the last rewind(). */
+    uint16_t replayed() const;
+
+    /** @brief APDUs whose CLA INS P1 P2 differed from the recorded command since the last rewind(). */
+    uint16_t mismatches() const;
+
+    /** @brief true once every recorded response has been replayed; the card then stops answering. */
+    bool exhausted() const;
+
+    void begin(void) override;
+    void write(const uint8_t *data, size_t len) override;
+    int available(void) override;
+    int read(void) override;
+
+private:
+    /** @brief One record of the capture. */
+    struct Record {
+        uint32_t micros;        /**< Timestamp */
+        uint8_t direction;      /**< CryptnoxTraceDirection */
+        uint8_t status;         /**< PN532 exchange error */
+        uint16_t length;        /**< Original length */
+        const uint8_t* data;    /**< Captured bytes */
+        uint16_t captured;      /**< Number of captured bytes */
+    };
+
+    bool nextRecord(uint8_t direction, Record &record);
+    void handleFrame(const uint8_t* data, uint8_t length);
+    void handleDataExchange(const uint8_t* data, uint8_t length);
+    void replayResponse();
+    void serveResponseChunk(uint32_t latency);
+    uint8_t putTarget(uint8_t* out) const;
+    void respond(uint8_t command, const uint8_t* data, uint8_t length, uint32_t latency);
+
+    const uint8_t* trace;       /**< pcap file */
+    size_t traceLength;
+    size_t cursor;              /**< Offset of the next record */
+    uint16_t replayCount;
+    uint16_t mismatchCount;
+
+    uint32_t commandLatency;
+    uint32_t exchangeLatency;
+    uint8_t uid[CRYPTNOX_REPLAY_UID_MAX_SIZE];
+    uint8_t uidLength;
+
+    uint8_t commandHeader[4];   /**< CLA INS P1 P2 of the APDU being received */
+    bool inCommand;             /**< Chained APDU frames received, last one pending */
+
+    Record pending;             /**< Response being served across chained frames */
+    uint16_t pendingOffset;
+
+    uint8_t inbox[CRYPTNOX_REPLAY_INBOX_SIZE];
+    uint16_t inboxLength;
+    uint8_t outbox[CRYPTNOX_REPLAY_OUTBOX_SIZE];
+    uint16_t outboxLength;
+    uint16_t outboxRead;
+    uint16_t ackLength;         /**< Bytes of the outbox available at once */
+    uint32_t answerStart;
+    uint32_t answerLatency;
+};
+
+#endif // CRYPTNOXREPLAYLINK_H
@@ -0,0 +1,55 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxScratch.h"
+
+#define SCRATCH_ALIGNMENT    4U
+
+CryptnoxScratch::CryptnoxScratch()
+    : top(0U), highWater(0U) {
+    clean(storage, sizeof(storage));
+}
+
+CryptnoxScratch::~CryptnoxScratch() {
+    clean(storage, sizeof(storage));
+}
+
+/**
+ * @brief Allocate a 4-byte aligned block from the top of the arena.
+ *
+ * @param size Block size in bytes.
+ * @return Pointer to the block, nullptr if the arena is exhausted.
+ */
+uint8_t* CryptnoxScratch::alloc(size_t size) {
+    uint8_t* ret = nullptr;
+    size_t rounded = (size + (SCRATCH_ALIGNMENT - 1U)) & ~(size_t)(SCRATCH_ALIGNMENT - 1U);
+
+    if ((rounded >= size) && (rounded <= (sizeof(storage) - top))) {
+        ret = reinterpret_cast<uint8_t*>(storage) + top;
+        top += rounded;
+        if (top > highWater) {
+            highWater = top;
+        }
+    }
+
+    return ret;
+}
+
+size_t CryptnoxScratch::mark() const {
+    return top;
+}
+
+/**
+ * @brief Free and wipe everything allocated since a mark.
+ *
+ * @param level Value returned by mark(), ignored if above the current level.
+ */
+void CryptnoxScratch::release(size_t level) {
+    if (level < top) {
+        clean(reinterpret_cast<uint8_t*>(storage) + level, top - level);
+        top = level;
+    }
+}
+
+size_t CryptnoxScratch::peak() const {
+    return highWater;
+}
@@ -0,0 +1,125 @@
+#ifndef CRYPTNOXSCRATCH_H
+#define CRYPTNOXSCRATCH_H
+
+#include <Arduino.h>
+#include "uECC.h"
+
+/**
+ * @def CRYPTNOX_SCRATCH_SIZE
+ * @brief Size in bytes of the wallet scratch arena.
+ *
+ * Covers the deepest handshake path (certificate, keys, shared secret and the
+ * protected MUTUALLY AUTHENTICATE buffer; the KDF hashes in place) as well as
+ * a batch work buffer.
+ * uECC_LOW_STACK builds add the micro-ecc temporaries (see CryptnoxEccScratch).
+ */
+#ifndef CRYPTNOX_SCRATCH_SIZE
+#if uECC_LOW_STACK
+#define CRYPTNOX_SCRATCH_SIZE       (384U + uECC_SCRATCH_SIZE)
+#else
+#define CRYPTNOX_SCRATCH_SIZE       384U
+#endif
+#endif
+
+/**
+ * @class CryptnoxScratch
+ * @brief Statically sized stack-like arena for APDU and crypto scratch buffers.
+ *
+ * Allocations are taken from the top of the arena and released in reverse
+ * order through CryptnoxScratchScope. Released bytes are wiped, so key material
+ * does not linger. Peak usage is tracked to size CRYPTNOX_SCRATCH_SIZE.
+ */
+class CryptnoxScratch {
+public:
+    /** @brief Construct an empty arena. */
+    CryptnoxScratch();
+
+    /** @brief Wipe the arena. */
+    ~CryptnoxScratch();
+
+    /**
+     * @brief Allocate a 4-byte aligned block.
+     * @param size Block size in bytes.
+     * @return Pointer to the block, nullptr if the arena is exhausted.
+     */
+    uint8_t* alloc(size_t size);
+
+    /** @brief Current allocation level, to be passed to release(). */
+    size_t mark() const;
+
+    /**
+     * @brief Free and wipe everything allocated since a mark.
+     * @param level Value returned by mark().
+     */
+    void release(size_t level);
+
+    /** @brief Highest allocation level reached, in bytes. */
+    size_t peak() const;
+
+private:
+    uint32_t storage[(CRYPTNOX_SCRATCH_SIZE + 3U) / 4U];  /**< Arena, word aligned */
+    size_t top;                                         /**< Allocation level */
+    size_t highWater;                                   /**< Peak allocation level */
+};
+
+/**
+ * @class CryptnoxScratchScope
+ * @brief Releases every allocation of a phase when it goes out of scope.
+ */
+class CryptnoxScratchScope {
+public:
+    /** @brief Remember the arena level at the start of the phase. */
+    explicit CryptnoxScratchScope(CryptnoxScratch &arena)
+        : arena(arena), level(arena.mark()) {}
+
+    /** @brief Release and wipe the phase allocations. */
+    ~CryptnoxScratchScope() {
+        arena.release(level);
+    }
+
+    /** @brief Allocate a block for this phase, see CryptnoxScratch::alloc(). */
+    uint8_t* alloc(size_t size) {
+        return arena.alloc(size);
+    }
+
+private:
+    CryptnoxScratch &arena;     /**< Arena the phase allocates from */
+    size_t level;               /**< Level to restore */
+
+    CryptnoxScratchScope(const CryptnoxScratchScope&);
+    CryptnoxScratchScope& operator=(const CryptnoxScratchScope&);
+};
+
+/**
+ * @class CryptnoxEccScratch
+ * @brief Lends uECC_SCRATCH_SIZE bytes of a phase to micro-ecc while in scope.
+ *
+ * In uECC_LOW_STACK builds the large ECC temporaries then come from the wallet
+ * arena instead of the stack, and are wiped with the rest of the phase. If the
+ * arena is exhausted the ECC calls fail. Other builds compile this to nothing.
+ */
+class CryptnoxEccScratch {
+public:
+    /** @brief Allocate the ECC scratch from a phase and hand it to micro-ecc. */
+    explicit CryptnoxEccScratch(CryptnoxScratchScope &phase) {
+#if uECC_LOW_STACK
+        uint8_t* block = phase.alloc(uECC_SCRATCH_SIZE);
+        uECC_set_scratch(block, (block != nullptr) ? uECC_SCRATCH_SIZE : 0U);
+#else
+        (void)phase;
+#endif
+    }
+
+    /** @brief Take the scratch back from micro-ecc. */
+    ~CryptnoxEccScratch() {
+#if uECC_LOW_STACK
+        uECC_set_scratch(nullptr, 0U);
+#endif
+    }
+
+private:
+    CryptnoxEccScratch(const CryptnoxEccScratch&);
+    CryptnoxEccScratch& operator=(const CryptnoxEccScratch&);
+};
+
+#endif // CRYPTNOXSCRATCH_H
@@ -0,0 +1,252 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxSession.h"
+
+/* Cryptnox secure channel starts chaining from an IV filled with 0x01 */
+#define SESSION_INITIAL_IV_BYTE    0x01U
+
+CryptnoxSession::CryptnoxSession()
+    : idLength(0U), established(false) {
+    clean(kEnc, sizeof(kEnc));
+    clean(kMac, sizeof(kMac));
+    clean(iv, sizeof(iv));
+    clean(id, sizeof(id));
+}
+
+CryptnoxSession::~CryptnoxSession() {
+    close();
+}
+
+/**
+ * @brief Bind the session to a card before the handshake.
+ *
+ * @param cardId Pointer to the card identifier (NFCID), may be nullptr.
+ * @param cardIdLength Length of the identifier in bytes.
+ */
+void CryptnoxSession::begin(const uint8_t* cardId, uint8_t cardIdLength) {
+    close();
+
+    if (cardId != nullptr) {
+        if (cardIdLength > CRYPTNOX_SESSION_CARD_ID_SIZE) {
+            cardIdLength = CRYPTNOX_SESSION_CARD_ID_SIZE;
+        }
+        memcpy(id, cardId, cardIdLength);
+        idLength = cardIdLength;
+    }
+}
+
+/**
+ * @brief Mark the session as established and reset the chaining value.
+ */
+void CryptnoxSession::open() {
+#if CRYPTNOX_SM_KEYED_CIPHERS
+    encCipher.setKey(kEnc, sizeof(kEnc));
+    macCipher.setKey(kMac, sizeof(kMac));
+#endif
+    memset(iv, SESSION_INITIAL_IV_BYTE, sizeof(iv));
+    established = true;
+}
+
+/**
+ * @brief Wipe all session material.
+ */
+void CryptnoxSession::close() {
+#if CRYPTNOX_SM_KEYED_CIPHERS
+    encCipher.clear();
+    macCipher.clear();
+#else
+    cipher.clear();
+#endif
+    clean(kEnc, sizeof(kEnc));
+    clean(kMac, sizeof(kMac));
+    clean(iv, sizeof(iv));
+    clean(id, sizeof(id));
+    idLength = 0U;
+    established = false;
+}
+
+bool CryptnoxSession::isOpen() const {
+    return established;
+}
+
+/**
+ * @brief Protect a command APDU in place (pad, encrypt with Kenc, MAC with Kmac).
+ *
+ * @param[in,out] apdu Header at offset 0, plain data at CRYPTNOX_SM_DATA_OFFSET.
+ * @param[in] dataLength Length of the plain command data in bytes.
+ * @param[in] bufferSize Total size of the apdu buffer in bytes.
+ * @param[out] apduLength Length of the protected APDU to send.
+ * @return true if the command was protected, false otherwise.
+ */
+bool CryptnoxSession::wrapCommand(uint8_t* apdu, uint8_t dataLength, uint8_t bufferSize, uint8_t &apduLength) {
+    bool ret = false;
+    /* Method 2 padding always appends at least the 0x80 byte */
+    size_t paddedLength = ((size_t)dataLength + CRYPTNOX_SM_BLOCK_SIZE) & ~((size_t)CRYPTNOX_SM_BLOCK_SIZE - 1U);
+    size_t totalLength = CRYPTNOX_SM_DATA_OFFSET + paddedLength;
+
+    if ((established == true) && (apdu != nullptr) && (totalLength <= bufferSize)) {
+        uint8_t* data = apdu + CRYPTNOX_SM_DATA_OFFSET;
+        const uint8_t* chain = iv;
+        AES256& enc = encryptionCipher();
+        uint8_t meta[CRYPTNOX_SM_BLOCK_SIZE];
+        size_t offset;
+        uint8_t i;
+
+        /* ISO/IEC 9797-1 method 2 padding */
+        data[dataLength] = 0x80U;
+        memset(data + dataLength + 1U, 0, paddedLength - dataLength - 1U);
+
+        /* AES-CBC encryption in place, IV = last MAC */
+        for (offset = 0U; offset < paddedLength; offset += CRYPTNOX_SM_BLOCK_SIZE) {
+            for (i = 0U; i < CRYPTNOX_SM_BLOCK_SIZE; i++) {
+                data[offset + i] ^= chain[i];
+            }
+            enc.encryptBlock(data + offset, data + offset);
+            chain = data + offset;
+        }
+
+        /* Lc covers MAC and cryptogram */
+        apdu[CRYPTNOX_SM_HEADER_SIZE - 1U] = (uint8_t)(CRYPTNOX_SM_MAC_SIZE + paddedLength);
+
+        /* MAC over the header block and the cryptogram, stored in front of the cryptogram */
+        memset(meta, 0, sizeof(meta));
+        memcpy(meta, apdu, CRYPTNOX_SM_HEADER_SIZE);
+        computeMac(meta, data, paddedLength, apdu + CRYPTNOX_SM_HEADER_SIZE);
+        memcpy(iv, apdu + CRYPTNOX_SM_HEADER_SIZE, sizeof(iv));
+
+        apduLength = (uint8_t)totalLength;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Verify and decrypt a protected response APDU in place.
+ *
+ * @param[in,out] response Buffer holding MAC || cryptogram || SW1 SW2.
+ * @param[in,out] responseLength Input: received length; Output: plain data length.
+ * @return true if the MAC matched and the data was decrypted, false otherwise.
+ */
+bool CryptnoxSession::unwrapResponse(uint8_t* response, uint8_t &responseLength) {
+    bool ret = false;
+
+    if ((established == true) && (response != nullptr) &&
+        (responseLength >= (CRYPTNOX_SM_MAC_SIZE + CRYPTNOX_SM_BLOCK_SIZE + 2U))) {
+        size_t protectedLength = (size_t)responseLength - 2U;
+        size_t cryptogramLength = protectedLength - CRYPTNOX_SM_MAC_SIZE;
+        uint8_t* data = response + CRYPTNOX_SM_MAC_SIZE;
+        uint8_t meta[CRYPTNOX_SM_BLOCK_SIZE];
+        uint8_t mac[CRYPTNOX_SM_MAC_SIZE];
+
+        if ((cryptogramLength % CRYPTNOX_SM_BLOCK_SIZE) == 0U) {
+            /* Response MAC covers the protected data length and the cryptogram */
+            memset(meta, 0, sizeof(meta));
+            meta[0] = (uint8_t)protectedLength;
+            computeMac(meta, data, cryptogramLength, mac);
+
+            if (secure_compare(mac, response, CRYPTNOX_SM_MAC_SIZE)) {
+                uint8_t chain[CRYPTNOX_SM_BLOCK_SIZE];
+                uint8_t saved[CRYPTNOX_SM_BLOCK_SIZE];
+                size_t offset;
+                size_t plainLength;
+                uint8_t i;
+                AES256& dec = encryptionCipher();
+
+                /* AES-CBC decryption in place, IV = command MAC */
+                memcpy(chain, iv, sizeof(chain));
+                for (offset = 0U; offset < cryptogramLength; offset += CRYPTNOX_SM_BLOCK_SIZE) {
+                    memcpy(saved, data + offset, sizeof(saved));
+                    dec.decryptBlock(data + offset, data + offset);
+                    for (i = 0U; i < CRYPTNOX_SM_BLOCK_SIZE; i++) {
+                        data[offset + i] ^= chain[i];
+                    }
+                    memcpy(chain, saved, sizeof(chain));
+                }
+                memcpy(iv, response, sizeof(iv));
+
+                /* Strip ISO/IEC 9797-1 method 2 padding */
+                plainLength = cryptogramLength;
+                while ((plainLength > 0U) && (data[plainLength - 1U] == 0x00U)) {
+                    plainLength--;
+                }
+                if ((plainLength > 0U) && (data[plainLength - 1U] == 0x80U)) {
+                    plainLength--;
+                    memmove(response, data, plainLength);
+                    responseLength = (uint8_t)plainLength;
+                    ret = true;
+                }
+                clean(chain, sizeof(chain));
+                clean(saved, sizeof(saved));
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief AES-CBC-MAC (zero IV) over a metadata block followed by a cryptogram.
+ *
+ * @param meta 16-byte metadata block.
+ * @param data Cryptogram, length multiple of CRYPTNOX_SM_BLOCK_SIZE.
+ * @param length Cryptogram length in bytes.
+ * @param mac Output buffer for the 16-byte MAC.
+ */
+void CryptnoxSession::computeMac(const uint8_t* meta, const uint8_t* data, size_t length, uint8_t* mac) {
+    size_t offset;
+    uint8_t i;
+    AES256& cbcMac = authenticationCipher();
+
+    cbcMac.encryptBlock(mac, meta);
+    for (offset = 0U; offset < length; offset += CRYPTNOX_SM_BLOCK_SIZE) {
+        for (i = 0U; i < CRYPTNOX_SM_BLOCK_SIZE; i++) {
+            mac[i] ^= data[offset + i];
+        }
+        cbcMac.encryptBlock(mac, mac);
+    }
+}
+
+/**
+ * @brief Block cipher ready to encrypt or decrypt with Kenc.
+ *
+ * @return The Kenc context, or the shared context re-keyed with Kenc.
+ */
+AES256& CryptnoxSession::encryptionCipher() {
+#if CRYPTNOX_SM_KEYED_CIPHERS
+    return encCipher;
+#else
+    cipher.setKey(kEnc, sizeof(kEnc));
+    return cipher;
+#endif
+}
+
+/**
+ * @brief Block cipher ready to compute the CBC-MAC with Kmac.
+ *
+ * @return The Kmac context, or the shared context re-keyed with Kmac.
+ */
+AES256& CryptnoxSession::authenticationCipher() {
+#if CRYPTNOX_SM_KEYED_CIPHERS
+    return macCipher;
+#else
+    cipher.setKey(kMac, sizeof(kMac));
+    return cipher;
+#endif
+}
+
+uint8_t* CryptnoxSession::encryptionKey() {
+    return kEnc;
+}
+
+uint8_t* CryptnoxSession::macKey() {
+    return kMac;
+}
+
+const uint8_t* CryptnoxSession::cardId() const {
+    return id;
+}
+
+uint8_t CryptnoxSession::cardIdLength() const {
+    return idLength;
+}
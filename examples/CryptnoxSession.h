@@ -0,0 +1,151 @@
+#ifndef CRYPTNOXSESSION_H
+#define CRYPTNOXSESSION_H
+
+#include <Arduino.h>
+#include <AES.h>
+
+#define CRYPTNOX_SESSION_KEY_SIZE        32
+#define CRYPTNOX_SESSION_IV_SIZE         16
+#define CRYPTNOX_SESSION_CARD_ID_SIZE    10
+
+/* Secure messaging command layout: CLA INS P1 P2 Lc | MAC | encrypted data */
+#define CRYPTNOX_SM_HEADER_SIZE           5
+#define CRYPTNOX_SM_MAC_SIZE             16
+#define CRYPTNOX_SM_BLOCK_SIZE           16
+#define CRYPTNOX_SM_DATA_OFFSET          (CRYPTNOX_SM_HEADER_SIZE + CRYPTNOX_SM_MAC_SIZE)
+
+/**
+ * @def CRYPTNOX_SM_KEYED_CIPHERS
+ * @brief Keep one AES-256 context per session key (1) or re-key a single one (0).
+ *
+ * Each protected exchange alternates between Kenc and Kmac, so a single
+ * context runs the AES-256 key expansion four times per APDU. With one
+ * context per key both schedules are expanded once, when the session opens,
+ * for about 250 more bytes of RAM. Defaults to 1 except on AVR.
+ */
+#ifndef CRYPTNOX_SM_KEYED_CIPHERS
+#if defined(__AVR__)
+#define CRYPTNOX_SM_KEYED_CIPHERS    0
+#else
+#define CRYPTNOX_SM_KEYED_CIPHERS    1
+#endif
+#endif
+
+/**
+ * @class CryptnoxSession
+ * @brief Secure channel state shared by every APDU exchanged with one card.
+ *
+ * Holds the session keys derived by the mutual authentication (Kenc/Kmac),
+ * the IV/MAC chaining value and the identifier of the card the keys belong to.
+ * Keeping this state alive between calls lets a terminal issue any number of
+ * wallet commands after a single ECDH handshake.
+ */
+class CryptnoxSession {
+public:
+    /** @brief Construct a closed session. */
+    CryptnoxSession();
+
+    /** @brief Wipe the session keys when the object goes out of scope. */
+    ~CryptnoxSession();
+
+    /**
+     * @brief Bind the session to a card before the handshake.
+     *
+     * Any previously derived keys are wiped.
+     *
+     * @param cardId Pointer to the card identifier (NFCID).
+     * @param cardIdLength Length of the identifier in bytes (truncated to CRYPTNOX_SESSION_CARD_ID_SIZE).
+     */
+    void begin(const uint8_t* cardId, uint8_t cardIdLength);
+
+    /**
+     * @brief Mark the session as established once Kenc/Kmac have been written.
+     *
+     * The chaining value is reset to the secure channel initial IV. With
+     * CRYPTNOX_SM_KEYED_CIPHERS the key schedules are expanded here.
+     */
+    void open();
+
+    /** @brief Wipe keys, chaining value and card identifier. */
+    void close();
+
+    /**
+     * @brief Check whether a secure channel is established.
+     * @return true if the session keys are valid, false otherwise.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Protect a command APDU in place.
+     *
+     * The caller writes CLA/INS/P1/P2 at offset 0 and the plain command data at
+     * CRYPTNOX_SM_DATA_OFFSET. The data is padded (ISO/IEC 9797-1 method 2) and
+     * AES-CBC encrypted with Kenc, Lc is set and the AES-CBC-MAC computed with
+     * Kmac is written in front of the cryptogram. The MAC becomes the new IV.
+     *
+     * @param[in,out] apdu Buffer holding the command, see layout above.
+     * @param[in] dataLength Length of the plain command data in bytes.
+     * @param[in] bufferSize Total size of the apdu buffer in bytes.
+     * @param[out] apduLength Length of the protected APDU to send.
+     * @return true if the command was protected, false if the session is closed or the buffer too small.
+     */
+    bool wrapCommand(uint8_t* apdu, uint8_t dataLength, uint8_t bufferSize, uint8_t &apduLength);
+
+    /**
+     * @brief Verify and decrypt a protected response APDU in place.
+     *
+     * The response is MAC || cryptogram || SW1 SW2. The MAC is checked with Kmac,
+     * the cryptogram is decrypted with Kenc using the command MAC as IV, and the
+     * plain data (padding removed) is moved to the start of the buffer.
+     * The response MAC becomes the new IV.
+     *
+     * @param[in,out] response Buffer holding the response as received from the card.
+     * @param[in,out] responseLength Input: received length; Output: plain data length.
+     * @return true if the MAC matched and the data was decrypted, false otherwise.
+     */
+    bool unwrapResponse(uint8_t* response, uint8_t &responseLength);
+
+    /** @brief Writable 32-byte storage for the encryption key (Kenc). */
+    uint8_t* encryptionKey();
+
+    /** @brief Writable 32-byte storage for the MAC key (Kmac). */
+    uint8_t* macKey();
+
+    /** @brief Identifier of the card this session is bound to. */
+    const uint8_t* cardId() const;
+
+    /** @brief Length of the card identifier in bytes. */
+    uint8_t cardIdLength() const;
+
+private:
+    uint8_t kEnc[CRYPTNOX_SESSION_KEY_SIZE];      /**< Session encryption key */
+    uint8_t kMac[CRYPTNOX_SESSION_KEY_SIZE];      /**< Session MAC key */
+    uint8_t iv[CRYPTNOX_SESSION_IV_SIZE];         /**< IV/MAC chaining value */
+    uint8_t id[CRYPTNOX_SESSION_CARD_ID_SIZE];    /**< Card identifier */
+    uint8_t idLength;                             /**< Card identifier length */
+    bool established;                             /**< true once keys are derived */
+#if CRYPTNOX_SM_KEYED_CIPHERS
+    AES256 encCipher;                             /**< Block cipher keyed with Kenc */
+    AES256 macCipher;                             /**< Block cipher keyed with Kmac */
+#else
+    AES256 cipher;                                /**< Block cipher keyed with Kenc or Kmac */
+#endif
+
+    /** @brief Block cipher keyed with Kenc. */
+    AES256& encryptionCipher();
+
+    /** @brief Block cipher keyed with Kmac. */
+    AES256& authenticationCipher();
+
+    /**
+     * @brief AES-CBC-MAC over one metadata block followed by a cryptogram.
+     *
+     * @param meta 16-byte metadata block.
+     * @param data Cryptogram, length multiple of CRYPTNOX_SM_BLOCK_SIZE.
+     * @param length Cryptogram length in bytes.
+     * @param mac Output buffer for the 16-byte MAC.
+     */
+    void computeMac(const uint8_t* meta, const uint8_t* data, size_t length, uint8_t* mac);
+};
+
+#endif // CRYPTNOXSESSION_H
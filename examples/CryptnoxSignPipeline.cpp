@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include <Crypto.h>
+#include "CryptnoxSignPipeline.h"
+
+CryptnoxSignPipeline::CryptnoxSignPipeline()
+    : total(0U), started(false) {
+    memset(apdu, 0, sizeof(apdu));
+}
+
+CryptnoxSignPipeline::~CryptnoxSignPipeline() {
+    clear();
+}
+
+/* Header first: the command only waits for its digest afterwards */
+void CryptnoxSignPipeline::begin(uint8_t p1, uint8_t p2) {
+    sha.reset();
+    apdu[0] = CRYPTNOX_SIGN_CLA;
+    apdu[1] = CRYPTNOX_SIGN_INS;
+    apdu[2] = p1;
+    apdu[3] = p2;
+    /* Lc is set when the session protects the command */
+    apdu[4] = 0U;
+    total = 0U;
+    started = true;
+}
+
+bool CryptnoxSignPipeline::update(const uint8_t* chunk, size_t length) {
+    bool ret = false;
+
+    if ((started == true) && ((chunk != nullptr) || (length == 0U))) {
+        sha.update(chunk, length);
+        total += (uint32_t)length;
+        ret = true;
+    }
+
+    return ret;
+}
+
+void CryptnoxSignPipeline::clear() {
+    sha.clear();
+    clean(apdu, sizeof(apdu));
+    total = 0U;
+    started = false;
+}
+
+uint8_t* CryptnoxSignPipeline::finish() {
+    sha.finalize(apdu + CRYPTNOX_SM_DATA_OFFSET, CRYPTNOX_SIGN_HASH_SIZE);
+    started = false;
+
+    return apdu;
+}
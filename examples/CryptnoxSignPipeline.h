@@ -0,0 +1,94 @@
+#ifndef CRYPTNOXSIGNPIPELINE_H
+#define CRYPTNOXSIGNPIPELINE_H
+
+#include <Arduino.h>
+#include <SHA256.h>
+#include "CryptnoxSession.h"
+
+#define CRYPTNOX_SIGN_CLA                  0x80U
+#define CRYPTNOX_SIGN_INS                  0xC0U
+#define CRYPTNOX_SIGN_P1_CURRENT_KEY       0x00U    /**< Sign with the current key, no derivation path */
+#define CRYPTNOX_SIGN_P2_ECDSA             0x00U    /**< Plain ECDSA signature */
+#define CRYPTNOX_SIGN_HASH_SIZE            32U
+
+/** @brief Longest DER signature returned by SIGN. */
+#define CRYPTNOX_SIGN_SIGNATURE_MAX_SIZE   72U
+
+/**
+ * @brief Secure APDU buffer of SIGN: the protected command, then in place the
+ *        MAC, the padded signature and inner status word, and SW1 SW2.
+ */
+#define CRYPTNOX_SIGN_BUFFER_SIZE          (CRYPTNOX_SM_DATA_OFFSET + CRYPTNOX_SIGN_SIGNATURE_MAX_SIZE + 2U + CRYPTNOX_SM_BLOCK_SIZE + 2U)
+
+/**
+ * @class CryptnoxSignPipeline
+ * @brief SIGN command built while the transaction arrives.
+ *
+ * Each chunk received over BLE or Serial goes straight into SHA-256 with
+ * update(); the transaction itself is never staged. begin() writes the SIGN
+ * header at the front of the secure APDU buffer, so once the last chunk is
+ * in, CryptnoxWallet::sign() only finalizes the digest into the data slot of
+ * that buffer and sends it.
+ *
+ * @code
+ * CryptnoxSignPipeline pipeline;
+ * pipeline.begin();
+ * while (receiving) {
+ *     pipeline.update(chunk, chunkLength);
+ * }
+ * wallet.sign(pipeline, signature, signatureLength);
+ * @endcode
+ */
+class CryptnoxSignPipeline {
+public:
+    CryptnoxSignPipeline();
+
+    /** @brief Wipe the hash state and the APDU buffer. */
+    ~CryptnoxSignPipeline();
+
+    /**
+     * @brief Start a new transaction.
+     *
+     * @param p1 Key selection, see the Cryptnox card documentation.
+     * @param p2 Signature type.
+     */
+    void begin(uint8_t p1 = CRYPTNOX_SIGN_P1_CURRENT_KEY, uint8_t p2 = CRYPTNOX_SIGN_P2_ECDSA);
+
+    /**
+     * @brief Hash the next chunk of the transaction.
+     *
+     * @param chunk Chunk bytes, not kept.
+     * @param length Chunk length in bytes.
+     * @return false if begin() was not called or the command was already sent.
+     */
+    bool update(const uint8_t* chunk, size_t length);
+
+    /** @brief Number of transaction bytes hashed since begin(). */
+    uint32_t hashedLength() const {
+        return total;
+    }
+
+    /** @brief true between begin() and sign(). */
+    bool isStarted() const {
+        return started;
+    }
+
+    /** @brief Drop the transaction and wipe the buffers. */
+    void clear();
+
+private:
+    friend class CryptnoxWallet;
+
+    /**
+     * @brief Write the digest into the data slot of the prepared command.
+     * @return Secure APDU buffer, header at 0 and digest at CRYPTNOX_SM_DATA_OFFSET.
+     */
+    uint8_t* finish();
+
+    SHA256 sha;                                 /**< Running transaction hash */
+    uint8_t apdu[CRYPTNOX_SIGN_BUFFER_SIZE];    /**< Secure APDU buffer, header written by begin() */
+    uint32_t total;                             /**< Bytes hashed since begin() */
+    bool started;                               /**< begin() called, command not sent yet */
+};
+
+#endif // CRYPTNOXSIGNPIPELINE_H
@@ -0,0 +1,86 @@
+#ifndef CRYPTNOXSPSCQUEUE_H
+#define CRYPTNOXSPSCQUEUE_H
+
+#include <Arduino.h>
+#include <Crypto.h>
+
+/**
+ * @class CryptnoxSpscQueue
+ * @brief Lock-free ring of fixed-size entries between one producer and one consumer.
+ *
+ * The producer only writes @c tail and the consumer only writes @c head, each
+ * with release ordering after touching the entry, so the two sides may run on
+ * different cores without a lock. Entries are copied in and out and wiped once
+ * consumed, as they carry key material.
+ *
+ * @tparam T Entry type, copied with memcpy().
+ * @tparam N Capacity, a power of two up to 128.
+ */
+template <typename T, uint8_t N>
+class CryptnoxSpscQueue {
+public:
+    CryptnoxSpscQueue() : head(0U), tail(0U) {
+        static_assert((N != 0U) && ((N & (N - 1U)) == 0U) && (N <= 128U), "N must be a power of two up to 128");
+        clean(entries, sizeof(entries));
+    }
+
+    ~CryptnoxSpscQueue() {
+        clean(entries, sizeof(entries));
+    }
+
+    /**
+     * @brief Producer side: copy an entry in.
+     * @return false if the queue is full.
+     */
+    bool push(const T& entry) {
+        bool ret = false;
+        uint8_t last = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+        if ((uint8_t)(last - __atomic_load_n(&head, __ATOMIC_ACQUIRE)) < N) {
+            memcpy(&entries[last & (N - 1U)], &entry, sizeof(T));
+            __atomic_store_n(&tail, (uint8_t)(last + 1U), __ATOMIC_RELEASE);
+            ret = true;
+        }
+
+        return ret;
+    }
+
+    /**
+     * @brief Consumer side: copy the oldest entry out and wipe its slot.
+     * @return false if the queue is empty.
+     */
+    bool pop(T& entry) {
+        bool ret = false;
+        uint8_t first = __atomic_load_n(&head, __ATOMIC_RELAXED);
+
+        if (first != __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) {
+            T* slot = &entries[first & (N - 1U)];
+            memcpy(&entry, slot, sizeof(T));
+            clean(slot, sizeof(T));
+            __atomic_store_n(&head, (uint8_t)(first + 1U), __ATOMIC_RELEASE);
+            ret = true;
+        }
+
+        return ret;
+    }
+
+    /** @brief Check whether pop() would fail; exact on the consumer side. */
+    bool empty() const {
+        return (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+    }
+
+    /** @brief Check whether push() would fail; exact on the producer side. */
+    bool full() const {
+        return ((uint8_t)(__atomic_load_n(&tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&head, __ATOMIC_ACQUIRE)) >= N);
+    }
+
+private:
+    T entries[N];               /**< Ring storage */
+    uint8_t head;               /**< Entries consumed, written by the consumer only */
+    uint8_t tail;               /**< Entries produced, written by the producer only */
+
+    CryptnoxSpscQueue(const CryptnoxSpscQueue&);
+    CryptnoxSpscQueue& operator=(const CryptnoxSpscQueue&);
+};
+
+#endif // CRYPTNOXSPSCQUEUE_H
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include "CryptnoxStats.h"
+
+CryptnoxStats::CryptnoxStats() {
+    reset();
+}
+
+void CryptnoxStats::reset() {
+    memset(phases, 0, sizeof(phases));
+#if CRYPTNOX_STATS_HISTOGRAMS
+    uint8_t i;
+
+    for (i = 0U; i < CRYPTNOX_STAT_PHASE_COUNT; i++) {
+        phaseHistograms[i].reset();
+    }
+    for (i = 0U; i < CRYPTNOX_STAT_CMD_COUNT; i++) {
+        commandHistograms[i].reset();
+    }
+#endif
+}
+
+/**
+ * @brief Add one sample to a phase.
+ *
+ * @param phase Timed phase, ignored if out of range.
+ * @param duration Duration in microseconds.
+ */
+void CryptnoxStats::record(CryptnoxStatPhase phase, uint32_t duration) {
+    if (phase < CRYPTNOX_STAT_PHASE_COUNT) {
+        CryptnoxPhaseStats &entry = phases[phase];
+
+        if ((entry.count == 0U) || (duration < entry.min)) {
+            entry.min = duration;
+        }
+        if (duration > entry.max) {
+            entry.max = duration;
+        }
+        entry.last = duration;
+        entry.total += duration;
+        entry.count++;
+#if CRYPTNOX_STATS_HISTOGRAMS
+        phaseHistograms[phase].record(duration);
+#endif
+    }
+}
+
+const CryptnoxPhaseStats& CryptnoxStats::get(CryptnoxStatPhase phase) const {
+    return phases[(phase < CRYPTNOX_STAT_PHASE_COUNT) ? phase : CRYPTNOX_STAT_HANDSHAKE];
+}
+
+/* Instruction byte to timed command */
+void CryptnoxStats::recordCommand(uint8_t ins, uint32_t duration) {
+#if CRYPTNOX_STATS_HISTOGRAMS
+    CryptnoxStatCommand command;
+
+    switch (ins) {
+    case 0xA4U: command = CRYPTNOX_STAT_CMD_SELECT; break;
+    case 0xF8U: command = CRYPTNOX_STAT_CMD_CERTIFICATE; break;
+    case 0x10U: command = CRYPTNOX_STAT_CMD_OPEN_CHANNEL; break;
+    case 0x11U: command = CRYPTNOX_STAT_CMD_AUTHENTICATE; break;
+    case 0xC0U: command = CRYPTNOX_STAT_CMD_SIGN; break;
+    default: command = CRYPTNOX_STAT_CMD_OTHER; break;
+    }
+    commandHistograms[command].record(duration);
+#else
+    (void)ins;
+    (void)duration;
+#endif
+}
+
+#if CRYPTNOX_STATS_HISTOGRAMS
+const CryptnoxHistogram& CryptnoxStats::histogram(CryptnoxStatPhase phase) const {
+    return phaseHistograms[(phase < CRYPTNOX_STAT_PHASE_COUNT) ? phase : CRYPTNOX_STAT_HANDSHAKE];
+}
+
+const CryptnoxHistogram& CryptnoxStats::histogram(CryptnoxStatCommand command) const {
+    return commandHistograms[(command < CRYPTNOX_STAT_CMD_COUNT) ? command : CRYPTNOX_STAT_CMD_OTHER];
+}
+
+/* One metric: id, then the bucket counts little-endian */
+static size_t writeHistogram(Print &out, uint8_t id, const CryptnoxHistogram &histogram) {
+    uint8_t record[1U + (2U * CRYPTNOX_HISTOGRAM_BUCKETS)];
+    uint8_t i;
+
+    record[0] = id;
+    for (i = 0U; i < CRYPTNOX_HISTOGRAM_BUCKETS; i++) {
+        uint16_t count = histogram.count(i);
+
+        record[1U + (2U * i)] = (uint8_t)count;
+        record[2U + (2U * i)] = (uint8_t)(count >> 8U);
+    }
+
+    return out.write(record, sizeof(record));
+}
+#endif
+
+size_t CryptnoxStats::writeHistograms(Print &out) const {
+    uint8_t header[8] = {
+        (uint8_t)CRYPTNOX_STATS_EXPORT_MAGIC[0], (uint8_t)CRYPTNOX_STATS_EXPORT_MAGIC[1],
+        (uint8_t)CRYPTNOX_STATS_EXPORT_MAGIC[2], CRYPTNOX_STATS_EXPORT_VERSION,
+        0U, CRYPTNOX_HISTOGRAM_BUCKETS, CRYPTNOX_HISTOGRAM_FIRST_SHIFT, 0U
+    };
+    size_t ret;
+
+#if CRYPTNOX_STATS_HISTOGRAMS
+    uint8_t i;
+
+    header[4] = CRYPTNOX_STAT_PHASE_COUNT + CRYPTNOX_STAT_CMD_COUNT;
+    ret = out.write(header, sizeof(header));
+    for (i = 0U; i < CRYPTNOX_STAT_PHASE_COUNT; i++) {
+        ret += writeHistogram(out, i, phaseHistograms[i]);
+    }
+    for (i = 0U; i < CRYPTNOX_STAT_CMD_COUNT; i++) {
+        ret += writeHistogram(out, CRYPTNOX_STATS_COMMAND_FLAG | i, commandHistograms[i]);
+    }
+#else
+    ret = out.write(header, sizeof(header));
+#endif
+
+    return ret;
+}
@@ -0,0 +1,165 @@
+#ifndef CRYPTNOXSTATS_H
+#define CRYPTNOXSTATS_H
+
+#include <Arduino.h>
+#include "CryptnoxHistogram.h"
+
+/**
+ * @def CRYPTNOX_STATS
+ * @brief Set to 0 to compile the handshake timing instrumentation out.
+ */
+#ifndef CRYPTNOX_STATS
+#define CRYPTNOX_STATS                1
+#endif
+
+/**
+ * @def CRYPTNOX_STATS_HISTOGRAMS
+ * @brief Set to 1 to keep a latency histogram per phase and per command.
+ *
+ * Adds 2 * CRYPTNOX_HISTOGRAM_BUCKETS bytes of RAM per metric, about 400
+ * bytes with the defaults, so it is off by default on AVR.
+ */
+#ifndef CRYPTNOX_STATS_HISTOGRAMS
+#if defined(__AVR__)
+#define CRYPTNOX_STATS_HISTOGRAMS     0
+#else
+#define CRYPTNOX_STATS_HISTOGRAMS     1
+#endif
+#endif
+
+/** @brief First bytes of a CryptnoxStats::writeHistograms() export. */
+#define CRYPTNOX_STATS_EXPORT_MAGIC   "CXH"
+#define CRYPTNOX_STATS_EXPORT_VERSION 1U
+/** @brief Metric id of a command histogram: this flag or'ed with the CryptnoxStatCommand. */
+#define CRYPTNOX_STATS_COMMAND_FLAG   0x80U
+
+/**
+ * @enum CryptnoxStatPhase
+ * @brief Timed sections of the card handshake.
+ */
+enum CryptnoxStatPhase : uint8_t {
+    CRYPTNOX_STAT_ACK_WAIT = 0,       /**< PN532 command ACK waits */
+    CRYPTNOX_STAT_RF_EXCHANGE,        /**< APDU exchange, ACK wait included */
+    CRYPTNOX_STAT_MAKE_KEY,           /**< uECC_make_key, idle or on demand */
+    CRYPTNOX_STAT_SHARED_SECRET,      /**< uECC_shared_secret */
+    CRYPTNOX_STAT_KDF,                /**< SHA-512 session key derivation */
+    CRYPTNOX_STAT_HANDSHAKE,          /**< Whole processCard() with a card present */
+    CRYPTNOX_STAT_BATCH,              /**< Whole CryptnoxWallet::runBatch() */
+    CRYPTNOX_STAT_PHASE_COUNT
+};
+
+/**
+ * @enum CryptnoxStatCommand
+ * @brief APDU exchanges timed per command, by instruction byte.
+ */
+enum CryptnoxStatCommand : uint8_t {
+    CRYPTNOX_STAT_CMD_SELECT = 0,     /**< SELECT (A4) */
+    CRYPTNOX_STAT_CMD_CERTIFICATE,    /**< GET CARD CERTIFICATE (F8) */
+    CRYPTNOX_STAT_CMD_OPEN_CHANNEL,   /**< OPEN SECURE CHANNEL (10) */
+    CRYPTNOX_STAT_CMD_AUTHENTICATE,   /**< MUTUALLY AUTHENTICATE (11) */
+    CRYPTNOX_STAT_CMD_SIGN,           /**< SIGN (C0) */
+    CRYPTNOX_STAT_CMD_OTHER,          /**< Any other instruction */
+    CRYPTNOX_STAT_CMD_COUNT
+};
+
+/**
+ * @struct CryptnoxPhaseStats
+ * @brief Duration summary of one phase, in microseconds.
+ */
+struct CryptnoxPhaseStats {
+    uint32_t count;      /**< Number of samples */
+    uint32_t last;       /**< Last sample */
+    uint32_t min;        /**< Shortest sample */
+    uint32_t max;        /**< Longest sample */
+    uint32_t total;      /**< Sum of all samples (wraps after ~71 minutes) */
+};
+
+/**
+ * @class CryptnoxStats
+ * @brief Fixed-size per-phase timing statistics.
+ *
+ * Samples are micros() deltas. Recording is a handful of integer operations so
+ * the instrumentation can stay enabled in field builds. With
+ * CRYPTNOX_STATS_HISTOGRAMS each phase and each command also has a
+ * CryptnoxHistogram, for the tail latency the summaries hide.
+ */
+class CryptnoxStats {
+public:
+    /** @brief Construct with all counters cleared. */
+    CryptnoxStats();
+
+    /** @brief Clear all counters. */
+    void reset();
+
+    /**
+     * @brief Add one sample to a phase.
+     * @param phase Timed phase.
+     * @param duration Duration in microseconds.
+     */
+    void record(CryptnoxStatPhase phase, uint32_t duration);
+
+    /**
+     * @brief Summary of one phase.
+     * @param phase Timed phase.
+     * @return Reference to the phase summary.
+     */
+    const CryptnoxPhaseStats& get(CryptnoxStatPhase phase) const;
+
+    /**
+     * @brief Add one APDU exchange to the histogram of its command.
+     * @param ins Instruction byte of the APDU.
+     * @param duration Duration in microseconds.
+     */
+    void recordCommand(uint8_t ins, uint32_t duration);
+
+#if CRYPTNOX_STATS_HISTOGRAMS
+    /**
+     * @brief Latency histogram of one phase.
+     * @param phase Timed phase.
+     * @return Reference to the histogram.
+     */
+    const CryptnoxHistogram& histogram(CryptnoxStatPhase phase) const;
+
+    /**
+     * @brief Latency histogram of one command.
+     * @param command Timed command.
+     * @return Reference to the histogram.
+     */
+    const CryptnoxHistogram& histogram(CryptnoxStatCommand command) const;
+#endif
+
+    /**
+     * @brief Write every histogram in binary, for a collector.
+     *
+     * Layout, integers little-endian:
+     * - "CXH", version (1), metric count, bucket count, first bucket shift, 0
+     * - per metric: id (CryptnoxStatPhase, or CRYPTNOX_STATS_COMMAND_FLAG |
+     *   CryptnoxStatCommand), then one uint16 count per bucket
+     *
+     * The header alone (metric count 0) is written when
+     * CRYPTNOX_STATS_HISTOGRAMS is 0.
+     *
+     * @param out Destination, e.g. Serial.
+     * @return Number of bytes written.
+     */
+    size_t writeHistograms(Print &out) const;
+
+private:
+    CryptnoxPhaseStats phases[CRYPTNOX_STAT_PHASE_COUNT];    /**< One summary per phase */
+#if CRYPTNOX_STATS_HISTOGRAMS
+    CryptnoxHistogram phaseHistograms[CRYPTNOX_STAT_PHASE_COUNT];      /**< Latency distribution per phase */
+    CryptnoxHistogram commandHistograms[CRYPTNOX_STAT_CMD_COUNT];      /**< Latency distribution per command */
+#endif
+};
+
+#if CRYPTNOX_STATS
+/** @brief Start timing a section into a local timestamp. */
+#define CRYPTNOX_STATS_START(start)                 uint32_t start = (uint32_t)micros()
+/** @brief Record the time elapsed since CRYPTNOX_STATS_START. */
+#define CRYPTNOX_STATS_STOP(stats, phase, start)    (stats).record((phase), (uint32_t)micros() - (start))
+#else
+#define CRYPTNOX_STATS_START(start)                 do { } while (0)
+#define CRYPTNOX_STATS_STOP(stats, phase, start)    do { } while (0)
+#endif
+
+#endif // CRYPTNOXSTATS_H
@@ -0,0 +1,181 @@
+#include <Arduino.h>
+#include <string.h>
+#include "CryptnoxTrace.h"
+
+#if CRYPTNOX_TRACE
+
+/* micros() timestamp, direction, status, original length, captured length */
+#define TRACE_RECORD_HEADER      9U
+#define TRACE_CAPTURED_OFFSET    8U
+/* direction, status, original length in the pcap packets */
+#define TRACE_PSEUDO_HEADER      4U
+
+#define PCAP_MAGIC               0xA1B2C3D4UL
+#define PCAP_VERSION_MAJOR       2U
+#define PCAP_VERSION_MINOR       4U
+#define PCAP_LINKTYPE_USER0      147UL
+#define MICROS_PER_SECOND        1000000UL
+
+static_assert(CRYPTNOX_TRACE_CAPTURE_SIZE <= 0xFFU, "The captured length is stored on one byte");
+static_assert(CRYPTNOX_TRACE_RING_SIZE >= (TRACE_RECORD_HEADER + CRYPTNOX_TRACE_CAPTURE_SIZE),
+              "The trace ring must hold at least one full record");
+
+static uint8_t ring[CRYPTNOX_TRACE_RING_SIZE];
+static size_t head = 0U;    /**< Next byte to write */
+static size_t tail = 0U;    /**< Oldest record */
+static size_t used = 0U;    /**< Bytes recorded */
+static uint16_t droppedRecords = 0U;
+
+/* At most two copies per call, around the end of the ring */
+static void ringPut(const uint8_t* data, size_t length) {
+    size_t first = CRYPTNOX_TRACE_RING_SIZE - head;
+
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&ring[head], data, first);
+    memcpy(ring, data + first, length - first);
+    head = (head + length) % CRYPTNOX_TRACE_RING_SIZE;
+    used += length;
+}
+
+static void ringGet(uint8_t* data, size_t length) {
+    size_t first = CRYPTNOX_TRACE_RING_SIZE - tail;
+
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, &ring[tail], first);
+    memcpy(data + first, ring, length - first);
+    tail = (tail + length) % CRYPTNOX_TRACE_RING_SIZE;
+    used -= length;
+}
+
+/* Forget the oldest record to make room */
+static void dropOldest() {
+    size_t length = TRACE_RECORD_HEADER + ring[(tail + TRACE_CAPTURED_OFFSET) % CRYPTNOX_TRACE_RING_SIZE];
+
+    tail = (tail + length) % CRYPTNOX_TRACE_RING_SIZE;
+    used -= length;
+    droppedRecords++;
+}
+
+/* pcap fields in host order: every supported core is little-endian, and readers go by the magic */
+static void writeU32(Print &out, uint32_t value) {
+    out.write((const uint8_t*)&value, sizeof(value));
+}
+
+static void writeU16(Print &out, uint16_t value) {
+    out.write((const uint8_t*)&value, sizeof(value));
+}
+
+/**
+ * @brief Append one record, overwriting the oldest ones if needed.
+ *
+ * @param direction CRYPTNOX_TRACE_COMMAND or CRYPTNOX_TRACE_RESPONSE.
+ * @param data APDU or response bytes.
+ * @param length Number of bytes.
+ * @param status PN532 exchange error of a response, 0 for a command.
+ */
+void CryptnoxTrace::record(CryptnoxTraceDirection direction, const uint8_t* data, size_t length, uint8_t status) {
+    uint8_t header[TRACE_RECORD_HEADER];
+    uint32_t now = (uint32_t)micros();
+    uint16_t total = (length > 0xFFFFU) ? 0xFFFFU : (uint16_t)length;
+    uint8_t captured = (length > CRYPTNOX_TRACE_CAPTURE_SIZE) ? (uint8_t)CRYPTNOX_TRACE_CAPTURE_SIZE : (uint8_t)length;
+
+    if (data == nullptr) {
+        captured = 0U;
+    }
+
+    memcpy(header, &now, sizeof(now));
+    header[4] = (uint8_t)direction;
+    header[5] = status;
+    memcpy(&header[6], &total, sizeof(total));
+    header[TRACE_CAPTURED_OFFSET] = captured;
+
+    while ((CRYPTNOX_TRACE_RING_SIZE - used) < (TRACE_RECORD_HEADER + captured)) {
+        dropOldest();
+    }
+    ringPut(header, TRACE_RECORD_HEADER);
+    if (captured > 0U) {
+        ringPut(data, captured);
+    }
+}
+
+/**
+ * @brief Write the pcap global header, then every record as one packet.
+ *
+ * @param out Binary sink.
+ */
+void CryptnoxTrace::dump(Print &out) {
+    uint8_t header[TRACE_RECORD_HEADER];
+    uint8_t pseudo[TRACE_PSEUDO_HEADER];
+    uint8_t bytes[CRYPTNOX_TRACE_CAPTURE_SIZE];
+
+    writeU32(out, PCAP_MAGIC);
+    writeU16(out, PCAP_VERSION_MAJOR);
+    writeU16(out, PCAP_VERSION_MINOR);
+    writeU32(out, 0U);      /* UTC offset */
+    writeU32(out, 0U);      /* Timestamp accuracy */
+    writeU32(out, TRACE_PSEUDO_HEADER + CRYPTNOX_TRACE_CAPTURE_SIZE);
+    writeU32(out, PCAP_LINKTYPE_USER0);
+
+    while (used >= TRACE_RECORD_HEADER) {
+        uint32_t timestamp;
+        uint16_t total;
+        uint8_t captured;
+
+        ringGet(header, TRACE_RECORD_HEADER);
+        memcpy(&timestamp, header, sizeof(timestamp));
+        memcpy(&total, &header[6], sizeof(total));
+        captured = header[TRACE_CAPTURED_OFFSET];
+        ringGet(bytes, captured);
+
+        pseudo[0] = header[4];
+        pseudo[1] = header[5];
+        pseudo[2] = (uint8_t)(total >> 8);
+        pseudo[3] = (uint8_t)total;
+
+        writeU32(out, timestamp / MICROS_PER_SECOND);
+        writeU32(out, timestamp % MICROS_PER_SECOND);
+        writeU32(out, TRACE_PSEUDO_HEADER + (uint32_t)captured);
+        writeU32(out, TRACE_PSEUDO_HEADER + (uint32_t)total);
+        out.write(pseudo, sizeof(pseudo));
+        out.write(bytes, captured);
+    }
+
+    clear();
+}
+
+void CryptnoxTrace::clear() {
+    head = 0U;
+    tail = 0U;
+    used = 0U;
+    droppedRecords = 0U;
+}
+
+uint16_t CryptnoxTrace::dropped() {
+    return droppedRecords;
+}
+
+#else
+
+void CryptnoxTrace::record(CryptnoxTraceDirection direction, const uint8_t* data, size_t length, uint8_t status) {
+    (void)direction;
+    (void)data;
+    (void)length;
+    (void)status;
+}
+
+void CryptnoxTrace::dump(Print &out) {
+    (void)out;
+}
+
+void CryptnoxTrace::clear() {
+}
+
+uint16_t CryptnoxTrace::dropped() {
+    return 0U;
+}
+
+#endif /* CRYPTNOX_TRACE */
@@ -0,0 +1,88 @@
+#ifndef CRYPTNOXTRACE_H
+#define CRYPTNOXTRACE_H
+
+#include <Arduino.h>
+
+/**
+ * @file CryptnoxTrace.h
+ * @brief Binary APDU trace recorded by PN532Base, dumped as a pcap file.
+ *
+ * Unlike the CRYPTNOX_LOG_HEX dumps, recording only copies the bytes into a
+ * RAM ring (no formatting, no Serial), so the exchange timing stays close to
+ * that of a build without tracing. Set CRYPTNOX_TRACE with a build flag, run
+ * the session, then call CryptnoxTrace::dump() and save the serial output to
+ * a .pcap file. Nothing else may print on that port during the dump.
+ *
+ * pcap layout: link type LINKTYPE_USER0 (147), one packet per APDU or
+ * response, timestamped with micros(). Each packet starts with a 4-byte
+ * pseudo-header: direction (CryptnoxTraceDirection), status (PN532 exchange
+ * error, 0 on success), original length (big-endian, 2 bytes); the APDU
+ * bytes follow, truncated to CRYPTNOX_TRACE_CAPTURE_SIZE.
+ */
+
+/**
+ * @def CRYPTNOX_TRACE
+ * @brief Set to 1 to record every APDU exchanged by PN532Base.
+ */
+#ifndef CRYPTNOX_TRACE
+#define CRYPTNOX_TRACE                 0
+#endif
+
+/** @brief Size in bytes of the trace ring; the oldest records are overwritten. */
+#ifndef CRYPTNOX_TRACE_RING_SIZE
+#define CRYPTNOX_TRACE_RING_SIZE       512U
+#endif
+
+/** @brief Bytes kept per APDU or response, the rest only counts in the length. */
+#ifndef CRYPTNOX_TRACE_CAPTURE_SIZE
+#define CRYPTNOX_TRACE_CAPTURE_SIZE    64U
+#endif
+
+/**
+ * @enum CryptnoxTraceDirection
+ * @brief Direction byte of a trace record.
+ */
+enum CryptnoxTraceDirection : uint8_t {
+    CRYPTNOX_TRACE_COMMAND = 0,   /**< Host to card */
+    CRYPTNOX_TRACE_RESPONSE       /**< Card to host */
+};
+
+/**
+ * @class CryptnoxTrace
+ * @brief RAM ring of timestamped APDUs behind CRYPTNOX_TRACE_RECORD.
+ */
+class CryptnoxTrace {
+public:
+    /**
+     * @brief Append one record, overwriting the oldest ones if needed.
+     *
+     * @param direction CRYPTNOX_TRACE_COMMAND or CRYPTNOX_TRACE_RESPONSE.
+     * @param data APDU or response bytes, may be nullptr when length is 0.
+     * @param length Number of bytes.
+     * @param status PN532 exchange error of a response, 0 for a command.
+     */
+    static void record(CryptnoxTraceDirection direction, const uint8_t* data, size_t length, uint8_t status);
+
+    /**
+     * @brief Write the records as a pcap file and empty the ring.
+     *
+     * @param out Binary sink, e.g. Serial.
+     */
+    static void dump(Print &out);
+
+    /** @brief Drop every record. */
+    static void clear();
+
+    /** @brief Number of records overwritten since the last dump() or clear(). */
+    static uint16_t dropped();
+};
+
+#if CRYPTNOX_TRACE
+/** @brief Record an APDU or a response in the trace ring. */
+#define CRYPTNOX_TRACE_RECORD(direction, data, length, status) \
+    CryptnoxTrace::record((direction), (data), (length), (status))
+#else
+#define CRYPTNOX_TRACE_RECORD(direction, data, length, status) do { } while (0)
+#endif
+
+#endif // CRYPTNOXTRACE_H
@@ -1,66 +1,852 @@
 #include <Arduino.h>
 #include <SHA512.h>
+#include <SHA256.h>
+#include <SHAEsp32.h>
+#include <Crypto.h>
+#include <RNG.h>
 #include "CryptnoxWallet.h"
+#include "CryptnoxLog.h"
+#include "CryptnoxApdu.h"
 
 #define RESPONSE_GETCARDCERTIFICATE_IN_BYTES    148
-#define RESPONSE_SELECT_IN_BYTES                 26
 #define RESPONSE_OPENSECURECHANNEL_IN_BYTES      34
 #define RESPONSE_STATUS_WORDS_IN_BYTES            2
 
 #define OPENSECURECHANNEL_SALT_IN_BYTES            (RESPONSE_OPENSECURECHANNEL_IN_BYTES - RESPONSE_STATUS_WORDS_IN_BYTES)
-#define GETCARDCERTIFICATE_IN_BYTES                (RESPONSE_GETCARDCERTIFICATE_IN_BYTES - RESPONSE_STATUS_WORDS_IN_BYTES)
 
 #define RANDOM_BYTES                              8
 #define COMMON_PAIRING_DATA                        "Cryptnox Basic CommonPairingData"
+#define APDU_P1_OFFSET                            2U
 #define CLIENT_PRIVATE_KEY_SIZE                  32
 #define CLIENT_PUBLIC_KEY_SIZE                   64
+#define CLIENT_COMPRESSED_KEY_SIZE               33
 #define CARDEPHEMERALPUBKEY_SIZE                 64
+#define MUTUALLYAUTHENTICATE_CHALLENGE_SIZE      32
+#define BATCH_BUFFER_SIZE                       255U
+#define CERTIFICATE_HASH_SIZE                   32U
+#define RNG_TAG                                 "Cryptnox Wallet RNG"
+#define RNG_ANALOG_SAMPLES                       16U
+#define CRYPTNOX_AID_SIZE                         7U
+#define SECURE_APDU_BUFFER_SIZE                 (CRYPTNOX_SM_DATA_OFFSET + MUTUALLYAUTHENTICATE_CHALLENGE_SIZE + CRYPTNOX_SM_BLOCK_SIZE + 2)
+
+/* Certificate and KDF hashes: the SHA peripheral where the Crypto library has a backend */
+#if CRYPTO_SHA_ESP32
+typedef SHA256Esp32 CertificateHash;
+typedef SHA512Esp32 SessionKdfHash;
+#else
+typedef SHA256 CertificateHash;
+typedef SHA512 SessionKdfHash;
+#endif
+
+/* Constant command headers, laid out at compile time */
+/* SELECT by name, first or only occurrence */
+typedef CryptnoxApdu<0x00, 0xA4, 0x04, 0x00, CRYPTNOX_AID_SIZE> SelectCommand;
+/* GET CARD CERTIFICATE with an 8-byte nonce */
+typedef CryptnoxApdu<0x80, 0xF8, 0x00, 0x00, RANDOM_BYTES> GetCardCertificateCommand;
+/* OPEN SECURE CHANNEL, P1 = pairing slot (0xFF, set per card), data = 0x04 || X || Y */
+typedef CryptnoxApdu<0x80, 0x10, 0xFF, 0x00, 1U + CLIENT_PUBLIC_KEY_SIZE> OpenSecureChannelCommand;
+/* OPEN SECURE CHANNEL with the SEC1 compressed key, data = 0x02/0x03 || X */
+typedef CryptnoxApdu<0x80, 0x10, 0xFF, 0x00, CLIENT_COMPRESSED_KEY_SIZE> OpenSecureChannelCompressedCommand;
+/* MUTUALLY AUTHENTICATE with a 32-byte challenge */
+typedef CryptnoxApdu<0x80, 0x11, 0x00, 0x00, MUTUALLYAUTHENTICATE_CHALLENGE_SIZE> MutuallyAuthenticateCommand;
+
+/* The common pairing data stands in for the pairing key of unpaired cards */
+static_assert(sizeof(COMMON_PAIRING_DATA) - 1U == CRYPTNOX_PAIRING_KEY_SIZE, "Common pairing data must be a pairing key");
+
+/* Responses the handshake accepts, checked by the driver before any copy */
+static const ApduContract selectContract = { 0x90, 0x00, 0U };
+static const ApduContract certificateContract = { 0x90, 0x00, 0U };
+static const ApduContract openSecureChannelContract = { 0x90, 0x00, OPENSECURECHANNEL_SALT_IN_BYTES };
+
+/* Cryptnox application AID, kept in flash */
+static const uint8_t cryptnoxAid[CRYPTNOX_AID_SIZE] PROGMEM = {
+    0xA0, 0x00, 0x00, 0x10, 0x00, 0x01, 0x12
+};
+
+/* Main NFC handler: a card left on the reader keeps its session, anything else is detected again */
+bool CryptnoxWallet::processCard() {
+    bool ret = false;
 
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_IDLE, false);
+    if (cardStillPresent()) {
+        /* No detection, no handshake: the open session is still valid */
+        lastError = CRYPTNOX_ERROR_SAME_CARD;
+    }
+    else {
+        ret = processNewCard();
+    }
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_IDLE, true);
 
-/* Main NFC handler:
+    return ret;
+}
+
+/* Presence test of the card holding the open session (Diagnose, one short RF frame) */
+bool CryptnoxWallet::cardStillPresent() {
+    bool ret = false;
+
+#if CRYPTNOX_PRESENCE_CHECK
+    if ((cardHeld == true) && (session.isOpen() || (channelPending == true))) {
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, true);
+        ret = driver.inPresenceCheck();
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, false);
+    }
+#endif
+    if (ret == false) {
+        cardHeld = false;
+        channelPending = false;
+    }
+
+    return ret;
+}
+
+/* Detection and handshake:
  * - If ISO-DEP card detected → select app, request certificate, open secure channel.
  * - Otherwise → try reading UID of simple NFC tag.
  */
-bool CryptnoxWallet::processCard() {
+bool CryptnoxWallet::processNewCard() {
     bool ret = false;
-    /* Local response buffer */
-    uint8_t cardCertificate[GETCARDCERTIFICATE_IN_BYTES];
-    uint8_t cardCertificateLength = 0;
-    uint8_t openSecureChannelSalt[OPENSECURECHANNEL_SALT_IN_BYTES];
-
-    uint8_t clientPrivateKey[32];
-    uint8_t clientPublicKey[64];
-    const uECC_Curve_t * sessionCurve = uECC_secp256r1();
 
-    uint8_t cardEphemeralPubKey[CARDEPHEMERALPUBKEY_SIZE];
+    /* Check for ISO-DEP capable target (APDU-capable card), pre-generating keys while polling */
+    driver.setIdleCallback(&idleHook, this);
+#if CRYPTNOX_AUTOPOLL
+    bool isoDep = false;
+    bool found = driver.autoPoll(isoDep, detectTimeout);
+    bool detected = (found == true) && (isoDep == true);
+#else
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, true);
+    bool detected = driver.inListPassiveTarget();
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, false);
+#endif
+    driver.setIdleCallback(nullptr);
+
+    if (detected) {
+        uint8_t cardId[CRYPTNOX_SESSION_CARD_ID_SIZE];
+        uint8_t cardIdLength = 0U;
+        CRYPTNOX_STATS_START(handshakeStart);
+
+        lastTagUidLength = 0U;
+        channelPending = false;
+
+        (void)driver.getInListedUID(cardId, &cardIdLength);
+        (void)driver.negotiateBitrate(maxBitrate);
+
+        /* A new activation invalidates any secure channel held by the card */
+        session.begin(cardId, cardIdLength);
+        pairing = pairings.find(cardId, cardIdLength);
 
-    /* Check for ISO-DEP capable target (APDU-capable card) */
-    if (driver.inListPassiveTarget()) {
         /* Try selecting Cryptnox app */
         if (selectApdu()) {
-            /* Get certificate and establish secure channel */
-            getCardCertificate(cardCertificate, cardCertificateLength);
-            extractCardEphemeralKey(cardCertificate, cardEphemeralPubKey);
-            openSecureChannel(openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve);
-            mutuallyAuthenticate(openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve, cardEphemeralPubKey);
-            ret = true;
+            if (lazySecureChannel == true) {
+                /* Identified: the handshake waits for the first protected command */
+                channelPending = true;
+                ret = true;
+            }
+            else {
+                /* Get certificate and establish secure channel */
+                ret = establishSecureChannel();
+            }
+        }
+
+        if (ret == true) {
+            lastError = CRYPTNOX_ERROR_NONE;
+            /* Checked by the next processCard() instead of a new detection */
+            cardHeld = true;
+        }
+        else if (driver.timedOut()) {
+            lastError = CRYPTNOX_ERROR_TIMEOUT;
+        }
+        else if (driver.getExchangeError() == PN532_EXCHANGE_OVERFLOW) {
+            lastError = CRYPTNOX_ERROR_OVERFLOW;
         }
+        else {
+            lastError = CRYPTNOX_ERROR_FAILED;
+        }
+        CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_HANDSHAKE, handshakeStart);
     }
     else {
         /* Basic tag: read its UID */
-        uint8_t uid[7];
+        uint8_t uid[CRYPTNOX_SESSION_CARD_ID_SIZE];
         uint8_t uidLength;
-        if (driver.readUID(uid, uidLength)) {
-            Serial.print(F("Card UID: "));
-            for (uint8_t i = 0; i < uidLength; i++) {
-                if (uid[i] < 16) Serial.print(F("0"));
-                Serial.print(uid[i], HEX);
-                Serial.print(F(" "));
+
+        session.close();
+#if CRYPTNOX_AUTOPOLL
+        /* Plain tag already found by the same polling cycle */
+        bool tagRead = (found == true) && driver.getInListedUID(uid, &uidLength);
+#else
+        bool tagRead = driver.readUID(uid, uidLength, detectTimeout);
+#endif
+        if (tagRead == false) {
+            lastTagUidLength = 0U;
+            lastError = driver.timedOut() ? CRYPTNOX_ERROR_NO_CARD : CRYPTNOX_ERROR_FAILED;
+        }
+#if CRYPTNOX_PRESENCE_CHECK
+        /* Same tag as last time: it never left the field, report it only once */
+        else if ((uidLength == lastTagUidLength) && (memcmp(uid, lastTagUid, uidLength) == 0)) {
+            lastError = CRYPTNOX_ERROR_SAME_CARD;
+        }
+#endif
+        else {
+            CRYPTNOX_LOG_INFO_HEX(F("Card UID"), uid, uidLength);
+            memcpy(lastTagUid, uid, uidLength);
+            lastTagUidLength = uidLength;
+            lastError = CRYPTNOX_ERROR_NONE;
+        }
+    }
+
+    return ret;
+}
+
+/* Handshake: certificate → card ephemeral key → OPEN SECURE CHANNEL → session keys */
+bool CryptnoxWallet::establishSecureChannel() {
+    bool ret = false;
+    /* Handshake buffers live in the scratch arena and are wiped when the scope ends */
+    CryptnoxScratchScope phase(scratch);
+    /* Certificate response, parsed in place */
+    uint8_t* cardCertificate = phase.alloc(RESPONSE_GETCARDCERTIFICATE_IN_BYTES);
+    uint8_t cardCertificateLength = RESPONSE_GETCARDCERTIFICATE_IN_BYTES;
+    CardCertificateView certificate;
+    uint8_t* openSecureChannelSalt = phase.alloc(OPENSECURECHANNEL_SALT_IN_BYTES);
+
+    uint8_t* clientPrivateKey = phase.alloc(CLIENT_PRIVATE_KEY_SIZE);
+    uint8_t* clientPublicKey = phase.alloc(CLIENT_PUBLIC_KEY_SIZE);
+    const uECC_Curve_t * sessionCurve = uECC_secp256r1();
+
+    if (clientPublicKey == nullptr) {
+        CRYPTNOX_LOG_ERROR(F("Scratch arena exhausted."));
+    }
+    else if ((getCardCertificate(cardCertificate, cardCertificateLength)) &&
+        (certificate.parse(cardCertificate, cardCertificateLength))) {
+        /* The signature is checked while the card computes its OPEN SECURE CHANNEL answer */
+        pendingCertificate = &certificate;
+        certificateValid = false;
+        bool opened = openSecureChannel(openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve);
+        pendingCertificate = nullptr;
+
+        if ((opened == true) && (certificateValid == true)) {
+            CRYPTNOX_LOG_HEX(F("Full Ephemeral Public Key (65 bytes)"), certificate.sessionPublicKey(), CARD_CERTIFICATE_KEY_SIZE);
+            ret = mutuallyAuthenticate(openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve, certificate.sessionPublicKeyXY());
+        }
+    }
+
+    if (ret == false) {
+        session.close();
+    }
+
+    return ret;
+}
+
+/* Deferred handshake, run on the card selected by processCard() */
+bool CryptnoxWallet::ensureSecureChannel() {
+    bool ret = session.isOpen();
+
+    if ((ret == false) && (channelPending == true)) {
+        CRYPTNOX_STATS_START(handshakeStart);
+
+        /* Cleared first: the handshake ends with a protected MUTUALLY AUTHENTICATE */
+        channelPending = false;
+        CRYPTNOX_LOG_INFO(F("Opening deferred secure channel..."));
+        ret = establishSecureChannel();
+        if (ret == false) {
+            /* Same as a failed processCard(): the next one detects the card again */
+            cardHeld = false;
+        }
+        CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_HANDSHAKE, handshakeStart);
+    }
+
+    return ret;
+}
+
+/* PN532 bring-up, IRQ mode when wired, I2C clock, bus timing calibration, bit rate limit and RNG start */
+bool CryptnoxWallet::begin(uint8_t maxRate) {
+    bool ret = driver.begin();
+
+    maxBitrate = maxRate;
+    started = ret;
+
+    if (ret) {
+        uint8_t i;
+        uint16_t sample;
+
+        (void)driver.enableIRQ();
+
+        /* Bounded detection and exchanges, see setDetectionPolicy() */
+        driver.setTimeouts(detectTimeout, exchangeTimeout);
+        if (driver.setPassiveActivationRetries(activationRetries) == false) {
+            CRYPTNOX_LOG_ERROR(F("Passive activation retries not set."));
+        }
+
+#if CRYPTNOX_I2C_CLOCK
+        /* Returns 0 on SPI and HSU, nothing to negotiate there */
+        (void)driver.negotiateI2CClock(CRYPTNOX_I2C_CLOCK);
+#endif
+
+#if CRYPTNOX_SPI_MAX_CLOCK
+        /* Returns 0 on I2C and HSU; bus time shrinks with the clock on long frames */
+        (void)driver.trainSPIClock(CRYPTNOX_SPI_MAX_CLOCK);
+#endif
+
+#if CRYPTNOX_TIMING_CALIBRATION
+        /* Keep the default profile if the PN532 does not answer every sample */
+        if (driver.calibrateTiming() == false) {
+            CRYPTNOX_LOG_INFO(F("PN532 timing calibration skipped."));
+        }
+#endif
+
+        RNG.begin(RNG_TAG);
+#if CRYPTNOX_RNG_BUFFERED
+        RNG.setBufferedMode(true);
+#endif
+        /* Floating analog input: no entropy credited, only mixed into the seed */
+        for (i = 0U; i < RNG_ANALOG_SAMPLES; i++) {
+            sample = (uint16_t)analogRead(0);
+            RNG.stir((const uint8_t*)&sample, sizeof(sample), 0U);
+        }
+
+        /* Read once here: a tap only looks the card up in RAM */
+        if (pairings.begin() == false) {
+            CRYPTNOX_LOG_INFO(F("No pairing storage, pairings kept in RAM."));
+        }
+
+#if CRYPTNOX_DUAL_CORE
+        /* ECC on the other core from now on; the loop core does it while the task is missing */
+        if (worker.begin() == false) {
+            CRYPTNOX_LOG_ERROR(F("ECC worker task not started."));
+        }
+#endif
+    }
+
+    return ret;
+}
+
+/* Diagnose tests: host bus echo, then the antenna when its detector setting is known */
+bool CryptnoxWallet::selfTest() {
+    bool ret = driver.diagnoseLine();
+
+    if (ret == false) {
+        CRYPTNOX_LOG_ERROR(F("PN532 communication line test failed."));
+    }
+#if CRYPTNOX_ANTENNA_DETECTOR
+    else if (driver.diagnoseAntenna(CRYPTNOX_ANTENNA_DETECTOR) == false) {
+        CRYPTNOX_LOG_ERROR(F("PN532 antenna self test failed."));
+        ret = false;
+    }
+#endif
+    else {
+        CRYPTNOX_LOG_INFO(F("PN532 self test passed."));
+    }
+
+    return ret;
+}
+
+void CryptnoxWallet::addNoiseSource(NoiseSource &source) {
+    RNG.addNoiseSource(source);
+}
+
+/* Non-blocking handshake: one step per call */
+CryptnoxPollState CryptnoxWallet::poll() {
+    CryptnoxPollState next = pollStep();
+
+    if (next == CRYPTNOX_POLL_FAILED) {
+        session.close();
+        clean(handshake);
+    }
+    else if (next == CRYPTNOX_POLL_READY) {
+        clean(handshake);
+    }
+    else {
+        /* Handshake still in progress */
+    }
+
+    pollState = next;
+    return pollState;
+}
+
+void CryptnoxWallet::resetPoll() {
+    session.close();
+    cardHeld = false;
+    channelPending = false;
+    clean(handshake);
+    pollState = CRYPTNOX_POLL_IDLE;
+}
+
+void CryptnoxWallet::setDetectionPolicy(uint8_t retries, uint16_t detectTimeoutMs, uint16_t exchangeTimeoutMs) {
+    activationRetries = retries;
+    detectTimeout = detectTimeoutMs;
+    exchangeTimeout = exchangeTimeoutMs;
+    driver.setTimeouts(detectTimeoutMs, exchangeTimeoutMs);
+
+    /* The PN532 only takes commands once begin() brought it up */
+    if (started == true) {
+        (void)driver.setPassiveActivationRetries(retries);
+    }
+}
+
+bool CryptnoxWallet::recover() {
+    resetPoll();
+    return driver.softRecover();
+}
+
+CryptnoxPollState CryptnoxWallet::pollStep() {
+    CryptnoxPollState next = CRYPTNOX_POLL_FAILED;
+    const uECC_Curve_t * sessionCurve = uECC_secp256r1();
+    /* Per-call curve and RNG: no micro-ecc global state is involved */
+    const uECC_Context ecc = { sessionCurve, &uECC_RNG };
+
+    switch (pollState) {
+    case CRYPTNOX_POLL_IDLE:
+    case CRYPTNOX_POLL_FAILED:
+        /* Only waits for the ACK, not for a card */
+        if (driver.startInListPassiveTarget()) {
+            /* The PN532 searches with the field on until isready() */
+            CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, true);
+            next = CRYPTNOX_POLL_DETECTING;
+        }
+        else {
+            next = CRYPTNOX_POLL_IDLE;
+        }
+        break;
+
+    case CRYPTNOX_POLL_DETECTING:
+        if (driver.isready() == false) {
+            /* At most one keypair slice, so the next isready() check comes soon */
+            idle();
+            next = CRYPTNOX_POLL_DETECTING;
+            break;
+        }
+
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_RF, false);
+        if (driver.readInListedPassiveTarget()) {
+            uint8_t cardId[CRYPTNOX_SESSION_CARD_ID_SIZE];
+            uint8_t cardIdLength = 0U;
+
+            channelPending = false;
+            (void)driver.getInListedUID(cardId, &cardIdLength);
+            (void)driver.negotiateBitrate(maxBitrate);
+            session.begin(cardId, cardIdLength);
+            pairing = pairings.find(cardId, cardIdLength);
+            next = CRYPTNOX_POLL_SELECT;
+        }
+        else {
+            next = CRYPTNOX_POLL_IDLE;
+        }
+        break;
+
+    case CRYPTNOX_POLL_SELECT:
+        if (selectApdu()) {
+            next = CRYPTNOX_POLL_CERTIFICATE;
+        }
+        break;
+
+    case CRYPTNOX_POLL_CERTIFICATE: {
+        const uint8_t* cardCertificate = nullptr;
+        uint8_t cardCertificateLength = 0U;
+        CardCertificateView certificate;
+
+        /* Parsed and verified in the PN532 packet buffer, which the next step reuses: keep only X||Y */
+        if ((requestCardCertificate(cardCertificate, cardCertificateLength)) &&
+            (certificate.parse(cardCertificate, cardCertificateLength)) &&
+            (verifyCardCertificate(certificate))) {
+            memcpy(handshake.cardEphemeralPubKey, certificate.sessionPublicKeyXY(), CARDEPHEMERALPUBKEY_SIZE);
+            next = CRYPTNOX_POLL_OPEN_CHANNEL;
+        }
+        break;
+    }
+
+    case CRYPTNOX_POLL_OPEN_CHANNEL:
+        if (openSecureChannel(handshake.salt, handshake.clientPublicKey, handshake.clientPrivateKey, sessionCurve)) {
+            handshake.ecdhTime = 0U;
+            handshake.ecdhTicket = 0U;
+#if CRYPTNOX_DUAL_CORE
+            /* Hand the ECDH to the worker, the loop stays free for the bus */
+            if (worker.running()) {
+                handshake.ecdhTicket = worker.requestSharedSecret(handshake.cardEphemeralPubKey, handshake.clientPrivateKey);
+            }
+#endif
+            /* The private key is only needed until the ECDH request or context is loaded */
+            if ((handshake.ecdhTicket != 0U) ||
+                (uECC_shared_secret_start(&handshake.ecdh, &ecc, handshake.cardEphemeralPubKey, handshake.clientPrivateKey) != 0)) {
+                next = CRYPTNOX_POLL_SHARED_SECRET;
             }
-            Serial.println();
+            clean(handshake.clientPrivateKey, sizeof(handshake.clientPrivateKey));
         }
+        break;
+
+    case CRYPTNOX_POLL_SHARED_SECRET: {
+#if CRYPTNOX_DUAL_CORE
+        /* Computed by the worker: only check for the result */
+        if (handshake.ecdhTicket != 0U) {
+            bool ok = false;
+
+            if (worker.takeSharedSecret(handshake.ecdhTicket, handshake.sharedSecret, ok, handshake.ecdhTime) == false) {
+                next = CRYPTNOX_POLL_SHARED_SECRET;
+            }
+            else if (ok == true) {
+#if CRYPTNOX_STATS
+                stats.record(CRYPTNOX_STAT_SHARED_SECRET, handshake.ecdhTime);
+#endif
+                CRYPTNOX_LOG_INFO(F("ECDH shared secret generated."));
+                next = CRYPTNOX_POLL_AUTHENTICATE;
+            }
+            else {
+                CRYPTNOX_LOG_ERROR(F("ECDH shared secret generation failed!"));
+            }
+            break;
+        }
+#endif
+        uint32_t sliceStart = (uint32_t)micros();
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+        int done = uECC_mult_step(&handshake.ecdh, CRYPTNOX_ECDH_SLICE_BITS);
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+
+        handshake.ecdhTime += (uint32_t)micros() - sliceStart;
+        if (done == 0) {
+            next = CRYPTNOX_POLL_SHARED_SECRET;
+        }
+        else if (uECC_shared_secret_finish(&handshake.ecdh, handshake.sharedSecret) != 0) {
+#if CRYPTNOX_STATS
+            stats.record(CRYPTNOX_STAT_SHARED_SECRET, handshake.ecdhTime);
+#endif
+            CRYPTNOX_LOG_INFO(F("ECDH shared secret generated."));
+            next = CRYPTNOX_POLL_AUTHENTICATE;
+        }
+        else {
+            CRYPTNOX_LOG_ERROR(F("ECDH shared secret generation failed!"));
+        }
+        break;
     }
 
+    case CRYPTNOX_POLL_AUTHENTICATE:
+        if (deriveSessionKeys(handshake.sharedSecret, handshake.salt)) {
+            next = CRYPTNOX_POLL_READY;
+        }
+        break;
+
+    case CRYPTNOX_POLL_READY:
+        next = CRYPTNOX_POLL_READY;
+        break;
+
+    default:
+        next = CRYPTNOX_POLL_FAILED;
+        break;
+    }
+
+    return next;
+}
+
+/* Idle work: harvest entropy and top up the ephemeral keypair pool, one ladder slice per call */
+void CryptnoxWallet::idle() {
+#if CRYPTNOX_DUAL_CORE
+    CryptnoxCryptoWorker::lockRng();
+    RNG.loop();
+    CryptnoxCryptoWorker::unlockRng();
+
+    /* The worker keeps its own keypairs ready */
+    if ((worker.running() == false) && (keyPool.isFull() == false)) {
+#else
+    RNG.loop();
+
+    if (keyPool.isFull() == false) {
+#endif
+        generatePoolKeySlice();
+    }
+}
+
+/* One pool keypair, timed as MAKE_KEY */
+void CryptnoxWallet::generatePoolKey() {
+    CryptnoxScratchScope phase(scratch);
+    CryptnoxEccScratch eccScratch(phase);
+    CRYPTNOX_STATS_START(makeKeyStart);
+
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+    if (keyPool.refill()) {
+        CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_MAKE_KEY, makeKeyStart);
+    }
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+}
+
+/* One slice of a pool keypair; MAKE_KEY records the sum of its slices */
+void CryptnoxWallet::generatePoolKeySlice() {
+    uint32_t sliceStart = (uint32_t)micros();
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+    bool added = keyPool.refillStep(CRYPTNOX_KEYGEN_SLICE_BITS);
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+
+    poolKeyTime += (uint32_t)micros() - sliceStart;
+    if (added == true) {
+#if CRYPTNOX_STATS
+        stats.record(CRYPTNOX_STAT_MAKE_KEY, poolKeyTime);
+#endif
+        poolKeyTime = 0U;
+    }
+}
+
+/* Whole pool in one batch, for setup() */
+bool CryptnoxWallet::prefillKeyPool() {
+    CryptnoxScratchScope phase(scratch);
+    CryptnoxEccScratch eccScratch(phase);
+
+    return keyPool.refillAll();
+}
+
+void CryptnoxWallet::idleHook(void* context) {
+    static_cast<CryptnoxWallet*>(context)->idle();
+}
+
+/* Batch: one work buffer for every command, stop at the first error */
+bool CryptnoxWallet::runBatch(CryptnoxCommandBatch &batch) {
+    uint8_t i;
+
+    /* Deferred handshake first, so its buffers do not stack on the work buffer */
+    for (i = 0U; i < batch.queued; i++) {
+        if (batch.commands[i].secure) {
+            (void)ensureSecureChannel();
+            break;
+        }
+    }
+
+    CryptnoxScratchScope phase(scratch);
+    uint8_t* work = phase.alloc(BATCH_BUFFER_SIZE);
+    bool ok = (work != nullptr);
+    CRYPTNOX_STATS_START(batchStart);
+
+    batch.rewind();
+
+    for (i = 0U; (ok == true) && (i < batch.queued); i++) {
+        CryptnoxBatchCommand &command = batch.commands[i];
+        uint8_t responseLength = 0U;
+
+        memcpy(work, command.header, sizeof(command.header));
+        if (command.secure) {
+            if (command.dataLength > (BATCH_BUFFER_SIZE - CRYPTNOX_SM_DATA_OFFSET - CRYPTNOX_SM_BLOCK_SIZE)) {
+                ok = false;
+            }
+            else {
+                if (command.dataLength > 0U) {
+                    memcpy(work + CRYPTNOX_SM_DATA_OFFSET, command.data, command.dataLength);
+                }
+                /* Decrypted data ends with the card's inner status word */
+                ok = sendSecureApdu(work, command.dataLength, BATCH_BUFFER_SIZE, responseLength);
+            }
+        }
+        else {
+            if (command.dataLength > (BATCH_BUFFER_SIZE - CRYPTNOX_SM_HEADER_SIZE)) {
+                ok = false;
+            }
+            else {
+                work[CRYPTNOX_SM_HEADER_SIZE - 1U] = command.dataLength;
+                if (command.dataLength > 0U) {
+                    memcpy(work + CRYPTNOX_SM_HEADER_SIZE, command.data, command.dataLength);
+                }
+                responseLength = BATCH_BUFFER_SIZE;
+                ok = transmitApdu(work, CRYPTNOX_SM_HEADER_SIZE + command.dataLength, work, responseLength);
+            }
+        }
+
+        if ((ok == true) && (responseLength >= RESPONSE_STATUS_WORDS_IN_BYTES)) {
+            uint8_t dataLength = responseLength - RESPONSE_STATUS_WORDS_IN_BYTES;
+
+            command.statusWord = ((uint16_t)work[dataLength] << 8U) | work[dataLength + 1U];
+            if (dataLength > command.responseSize) {
+                ok = false;
+            }
+            else {
+                if (dataLength > 0U) {
+                    memcpy(command.response, work, dataLength);
+                }
+                command.responseLength = dataLength;
+                ok = (command.statusWord == 0x9000U);
+            }
+        }
+        else {
+            ok = false;
+        }
+
+        if (ok == true) {
+            batch.done++;
+        }
+    }
+
+    CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_BATCH, batchStart);
+
+    return ok;
+}
+
+/* SIGN: the digest lands in the prepared command, which is protected and sent in place */
+bool CryptnoxWallet::sign(CryptnoxSignPipeline &pipeline, uint8_t* signature, uint8_t &signatureLength) {
+    bool ret = false;
+    uint8_t responseLength = 0U;
+
+    if ((pipeline.isStarted() == true) && (signature != nullptr)) {
+        uint8_t* apdu = pipeline.finish();
+
+        CRYPTNOX_LOG_INFO(F("Sending SIGN APDU..."));
+        /* Decrypted data ends with the card's inner status word */
+        if ((sendSecureApdu(apdu, CRYPTNOX_SIGN_HASH_SIZE, CRYPTNOX_SIGN_BUFFER_SIZE, responseLength)) &&
+            (checkStatusWord(apdu, responseLength, 0x90, 0x00))) {
+            uint8_t dataLength = responseLength - RESPONSE_STATUS_WORDS_IN_BYTES;
+
+            if (dataLength <= signatureLength) {
+                memcpy(signature, apdu, dataLength);
+                signatureLength = dataLength;
+                ret = true;
+            }
+            else {
+                CRYPTNOX_LOG_ERROR(F("Signature buffer too small."));
+            }
+        }
+        else {
+            CRYPTNOX_LOG_ERROR(F("APDU sign failed."));
+        }
+    }
+    pipeline.clear();
+
+    return ret;
+}
+
+/* MUTUALLY AUTHENTICATE: protected random challenge proves both sides hold the keys */
+bool CryptnoxWallet::sendAuthenticationChallenge() {
+    CryptnoxScratchScope phase(scratch);
+    uint8_t* apdu = phase.alloc(SECURE_APDU_BUFFER_SIZE);
+    uint8_t responseLength = 0U;
+    bool ret = false;
+
+    if (apdu != nullptr) {
+        /* Lc is rewritten by the session when the challenge is protected */
+        (void)MutuallyAuthenticateCommand::write(apdu);
+        uECC_RNG(apdu + CRYPTNOX_SM_DATA_OFFSET, MUTUALLYAUTHENTICATE_CHALLENGE_SIZE);
+
+        ret = sendSecureApdu(apdu, MUTUALLYAUTHENTICATE_CHALLENGE_SIZE, SECURE_APDU_BUFFER_SIZE, responseLength);
+    }
+
+    return ret;
+}
+
+/* Certificate signature: ECDSA P-256 over SHA-256('C' || nonce || session key) */
+bool CryptnoxWallet::verifyCardCertificate(const CardCertificateView &certificate) {
+    bool ret = true;
+
+    if (cardKeys.hasProvider()) {
+        const uECC_PublicKey* cardKey = cardKeys.get(session.cardId(), session.cardIdLength());
+        uint8_t hash[CERTIFICATE_HASH_SIZE];
+        uint8_t signature[CARD_CERTIFICATE_RAW_SIGNATURE_SIZE];
+
+        ret = false;
+        if (cardKey == nullptr) {
+            CRYPTNOX_LOG_ERROR(F("Unknown card public key."));
+        }
+        else if (certificate.rawSignature(signature) == false) {
+            CRYPTNOX_LOG_ERROR(F("Malformed certificate signature."));
+        }
+        else {
+            CryptnoxScratchScope phase(scratch);
+            CryptnoxEccScratch eccScratch(phase);
+            CertificateHash sha;
+            CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+            sha.update(certificate.signedData(), certificate.signedDataLength());
+            sha.finalize(hash, sizeof(hash));
+
+            ret = (uECC_verify_loaded(cardKey, hash, sizeof(hash), signature) != 0);
+            CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+            if (ret == false) {
+                /* The cached key may be stale: ask the provider again next time */
+                cardKeys.remove(session.cardId(), session.cardIdLength());
+                CRYPTNOX_LOG_ERROR(F("Card certificate signature invalid."));
+            }
+            else {
+                CRYPTNOX_LOG_INFO(F("Card certificate signature verified."));
+            }
+        }
+    }
+
+    return ret;
+}
+
+/* Plain APDU built in the driver frame buffer, timed for getStats() */
+bool CryptnoxWallet::transmitFrame(uint8_t apduLength, const ApduContract& contract,
+                                   const uint8_t* &response, uint8_t &responseLength) {
+    bool ret;
+#if CRYPTNOX_STATS
+    uint32_t ackWaitStart = driver.getAckWaitMicros();
+    /* The packet buffer is overwritten by the answer */
+    uint8_t ins = driver.beginFrame()[1];
+#endif
+    CRYPTNOX_STATS_START(exchangeStart);
+
+    ret = driver.sendFrameAPDUView(apduLength, contract, response, responseLength);
+
+#if CRYPTNOX_STATS
+    uint32_t exchangeTime = (uint32_t)micros() - exchangeStart;
+    stats.record(CRYPTNOX_STAT_RF_EXCHANGE, exchangeTime);
+    stats.recordCommand(ins, exchangeTime);
+    stats.record(CRYPTNOX_STAT_ACK_WAIT, driver.getAckWaitMicros() - ackWaitStart);
+#endif
+
+    return ret;
+}
+
+/* Split-phase frame exchange: host work runs between the ACK and the card's answer */
+bool CryptnoxWallet::transmitFrameOverlapped(uint8_t apduLength, const ApduContract& contract,
+                                             const uint8_t* &response, uint8_t &responseLength) {
+    bool ret = false;
+#if CRYPTNOX_STATS
+    uint32_t ackWaitStart = driver.getAckWaitMicros();
+    uint8_t ins = driver.beginFrame()[1];
+#endif
+    CRYPTNOX_STATS_START(exchangeStart);
+
+    if (driver.beginFrameAPDU(apduLength, contract)) {
+        overlapCardWork();
+        ret = driver.finishFrameAPDUView(contract, response, responseLength);
+    }
+
+#if CRYPTNOX_STATS
+    uint32_t exchangeTime = (uint32_t)micros() - exchangeStart;
+    stats.record(CRYPTNOX_STAT_RF_EXCHANGE, exchangeTime);
+    stats.recordCommand(ins, exchangeTime);
+    stats.record(CRYPTNOX_STAT_ACK_WAIT, driver.getAckWaitMicros() - ackWaitStart);
+#endif
+
+    return ret;
+}
+
+/* Certificate first, it gates the handshake; the keypair is for the next card */
+void CryptnoxWallet::overlapCardWork() {
+    if (pendingCertificate != nullptr) {
+        certificateValid = verifyCardCertificate(*pendingCertificate);
+        pendingCertificate = nullptr;
+    }
+
+#if CRYPTNOX_OVERLAP_KEYGEN
+#if CRYPTNOX_DUAL_CORE
+    /* The worker keeps its own keypairs ready */
+    if ((worker.running() == false) && (keyPool.isFull() == false) && (driver.isExchangeComplete() == false)) {
+#else
+    if ((keyPool.isFull() == false) && (driver.isExchangeComplete() == false)) {
+#endif
+        generatePoolKey();
+    }
+#endif
+}
+
+/* Plain APDU exchange, timed for getStats() */
+bool CryptnoxWallet::transmitApdu(const uint8_t* apdu, uint8_t apduLength, uint8_t* response, uint8_t &responseLength) {
+    bool ret;
+#if CRYPTNOX_STATS
+    uint32_t ackWaitStart = driver.getAckWaitMicros();
+    /* Read first: response may alias apdu */
+    uint8_t ins = apdu[1];
+#endif
+    CRYPTNOX_STATS_START(exchangeStart);
+
+    ret = driver.sendAPDU(apdu, apduLength, response, responseLength);
+
+#if CRYPTNOX_STATS
+    uint32_t exchangeTime = (uint32_t)micros() - exchangeStart;
+    stats.record(CRYPTNOX_STAT_RF_EXCHANGE, exchangeTime);
+    stats.recordCommand(ins, exchangeTime);
+    stats.record(CRYPTNOX_STAT_ACK_WAIT, driver.getAckWaitMicros() - ackWaitStart);
+#endif
+
     return ret;
 }
 
@@ -79,34 +865,32 @@ bool CryptnoxWallet::selectApdu() {
     bool ret = false;
 
     /* Application AID selection command */
-    uint8_t selectApdu[] = {
-        0x00, /* CLA  : ISO interindustry */
-        0xA4, /* INS  : SELECT */
-        0x04, /* P1   : Select by name */
-        0x00, /* P2   : First or only occurrence */
-        0x07, /* Lc   : Length of AID */
-        0xA0, 0x00, 0x00, 0x10, 0x00, 0x01, 0x12  /* AID */
-    };
+    uint8_t* selectApdu = driver.beginFrame();
+    memcpy_P(SelectCommand::write(selectApdu), cryptnoxAid, sizeof(cryptnoxAid));
 
     /* Print APDU */
-    printApdu(selectApdu, sizeof(selectApdu));
+    printApdu(selectApdu, SelectCommand::SIZE);
 
-    /* Response buffer on stack */
-    uint8_t response[RESPONSE_SELECT_IN_BYTES];
-    uint8_t responseLength = sizeof(response);
+    /* Answer read in the packet buffer */
+    const uint8_t* response = nullptr;
+    uint8_t responseLength = 0U;
 
-    Serial.println(F("Sending Select APDU..."));
+    CRYPTNOX_LOG_INFO(F("Sending Select APDU..."));
 
-    /* Send SELECT command */
-    if (driver.sendAPDU(selectApdu, sizeof(selectApdu), response, responseLength)) {
-        if (checkStatusWord(response,responseLength, 0x90, 0x00)) {
-            Serial.println(F("APDU exchange successful!"));
-            ret = true;
-        } else {
-            Serial.println(F("APDU SW1/SW2 not expected. Error."));
+    /* Send SELECT command, the driver checks SW1/SW2 */
+    selectInfoLength = 0U;
+    if (transmitFrame(SelectCommand::SIZE, selectContract, response, responseLength)) {
+        /* Kept for getSelectInfo(), the packet buffer is reused by the next command */
+        selectInfoLength = responseLength - RESPONSE_STATUS_WORDS_IN_BYTES;
+        if (selectInfoLength > CRYPTNOX_SELECT_INFO_SIZE) {
+            selectInfoLength = CRYPTNOX_SELECT_INFO_SIZE;
         }
+        memcpy(selectInfo, response, selectInfoLength);
+
+        CRYPTNOX_LOG_INFO(F("APDU exchange successful!"));
+        ret = true;
     } else {
-        Serial.println(F("APDU select failed."));
+        CRYPTNOX_LOG_ERROR(F("APDU select failed."));
     }
 
     return ret;
@@ -131,52 +915,46 @@ bool CryptnoxWallet::selectApdu() {
  */
 bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardCertificateLength) {
     bool ret = false;
-    uint8_t getCardCertificateResponse[RESPONSE_GETCARDCERTIFICATE_IN_BYTES];
-    uint8_t getCardCertificateResponseLength = sizeof(getCardCertificateResponse);
-    uint8_t randomBytes[RANDOM_BYTES];
-
-    if (cardCertificate != nullptr) {
-        /* APDU template (last 8 bytes replaced by random nonce) */
-        uint8_t getCardCertificateApdu[] = {
-            0x80,  /* CLA */
-            0xF8,  /* INS : GET CARD CERTIFICATE */
-            0x00,  /* P1 */
-            0x00,  /* P2 */
-            0x08,  /* Lc : 8 bytes nonce */
-        };
-
-        /* Generate 8 random bytes */
-        uECC_RNG(randomBytes, RANDOM_BYTES);
-
-        /* Final APDU = header + 8 random bytes */
-        uint8_t fullApdu[sizeof(getCardCertificateApdu) + RANDOM_BYTES];
-        memcpy(fullApdu, getCardCertificateApdu, sizeof(getCardCertificateApdu));
-        memcpy(fullApdu + sizeof(getCardCertificateApdu), randomBytes, RANDOM_BYTES);
-
-        /* Print APDU */
-        printApdu(fullApdu, sizeof(fullApdu));
-
-        Serial.println(F("Sending getCardCertificate APDU..."));
-
-        /* Send APDU */
-        if (driver.sendAPDU(fullApdu, sizeof(fullApdu), getCardCertificateResponse, getCardCertificateResponseLength)) {
-            if (checkStatusWord(getCardCertificateResponse, getCardCertificateResponseLength, 0x90, 0x00)) {
-                /* Remove status word from answer */
-                cardCertificateLength = getCardCertificateResponseLength - RESPONSE_STATUS_WORDS_IN_BYTES;
-
-                /* Copy only the useful data (the salt) into the buffer */
-                memcpy(cardCertificate, getCardCertificateResponse, cardCertificateLength);
-
-                Serial.println(F("APDU exchange successful!"));    
-                ret = true;
-            } else {
-                Serial.println(F("APDU SW1/SW2 not expected. Error."));
-            }
+    const uint8_t* view = nullptr;
+    uint8_t viewLength = 0U;
+
+    if ((cardCertificate != nullptr) && (requestCardCertificate(view, viewLength))) {
+        if (viewLength <= cardCertificateLength) {
+            memcpy(cardCertificate, view, viewLength);
+            cardCertificateLength = viewLength;
+            ret = true;
         } else {
-            Serial.println(F("APDU getCardCertificate failed."));
+            CRYPTNOX_LOG_ERROR(F("Certificate larger than buffer!"));
         }
     }
-    
+
+    return ret;
+}
+
+/* GET CARD CERTIFICATE with a fresh nonce, certificate left in the packet buffer */
+bool CryptnoxWallet::requestCardCertificate(const uint8_t* &cardCertificate, uint8_t &cardCertificateLength) {
+    bool ret = false;
+
+    /* Final APDU = header + 8 random bytes, nonce generated in place */
+    uint8_t* fullApdu = driver.beginFrame();
+    uECC_RNG(GetCardCertificateCommand::write(fullApdu), RANDOM_BYTES);
+
+    /* Print APDU */
+    printApdu(fullApdu, GetCardCertificateCommand::SIZE);
+
+    CRYPTNOX_LOG_INFO(F("Sending getCardCertificate APDU..."));
+
+    /* Send APDU */
+    if (transmitFrame(GetCardCertificateCommand::SIZE, certificateContract, cardCertificate, cardCertificateLength)) {
+        /* Remove status word from answer */
+        cardCertificateLength -= RESPONSE_STATUS_WORDS_IN_BYTES;
+
+        CRYPTNOX_LOG_INFO(F("APDU exchange successful!"));
+        ret = true;
+    } else {
+        CRYPTNOX_LOG_ERROR(F("APDU getCardCertificate failed."));
+    }
+
     return ret;
 }
 
@@ -185,6 +963,8 @@ bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardC
  *
  * This function sends the APDU command to the card to get the session salt, which is
  * required for the subsequent key derivation in the secure channel setup.
+ * The client key is sent compressed while compressedClientKey is set (see
+ * CRYPTNOX_COMPRESSED_CLIENT_KEY), uncompressed otherwise.
  *
  * @param[inout] salt Pointer to a 32-byte buffer where the card-provided salt will be stored.
  * @param[inout] clientPublicKey Buffer to store the client's generated 64-byte public key.
@@ -194,63 +974,90 @@ bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardC
  */
 bool CryptnoxWallet::openSecureChannel(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve) {
     bool ret = false;
-
-    /* ECC setup and random generation */
-    uECC_set_rng(&uECC_RNG);
-
-    /* Generate keypair */
-    bool eccSuccess = uECC_make_key(clientPublicKey, clientPrivateKey, sessionCurve);
+    CryptnoxScratchScope phase(scratch);
+    /* Salt read in the PN532 packet buffer */
+    const uint8_t* response = nullptr;
+    uint8_t responseLength = 0U;
+    /* Own slot of a paired card, the common one otherwise */
+    uint8_t pairingSlot = (pairing != nullptr) ? pairing->slot : CRYPTNOX_PAIRING_SLOT_COMMON;
+
+    bool eccSuccess = false;
+
+    /* Use a keypair pre-generated during idle time if one is ready */
+    if (sessionCurve == keyPool.getCurve()) {
+        eccSuccess = keyPool.take(clientPublicKey, clientPrivateKey);
+    }
+#if CRYPTNOX_DUAL_CORE
+    /* Or one the worker generated while the previous card was on the field */
+    if ((eccSuccess == false) && (sessionCurve == uECC_secp256r1()) && worker.running()) {
+        eccSuccess = worker.takeKeyPair(clientPublicKey, clientPrivateKey);
+    }
+#endif
+
+    if (eccSuccess == false) {
+        const uECC_Context ecc = { sessionCurve, &uECC_RNG };
+        CryptnoxEccScratch eccScratch(phase);
+        CRYPTNOX_STATS_START(makeKeyStart);
+
+        /* Generate keypair */
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+        eccSuccess = (uECC_make_key_ctx(&ecc, clientPublicKey, clientPrivateKey) != 0);
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+        CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_MAKE_KEY, makeKeyStart);
+    }
 
     /* Abort if ECC fails */
     if (!eccSuccess) {
-        Serial.println(F("ECC key generation failed."));
+        CRYPTNOX_LOG_ERROR(F("ECC key generation failed."));
     }
     else {
-        /* APDU header for OPEN SECURE CHANNEL */
-        uint8_t opcApduHeader[] = {
-            0x80,  /* CLA */
-            0x10,  /* INS : OPEN SECURE CHANNEL */
-            0xFF,  /* P1 : pairing slot index */
-            0x00,  /* P2 */
-            0x41,  /* Lc : 1 format byte + 64 public key bytes */
-            0x04   /* ECC uncompressed public key format */
-        };
-
-        /* Construct final APDU */
-        uint8_t fullApdu[sizeof(opcApduHeader) + CLIENT_PUBLIC_KEY_SIZE];
-        memcpy(fullApdu, opcApduHeader, sizeof(opcApduHeader));
-        memcpy(fullApdu + sizeof(opcApduHeader), clientPublicKey, CLIENT_PUBLIC_KEY_SIZE);
-
-        /* Response buffer */
-        uint8_t response[RESPONSE_OPENSECURECHANNEL_IN_BYTES];
-        uint8_t responseLength = sizeof(response);
-
-        /* Print APDU */
-        printApdu(fullApdu, sizeof(fullApdu));
-
-        Serial.println(F("Sending OpenSecureChannel APDU..."));
-
-        /* Send OPC request */
-        if (driver.sendAPDU(fullApdu, sizeof(fullApdu), response, responseLength)) {
-            if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
-                if (responseLength == RESPONSE_OPENSECURECHANNEL_IN_BYTES) {
-                    /* Remove status word from answer */
-                    size_t dataLength = OPENSECURECHANNEL_SALT_IN_BYTES;
-
-                    /* Copy only the useful data (the salt) into the buffer */
-                    memcpy(salt, response, dataLength);
-
-                    Serial.println(F("APDU exchange successful!"));    
-                    ret = true;
-                } 
-                else {
-                    Serial.println(F("Unexpected response size."));
-                }
-            } else {
-                Serial.println(F("APDU SW1/SW2 not expected. Error."));
+        bool sent = false;
+
+        if (compressedClientKey == true) {
+            /* Construct final APDU: header, compressed key 0x02/0x03 || X */
+            uint8_t* fullApdu = driver.beginFrame();
+            uECC_compress(clientPublicKey, OpenSecureChannelCompressedCommand::write(fullApdu), sessionCurve);
+            fullApdu[APDU_P1_OFFSET] = pairingSlot;
+
+            /* Print APDU */
+            printApdu(fullApdu, OpenSecureChannelCompressedCommand::SIZE);
+
+            CRYPTNOX_LOG_INFO(F("Sending OpenSecureChannel APDU (compressed key)..."));
+
+            sent = transmitFrameOverlapped(OpenSecureChannelCompressedCommand::SIZE, openSecureChannelContract, response, responseLength);
+            if ((sent == false) && (driver.getExchangeError() == PN532_EXCHANGE_STATUS)) {
+                /* The card does not take compressed points: stay uncompressed from now on */
+                CRYPTNOX_LOG_INFO(F("Compressed key rejected, sending it uncompressed."));
+                compressedClientKey = false;
             }
+        }
+
+        if ((sent == false) && (compressedClientKey == false)) {
+            /* Construct final APDU: header, uncompressed key format, X||Y */
+            uint8_t* fullApdu = driver.beginFrame();
+            uint8_t* data = OpenSecureChannelCommand::write(fullApdu);
+            fullApdu[APDU_P1_OFFSET] = pairingSlot;
+            data[0] = 0x04;
+            memcpy(data + 1U, clientPublicKey, CLIENT_PUBLIC_KEY_SIZE);
+
+            /* Print APDU */
+            printApdu(fullApdu, OpenSecureChannelCommand::SIZE);
+
+            CRYPTNOX_LOG_INFO(F("Sending OpenSecureChannel APDU..."));
+
+            /* Send OPC request */
+            /* SW1/SW2 and the salt length are checked by the driver */
+            sent = transmitFrameOverlapped(OpenSecureChannelCommand::SIZE, openSecureChannelContract, response, responseLength);
+        }
+
+        if (sent == true) {
+            /* Copy only the useful data (the salt) out of the packet buffer */
+            memcpy(salt, response, OPENSECURECHANNEL_SALT_IN_BYTES);
+
+            CRYPTNOX_LOG_INFO(F("APDU exchange successful!"));
+            ret = true;
         } else {
-            Serial.println(F("APDU exchange failed."));
+            CRYPTNOX_LOG_ERROR(F("APDU exchange failed."));
         }
     }
 
@@ -270,46 +1077,119 @@ bool CryptnoxWallet::openSecureChannel(uint8_t* salt, uint8_t* clientPublicKey,
  * @param[in] cardEphemeralPubKey Pointer to the 65-byte card ephemeral public key ('0x04' prefix + X||Y).
  * @return true if the shared secret was successfully generated, false otherwise.
  */
-bool CryptnoxWallet::mutuallyAuthenticate(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, uint8_t* cardEphemeralPubKey) {
+bool CryptnoxWallet::mutuallyAuthenticate(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, const uint8_t* cardEphemeralPubKey) {
     bool ret = false;
-    uint8_t sharedSecret[32];
-    uint8_t concat[32 + sizeof(COMMON_PAIRING_DATA) - 1 + 32]; /* sharedSecret || pairingKey || salt */
-    uint8_t sha512Output[64];
-    uint8_t Kenc[32];
-    uint8_t Kmac[32];
-    size_t pairingKeyLen;
-    size_t concatLen;
+    /* Intermediate key material, wiped by the scope */
+    CryptnoxScratchScope phase(scratch);
+    uint8_t* sharedSecret = phase.alloc(32U);
+    int eccResult = 0;
 
     /* Generate ECDH shared secret */
-    if (uECC_shared_secret(cardEphemeralPubKey, clientPrivateKey, sharedSecret, sessionCurve) == 0) {
-        Serial.println(F("ECDH shared secret generation failed!"));
-        return false;
+    if (sharedSecret != nullptr) {
+        const uECC_Context ecc = { sessionCurve, &uECC_RNG };
+        CryptnoxEccScratch eccScratch(phase);
+        CRYPTNOX_STATS_START(sharedSecretStart);
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+        eccResult = uECC_shared_secret_ctx(&ecc, cardEphemeralPubKey, clientPrivateKey, sharedSecret);
+        CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+        CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_SHARED_SECRET, sharedSecretStart);
+    }
+
+    if (eccResult == 0) {
+        CRYPTNOX_LOG_ERROR(F("ECDH shared secret generation failed!"));
     }
     else {
-        Serial.println(F("ECDH shared secret generated."));
+        CRYPTNOX_LOG_INFO(F("ECDH shared secret generated."));
+        ret = deriveSessionKeys(sharedSecret, salt);
+    }
 
-        /* Concatenate sharedSecret, pairingKey, and salt */
-        pairingKeyLen = sizeof(COMMON_PAIRING_DATA) - 1U; /* exclude null terminator */
-        concatLen = 32U + pairingKeyLen + 32U;
+    return ret;
+}
 
-        memcpy(concat, sharedSecret, 32U); /* copy sharedSecret */
-        memcpy(concat + 32U, COMMON_PAIRING_DATA, pairingKeyLen); /* copy pairingKey */
-        memcpy(concat + 32U + pairingKeyLen, salt, 32U); /* copy salt */
+/**
+ * @brief Derives the session keys from the ECDH shared secret and confirms them with the card.
+ *
+ * Kenc || Kmac = SHA-512(sharedSecret || pairingKey || salt).
+ *
+ * @param[in] sharedSecret Pointer to the 32-byte ECDH shared secret.
+ * @param[in] salt Pointer to the 32-byte salt received from the card.
+ * @return true if the card accepted the session keys, false otherwise.
+ */
+bool CryptnoxWallet::deriveSessionKeys(const uint8_t* sharedSecret, const uint8_t* salt) {
+    bool ret = false;
+    /* sharedSecret || pairingKey || salt, hashed in place without a concat buffer */
+    const HashInput input[3] = {
+        { sharedSecret, 32U },
+        { (pairing != nullptr) ? (const void*)pairing->key : (const void*)COMMON_PAIRING_DATA,
+          CRYPTNOX_PAIRING_KEY_SIZE }, /* common data without its null terminator */
+        { salt, 32U }
+    };
+    /* First 32 bytes for the encryption key, last 32 bytes for the MAC key */
+    const HashOutput output[2] = {
+        { session.encryptionKey(), CRYPTNOX_SESSION_KEY_SIZE },
+        { session.macKey(), CRYPTNOX_SESSION_KEY_SIZE }
+    };
 
-        /* Calculate SHA-512 over concatenated buffer */
-        SHA512 sha;
-        sha.update(concat, concatLen);
-        sha.finalize(sha512Output, sizeof(sha512Output));
+    SessionKdfHash sha;
 
-        Serial.println(F("SHA-512 calculated."));
+    CRYPTNOX_STATS_START(kdfStart);
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, true);
+    sha.digestv(input, 3U, output, 2U);
+    CRYPTNOX_POWER_MARK(driver, CRYPTNOX_POWER_CPU, false);
+    session.open();
+    CRYPTNOX_STATS_STOP(stats, CRYPTNOX_STAT_KDF, kdfStart);
 
-        /* Split SHA-512 output into Kenc and Kmac */
-        memcpy(Kenc, sha512Output, 32U);       /* first 32 bytes for encryption key */
-        memcpy(Kmac, sha512Output + 32U, 32U); /* last 32 bytes for MAC key */
+    CRYPTNOX_LOG_INFO(F("Kenc and Kmac derived."));
 
-        Serial.println(F("Kenc and Kmac derived."));
+    CRYPTNOX_LOG_INFO(F("Sending MutuallyAuthenticate APDU..."));
 
+    if (sendAuthenticationChallenge()) {
+        CRYPTNOX_LOG_INFO(F("Secure channel established."));
         ret = true;
+    } else {
+        CRYPTNOX_LOG_ERROR(F("Mutual authentication failed."));
+        session.close();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Exchanges a secure-messaging protected APDU in a single buffer.
+ *
+ * The command is wrapped in place by the session, sent, and the response is
+ * received into the same buffer, checked for a 0x90 0x00 status word and
+ * unwrapped in place.
+ *
+ * @param[in,out] buffer APDU buffer shared by command and response.
+ * @param[in] dataLength Length of the plain command data in bytes.
+ * @param[in] bufferSize Total size of the buffer in bytes.
+ * @param[out] responseLength Length of the decrypted response data.
+ * @return true if the exchange succeeded and the response MAC was valid, false otherwise.
+ */
+bool CryptnoxWallet::sendSecureApdu(uint8_t* buffer, uint8_t dataLength, uint8_t bufferSize, uint8_t &responseLength) {
+    bool ret = false;
+    uint8_t apduLength = 0U;
+
+    if ((ensureSecureChannel() == true) && (session.wrapCommand(buffer, dataLength, bufferSize, apduLength))) {
+        responseLength = bufferSize;
+        if (transmitApdu(buffer, apduLength, buffer, responseLength)) {
+            if (checkStatusWord(buffer, responseLength, 0x90, 0x00)) {
+                if (session.unwrapResponse(buffer, responseLength)) {
+                    ret = true;
+                } else {
+                    /* Chaining is lost, the channel must be re-established */
+                    CRYPTNOX_LOG_ERROR(F("Secure messaging: invalid response MAC."));
+                    session.close();
+                }
+            } else {
+                CRYPTNOX_LOG_ERROR(F("APDU SW1/SW2 not expected. Error."));
+            }
+        } else {
+            CRYPTNOX_LOG_ERROR(F("APDU exchange failed."));
+        }
+    } else {
+        CRYPTNOX_LOG_ERROR(F("Secure messaging: no session or buffer too small."));
     }
 
     return ret;
@@ -325,44 +1205,35 @@ bool CryptnoxWallet::mutuallyAuthenticate(uint8_t* salt, uint8_t* clientPublicKe
  */
 int CryptnoxWallet::uECC_RNG(uint8_t *dest, unsigned size) {
     if (dest != nullptr) {
-        /* Seed the RNG once; ideally done once in setup() */
-        static bool seeded = false;
-        if (seeded == false) {
-            randomSeed(analogRead(0));
-            seeded = true;
-        }
-
-        for (uint16_t i = 0u; i < size; i++) {
-            dest[i] = (uint8_t)random(0, 256);
-        }
+#if CRYPTNOX_DUAL_CORE
+        /* Shared with the worker task */
+        CryptnoxCryptoWorker::lockRng();
+        RNG.rand(dest, size);
+        CryptnoxCryptoWorker::unlockRng();
+#else
+        RNG.rand(dest, size);
+#endif
     }
 
     return 1;
 }
 
 /**
- * @brief Print an APDU in hexadecimal format to Serial for debugging.
+ * @brief Trace an APDU in hexadecimal format (debug log level only).
  * 
  * Each byte is printed as 0xXX. Lines wrap every 16 bytes for readability.
  * @param apdu Pointer to the APDU byte array.
  * @param length Number of bytes in the APDU.
- * @param label Optional label to prepend (default: "APDU to send").
+ * @param label Optional flash string label (default: "APDU to send").
  */
-void CryptnoxWallet::printApdu(const uint8_t* apdu, uint8_t length, const char* label) {
-    Serial.print(label);
-    Serial.print(F(": "));
-    Serial.println();
-    for (uint8_t i = 0; i < length; i++) {
-        if (apdu[i] < 16) Serial.print("0");
-        Serial.print("0x");
-        Serial.print(apdu[i], HEX);
-        Serial.print(" ");
-        
-        /* Wrap line every 16 bytes */
-        if ((i + 1) % 16 == 0 && (i + 1) != length) Serial.println();
-    }
-    
-    Serial.println();
+void CryptnoxWallet::printApdu(const uint8_t* apdu, uint8_t length, const __FlashStringHelper* label) {
+#if CRYPTNOX_LOG_LEVEL >= CRYPTNOX_LOG_LEVEL_DEBUG
+    CRYPTNOX_LOG_HEX((label != nullptr) ? label : F("APDU to send"), apdu, length);
+#else
+    (void)apdu;
+    (void)length;
+    (void)label;
+#endif
 }
 
 /**
@@ -378,21 +1249,14 @@ bool CryptnoxWallet::checkStatusWord(const uint8_t* response, uint8_t responseLe
     bool ret = false;
 
     if (response == nullptr || responseLength < 2) {
-        Serial.println(F("checkStatusWord: response too short."));
+        CRYPTNOX_LOG_ERROR(F("checkStatusWord: response too short."));
         ret = false;
     }
     else {
         uint8_t sw1 = response[responseLength - 2];
         uint8_t sw2 = response[responseLength - 1];
 
-        Serial.print(F("Received SW1/SW2: "));
-        Serial.print(F("0x"));
-        if (sw1 < 16) Serial.print("0");
-        Serial.print(sw1, HEX);
-        Serial.print(F(" "));
-        Serial.print(F("0x"));
-        if (sw2 < 16) Serial.print("0");
-        Serial.println(sw2, HEX);
+        CRYPTNOX_LOG_HEX(F("Received SW1/SW2"), response + responseLength - 2, 2U);
 
         if ((sw1 == sw1Expected) && (sw2 == sw2Expected)) {
             ret = true;
@@ -425,42 +1289,19 @@ bool CryptnoxWallet::checkStatusWord(const uint8_t* response, uint8_t responseLe
 bool CryptnoxWallet::extractCardEphemeralKey(const uint8_t* cardCertificate, uint8_t* cardEphemeralPubKey, uint8_t* fullEphemeralPubKey65) {
     bool ret = false;
 
-    Serial.print(F("Full Ephemeral Public Key (65 bytes):"));
-    Serial.println();
-    if ((cardCertificate == nullptr) || (cardEphemeralPubKey == nullptr)) {
-        ret = false; // invalid input
-    }
-    else {
-        const uint8_t keyStart = 1u + 8u; /* skip 'C' and nonce */
-        const uint8_t fullKeyLength = 65u; /* includes 0x04 prefix */
-        uint8_t i;
-
-        for (i = 0u; i < fullKeyLength; i++) {
-            uint8_t b = cardCertificate[keyStart + i];
-
-            /* Copy full key including prefix if buffer provided */
-            if (fullEphemeralPubKey65 != nullptr) {
-                fullEphemeralPubKey65[i] = b;
-            }
-
-            /* Skip the first byte (0x04 prefix) for ECDH */
-            if (i > 0u) {
-                cardEphemeralPubKey[i - 1u] = b;
-            }
-
-            /* Print hex to Serial for debugging */
-            Serial.print("0x");
-            if (b < 0x10u) {
-                Serial.print('0');
-            }
-            Serial.print(b, HEX);
-            Serial.print(' ');
+    if ((cardCertificate != nullptr) && (cardEphemeralPubKey != nullptr)) {
+        const uint8_t* key = cardCertificate + CARD_CERTIFICATE_KEY_OFFSET;
 
-            /* Wrap line every 16 bytes */
-            if ((i + 1) % 16 == 0 && (i + 1) != fullKeyLength) Serial.println();
+        /* Copy full key including prefix if buffer provided */
+        if (fullEphemeralPubKey65 != nullptr) {
+            memcpy(fullEphemeralPubKey65, key, CARD_CERTIFICATE_KEY_SIZE);
         }
 
-        Serial.println();
+        /* Skip the first byte (0x04 prefix) for ECDH */
+        memcpy(cardEphemeralPubKey, key + 1U, CARD_CERTIFICATE_KEY_SIZE - 1U);
+
+        CRYPTNOX_LOG_HEX(F("Full Ephemeral Public Key (65 bytes)"), key, CARD_CERTIFICATE_KEY_SIZE);
+        ret = true;
     }
 
     return ret;
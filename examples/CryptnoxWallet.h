@@ -2,9 +2,244 @@
 #define CRYPTNOXWALLET_H
 
 #include "PN532Base.h"
+#include "CryptnoxSession.h"
+#include "CryptnoxKeyPool.h"
+#include "CryptnoxStats.h"
+#include "CardCertificateView.h"
+#include "CryptnoxCardKeyCache.h"
+#include "CryptnoxPairingStore.h"
+#include "CryptnoxCommandBatch.h"
+#include "CryptnoxSignPipeline.h"
+#include "CryptnoxScratch.h"
+#include "CryptnoxCryptoWorker.h"
+#include <NoiseSource.h>
 #include <Arduino.h>
 #include "uECC.h"
 
+/**
+ * @def CRYPTNOX_TIMING_CALIBRATION
+ * @brief Set to 0 to keep the default PN532 bus pauses instead of measuring
+ * the real ACK and response latency in CryptnoxWallet::begin().
+ */
+#ifndef CRYPTNOX_TIMING_CALIBRATION
+#define CRYPTNOX_TIMING_CALIBRATION    1
+#endif
+
+/**
+ * @def CRYPTNOX_I2C_CLOCK
+ * @brief I2C clock requested in CryptnoxWallet::begin() for the I2C constructor.
+ *
+ * Fast mode (400 kHz, the PN532 maximum) by default. The SDK falls back to
+ * 100 kHz if the PN532 does not answer. Set to 0 to keep the Wire default.
+ */
+#ifndef CRYPTNOX_I2C_CLOCK
+#define CRYPTNOX_I2C_CLOCK             400000UL
+#endif
+
+/**
+ * @def CRYPTNOX_SPI_CLOCK
+ * @brief SPI clock given to the driver by the SPI constructors.
+ */
+#ifndef CRYPTNOX_SPI_CLOCK
+#define CRYPTNOX_SPI_CLOCK             PN532_SPI_CLOCK
+#endif
+
+/**
+ * @def CRYPTNOX_SPI_MAX_CLOCK
+ * @brief Highest SPI clock tried by the training step of CryptnoxWallet::begin().
+ *
+ * On SPI, begin() raises the clock from the constructor one in 1 MHz steps
+ * while GetFirmwareVersion stays reliable, up to this value (the PN532
+ * maximum by default), and keeps the last reliable step. Set to 0 to keep
+ * the constructor clock.
+ */
+#ifndef CRYPTNOX_SPI_MAX_CLOCK
+#define CRYPTNOX_SPI_MAX_CLOCK         PN532_SPI_MAX_CLOCK
+#endif
+
+/**
+ * @def CRYPTNOX_MAX_BITRATE
+ * @brief Default highest ISO-DEP bit rate passed to CryptnoxWallet::begin().
+ *
+ * After each detection the SDK switches to the fastest rate up to this one
+ * that the card announces (PPS), and falls back to 106 kbps on RF errors.
+ * Use PN532_BITRATE_106 to keep every exchange at the default rate.
+ */
+#ifndef CRYPTNOX_MAX_BITRATE
+#define CRYPTNOX_MAX_BITRATE           PN532_BITRATE_424
+#endif
+
+/**
+ * @def CRYPTNOX_AUTOPOLL
+ * @brief Set to 1 to detect cards with PN532 InAutoPoll in processCard().
+ *
+ * One detection cycle then finds both ISO-DEP cards and plain tags, and the
+ * PN532 polls on its own: with the IRQ line wired the host sees no bus
+ * traffic until a card shows up. The default inlists first and reads a
+ * plain UID as a second cycle.
+ */
+#ifndef CRYPTNOX_AUTOPOLL
+#define CRYPTNOX_AUTOPOLL              0
+#endif
+
+/**
+ * @def CRYPTNOX_PRESENCE_CHECK
+ * @brief Set to 0 to run the full processCard() again on a card left on the reader.
+ *
+ * By default processCard() first checks with a PN532 presence test (one short
+ * RF frame) whether the card of the last secure channel is still in the field
+ * and then keeps its session instead of detecting it and redoing the ECDH.
+ * A plain tag left on the reader has its UID logged once.
+ */
+#ifndef CRYPTNOX_PRESENCE_CHECK
+#define CRYPTNOX_PRESENCE_CHECK        1
+#endif
+
+/**
+ * @def CRYPTNOX_LAZY_SECURE_CHANNEL
+ * @brief Set to 1 to defer the secure channel to the first protected command.
+ *
+ * processCard() then stops after SELECT: the UID and the SELECT answer are
+ * available at once, and GET CARD CERTIFICATE, OPEN SECURE CHANNEL and the
+ * ECDH only run when a protected command needs them. Taps that only identify
+ * the card skip the ECC work. See setLazySecureChannel().
+ */
+#ifndef CRYPTNOX_LAZY_SECURE_CHANNEL
+#define CRYPTNOX_LAZY_SECURE_CHANNEL   0
+#endif
+
+/** @brief Bytes of the SELECT answer kept for getSelectInfo(), longer answers are truncated. */
+#ifndef CRYPTNOX_SELECT_INFO_SIZE
+#define CRYPTNOX_SELECT_INFO_SIZE      32U
+#endif
+
+/**
+ * @def CRYPTNOX_ANTENNA_DETECTOR
+ * @brief Antenna detector setting of the antenna self test in CryptnoxWallet::selfTest().
+ *
+ * ANDET_CONTROL thresholds and enable bits (see the PN532 user manual),
+ * which depend on the antenna and its matching circuit. 0 skips the test.
+ */
+#ifndef CRYPTNOX_ANTENNA_DETECTOR
+#define CRYPTNOX_ANTENNA_DETECTOR      0U
+#endif
+
+/** @brief Default longest wait for a card in processCard(), in ms (0 = forever). */
+#ifndef CRYPTNOX_DETECT_TIMEOUT_MS
+#define CRYPTNOX_DETECT_TIMEOUT_MS     1000U
+#endif
+
+/** @brief Default longest wait for the answer to each APDU frame, in ms (0 = forever). */
+#ifndef CRYPTNOX_EXCHANGE_TIMEOUT_MS
+#define CRYPTNOX_EXCHANGE_TIMEOUT_MS   1000U
+#endif
+
+/**
+ * @def CRYPTNOX_ACTIVATION_RETRIES
+ * @brief Default PN532 MxRtyPassiveActivation: activation attempts per detection.
+ *
+ * 0xFF retries until the host deadline stops the search; a small value lets
+ * the PN532 give up on its own, answering "no card" before the deadline.
+ */
+#ifndef CRYPTNOX_ACTIVATION_RETRIES
+#define CRYPTNOX_ACTIVATION_RETRIES    0xFFU
+#endif
+
+/**
+ * @def CRYPTNOX_ECDH_SLICE_BITS
+ * @brief Scalar bits of the ECDH ladder run by each poll() call.
+ *
+ * The P-256 shared secret is a 257-bit ladder; 32 bits per call splits it in
+ * nine steps, so poll() returns within a few ms on Cortex-M and within a few
+ * tens of ms on AVR. A larger value finishes the handshake in fewer calls.
+ */
+#ifndef CRYPTNOX_ECDH_SLICE_BITS
+#define CRYPTNOX_ECDH_SLICE_BITS       32U
+#endif
+
+/**
+ * @def CRYPTNOX_KEYGEN_SLICE_BITS
+ * @brief Scalar bits of a pool keypair ladder run by each idle() call.
+ *
+ * idle() also runs from the PN532 wait loop and from poll(), so a whole
+ * uECC_make_key() there would stall detection for tens to hundreds of ms.
+ * Same trade-off as CRYPTNOX_ECDH_SLICE_BITS.
+ */
+#ifndef CRYPTNOX_KEYGEN_SLICE_BITS
+#define CRYPTNOX_KEYGEN_SLICE_BITS     32U
+#endif
+
+/**
+ * @def CRYPTNOX_COMPRESSED_CLIENT_KEY
+ * @brief Set to 1 to send the client key compressed in OPEN SECURE CHANNEL.
+ *
+ * The 33-byte SEC1 form (0x02/0x03 || X) halves the command, which saves RF
+ * time at 106 kbps. When a card rejects it with an error status word, the
+ * command is sent again with the uncompressed key and the wallet keeps the
+ * uncompressed form from then on (see setCompressedClientKey()).
+ */
+#ifndef CRYPTNOX_COMPRESSED_CLIENT_KEY
+#define CRYPTNOX_COMPRESSED_CLIENT_KEY 0
+#endif
+
+/**
+ * @def CRYPTNOX_OVERLAP_KEYGEN
+ * @brief Set to 1 to generate the next ephemeral keypair while the card computes
+ *        its OPEN SECURE CHANNEL answer.
+ *
+ * processCard() always checks the certificate signature in that window; the
+ * keypair comes on top when the card is still busy. A P-256 key takes far
+ * longer than the card on AVR, so it is left to idle() there by default.
+ */
+#ifndef CRYPTNOX_OVERLAP_KEYGEN
+#if defined(__AVR__)
+#define CRYPTNOX_OVERLAP_KEYGEN        0
+#else
+#define CRYPTNOX_OVERLAP_KEYGEN        1
+#endif
+#endif
+
+/**
+ * @def CRYPTNOX_RNG_BUFFERED
+ * @brief Set to 1 to serve uECC_RNG() and nonces from the RNG keystream reserve.
+ *
+ * See RNGClass::setBufferedMode(). Small requests such as the 8-byte
+ * certificate nonce then cost a copy instead of two ChaCha blocks. Ignored
+ * where the Crypto library leaves the reserve out (RNG_RESERVE_SIZE 0, AVR).
+ */
+#ifndef CRYPTNOX_RNG_BUFFERED
+#define CRYPTNOX_RNG_BUFFERED          1
+#endif
+
+/**
+ * @enum CryptnoxError
+ * @brief Why the last CryptnoxWallet::processCard() did not open a secure channel.
+ */
+enum CryptnoxError : uint8_t {
+    CRYPTNOX_ERROR_NONE = 0,      /**< Secure channel opened, or a plain tag was read */
+    CRYPTNOX_ERROR_NO_CARD,       /**< Detection deadline passed without a card */
+    CRYPTNOX_ERROR_TIMEOUT,       /**< A card was found but stopped answering in time */
+    CRYPTNOX_ERROR_FAILED,        /**< Protocol or reader error */
+    CRYPTNOX_ERROR_OVERFLOW,      /**< The card answered more than the response buffer holds */
+    CRYPTNOX_ERROR_SAME_CARD      /**< The card or tag of the previous call is still on the reader */
+};
+
+/**
+ * @enum CryptnoxPollState
+ * @brief Steps of the non-blocking card handshake driven by CryptnoxWallet::poll().
+ */
+enum CryptnoxPollState : uint8_t {
+    CRYPTNOX_POLL_IDLE = 0,       /**< No detection running */
+    CRYPTNOX_POLL_DETECTING,      /**< InListPassiveTarget sent, waiting for a card */
+    CRYPTNOX_POLL_SELECT,         /**< Card found, SELECT pending */
+    CRYPTNOX_POLL_CERTIFICATE,    /**< GET CARD CERTIFICATE pending */
+    CRYPTNOX_POLL_OPEN_CHANNEL,   /**< OPEN SECURE CHANNEL pending */
+    CRYPTNOX_POLL_SHARED_SECRET,  /**< ECDH running, CRYPTNOX_ECDH_SLICE_BITS per step */
+    CRYPTNOX_POLL_AUTHENTICATE,   /**< Key derivation and MUTUALLY AUTHENTICATE pending */
+    CRYPTNOX_POLL_READY,          /**< Secure channel open, session usable */
+    CRYPTNOX_POLL_FAILED          /**< Handshake failed, next poll() restarts detection */
+};
+
 /**
  * @class CryptnoxWallet
  * @brief High-level interface for interacting with a PN532-based wallet.
@@ -16,6 +251,7 @@
  */
 class CryptnoxWallet {
 public:
+#if PN532_HAS_I2C
     /**
      * @brief Construct a CryptnoxWallet over I2C.
      *
@@ -24,28 +260,37 @@ public:
      * @param theWire TwoWire instance (default is &Wire).
      */
     CryptnoxWallet(uint8_t irq, uint8_t reset, TwoWire *theWire = &Wire)
-        : driver(irq, reset, theWire) {}
+        : driver(irq, reset, theWire), keyPool(uECC_secp256r1(), &uECC_RNG), cardKeys(uECC_secp256r1()) {}
+#endif
 
+#if PN532_HAS_SPI
     /**
      * @brief Construct a CryptnoxWallet over hardware SPI.
      *
      * @param ss SPI slave select pin.
      * @param theSPI SPIClass instance (default is &SPI).
+     * @param spiClock SPI clock in Hz, the start of the begin() training (see CRYPTNOX_SPI_MAX_CLOCK).
      */
-    CryptnoxWallet(uint8_t ss, SPIClass *theSPI = &SPI)
-        : driver(ss, theSPI) {}
+    CryptnoxWallet(uint8_t ss, SPIClass *theSPI = &SPI, uint32_t spiClock = CRYPTNOX_SPI_CLOCK)
+        : driver(ss, theSPI, spiClock), keyPool(uECC_secp256r1(), &uECC_RNG), cardKeys(uECC_secp256r1()) {}
 
     /**
      * @brief Construct a CryptnoxWallet over software SPI.
      *
+     * On RP2040 the bus runs on a PIO state machine rather than being
+     * bit-banged (BUSIO_HAS_PIO_SPI in Adafruit_SPIDevice.h).
+     *
      * @param clk Clock pin.
      * @param miso MISO pin.
      * @param mosi MOSI pin.
      * @param ss SPI slave select pin.
+     * @param spiClock SPI clock in Hz, the start of the begin() training (see CRYPTNOX_SPI_MAX_CLOCK).
      */
-    CryptnoxWallet(uint8_t clk, uint8_t miso, uint8_t mosi, uint8_t ss)
-        : driver(clk, miso, mosi, ss) {}
+    CryptnoxWallet(uint8_t clk, uint8_t miso, uint8_t mosi, uint8_t ss, uint32_t spiClock = CRYPTNOX_SPI_CLOCK)
+        : driver(clk, miso, mosi, ss, spiClock), keyPool(uECC_secp256r1(), &uECC_RNG), cardKeys(uECC_secp256r1()) {}
+#endif
 
+#if PN532_HAS_HSU
     /**
      * @brief Construct a CryptnoxWallet over UART.
      *
@@ -53,29 +298,320 @@ public:
      * @param theSer HardwareSerial instance.
      */
     CryptnoxWallet(uint8_t reset, HardwareSerial *theSer)
-        : driver(reset, theSer) {}
+        : driver(reset, theSer), keyPool(uECC_secp256r1(), &uECC_RNG), cardKeys(uECC_secp256r1()) {}
+#endif
+
+#if PN532_HAS_MOCK
+    /**
+     * @brief Construct a CryptnoxWallet over a mock link, e.g. a CryptnoxReplayLink in a host build.
+     *
+     * @param theMock Link standing in for the PN532 and its bus.
+     */
+    explicit CryptnoxWallet(Adafruit_PN532_MockLink *theMock)
+        : driver(theMock), keyPool(uECC_secp256r1(), &uECC_RNG), cardKeys(uECC_secp256r1()) {}
+#endif
 
     /**
      * @brief Initialize the PN532 module via the underlying driver.
      *
-     * Performs SAM configuration and checks firmware version.
+     * Performs SAM configuration and checks firmware version. When an IRQ pin
+     * is known (I2C constructor), readiness is then signalled by the IRQ line
+     * instead of bus polling.
+     *
+     * On I2C, the bus is switched to CRYPTNOX_I2C_CLOCK with a fallback to
+     * 100 kHz; on SPI, the clock is trained up to CRYPTNOX_SPI_MAX_CLOCK. The PN532 bus pauses are then tuned to the measured ACK and response
+     * latency (see CRYPTNOX_TIMING_CALIBRATION). The random number generator
+     * used for ephemeral keys and challenges is started here as well, followed
+     * by the ECC worker task when CRYPTNOX_DUAL_CORE is set.
      *
+     * @param maxRate Highest ISO-DEP bit rate negotiated with each detected
+     *        card, PN532_BITRATE_106 to PN532_BITRATE_848 (see CRYPTNOX_MAX_BITRATE).
      * @return true if the module was successfully initialized, false otherwise.
      */
-    bool begin() {
-        return driver.begin();
-    }
+    bool begin(uint8_t maxRate = CRYPTNOX_MAX_BITRATE);
+
+    /**
+     * @brief Register an extra entropy source with the random number generator.
+     *
+     * Boards with a hardware TRNG known to the Crypto library (ESP32, Uno R4,
+     * Due) or the AVR watchdog jitter do not need one; other boards should
+     * provide a proper NoiseSource, such as an AdcNoiseSource on a floating
+     * analog pin. The source must outlive the wallet.
+     *
+     * @param source Noise source stirred from idle().
+     */
+    void addNoiseSource(NoiseSource &source);
 
     /**
      * @brief Detect and process an NFC card for Cryptnox wallet operations.
      *
-     * If an ISO-DEP card is detected, SELECT APDU is sent and certificate is retrieved.
+     * If an ISO-DEP card is detected, SELECT APDU is sent and a secure channel is
+     * established. The resulting session stays open for further commands until
+     * the next card is processed or closeSession() is called.
      * If only a passive card is detected, the UID is printed.
      *
-     * @return true if a card was successfully processed, false otherwise.
+     * With CRYPTNOX_PRESENCE_CHECK, a card whose secure channel is open and
+     * that is still on the reader is not processed again: the call returns
+     * false with getLastError() at CRYPTNOX_ERROR_SAME_CARD and the session
+     * stays usable. The same goes for a plain tag read by the previous call.
+     * The card is processed again once it has left the field.
+     *
+     * With lazy secure channels (see setLazySecureChannel()), the call stops
+     * after SELECT and returns true once the card is identified; the handshake
+     * runs on the first protected command.
+     *
+     * @return true if a secure channel was established with the card (or, lazily,
+     *         the card was selected), false otherwise.
      */
     bool processCard();
 
+    /**
+     * @brief Advance the card handshake by one non-blocking step.
+     *
+     * Detection is started and then checked without waiting; each further call
+     * performs at most one APDU exchange (SELECT, GET CARD CERTIFICATE,
+     * OPEN SECURE CHANNEL, MUTUALLY AUTHENTICATE) or one slice of the ECDH
+     * shared secret. While waiting for a card each call runs one idle() step,
+     * which generates pool keypairs CRYPTNOX_KEYGEN_SLICE_BITS at a time, so
+     * detection is never held up by a whole key generation. Once
+     * CRYPTNOX_POLL_READY is reached the state is kept until resetPoll() is called. With CRYPTNOX_DUAL_CORE the shared secret is
+     * computed by the worker task and CRYPTNOX_POLL_SHARED_SECRET only checks
+     * for its result.
+     *
+     * @return State reached after this step.
+     */
+    CryptnoxPollState poll();
+
+    /**
+     * @brief Abort the running handshake, close the session and return to idle.
+     */
+    void resetPoll();
+
+    /**
+     * @brief Recover from a reader error without calling begin() again.
+     *
+     * Aborts the handshake, then lets the driver re-send only the PN532
+     * configuration (see PN532Base::softRecover()). The bus clock, timing
+     * profile and RNG set up by begin() are kept.
+     *
+     * @return true if the PN532 is answering again, false otherwise.
+     */
+    bool recover();
+
+    /**
+     * @brief Current state of the non-blocking handshake.
+     * @return Last state reached by poll().
+     */
+    CryptnoxPollState getPollState() const {
+        return pollState;
+    }
+
+    /**
+     * @brief Cooperative idle hook, to be called from loop() while no card is processed.
+     *
+     * Stirs the registered RNG noise sources, then runs one
+     * CRYPTNOX_KEYGEN_SLICE_BITS slice of the next ephemeral ECDH keypair until the key pool
+     * is full, so OPEN SECURE CHANNEL does not wait for uECC_make_key(). Each call stays short:
+     * processCard() runs it from the PN532 wait loop and poll() while waiting for a card.
+     */
+    void idle();
+
+    /**
+     * @brief Fill the ephemeral key pool at once, keys sharing one modular inversion.
+     *
+     * Blocks for the whole pool (see CryptnoxKeyPool::refillAll()); meant for
+     * setup(), after begin() started the random number generator. idle()
+     * keeps topping the pool up one key at a time afterwards.
+     *
+     * @return true if the pool is full, false if key generation failed.
+     */
+    bool prefillKeyPool();
+
+    /**
+     * @brief Bound how long detection and APDU exchanges may block.
+     *
+     * Can be called before or after begin(). A flaky antenna then costs at
+     * most detectTimeoutMs per processCard() instead of stalling the terminal;
+     * getLastError() tells a missing card from a card that stopped answering.
+     *
+     * @param retries PN532 MxRtyPassiveActivation, 0xFF to retry until the deadline.
+     * @param detectTimeoutMs Longest wait for a card, 0 to wait forever.
+     * @param exchangeTimeoutMs Longest wait for the answer to each APDU frame, 0 to wait forever.
+     */
+    void setDetectionPolicy(uint8_t retries, uint16_t detectTimeoutMs, uint16_t exchangeTimeoutMs);
+
+    /**
+     * @brief Check the reader with the PN532 Diagnose command.
+     *
+     * Runs the communication line test (an echo over the host bus), then the
+     * antenna self test when CRYPTNOX_ANTENNA_DETECTOR is set. Call it after
+     * begin(), e.g. from setup() or after repeated RF errors.
+     *
+     * @return true if every test run passed, false otherwise.
+     */
+    bool selfTest();
+
+    /**
+     * @brief RF statistics of the current card (exchanges, RF errors, fallbacks).
+     *
+     * They drive the adaptive bit rate and retry policy of the driver, see
+     * PN532Base::negotiateBitrate().
+     *
+     * @return Reference to the counters, reset at each detection.
+     */
+    const PN532LinkStats& getLinkStats() const {
+        return driver.getLinkStats();
+    }
+
+    /**
+     * @brief Reason of the last processCard() result.
+     * @return CRYPTNOX_ERROR_NONE on success, otherwise the kind of failure.
+     */
+    CryptnoxError getLastError() const {
+        return lastError;
+    }
+
+    /**
+     * @brief Enable verification of the card certificate signature.
+     *
+     * The provider returns the permanent public key of a card from its UID
+     * (e.g. from a provisioning table). Keys are validated once and kept in a
+     * small LRU cache, so repeat taps only run uECC_verify_loaded(). Without a
+     * provider the certificate signature is not checked. processCard() runs
+     * the check, provider included, while the card computes its OPEN SECURE
+     * CHANNEL answer: the provider must not use the PN532.
+     *
+     * @param provider Card key lookup callback, nullptr to disable verification.
+     * @param context User pointer passed to the callback.
+     */
+    void setCardKeyProvider(CryptnoxCardKeyProvider provider, void* context = nullptr) {
+        cardKeys.setProvider(provider, context);
+        cardKeys.clear();
+    }
+
+    /**
+     * @brief Register an energy profiling hook.
+     *
+     * With CRYPTNOX_POWER_HOOKS set, the hook is called at the start and end
+     * of every RF exchange, ECC or SHA computation and idle period between
+     * processCard() calls, so a power monitor read in the hook can split the
+     * energy of a tap between them. Ignored otherwise.
+     *
+     * @param hook Interval callback, nullptr to disable.
+     * @param context User pointer passed to the callback.
+     */
+    void setPowerHook(CryptnoxPowerHook hook, void* context = nullptr) {
+        driver.setPowerHook(hook, context);
+    }
+
+    /**
+     * @brief Access the pairing keys of the paired cards.
+     *
+     * begin() loads the store from storage. A card found in it opens its
+     * secure channel on its own pairing slot and key; other cards use slot
+     * 0xFF and the common pairing data.
+     *
+     * @return Reference to the pairing store owned by the wallet.
+     */
+    CryptnoxPairingStore& getPairingStore() {
+        return pairings;
+    }
+
+    /**
+     * @brief Choose the client key format sent in OPEN SECURE CHANNEL.
+     *
+     * Compressed keys are tried until a card rejects one, then the wallet
+     * switches back to uncompressed keys; call again to re-enable them.
+     *
+     * @param enable true for the 33-byte compressed key, false for 0x04 || X || Y.
+     */
+    void setCompressedClientKey(bool enable) {
+        compressedClientKey = enable;
+    }
+
+    /**
+     * @brief Defer the secure channel of the next cards to their first protected command.
+     *
+     * When enabled, processCard() only selects the card. sendSecureApdu(),
+     * runBatch() with a secure command and ensureSecureChannel() then run the
+     * handshake on the card still in the field. poll() always runs the full
+     * handshake.
+     *
+     * @param enable true to defer the handshake, false to run it in processCard().
+     */
+    void setLazySecureChannel(bool enable) {
+        lazySecureChannel = enable;
+    }
+
+    /**
+     * @brief Open the secure channel of the selected card if it was deferred.
+     *
+     * Runs GET CARD CERTIFICATE, OPEN SECURE CHANNEL and MUTUALLY AUTHENTICATE
+     * at most once per tap; protected commands call it on their own.
+     *
+     * @return true if the secure channel is open, false if there is no selected
+     *         card or the handshake failed.
+     */
+    bool ensureSecureChannel();
+
+    /**
+     * @brief Data of the SELECT answer of the last selected card, without SW1 SW2.
+     *
+     * @param[out] length Set to the number of bytes kept (see CRYPTNOX_SELECT_INFO_SIZE).
+     * @return Pointer to the kept bytes, valid until the next SELECT.
+     */
+    const uint8_t* getSelectInfo(uint8_t &length) const {
+        length = selectInfoLength;
+        return selectInfo;
+    }
+
+    /**
+     * @brief Per-phase timing of the handshake (ACK waits, RF exchanges, ECC, KDF).
+     *
+     * Counters stay at zero when CRYPTNOX_STATS is 0. With
+     * CRYPTNOX_STATS_HISTOGRAMS, every APDU exchange is also counted per
+     * command; getStats().writeHistograms(Serial) exports them in binary.
+     *
+     * @return Reference to the statistics accumulated since the last resetStats().
+     */
+    const CryptnoxStats& getStats() const {
+        return stats;
+    }
+
+    /**
+     * @brief Clear the handshake timing statistics.
+     */
+    void resetStats() {
+        stats.reset();
+    }
+
+    /**
+     * @brief Peak use of the scratch arena, to size CRYPTNOX_SCRATCH_SIZE.
+     *
+     * @return Highest number of scratch bytes in use at once since power-up.
+     */
+    size_t getScratchPeak() const {
+        return scratch.peak();
+    }
+
+    /**
+     * @brief Access the secure channel session of the current card.
+     *
+     * @return Reference to the session object owned by the wallet.
+     */
+    CryptnoxSession& getSession() {
+        return session;
+    }
+
+    /**
+     * @brief Close the current secure channel session and wipe its keys.
+     */
+    void closeSession() {
+        session.close();
+        cardHeld = false;
+        channelPending = false;
+    }
+
     /**
      * @brief Send the SELECT APDU to select the wallet application.
      *
@@ -84,16 +620,16 @@ public:
     bool selectApdu();
 
     /**
-    * @brief Retrieves the card's ephemeral public key with a GET CARD CERTIFICATE APDU.
+    * @brief Retrieves the card certificate with a GET CARD CERTIFICATE APDU.
     *
-    * Sends a GET CARD CERTIFICATE command to the card, validates the response,
-    * and extracts the ephemeral EC P-256 public key used for ECDH in the secure channel.
+    * The certificate is copied out of the PN532 packet buffer, so it outlives
+    * the next exchange. Use CardCertificateView to access its fields in place.
     *
-    * @param[out] cardEphemeralPubKey Buffer to store the 65-byte card ephemeral public key.
-    * @param[in,out] cardEphemeralPubKeyLength Input: size of the buffer; Output: actual key length (65 bytes).
-    * @return true if the APDU exchange and key extraction succeeded, false otherwise.
+    * @param[out] cardCertificate Buffer receiving the certificate (CARD_CERTIFICATE_MAX_SIZE bytes recommended).
+    * @param[in,out] cardCertificateLength Input: size of the buffer; Output: certificate length without SW1 SW2.
+    * @return true if the APDU exchange succeeded with 90 00, false otherwise.
     */
-    bool getCardCertificate(uint8_t* cardEphemeralPubKey, uint8_t &cardEphemeralPubKeyLength);
+    bool getCardCertificate(uint8_t* cardCertificate, uint8_t &cardCertificateLength);
 
     /**
      * @brief Read the UID of a detected card.
@@ -125,11 +661,70 @@ public:
     */
     bool openSecureChannel(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve);
 
-    bool mutuallyAuthenticate(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, uint8_t* cardEphemeralPubKey);
+    /**
+    * @brief Derives the session keys from the ECDH shared secret.
+    *
+    * Kenc and Kmac are written directly into the wallet session, which is then
+    * confirmed with the card by a protected MUTUALLY AUTHENTICATE command.
+    *
+    * @param[in] salt Pointer to the 32-byte salt received from the card.
+    * @param[in] clientPublicKey Pointer to the 64-byte client public key.
+    * @param[in] clientPrivateKey Pointer to the 32-byte client private key.
+    * @param[in] sessionCurve Pointer to the ECC curve (e.g., uECC_secp256r1()).
+    * @param[in] cardEphemeralPubKey Pointer to the 64-byte card ephemeral public key (X||Y).
+    * @return true if the session keys were derived and accepted by the card, false otherwise.
+    */
+    bool mutuallyAuthenticate(uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, const uint8_t* cardEphemeralPubKey);
+
+    /**
+    * @brief Exchanges a secure-messaging protected APDU using the current session.
+    *
+    * The same buffer is used for the command and the response, no intermediate copy is made.
+    * Before the call, CLA/INS/P1/P2 are at offset 0 and the plain command data at
+    * CRYPTNOX_SM_DATA_OFFSET. After the call, the decrypted response data (including the
+    * card's inner status word) starts at offset 0.
+    *
+    * @param[in,out] buffer APDU buffer shared by command and response.
+    * @param[in] dataLength Length of the plain command data in bytes.
+    * @param[in] bufferSize Total size of the buffer in bytes.
+    * @param[out] responseLength Length of the decrypted response data.
+    * @return true if the exchange succeeded and the response MAC was valid, false otherwise.
+    */
+    bool sendSecureApdu(uint8_t* buffer, uint8_t dataLength, uint8_t bufferSize, uint8_t &responseLength);
+
+    /**
+    * @brief Run the queued commands of a batch back-to-back with the current card.
+    *
+    * Commands are exchanged in order through one work buffer, secure commands
+    * through the current session. The run stops at the first failed exchange or
+    * status word other than 90 00; results are read back with batch.get().
+    *
+    * @param[in,out] batch Commands to run, results are stored in place.
+    * @return true if every command completed with 90 00, false otherwise.
+    */
+    bool runBatch(CryptnoxCommandBatch &batch);
+
+    /**
+    * @brief Send the SIGN command of a transaction hashed by a pipeline.
+    *
+    * The digest is finalized into the command prepared by pipeline.begin()
+    * and the command is sent through the current session, with no copy in
+    * between. With lazy secure channels, call ensureSecureChannel() while the
+    * chunks arrive so the handshake is not left for the end.
+    *
+    * @param[in,out] pipeline Transaction hashed with update(), cleared on return.
+    * @param[out] signature Buffer receiving the DER signature.
+    * @param[in,out] signatureLength Input: size of signature; Output: signature length.
+    * @return true if the card signed with 90 00, false otherwise.
+    */
+    bool sign(CryptnoxSignPipeline &pipeline, uint8_t* signature, uint8_t &signatureLength);
 
     /**
     * @brief Extracts the card's ephemeral EC P-256 public key from the certificate.
     *
+    * Copies the key out of the certificate; the handshake itself uses
+    * CardCertificateView to read it in place.
+    *
     * @param[in]  cardCertificate        Pointer to the full card certificate response.
     * @param[out] cardEphemeralPubKey    Buffer to store **64 bytes** (X||Y coordinates only, no 0x04 prefix)
     *                                    for use with uECC_shared_secret. Must be at least 64 bytes.
@@ -139,12 +734,15 @@ public:
     bool extractCardEphemeralKey(const uint8_t* cardCertificate, uint8_t* cardEphemeralPubKey, uint8_t* fullEphemeralPubKey65 = nullptr);
 
     /**
-    * @brief Print an APDU in hex format with optional label.
+    * @brief Trace an APDU in hex format with optional label.
+    *
+    * Compiled out unless CRYPTNOX_LOG_LEVEL is CRYPTNOX_LOG_LEVEL_DEBUG.
+    *
     * @param apdu Pointer to the APDU bytes.
     * @param length Number of bytes in the APDU.
-    * @param label Optional label for printing (default: "APDU to send").
+    * @param label Optional flash string label (default: "APDU to send").
     */
-    void printApdu(const uint8_t* apdu, uint8_t length, const char* label = "APDU to send");
+    void printApdu(const uint8_t* apdu, uint8_t length, const __FlashStringHelper* label = nullptr);
 
     /**
     * @brief Checks the status word (SW1/SW2) at the end of an APDU response.
@@ -159,9 +757,177 @@ public:
 
 private:
     PN532Base driver; /**< PN532 driver for low-level NFC operations */
+    CryptnoxSession session; /**< Secure channel state of the current card */
+    CryptnoxKeyPool keyPool; /**< Pre-generated ephemeral keypairs */
+    CryptnoxPollState pollState = CRYPTNOX_POLL_IDLE; /**< State of the non-blocking handshake */
+    CryptnoxStats stats; /**< Handshake timing statistics */
+    uint32_t poolKeyTime = 0U; /**< Time spent in the slices of the pending pool keypair, in us */
+    uint8_t maxBitrate = PN532_BITRATE_106; /**< Highest ISO-DEP bit rate, set in begin() */
+    uint8_t activationRetries = CRYPTNOX_ACTIVATION_RETRIES; /**< MxRtyPassiveActivation policy */
+    uint16_t detectTimeout = CRYPTNOX_DETECT_TIMEOUT_MS; /**< Detection deadline in ms */
+    uint16_t exchangeTimeout = CRYPTNOX_EXCHANGE_TIMEOUT_MS; /**< APDU frame deadline in ms */
+    bool started = false; /**< true once begin() brought the PN532 up */
+    bool compressedClientKey = (CRYPTNOX_COMPRESSED_CLIENT_KEY != 0); /**< Send the client key compressed, cleared when a card rejects it */
+    CryptnoxError lastError = CRYPTNOX_ERROR_NONE; /**< Outcome of the last processCard() */
+    bool cardHeld = false; /**< The card of the open session has not left the field yet */
+    bool lazySecureChannel = (CRYPTNOX_LAZY_SECURE_CHANNEL != 0); /**< Defer the handshake to the first protected command */
+    bool channelPending = false; /**< Card selected, secure channel deferred */
+    uint8_t selectInfo[CRYPTNOX_SELECT_INFO_SIZE]; /**< SELECT answer data of the last selected card */
+    uint8_t selectInfoLength = 0U; /**< Length of selectInfo */
+    uint8_t lastTagUid[CRYPTNOX_SESSION_CARD_ID_SIZE]; /**< UID of the plain tag read by the previous processCard() */
+    uint8_t lastTagUidLength = 0U; /**< Length of lastTagUid, 0 when no tag was read */
+    CryptnoxCardKeyCache cardKeys; /**< Validated permanent keys of known cards */
+    CryptnoxPairingStore pairings; /**< Pairing slots and keys of the paired cards */
+    const CryptnoxPairing* pairing = nullptr; /**< Pairing of the card in the handshake, nullptr for the common one */
+    const CardCertificateView* pendingCertificate = nullptr; /**< Certificate to verify while the card computes */
+    bool certificateValid = false; /**< Result of the deferred certificate verification */
+    CryptnoxScratch scratch; /**< APDU and crypto scratch buffers, phase scoped */
+#if CRYPTNOX_DUAL_CORE
+    CryptnoxCryptoWorker worker; /**< ECC task on the other core, started by begin() */
+#endif
+
+    /**
+     * @brief Handshake material carried between poll() steps.
+     */
+    struct HandshakeContext {
+        uint8_t cardEphemeralPubKey[64]; /**< Card ephemeral key X||Y */
+        uint8_t clientPublicKey[64];     /**< Client ephemeral public key */
+        uint8_t clientPrivateKey[32];    /**< Client ephemeral private key */
+        uint8_t salt[32];                /**< OPEN SECURE CHANNEL salt */
+        uint8_t sharedSecret[32];        /**< ECDH result, once CRYPTNOX_POLL_SHARED_SECRET is done */
+        uECC_mult_ctx ecdh;              /**< Sliced ECDH in progress */
+        uint32_t ecdhTime;               /**< Time spent in the ECDH slices, in us */
+        uint8_t ecdhTicket;              /**< Worker request of the ECDH, 0 when sliced on this core */
+    } handshake; /**< Material of the handshake in progress */
+
+    /**
+     * @brief Detect and process a card, the body of processCard().
+     * @return true if a secure channel was established with the card, false otherwise.
+     */
+    bool processNewCard();
+
+    /**
+     * @brief Check whether the card of the open session is still on the reader.
+     *
+     * Clears cardHeld once the card stops answering the presence test. A card
+     * whose secure channel is deferred is checked the same way.
+     *
+     * @return true if the card answered, false otherwise or with CRYPTNOX_PRESENCE_CHECK 0.
+     */
+    bool cardStillPresent();
+
+    /**
+     * @brief Execute the current poll() state and return the next one.
+     * @return Next handshake state.
+     */
+    CryptnoxPollState pollStep();
+
+    /**
+     * @brief Exchange a plain APDU through the driver, timing the RF exchange and ACK wait.
+     *
+     * @param apdu Pointer to the APDU command buffer.
+     * @param apduLength Length of the APDU command in bytes.
+     * @param response Pointer to the response buffer (may alias apdu).
+     * @param[in,out] responseLength Input: size of response; Output: response length.
+     * @return true if the APDU exchange succeeded, false otherwise.
+     */
+    bool transmitApdu(const uint8_t* apdu, uint8_t apduLength, uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Exchange a plain APDU built in place in driver.beginFrame(), doing host work
+     *        while the card computes its answer.
+     *
+     * Split-phase transmitFrame(): between the PN532 ACK and the card's answer,
+     * overlapCardWork() runs.
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param contract Status word and data length the response must have.
+     * @param[out] response Set to the response in the PN532 packet buffer.
+     * @param[out] responseLength Set to the response length.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool transmitFrameOverlapped(uint8_t apduLength, const ApduContract& contract,
+                                 const uint8_t* &response, uint8_t &responseLength);
+
+    /**
+     * @brief Host work done while the card computes: the pending certificate
+     *        verification, then with CRYPTNOX_OVERLAP_KEYGEN one pool keypair
+     *        if the card is still busy.
+     */
+    void overlapCardWork();
+
+    /** @brief Add one keypair to the pool, for overlapCardWork(). */
+    void generatePoolKey();
+
+    /** @brief Run one slice of the next pool keypair, for idle(). */
+    void generatePoolKeySlice();
+
+    /**
+     * @brief Exchange a plain APDU built in place in driver.beginFrame(), timed like transmitApdu().
+     *
+     * The response is not copied: it is read where it landed in the PN532
+     * packet buffer and is valid until the next driver command, beginFrame()
+     * included (see PN532Base::sendFrameAPDUView()).
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param contract Status word and data length the response must have.
+     * @param[out] response Set to the response in the PN532 packet buffer.
+     * @param[out] responseLength Set to the response length.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool transmitFrame(uint8_t apduLength, const ApduContract& contract,
+                       const uint8_t* &response, uint8_t &responseLength);
+
+    /**
+     * @brief Send GET CARD CERTIFICATE and view the certificate in the PN532 packet buffer.
+     *
+     * @param[out] cardCertificate Set to the certificate, valid until the next driver command.
+     * @param[out] cardCertificateLength Set to the certificate length without SW1 SW2.
+     * @return true if the APDU exchange succeeded with 90 00, false otherwise.
+     */
+    bool requestCardCertificate(const uint8_t* &cardCertificate, uint8_t &cardCertificateLength);
+
+    /**
+     * @brief Send a protected MUTUALLY AUTHENTICATE with a fresh random challenge.
+     * @return true if the card answered with a valid MAC under the session keys.
+     */
+    bool sendAuthenticationChallenge();
+
+    /**
+     * @brief Verify the certificate signature with the permanent key of the current card.
+     *
+     * @param certificate Parsed certificate.
+     * @return true if the signature is valid or no key provider is set, false otherwise.
+     */
+    bool verifyCardCertificate(const CardCertificateView &certificate);
+
+    /**
+     * @brief PN532 idle callback trampoline to idle().
+     * @param context Pointer to the CryptnoxWallet instance.
+     */
+    static void idleHook(void* context);
+
+    /**
+     * @brief Run GET CARD CERTIFICATE, OPEN SECURE CHANNEL and key derivation.
+     * @return true if the session was opened, false otherwise.
+     */
+    bool establishSecureChannel();
+
+    /**
+     * @brief Derive Kenc/Kmac from an ECDH shared secret and confirm them with MUTUALLY AUTHENTICATE.
+     *
+     * @param sharedSecret Pointer to the 32-byte ECDH shared secret.
+     * @param salt Pointer to the 32-byte salt received from the card.
+     * @return true if the session keys were derived and accepted by the card, false otherwise.
+     */
+    bool deriveSessionKeys(const uint8_t* sharedSecret, const uint8_t* salt);
     
     /**
-     * @brief RNG callback for micro-ecc library.
+     * @brief RNG callback for micro-ecc library, backed by the Crypto RNG.
+     *
+     * The whole request is served by one RNG.rand() call, from the keystream
+     * reserve when CRYPTNOX_RNG_BUFFERED is set and the request fits.
+     *
      * @param dest Pointer to buffer to fill with random bytes.
      * @param size Number of bytes to generate.
      * @return 1 on success.
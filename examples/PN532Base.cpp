@@ -1,6 +1,21 @@
 #include "PN532Base.h"
+#include "CryptnoxLog.h"
 #include <Arduino.h>
 
+/* SW1 value announcing that SW2 more response bytes are available */
+#define SW1_BYTES_AVAILABLE    0x61U
+#define GET_RESPONSE_APDU_SIZE 5U
+/* I2C standard mode, the Wire default */
+#define I2C_STANDARD_CLOCK     100000UL
+/* SPI clock training: step and GetFirmwareVersion reads per step */
+#define SPI_CLOCK_STEP         1000000UL
+#define SPI_TRAINING_SAMPLES   8U
+/* ATS TA(1): card send (DS) and receive (DR) bits for 212 kbps, shifted per rate */
+#define TA1_DS_212             0x10U
+#define TA1_DR_212             0x01U
+/* Target types searched by InAutoPoll, ISO-DEP first */
+#define AUTOPOLL_TYPE_COUNT    2U
+
 /**
  * @brief Initialize the PN532 module and configure it for normal operation.
  *
@@ -18,10 +33,17 @@ bool PN532Base::begin(void) {
  *
  * @param uidBuffer Pointer to buffer to store the UID.
  * @param uidLength Reference to variable to store the UID length.
+ * @param timeout Longest wait for a card in milliseconds, 0 to wait forever.
  * @return true if a card was detected and UID read successfully, false otherwise.
  */
-bool PN532Base::readUID(uint8_t* uidBuffer, uint8_t &uidLength) {
-    return readPassiveTargetID(PN532_MIFARE_ISO14443A, uidBuffer, &uidLength);
+bool PN532Base::readUID(uint8_t* uidBuffer, uint8_t &uidLength, uint16_t timeout) {
+    bool ret;
+
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+    ret = readPassiveTargetID(PN532_MIFARE_ISO14443A, uidBuffer, &uidLength, timeout);
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+
+    return ret;
 }
 
 /**
@@ -41,6 +63,320 @@ bool PN532Base::getFirmwareVersion(uint32_t &version) {
     return (version != 0);
 }
 
+/**
+ * @brief Switch the I2C bus to a faster clock, falling back if the PN532 stops answering.
+ *
+ * @param clock Requested SCL frequency in Hz.
+ * @return Clock in use in Hz, 0 if the bus is not I2C or the PN532 did not answer.
+ */
+uint32_t PN532Base::negotiateI2CClock(uint32_t clock) {
+    uint32_t ret = 0U;
+    uint32_t version = 0U;
+
+    if (setI2CClock(clock)) {
+        if (getFirmwareVersion(version)) {
+            ret = clock;
+        }
+        else if ((clock != I2C_STANDARD_CLOCK) && setI2CClock(I2C_STANDARD_CLOCK) &&
+                 getFirmwareVersion(version)) {
+            CRYPTNOX_LOG_INFO(F("I2C clock refused, back to 100 kHz."));
+            ret = I2C_STANDARD_CLOCK;
+        }
+        else {
+            CRYPTNOX_LOG_ERROR(F("PN532 not answering on I2C."));
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Raise the SPI clock step by step until the PN532 answers unreliably, then back off one step.
+ *
+ * @param maxClock Highest SCK frequency tried in Hz.
+ * @return Clock in use in Hz, 0 if the bus is not SPI or the PN532 did not answer.
+ */
+uint32_t PN532Base::trainSPIClock(uint32_t maxClock) {
+    uint32_t ret = getSPIClock();
+    uint32_t reference = 0U;
+
+    if (maxClock > PN532_SPI_MAX_CLOCK) {
+        maxClock = PN532_SPI_MAX_CLOCK;
+    }
+
+    /* The constructor clock is the known good starting point */
+    if ((ret != 0U) && getFirmwareVersion(reference)) {
+        bool reliable = true;
+
+        while ((reliable == true) && (ret < maxClock)) {
+            uint32_t next = ret + SPI_CLOCK_STEP;
+
+            if (next > maxClock) {
+                next = maxClock;
+            }
+            reliable = setSPIClock(next) && firmwareVersionStable(reference);
+            if (reliable == true) {
+                ret = next;
+            }
+        }
+
+        if (reliable == false) {
+            (void)setSPIClock(ret);
+            /* Drop any answer left pending by a garbled exchange */
+            abortCommand();
+            if (firmwareVersionStable(reference) == false) {
+                CRYPTNOX_LOG_ERROR(F("PN532 not answering on SPI."));
+                ret = 0U;
+            }
+        }
+    }
+    else if (ret != 0U) {
+        CRYPTNOX_LOG_ERROR(F("PN532 not answering on SPI."));
+        ret = 0U;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Read the firmware version SPI_TRAINING_SAMPLES times.
+ *
+ * @param reference Version read at the starting clock.
+ * @return true if every read returned the reference version.
+ */
+bool PN532Base::firmwareVersionStable(uint32_t reference) {
+    bool ret = true;
+    uint8_t i;
+
+    for (i = 0U; (i < SPI_TRAINING_SAMPLES) && (ret == true); i++) {
+        ret = (Adafruit_PN532::getFirmwareVersion() == reference);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Start InAutoPoll for ISO-DEP cards and plain ISO14443A tags.
+ *
+ * @param period Pause between polling rounds, in units of 150 ms.
+ * @return true if the PN532 accepted the command, false otherwise.
+ */
+bool PN532Base::startAutoPoll(uint8_t period) {
+    static const uint8_t types[AUTOPOLL_TYPE_COUNT] = {
+        PN532_AUTOPOLL_TYPE_ISO14443_4A, PN532_AUTOPOLL_TYPE_GENERIC_106A
+    };
+
+    return startInAutoPoll(PN532_AUTOPOLL_ENDLESS, period, types, AUTOPOLL_TYPE_COUNT);
+}
+
+/**
+ * @brief Read the target found by startAutoPoll().
+ *
+ * @param isoDep Set to true if the target is an ISO14443-4 card.
+ * @return true if a target was found, false otherwise.
+ */
+bool PN532Base::readAutoPoll(bool &isoDep) {
+    uint8_t type = 0U;
+    bool ret = readInAutoPoll(&type);
+
+    isoDep = (ret == true) && (type == PN532_AUTOPOLL_TYPE_ISO14443_4A);
+
+    return ret;
+}
+
+/**
+ * @brief Detect one card with InAutoPoll.
+ *
+ * @param isoDep Set to true if the target is an ISO14443-4 card.
+ * @param timeout Longest wait in milliseconds, 0 to wait forever.
+ * @return true if a target was found, false on timeout (polling is then aborted) or error.
+ */
+bool PN532Base::autoPoll(bool &isoDep, uint16_t timeout) {
+    bool ret = false;
+
+    isoDep = false;
+    if (startAutoPoll()) {
+        CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+        if (waitready(timeout)) {
+            ret = readAutoPoll(isoDep);
+        }
+        else {
+            /* Still polling: stop it so the next command is accepted */
+            abortCommand();
+        }
+        CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Get the PN532 working again after an error without a full begin().
+ *
+ * @return true if the PN532 is answering and configured, false otherwise.
+ */
+bool PN532Base::softRecover() {
+    bool ret = false;
+    uint32_t version = 0U;
+
+    abortCommand();
+    if (getFirmwareVersion(version) == false) {
+        /* Asleep or in LowVbat: a wake-up pulse may be enough */
+        wakeFromPowerDown();
+        (void)getFirmwareVersion(version);
+    }
+
+    if ((version != 0U) && restoreConfig()) {
+        CRYPTNOX_LOG_INFO(F("PN532 recovered without reset."));
+        ret = true;
+    }
+    else if (begin() && getFirmwareVersion(version)) {
+        CRYPTNOX_LOG_INFO(F("PN532 recovered by reset."));
+        ret = true;
+    }
+    else {
+        CRYPTNOX_LOG_ERROR(F("PN532 recovery failed."));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Put the PN532 into PowerDown between detections.
+ *
+ * @param wakeOnField Also wake up on an external RF field.
+ * @return true if the PN532 went to sleep, false otherwise.
+ */
+bool PN532Base::sleep(bool wakeOnField) {
+    uint8_t sources = hostWakeUpSource();
+
+    if (wakeOnField == true) {
+        sources |= PN532_WAKEUP_SOURCE_RF;
+    }
+
+    return powerDown(sources);
+}
+
+/**
+ * @brief Bring the PN532 back from sleep() without a full begin().
+ */
+void PN532Base::wake() {
+    wakeFromPowerDown();
+}
+
+/**
+ * @brief Raise the RF bit rate of the inlisted ISO-DEP card.
+ *
+ * @param maxBitrate Highest rate to use, PN532_BITRATE_106 to PN532_BITRATE_848.
+ * @return Rate in use.
+ */
+uint8_t PN532Base::negotiateBitrate(uint8_t maxBitrate) {
+    uint8_t ta1 = getInListedTA1();
+    uint8_t rate;
+
+    adaptLink();
+    rate = (maxBitrate > bitrateCap) ? bitrateCap : maxBitrate;
+
+    /* A new activation always starts at 106 kbps */
+    bitrate = PN532_BITRATE_106;
+
+    /* Fastest rate the card supports in both directions */
+    while ((rate > PN532_BITRATE_106) &&
+           (((ta1 & (uint8_t)(TA1_DS_212 << (rate - 1U))) == 0U) ||
+            ((ta1 & (uint8_t)(TA1_DR_212 << (rate - 1U))) == 0U))) {
+        rate--;
+    }
+
+    if (rate > PN532_BITRATE_106) {
+        if (inPSL(rate, rate)) {
+            bitrate = rate;
+            CRYPTNOX_LOG_INFO(F("ISO-DEP bit rate raised."));
+        }
+        else {
+            CRYPTNOX_LOG_INFO(F("PPS refused, staying at 106 kbps."));
+        }
+    }
+    linkStats.bitrate = bitrate;
+
+    return bitrate;
+}
+
+uint8_t PN532Base::getBitrate() const {
+    return bitrate;
+}
+
+/**
+ * @brief Apply the link policy to the card session that ended.
+ *
+ * RF errors lower the cap below the rate that failed and let the PN532
+ * repeat frames; clean sessions win both back one step at a time.
+ */
+void PN532Base::adaptLink() {
+    if (linkStats.exchanges != 0U) {
+        if (linkStats.rfErrors >= CRYPTNOX_LINK_ERROR_THRESHOLD) {
+            if (linkStats.bitrate > PN532_BITRATE_106) {
+                bitrateCap = linkStats.bitrate - 1U;
+            }
+            cleanSessions = 0U;
+            CRYPTNOX_LOG_INFO(F("Marginal RF link, bit rate capped and retries raised."));
+            (void)setCommunicationRetries(CRYPTNOX_LINK_COM_RETRIES);
+        }
+        else {
+            cleanSessions++;
+            if (cleanSessions >= CRYPTNOX_LINK_CLEAN_SESSIONS) {
+                cleanSessions = 0U;
+                if (bitrateCap < PN532_BITRATE_848) {
+                    bitrateCap++;
+                }
+                (void)setCommunicationRetries(0U);
+            }
+        }
+    }
+
+    memset(&linkStats, 0, sizeof(linkStats));
+}
+
+void PN532Base::resetLinkPolicy() {
+    bitrateCap = PN532_BITRATE_848;
+    cleanSessions = 0U;
+    (void)setCommunicationRetries(0U);
+}
+
+void PN532Base::setPowerHook(CryptnoxPowerHook hook, void* context) {
+    powerHook = hook;
+    powerContext = context;
+}
+
+void PN532Base::markPower(CryptnoxPowerPhase phase, bool enter) {
+    if (powerHook != nullptr) {
+        powerHook(phase, enter, powerContext);
+    }
+}
+
+/**
+ * @brief Drop back to 106 kbps after an RF error at a raised bit rate.
+ *
+ * @return true if a retry at 106 kbps makes sense, false otherwise.
+ */
+bool PN532Base::fallBackTo106() {
+    bool ret = false;
+    uint8_t status = getLastStatus();
+    bool rfError = (status == PN532_STATUS_TIMEOUT) || (status == PN532_STATUS_CRC) ||
+                   (status == PN532_STATUS_PARITY);
+
+    if (rfError == true) {
+        linkStats.rfErrors++;
+    }
+    if ((bitrate != PN532_BITRATE_106) && (rfError == true)) {
+        CRYPTNOX_LOG_INFO(F("RF error, back to 106 kbps."));
+        bitrate = PN532_BITRATE_106;
+        linkStats.fallbacks++;
+        ret = inPSL(PN532_BITRATE_106, PN532_BITRATE_106);
+    }
+
+    return ret;
+}
+
 /**
  * @brief Print detailed firmware information of the PN532 module.
  *
@@ -132,34 +468,368 @@ bool PN532Base::printFirmwareVersion(void)
  */
 bool PN532Base::sendAPDU(const uint8_t* apdu, uint8_t apduLength,
                          uint8_t* response, uint8_t &responseLength) {
-    bool success = inDataExchange(
-        (uint8_t*)apdu,
-        apduLength,
-        response,
-        &responseLength
-    );
+    size_t length = responseLength;
+    bool success = sendExtendedAPDU(apdu, apduLength, response, length);
 
     if (success == false) {
-        Serial.println(F("APDU exchange failed!"));
+        logExchangeError();
         return false;
     }
 
-    Serial.print(F("APDU response ("));
-    Serial.print(responseLength);
-    Serial.println(F(" bytes):"));
+    /* length never exceeds the uint8_t capacity passed in */
+    responseLength = (uint8_t)length;
+
+    CRYPTNOX_LOG_HEX(F("APDU response"), response, responseLength);
+
+    return true;
+}
+
+/**
+ * @brief Send an APDU to one of the targets inlisted together.
+ *
+ * @param target Index of the inlisted target (0 or 1).
+ * @param apdu Pointer to APDU command buffer.
+ * @param apduLength Length of the APDU command in bytes.
+ * @param response Pointer to buffer to store the card response.
+ * @param responseLength Reference to variable to store the response length.
+ * @return true if the target exists and the APDU exchange succeeded, false otherwise.
+ */
+bool PN532Base::sendAPDU(uint8_t target, const uint8_t* apdu, uint8_t apduLength,
+                         uint8_t* response, uint8_t &responseLength) {
+    bool ret = false;
+
+    if (selectInListedTarget(target)) {
+        ret = sendAPDU(apdu, apduLength, response, responseLength);
+    }
+    else {
+        CRYPTNOX_LOG_ERROR(F("No such inlisted target."));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Exchange an APDU of any length, following ISO-DEP chaining and 61xx.
+ *
+ * @param apdu Pointer to APDU command buffer.
+ * @param apduLength Length of the APDU command in bytes.
+ * @param response Pointer to buffer to store the card response.
+ * @param[in,out] responseLength Input: size of response; Output: response length.
+ * @return true if the APDU exchange succeeded, false otherwise.
+ */
+bool PN532Base::sendExtendedAPDU(const uint8_t* apdu, size_t apduLength,
+                                 uint8_t* response, size_t &responseLength) {
+    size_t capacity = responseLength;
+    size_t received = capacity;
+    bool ret;
+
+    CRYPTNOX_TRACE_RECORD(CRYPTNOX_TRACE_COMMAND, apdu, apduLength, PN532_EXCHANGE_OK);
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+    ret = inDataExchangeChained(apdu, apduLength, response, &received);
+
+    if ((ret == false) && fallBackTo106()) {
+        received = capacity;
+        ret = inDataExchangeChained(apdu, apduLength, response, &received);
+    }
+
+    if (ret == true) {
+        ret = readRemainingResponse(response, capacity, received);
+    }
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+    recordResponse(ret, response, received);
+
+    if (ret == true) {
+        responseLength = received;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Send the APDU built in place in the beginFrame() buffer.
+ *
+ * @param apduLength Length of the APDU written in the frame buffer.
+ * @param response Pointer to buffer to store the card response.
+ * @param[in,out] responseLength Input: size of response; Output: response length.
+ * @return true if the APDU exchange succeeded, false otherwise.
+ */
+bool PN532Base::sendFrameAPDU(uint8_t apduLength, uint8_t* response, uint8_t &responseLength) {
+    size_t capacity = responseLength;
+    size_t received = capacity;
+    bool ret;
+
+    CRYPTNOX_TRACE_RECORD(CRYPTNOX_TRACE_COMMAND, beginFrame(), apduLength, PN532_EXCHANGE_OK);
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+    ret = commitFrame(apduLength, response, &received);
+
+    return completeFrameAPDU(ret, response, capacity, received, responseLength);
+}
+
+/**
+ * @brief Send the APDU built in place in the beginFrame() buffer and hold the response to a contract.
+ *
+ * @param apduLength Length of the APDU written in the frame buffer.
+ * @param contract Expected status word and data length.
+ * @param response Pointer to buffer to store the card response.
+ * @param[in,out] responseLength Input: size of response; Output: response length.
+ * @return true if the response met the contract, false otherwise.
+ */
+bool PN532Base::sendFrameAPDU(uint8_t apduLength, const ApduContract& contract,
+                              uint8_t* response, uint8_t &responseLength) {
+    bool ret = false;
+
+    expectStatusWord(contract.sw1, contract.sw2);
+    if (sendFrameAPDU(apduLength, response, responseLength)) {
+        ret = checkContract(contract, responseLength);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Start the APDU built in the beginFrame() buffer without waiting for the card.
+ *
+ * @param apduLength Length of the APDU written in the frame buffer.
+ * @param contract Expected status word and data length.
+ * @return true if the exchange is pending, false otherwise.
+ */
+bool PN532Base::beginFrameAPDU(uint8_t apduLength, const ApduContract& contract) {
+    bool ret;
+
+    expectStatusWord(contract.sw1, contract.sw2);
+    CRYPTNOX_TRACE_RECORD(CRYPTNOX_TRACE_COMMAND, beginFrame(), apduLength, PN532_EXCHANGE_OK);
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+    ret = beginDataExchange(beginFrame(), apduLength);
+    if (ret == false) {
+        CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+        recordResponse(ret, nullptr, 0U);
+        (void)fallBackTo106();
+        logExchangeError();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Collect the answer to beginFrameAPDU() and hold it to the contract.
+ *
+ * @param contract Contract given to beginFrameAPDU().
+ * @param response Pointer to buffer to store the card response.
+ * @param[in,out] responseLength Input: size of response; Output: response length.
+ * @return true if the response met the contract, false otherwise.
+ */
+bool PN532Base::finishFrameAPDU(const ApduContract& contract, uint8_t* response, uint8_t &responseLength) {
+    size_t capacity = responseLength;
+    size_t received = capacity;
+    bool ret = finishDataExchange(response, &received);
+
+    ret = completeFrameAPDU(ret, response, capacity, received, responseLength);
+    if (ret == true) {
+        ret = checkContract(contract, responseLength);
+    }
 
-    for (uint8_t i = 0; i < responseLength; i++) {
-        Serial.print("0x");
-        if (response[i] < 16) {
-            Serial.print("0");
+    return ret;
+}
+
+/**
+ * @brief Fetch 61xx remainders after a frame exchange and log its outcome.
+ *
+ * @param exchanged Result of the frame exchange.
+ * @param response Pointer to buffer holding the card response.
+ * @param capacity Size of the response buffer.
+ * @param received Bytes received by the frame exchange.
+ * @param[out] responseLength Response length, set on success.
+ * @return true if the whole response was received, false otherwise.
+ */
+bool PN532Base::completeFrameAPDU(bool exchanged, uint8_t* response, size_t capacity, size_t received,
+                                  uint8_t &responseLength) {
+    bool ret = exchanged;
+
+    if (ret == true) {
+        ret = readRemainingResponse(response, capacity, received);
+    }
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+    recordResponse(ret, response, received);
+
+    if (ret == true) {
+        /* received never exceeds the uint8_t capacity passed in */
+        responseLength = (uint8_t)received;
+        CRYPTNOX_LOG_HEX(F("APDU response"), response, responseLength);
+    }
+    else {
+        /* The frame is gone, only the next exchanges benefit from the fallback */
+        (void)fallBackTo106();
+        logExchangeError();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Send the APDU built in the beginFrame() buffer and view the response in place.
+ *
+ * @param apduLength Length of the APDU written in the frame buffer.
+ * @param contract Expected status word and data length.
+ * @param[out] response Set to the response in the PN532 packet buffer.
+ * @param[out] responseLength Set to the response length.
+ * @return true if the response met the contract, false otherwise.
+ */
+bool PN532Base::sendFrameAPDUView(uint8_t apduLength, const ApduContract& contract,
+                                  const uint8_t* &response, uint8_t &responseLength) {
+    bool ret;
+
+    response = nullptr;
+    responseLength = 0U;
+    expectStatusWord(contract.sw1, contract.sw2);
+    CRYPTNOX_TRACE_RECORD(CRYPTNOX_TRACE_COMMAND, beginFrame(), apduLength, PN532_EXCHANGE_OK);
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, true);
+    ret = commitFrameView(apduLength, &response, &responseLength);
+
+    return completeFrameView(ret, contract, response, responseLength);
+}
+
+/**
+ * @brief View the answer to beginFrameAPDU() in place and hold it to the contract.
+ *
+ * @param contract Contract given to beginFrameAPDU().
+ * @param[out] response Set to the response in the PN532 packet buffer.
+ * @param[out] responseLength Set to the response length.
+ * @return true if the response met the contract, false otherwise.
+ */
+bool PN532Base::finishFrameAPDUView(const ApduContract& contract, const uint8_t* &response,
+                                    uint8_t &responseLength) {
+    bool ret;
+
+    response = nullptr;
+    responseLength = 0U;
+    ret = finishDataExchangeView(&response, &responseLength);
+
+    return completeFrameView(ret, contract, response, responseLength);
+}
+
+/**
+ * @brief Check and log a response viewed in the packet buffer.
+ *
+ * @param exchanged Result of the frame exchange.
+ * @param contract Expected status word and data length.
+ * @param response Response in the packet buffer.
+ * @param responseLength Response length.
+ * @return true if the response met the contract, false otherwise.
+ */
+bool PN532Base::completeFrameView(bool exchanged, const ApduContract& contract,
+                                  const uint8_t* response, uint8_t responseLength) {
+    bool ret = exchanged;
+
+    CRYPTNOX_POWER_MARK(*this, CRYPTNOX_POWER_RF, false);
+    recordResponse(ret, response, responseLength);
+    if (ret == true) {
+        CRYPTNOX_LOG_HEX(F("APDU response"), response, responseLength);
+        /* The rest of a 61xx response would overwrite the view */
+        if ((responseLength >= 2U) && (response[responseLength - 2U] == PN532_SW1_MORE_DATA)) {
+            CRYPTNOX_LOG_ERROR(F("APDU response larger than buffer!"));
+            ret = false;
+        }
+        else {
+            ret = checkContract(contract, responseLength);
         }
-        Serial.print(response[i], HEX);
-        Serial.print(" ");
+    }
+    else {
+        (void)fallBackTo106();
+        logExchangeError();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Count an exchange and record its response in the APDU trace.
+ *
+ * @param exchanged Result of the exchange.
+ * @param response Response bytes.
+ * @param responseLength Bytes in the response; only SW1 SW2 are there when
+ *        the status word was refused, nothing on other failures.
+ */
+void PN532Base::recordResponse(bool exchanged, const uint8_t* response, size_t responseLength) {
+    linkStats.exchanges++;
+#if CRYPTNOX_TRACE
+    uint8_t error = (exchanged == true) ? (uint8_t)PN532_EXCHANGE_OK : getExchangeError();
 
-        /* Wrap line every 16 bytes */
-        if ((i + 1) % 16 == 0 && (i + 1) != responseLength) Serial.println();
+    if ((exchanged == false) && (error != PN532_EXCHANGE_STATUS)) {
+        responseLength = 0U;
     }
-    Serial.println();
+    CryptnoxTrace::record(CRYPTNOX_TRACE_RESPONSE, response, responseLength, error);
+#else
+    (void)exchanged;
+    (void)response;
+    (void)responseLength;
+#endif
+}
 
-    return true;
+/**
+ * @brief Check the data length of a response against its contract.
+ *
+ * @param contract Expected data length, 0 for any.
+ * @param responseLength Response length including SW1 SW2.
+ * @return true if the length is the expected one.
+ */
+bool PN532Base::checkContract(const ApduContract& contract, uint8_t responseLength) {
+    bool ret = true;
+
+    if ((contract.dataLength != 0U) &&
+        (responseLength != (uint8_t)(contract.dataLength + 2U))) {
+        CRYPTNOX_LOG_ERROR(F("Unexpected APDU response size."));
+        ret = false;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Log why the last APDU exchange failed.
+ */
+void PN532Base::logExchangeError() {
+    switch (getExchangeError()) {
+    case PN532_EXCHANGE_OVERFLOW:
+        CRYPTNOX_LOG_ERROR(F("APDU response larger than buffer!"));
+        break;
+    case PN532_EXCHANGE_STATUS:
+        CRYPTNOX_LOG_ERROR(F("APDU SW1/SW2 not expected."));
+        break;
+    default:
+        CRYPTNOX_LOG_ERROR(F("APDU exchange failed!"));
+        break;
+    }
+}
+
+/**
+ * @brief Follow 61xx status words with GET RESPONSE commands.
+ *
+ * Each GET RESPONSE is built in the frame buffer and its data overwrites the
+ * interim status word.
+ *
+ * @param response Response buffer, already holding the first part.
+ * @param capacity Size of the response buffer in bytes.
+ * @param[in,out] received Bytes in the buffer, updated as parts are appended.
+ * @return true if every GET RESPONSE succeeded, false otherwise.
+ */
+bool PN532Base::readRemainingResponse(uint8_t* response, size_t capacity, size_t &received) {
+    bool ret = true;
+
+    /* 61xx: collect the remaining data with GET RESPONSE, dropping the interim SW */
+    while ((ret == true) && (received >= 2U) && (response[received - 2U] == SW1_BYTES_AVAILABLE)) {
+        uint8_t* getResponse = beginFrame();
+        size_t offset = received - 2U;
+        size_t part = capacity - offset;
+
+        getResponse[0] = 0x00;                       /* CLA */
+        getResponse[1] = 0xC0;                       /* INS : GET RESPONSE */
+        getResponse[2] = 0x00;                       /* P1 */
+        getResponse[3] = 0x00;                       /* P2 */
+        getResponse[4] = response[received - 1U];    /* Le : bytes announced by SW2 */
+
+        ret = commitFrame(GET_RESPONSE_APDU_SIZE, response + offset, &part);
+        received = offset + part;
+    }
+
+    return ret;
 }
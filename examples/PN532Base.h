@@ -2,6 +2,66 @@
 #define PN532BASE_H
 
 #include <Adafruit_PN532.h>
+#include "CryptnoxPower.h"
+#include "CryptnoxTrace.h"
+
+/**
+ * @def PN532BASE_AUTOPOLL_PERIOD
+ * @brief Pause between InAutoPoll rounds, in units of 150 ms (1 to 15).
+ */
+#ifndef PN532BASE_AUTOPOLL_PERIOD
+#define PN532BASE_AUTOPOLL_PERIOD      2U
+#endif
+
+/**
+ * @def CRYPTNOX_LINK_ERROR_THRESHOLD
+ * @brief RF errors in one card session that lower the bit rate cap of the next ones.
+ */
+#ifndef CRYPTNOX_LINK_ERROR_THRESHOLD
+#define CRYPTNOX_LINK_ERROR_THRESHOLD  1U
+#endif
+
+/**
+ * @def CRYPTNOX_LINK_CLEAN_SESSIONS
+ * @brief Consecutive card sessions without RF error that raise the cap one step
+ *        and drop the extra PN532 retries.
+ */
+#ifndef CRYPTNOX_LINK_CLEAN_SESSIONS
+#define CRYPTNOX_LINK_CLEAN_SESSIONS   4U
+#endif
+
+/**
+ * @def CRYPTNOX_LINK_COM_RETRIES
+ * @brief PN532 MxRtyCOM while the link is marginal: frame repeats after a
+ *        timeout or RF error, done by the PN532 inside one exchange.
+ */
+#ifndef CRYPTNOX_LINK_COM_RETRIES
+#define CRYPTNOX_LINK_COM_RETRIES      3U
+#endif
+
+/**
+ * @struct PN532LinkStats
+ * @brief RF outcome of the APDU exchanges with the current card.
+ */
+struct PN532LinkStats {
+    uint16_t exchanges;     /**< APDU exchanges, failed ones included */
+    uint16_t rfErrors;      /**< Exchanges failed on timeout, CRC or parity error */
+    uint8_t fallbacks;      /**< Drops to 106 kbps */
+    uint8_t bitrate;        /**< Rate negotiated for the card */
+};
+
+/**
+ * @struct ApduContract
+ * @brief What a caller accepts back from an APDU.
+ *
+ * The status word is checked by the driver on the last response frame before
+ * anything is copied, so a wrong status aborts the exchange at once.
+ */
+struct ApduContract {
+    uint8_t sw1;            /**< Expected SW1 */
+    uint8_t sw2;            /**< Expected SW2 */
+    uint8_t dataLength;     /**< Exact data length before SW1 SW2, 0 for any length */
+};
 
 /**
  * @class PN532Base
@@ -36,9 +96,10 @@ public:
      *
      * @param uidBuffer Pointer to a buffer where the UID will be stored.
      * @param uidLength Reference to a variable that will hold the length of the UID.
+     * @param timeout Longest wait for a card in milliseconds, 0 to wait forever.
      * @return true if a card was detected and UID read successfully, false otherwise.
      */
-    bool readUID(uint8_t* uidBuffer, uint8_t &uidLength);
+    bool readUID(uint8_t* uidBuffer, uint8_t &uidLength, uint16_t timeout = 0U);
 
     /**
     * @brief Retrieve the firmware version of the PN532 module.
@@ -65,6 +126,165 @@ public:
     */
     bool printFirmwareVersion();
 
+    /**
+     * @brief Switch the I2C bus to a faster clock, falling back if the PN532 stops answering.
+     *
+     * The requested clock is set and checked with GetFirmwareVersion. On failure the
+     * bus returns to the 100 kHz standard mode and is checked again.
+     *
+     * @param clock Requested SCL frequency in Hz (e.g. 400000 for fast mode).
+     * @return Clock in use in Hz, 0 if the bus is not I2C or the PN532 did not answer.
+     */
+    uint32_t negotiateI2CClock(uint32_t clock);
+
+    /**
+     * @brief Raise the SPI clock as far as the wiring allows.
+     *
+     * Starting from the constructor clock, the clock goes up in 1 MHz steps
+     * up to maxClock. Each step must return the same firmware version on
+     * several GetFirmwareVersion reads in a row; at the first unreliable step
+     * the clock backs off to the previous one, which is checked again.
+     *
+     * @param maxClock Highest SCK frequency tried in Hz, capped to PN532_SPI_MAX_CLOCK.
+     * @return Clock in use in Hz, 0 if the bus is not SPI or the PN532 did not answer.
+     */
+    uint32_t trainSPIClock(uint32_t maxClock);
+
+    /**
+     * @brief Let the PN532 look for ISO-DEP cards and plain ISO14443A tags on its own.
+     *
+     * InAutoPoll runs on the PN532 until a target shows up, with no host
+     * traffic in between. Wait with isready() (cheap once the IRQ line is
+     * enabled) and collect the result with readAutoPoll().
+     *
+     * @param period Pause between polling rounds, in units of 150 ms (1 to 15).
+     * @return true if the PN532 accepted the command, false otherwise.
+     */
+    bool startAutoPoll(uint8_t period = PN532BASE_AUTOPOLL_PERIOD);
+
+    /**
+     * @brief Read the target found by startAutoPoll().
+     *
+     * The target becomes the inlisted one: getInListedUID() returns its NFCID
+     * and, for an ISO-DEP card, APDUs can be sent right away.
+     *
+     * @param isoDep Set to true if the target is an ISO14443-4 card, false for a plain tag.
+     * @return true if a target was found, false otherwise.
+     */
+    bool readAutoPoll(bool &isoDep);
+
+    /**
+     * @brief Detect one card with InAutoPoll, waiting until it shows up.
+     *
+     * @param isoDep Set to true if the target is an ISO14443-4 card, false for a plain tag.
+     * @param timeout Longest wait in milliseconds, 0 to wait forever.
+     * @return true if a target was found, false on timeout or error.
+     */
+    bool autoPoll(bool &isoDep, uint16_t timeout = 0U);
+
+    /**
+     * @brief Get the PN532 working again after an error without a full begin().
+     *
+     * The pending command is aborted and the PN532 is checked with
+     * GetFirmwareVersion (after a bus wake-up pulse if it does not answer).
+     * Only the SAM and RF configuration are then sent again; begin() with its
+     * reset is the last resort.
+     *
+     * @return true if the PN532 is answering and configured, false otherwise.
+     */
+    bool softRecover();
+
+    /**
+     * @brief Put the PN532 into PowerDown between detections.
+     *
+     * The PN532 wakes up on the next command sent on its bus and, with
+     * wakeOnField, when an external RF field appears (a phone or another
+     * reader). The IRQ line goes low on wake-up. Passive cards cannot wake
+     * it: the PN532 has no low-power card detection, so battery readers
+     * sleep, wake() and poll on a timer.
+     *
+     * @param wakeOnField Also wake up on an external RF field.
+     * @return true if the PN532 went to sleep, false otherwise.
+     */
+    bool sleep(bool wakeOnField = false);
+
+    /**
+     * @brief Bring the PN532 back from sleep() without a full begin().
+     *
+     * SAM and RF settings survive PowerDown, so this costs only the wake-up
+     * pulse and about 2 ms of oscillator start instead of reset, wake-up and
+     * SAMConfig.
+     */
+    void wake();
+
+    /**
+     * @brief Raise the RF bit rate of the inlisted ISO-DEP card.
+     *
+     * Picks the fastest rate up to maxBitrate that the card announces in its
+     * ATS for both directions and switches to it with InPSL (PPS). When an
+     * exchange later fails with a timeout, CRC or parity error at the raised
+     * rate, the link drops back to 106 kbps and sendExtendedAPDU() retries once.
+     * Call it after each inlisting.
+     *
+     * It also closes the link statistics of the previous card: a session
+     * with CRYPTNOX_LINK_ERROR_THRESHOLD RF errors caps the next ones one
+     * rate below its own and sets the PN532 frame retries to
+     * CRYPTNOX_LINK_COM_RETRIES; CRYPTNOX_LINK_CLEAN_SESSIONS clean sessions
+     * in a row raise the cap one step and drop the retries again.
+     *
+     * @param maxBitrate Highest rate to use, PN532_BITRATE_106 to PN532_BITRATE_848.
+     * @return Rate in use, PN532_BITRATE_106 if the card or the PPS refused.
+     */
+    uint8_t negotiateBitrate(uint8_t maxBitrate);
+
+    /**
+     * @brief RF bit rate in use with the inlisted card.
+     * @return PN532_BITRATE_106 to PN532_BITRATE_848.
+     */
+    uint8_t getBitrate() const;
+
+    /**
+     * @brief RF statistics of the current card, reset by negotiateBitrate().
+     * @return Reference to the counters.
+     */
+    const PN532LinkStats& getLinkStats() const {
+        return linkStats;
+    }
+
+    /**
+     * @brief Highest bit rate the adaptive policy currently allows.
+     * @return PN532_BITRATE_106 to PN532_BITRATE_848.
+     */
+    uint8_t getBitrateCap() const {
+        return bitrateCap;
+    }
+
+    /**
+     * @brief Forget the link history, e.g. after changing the antenna.
+     *
+     * The bit rate cap is lifted and the PN532 frame retries are dropped.
+     */
+    void resetLinkPolicy();
+
+    /**
+     * @brief Register the hook told when RF exchanges start and end.
+     *
+     * Detections and APDU exchanges of this class are reported as
+     * CRYPTNOX_POWER_RF intervals. Only called with CRYPTNOX_POWER_HOOKS.
+     *
+     * @param hook Interval callback, nullptr to disable.
+     * @param context User pointer passed to the callback.
+     */
+    void setPowerHook(CryptnoxPowerHook hook, void* context = nullptr);
+
+    /**
+     * @brief Report an interval boundary to the registered hook, if any.
+     *
+     * @param phase Interval kind.
+     * @param enter true at the start of the interval, false at its end.
+     */
+    void markPower(CryptnoxPowerPhase phase, bool enter);
+
     /**
      * @brief Send an APDU command to an ISO14443-4 (Type 4) NFC card.
      *
@@ -78,6 +298,183 @@ public:
      */
     bool sendAPDU(const uint8_t* apdu, uint8_t apduLength,
                   uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Send an APDU to one of the targets inlisted together.
+     *
+     * After inListPassiveTarget(2) two stacked cards are active at once; this
+     * addresses either of them without a new detection. The chosen target
+     * stays selected for the following exchanges.
+     *
+     * @param target Index of the inlisted target (0 or 1).
+     * @param apdu Pointer to the APDU command buffer to send.
+     * @param apduLength Length of the APDU command buffer in bytes.
+     * @param response Pointer to a buffer where the card's response will be stored.
+     * @param responseLength Reference to a variable that will hold the length of the response.
+     * @return true if the target exists and the APDU exchange was successful, false otherwise.
+     */
+    bool sendAPDU(uint8_t target, const uint8_t* apdu, uint8_t apduLength,
+                  uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Exchange an APDU of any length with an ISO14443-4 card.
+     *
+     * Commands and responses larger than one PN532 frame are split with
+     * InDataExchange chaining (MI bit). A 61xx status word is followed by
+     * GET RESPONSE commands until the card returns its final status word,
+     * and every part is appended to the response buffer.
+     *
+     * @param apdu Pointer to the APDU command buffer to send.
+     * @param apduLength Length of the APDU command buffer in bytes.
+     * @param response Pointer to a buffer where the card's response will be stored.
+     * @param[in,out] responseLength Input: size of response; Output: length of the response including SW1 SW2.
+     * @return true if the APDU exchange was successful, false otherwise.
+     */
+    bool sendExtendedAPDU(const uint8_t* apdu, size_t apduLength,
+                          uint8_t* response, size_t &responseLength);
+
+    /**
+     * @brief Send the APDU built in place in the beginFrame() buffer.
+     *
+     * The caller writes the command into beginFrame() (at most
+     * PN532_FRAME_DATA_MAX bytes) and passes its length here, which saves the
+     * copy into the PN532 packet buffer. Chaining and 61xx are handled as in
+     * sendExtendedAPDU(). The frame content is lost once the response arrives.
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param response Pointer to a buffer where the card's response will be stored.
+     * @param[in,out] responseLength Input: size of response; Output: length of the response including SW1 SW2.
+     * @return true if the APDU exchange was successful, false otherwise.
+     */
+    bool sendFrameAPDU(uint8_t apduLength, uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Send the APDU built in place in the beginFrame() buffer and hold
+     *        the response to a contract.
+     *
+     * Like sendFrameAPDU(), but the exchange fails as soon as the status word
+     * differs from the contract (only SW1 SW2 are then returned) or the data
+     * length is not the expected one. getExchangeError() tells a response
+     * larger than the buffer apart from a wrong status or a lost card.
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param contract Expected status word and data length.
+     * @param response Pointer to a buffer where the card's response will be stored.
+     * @param[in,out] responseLength Input: size of response; Output: length of the response including SW1 SW2.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool sendFrameAPDU(uint8_t apduLength, const ApduContract& contract,
+                       uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Start the APDU built in the beginFrame() buffer without waiting for the answer.
+     *
+     * Split-phase sendFrameAPDU(): returns once the PN532 has acknowledged
+     * the frame, so the host can compute while the card does. Poll
+     * isExchangeComplete() and collect the answer with finishFrameAPDU();
+     * no other PN532 command may be sent in between.
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param contract Expected status word and data length.
+     * @return true if the exchange is pending, false otherwise.
+     */
+    bool beginFrameAPDU(uint8_t apduLength, const ApduContract& contract);
+
+    /**
+     * @brief Wait for the answer to beginFrameAPDU() and hold it to the contract.
+     *
+     * 61xx remainders are fetched and the RF fallback applies as in sendFrameAPDU().
+     *
+     * @param contract Contract given to beginFrameAPDU().
+     * @param response Pointer to a buffer where the card's response will be stored.
+     * @param[in,out] responseLength Input: size of response; Output: length of the response including SW1 SW2.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool finishFrameAPDU(const ApduContract& contract, uint8_t* response, uint8_t &responseLength);
+
+    /**
+     * @brief Send the APDU built in the beginFrame() buffer and read the
+     *        response where it landed in the PN532 packet buffer.
+     *
+     * Zero-copy sendFrameAPDU(): response points into the driver and stays
+     * valid until the next PN532 command, including beginFrame() writes. A
+     * response that does not fit one frame (MI chaining or 61xx) fails with
+     * PN532_EXCHANGE_OVERFLOW: use sendFrameAPDU() with a buffer for those.
+     *
+     * @param apduLength Length of the APDU written in the frame buffer.
+     * @param contract Expected status word and data length.
+     * @param[out] response Set to the response including SW1 SW2; on a wrong
+     *             status word, to SW1 SW2 only.
+     * @param[out] responseLength Set to the length of the response.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool sendFrameAPDUView(uint8_t apduLength, const ApduContract& contract,
+                           const uint8_t* &response, uint8_t &responseLength);
+
+    /**
+     * @brief Zero-copy finishFrameAPDU(): read the answer to beginFrameAPDU()
+     *        in place, with the limits of sendFrameAPDUView().
+     *
+     * @param contract Contract given to beginFrameAPDU().
+     * @param[out] response Set to the response including SW1 SW2.
+     * @param[out] responseLength Set to the length of the response.
+     * @return true if the response met the contract, false otherwise.
+     */
+    bool finishFrameAPDUView(const ApduContract& contract, const uint8_t* &response,
+                             uint8_t &responseLength);
+
+private:
+    uint8_t bitrate = PN532_BITRATE_106; /**< RF bit rate set by negotiateBitrate() */
+    uint8_t bitrateCap = PN532_BITRATE_848; /**< Highest rate allowed by the link policy */
+    uint8_t cleanSessions = 0U; /**< Card sessions without RF error since the last change */
+    PN532LinkStats linkStats = {}; /**< RF outcome of the current card session */
+    CryptnoxPowerHook powerHook = nullptr; /**< Energy profiling callback */
+    void* powerContext = nullptr; /**< Argument of powerHook */
+
+    /**
+     * @brief Drop back to 106 kbps after an RF error at a raised bit rate.
+     *
+     * @return true if the link was at a raised rate and the last exchange
+     *         failed on RF, i.e. a retry at 106 kbps makes sense.
+     */
+    bool fallBackTo106();
+
+    /** @brief Apply the link policy to the statistics of the card session that ended. */
+    void adaptLink();
+
+    /** @brief Check that every training read returns the reference firmware version. */
+    bool firmwareVersionStable(uint32_t reference);
+
+    /** @brief Common end of sendFrameAPDU() and finishFrameAPDU(): 61xx, logging and fallback. */
+    bool completeFrameAPDU(bool exchanged, uint8_t* response, size_t capacity, size_t received,
+                           uint8_t &responseLength);
+
+    /**
+     * @brief Count an exchange in the link statistics and record its outcome
+     *        with CRYPTNOX_TRACE: the response, SW1 SW2 of a refused one, no
+     *        bytes otherwise.
+     */
+    void recordResponse(bool exchanged, const uint8_t* response, size_t responseLength);
+
+    /** @brief Common end of the view variants: contract, logging and fallback. */
+    bool completeFrameView(bool exchanged, const ApduContract& contract,
+                           const uint8_t* response, uint8_t responseLength);
+
+    /** @brief Check the response length required by a contract. */
+    bool checkContract(const ApduContract& contract, uint8_t responseLength);
+
+    /** @brief Log why the last APDU exchange failed, from getExchangeError(). */
+    void logExchangeError();
+
+    /**
+     * @brief Follow 61xx status words with GET RESPONSE commands.
+     *
+     * @param response Response buffer, already holding the first part.
+     * @param capacity Size of the response buffer in bytes.
+     * @param[in,out] received Bytes in the buffer, updated as parts are appended.
+     * @return true if every GET RESPONSE succeeded, false otherwise.
+     */
+    bool readRemainingResponse(uint8_t* response, size_t capacity, size_t &received);
 };
 
 #endif // PN532BASE_H
@@ -9,6 +9,9 @@
 
 #include <Wire.h>
 #include "CryptnoxWallet.h"
+#include "CryptnoxLog.h"
+#include "CryptnoxTrace.h"
+#include <AdcNoiseSource.h>
 
 /**
  * @def PN532_SS
@@ -16,8 +19,22 @@
  */
 #define PN532_SS   (10)
 
+/**
+ * @def ADC_NOISE_PIN
+ * @brief Unconnected analog pin sampled as entropy source, -1 for none.
+ *
+ * Useful on boards without a hardware TRNG, such as the RP2040 (A0 to A3).
+ */
+#ifndef ADC_NOISE_PIN
+#define ADC_NOISE_PIN   (-1)
+#endif
+
 CryptnoxWallet wallet(PN532_SS, &SPI);
 
+#if ADC_NOISE_PIN >= 0
+static AdcNoiseSource adcNoise(ADC_NOISE_PIN);
+#endif
+
 /**
  * @brief Arduino setup function.
  *
@@ -36,6 +53,12 @@ void setup() {
     /* Initialize the PN532 module */
     if (wallet.begin()) {
         Serial.println(F("PN532 initialized"));
+#if ADC_NOISE_PIN >= 0
+        wallet.addNoiseSource(adcNoise);
+#endif
+        if (wallet.selfTest() == false) {
+            Serial.println(F("PN532 self test failed"));
+        }
     } else {
         Serial.println(F("PN532 init failed"));
         /* Halt program if initialization fails */
@@ -58,6 +81,18 @@ void loop() {
     /* Process any detected NFC card */
     (void)wallet.processCard();
 
-    /* Wait 1 second before next loop iteration */
-    delay(1000);
+    /* Print traces queued during the exchange (CRYPTNOX_LOG_DEFERRED builds) */
+    CryptnoxLog::flush();
+
+#if CRYPTNOX_TRACE
+    /* APDUs of the session as a pcap file: build with CRYPTNOX_LOG_LEVEL_NONE and capture the port */
+    CryptnoxTrace::dump(Serial);
+#endif
+
+    /* Use the wait before the next iteration to pre-generate session keys */
+    unsigned long start = millis();
+    while ((millis() - start) < 1000UL) {
+        wallet.idle();
+        delay(10);
+    }
 }
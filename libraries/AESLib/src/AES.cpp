@@ -1,5 +1,9 @@
 #include "AES.h"
 
+#if AESLIB_USE_CRYPTO
+#include <new>
+#endif
+
 /*
  ---------------------------------------------------------------------------
  Copyright (c) 1998-2008, Brian Gladman, Worcester, UK. All rights reserved.
@@ -60,6 +64,8 @@
  * 16/12/14
  */
 
+#if !AESLIB_USE_CRYPTO
+
 // GF(2^8) stuff
 
 #define WPOLY   0x011B
@@ -128,7 +134,13 @@ static byte is_box (byte x)
 #endif
 }
 
+#endif // !AESLIB_USE_CRYPTO
 
+
+#if defined(__AVR__) || defined(__x86_64)
+
+// AVR has no wider registers, and on x86 the compiler already turns these
+// byte loops into 128-bit moves
 static void xor_block (byte * d, const byte * s)
 {
   for (byte i = 0 ; i < N_BLOCK ; i += 4)
@@ -140,6 +152,7 @@ static void xor_block (byte * d, const byte * s)
     }
 }
 
+#if !AESLIB_USE_CRYPTO
 static void copy_and_key (byte * d, const byte * s, const byte * k)
 {
   for (byte i = 0 ; i < N_BLOCK ; i += 4)
@@ -150,9 +163,51 @@ static void copy_and_key (byte * d, const byte * s, const byte * k)
       *d++ = *s++ ^ *k++ ;
     }
 }
+#endif
+
+#else
+
+// 32-bit cores move the block a word at a time; memcpy() keeps the loads
+// legal for unaligned buffers and compiles to plain word moves
+typedef uint32_t block_word ;
+
+static void xor_block (byte * d, const byte * s)
+{
+  for (byte i = 0 ; i < N_BLOCK ; i += sizeof (block_word))
+    {
+      block_word x, y ;
+      memcpy (&x, d + i, sizeof (x)) ;
+      memcpy (&y, s + i, sizeof (y)) ;
+      x ^= y ;
+      memcpy (d + i, &x, sizeof (x)) ;
+    }
+}
+
+#if !AESLIB_USE_CRYPTO
+static void copy_and_key (byte * d, const byte * s, const byte * k)
+{
+  for (byte i = 0 ; i < N_BLOCK ; i += sizeof (block_word))
+    {
+      block_word x, y ;
+      memcpy (&x, s + i, sizeof (x)) ;
+      memcpy (&y, k + i, sizeof (y)) ;
+      x ^= y ;
+      memcpy (d + i, &x, sizeof (x)) ;
+    }
+}
+#endif
+
+#endif
+
+static void copy_block (byte * d, const byte * s)
+{
+  memcpy (d, s, N_BLOCK) ;
+}
 
 // #define add_round_key(d, k) xor_block (d, k)
 
+#if !AESLIB_USE_CRYPTO
+
 /* SUB ROW PHASE */
 
 static void shift_sub_rows (byte st [N_BLOCK])
@@ -232,6 +287,8 @@ static void inv_mix_sub_columns (byte dt[N_BLOCK], const byte st[N_BLOCK])
     }
 }
 
+#endif // !AESLIB_USE_CRYPTO
+
 /******************************************************************************/
 
 AES::AES(){
@@ -254,13 +311,20 @@ AES::AES(){
   arr_pad[14] = 0xb8;
   // arr_pad[15] = 0xbf; // padding past end of array which has 15 elements
   padmode = paddingMode::Array; // backwards compatibility
+  round = 0 ;
+}
+
+AES::~AES(){
+  clean () ;
 }
 
 /******************************************************************************/
 
 byte AES::set_key (const byte key [], uint16_t keylen)
 {
-  byte hi ;
+#if AESLIB_USE_CRYPTO
+  clean () ;
+#endif
   switch (keylen)
     {
     case 16:
@@ -282,7 +346,17 @@ byte AES::set_key (const byte key [], uint16_t keylen)
       round = 0;
       return FAILURE;
     }
-  hi = (round + 1) << 4 ;
+#if AESLIB_USE_CRYPTO
+  BlockCipher *e ;
+  if (round == 10)
+    e = new (engine_buf) AES128 () ;
+  else if (round == 12)
+    e = new (engine_buf) AES192 () ;
+  else
+    e = new (engine_buf) AES256 () ;
+  e->setKey (key, keylen) ;
+#else
+  byte hi = (round + 1) << 4 ;
   copy_n_bytes (key_sched, key, keylen) ;
   byte t[4] ;
   byte next = keylen ;
@@ -309,6 +383,7 @@ byte AES::set_key (const byte key [], uint16_t keylen)
       for (byte i = 0 ; i < N_COL ; i++)
         key_sched [cc + i] = key_sched [tt + i] ^ t[i] ;
     }
+#endif
   return SUCCESS ;
 }
 
@@ -316,25 +391,43 @@ byte AES::set_key (const byte key [], uint16_t keylen)
 
 void AES::clean ()
 {
+#if AESLIB_USE_CRYPTO
+  BlockCipher *e = engine () ;
+  if (e)
+    e->~BlockCipher () ;  // the Crypto destructor wipes its key schedule
+#else
   for (byte i = 0 ; i < KEY_SCHEDULE_BYTES ; i++)
     key_sched [i] = 0 ;
+#endif
   round = 0 ;
 }
 
+#if AESLIB_USE_CRYPTO
+
 /******************************************************************************/
 
-void AES::copy_n_bytes (byte * d, const byte * s, byte nn)
+BlockCipher *AES::engine ()
 {
-  while (nn >= 4)
+  switch (round)
     {
-      *d++ = *s++ ;  // some unrolling
-      *d++ = *s++ ;
-      *d++ = *s++ ;
-      *d++ = *s++ ;
-      nn -= 4 ;
+    case 10:
+      return reinterpret_cast<AES128 *> (engine_buf) ;
+    case 12:
+      return reinterpret_cast<AES192 *> (engine_buf) ;
+    case 14:
+      return reinterpret_cast<AES256 *> (engine_buf) ;
+    default:
+      return 0 ;
     }
-  while (nn--)
-    *d++ = *s++ ;
+}
+
+#endif
+
+/******************************************************************************/
+
+void AES::copy_n_bytes (byte * d, const byte * s, byte nn)
+{
+  memcpy (d, s, nn) ;
 }
 
 /******************************************************************************/
@@ -349,6 +442,13 @@ uint8_t AES::getrandom()
 
 byte AES::encrypt (const byte plain [N_BLOCK], byte cipher [N_BLOCK])
 {
+#if AESLIB_USE_CRYPTO
+  BlockCipher *e = engine () ;
+  if (!e)
+    return FAILURE ;
+  e->encryptBlock (cipher, plain) ;
+  return SUCCESS ;
+#else
   if (round)
     {
       byte s1 [N_BLOCK], r ;
@@ -366,6 +466,7 @@ byte AES::encrypt (const byte plain [N_BLOCK], byte cipher [N_BLOCK])
   else
     return FAILURE ;
   return SUCCESS ;
+#endif
 }
 
 /******************************************************************************/
@@ -377,7 +478,7 @@ byte AES::cbc_encrypt (const byte * plain, byte * cipher, int n_block, byte iv [
       xor_block (iv, plain) ;
       if (encrypt (iv, iv) != SUCCESS)
         return FAILURE ;
-      copy_n_bytes (cipher, iv, N_BLOCK) ;
+      copy_block (cipher, iv) ;
       plain  += N_BLOCK ;
       cipher += N_BLOCK ;
     }
@@ -388,6 +489,13 @@ byte AES::cbc_encrypt (const byte * plain, byte * cipher, int n_block, byte iv [
 
 byte AES::decrypt (const byte plain [N_BLOCK], byte cipher [N_BLOCK])
 {
+#if AESLIB_USE_CRYPTO
+  BlockCipher *e = engine () ;
+  if (!e)
+    return FAILURE ;
+  e->decryptBlock (cipher, plain) ;
+  return SUCCESS ;
+#else
   if (round)
     {
       byte s1 [N_BLOCK] ;
@@ -405,23 +513,32 @@ byte AES::decrypt (const byte plain [N_BLOCK], byte cipher [N_BLOCK])
   else
     return FAILURE ;
   return SUCCESS ;
+#endif
 }
 
 /******************************************************************************/
 
 byte AES::cbc_decrypt (const byte * cipher, byte * plain, int n_block, byte iv [N_BLOCK])
 {
-  while (n_block--)
+  if (n_block <= 0)
+    return SUCCESS ;
+  if (!round)
+    return FAILURE ;
+
+  // Blocks are independent once their chaining input is known, so walk
+  // from the last one back: the previous ciphertext block is then still
+  // intact when plain and cipher are the same buffer, and only the next
+  // IV needs saving instead of a copy of every block.
+  byte next_iv [N_BLOCK] ;
+  copy_block (next_iv, cipher + (n_block - 1) * N_BLOCK) ;
+  for (int i = n_block - 1 ; i > 0 ; i--)
     {
-      byte tmp [N_BLOCK] ;
-      copy_n_bytes (tmp, cipher, N_BLOCK) ;
-      if (decrypt (cipher, plain) != SUCCESS)
-        return FAILURE ;
-      xor_block (plain, iv) ;
-      copy_n_bytes (iv, tmp, N_BLOCK) ;
-      plain  += N_BLOCK ;
-      cipher += N_BLOCK;
+      decrypt (cipher + i * N_BLOCK, plain + i * N_BLOCK) ;
+      xor_block (plain + i * N_BLOCK, cipher + (i - 1) * N_BLOCK) ;
     }
+  decrypt (cipher, plain) ;
+  xor_block (plain, iv) ;
+  copy_block (iv, next_iv) ;
   return SUCCESS ;
 }
 
@@ -508,32 +625,43 @@ int AES::get_pad_len(int p_size){
 /******************************************************************************/
 void AES::padPlaintext(const void* in,byte* out)
 {
-  memcpy(out,in,size);
-  for (int i = size-pad; i < size; i++){;
+  if (pad == 0){
+    memcpy(out,in,size);
+  }else{
+    memcpy(out,in,size-N_BLOCK);
+    padLastBlock((const byte*)in + size - N_BLOCK, out + size - N_BLOCK);
+  }
+}
+
+/******************************************************************************/
+void AES::padLastBlock(const void* in,byte block[N_BLOCK])
+{
+  int used = N_BLOCK - pad;
+  memcpy(block,in,used);
+  for (int i = used; i < N_BLOCK; i++){
     switch (padmode){
       case paddingMode::CMS :
-        out[i] = pad;
+        block[i] = pad;
         break;
       case paddingMode::Bit:
       case paddingMode::ZeroLength:
       case paddingMode::Null:
-        out[i] = 0x00;
+        block[i] = 0x00;
         break;
       case paddingMode::Space:
-        out[i] = 0x20;
+        block[i] = 0x20;
         break;
       case paddingMode::Array:
-        out[i] = arr_pad[pad - 1];
+        block[i] = arr_pad[pad - 1];
         break;
       case paddingMode::Random:
-        out[i] = getrandom();
+        block[i] = getrandom();
     }
   }
-  if (padmode == paddingMode::Bit)
-    out[size-pad] = 0x80;
-  if (padmode == paddingMode::ZeroLength)
-    out[size-1] = pad;
-
+  if (pad > 0 && padmode == paddingMode::Bit)
+    block[used] = 0x80;
+  if (pad > 0 && padmode == paddingMode::ZeroLength)
+    block[N_BLOCK-1] = pad;
 }
 
 /******************************************************************************/
@@ -634,22 +762,247 @@ void AES::printArray(const byte output[],int sizel)
 /******************************************************************************/
 
 void AES::do_aes_encrypt(const byte *plain,int size_p,byte *cipher, const byte *key, int bits, byte ivl [N_BLOCK]){
-  calc_size_n_pad(size_p);
-  byte plain_p[get_size()];
-  padPlaintext(plain,plain_p);
-
-  int blocks = get_size() / N_BLOCK;
   set_key (key, bits) ;
-  cbc_encrypt (plain_p, cipher, blocks, ivl);
+  do_aes_encrypt (plain, size_p, cipher, ivl);
 }
 
 /******************************************************************************/
 
 int AES::do_aes_decrypt(const byte *cipher,int size_c,byte *plain,const byte *key, int bits, byte ivl [N_BLOCK]){
+  set_key (key, bits);
+  return do_aes_decrypt (cipher, size_c, plain, ivl);
+}
+
+/******************************************************************************/
+
+void AES::do_aes_encrypt(const byte *plain,int size_p,byte *cipher, byte ivl [N_BLOCK]){
+  calc_size_n_pad(size_p);
+
+  // full plaintext blocks go straight to the output, only the last one is padded
+  int blocks = (size - pad) / N_BLOCK;
+  cbc_encrypt (plain, cipher, blocks, ivl);
+  if (pad > 0){
+    byte last[N_BLOCK];
+    padLastBlock(plain + blocks * N_BLOCK, last);
+    cbc_encrypt (last, cipher + blocks * N_BLOCK, 1, ivl);
+  }
+}
+
+/******************************************************************************/
+
+int AES::do_aes_decrypt(const byte *cipher,int size_c,byte *plain, byte ivl [N_BLOCK]){
   set_size(size_c);
   int blocks = size_c / N_BLOCK;
-  set_key (key, bits);
   cbc_decrypt (cipher,plain, blocks, ivl);
   return get_unpadded_len(plain,size_c);
 }
 
+/******************************************************************************
+ *  CTR and GCM on top of encrypt(), no padding.
+ */
+
+/* adds n to a 128-bit big-endian counter block */
+static void ctr_add (byte ctr [N_BLOCK], uint32_t n)
+{
+  for (int i = N_BLOCK - 1 ; i >= 0 && n ; i--)
+    {
+      n += ctr [i] ;
+      ctr [i] = (byte) n ;
+      n >>= 8 ;
+    }
+}
+
+/* GCM increments the low 32 bits of the counter only */
+static void gcm_inc32 (byte ctr [N_BLOCK])
+{
+  for (int i = N_BLOCK - 1 ; i >= N_BLOCK - 4 ; i--)
+    if (++ctr [i])
+      break ;
+}
+
+/* x = x * h in GF(2^128), bit-serially as in NIST SP 800-38D */
+static void gf_mult (byte x [N_BLOCK], const byte h [N_BLOCK])
+{
+  byte z [N_BLOCK] ;
+  byte v [N_BLOCK] ;
+  memset (z, 0, N_BLOCK) ;
+  copy_block (v, h) ;
+  for (int i = 0 ; i < 128 ; i++)
+    {
+      if (x [i >> 3] & (0x80 >> (i & 7)))
+        xor_block (z, v) ;
+      byte lsb = v [N_BLOCK - 1] & 1 ;
+      for (int j = N_BLOCK - 1 ; j > 0 ; j--)
+        v [j] = (v [j] >> 1) | (v [j - 1] << 7) ;
+      v [0] >>= 1 ;
+      if (lsb)
+        v [0] ^= 0xe1 ;
+    }
+  copy_block (x, z) ;
+}
+
+/* absorbs data into the GHASH state y, zero-padding the last block */
+static void ghash_update (byte y [N_BLOCK], const byte h [N_BLOCK], const byte *data, int len)
+{
+  while (len > 0)
+    {
+      int n = len < N_BLOCK ? len : N_BLOCK ;
+      for (int i = 0 ; i < n ; i++)
+        y [i] ^= data [i] ;
+      gf_mult (y, h) ;
+      data += n ;
+      len -= n ;
+    }
+}
+
+/* absorbs the bit lengths of the two inputs as 64-bit big-endian values */
+static void ghash_lengths (byte y [N_BLOCK], const byte h [N_BLOCK], uint32_t len_a, uint32_t len_b)
+{
+  byte block [N_BLOCK] ;
+  uint64_t bits_a = (uint64_t) len_a * 8 ;
+  uint64_t bits_b = (uint64_t) len_b * 8 ;
+  for (int i = 0 ; i < 8 ; i++)
+    {
+      block [7 - i] = (byte) (bits_a >> (8 * i)) ;
+      block [15 - i] = (byte) (bits_b >> (8 * i)) ;
+    }
+  ghash_update (y, h, block, N_BLOCK) ;
+}
+
+/******************************************************************************/
+
+byte AES::ctr_crypt (const byte *in, byte *out, int len, const byte ctr [N_BLOCK], uint32_t offset)
+{
+  if (!round)
+    return FAILURE ;
+
+  byte counter [N_BLOCK] ;
+  byte stream [N_BLOCK] ;
+  int skip = offset % N_BLOCK ;
+  copy_block (counter, ctr) ;
+  ctr_add (counter, offset / N_BLOCK) ;
+  while (len > 0)
+    {
+      encrypt (counter, stream) ;
+      ctr_add (counter, 1) ;
+      int n = N_BLOCK - skip ;
+      if (n > len)
+        n = len ;
+      for (int i = 0 ; i < n ; i++)
+        out [i] = in [i] ^ stream [skip + i] ;
+      in += n ;
+      out += n ;
+      len -= n ;
+      skip = 0 ;
+    }
+  memset (stream, 0, N_BLOCK) ;
+  return SUCCESS ;
+}
+
+/******************************************************************************/
+
+void AES::gcm_ctr (const byte *in, byte *out, int len, byte counter [N_BLOCK])
+{
+  // unlike ctr_crypt(), GCM wraps the low 32 bits of the counter, which
+  // matters when J0 comes from hashing an IV that is not 12 bytes long
+  byte stream [N_BLOCK] ;
+  while (len > 0)
+    {
+      gcm_inc32 (counter) ;
+      encrypt (counter, stream) ;
+      int n = len < N_BLOCK ? len : N_BLOCK ;
+      for (int i = 0 ; i < n ; i++)
+        out [i] = in [i] ^ stream [i] ;
+      in += n ;
+      out += n ;
+      len -= n ;
+    }
+  memset (stream, 0, N_BLOCK) ;
+}
+
+/******************************************************************************/
+
+void AES::gcm_init (const byte *iv, int iv_len, byte h [N_BLOCK], byte j0 [N_BLOCK])
+{
+  memset (h, 0, N_BLOCK) ;
+  encrypt (h, h) ;
+  if (iv_len == 12)
+    {
+      memcpy (j0, iv, 12) ;
+      j0 [12] = 0 ;
+      j0 [13] = 0 ;
+      j0 [14] = 0 ;
+      j0 [15] = 1 ;
+    }
+  else
+    {
+      memset (j0, 0, N_BLOCK) ;
+      ghash_update (j0, h, iv, iv_len) ;
+      ghash_lengths (j0, h, 0, iv_len) ;
+    }
+}
+
+/******************************************************************************/
+
+void AES::gcm_hash (const byte h [N_BLOCK], const byte *aad, int aad_len, const byte *cipher, int len, byte y [N_BLOCK])
+{
+  memset (y, 0, N_BLOCK) ;
+  ghash_update (y, h, aad, aad_len) ;
+  ghash_update (y, h, cipher, len) ;
+  ghash_lengths (y, h, aad_len, len) ;
+}
+
+/******************************************************************************/
+
+byte AES::gcm_encrypt (const byte *iv, int iv_len, const byte *aad, int aad_len, const byte *plain, byte *cipher, int len, byte tag [N_BLOCK])
+{
+  if (!round || iv_len <= 0)
+    return FAILURE ;
+
+  byte h [N_BLOCK] ;
+  byte j0 [N_BLOCK] ;
+  byte counter [N_BLOCK] ;
+  byte y [N_BLOCK] ;
+  gcm_init (iv, iv_len, h, j0) ;
+
+  copy_block (counter, j0) ;
+  gcm_ctr (plain, cipher, len, counter) ;
+
+  gcm_hash (h, aad, aad_len, cipher, len, y) ;
+  encrypt (j0, tag) ;
+  xor_block (tag, y) ;
+  memset (h, 0, N_BLOCK) ;
+  return SUCCESS ;
+}
+
+/******************************************************************************/
+
+byte AES::gcm_decrypt (const byte *iv, int iv_len, const byte *aad, int aad_len, const byte *cipher, byte *plain, int len, const byte *tag, int tag_len)
+{
+  if (!round || iv_len <= 0 || tag_len < 4 || tag_len > N_BLOCK)
+    return FAILURE ;
+
+  byte h [N_BLOCK] ;
+  byte j0 [N_BLOCK] ;
+  byte counter [N_BLOCK] ;
+  byte y [N_BLOCK] ;
+  byte expected [N_BLOCK] ;
+  gcm_init (iv, iv_len, h, j0) ;
+  gcm_hash (h, aad, aad_len, cipher, len, y) ;
+  encrypt (j0, expected) ;
+  xor_block (expected, y) ;
+  memset (h, 0, N_BLOCK) ;
+
+  // compare in constant time, and only decrypt an authentic message
+  byte diff = 0 ;
+  for (int i = 0 ; i < tag_len ; i++)
+    diff |= expected [i] ^ tag [i] ;
+  memset (expected, 0, N_BLOCK) ;
+  if (diff)
+    return FAILURE ;
+
+  copy_block (counter, j0) ;
+  gcm_ctr (cipher, plain, len, counter) ;
+  return SUCCESS ;
+}
+
@@ -2,6 +2,10 @@
 #define __AES_H__
 
 #include "AES_config.h"
+#if AESLIB_USE_CRYPTO
+#include <BlockCipher.h>           // makes the IDE link the Crypto library
+#include "../../Crypto/src/AES.h"  // by path, <AES.h> may resolve to this file
+#endif
 /*
  ---------------------------------------------------------------------------
  Copyright (c) 1998-2008, Brian Gladman, Worcester, UK. All rights reserved.
@@ -65,6 +69,10 @@ class AES
   * This function initialized an instance of AES.
   */
   AES();
+  /** \fn ~AES()
+  * \brief AES destructor, wipes the key schedule.
+  */
+  ~AES();
 
   /** Set the cipher key for the pre-keyed version.
    *  @param key[] pointer to the key string.
@@ -212,6 +220,16 @@ class AES
    * @return no return, The padded plaintext is stored in the out pointer.
    */
   void padPlaintext(const void* in,byte* out);
+  /** Pads the last block of the plaintext
+   *
+   * Builds the final cipher block from the plaintext bytes that do not fill
+   * a whole block, followed by the padding computed by calc_size_n_pad().
+   * Unlike padPlaintext() it needs N_BLOCK bytes of scratch only.
+   *
+   * @param in the plaintext bytes of the last block (N_BLOCK - pad bytes)
+   * @param block the padded block of N_BLOCK bytes.
+   */
+  void padLastBlock(const void* in,byte block[N_BLOCK]);
 
   /** Check the if the padding is correct.
    *
@@ -281,10 +299,95 @@ class AES
    */
   int do_aes_decrypt(const byte *cipher,int size_c,byte *plain,const byte *key, int bits, byte ivl [N_BLOCK]);
 
+  /** AES-CBC encryption with the key schedule from set_key().
+   *
+   * Same as do_aes_encrypt() with a key, without expanding the key again.
+   * Call set_key() once and reuse the schedule for every message.
+   * Only the last block is padded on the stack, so cipher may point to the
+   * plaintext buffer when it has room for get_padded_len(size_p) bytes.
+   *
+   * @param *plain pointer to the plaintext
+   * @param size_p size of the plaintext
+   * @param *cipher pointer to the ciphertext
+   * @param ivl[N_BLOCK] the initialization vector IV that will be used for encryption.
+   */
+  void do_aes_encrypt(const byte *plain,int size_p,byte *cipher, byte ivl [N_BLOCK]);
+
+  /** AES-CBC decryption with the key schedule from set_key().
+   *
+   * plain may point to the ciphertext buffer to decrypt in place.
+   *
+   * @param *cipher pointer to the ciphertext
+   * @param size_c size of the ciphertext
+   * @param *plain pointer to the plaintext
+   * @param ivl[N_BLOCK] the initialization vector IV that will be used for decryption.
+   * @return length of the unpadded plaintext.
+   */
+  int do_aes_decrypt(const byte *cipher,int size_c,byte *plain, byte ivl [N_BLOCK]);
+  /** AES-CTR encryption or decryption with the key schedule from set_key().
+   *
+   * The keystream block for byte offset n is E(ctr + n / N_BLOCK), the
+   * counter being a 128-bit big-endian integer (NIST SP 800-38A). Any part
+   * of a record can therefore be processed on its own by passing its byte
+   * offset, without running the keystream from the start. No padding is
+   * added and out may point to in.
+   *
+   * @param *in pointer to the input
+   * @param *out pointer to the output, len bytes
+   * @param len number of bytes to process
+   * @param ctr[N_BLOCK] the initial counter block, left unchanged.
+   * @param offset byte offset of in within the record.
+   * @return 0 if SUCCESS or -1 if FAILURE
+   */
+  byte ctr_crypt(const byte *in, byte *out, int len, const byte ctr [N_BLOCK], uint32_t offset = 0);
+  /** AES-GCM authenticated encryption with the key schedule from set_key().
+   *
+   * @param *iv pointer to the IV, 12 bytes recommended
+   * @param iv_len length of the IV
+   * @param *aad pointer to the data that is authenticated but not encrypted
+   * @param aad_len length of aad
+   * @param *plain pointer to the plaintext
+   * @param *cipher pointer to the ciphertext, len bytes, may be plain.
+   * @param len length of the plaintext
+   * @param tag[N_BLOCK] the authentication tag, may be truncated by the caller.
+   * @return 0 if SUCCESS or -1 if FAILURE
+   */
+  byte gcm_encrypt(const byte *iv, int iv_len, const byte *aad, int aad_len, const byte *plain, byte *cipher, int len, byte tag [N_BLOCK]);
+  /** AES-GCM authenticated decryption with the key schedule from set_key().
+   *
+   * The tag is checked before anything is decrypted, so plain is left
+   * untouched when it does not match.
+   *
+   * @param *iv pointer to the IV
+   * @param iv_len length of the IV
+   * @param *aad pointer to the authenticated data
+   * @param aad_len length of aad
+   * @param *cipher pointer to the ciphertext
+   * @param *plain pointer to the plaintext, len bytes, may be cipher.
+   * @param len length of the ciphertext
+   * @param *tag pointer to the received tag
+   * @param tag_len length of the tag, 4 to N_BLOCK bytes.
+   * @return 0 if SUCCESS or -1 if FAILURE or the tag does not match
+   */
+  byte gcm_decrypt(const byte *iv, int iv_len, const byte *aad, int aad_len, const byte *cipher, byte *plain, int len, const byte *tag, int tag_len);
+
  private:
+  /** GCTR of GCM: encrypts with the counters after the one passed in. */
+  void gcm_ctr(const byte *in, byte *out, int len, byte counter [N_BLOCK]);
+  /** Derives H and the pre-counter block J0 of GCM from the IV. */
+  void gcm_init(const byte *iv, int iv_len, byte h [N_BLOCK], byte j0 [N_BLOCK]);
+  /** GHASH of aad and the ciphertext, including the length block. */
+  void gcm_hash(const byte h [N_BLOCK], const byte *aad, int aad_len, const byte *cipher, int len, byte y [N_BLOCK]);
+
   byte round ;/**< holds the number of rounds to be used. */
   paddingMode padmode;
+#if AESLIB_USE_CRYPTO
+  BlockCipher *engine () ;/**< the Crypto cipher matching round, 0 before set_key(). */
+  alignas (AES256) byte engine_buf [sizeof (AES128) > sizeof (AES256) ? sizeof (AES128) :
+                                    sizeof (AES192) > sizeof (AES256) ? sizeof (AES192) : sizeof (AES256)] ;/**< holds the Crypto cipher and its key schedule. */
+#else
   byte key_sched [KEY_SCHEDULE_BYTES] ;/**< holds the pre-computed key for the encryption/decrpytion. */
+#endif
   int pad;/**< holds the size of the padding. */
   int size;/**< hold the size of the plaintext to be ciphered */
   byte arr_pad[15] = { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 };/**< holds the hexadecimal padding values */
@@ -59,7 +59,6 @@ void AESLib::clean() {
 /* Returns message encrypted only to be used as byte array. TODO: Refactor to byte[] */
 uint16_t AESLib::encrypt(const byte input[], uint16_t input_length, byte *output, const byte key[], int bits, byte my_iv[]) {
 
-  aes.set_key(key, bits);
   aes.do_aes_encrypt((byte *)input, input_length, (byte*)output, key, bits, my_iv);
 
   uint16_t enc_len = aes.get_size();
@@ -93,72 +92,112 @@ uint16_t AESLib::decrypt(byte input[], uint16_t input_length, byte *plain, const
 }
 
 //
-// Deprecated de/encryption for Arduino Strings
+// Pre-keyed de/encryption: the key schedule is expanded once by set_key()
 //
 
-#ifndef __x86_64
+byte AESLib::set_key(const byte key[], int bits) {
+  return aes.set_key(key, bits);
+}
 
-/* Returns message encrypted and base64 encoded to be used as string. */
-uint16_t AESLib::encrypt64(const byte *msg, uint16_t msgLen, char *output, const byte key[],int bits, byte my_iv[]) {
+uint16_t AESLib::encrypt(const byte input[], uint16_t input_length, byte *output, byte my_iv[]) {
+  aes.do_aes_encrypt(input, input_length, output, my_iv);
+  return aes.get_size();
+}
 
-  aes.set_key(key, bits);
+uint16_t AESLib::decrypt(byte input[], uint16_t input_length, byte *plain, byte my_iv[]) {
+  return aes.do_aes_decrypt(input, input_length, plain, my_iv);
+}
 
-  int paddedLen = aes.get_padded_len(msgLen);
+//
+// Unpadded CTR and GCM with the set_key() schedule
+//
 
-  // Serial.print("- Expected padded length "); Serial.print(paddedLen); Serial.println(" bytes");
+byte AESLib::ctr_crypt(const byte input[], uint16_t input_length, byte *output, const byte ctr[], uint32_t offset) {
+  return aes.ctr_crypt(input, output, input_length, ctr, offset);
+}
 
-  byte cipher[paddedLen];
-  aes.do_aes_encrypt((byte *)msg, msgLen, cipher, key, bits, my_iv);
+byte AESLib::gcm_encrypt(const byte iv[], int iv_length, const byte aad[], int aad_length, const byte input[], uint16_t input_length, byte *output, byte tag[]) {
+  return aes.gcm_encrypt(iv, iv_length, aad, aad_length, input, output, input_length, tag);
+}
 
-  uint16_t encrypted_length = aes.get_size();
+byte AESLib::gcm_decrypt(const byte iv[], int iv_length, const byte aad[], int aad_length, const byte input[], uint16_t input_length, byte *output, const byte tag[], int tag_length) {
+  return aes.gcm_decrypt(iv, iv_length, aad, aad_length, input, output, input_length, tag, tag_length);
+}
 
-  // only this method can return b64
-  encrypted_length = base64_encode(output, (char *)cipher, aes.get_size() );
+//
+// Base64 de/encryption, streamed through a small chunk buffer
+//
 
-  return encrypted_length;
-}
+/* Returns message encrypted and base64 encoded to be used as string. */
+uint16_t AESLib::encrypt64(const byte *msg, uint16_t msgLen, char *output, const byte key[],int bits, byte my_iv[]) {
 
-/* Suggested size for the plaintext buffer is 1/2 length of `msg`. Refactor! */
-uint16_t AESLib::decrypt64(char *msg, uint16_t msgLen, byte *plain, const byte key[],int bits, byte my_iv[]) {
+  int blocks = aes.get_padded_len(msgLen) / N_BLOCK;
+  int full = msgLen / N_BLOCK; // blocks that need no padding
+  uint16_t encrypted_length = 0;
 
-#ifdef AES_DEBUG
-  Serial.println("[decrypt64] decrypting message:  ");
-#endif
+  // AES64_CHUNK_BLOCKS blocks are a whole number of base64 groups, so the
+  // chunks encode back to back without '=' in between
+  byte chunk[AES64_CHUNK_BLOCKS * N_BLOCK];
+  int n = 0;
 
   aes.set_key(key, bits);
+  for (int block = 0; block < blocks; block++) {
+    if (block < full) {
+      aes.cbc_encrypt(msg + block * N_BLOCK, chunk + n * N_BLOCK, 1, my_iv);
+    } else {
+      byte last[N_BLOCK];
+      aes.padLastBlock(msg + block * N_BLOCK, last);
+      aes.cbc_encrypt(last, chunk + n * N_BLOCK, 1, my_iv);
+    }
+    n++;
+    if (n == AES64_CHUNK_BLOCKS || block == blocks - 1) {
+      encrypted_length += base64_encode(output + encrypted_length, (char *)chunk, n * N_BLOCK);
+      n = 0;
+    }
+  }
+  if (blocks == 0)
+    output[0] = '\0';
 
-#ifdef AES_DEBUG
-  Serial.print("[decrypt64] msgLen (strlen msg):  "); Serial.println(msgLen);
-#endif
+  return encrypted_length;
+}
 
-  // decoded base64 takes some space, but less than original...
-  // it should therefore never overfill when reusing the msg-text buffer
-  char *msgOut = (char*)malloc(msgLen);
-  int b64len = base64_decode(msgOut, msg, msgLen);
+/* Suggested size for the plaintext buffer is 3/4 length of `msg`. */
+uint16_t AESLib::decrypt64(char *msg, uint16_t msgLen, byte *plain, const byte key[],int bits, byte my_iv[]) {
 
-  // decrypting will keep the message length
 #ifdef AES_DEBUG
-  Serial.print("[decrypt64] base64_decode allocating decrypt buffer len:  "); Serial.println(b64len);
+  Serial.print("[decrypt64] msgLen (strlen msg):  "); Serial.println(msgLen);
 #endif
 
-#ifdef AES_DEBUG
-#ifdef ESP8266
-  Serial.print("[decrypt64] free heap: "); Serial.println(ESP.getFreeHeap());
-#endif
-#endif
+  // base64_decode() terminates its output, hence the extra byte
+  char chunk[AES64_CHUNK_BLOCKS * N_BLOCK + 1];
+  int chunkChars = base64_enc_len(AES64_CHUNK_BLOCKS * N_BLOCK);
+  int plain_len = 0;
 
-  int plain_len = aes.do_aes_decrypt((byte *)msgOut, b64len, (byte*)plain, key, bits, (byte *)my_iv);
+  aes.set_key(key, bits);
+  for (int posn = 0; posn < msgLen; posn += chunkChars) {
+    int len = msgLen - posn;
+    if (len > chunkChars)
+      len = chunkChars;
+    int b64len = base64_decode(chunk, msg + posn, len);
+    int blocks = b64len / N_BLOCK;
+    aes.cbc_decrypt((byte *)chunk, plain + plain_len, blocks, my_iv);
+    plain_len += blocks * N_BLOCK;
+    if (b64len < AES64_CHUNK_BLOCKS * N_BLOCK)
+      break; // '=' or a short final group ends the message
+  }
+  memset(chunk, 0, sizeof(chunk));
+
+  aes.set_size(plain_len);
+  if (plain_len > 0)
+    plain_len = aes.get_unpadded_len(plain, plain_len);
 
-  free(msgOut);
-  
   // ToWI: 2021-01-22: Check the padding length, negative value means deciphering error and cause ESP restarts due to stack smashing error
   if (plain_len < 0)
       return 0;
-    
+
 #ifdef AES_DEBUG
   Serial.print("[decrypt64] do_aes_decrypt->plain_len =  "); Serial.println(plain_len);
 #endif
 
   return plain_len;
 }
-#endif
@@ -36,6 +36,12 @@
 //#define AES_DEBUG
 #endif
 
+// Cipher blocks per base64 chunk in encrypt64()/decrypt64(); must be a
+// multiple of 3 so that each chunk is a whole number of base64 groups
+#ifndef AES64_CHUNK_BLOCKS
+#define AES64_CHUNK_BLOCKS 3
+#endif
+
 class AESLib
 {
   public:
@@ -48,12 +54,20 @@ class AESLib
     void set_paddingmode(paddingMode mode);
     paddingMode get_paddingmode();
 
-    uint16_t encrypt64(const byte *input, uint16_t input_length, char *output, const byte key[],int bits, byte my_iv[]); // base64 encode, encrypt and base64 encode again; will deprecate
+    uint16_t encrypt64(const byte *input, uint16_t input_length, char *output, const byte key[],int bits, byte my_iv[]); // encrypt and base64 encode in chunks, no message-sized buffer
     uint16_t encrypt(const byte input[], uint16_t input_length, byte *output, const byte key[],int bits, byte my_iv[]); // base64 encode and encrypt; should encode on output only (if)
 
-    uint16_t decrypt64(char *input, uint16_t input_length, byte *output, const byte key[],int bits, byte my_iv[]); // decode, decrypt and decode
+    uint16_t decrypt64(char *input, uint16_t input_length, byte *output, const byte key[],int bits, byte my_iv[]); // base64 decode and decrypt in chunks, no heap
     uint16_t decrypt(byte input[], uint16_t input_length, byte *output, const byte key[], int bits, byte my_iv[]); // decrypts and decodes (expects encoded)
 
+    byte set_key(const byte key[], int bits); // expands the key schedule once for the pre-keyed calls below
+    uint16_t encrypt(const byte input[], uint16_t input_length, byte *output, byte my_iv[]); // encrypt with the set_key() schedule
+    uint16_t decrypt(byte input[], uint16_t input_length, byte *output, byte my_iv[]); // decrypt with the set_key() schedule
+
+    byte ctr_crypt(const byte input[], uint16_t input_length, byte *output, const byte ctr[], uint32_t offset = 0); // CTR with the set_key() schedule, seekable by byte offset
+    byte gcm_encrypt(const byte iv[], int iv_length, const byte aad[], int aad_length, const byte input[], uint16_t input_length, byte *output, byte tag[]); // GCM with the set_key() schedule, 16-byte tag
+    byte gcm_decrypt(const byte iv[], int iv_length, const byte aad[], int aad_length, const byte input[], uint16_t input_length, byte *output, const byte tag[], int tag_length); // SUCCESS only if the tag matches
+
 #ifndef __x86_64
     String decrypt(String msg, byte key[],int bits, byte my_iv[]) __attribute__((deprecated)); // decode, decrypt, decode and return as String
     String encrypt(String msg, byte key[], int bits, byte my_iv[]) __attribute__((deprecated)); // encode, encrypt, encode and return as String
@@ -51,4 +51,12 @@
 #define SUCCESS (0)
 #define FAILURE (-1)
 
+// Set to 1 to run AES::encrypt()/decrypt() on the AES128/AES192/AES256
+// classes of the Crypto library, and so on its hardware backends such as
+// AESEsp32, instead of the byte-oriented core in AES.cpp. The S-boxes and
+// round functions of AES.cpp are then left out of the build.
+#ifndef AESLIB_USE_CRYPTO
+#define AESLIB_USE_CRYPTO 0
+#endif
+
 #endif
@@ -15,6 +15,26 @@ const char PROGMEM b64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
     "abcdefghijklmnopqrstuvwxyz"
     "0123456789+/";
 
+/* Reverse of b64_alphabet, 0xff for characters outside the alphabet */
+const unsigned char PROGMEM b64_reverse[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+  0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
 /* 'Private' declarations */
 inline void a3_to_a4(unsigned char * a4, const unsigned char * a3);
 inline void a4_to_a3(unsigned char * a3, const unsigned char * a4);
@@ -141,10 +161,119 @@ inline void a4_to_a3(unsigned char * a3, const unsigned char * a4) {
 }
 
 inline unsigned char b64_lookup(char c) {
-  if(c >='A' && c <='Z') return c - 'A';
-  if(c >='a' && c <='z') return c - 71;
-  if(c >='0' && c <='9') return c + 4;
-  if(c == '+') return 62;
-  if(c == '/') return 63;
-  return -1;
+#if !defined(__x86_64)
+  return pgm_read_byte(&b64_reverse[(unsigned char)c]);
+#else
+  return b64_reverse[(unsigned char)c];
+#endif
+}
+
+/* Base64Encoder */
+
+Base64Encoder::Base64Encoder() {
+  reset();
+}
+
+void Base64Encoder::reset() {
+  pending = 0;
+}
+
+int Base64Encoder::update(char *output, const char *input, int inputLen) {
+  int encLen = 0;
+  unsigned char a4[4];
+
+  while (inputLen--) {
+    a3[pending++] = *(input++);
+    if (pending == 3) {
+      a3_to_a4(a4, a3);
+      for (int i = 0; i < 4; i++) {
+#if !defined(__x86_64)
+        output[encLen++] = pgm_read_byte(&b64_alphabet[a4[i]]);
+#else
+        output[encLen++] = b64_alphabet[a4[i]];
+#endif
+      }
+      pending = 0;
+    }
+  }
+  return encLen;
+}
+
+int Base64Encoder::finish(char *output) {
+  int encLen = 0;
+  unsigned char a4[4];
+
+  if (pending) {
+    for (int j = pending; j < 3; j++) {
+      a3[j] = '\0';
+    }
+    a3_to_a4(a4, a3);
+    for (int j = 0; j < pending + 1; j++) {
+#if !defined(__x86_64)
+      output[encLen++] = pgm_read_byte(&b64_alphabet[a4[j]]);
+#else
+      output[encLen++] = b64_alphabet[a4[j]];
+#endif
+    }
+    while (encLen < 4) {
+      output[encLen++] = '=';
+    }
+  }
+  output[encLen] = '\0';
+  reset();
+  return encLen;
+}
+
+/* Base64Decoder */
+
+Base64Decoder::Base64Decoder() {
+  reset();
+}
+
+void Base64Decoder::reset() {
+  pending = 0;
+  done = false;
+}
+
+int Base64Decoder::update(char *output, const char *input, int inputLen) {
+  int decLen = 0;
+  unsigned char a3[3];
+
+  while (inputLen-- && !done) {
+    unsigned char c = *(input++);
+    if (c == '=') {
+      done = true;
+      break;
+    }
+    c = b64_lookup(c);
+    if (c == 0xff) {
+      continue; // line breaks and other separators
+    }
+    a4[pending++] = c;
+    if (pending == 4) {
+      a4_to_a3(a3, a4);
+      for (int i = 0; i < 3; i++) {
+        output[decLen++] = a3[i];
+      }
+      pending = 0;
+    }
+  }
+  return decLen;
+}
+
+int Base64Decoder::finish(char *output) {
+  int decLen = 0;
+  unsigned char a3[3];
+
+  if (pending) {
+    for (int j = pending; j < 4; j++) {
+      a4[j] = 0;
+    }
+    a4_to_a3(a3, a4);
+    for (int j = 0; j < pending - 1; j++) {
+      output[decLen++] = a3[j];
+    }
+  }
+  reset();
+  return decLen;
 }
@@ -76,4 +76,57 @@ int base64_enc_len(int inputLen);
  */
 int base64_dec_len(const char *input, int inputLen);
 
+/* Base64Encoder:
+ *    Description:
+ *      Incremental base64 encoder. Input can be fed in chunks of any
+ *      size; the output of all update() calls followed by finish() is the
+ *      same as base64_encode() over the concatenated input
+ *    Usage:
+ *      update(output, input, inputLen) writes the complete groups so far
+ *      and returns their length. output must hold (inputLen + 2) / 3 * 4
+ *      characters and is not null terminated
+ *      finish(output) writes the last group with '=' padding, null
+ *      terminates it and returns its length (0 or 4). output must hold
+ *      5 characters. The encoder is then ready for a new message
+ */
+class Base64Encoder
+{
+  public:
+    Base64Encoder();
+    void reset();
+    int update(char *output, const char *input, int inputLen);
+    int finish(char *output);
+
+  private:
+    unsigned char a3[3];
+    int pending;
+};
+
+/* Base64Decoder:
+ *    Description:
+ *      Incremental base64 decoder. Input can be fed in chunks of any
+ *      size. Characters outside the base64 alphabet, such as line
+ *      breaks, are skipped and decoding stops at the first '='
+ *    Usage:
+ *      update(output, input, inputLen) writes the bytes of the complete
+ *      groups so far and returns their number. output must hold
+ *      (inputLen + 3) / 4 * 3 bytes and is not null terminated
+ *      finish(output) writes the bytes of a trailing partial group and
+ *      returns their number (0 to 2). The decoder is then ready for a
+ *      new message
+ */
+class Base64Decoder
+{
+  public:
+    Base64Decoder();
+    void reset();
+    int update(char *output, const char *input, int inputLen);
+    int finish(char *output);
+
+  private:
+    unsigned char a4[4];
+    int pending;
+    bool done;
+};
+
 #endif // _BASE64_H
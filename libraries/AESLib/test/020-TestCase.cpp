@@ -94,3 +94,208 @@ TEST_CASE( "Encrypted test string has expected length.", "[single-file]" ) {
 TEST_CASE( "Decrypted test string has expected contents.", "[single-file]" ) {
     REQUIRE( decrypt_to_cleartext((byte*)ciphertext, 44, enc_iv_from) == 17 );
 }
+
+TEST_CASE( "Pre-keyed encryption matches the keyed call.", "[single-file]" ) {
+    AESLib keyed;
+    byte iv_a[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte iv_b[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte once[2*INPUT_BUFFER_LIMIT] = {0};
+    byte every[2*INPUT_BUFFER_LIMIT] = {0};
+    byte plain[INPUT_BUFFER_LIMIT] = {0};
+    uint16_t len = strlen(test_string);
+
+    REQUIRE( keyed.set_key(aes_key, sizeof(aes_key)) == SUCCESS );
+    uint16_t once_len = keyed.encrypt((byte*)test_string, len, once, iv_a);
+    uint16_t every_len = aesLib.encrypt((byte*)test_string, len, every, aes_key, sizeof(aes_key), iv_b);
+    REQUIRE( once_len == every_len );
+    REQUIRE( memcmp(once, every, once_len) == 0 );
+
+    byte iv_c[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte iv_d[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte every_plain[INPUT_BUFFER_LIMIT] = {0};
+    REQUIRE( keyed.decrypt(once, once_len, plain, iv_c) ==
+             aesLib.decrypt(every, every_len, every_plain, aes_key, sizeof(aes_key), iv_d) );
+    REQUIRE( memcmp(plain, test_string, len) == 0 );
+}
+
+TEST_CASE( "Chunked base64 encryption matches encrypting in one piece.", "[single-file]" ) {
+    AESLib whole_lib;
+    AESLib chunked;
+    whole_lib.set_paddingmode(paddingMode::CMS);
+    chunked.set_paddingmode(paddingMode::CMS);
+    byte msg[100];
+    for (int i = 0; i < (int)sizeof(msg); i++)
+        msg[i] = (byte)(i * 7 + 1);
+
+    for (uint16_t len = 0; len <= sizeof(msg); len++) {
+        byte iv_a[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        byte iv_b[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        byte iv_c[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        byte whole[2*INPUT_BUFFER_LIMIT] = {0};
+        char expected[4*INPUT_BUFFER_LIMIT] = {0};
+        char encoded[4*INPUT_BUFFER_LIMIT] = {0};
+        byte plain[2*INPUT_BUFFER_LIMIT] = {0};
+
+        uint16_t whole_len = whole_lib.encrypt(msg, len, whole, aes_key, sizeof(aes_key), iv_a);
+        base64_encode(expected, (char *)whole, whole_len);
+
+        uint16_t encoded_len = chunked.encrypt64(msg, len, encoded, aes_key, sizeof(aes_key), iv_b);
+        REQUIRE( encoded_len == strlen(expected) );
+        REQUIRE( strcmp(encoded, expected) == 0 );
+
+        REQUIRE( chunked.decrypt64(encoded, encoded_len, plain, aes_key, sizeof(aes_key), iv_c) == len );
+        REQUIRE( memcmp(plain, msg, len) == 0 );
+    }
+}
+
+TEST_CASE( "Pre-keyed encryption works in place.", "[single-file]" ) {
+    AESLib keyed;
+    keyed.set_paddingmode(paddingMode::CMS);
+    byte iv_a[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte iv_b[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte iv_c[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte separate[2*INPUT_BUFFER_LIMIT] = {0};
+    byte buffer[2*INPUT_BUFFER_LIMIT] = {0};
+    uint16_t len = strlen(test_string);
+
+    REQUIRE( keyed.set_key(aes_key, sizeof(aes_key)) == SUCCESS );
+    uint16_t separate_len = keyed.encrypt((byte*)test_string, len, separate, iv_a);
+    memcpy(buffer, test_string, len);
+    REQUIRE( keyed.encrypt(buffer, len, buffer, iv_b) == separate_len );
+    REQUIRE( memcmp(buffer, separate, separate_len) == 0 );
+
+    REQUIRE( keyed.decrypt(buffer, separate_len, buffer, iv_c) == len );
+    REQUIRE( memcmp(buffer, test_string, len) == 0 );
+}
+
+TEST_CASE( "Streaming base64 matches the one-shot functions.", "[single-file]" ) {
+    char data[100];
+    for (int i = 0; i < (int)sizeof(data); i++)
+        data[i] = (char)(i * 37 + 11);
+
+    for (int len = 0; len <= (int)sizeof(data); len++) {
+        for (int step = 1; step <= 7; step++) {
+            char expected[4*INPUT_BUFFER_LIMIT] = {0};
+            char encoded[4*INPUT_BUFFER_LIMIT] = {0};
+            char decoded[2*INPUT_BUFFER_LIMIT] = {0};
+            int expected_len = base64_encode(expected, data, len);
+
+            Base64Encoder encoder;
+            int encoded_len = 0;
+            for (int posn = 0; posn < len; posn += step) {
+                int n = (len - posn < step) ? (len - posn) : step;
+                encoded_len += encoder.update(encoded + encoded_len, data + posn, n);
+            }
+            encoded_len += encoder.finish(encoded + encoded_len);
+            REQUIRE( encoded_len == expected_len );
+            REQUIRE( strcmp(encoded, expected) == 0 );
+
+            Base64Decoder decoder;
+            int decoded_len = 0;
+            for (int posn = 0; posn < encoded_len; posn += step) {
+                int n = (encoded_len - posn < step) ? (encoded_len - posn) : step;
+                decoded_len += decoder.update(decoded + decoded_len, encoded + posn, n);
+            }
+            decoded_len += decoder.finish(decoded + decoded_len);
+            REQUIRE( decoded_len == len );
+            REQUIRE( memcmp(decoded, data, len) == 0 );
+        }
+    }
+
+    // line breaks are skipped
+    Base64Decoder decoder;
+    char decoded[8] = {0};
+    int decoded_len = decoder.update(decoded, "SGVs\r\nbG8=", 10);
+    decoded_len += decoder.finish(decoded + decoded_len);
+    REQUIRE( decoded_len == 5 );
+    REQUIRE( memcmp(decoded, "Hello", 5) == 0 );
+}
+
+TEST_CASE( "CBC decryption in place and across calls matches one call.", "[single-file]" ) {
+    AES aes;
+    byte plain[8 * N_BLOCK];
+    byte cipher[8 * N_BLOCK];
+    byte buffer[8 * N_BLOCK];
+    byte iv_a[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    byte iv_b[N_BLOCK] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < (int)sizeof(plain); i++)
+        plain[i] = (byte)(i * 5 + 3);
+
+    REQUIRE( aes.set_key(aes_key, sizeof(aes_key)) == SUCCESS );
+    REQUIRE( aes.cbc_encrypt(plain, cipher, 8, iv_a) == SUCCESS );
+
+    // 3 + 1 + 4 blocks, in place, carrying the IV between calls
+    memcpy(buffer, cipher, sizeof(cipher));
+    REQUIRE( aes.cbc_decrypt(buffer, buffer, 3, iv_b) == SUCCESS );
+    REQUIRE( aes.cbc_decrypt(buffer + 3 * N_BLOCK, buffer + 3 * N_BLOCK, 1, iv_b) == SUCCESS );
+    REQUIRE( aes.cbc_decrypt(buffer + 4 * N_BLOCK, buffer + 4 * N_BLOCK, 4, iv_b) == SUCCESS );
+    REQUIRE( memcmp(buffer, plain, sizeof(plain)) == 0 );
+    REQUIRE( memcmp(iv_b, iv_a, N_BLOCK) == 0 );
+}
+
+static void from_hex(byte *out, const char *hex) {
+    for (; hex[0] && hex[1]; hex += 2) {
+        unsigned v;
+        sscanf(hex, "%2x", &v);
+        *out++ = (byte)v;
+    }
+}
+
+TEST_CASE( "CTR matches NIST SP 800-38A F.5.1 and seeks by offset.", "[single-file]" ) {
+    AESLib ctr;
+    byte ctr0[N_BLOCK], plain[64], expected[64], out[64];
+    from_hex(ctr0, "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    from_hex(plain, "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    from_hex(expected, "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                       "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+
+    REQUIRE( ctr.set_key(aes_key, sizeof(aes_key)) == SUCCESS );
+    REQUIRE( ctr.ctr_crypt(plain, sizeof(plain), out, ctr0) == SUCCESS );
+    REQUIRE( memcmp(out, expected, sizeof(out)) == 0 );
+
+    // any slice decrypts on its own from its offset
+    for (uint32_t offset = 0; offset < sizeof(plain); offset += 7) {
+        uint16_t len = sizeof(plain) - offset < 11 ? sizeof(plain) - offset : 11;
+        REQUIRE( ctr.ctr_crypt(expected + offset, len, out, ctr0, offset) == SUCCESS );
+        REQUIRE( memcmp(out, plain + offset, len) == 0 );
+    }
+}
+
+TEST_CASE( "GCM matches the McGrew-Viega test cases 4 and 6.", "[single-file]" ) {
+    AESLib gcm;
+    byte key[16], iv[60], aad[20], plain[60], expected[60], expected_tag[16];
+    byte out[60], tag[16], back[60];
+    from_hex(key, "feffe9928665731c6d6a8f9467308308");
+    from_hex(aad, "feedfacedeadbeeffeedfacedeadbeefabaddad2");
+    from_hex(plain, "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+    REQUIRE( gcm.set_key(key, sizeof(key)) == SUCCESS );
+
+    // 96-bit IV
+    from_hex(iv, "cafebabefacedbaddecaf888");
+    from_hex(expected, "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+                       "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091");
+    from_hex(expected_tag, "5bc94fbc3221a5db94fae95ae7121a47");
+    REQUIRE( gcm.gcm_encrypt(iv, 12, aad, sizeof(aad), plain, sizeof(plain), out, tag) == SUCCESS );
+    REQUIRE( memcmp(out, expected, sizeof(out)) == 0 );
+    REQUIRE( memcmp(tag, expected_tag, sizeof(tag)) == 0 );
+    REQUIRE( gcm.gcm_decrypt(iv, 12, aad, sizeof(aad), out, sizeof(out), back, tag, 16) == SUCCESS );
+    REQUIRE( memcmp(back, plain, sizeof(plain)) == 0 );
+
+    // a forged tag is refused and nothing is decrypted
+    memset(back, 0, sizeof(back));
+    tag[15] ^= 1;
+    REQUIRE( gcm.gcm_decrypt(iv, 12, aad, sizeof(aad), out, sizeof(out), back, tag, 16) != SUCCESS );
+    REQUIRE( back[0] == 0 );
+
+    // 60-byte IV goes through GHASH
+    from_hex(iv, "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728"
+                 "c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b");
+    from_hex(expected, "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7"
+                       "01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5");
+    from_hex(expected_tag, "619cc5aefffe0bfa462af43c1699d050");
+    REQUIRE( gcm.gcm_encrypt(iv, 60, aad, sizeof(aad), plain, sizeof(plain), out, tag) == SUCCESS );
+    REQUIRE( memcmp(out, expected, sizeof(out)) == 0 );
+    REQUIRE( memcmp(tag, expected_tag, sizeof(tag)) == 0 );
+}
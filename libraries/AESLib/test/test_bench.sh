@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+
+# Build and run the host benchmarks; results go to the console and benchmark.csv
+
+echo "*** Building ***"
+g++ -std=c++14 -O2 -Wall -o 030-Benchmark 030-Benchmark.cpp ../src/*.cpp
+
+echo "*** Running benchmarks ***"
+
+./030-Benchmark "$@"
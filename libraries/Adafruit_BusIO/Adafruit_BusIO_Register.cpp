@@ -359,6 +359,18 @@ bool Adafruit_BusIO_RegisterBits::write(uint32_t data) {
  */
 uint8_t Adafruit_BusIO_Register::width(void) { return _width; }
 
+/*!
+ *    @brief  The byte order of the register data
+ *    @returns LSBFIRST or MSBFIRST, as set when initializing the register
+ */
+uint8_t Adafruit_BusIO_Register::byteorder(void) { return _byteorder; }
+
+/*!
+ *    @brief  The register address
+ *    @returns The address pointer value used for reads and writes
+ */
+uint16_t Adafruit_BusIO_Register::address(void) { return _address; }
+
 /*!
  *    @brief  Set the default width of data
  *    @param width the default width of data read from register
@@ -381,4 +393,179 @@ void Adafruit_BusIO_Register::setAddressWidth(uint16_t address_width) {
   _addrwidth = address_width;
 }
 
+/*!
+ *    @brief  Create a shadow copy of a contiguous range of registers. The
+ * device must auto-increment the register address across a multi-byte access
+ * (for SPI, pick the register type that sets the increment bit)
+ *    @param  first The register at the start of the range; its bus, address
+ * width, SPI type and byte order are used for every access
+ *    @param  shadow Caller-owned buffer of len bytes holding the shadow copy
+ *    @param  len Number of register bytes in the range
+ */
+Adafruit_BusIO_RegisterFile::Adafruit_BusIO_RegisterFile(
+    Adafruit_BusIO_Register *first, uint8_t *shadow, uint8_t len) {
+  _register = first;
+  _shadow = shadow;
+  _len = len;
+  _dirtyStart = 0;
+  _dirtyEnd = 0;
+}
+
+/*!
+ *    @brief  Read the whole range into the shadow copy in one burst. Pending
+ * writes that were not flushed are discarded
+ *    @return True on successful read
+ */
+bool Adafruit_BusIO_RegisterFile::refresh(void) {
+  _dirtyStart = 0;
+  _dirtyEnd = 0;
+  return _register->read(_shadow, _len);
+}
+
+/*!
+ *    @brief  Write every byte changed since the last refresh() or flush() in
+ * one transaction. Unchanged bytes lying between two changed ones are
+ * rewritten with their shadow value, so refresh() first unless the whole span
+ * was written
+ *    @return True on successful write, or if there was nothing to write
+ */
+bool Adafruit_BusIO_RegisterFile::flush(void) {
+  if (_dirtyStart == _dirtyEnd) {
+    return true;
+  }
+
+  uint16_t start = _register->address();
+  _register->setAddress(start + _dirtyStart);
+  bool ok = _register->write(_shadow + _dirtyStart, _dirtyEnd - _dirtyStart);
+  _register->setAddress(start);
+
+  if (ok) {
+    _dirtyStart = 0;
+    _dirtyEnd = 0;
+  }
+  return ok;
+}
+
+/*!
+ *    @brief  Whether there are writes waiting for flush()
+ *    @return True if the shadow copy holds unwritten changes
+ */
+bool Adafruit_BusIO_RegisterFile::dirty(void) {
+  return _dirtyStart != _dirtyEnd;
+}
+
+/*!
+ *    @brief  Read a register value from the shadow copy, no bus access
+ *    @param  offset Byte offset of the register in the range
+ *    @param  width Width of the register in bytes (1-4)
+ *    @return The value, or 0xFFFFFFFF if it lies outside the range
+ */
+uint32_t Adafruit_BusIO_RegisterFile::read(uint8_t offset, uint8_t width) {
+  if ((width == 0) || (width > 4) || (offset + width > _len)) {
+    return -1;
+  }
+
+  uint32_t value = 0;
+
+  for (int i = 0; i < width; i++) {
+    value <<= 8;
+    if (_register->byteorder() == LSBFIRST) {
+      value |= _shadow[offset + width - i - 1];
+    } else {
+      value |= _shadow[offset + i];
+    }
+  }
+  return value;
+}
+
+/*!
+ *    @brief  Write a register value into the shadow copy; it reaches the
+ * device on the next flush()
+ *    @param  offset Byte offset of the register in the range
+ *    @param  value Data to write
+ *    @param  width Width of the register in bytes (1-4)
+ *    @return False if the register lies outside the range
+ */
+bool Adafruit_BusIO_RegisterFile::write(uint8_t offset, uint32_t value,
+                                        uint8_t width) {
+  if ((width == 0) || (width > 4) || (offset + width > _len)) {
+    return false;
+  }
+
+  for (int i = 0; i < width; i++) {
+    if (_register->byteorder() == LSBFIRST) {
+      _shadow[offset + i] = value & 0xFF;
+    } else {
+      _shadow[offset + width - i - 1] = value & 0xFF;
+    }
+    value >>= 8;
+  }
+  markDirty(offset, width);
+  return true;
+}
+
+/*!
+ *    @brief  Read a slice of bits of a register from the shadow copy
+ *    @param  offset Byte offset of the register in the range
+ *    @param  bits The number of bits wide the slice is
+ *    @param  shift The number of bits the slice is shifted from LSB
+ *    @param  width Width of the register in bytes (1-4)
+ *    @return The bits of the slice
+ */
+uint32_t Adafruit_BusIO_RegisterFile::readBits(uint8_t offset, uint8_t bits,
+                                               uint8_t shift, uint8_t width) {
+  uint32_t val = read(offset, width);
+  val >>= shift;
+  return val & ((1 << (bits)) - 1);
+}
+
+/*!
+ *    @brief  Change a slice of bits of a register in the shadow copy, leaving
+ * the other bits alone. No bus access: several fields of one or more
+ * registers go out together on the next flush()
+ *    @param  offset Byte offset of the register in the range
+ *    @param  bits The number of bits wide the slice is
+ *    @param  shift The number of bits the slice is shifted from LSB
+ *    @param  value The new value of the slice
+ *    @param  width Width of the register in bytes (1-4)
+ *    @return False if the register lies outside the range
+ */
+bool Adafruit_BusIO_RegisterFile::writeBits(uint8_t offset, uint8_t bits,
+                                            uint8_t shift, uint32_t value,
+                                            uint8_t width) {
+  if ((width == 0) || (width > 4) || (offset + width > _len)) {
+    return false;
+  }
+  uint32_t val = read(offset, width);
+
+  // mask off the data before writing
+  uint32_t mask = (1 << (bits)) - 1;
+  value &= mask;
+
+  mask <<= shift;
+  val &= ~mask;           // remove the current data at that spot
+  val |= value << shift;  // and add in the new data
+
+  return write(offset, val, width);
+}
+
+/*!
+ *    @brief  Grow the dirty span to cover a register
+ *    @param  offset Byte offset of the register in the range
+ *    @param  width Width of the register in bytes
+ */
+void Adafruit_BusIO_RegisterFile::markDirty(uint8_t offset, uint8_t width) {
+  if (_dirtyStart == _dirtyEnd) {
+    _dirtyStart = offset;
+    _dirtyEnd = offset + width;
+    return;
+  }
+  if (offset < _dirtyStart) {
+    _dirtyStart = offset;
+  }
+  if (offset + width > _dirtyEnd) {
+    _dirtyEnd = offset + width;
+  }
+}
+
 #endif // SPI exists
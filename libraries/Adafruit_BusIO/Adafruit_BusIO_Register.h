@@ -72,6 +72,8 @@ public:
   bool write(uint32_t value, uint8_t numbytes = 0);
 
   uint8_t width(void);
+  uint8_t byteorder(void);
+  uint16_t address(void);
 
   void setWidth(uint8_t width);
   void setAddress(uint16_t address);
@@ -113,5 +115,35 @@ private:
   uint8_t _bits, _shift;
 };
 
+/*!
+ * @brief A contiguous range of device registers mirrored in a shadow copy, so
+ * the whole range is read in one burst and field writes are combined into one
+ * transaction
+ */
+class Adafruit_BusIO_RegisterFile {
+public:
+  Adafruit_BusIO_RegisterFile(Adafruit_BusIO_Register *first, uint8_t *shadow,
+                              uint8_t len);
+
+  bool refresh(void);
+  bool flush(void);
+  bool dirty(void);
+
+  uint32_t read(uint8_t offset, uint8_t width = 1);
+  bool write(uint8_t offset, uint32_t value, uint8_t width = 1);
+  uint32_t readBits(uint8_t offset, uint8_t bits, uint8_t shift,
+                    uint8_t width = 1);
+  bool writeBits(uint8_t offset, uint8_t bits, uint8_t shift, uint32_t value,
+                 uint8_t width = 1);
+
+private:
+  void markDirty(uint8_t offset, uint8_t width);
+
+  Adafruit_BusIO_Register *_register;
+  uint8_t *_shadow;
+  uint8_t _len;
+  uint8_t _dirtyStart, _dirtyEnd; // dirty byte span, empty when equal
+};
+
 #endif // SPI exists
 #endif // BusIO_Register_h
@@ -88,3 +88,176 @@ bool Adafruit_GenericDevice::writeRegister(uint8_t *addr_buf, uint8_t addrsiz,
     return false;
   return _writereg_func(_obj, addr_buf, addrsiz, buf, bufsiz);
 }
+
+/*! @brief Provide the transport functions used by the transaction queue. The
+   submit function starts a transaction on the link and returns at once, so
+   several requests can be in flight; the poll function reports when the
+   oldest one has finished. Transactions complete in submission order.
+   Without these functions, submitted transactions run synchronously through
+   the read/write functions and their callback is called before the submit
+   call returns
+   @param submit_func Function pointer starting a transaction
+   @param poll_func Function pointer checking the oldest transaction */
+void Adafruit_GenericDevice::setAsyncFunctions(
+    busio_genericdevice_submit_t submit_func,
+    busio_genericdevice_poll_t poll_func) {
+  _submit_func = submit_func;
+  _poll_func = poll_func;
+}
+
+/*! @brief Queue a read of raw data
+   @param buffer Buffer to read data into, untouched by the caller until the
+   transaction completes
+   @param len Number of bytes to read
+   @param callback Optional function called once the read completed
+   @param context Argument passed to the callback
+   @return false if the queue is full or the transport refused it */
+bool Adafruit_GenericDevice::submitRead(uint8_t *buffer, uint16_t len,
+                                        BusIO_GenericCallback callback,
+                                        void *context) {
+  return submit(BUSIO_GENERIC_READ, nullptr, 0, buffer, len, callback,
+                context);
+}
+
+/*! @brief Queue a write of raw data
+   @param buffer Data to write, kept valid until the transaction completes
+   @param len Number of bytes to write
+   @param callback Optional function called once the write completed
+   @param context Argument passed to the callback
+   @return false if the queue is full or the transport refused it */
+bool Adafruit_GenericDevice::submitWrite(const uint8_t *buffer, uint16_t len,
+                                         BusIO_GenericCallback callback,
+                                         void *context) {
+  return submit(BUSIO_GENERIC_WRITE, nullptr, 0, (uint8_t *)buffer, len,
+                callback, context);
+}
+
+/*! @brief Queue a register read
+   @param addr_buf Buffer containing register address, copied into the queue
+   @param addrsiz Size of register address in bytes (up to 4)
+   @param buf Buffer to store read data, untouched by the caller until the
+   transaction completes
+   @param bufsiz Size of data to read in bytes
+   @param callback Optional function called once the read completed
+   @param context Argument passed to the callback
+   @return false if the queue is full or the transport refused it */
+bool Adafruit_GenericDevice::submitReadRegister(const uint8_t *addr_buf,
+                                                uint8_t addrsiz, uint8_t *buf,
+                                                uint16_t bufsiz,
+                                                BusIO_GenericCallback callback,
+                                                void *context) {
+  return submit(BUSIO_GENERIC_READREG, addr_buf, addrsiz, buf, bufsiz,
+                callback, context);
+}
+
+/*! @brief Queue a register write
+   @param addr_buf Buffer containing register address, copied into the queue
+   @param addrsiz Size of register address in bytes (up to 4)
+   @param buf Data to write, kept valid until the transaction completes
+   @param bufsiz Size of data to write in bytes
+   @param callback Optional function called once the write completed
+   @param context Argument passed to the callback
+   @return false if the queue is full or the transport refused it */
+bool Adafruit_GenericDevice::submitWriteRegister(
+    const uint8_t *addr_buf, uint8_t addrsiz, const uint8_t *buf,
+    uint16_t bufsiz, BusIO_GenericCallback callback, void *context) {
+  return submit(BUSIO_GENERIC_WRITEREG, addr_buf, addrsiz, (uint8_t *)buf,
+                bufsiz, callback, context);
+}
+
+/*! @brief Complete every finished transaction at the head of the queue,
+   calling their callbacks in submission order
+   @return true if no transaction is outstanding anymore */
+bool Adafruit_GenericDevice::poll(void) {
+  while (_queueCount > 0) {
+    BusIO_GenericTransaction *txn = &_queue[_queueHead];
+    bool ok = false;
+    if (!_poll_func(_obj, txn, &ok)) {
+      return false;
+    }
+
+    // Free the slot before the callback so it can submit the next request
+    BusIO_GenericCallback callback = txn->callback;
+    void *context = txn->context;
+    _queueHead = (_queueHead + 1) % BUSIO_GENERIC_QUEUE_SIZE;
+    _queueCount--;
+    if (callback) {
+      callback(context, ok);
+    }
+  }
+  return true;
+}
+
+/*! @brief Number of submitted transactions not completed yet
+   @return The count, at most BUSIO_GENERIC_QUEUE_SIZE */
+uint8_t Adafruit_GenericDevice::pending(void) { return _queueCount; }
+
+/*! @brief Queue one transaction and start it on the link
+   @param op Kind of transaction
+   @param addr_buf Register address, or nullptr for raw transfers
+   @param addrsiz Size of register address in bytes
+   @param data Read destination or write source
+   @param len Data length in bytes
+   @param callback Optional completion callback
+   @param context Argument passed to the callback
+   @return false if the queue is full or the transport refused it */
+bool Adafruit_GenericDevice::submit(BusIO_GenericOp op,
+                                    const uint8_t *addr_buf, uint8_t addrsiz,
+                                    uint8_t *data, uint16_t len,
+                                    BusIO_GenericCallback callback,
+                                    void *context) {
+  if (!_begun || (addrsiz > BUSIO_GENERIC_MAX_ADDR)) {
+    return false;
+  }
+
+  BusIO_GenericTransaction now;
+  BusIO_GenericTransaction *txn = &now;
+  bool queued = _submit_func && _poll_func;
+  if (queued) {
+    if (_queueCount >= BUSIO_GENERIC_QUEUE_SIZE) {
+      return false;
+    }
+    txn = &_queue[(_queueHead + _queueCount) % BUSIO_GENERIC_QUEUE_SIZE];
+  }
+
+  txn->op = op;
+  if (addrsiz > 0) {
+    memcpy(txn->addr, addr_buf, addrsiz);
+  }
+  txn->addrsiz = addrsiz;
+  txn->data = data;
+  txn->len = len;
+  txn->callback = callback;
+  txn->context = context;
+
+  if (!queued) {
+    bool ok = runNow(txn);
+    if (callback) {
+      callback(context, ok);
+    }
+    return true;
+  }
+
+  if (!_submit_func(_obj, txn)) {
+    return false;
+  }
+  _queueCount++;
+  return true;
+}
+
+/*! @brief Run a transaction synchronously through the read/write functions
+   @param txn The transaction
+   @return true if it succeeded */
+bool Adafruit_GenericDevice::runNow(BusIO_GenericTransaction *txn) {
+  switch (txn->op) {
+  case BUSIO_GENERIC_READ:
+    return read(txn->data, txn->len);
+  case BUSIO_GENERIC_WRITE:
+    return write(txn->data, txn->len);
+  case BUSIO_GENERIC_READREG:
+    return readRegister(txn->addr, txn->addrsiz, txn->data, txn->len);
+  case BUSIO_GENERIC_WRITEREG:
+    return writeRegister(txn->addr, txn->addrsiz, txn->data, txn->len);
+  }
+  return false;
+}
@@ -15,6 +15,48 @@ typedef bool (*busio_genericdevice_writereg_t)(void *obj, uint8_t *addr_buf,
                                                const uint8_t *data,
                                                uint16_t datalen);
 
+/// Maximum number of queued asynchronous transactions
+#ifndef BUSIO_GENERIC_QUEUE_SIZE
+#define BUSIO_GENERIC_QUEUE_SIZE 4
+#endif
+
+/// Largest register address carried by a queued transaction, in bytes
+#define BUSIO_GENERIC_MAX_ADDR 4
+
+/// Kind of a queued transaction
+typedef enum _BusIO_GenericOp {
+  BUSIO_GENERIC_READ = 0,
+  BUSIO_GENERIC_WRITE = 1,
+  BUSIO_GENERIC_READREG = 2,
+  BUSIO_GENERIC_WRITEREG = 3,
+} BusIO_GenericOp;
+
+/// Called once a queued transaction has completed, ok is false on failure
+typedef void (*BusIO_GenericCallback)(void *context, bool ok);
+
+/*!
+ * @brief One queued transaction, handed to the transport's submit and poll
+ * functions
+ */
+typedef struct _BusIO_GenericTransaction {
+  BusIO_GenericOp op;                    ///< What to do
+  uint8_t addr[BUSIO_GENERIC_MAX_ADDR];  ///< Register address (register ops)
+  uint8_t addrsiz;                       ///< Register address size in bytes
+  uint8_t *data;                         ///< Read destination / write source
+  uint16_t len;                          ///< Data length in bytes
+  BusIO_GenericCallback callback;        ///< Completion callback, may be null
+  void *context;                         ///< Argument of the callback
+} BusIO_GenericTransaction;
+
+/// Start a transaction on the link without waiting for its result
+typedef bool (*busio_genericdevice_submit_t)(void *obj,
+                                             BusIO_GenericTransaction *txn);
+/// Check the oldest outstanding transaction; return true once it finished,
+/// with its result in *ok (and read data in txn->data)
+typedef bool (*busio_genericdevice_poll_t)(void *obj,
+                                           BusIO_GenericTransaction *txn,
+                                           bool *ok);
+
 /*!
  * @brief Class for communicating with a device via generic read/write functions
  */
@@ -36,6 +78,25 @@ public:
   bool writeRegister(uint8_t *addr_buf, uint8_t addrsiz, const uint8_t *buf,
                      uint16_t bufsiz);
 
+  void setAsyncFunctions(busio_genericdevice_submit_t submit_func,
+                         busio_genericdevice_poll_t poll_func);
+  bool submitRead(uint8_t *buffer, uint16_t len,
+                  BusIO_GenericCallback callback = nullptr,
+                  void *context = nullptr);
+  bool submitWrite(const uint8_t *buffer, uint16_t len,
+                   BusIO_GenericCallback callback = nullptr,
+                   void *context = nullptr);
+  bool submitReadRegister(const uint8_t *addr_buf, uint8_t addrsiz,
+                          uint8_t *buf, uint16_t bufsiz,
+                          BusIO_GenericCallback callback = nullptr,
+                          void *context = nullptr);
+  bool submitWriteRegister(const uint8_t *addr_buf, uint8_t addrsiz,
+                           const uint8_t *buf, uint16_t bufsiz,
+                           BusIO_GenericCallback callback = nullptr,
+                           void *context = nullptr);
+  bool poll(void);
+  uint8_t pending(void);
+
 protected:
   /*! @brief Function pointer for reading raw data from the device */
   busio_genericdevice_read_t _read_func;
@@ -49,8 +110,22 @@ protected:
   bool _begun; ///< whether we have initialized yet (in case the function needs
                ///< to do something)
 
+  /*! @brief Function pointer starting a queued transaction (optional) */
+  busio_genericdevice_submit_t _submit_func = nullptr;
+  /*! @brief Function pointer completing a queued transaction (optional) */
+  busio_genericdevice_poll_t _poll_func = nullptr;
+
 private:
+  bool submit(BusIO_GenericOp op, const uint8_t *addr_buf, uint8_t addrsiz,
+              uint8_t *data, uint16_t len, BusIO_GenericCallback callback,
+              void *context);
+  bool runNow(BusIO_GenericTransaction *txn);
+
   void *_obj; ///< Pointer to object instance
+
+  BusIO_GenericTransaction _queue[BUSIO_GENERIC_QUEUE_SIZE]; ///< FIFO ring
+  uint8_t _queueHead = 0;  ///< Index of the oldest outstanding transaction
+  uint8_t _queueCount = 0; ///< Number of outstanding transactions
 };
 
 #endif // ADAFRUIT_GENERICDEVICE_H
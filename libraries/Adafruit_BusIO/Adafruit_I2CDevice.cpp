@@ -87,8 +87,8 @@ bool Adafruit_I2CDevice::detected(void) {
 }
 
 /*!
- *    @brief  Write a buffer or two to the I2C device. Cannot be more than
- * maxBufferSize() bytes.
+ *    @brief  Write up to three buffers to the I2C device in one transmission.
+ * Transfers larger than maxBufferSize() are split, see _writeChunked().
  *    @param  buffer Pointer to buffer of data to write. This is const to
  *            ensure the content of this buffer doesn't change.
  *    @param  len Number of bytes from buffer to write
@@ -96,20 +96,20 @@ bool Adafruit_I2CDevice::detected(void) {
  * buffer. Cannot be more than maxBufferSize() bytes. This is const to
  *            ensure the content of this buffer doesn't change.
  *    @param  prefix_len Number of bytes from prefix buffer to write
+ *    @param  suffix_buffer Pointer to optional array of data to write after
+ * buffer, such as a trailing checksum. This is const to ensure the content of
+ * this buffer doesn't change.
+ *    @param  suffix_len Number of bytes from suffix buffer to write
  *    @param  stop Whether to send an I2C STOP signal on write
  *    @return True if write was successful, otherwise false.
  */
 bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
-                               const uint8_t *prefix_buffer,
-                               size_t prefix_len) {
-  if ((len + prefix_len) > maxBufferSize()) {
-    // currently not guaranteed to work if more than 32 bytes!
-    // we will need to find out if some platforms have larger
-    // I2C buffer sizes :/
-#ifdef DEBUG_SERIAL
-    DEBUG_SERIAL.println(F("\tI2CDevice could not write such a large buffer"));
-#endif
-    return false;
+                               const uint8_t *prefix_buffer, size_t prefix_len,
+                               const uint8_t *suffix_buffer,
+                               size_t suffix_len) {
+  if ((len + prefix_len + suffix_len) > maxBufferSize()) {
+    return _writeChunked(buffer, len, stop, prefix_buffer, prefix_len,
+                         suffix_buffer, suffix_len);
   }
 
   _wire->beginTransmission(_addr);
@@ -132,6 +132,16 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
     return false;
   }
 
+  // Write the suffix data (usually a checksum)
+  if ((suffix_len != 0) && (suffix_buffer != nullptr)) {
+    if (_wire->write(suffix_buffer, suffix_len) != suffix_len) {
+#ifdef DEBUG_SERIAL
+      DEBUG_SERIAL.println(F("\tI2CDevice failed to write"));
+#endif
+      return false;
+    }
+  }
+
 #ifdef DEBUG_SERIAL
 
   DEBUG_SERIAL.print(F("\tI2CWRITE @ 0x"));
@@ -152,6 +162,13 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
       DEBUG_SERIAL.println();
     }
   }
+  if ((suffix_len != 0) && (suffix_buffer != nullptr)) {
+    for (uint16_t i = 0; i < suffix_len; i++) {
+      DEBUG_SERIAL.print(F("0x"));
+      DEBUG_SERIAL.print(suffix_buffer[i], HEX);
+      DEBUG_SERIAL.print(F(", "));
+    }
+  }
 
   if (stop) {
     DEBUG_SERIAL.print("\tSTOP");
@@ -172,6 +189,66 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
   }
 }
 
+/*!
+ *    @brief  Write a transfer larger than the Wire buffer. The bytes are
+ * streamed in maxBufferSize() pieces; each piece but the last ends with a
+ * repeated START instead of a STOP, so the bus is never released in the
+ * middle of the transfer. The device must accept a write continued after a
+ * repeated START.
+ *    @param  buffer Pointer to buffer of data to write
+ *    @param  len Number of bytes from buffer to write
+ *    @param  stop Whether to send an I2C STOP signal after the last piece
+ *    @param  prefix_buffer Pointer to optional data to write before buffer
+ *    @param  prefix_len Number of bytes from prefix buffer to write
+ *    @param  suffix_buffer Pointer to optional data to write after buffer
+ *    @param  suffix_len Number of bytes from suffix buffer to write
+ *    @return True if write was successful, otherwise false.
+ */
+bool Adafruit_I2CDevice::_writeChunked(const uint8_t *buffer, size_t len,
+                                       bool stop, const uint8_t *prefix_buffer,
+                                       size_t prefix_len,
+                                       const uint8_t *suffix_buffer,
+                                       size_t suffix_len) {
+  const uint8_t *parts[3] = {prefix_buffer, buffer, suffix_buffer};
+  size_t lengths[3] = {(prefix_buffer != nullptr) ? prefix_len : 0, len,
+                       (suffix_buffer != nullptr) ? suffix_len : 0};
+  size_t room = maxBufferSize();
+
+  if (room == 0) {
+    return false;
+  }
+
+  _wire->beginTransmission(_addr);
+  for (uint8_t p = 0; p < 3; p++) {
+    const uint8_t *data = parts[p];
+    size_t remaining = lengths[p];
+    while (remaining > 0) {
+      if (room == 0) {
+        if (_wire->endTransmission(false) != 0) {
+#ifdef DEBUG_SERIAL
+          DEBUG_SERIAL.println(F("\tI2CDevice failed to send a chunk"));
+#endif
+          return false;
+        }
+        _wire->beginTransmission(_addr);
+        room = maxBufferSize();
+      }
+      size_t n = (remaining > room) ? room : remaining;
+      if (_wire->write(data, n) != n) {
+#ifdef DEBUG_SERIAL
+        DEBUG_SERIAL.println(F("\tI2CDevice failed to write"));
+#endif
+        return false;
+      }
+      data += n;
+      remaining -= n;
+      room -= n;
+    }
+  }
+
+  return (_wire->endTransmission(stop) == 0);
+}
+
 /*!
  *    @brief  Read from I2C into a buffer from the I2C device.
  *    Cannot be more than maxBufferSize() bytes.
@@ -193,16 +270,49 @@ bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
   return true;
 }
 
-bool Adafruit_I2CDevice::_read(uint8_t *buffer, size_t len, bool stop) {
+/*!
+ *    @brief  Read from I2C into a buffer from the I2C device, dropping the
+ *    first bytes of the transfer (such as a status byte) instead of copying
+ *    them into the buffer. Reads longer than maxBufferSize() are split like
+ *    read(), only the first chunk carries the skipped bytes.
+ *    @param  buffer Pointer to buffer of data to read into
+ *    @param  len Number of bytes to store in buffer.
+ *    @param  skip Number of leading bytes to read and discard.
+ *    @param  stop Whether to send an I2C STOP signal on read
+ *    @return True if read was successful, otherwise false.
+ */
+bool Adafruit_I2CDevice::read_skip(uint8_t *buffer, size_t len, size_t skip,
+                                   bool stop) {
+  size_t pos = 0;
+  if (skip >= maxBufferSize()) {
+    return false;
+  }
+  do {
+    size_t read_len = ((len - pos + skip) > maxBufferSize())
+                          ? (maxBufferSize() - skip)
+                          : (len - pos);
+    bool read_stop = (pos < (len - read_len)) ? false : stop;
+    if (!_read(buffer + pos, read_len, read_stop, skip))
+      return false;
+    pos += read_len;
+    skip = 0;
+  } while (pos < len);
+  return true;
+}
+
+bool Adafruit_I2CDevice::_read(uint8_t *buffer, size_t len, bool stop,
+                               size_t skip) {
+  size_t total = len + skip;
 #if defined(TinyWireM_h)
-  size_t recv = _wire->requestFrom((uint8_t)_addr, (uint8_t)len);
+  size_t recv = _wire->requestFrom((uint8_t)_addr, (uint8_t)total);
 #elif defined(ARDUINO_ARCH_MEGAAVR)
-  size_t recv = _wire->requestFrom(_addr, len, stop);
+  size_t recv = _wire->requestFrom(_addr, total, stop);
 #else
-  size_t recv = _wire->requestFrom((uint8_t)_addr, (uint8_t)len, (uint8_t)stop);
+  size_t recv =
+      _wire->requestFrom((uint8_t)_addr, (uint8_t)total, (uint8_t)stop);
 #endif
 
-  if (recv != len) {
+  if (recv != total) {
     // Not enough data available to fulfill our obligation!
 #ifdef DEBUG_SERIAL
     DEBUG_SERIAL.print(F("\tI2CDevice did not receive enough data: "));
@@ -211,6 +321,9 @@ bool Adafruit_I2CDevice::_read(uint8_t *buffer, size_t len, bool stop) {
     return false;
   }
 
+  for (size_t i = 0; i < skip; i++) {
+    (void)_wire->read();
+  }
   for (uint16_t i = 0; i < len; i++) {
     buffer[i] = _wire->read();
   }
@@ -254,6 +367,117 @@ bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
   return read(read_buffer, read_len);
 }
 
+/*!
+ *    @brief  Start a read that runs in the background on cores with
+ * asynchronous Wire transfers (BUSIO_HAS_I2C_ASYNC), in one transaction
+ * whatever maxBufferSize(). The CPU is free until asyncDone() reports
+ * completion; the buffer must stay untouched until then and the bus must not
+ * be used meanwhile. Elsewhere the read is done synchronously with read() and
+ * the callback runs before this returns.
+ *    @param  buffer Pointer to buffer of data to read into
+ *    @param  len Number of bytes to read
+ *    @param  stop Whether to send an I2C STOP signal on read
+ *    @param  callback Optional function called once the read completed
+ *    @param  context Argument passed to the callback
+ *    @return False if another asynchronous transfer is still running or the
+ * synchronous read failed, otherwise true
+ */
+bool Adafruit_I2CDevice::readAsync(uint8_t *buffer, size_t len, bool stop,
+                                   BusIO_I2CCallback callback, void *context) {
+  if (_asyncBusy) {
+    return false;
+  }
+  _asyncCallback = callback;
+  _asyncContext = context;
+
+#ifdef BUSIO_HAS_I2C_ASYNC
+  if ((len > 0) && _wire->readAsync(_addr, buffer, len, stop)) {
+    _asyncBusy = true;
+    return true;
+  }
+#endif
+
+  // Synchronous fallback
+  if (!read(buffer, len, stop)) {
+    _asyncCallback = nullptr;
+    return false;
+  }
+  _asyncBusy = true;
+  finishAsync();
+  return true;
+}
+
+/*!
+ *    @brief  Start a write that runs in the background, see readAsync()
+ *    @param  buffer Pointer to buffer of data to write
+ *    @param  len Number of bytes to write
+ *    @param  stop Whether to send an I2C STOP signal on write
+ *    @param  callback Optional function called once the write completed
+ *    @param  context Argument passed to the callback
+ *    @return False if another asynchronous transfer is still running or the
+ * synchronous write failed, otherwise true
+ */
+bool Adafruit_I2CDevice::writeAsync(const uint8_t *buffer, size_t len,
+                                    bool stop, BusIO_I2CCallback callback,
+                                    void *context) {
+  if (_asyncBusy) {
+    return false;
+  }
+  _asyncCallback = callback;
+  _asyncContext = context;
+
+#ifdef BUSIO_HAS_I2C_ASYNC
+  if ((len > 0) && _wire->writeAsync(_addr, buffer, len, stop)) {
+    _asyncBusy = true;
+    return true;
+  }
+#endif
+
+  // Synchronous fallback
+  if (!write(buffer, len, stop)) {
+    _asyncCallback = nullptr;
+    return false;
+  }
+  _asyncBusy = true;
+  finishAsync();
+  return true;
+}
+
+/*!
+ *    @brief  Poll a transfer started with readAsync() or writeAsync(). On
+ * completion the callback is called, once.
+ *    @return True if no transfer is running anymore, false while the bus is
+ * still busy
+ */
+bool Adafruit_I2CDevice::asyncDone(void) {
+  if (!_asyncBusy) {
+    return true;
+  }
+
+#ifdef BUSIO_HAS_I2C_ASYNC
+  if (!_wire->finishedAsync()) {
+    return false;
+  }
+#endif
+
+  finishAsync();
+  return true;
+}
+
+/*!
+ *    @brief  Mark a completed asynchronous transfer as done and notify the
+ * caller
+ */
+void Adafruit_I2CDevice::finishAsync(void) {
+  BusIO_I2CCallback callback = _asyncCallback;
+
+  _asyncCallback = nullptr;
+  _asyncBusy = false;
+  if (callback) {
+    callback(_asyncContext);
+  }
+}
+
 /*!
  *    @brief  Returns the 7-bit address of this device
  *    @return The 7-bit address of this device
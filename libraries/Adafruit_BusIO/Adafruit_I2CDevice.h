@@ -4,6 +4,16 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+// Cores whose TwoWire can run a transfer in the background (arduino-pico 4.x
+// readAsync()/writeAsync() with DMA)
+#if defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED) &&            \
+    defined(ARDUINO_PICO_MAJOR) && (ARDUINO_PICO_MAJOR >= 4)
+#define BUSIO_HAS_I2C_ASYNC
+#endif
+
+/// Called once an asynchronous I2C transfer has completed
+typedef void (*BusIO_I2CCallback)(void *context);
+
 ///< The class which defines how we will talk to this device over I2C
 class Adafruit_I2CDevice {
 public:
@@ -14,11 +24,19 @@ public:
   bool detected(void);
 
   bool read(uint8_t *buffer, size_t len, bool stop = true);
+  bool read_skip(uint8_t *buffer, size_t len, size_t skip, bool stop = true);
   bool write(const uint8_t *buffer, size_t len, bool stop = true,
-             const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0);
+             const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0,
+             const uint8_t *suffix_buffer = nullptr, size_t suffix_len = 0);
   bool write_then_read(const uint8_t *write_buffer, size_t write_len,
                        uint8_t *read_buffer, size_t read_len,
                        bool stop = false);
+  bool readAsync(uint8_t *buffer, size_t len, bool stop = true,
+                 BusIO_I2CCallback callback = nullptr, void *context = nullptr);
+  bool writeAsync(const uint8_t *buffer, size_t len, bool stop = true,
+                  BusIO_I2CCallback callback = nullptr,
+                  void *context = nullptr);
+  bool asyncDone(void);
   bool setSpeed(uint32_t desiredclk);
 
   /*!   @brief  How many bytes we can read in a transaction
@@ -30,7 +48,14 @@ private:
   TwoWire *_wire;
   bool _begun;
   size_t _maxBufferSize;
-  bool _read(uint8_t *buffer, size_t len, bool stop);
+  bool _asyncBusy = false;
+  BusIO_I2CCallback _asyncCallback = nullptr;
+  void *_asyncContext = nullptr;
+  void finishAsync(void);
+  bool _read(uint8_t *buffer, size_t len, bool stop, size_t skip = 0);
+  bool _writeChunked(const uint8_t *buffer, size_t len, bool stop,
+                     const uint8_t *prefix_buffer, size_t prefix_len,
+                     const uint8_t *suffix_buffer, size_t suffix_len);
 };
 
 #endif // Adafruit_I2CDevice_h
@@ -1,5 +1,11 @@
 #include "Adafruit_SPIDevice.h"
 
+#ifdef BUSIO_HAS_PIO_SPI
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#endif
+
 // #define DEBUG_SERIAL Serial
 
 #ifdef BUSIO_USE_FAST_PINIO
@@ -37,10 +43,11 @@ Adafruit_SPIDevice::Adafruit_SPIDevice(int8_t cspin, uint32_t freq,
   _sck = _mosi = _miso = -1;
   _spi = theSPI;
   _begun = false;
-  _spiSetting = new SPISettings(freq, dataOrder, dataMode);
+  _spiSetting = SPISettings(freq, dataOrder, dataMode);
   _freq = freq;
   _dataOrder = dataOrder;
   _dataMode = dataMode;
+  selectSoftTransfer();
 #else
   // unused, but needed to suppress compiler warns
   (void)cspin;
@@ -92,16 +99,304 @@ Adafruit_SPIDevice::Adafruit_SPIDevice(int8_t cspin, int8_t sckpin,
   _dataOrder = dataOrder;
   _dataMode = dataMode;
   _begun = false;
+  selectSoftTransfer();
+}
+
+// Software SPI kernels: which edge drives MOSI and which one samples MISO
+#define BUSIO_SOFT_KERNEL_MODE0 0 ///< Also used for SPI_MODE2
+#define BUSIO_SOFT_KERNEL_MODE1 1 ///< Write on rising, read on falling edge
+#define BUSIO_SOFT_KERNEL_MODE3 3 ///< Write on falling, read on rising edge
+
+/*!
+ *    @brief  Pick the software SPI kernel matching the mode and bit order,
+ * and the half-bit delay matching the clock, so neither is evaluated per bit
+ */
+void Adafruit_SPIDevice::selectSoftTransfer(void) {
+  bool lsbFirst = (_dataOrder == SPI_BITORDER_LSBFIRST);
+
+  _bitDelayUs = (uint8_t)((1000000 / _freq) / 2);
+
+  if (_dataMode == SPI_MODE3) {
+    _softTransfer =
+        lsbFirst ? &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE3,
+                                                     true>
+                 : &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE3,
+                                                     false>;
+  } else if (_dataMode == SPI_MODE1) {
+    _softTransfer =
+        lsbFirst ? &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE1,
+                                                     true>
+                 : &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE1,
+                                                     false>;
+  } else {
+    _softTransfer =
+        lsbFirst ? &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE0,
+                                                     true>
+                 : &Adafruit_SPIDevice::softTransfer<BUSIO_SOFT_KERNEL_MODE0,
+                                                     false>;
+  }
+}
+
+/*!
+ *    @brief  Clock one bit in software, the mode is resolved at compile time
+ *    @param  send The byte being sent
+ *    @param  mask The bit of send to drive on MOSI
+ *    @return mask if MISO read high, otherwise 0
+ */
+template <uint8_t Kernel>
+inline __attribute__((always_inline)) uint8_t
+Adafruit_SPIDevice::softBit(uint8_t send, uint8_t mask) {
+  uint8_t reply = 0;
+
+  if (Kernel == BUSIO_SOFT_KERNEL_MODE0) {
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if (_mosi != -1) {
+      BUSIO_WRITE_MOSI(send & mask);
+    }
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if ((_miso != -1) && BUSIO_READ_MISO()) {
+      reply = mask;
+    }
+    BUSIO_SET_CLOCK_LOW();
+  } else if (Kernel == BUSIO_SOFT_KERNEL_MODE3) {
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if (_mosi != -1) { // transmit on falling edge
+      BUSIO_WRITE_MOSI(send & mask);
+    }
+    BUSIO_SET_CLOCK_LOW();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if ((_miso != -1) && BUSIO_READ_MISO()) { // read on rising edge
+      reply = mask;
+    }
+  } else {
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if (_mosi != -1) {
+      BUSIO_WRITE_MOSI(send & mask);
+    }
+    BUSIO_SET_CLOCK_LOW();
+    if ((_miso != -1) && BUSIO_READ_MISO()) {
+      reply = mask;
+    }
+  }
+
+  return reply;
+}
+
+/*!
+ *    @brief  Software SPI transfer in place, eight unrolled bits per byte
+ *    @param  buffer Pointer to buffer of data to write/read to/from
+ *    @param  len Number of bytes from buffer to write/read.
+ */
+template <uint8_t Kernel, bool LsbFirst>
+void Adafruit_SPIDevice::softTransfer(uint8_t *buffer, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t send = buffer[i];
+    uint8_t reply;
+
+    if (LsbFirst) {
+      reply = softBit<Kernel>(send, 0x01);
+      reply |= softBit<Kernel>(send, 0x02);
+      reply |= softBit<Kernel>(send, 0x04);
+      reply |= softBit<Kernel>(send, 0x08);
+      reply |= softBit<Kernel>(send, 0x10);
+      reply |= softBit<Kernel>(send, 0x20);
+      reply |= softBit<Kernel>(send, 0x40);
+      reply |= softBit<Kernel>(send, 0x80);
+    } else {
+      reply = softBit<Kernel>(send, 0x80);
+      reply |= softBit<Kernel>(send, 0x40);
+      reply |= softBit<Kernel>(send, 0x20);
+      reply |= softBit<Kernel>(send, 0x10);
+      reply |= softBit<Kernel>(send, 0x08);
+      reply |= softBit<Kernel>(send, 0x04);
+      reply |= softBit<Kernel>(send, 0x02);
+      reply |= softBit<Kernel>(send, 0x01);
+    }
+
+    if (_miso != -1) {
+      buffer[i] = reply;
+    }
+  }
+}
+
+#ifdef BUSIO_HAS_PIO_SPI
+/*!
+ *    @brief  Move a software SPI device to a PIO state machine. The program
+ * clocks one bit per two instructions with SCK as side-set: MOSI changes while
+ * SCK is low and MISO is sampled on the rising edge (CPHA 0), SPI_MODE2 gets
+ * the same waveform through an inverted SCK pad. Autopull and autopush move
+ * whole bytes, shifted in the device's bit order. Two DMA channels are claimed
+ * for transferAsync() when available.
+ *    @return False if the mode or pins do not fit or no state machine is free:
+ * the device then stays on the software kernels
+ */
+bool Adafruit_SPIDevice::pioBegin(void) {
+  static const uint16_t instructions[] = {
+      0x6101, //  0: out pins, 1  side 0 [1] ; stalls with SCK low
+      0x5101, //  1: in  pins, 1  side 1 [1]
+  };
+  static const pio_program_t program = {instructions, 2, -1};
+  PIO pios[] = {pio0, pio1};
+  bool lsbFirst = (_dataOrder == SPI_BITORDER_LSBFIRST);
+  uint32_t outMask, pinMask;
+  pio_sm_config config;
+
+  if (_pioSm >= 0) {
+    return true;
+  }
+  if ((_sck < 0) || (_mosi < 0) || (_miso < 0) ||
+      ((_dataMode != SPI_MODE0) && (_dataMode != SPI_MODE2))) {
+    return false;
+  }
+  for (PIO pio : pios) {
+    if (pio_can_add_program(pio, &program)) {
+      int sm = pio_claim_unused_sm(pio, false);
+      if (sm >= 0) {
+        _pio = pio;
+        _pioSm = (int8_t)sm;
+        _pioOffset = (uint8_t)pio_add_program(pio, &program);
+        break;
+      }
+    }
+  }
+  if (_pioSm < 0) {
+    return false;
+  }
+
+  outMask = (1UL << _sck) | (1UL << _mosi);
+  pinMask = outMask | (1UL << _miso);
+  config = pio_get_default_sm_config();
+  sm_config_set_wrap(&config, _pioOffset, _pioOffset + 1);
+  sm_config_set_sideset(&config, 1, false, false);
+  sm_config_set_sideset_pins(&config, _sck);
+  sm_config_set_out_pins(&config, _mosi, 1);
+  sm_config_set_in_pins(&config, _miso);
+  sm_config_set_out_shift(&config, lsbFirst, true, 8);
+  sm_config_set_in_shift(&config, lsbFirst, true, 8);
+
+  pio_sm_set_pins_with_mask(_pio, _pioSm, 0, outMask);
+  pio_sm_set_pindirs_with_mask(_pio, _pioSm, outMask, pinMask);
+  pio_gpio_init(_pio, _sck);
+  pio_gpio_init(_pio, _mosi);
+  pio_gpio_init(_pio, _miso);
+  gpio_set_outover(_sck, (_dataMode == SPI_MODE2) ? GPIO_OVERRIDE_INVERT
+                                                  : GPIO_OVERRIDE_NORMAL);
+  pio_sm_init(_pio, _pioSm, _pioOffset, &config);
+  pioSetSpeed();
+  pio_sm_set_enabled(_pio, _pioSm, true);
+
+  _pioDmaTx = (int8_t)dma_claim_unused_channel(false);
+  _pioDmaRx = (int8_t)dma_claim_unused_channel(false);
+  if ((_pioDmaTx < 0) || (_pioDmaRx < 0)) {
+    if (_pioDmaTx >= 0) {
+      dma_channel_unclaim(_pioDmaTx);
+    }
+    if (_pioDmaRx >= 0) {
+      dma_channel_unclaim(_pioDmaRx);
+    }
+    _pioDmaTx = _pioDmaRx = -1;
+  }
+  return true;
 }
 
 /*!
- *    @brief  Release memory allocated in constructors
+ *    @brief  Set the PIO clock divider for _freq: four system clocks per bit
  */
-Adafruit_SPIDevice::~Adafruit_SPIDevice() {
-  if (_spiSetting)
-    delete _spiSetting;
+void Adafruit_SPIDevice::pioSetSpeed(void) {
+  float divider = (float)clock_get_hz(clk_sys) / (4.0f * (float)_freq);
+
+  if (divider < 1.0f) {
+    divider = 1.0f;
+  }
+  pio_sm_set_clkdiv(_pio, _pioSm, divider);
 }
 
+/*!
+ *    @brief  Wait until the state machine stalls on an empty TX FIFO, SCK
+ * low, so CS is never released in the middle of the last clock pulse
+ */
+void Adafruit_SPIDevice::pioWaitIdle(void) {
+  while (!pio_sm_is_tx_fifo_empty(_pio, _pioSm) ||
+         (pio_sm_get_pc(_pio, _pioSm) != _pioOffset)) {
+  }
+}
+
+/*!
+ *    @brief  Full-duplex transfer in place through the PIO FIFOs. At most
+ * four bytes are in flight, so the RX FIFO never fills and SCK does not stop
+ * in the middle of the transfer.
+ *    @param  buffer The buffer to send and receive at the same time
+ *    @param  len    The number of bytes to transfer
+ */
+void Adafruit_SPIDevice::pioTransfer(uint8_t *buffer, size_t len) {
+  io_rw_8 *txFifo = (io_rw_8 *)&_pio->txf[_pioSm];
+  // Right shifts leave the received byte in the top lane of the FIFO word
+  const volatile uint8_t *rxFifo =
+      (const volatile uint8_t *)&_pio->rxf[_pioSm] +
+      ((_dataOrder == SPI_BITORDER_LSBFIRST) ? 3 : 0);
+  size_t sent = 0;
+  size_t received = 0;
+
+  while (received < len) {
+    if ((sent < len) && ((sent - received) < 4)) {
+      *txFifo = buffer[sent++];
+    }
+    if (!pio_sm_is_rx_fifo_empty(_pio, _pioSm)) {
+      buffer[received++] = *rxFifo;
+    }
+  }
+  pioWaitIdle();
+}
+
+/*!
+ *    @brief  Start a full-duplex transfer in place with one DMA channel
+ * feeding the TX FIFO and one draining the RX FIFO, both paced by the state
+ * machine
+ *    @param  buffer The buffer to send and receive at the same time
+ *    @param  len    The number of bytes to transfer
+ */
+void Adafruit_SPIDevice::pioTransferAsync(uint8_t *buffer, size_t len) {
+  const volatile uint8_t *rxFifo =
+      (const volatile uint8_t *)&_pio->rxf[_pioSm] +
+      ((_dataOrder == SPI_BITORDER_LSBFIRST) ? 3 : 0);
+  dma_channel_config config;
+
+  config = dma_channel_get_default_config(_pioDmaTx);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+  channel_config_set_dreq(&config, pio_get_dreq(_pio, _pioSm, true));
+  dma_channel_configure(_pioDmaTx, &config, &_pio->txf[_pioSm], buffer, len,
+                        false);
+
+  config = dma_channel_get_default_config(_pioDmaRx);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+  channel_config_set_dreq(&config, pio_get_dreq(_pio, _pioSm, false));
+  channel_config_set_read_increment(&config, false);
+  channel_config_set_write_increment(&config, true);
+  dma_channel_configure(_pioDmaRx, &config, buffer, rxFifo, len, false);
+
+  dma_start_channel_mask((1UL << _pioDmaTx) | (1UL << _pioDmaRx));
+}
+#endif
+
 /*!
  *    @brief  Initializes SPI bus and sets CS pin high
  *    @return Always returns true because there's no way to test success of SPI
@@ -118,6 +413,12 @@ bool Adafruit_SPIDevice::begin(void) {
     _spi->begin();
 #endif
   } else {
+#ifdef BUSIO_HAS_PIO_SPI
+    if (pioBegin()) {
+      _begun = true;
+      return true;
+    }
+#endif
     pinMode(_sck, OUTPUT);
 
     if ((_dataMode == SPI_MODE0) || (_dataMode == SPI_MODE1)) {
@@ -156,7 +457,7 @@ void Adafruit_SPIDevice::transfer(uint8_t *buffer, size_t len) {
     _spi->transfer(buffer, buffer, len, nullptr);
 #elif defined(STM32)
     for (size_t i = 0; i < len; i++) {
-      _spi->transfer(buffer[i]);
+      buffer[i] = _spi->transfer(buffer[i]);
     }
 #else
     _spi->transfer(buffer, len);
@@ -168,104 +469,42 @@ void Adafruit_SPIDevice::transfer(uint8_t *buffer, size_t len) {
   //
   // SOFTWARE SPI
   //
-  uint8_t startbit;
-  if (_dataOrder == SPI_BITORDER_LSBFIRST) {
-    startbit = 0x1;
-  } else {
-    startbit = 0x80;
+#ifdef BUSIO_HAS_PIO_SPI
+  if (_pioSm >= 0) {
+    pioTransfer(buffer, len);
+    return;
   }
+#endif
+  if (_softTransfer) {
+    (this->*_softTransfer)(buffer, len);
+  }
+}
 
-  bool towrite, lastmosi = !(buffer[0] & startbit);
-  uint8_t bitdelay_us = (1000000 / _freq) / 2;
-
-  for (size_t i = 0; i < len; i++) {
-    uint8_t reply = 0;
-    uint8_t send = buffer[i];
-
-    /*
-    Serial.print("\tSending software SPI byte 0x");
-    Serial.print(send, HEX);
-    Serial.print(" -> 0x");
-    */
-
-    // Serial.print(send, HEX);
-    for (uint8_t b = startbit; b != 0;
-         b = (_dataOrder == SPI_BITORDER_LSBFIRST) ? b << 1 : b >> 1) {
-
-      if (bitdelay_us) {
-        delayMicroseconds(bitdelay_us);
-      }
-
-      if (_dataMode == SPI_MODE0 || _dataMode == SPI_MODE2) {
-        towrite = send & b;
-        if ((_mosi != -1) && (lastmosi != towrite)) {
-          BUSIO_WRITE_MOSI(towrite);
-          lastmosi = towrite;
-        }
-
-        BUSIO_SET_CLOCK_HIGH();
-
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
-
-        if (_miso != -1) {
-          if (BUSIO_READ_MISO())
-            reply |= b;
-        }
-
-        BUSIO_SET_CLOCK_LOW();
-
-      } else if (_dataMode == SPI_MODE3) {
-
-        if (_mosi != -1) { // transmit on falling edge
-          BUSIO_WRITE_MOSI(send & b);
-        }
-
-        BUSIO_SET_CLOCK_LOW();
-
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
-
-        BUSIO_SET_CLOCK_HIGH();
-
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
-
-        if (_miso != -1) { // read on rising edge
-          if (BUSIO_READ_MISO()) {
-            reply |= b;
-          }
-        }
-
-      } else { // || _dataMode == SPI_MODE1)
-
-        BUSIO_SET_CLOCK_HIGH();
-
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
-
-        if (_mosi != -1) {
-          BUSIO_WRITE_MOSI(send & b);
-        }
-
-        BUSIO_SET_CLOCK_LOW();
-
-        if (_miso != -1) {
-          if (BUSIO_READ_MISO()) {
-            reply |= b;
-          }
-        }
-      }
-    }
-    if (_miso != -1) {
-      buffer[i] = reply;
-    }
+/*!
+ *    @brief  Write a buffer over hard/soft SPI, without transaction management,
+ * discarding the received bytes. The data is staged in
+ * BUSIO_SPI_WRITE_CHUNK-byte blocks so the buffer transfer() is used instead
+ * of one call per byte.
+ *    @param  buffer Pointer to buffer of data to write. This is const to
+ *            ensure the content of this buffer doesn't change.
+ *    @param  len Number of bytes from buffer to write.
+ */
+void Adafruit_SPIDevice::transmit(const uint8_t *buffer, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_spi) {
+    _spi->transferBytes((uint8_t *)buffer, nullptr, len);
+    return;
+  }
+#endif
+  uint8_t chunk[BUSIO_SPI_WRITE_CHUNK];
+
+  while (len > 0) {
+    size_t n = (len > sizeof(chunk)) ? sizeof(chunk) : len;
+    memcpy(chunk, buffer, n);
+    transfer(chunk, n);
+    buffer += n;
+    len -= n;
   }
-  return;
 }
 
 /*!
@@ -285,9 +524,9 @@ uint8_t Adafruit_SPIDevice::transfer(uint8_t send) {
  * SPI)
  */
 void Adafruit_SPIDevice::beginTransaction(void) {
-  if (_spi) {
+  if (_spi && (_holdDepth == 0)) {
 #ifdef BUSIO_HAS_HW_SPI
-    _spi->beginTransaction(*_spiSetting);
+    _spi->beginTransaction(_spiSetting);
 #endif
   }
 }
@@ -296,13 +535,66 @@ void Adafruit_SPIDevice::beginTransaction(void) {
  *    @brief  Manually end a transaction (calls endTransaction if hardware SPI)
  */
 void Adafruit_SPIDevice::endTransaction(void) {
-  if (_spi) {
+  if (_spi && (_holdDepth == 0)) {
 #ifdef BUSIO_HAS_HW_SPI
     _spi->endTransaction();
 #endif
   }
 }
 
+/*!
+ *    @brief  Keep one hardware SPI transaction open across several operations.
+ * Until the matching releaseTransaction(), the read/write helpers only toggle
+ * CS and skip beginTransaction()/endTransaction(), so a status poll loop and
+ * the following data read share one transaction. Calls may be nested. Other
+ * devices on the same bus must not be used while a transaction is held.
+ */
+void Adafruit_SPIDevice::holdTransaction(void) {
+  beginTransaction();
+  _holdDepth++;
+}
+
+/*!
+ *    @brief  Change the SPI clock used by the following transactions
+ *    @param  freq The SPI clock frequency to use
+ *    @return false if freq is 0 or a transaction is held, true otherwise
+ */
+bool Adafruit_SPIDevice::setSpeed(uint32_t freq) {
+  if ((freq == 0) || (_holdDepth > 0)) {
+    return false;
+  }
+
+#ifdef BUSIO_HAS_HW_SPI
+  _spiSetting = SPISettings(freq, _dataOrder, _dataMode);
+#endif
+  _freq = freq;
+  // Software SPI: new half-bit delay
+  selectSoftTransfer();
+#ifdef BUSIO_HAS_PIO_SPI
+  if (_pioSm >= 0) {
+    pioSetSpeed();
+  }
+#endif
+  return true;
+}
+
+/*!
+ *    @brief  Get the SPI clock set at construction or by setSpeed()
+ *    @return The SPI clock frequency in Hz
+ */
+uint32_t Adafruit_SPIDevice::getSpeed(void) const { return _freq; }
+
+/*!
+ *    @brief  Close the transaction opened by holdTransaction() once the
+ * outermost hold is released
+ */
+void Adafruit_SPIDevice::releaseTransaction(void) {
+  if (_holdDepth > 0) {
+    _holdDepth--;
+    endTransaction();
+  }
+}
+
 /*!
  *    @brief  Assert/Deassert the CS pin if it is defined
  *    @param  value The state the CS is set to
@@ -350,23 +642,11 @@ bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
   beginTransactionWithAssertingCS();
 
   // do the writing
-#if defined(ARDUINO_ARCH_ESP32)
-  if (_spi) {
-    if (prefix_len > 0) {
-      _spi->transferBytes((uint8_t *)prefix_buffer, nullptr, prefix_len);
-    }
-    if (len > 0) {
-      _spi->transferBytes((uint8_t *)buffer, nullptr, len);
-    }
-  } else
-#endif
-  {
-    for (size_t i = 0; i < prefix_len; i++) {
-      transfer(prefix_buffer[i]);
-    }
-    for (size_t i = 0; i < len; i++) {
-      transfer(buffer[i]);
-    }
+  if (prefix_len > 0) {
+    transmit(prefix_buffer, prefix_len);
+  }
+  if (len > 0) {
+    transmit(buffer, len);
   }
   endTransactionWithDeassertingCS();
 
@@ -444,17 +724,8 @@ bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
                                          size_t read_len, uint8_t sendvalue) {
   beginTransactionWithAssertingCS();
   // do the writing
-#if defined(ARDUINO_ARCH_ESP32)
-  if (_spi) {
-    if (write_len > 0) {
-      _spi->transferBytes((uint8_t *)write_buffer, nullptr, write_len);
-    }
-  } else
-#endif
-  {
-    for (size_t i = 0; i < write_len; i++) {
-      transfer(write_buffer[i]);
-    }
+  if (write_len > 0) {
+    transmit(write_buffer, write_len);
   }
 
 #ifdef DEBUG_SERIAL
@@ -470,9 +741,10 @@ bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
   DEBUG_SERIAL.println();
 #endif
 
-  // do the reading
-  for (size_t i = 0; i < read_len; i++) {
-    read_buffer[i] = transfer(sendvalue);
+  // do the reading, in place as one block
+  if (read_len > 0) {
+    memset(read_buffer, sendvalue, read_len);
+    transfer(read_buffer, read_len);
   }
 
 #ifdef DEBUG_SERIAL
@@ -510,3 +782,107 @@ bool Adafruit_SPIDevice::write_and_read(uint8_t *buffer, size_t len) {
 
   return true;
 }
+
+/*!
+ *    @brief  Start a full-duplex transfer in place that runs in the background
+ * on cores with SPI DMA (BUSIO_HAS_SPI_DMA), with transaction management. The
+ * CPU is free until transferAsyncDone() reports completion; the buffer must
+ * stay untouched until then. Software SPI devices running on PIO
+ * (BUSIO_HAS_PIO_SPI) use DMA the same way. Elsewhere, the transfer is done
+ * synchronously and the callback runs before this returns.
+ *    @param  buffer Pointer to buffer of data to write/read to/from
+ *    @param  len Number of bytes from buffer to write/read.
+ *    @param  callback Optional function called once the transfer completed
+ *    @param  context Argument passed to the callback
+ *    @return False if another asynchronous transfer is still running,
+ * otherwise true
+ */
+bool Adafruit_SPIDevice::transferAsync(uint8_t *buffer, size_t len,
+                                       BusIO_SPICallback callback,
+                                       void *context) {
+  if (_asyncBusy) {
+    return false;
+  }
+  _asyncCallback = callback;
+  _asyncContext = context;
+  _asyncBusy = true;
+  beginTransactionWithAssertingCS();
+
+#ifdef BUSIO_HAS_SPI_DMA
+  if (_spi && (len > 0)) {
+#if defined(ARDUINO_ARCH_RP2040)
+    if (_spi->transferAsync(buffer, buffer, len)) {
+      return true;
+    }
+#else
+    _spi->transfer(buffer, buffer, len, false);
+    return true;
+#endif
+  }
+#endif
+#ifdef BUSIO_HAS_PIO_SPI
+  if ((_pioDmaRx >= 0) && (len > 0)) {
+    pioTransferAsync(buffer, len);
+    return true;
+  }
+#endif
+
+  // Synchronous fallback
+  transfer(buffer, len);
+  finishAsync();
+  return true;
+}
+
+/*!
+ *    @brief  Poll an asynchronous transfer started with transferAsync(). On
+ * completion the chip select is released, the transaction ended and the
+ * callback called, once.
+ *    @return True if no transfer is running anymore, false while the DMA is
+ * still busy
+ */
+bool Adafruit_SPIDevice::transferAsyncDone(void) {
+  if (!_asyncBusy) {
+    return true;
+  }
+
+#ifdef BUSIO_HAS_PIO_SPI
+  if (_pioDmaRx >= 0) {
+    if (dma_channel_is_busy(_pioDmaRx)) {
+      return false;
+    }
+    pioWaitIdle();
+    finishAsync();
+    return true;
+  }
+#endif
+
+#ifdef BUSIO_HAS_SPI_DMA
+#if defined(ARDUINO_ARCH_RP2040)
+  if (!_spi->finishedAsync()) {
+    return false;
+  }
+#else
+  if (_spi->isBusy()) {
+    return false;
+  }
+#endif
+#endif
+
+  finishAsync();
+  return true;
+}
+
+/*!
+ *    @brief  Close the transaction of a completed asynchronous transfer and
+ * notify the caller
+ */
+void Adafruit_SPIDevice::finishAsync(void) {
+  BusIO_SPICallback callback = _asyncCallback;
+
+  endTransactionWithDeassertingCS();
+  _asyncCallback = nullptr;
+  _asyncBusy = false;
+  if (callback) {
+    callback(_asyncContext);
+  }
+}
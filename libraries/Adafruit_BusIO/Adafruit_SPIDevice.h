@@ -91,6 +91,30 @@ typedef uint32_t BusIO_PortMask;
 #undef BUSIO_USE_FAST_PINIO
 #endif
 
+// Cores whose SPIClass can run a buffer transfer in the background with DMA
+#if defined(BUSIO_HAS_HW_SPI) &&                                               \
+    (defined(ARDUINO_SAMD_ADAFRUIT) ||                                         \
+     (defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED)))
+#define BUSIO_HAS_SPI_DMA
+#endif
+
+// RP2040 cores with the Pico SDK: software SPI devices in SPI_MODE0 or
+// SPI_MODE2 run on a PIO state machine, on any pins, instead of being
+// bit-banged. Define BUSIO_NO_PIO_SPI to always bit-bang.
+#if defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED) &&            \
+    !defined(BUSIO_NO_PIO_SPI)
+#define BUSIO_HAS_PIO_SPI
+#include <hardware/pio.h>
+#endif
+
+/// Called once an asynchronous transfer has completed
+typedef void (*BusIO_SPICallback)(void *context);
+
+/// Bytes staged on the stack per block when a const buffer is written
+#ifndef BUSIO_SPI_WRITE_CHUNK
+#define BUSIO_SPI_WRITE_CHUNK 32
+#endif
+
 /**! The class which defines how we will talk to this device over SPI **/
 class Adafruit_SPIDevice {
 public:
@@ -107,9 +131,10 @@ public:
                      uint32_t freq = 1000000,
                      BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
                      uint8_t dataMode = SPI_MODE0);
-  ~Adafruit_SPIDevice();
 
   bool begin(void);
+  bool setSpeed(uint32_t freq);
+  uint32_t getSpeed(void) const;
   bool read(uint8_t *buffer, size_t len, uint8_t sendvalue = 0xFF);
   bool write(const uint8_t *buffer, size_t len,
              const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0);
@@ -117,28 +142,63 @@ public:
                        uint8_t *read_buffer, size_t read_len,
                        uint8_t sendvalue = 0xFF);
   bool write_and_read(uint8_t *buffer, size_t len);
+  bool transferAsync(uint8_t *buffer, size_t len,
+                     BusIO_SPICallback callback = nullptr,
+                     void *context = nullptr);
+  bool transferAsyncDone(void);
 
   uint8_t transfer(uint8_t send);
   void transfer(uint8_t *buffer, size_t len);
+  void transmit(const uint8_t *buffer, size_t len);
   void beginTransaction(void);
   void endTransaction(void);
   void beginTransactionWithAssertingCS();
   void endTransactionWithDeassertingCS();
+  void holdTransaction(void);
+  void releaseTransaction(void);
 
 private:
 #ifdef BUSIO_HAS_HW_SPI
   SPIClass *_spi = nullptr;
-  SPISettings *_spiSetting = nullptr;
+  SPISettings _spiSetting; // held by value: no heap allocation
 #else
   uint8_t *_spi = nullptr;
-  uint8_t *_spiSetting = nullptr;
 #endif
   uint32_t _freq;
   BusIOBitOrder _dataOrder;
   uint8_t _dataMode;
   void setChipSelect(int value);
+  uint8_t _holdDepth = 0; // nested holdTransaction() calls
 
   int8_t _cs, _sck, _mosi, _miso;
+
+  // Software SPI kernel, chosen once from the mode and bit order
+  typedef void (Adafruit_SPIDevice::*SoftTransfer)(uint8_t *buffer,
+                                                   size_t len);
+  SoftTransfer _softTransfer = nullptr;
+  uint8_t _bitDelayUs = 0;
+  void selectSoftTransfer(void);
+  template <uint8_t Kernel, bool LsbFirst>
+  void softTransfer(uint8_t *buffer, size_t len);
+  template <uint8_t Kernel> uint8_t softBit(uint8_t send, uint8_t mask);
+
+#ifdef BUSIO_HAS_PIO_SPI
+  // PIO state machine taking over from the software kernels, see pioBegin()
+  PIO _pio = nullptr;
+  int8_t _pioSm = -1;
+  uint8_t _pioOffset = 0;
+  int8_t _pioDmaTx = -1, _pioDmaRx = -1; // -1: synchronous transfers only
+  bool pioBegin(void);
+  void pioSetSpeed(void);
+  void pioWaitIdle(void);
+  void pioTransfer(uint8_t *buffer, size_t len);
+  void pioTransferAsync(uint8_t *buffer, size_t len);
+#endif
+
+  volatile bool _asyncBusy = false;
+  BusIO_SPICallback _asyncCallback = nullptr;
+  void *_asyncContext = nullptr;
+  void finishAsync(void);
 #ifdef BUSIO_USE_FAST_PINIO
   BusIO_PortReg *mosiPort, *clkPort, *misoPort, *csPort;
   BusIO_PortMask mosiPinMask, misoPinMask, clkPinMask, csPinMask;
@@ -0,0 +1,51 @@
+#include <Adafruit_BusIO_Register.h>
+#include <Adafruit_I2CDevice.h>
+
+#define I2C_ADDRESS 0x60
+Adafruit_I2CDevice i2c_dev = Adafruit_I2CDevice(I2C_ADDRESS);
+
+// Registers 0x00..0x07 of the device, mirrored in one shadow copy
+Adafruit_BusIO_Register first_reg = Adafruit_BusIO_Register(&i2c_dev, 0x00);
+uint8_t shadow[8];
+Adafruit_BusIO_RegisterFile regs =
+    Adafruit_BusIO_RegisterFile(&first_reg, shadow, sizeof(shadow));
+
+void setup() {
+  while (!Serial) {
+    delay(10);
+  }
+  Serial.begin(115200);
+  Serial.println("I2C device register file test");
+
+  if (!i2c_dev.begin()) {
+    Serial.print("Did not find device at 0x");
+    Serial.println(i2c_dev.address(), HEX);
+    while (1)
+      ;
+  }
+
+  // One burst read for all eight registers
+  if (!regs.refresh()) {
+    Serial.println("Burst read failed");
+    while (1)
+      ;
+  }
+  for (uint8_t reg = 0; reg < sizeof(shadow); reg++) {
+    Serial.print("Register 0x0");
+    Serial.print(reg, HEX);
+    Serial.print(" = 0x");
+    Serial.println(regs.read(reg), HEX);
+  }
+
+  // Change fields in two registers, then write them in one transaction
+  regs.writeBits(0x01, 2, 4, 0x3);
+  regs.writeBits(0x03, 1, 0, 1);
+  regs.write(0x04, ~regs.read(0x04));
+  regs.flush();
+
+  regs.refresh();
+  Serial.print("Post register 0x04 = 0x");
+  Serial.println(regs.read(0x04), HEX);
+}
+
+void loop() {}
@@ -59,11 +59,12 @@
 
 #include "Adafruit_PN532.h"
 
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
 byte pn532ack[] = {0x00, 0x00, 0xFF,
                    0x00, 0xFF, 0x00}; ///< ACK message from PN532
-byte pn532response_firmwarevers[] = {
-    0x00, 0x00, 0xFF,
-    0x06, 0xFA, 0xD5}; ///< Expected firmware version message from PN532
 
 // Uncomment these lines to enable debug output for PN532(SPI) and/or MIFARE
 // related code
@@ -75,10 +76,22 @@ byte pn532response_firmwarevers[] = {
 #define PN532DEBUGPRINT Serial ///< Fixed name for debug Serial instance
 // #define PN532DEBUGPRINT SerialUSB ///< Fixed name for debug Serial instance
 
-#define PN532_PACKBUFFSIZ 255                ///< Packet buffer size in bytes
-byte pn532_packetbuffer[PN532_PACKBUFFSIZ]; ///< Packet buffer used in various
-                                            ///< transactions
+#if (defined(PN532DEBUG) || defined(MIFAREDEBUG)) && !PN532_ENABLE_PRINTHEX
+#error "PN532DEBUG and MIFAREDEBUG need PN532_ENABLE_PRINTHEX"
+#endif
+
+#define PN532_DATAEXCHANGE_CHUNK                                               \
+  (PN532_PACKBUFFSIZ - 3) ///< Data bytes per chained InDataExchange frame
+#define PN532_DATAEXCHANGE_DATA_OFFSET                                         \
+  (2) ///< Command code and Tg in front of the InDataExchange data
+#define PN532_I2C_FRAME_OVERHEAD                                               \
+  (10) ///< Frame bytes around the InDataExchange data on the I2C bus
+#define PN532_I2C_MIN_CHUNK                                                    \
+  (16) ///< Smallest chained frame worth fitting into the Wire buffer
 
+Adafruit_PN532 *Adafruit_PN532::_irqOwner = NULL;
+
+#if PN532_HAS_SPI
 /**************************************************************************/
 /*!
     @brief  Instantiates a new PN532 class using software SPI.
@@ -87,15 +100,18 @@ byte pn532_packetbuffer[PN532_PACKBUFFSIZ]; ///< Packet buffer used in various
     @param  miso      SPI MISO pin
     @param  mosi      SPI MOSI pin
     @param  ss        SPI chip select pin (CS/SSEL)
+    @param  spiClock  SPI clock in Hz, at most PN532_SPI_MAX_CLOCK
 */
 /**************************************************************************/
 Adafruit_PN532::Adafruit_PN532(uint8_t clk, uint8_t miso, uint8_t mosi,
-                               uint8_t ss) {
+                               uint8_t ss, uint32_t spiClock) {
   _cs = ss;
-  spi_dev = new Adafruit_SPIDevice(ss, clk, miso, mosi, 1000000,
-                                   SPI_BITORDER_LSBFIRST, SPI_MODE0);
+  spi_dev = new (_busStorage) Adafruit_SPIDevice(
+      ss, clk, miso, mosi, spiClock, SPI_BITORDER_LSBFIRST, SPI_MODE0);
 }
+#endif
 
+#if PN532_HAS_I2C
 /**************************************************************************/
 /*!
     @brief  Instantiates a new PN532 class using I2C.
@@ -109,23 +125,29 @@ Adafruit_PN532::Adafruit_PN532(uint8_t irq, uint8_t reset, TwoWire *theWire)
     : _irq(irq), _reset(reset) {
   pinMode(_irq, INPUT);
   pinMode(_reset, OUTPUT);
-  i2c_dev = new Adafruit_I2CDevice(PN532_I2C_ADDRESS, theWire);
+  i2c_dev = new (_busStorage) Adafruit_I2CDevice(PN532_I2C_ADDRESS, theWire);
 }
+#endif
 
+#if PN532_HAS_SPI
 /**************************************************************************/
 /*!
     @brief  Instantiates a new PN532 class using hardware SPI.
 
     @param  ss        SPI chip select pin (CS/SSEL)
     @param  theSPI    pointer to the SPI bus to use
+    @param  spiClock  SPI clock in Hz, at most PN532_SPI_MAX_CLOCK
 */
 /**************************************************************************/
-Adafruit_PN532::Adafruit_PN532(uint8_t ss, SPIClass *theSPI) {
+Adafruit_PN532::Adafruit_PN532(uint8_t ss, SPIClass *theSPI,
+                               uint32_t spiClock) {
   _cs = ss;
-  spi_dev = new Adafruit_SPIDevice(ss, 1000000, SPI_BITORDER_LSBFIRST,
-                                   SPI_MODE0, theSPI);
+  spi_dev = new (_busStorage) Adafruit_SPIDevice(
+      ss, spiClock, SPI_BITORDER_LSBFIRST, SPI_MODE0, theSPI);
 }
+#endif
 
+#if PN532_HAS_HSU
 /**************************************************************************/
 /*!
     @brief  Instantiates a new PN532 class using hardware UART (HSU).
@@ -139,6 +161,36 @@ Adafruit_PN532::Adafruit_PN532(uint8_t reset, HardwareSerial *theSer)
   pinMode(_reset, OUTPUT);
   ser_dev = theSer;
 }
+#endif
+
+#if PN532_HAS_MOCK
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new PN532 class talking to a mock link, e.g. a
+            PN532 emulator for host-side tests and benchmarks. There is no
+            reset or IRQ pin.
+
+    @param  theMock   pointer to the mock link to use
+*/
+/**************************************************************************/
+Adafruit_PN532::Adafruit_PN532(Adafruit_PN532_MockLink *theMock) {
+  mock_dev = theMock;
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Destroys the bus device built in place by the constructor.
+*/
+/**************************************************************************/
+Adafruit_PN532::~Adafruit_PN532() {
+  if (spi_dev) {
+    spi_dev->~Adafruit_SPIDevice();
+  }
+  if (i2c_dev) {
+    i2c_dev->~Adafruit_I2CDevice();
+  }
+}
 
 /**************************************************************************/
 /*!
@@ -148,26 +200,33 @@ Adafruit_PN532::Adafruit_PN532(uint8_t reset, HardwareSerial *theSer)
 */
 /**************************************************************************/
 bool Adafruit_PN532::begin() {
-  if (spi_dev) {
+  if (onSPI()) {
     // SPI initialization
     if (!spi_dev->begin()) {
       return false;
     }
-  } else if (i2c_dev) {
+  } else if (onI2C()) {
     // I2C initialization
     // PN532 will fail address check since its asleep, so suppress
     if (!i2c_dev->begin(false)) {
       return false;
     }
-  } else if (ser_dev) {
-    ser_dev->begin(115200);
+  } else if (onHSU()) {
+    ser_dev->begin(PN532_HSU_DEFAULT_BAUD);
     // clear out anything in read buffer
     while (ser_dev->available())
       ser_dev->read();
+    _rxHead = 0;
+    _rxTail = 0;
+  } else if (onMock()) {
+    mock_dev->begin();
+    _rxHead = 0;
+    _rxTail = 0;
   } else {
     // no interface specified
     return false;
   }
+  invalidateConfig();
   reset(); // HW reset - put in known state
   delay(10);
   wakeup(); // hey! wakeup!
@@ -182,6 +241,8 @@ bool Adafruit_PN532::begin() {
 void Adafruit_PN532::reset(void) {
   // see Datasheet p.209, Fig.48 for timings
   if (_reset != -1) {
+    // the PN532 forgets its configuration
+    invalidateConfig();
     digitalWrite(_reset, LOW);
     delay(1); // min 20ns
     digitalWrite(_reset, HIGH);
@@ -195,23 +256,107 @@ void Adafruit_PN532::reset(void) {
 */
 /**************************************************************************/
 void Adafruit_PN532::wakeup(void) {
-  // interface specific wakeups - each one is unique!
-  if (spi_dev) {
+  // LowVbat mode needs the SAM configuration again
+  _samConfigured = false;
+  wakeInterface();
+
+  // PN532 will clock stretch I2C during SAMConfig as a "wakeup"
+
+  // need to config SAM to stay in Normal Mode
+  SAMConfig();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Interface specific wake-up sequence, each one is unique!
+*/
+/**************************************************************************/
+void Adafruit_PN532::wakeInterface(void) {
+  if (onSPI()) {
     // hold CS low for 2ms
     digitalWrite(_cs, LOW);
     delay(2);
-  } else if (ser_dev) {
-    uint8_t w[3] = {0x55, 0x00, 0x00};
+  } else if (onHSU()) {
+    uint8_t w[3] = {PN532_WAKEUP, 0x00, 0x00};
     ser_dev->write(w, 3);
     delay(2);
   }
+}
 
-  // PN532 will clock stretch I2C during SAMConfig as a "wakeup"
+/**************************************************************************/
+/*!
+    @brief  Puts the PN532 into PowerDown. It draws a few tens of uA until
+            one of the wake-up sources fires; with generateIrq the IRQ line
+            then goes low, so the host can sleep as well until it does.
+            SAM and RF settings survive, see wakeFromPowerDown().
+
+    @param  wakeUpSources  OR of PN532_WAKEUP_SOURCE_* bits. The bus in use
+                           should be part of it, or only the other sources
+                           can bring the PN532 back.
+    @param  generateIrq    Pull IRQ low when the PN532 wakes up
+    @return true if the PN532 accepted the command, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::powerDown(uint8_t wakeUpSources, bool generateIrq) {
+  pn532_packetbuffer[0] = PN532_COMMAND_POWERDOWN;
+  pn532_packetbuffer[1] = wakeUpSources;
+  pn532_packetbuffer[2] = generateIrq ? 0x01 : 0x00;
 
-  // need to config SAM to stay in Normal Mode
-  SAMConfig();
+  if (!sendCommandCheckAck(pn532_packetbuffer, 3)) {
+    return false;
+  }
+
+  // The answer is sent before the PN532 goes to sleep
+  PN532Frame frame;
+  bool ok = readResponse(PN532_COMMAND_POWERDOWN, &frame) &&
+            (frame.length >= 1) && ((frame.payload[0] & 0x3f) == 0);
+  _irqFired = false;
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  PowerDown wake-up source matching the bus this object talks on.
+
+    @return PN532_WAKEUP_SOURCE_I2C, _SPI or _HSU.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::hostWakeUpSource(void) {
+  if (onI2C()) {
+    return PN532_WAKEUP_SOURCE_I2C;
+  } else if (onSPI()) {
+    return PN532_WAKEUP_SOURCE_SPI;
+  }
+  return PN532_WAKEUP_SOURCE_HSU;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Brings the PN532 back from PowerDown. Only the bus wake-up pulse
+            and the oscillator start-up are waited for: the SAM and RF
+            configuration were kept, so neither reset() nor SAMConfig() is
+            needed and the next command can be sent at once.
+*/
+/**************************************************************************/
+void Adafruit_PN532::wakeFromPowerDown(void) {
+  if (onI2C()) {
+    // The address phase wakes the PN532; this read may not be answered
+    uint8_t rdy;
+    (void)i2c_dev->read(&rdy, 1);
+  } else if (onSPI()) {
+    // A short CS pulse is enough once the PN532 sleeps on SPI activity
+    digitalWrite(_cs, LOW);
+    delayMicroseconds(100);
+    digitalWrite(_cs, HIGH);
+  } else {
+    wakeInterface();
+  }
+  pauseMicros(PN532_WAKEUP_DELAY_US);
+  _irqFired = false;
 }
 
+#if PN532_ENABLE_PRINTHEX
+
 /**************************************************************************/
 /*!
     @brief  Prints a hexadecimal value in plain characters
@@ -266,6 +411,8 @@ void Adafruit_PN532::PrintHexChar(const byte *data, const uint32_t numBytes) {
   }
   PN532DEBUGPRINT.println();
 }
+#endif // PN532_ENABLE_PRINTHEX
+
 
 /**************************************************************************/
 /*!
@@ -284,25 +431,22 @@ uint32_t Adafruit_PN532::getFirmwareVersion(void) {
   }
 
   // read data packet
-  readdata(pn532_packetbuffer, 13);
-
-  // check some basic stuff
-  if (0 != memcmp((char *)pn532_packetbuffer,
-                  (char *)pn532response_firmwarevers, 6)) {
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_GETFIRMWAREVERSION, &frame) ||
+      (frame.length < 4)) {
 #ifdef PN532DEBUG
     PN532DEBUGPRINT.println(F("Firmware doesn't match!"));
 #endif
     return 0;
   }
 
-  int offset = 7;
-  response = pn532_packetbuffer[offset++];
+  response = frame.payload[0];
   response <<= 8;
-  response |= pn532_packetbuffer[offset++];
+  response |= frame.payload[1];
   response <<= 8;
-  response |= pn532_packetbuffer[offset++];
+  response |= frame.payload[2];
   response <<= 8;
-  response |= pn532_packetbuffer[offset++];
+  response |= frame.payload[3];
 
   return response;
 }
@@ -322,26 +466,76 @@ uint32_t Adafruit_PN532::getFirmwareVersion(void) {
 // default timeout of one second
 bool Adafruit_PN532::sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
                                          uint16_t timeout) {
+  // write, ACK polls, ACK read and response polls share one SPI transaction
+  bool held = holdSPI();
+  bool ok = sendCommand(cmd, cmdlen, timeout);
 
-  // I2C works without using IRQ pin by polling for RDY byte
-  // seems to work best with some delays between transactions
-  uint8_t SLOWDOWN = 0;
-  if (i2c_dev || spi_dev) // SPI and I2C need 1ms slow for page reads
-    SLOWDOWN = 1;
+  if (ok) {
+    // I2C TUNING
+    if (onI2C() || onSPI()) // SPI and I2C need a pause for page reads
+      pauseMicros(_responseDelayUs);
+
+    // Wait for chip to say its ready!
+    ok = waitready(timeout);
+  }
+
+  if (held) {
+    spi_dev->releaseTransaction();
+  }
+  return ok; // ack'd command
+}
+
+/**************************************************************************/
+/*!
+    @brief  Keeps the SPI transaction open across the status polls and
+            reads of one exchange, so they only toggle CS. Not done in IRQ
+            mode (no polls) or when an idle callback may use the bus.
+
+    @returns  true if a transaction is held and must be released
+*/
+/**************************************************************************/
+bool Adafruit_PN532::holdSPI(void) {
+  if (onSPI() && !_irqEnabled && (_idleCallback == NULL)) {
+    spi_dev->holdTransaction();
+    return true;
+  }
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sends a command and waits for the ACK only. The response is
+            not waited for: poll isready() and read it when available.
+
+    @param  cmd       Pointer to the command buffer
+    @param  cmdlen    The size of the command in bytes
+    @param  timeout   timeout before giving up on the ACK
+
+    @returns  1 if the command was ACK'd, 0 if timeout occured before an
+              ACK was recieved
+*/
+/**************************************************************************/
+bool Adafruit_PN532::sendCommand(uint8_t *cmd, uint8_t cmdlen,
+                                 uint16_t timeout) {
 
   // write the command
   writecommand(cmd, cmdlen);
+  unsigned long ackStart = micros();
 
-  // I2C TUNING
-  delay(SLOWDOWN);
+  // I2C works without using IRQ pin by polling for RDY byte
+  // seems to work best with some delays between transactions
+  if (onI2C() || onSPI())
+    pauseMicros(_ackDelayUs);
 
   // Wait for chip to say its ready!
-  if (!waitready(timeout)) {
+  bool acked = waitready(timeout);
+  _ackWaitMicros += (uint32_t)(micros() - ackStart);
+  if (!acked) {
     return false;
   }
 
 #ifdef PN532DEBUG
-  if (spi_dev == NULL) {
+  if (!onSPI()) {
     PN532DEBUGPRINT.println(F("IRQ received"));
   }
 #endif
@@ -354,15 +548,309 @@ bool Adafruit_PN532::sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
     return false;
   }
 
-  // I2C TUNING
-  delay(SLOWDOWN);
+  return true;
+}
 
-  // Wait for chip to say its ready!
-  if (!waitready(timeout)) {
+/**************************************************************************/
+/*!
+    @brief   Returns the total time spent waiting for command ACKs.
+    @return  Accumulated microseconds, wraps around like micros().
+*/
+/**************************************************************************/
+uint32_t Adafruit_PN532::getAckWaitMicros(void) { return _ackWaitMicros; }
+
+/**************************************************************************/
+/*!
+    @brief   Sets the I2C/SPI timing profile. The defaults are the historic
+             1 ms pauses and 10 ms poll steps; HSU ignores the pauses.
+
+    @param   ackDelayUs       Pause after a command before polling for ACK
+    @param   responseDelayUs  Pause after the ACK before polling for the
+                              response
+    @param   pollIntervalUs   Pause between two ready polls when the IRQ
+                              line is not used
+*/
+/**************************************************************************/
+void Adafruit_PN532::setTiming(uint16_t ackDelayUs, uint16_t responseDelayUs,
+                               uint16_t pollIntervalUs) {
+  _ackDelayUs = ackDelayUs;
+  _responseDelayUs = responseDelayUs;
+  _pollIntervalUs =
+      (pollIntervalUs == 0) ? PN532_MIN_POLL_INTERVAL_US : pollIntervalUs;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Measures how fast this PN532 answers on the current bus and
+             tunes the timing profile to match.
+
+             GetFirmwareVersion is sent a few times with busy polling. The
+             pauses are set to 3/4 of the fastest ACK and response seen, so
+             the first poll lands just before the chip is ready, and the poll
+             interval to 1/4 of the fastest ACK. The profile is left
+             untouched if a sample fails.
+
+    @param   samples  Number of GetFirmwareVersion exchanges to time
+    @return  true if the profile was updated, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::calibrateTiming(uint8_t samples) {
+  uint32_t bestAck = PN532_CALIBRATION_TIMEOUT_US;
+  uint32_t bestResponse = PN532_CALIBRATION_TIMEOUT_US;
+  uint32_t start;
+  uint32_t elapsed;
+
+  if ((samples == 0) || !(onI2C() || onSPI())) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < samples; i++) {
+    pn532_packetbuffer[0] = PN532_COMMAND_GETFIRMWAREVERSION;
+    writecommand(pn532_packetbuffer, 1);
+
+    start = micros();
+    while (!isready()) {
+      if ((uint32_t)(micros() - start) > PN532_CALIBRATION_TIMEOUT_US) {
+        return false;
+      }
+    }
+    elapsed = (uint32_t)(micros() - start);
+    _irqFired = false;
+    if (elapsed < bestAck) {
+      bestAck = elapsed;
+    }
+    if (!readack()) {
+      return false;
+    }
+
+    start = micros();
+    while (!isready()) {
+      if ((uint32_t)(micros() - start) > PN532_CALIBRATION_TIMEOUT_US) {
+        return false;
+      }
+    }
+    elapsed = (uint32_t)(micros() - start);
+    _irqFired = false;
+    if (elapsed < bestResponse) {
+      bestResponse = elapsed;
+    }
+    if (readframe(pn532_packetbuffer, sizeof(pn532_packetbuffer)) == 0) {
+      return false;
+    }
+  }
+
+  setTiming((uint16_t)((bestAck * 3) / 4), (uint16_t)((bestResponse * 3) / 4),
+            (bestAck / 4 > PN532_MIN_POLL_INTERVAL_US)
+                ? (uint16_t)(bestAck / 4)
+                : PN532_MIN_POLL_INTERVAL_US);
+#ifdef PN532DEBUG
+  PN532DEBUGPRINT.print(F("ACK latency (us): "));
+  PN532DEBUGPRINT.println(bestAck);
+  PN532DEBUGPRINT.print(F("Response latency (us): "));
+  PN532DEBUGPRINT.println(bestResponse);
+#endif
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sets the deadlines of the card operations, in milliseconds.
+             Both default to one second; 0 waits forever.
+
+    @param   inListTimeoutMs    Longest wait for a card in
+                                inListPassiveTarget()
+    @param   exchangeTimeoutMs  Longest wait for the answer of each
+                                InDataExchange frame
+*/
+/**************************************************************************/
+void Adafruit_PN532::setTimeouts(uint16_t inListTimeoutMs,
+                                 uint16_t exchangeTimeoutMs) {
+  _inListTimeoutMs = inListTimeoutMs;
+  _exchangeTimeoutMs = exchangeTimeoutMs;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Tells whether the last operation failed on a deadline rather
+             than on an error: a wait for the PN532 ran out, or an inlist
+             found no card within the passive activation retries.
+
+    @return  true after a timeout, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::timedOut(void) { return _timedOut; }
+
+/**************************************************************************/
+/*!
+    @brief   Changes the I2C clock used to talk to the PN532.
+
+    @param   clock  SCL frequency in Hz, the PN532 supports up to 400 kHz
+    @return  true if the clock was set, false on SPI/HSU or when the core
+             cannot change it.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::setI2CClock(uint32_t clock) {
+  if (!onI2C()) {
+    return false;
+  }
+  return i2c_dev->setSpeed(clock);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Changes the SPI clock used to talk to the PN532. Must not be
+             called while the SPI transaction is held (holdSPI()).
+
+    @param   clock  SCK frequency in Hz, the PN532 supports up to
+                    PN532_SPI_MAX_CLOCK
+    @return  true if the clock was set, false on I2C/HSU or for a clock of 0.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::setSPIClock(uint32_t clock) {
+  if (!onSPI()) {
+    return false;
+  }
+  return spi_dev->setSpeed(clock);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Reads back the SPI clock set by the constructor or
+             setSPIClock().
+
+    @return  SCK frequency in Hz, 0 on I2C/HSU.
+*/
+/**************************************************************************/
+uint32_t Adafruit_PN532::getSPIClock(void) {
+  if (!onSPI()) {
+    return 0;
+  }
+  return spi_dev->getSpeed();
+}
+
+/**************************************************************************/
+/*!
+    @brief   Switches the HSU link to a faster baud rate. The PN532 answers
+             at the old rate, then changes once the host confirms with an
+             ACK frame; the host UART follows after a short settle time.
+             A reset() returns the PN532 to 115200 baud.
+
+    @param   baud  One of 9600, 19200, 38400, 57600, 115200, 230400,
+                   460800, 921600 or 1288000
+    @return  true if both sides now run at the new rate, false on SPI/I2C,
+             for an unsupported rate or when the PN532 did not answer.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::setSerialBaudRate(uint32_t baud) {
+  static const uint32_t rates[] = {9600UL,   19200UL,  38400UL,
+                                   57600UL,  115200UL, 230400UL,
+                                   460800UL, 921600UL, 1288000UL};
+  uint8_t br = 0;
+
+  if (!onHSU()) {
     return false;
   }
+  while ((br < (sizeof(rates) / sizeof(rates[0]))) && (rates[br] != baud)) {
+    br++;
+  }
+  if (br == (sizeof(rates) / sizeof(rates[0]))) {
+    return false;
+  }
+
+  pn532_packetbuffer[0] = PN532_COMMAND_SETSERIALBAUDRATE;
+  pn532_packetbuffer[1] = br;
+  if (!sendCommandCheckAck(pn532_packetbuffer, 2)) {
+    return false;
+  }
+
+  // read data packet
+  readdata(pn532_packetbuffer, 9);
+  if (pn532_packetbuffer[6] != (PN532_COMMAND_SETSERIALBAUDRATE + 1)) {
+    return false;
+  }
+
+  // The PN532 switches once it has received the ACK
+  ser_dev->write(pn532ack, sizeof(pn532ack));
+  ser_dev->flush();
+  pauseMicros(PN532_HSU_SWITCH_DELAY_US);
+  ser_dev->begin(baud);
+  _rxHead = 0;
+  _rxTail = 0;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Moves the bytes received by the HSU into the driver ring. It is
+             called while waiting for the PN532; calling it from
+             serialEvent() as well keeps the core's (smaller) UART buffer
+             from overflowing at high baud rates while the sketch is busy.
+*/
+/**************************************************************************/
+void Adafruit_PN532::pumpSerial(void) {
+  if (!onStream()) {
+    return;
+  }
+  while ((onMock() ? mock_dev->available() : ser_dev->available()) > 0) {
+    uint8_t next = (uint8_t)((_rxHead + 1U) % PN532_HSU_RING_SIZE);
+    if (next == _rxTail) {
+      break; // ring full, the rest waits in the core buffer
+    }
+    _rxRing[_rxHead] =
+        (uint8_t)(onMock() ? mock_dev->read() : ser_dev->read());
+    _rxHead = next;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief   Takes n bytes from the HSU ring as they arrive. Unlike
+             Stream::readBytes() the deadline restarts with each byte, so a
+             frame completes as soon as its last byte is in and a link that
+             stalls mid-frame is noticed after PN532_HSU_BYTE_TIMEOUT_MS.
+
+    @param   buff  Destination, bytes not received are zeroed
+    @param   n     Number of bytes to read
+    @return  Number of bytes actually received.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::readSerial(uint8_t *buff, uint8_t n) {
+  uint8_t got = 0;
+  unsigned long last = millis();
+
+  while (got < n) {
+    pumpSerial();
+    if (_rxTail != _rxHead) {
+      buff[got++] = _rxRing[_rxTail];
+      _rxTail = (uint8_t)((_rxTail + 1U) % PN532_HSU_RING_SIZE);
+      last = millis();
+    } else if ((millis() - last) > ((got == 0)
+                                           ? PN532_HSU_FIRST_BYTE_TIMEOUT_MS
+                                           : PN532_HSU_BYTE_TIMEOUT_MS)) {
+      memset(buff + got, 0, n - got);
+      break;
+    }
+  }
+
+  return got;
+}
 
-  return true; // ack'd command
+/**************************************************************************/
+/*!
+    @brief   Sleeps for a number of microseconds, delay() for whole
+             milliseconds so long pauses still let the core run yield().
+
+    @param   us  Pause in microseconds, 0 returns at once
+*/
+/**************************************************************************/
+void Adafruit_PN532::pauseMicros(uint16_t us) {
+  if (us >= 1000) {
+    delay(us / 1000);
+    us %= 1000;
+  }
+  if (us > 0) {
+    delayMicroseconds(us);
+  }
 }
 
 /**************************************************************************/
@@ -488,11 +976,16 @@ uint8_t Adafruit_PN532::readGPIO(void) {
 
 /**************************************************************************/
 /*!
-    @brief   Configures the SAM (Secure Access Module)
+    @brief   Configures the SAM (Secure Access Module). Skipped when the
+             PN532 is known to be configured already.
     @return  true on success, false otherwise.
 */
 /**************************************************************************/
 bool Adafruit_PN532::SAMConfig(void) {
+  if (_samConfigured) {
+    return true;
+  }
+
   pn532_packetbuffer[0] = PN532_COMMAND_SAMCONFIGURATION;
   pn532_packetbuffer[1] = 0x01; // normal mode;
   pn532_packetbuffer[2] = 0x14; // timeout 50ms * 20 = 1 second
@@ -505,7 +998,8 @@ bool Adafruit_PN532::SAMConfig(void) {
   readdata(pn532_packetbuffer, 9);
 
   int offset = 6;
-  return (pn532_packetbuffer[offset] == 0x15);
+  _samConfigured = (pn532_packetbuffer[offset] == 0x15);
+  return _samConfigured;
 }
 
 /**************************************************************************/
@@ -516,9 +1010,14 @@ bool Adafruit_PN532::SAMConfig(void) {
                           after mxRetries
 
     @returns 1 if everything executed properly, 0 for an error
+             (nothing is sent if the PN532 already uses this value)
 */
 /**************************************************************************/
 bool Adafruit_PN532::setPassiveActivationRetries(uint8_t maxRetries) {
+  if (_maxRetries == (int16_t)maxRetries) {
+    return 1;
+  }
+
   pn532_packetbuffer[0] = PN532_COMMAND_RFCONFIGURATION;
   pn532_packetbuffer[1] = 5;    // Config item 5 (MaxRetries)
   pn532_packetbuffer[2] = 0xFF; // MxRtyATR (default = 0xFF)
@@ -534,284 +1033,1412 @@ bool Adafruit_PN532::setPassiveActivationRetries(uint8_t maxRetries) {
   if (!sendCommandCheckAck(pn532_packetbuffer, 5))
     return 0x0; // no ACK
 
+  _maxRetries = maxRetries;
+  _wantedRetries = maxRetries;
   return 1;
 }
 
-/***** ISO14443A Commands ******/
-
 /**************************************************************************/
 /*!
-    @brief   Waits for an ISO14443A target to enter the field and reads
-             its ID.
+    Sets the MxRtyCOM byte of the RFConfiguration register: how many times
+    the PN532 repeats an InDataExchange frame on its own after a timeout or
+    an RF error before reporting the failure
 
-    @param   cardbaudrate  Baud rate of the card
-    @param   uid           Pointer to the array that will be populated
-                           with the card's UID (up to 7 bytes)
-    @param   uidLength     Pointer to the variable that will hold the
-                           length of the card's UID.
-    @param   timeout       Timeout in milliseconds.
+    @param  maxRetries    0x00 (default) to report the first failure,
+                          0xFF to retry forever
 
-    @return  1 if everything executed properly, 0 for an error
+    @returns 1 if everything executed properly, 0 for an error
+             (nothing is sent if the PN532 already uses this value)
 */
 /**************************************************************************/
-bool Adafruit_PN532::readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid,
-                                         uint8_t *uidLength, uint16_t timeout) {
-  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
-  pn532_packetbuffer[1] = 1; // max 1 cards at once (we can set this to 2 later)
-  pn532_packetbuffer[2] = cardbaudrate;
+bool Adafruit_PN532::setCommunicationRetries(uint8_t maxRetries) {
+  if (_comRetries == (int16_t)maxRetries) {
+    return 1;
+  }
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, 3, timeout)) {
-#ifdef PN532DEBUG
+  pn532_packetbuffer[0] = PN532_COMMAND_RFCONFIGURATION;
+  pn532_packetbuffer[1] = 4; // Config item 4 (MaxRtyCOM)
+  pn532_packetbuffer[2] = maxRetries;
+
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.print(F("Setting MxRtyCOM to "));
+  PN532DEBUGPRINT.print(maxRetries, DEC);
+  PN532DEBUGPRINT.println(F(" "));
+#endif
+
+  if (!sendCommandCheckAck(pn532_packetbuffer, 3))
+    return 0x0; // no ACK
+
+  _comRetries = maxRetries;
+  _wantedComRetries = maxRetries;
+  return 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Forgets which configuration the PN532 holds, so the next
+             SAMConfig(), setPassiveActivationRetries() and
+             setCommunicationRetries() are sent again. The requested values
+             are kept for restoreConfig().
+*/
+/**************************************************************************/
+void Adafruit_PN532::invalidateConfig(void) {
+  _samConfigured = false;
+  _maxRetries = -1;
+  _comRetries = -1;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends the SAM and RF configuration again, e.g. after an RF
+             glitch or a brown-out of the PN532, without the reset and
+             wake-up of begin(). Retries are restored only if they were
+             set.
+    @return  true if every setting was accepted, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::restoreConfig(void) {
+  invalidateConfig();
+  bool ok = SAMConfig();
+  if (ok && (_wantedRetries >= 0)) {
+    ok = setPassiveActivationRetries((uint8_t)_wantedRetries);
+  }
+  if (ok && (_wantedComRetries >= 0)) {
+    ok = setCommunicationRetries((uint8_t)_wantedComRetries);
+  }
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Registers a function called between ready polls while waiting
+             for the PN532, so the host can do useful work instead of
+             sleeping. Pass NULL to remove it.
+
+    @param   callback  Function to call, or NULL
+    @param   context   Argument passed to the callback
+*/
+/**************************************************************************/
+void Adafruit_PN532::setIdleCallback(idleCallback_t callback, void *context) {
+  _idleCallback = callback;
+  _idleContext = context;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Uses the PN532 IRQ line instead of status polling to detect
+             that a response is ready. waitready() then returns as soon as
+             the line goes low instead of checking every 10ms over the bus.
+             Only one instance can be served by the interrupt at a time;
+             pins without interrupt support fall back to reading the line.
+
+    @param   irq  IRQ pin, or -1 to use the pin given to the constructor
+
+    @return  true if the IRQ mode is enabled, false if no pin is known
+*/
+/**************************************************************************/
+bool Adafruit_PN532::enableIRQ(int8_t irq) {
+  if (irq != -1) {
+    _irq = irq;
+  }
+  if (_irq == -1) {
+    return false;
+  }
+
+  pinMode(_irq, INPUT_PULLUP);
+  _irqFired = false;
+  int interrupt = digitalPinToInterrupt(_irq);
+#ifdef NOT_AN_INTERRUPT
+  if (interrupt != NOT_AN_INTERRUPT)
+#endif
+  {
+    _irqOwner = this;
+    attachInterrupt(interrupt, irqHandler, FALLING);
+  }
+  _irqEnabled = true;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Returns to status polling over the bus.
+*/
+/**************************************************************************/
+void Adafruit_PN532::disableIRQ(void) {
+  if (_irqOwner == this) {
+    detachInterrupt(digitalPinToInterrupt(_irq));
+    _irqOwner = NULL;
+  }
+  _irqEnabled = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief   IRQ falling edge handler: flags the owning instance as ready.
+*/
+/**************************************************************************/
+void Adafruit_PN532::irqHandler(void) {
+  if (_irqOwner != NULL) {
+    _irqOwner->_irqFired = true;
+#ifdef PN532_RTOS_WAIT
+    TaskHandle_t waiter = _irqOwner->_irqWaiter;
+    if (waiter != NULL) {
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveFromISR(waiter, &woken);
+      portYIELD_FROM_ISR(woken);
+    }
+#endif
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief   Gives the CPU away until the IRQ line may have asserted.
+
+    On FreeRTOS builds the calling task blocks on a notification from
+    irqHandler(), so other tasks run while the card computes its answer.
+    Bare-metal AVR and Cortex-M cores sleep until the next interrupt, which
+    is the IRQ edge or at the latest the millis() tick. Other cores yield().
+    The caller checks isready() again after each return.
+
+    @param   maxMs  Longest block on FreeRTOS, 0 for no limit
+*/
+/**************************************************************************/
+void Adafruit_PN532::waitForIRQ(uint16_t maxMs) {
+#ifdef PN532_RTOS_WAIT
+  TickType_t ticks = portMAX_DELAY;
+  if (maxMs != 0) {
+    ticks = pdMS_TO_TICKS(maxMs);
+    if (ticks == 0) {
+      ticks = 1;
+    }
+  }
+  _irqWaiter = xTaskGetCurrentTaskHandle();
+  // An edge after the owner check below leaves a notification pending
+  if ((_irqOwner == this) && !isready()) {
+    (void)ulTaskNotifyTake(pdTRUE, ticks);
+  } else {
+    yield();
+  }
+  _irqWaiter = NULL;
+#elif defined(__AVR__)
+  (void)maxMs;
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_mode();
+#elif defined(__arm__) && !defined(ARDUINO_ARCH_MBED)
+  (void)maxMs;
+  __asm__ volatile("wfi");
+#else
+  (void)maxMs;
+  yield();
+#endif
+}
+
+/***** ISO14443A Commands ******/
+
+/**************************************************************************/
+/*!
+    @brief   Waits for an ISO14443A target to enter the field and reads
+             its ID.
+
+    @param   cardbaudrate  Baud rate of the card
+    @param   uid           Pointer to the array that will be populated
+                           with the card's UID (up to 7 bytes)
+    @param   uidLength     Pointer to the variable that will hold the
+                           length of the card's UID.
+    @param   timeout       Timeout in milliseconds.
+
+    @return  1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid,
+                                         uint8_t *uidLength, uint16_t timeout) {
+  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
+  pn532_packetbuffer[1] = 1; // max 1 cards at once (we can set this to 2 later)
+  pn532_packetbuffer[2] = cardbaudrate;
+
+  if (!sendCommandCheckAck(pn532_packetbuffer, 3, timeout)) {
+#ifdef PN532DEBUG
     PN532DEBUGPRINT.println(F("No card(s) read"));
 #endif
+    if (_timedOut) {
+      abortCommand(); // the PN532 would keep searching otherwise
+    }
     return 0x0; // no cards read
   }
 
-  return readDetectedPassiveTargetID(uid, uidLength);
+  return readDetectedPassiveTargetID(uid, uidLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Put the reader in detection mode, non blocking so interrupts
+             must be enabled.
+    @param   cardbaudrate  Baud rate of the card
+    @return  1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startPassiveTargetIDDetection(uint8_t cardbaudrate) {
+  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
+  pn532_packetbuffer[1] = 1; // max 1 cards at once (we can set this to 2 later)
+  pn532_packetbuffer[2] = cardbaudrate;
+
+  return sendCommandCheckAck(pn532_packetbuffer, 3);
+}
+
+/**************************************************************************/
+/*!
+    Reads the ID of the passive target the reader has deteceted.
+
+    @param  uid           Pointer to the array that will be populated
+                          with the card's UID (up to 7 bytes)
+    @param  uidLength     Pointer to the variable that will hold the
+                          length of the card's UID.
+
+    @returns 1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readDetectedPassiveTargetID(uint8_t *uid,
+                                                 uint8_t *uidLength) {
+  // read data packet
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_INLISTPASSIVETARGET, &frame) ||
+      (frame.length < 1))
+    return 0;
+
+  /* ISO14443A card response payload should be in the following format:
+
+    byte            Description
+    -------------   ------------------------------------------
+    b0              Tags Found
+    b1              Tag Number (only one used in this example)
+    b2..3           SENS_RES
+    b4              SEL_RES
+    b5              NFCID Length
+    b6..NFCIDLen    NFCID                                      */
+
+  const uint8_t *target = frame.payload;
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.print(F("Found "));
+  PN532DEBUGPRINT.print(target[0], DEC);
+  PN532DEBUGPRINT.println(F(" tags"));
+#endif
+  if ((target[0] != 1) || (frame.length < 6) ||
+      (frame.length < 6 + target[5]))
+    return 0;
+
+  uint16_t sens_res = target[2];
+  sens_res <<= 8;
+  sens_res |= target[3];
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.print(F("ATQA: 0x"));
+  PN532DEBUGPRINT.println(sens_res, HEX);
+  PN532DEBUGPRINT.print(F("SAK: 0x"));
+  PN532DEBUGPRINT.println(target[4], HEX);
+#endif
+
+  /* Card appears to be Mifare Classic */
+  *uidLength = target[5];
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.print(F("UID:"));
+#endif
+  for (uint8_t i = 0; i < target[5]; i++) {
+    uid[i] = target[6 + i];
+#ifdef MIFAREDEBUG
+    PN532DEBUGPRINT.print(F(" 0x"));
+    PN532DEBUGPRINT.print(uid[i], HEX);
+#endif
+  }
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.println();
+#endif
+
+  return 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges an APDU with the currently inlisted peer
+
+    @param   send            Pointer to data to send
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchange(uint8_t *send, uint8_t sendLength,
+                                    uint8_t *response,
+                                    uint8_t *responseLength) {
+  if (sendLength > PN532_PACKBUFFSIZ - 2) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
+#endif
+    return false;
+  }
+  uint8_t i;
+
+  _exchangeError = PN532_EXCHANGE_LINK;
+  pn532_packetbuffer[0] = 0x40; // PN532_COMMAND_INDATAEXCHANGE;
+  pn532_packetbuffer[1] = _inListedTag;
+  for (i = 0; i < sendLength; ++i) {
+    pn532_packetbuffer[i + 2] = send[i];
+  }
+
+  if (!sendCommandCheckAck(pn532_packetbuffer, sendLength + 2,
+                           _exchangeTimeoutMs)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Could not send APDU"));
+#endif
+    return false;
+  }
+
+  if (!waitready(_exchangeTimeoutMs)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+#endif
+    return false;
+  }
+
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_INDATAEXCHANGE, &frame) ||
+      (frame.length < 1)) {
+    return false;
+  }
+
+  if ((frame.payload[0] & 0x3f) != 0) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Status code indicates an error"));
+#endif
+    return false;
+  }
+
+  uint8_t length = frame.length - 1;
+  if (length > *responseLength) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Response buffer too small"));
+#endif
+    _exchangeError = PN532_EXCHANGE_OVERFLOW;
+    return false;
+  }
+
+  for (i = 0; i < length; ++i) {
+    response[i] = frame.payload[1 + i];
+  }
+  *responseLength = length;
+
+  _exchangeError = PN532_EXCHANGE_OK;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges data of any length with the currently inlisted peer.
+
+             Commands longer than one frame are sent as a chain of
+             InDataExchange frames with the MI bit set in the target byte,
+             and responses flagged with MI are collected by sending empty
+             InDataExchange frames until the card is done. Lengths are not
+             limited by the packet buffer, only by the caller's buffer.
+             Over I2C each chained frame is sized to fit the Wire buffer,
+             see dataExchangeChunk().
+
+    @param   send            Pointer to data to send
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Input: size of response; Output: bytes received
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchangeChained(const uint8_t *send,
+                                           size_t sendLength,
+                                           uint8_t *response,
+                                           size_t *responseLength) {
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  uint8_t maxChunk = dataExchangeChunk();
+
+  // Outgoing chain: only the last frame comes back with the card's answer
+  do {
+    uint8_t chunk =
+        (sendLength > maxChunk) ? maxChunk : (uint8_t)sendLength;
+    uint8_t tg = _inListedTag;
+    if (sendLength > chunk) {
+      tg |= PN532_DATAEXCHANGE_MI;
+    }
+    if (!exchangeDataFrame(tg, send, chunk, &status, &length)) {
+      _expectSW = false;
+      return false;
+    }
+    send += chunk;
+    sendLength -= chunk;
+  } while (sendLength > 0);
+
+  return readChainedResponse(status, length, response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Largest InDataExchange data chunk for the current bus. Over I2C
+             the whole frame must fit the Wire buffer (32 bytes on AVR) to
+             go out in one transmission, so chained frames are shortened
+             accordingly; SPI and HSU use the full packet buffer.
+
+    @return  Number of data bytes per chained InDataExchange frame.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::dataExchangeChunk(void) {
+  uint8_t chunk = PN532_DATAEXCHANGE_CHUNK;
+
+  if (onI2C()) {
+    size_t room = i2c_dev->maxBufferSize();
+    // Below the minimum, large frames go through the chunked I2C write
+    if ((room >= (PN532_I2C_FRAME_OVERHEAD + PN532_I2C_MIN_CHUNK)) &&
+        ((room - PN532_I2C_FRAME_OVERHEAD) < chunk)) {
+      chunk = (uint8_t)(room - PN532_I2C_FRAME_OVERHEAD);
+    }
+  }
+
+  return chunk;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Gives access to the transmit buffer so a caller can build the
+             InDataExchange data in place, without an intermediate copy.
+             The buffer holds PN532_FRAME_DATA_MAX bytes and stays valid
+             until the next command is sent to the PN532.
+
+    @return  Pointer to the data area of the next InDataExchange frame.
+*/
+/**************************************************************************/
+uint8_t *Adafruit_PN532::beginFrame(void) {
+  return pn532_packetbuffer + PN532_DATAEXCHANGE_DATA_OFFSET;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends the data built in the beginFrame() buffer to the
+             inlisted peer and collects its (possibly chained) response.
+
+    @param   len             Number of data bytes written after beginFrame()
+    @param   response        Pointer to response data
+    @param   responseLength  Input: size of response; Output: bytes received
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::commitFrame(uint8_t len, uint8_t *response,
+                                 size_t *responseLength) {
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  if (len > PN532_FRAME_DATA_MAX) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
+#endif
+    _expectSW = false;
+    return false;
+  }
+
+  // A frame too large for the Wire buffer is chained from the buffer itself:
+  // intermediate answers are shorter than one chunk, so they only overwrite
+  // data that was already sent.
+  if (len > dataExchangeChunk()) {
+    return inDataExchangeChained(beginFrame(), len, response, responseLength);
+  }
+
+  if (!exchangeDataFrame(_inListedTag, beginFrame(), len, &status, &length)) {
+    _expectSW = false;
+    return false;
+  }
+
+  return readChainedResponse(status, length, response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Copies the response left in the packet buffer by
+             exchangeDataFrame() and fetches the following frames while the
+             peer sets the MI bit.
+
+    @param   status          Status byte of the first response frame
+    @param   length          Payload length of the first response frame
+    @param   response        Pointer to response data
+    @param   responseLength  Input: size of response; Output: bytes received
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readChainedResponse(uint8_t status, uint8_t length,
+                                         uint8_t *response,
+                                         size_t *responseLength) {
+  size_t capacity = *responseLength;
+  size_t received = 0;
+
+  while (true) {
+    const uint8_t *payload = pn532_packetbuffer + 8;
+    bool last = ((status & PN532_DATAEXCHANGE_MI) == 0);
+
+    // The status word ends the last frame: check it before copying anything
+    if (last && _expectSW && (length >= 2) &&
+        (payload[length - 2] != PN532_SW1_MORE_DATA)) {
+      _expectSW = false;
+      if ((((uint16_t)payload[length - 2] << 8) | payload[length - 1]) !=
+          _expectedSW) {
+#ifdef PN532DEBUG
+        PN532DEBUGPRINT.println(F("Unexpected status word"));
+#endif
+        // Only the status word is handed back
+        if (capacity >= 2) {
+          memcpy(response, payload + length - 2, 2);
+          *responseLength = 2;
+        }
+        _exchangeError = PN532_EXCHANGE_STATUS;
+        return false;
+      }
+    }
+
+    if (length > (capacity - received)) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("Response buffer too small"));
+#endif
+      _expectSW = false;
+      _exchangeError = PN532_EXCHANGE_OVERFLOW;
+      return false;
+    }
+    memcpy(response + received, payload, length);
+    received += length;
+
+    if (last) {
+      break;
+    }
+    if (!exchangeDataFrame(_inListedTag, NULL, 0, &status, &length)) {
+      _expectSW = false;
+      return false;
+    }
+  }
+
+  *responseLength = received;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends one InDataExchange frame and checks its response. The
+             response payload is left in the packet buffer at offset 8.
+
+    @param   tg             Target byte, optionally with the MI bit
+    @param   data           Pointer to data to send, may be NULL if len is 0
+                            or the beginFrame() buffer
+    @param   len            Length of the data to send
+    @param   status         Pointer to the returned status byte
+    @param   payloadLength  Pointer to the returned payload length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::exchangeDataFrame(uint8_t tg, const uint8_t *data,
+                                       uint8_t len, uint8_t *status,
+                                       uint8_t *payloadLength) {
+  // the response read joins the transaction of the command
+  bool held = holdSPI();
+  bool ok = sendDataFrame(tg, data, len);
+
+  if (ok) {
+    // I2C TUNING
+    if (onI2C() || onSPI()) // SPI and I2C need a pause for page reads
+      pauseMicros(_responseDelayUs);
+    ok = waitready(_exchangeTimeoutMs);
+#ifdef PN532DEBUG
+    if (!ok) {
+      PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+    }
+#endif
+  }
+
+  if (ok) {
+    ok = readDataFrame(status, payloadLength);
+  }
+  if (held) {
+    spi_dev->releaseTransaction();
+  }
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends one InDataExchange frame and waits for its ACK only.
+
+    @param   tg    Target byte, optionally with the MI bit
+    @param   data  Pointer to data to send, may be NULL if len is 0 or the
+                   beginFrame() buffer
+    @param   len   Length of the data to send
+    @return  true if the PN532 acknowledged the frame, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::sendDataFrame(uint8_t tg, const uint8_t *data,
+                                   uint8_t len) {
+  uint8_t *frame = beginFrame();
+
+  _lastStatus = 0;
+  // Every failure until the response is checked is on the link
+  _exchangeError = PN532_EXCHANGE_LINK;
+  pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+  pn532_packetbuffer[1] = tg;
+  // Data built in place with beginFrame() is already where it belongs
+  if ((len > 0) && (data != frame)) {
+    memmove(frame, data, len);
+  }
+
+  if (!sendCommand(pn532_packetbuffer, len + PN532_DATAEXCHANGE_DATA_OFFSET,
+                   _exchangeTimeoutMs)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Could not send APDU"));
+#endif
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Reads the InDataExchange response the PN532 reported ready and
+             checks its status. The payload is left in the packet buffer at
+             offset 8.
+
+    @param   status         Pointer to the returned status byte
+    @param   payloadLength  Pointer to the returned payload length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readDataFrame(uint8_t *status, uint8_t *payloadLength) {
+  PN532Frame reply;
+  if (!readResponse(PN532_COMMAND_INDATAEXCHANGE, &reply) ||
+      (reply.length < 1)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unexpected InDataExchange response"));
+#endif
+    return false;
+  }
+
+  *status = reply.payload[0];
+  _lastStatus = *status & 0x3f;
+  if (_lastStatus != 0) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Status code indicates an error"));
+#endif
+    return false;
+  }
+
+  *payloadLength = reply.length - 1;
+  _exchangeError = PN532_EXCHANGE_OK;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Starts a data exchange with the inlisted peer and returns once
+             the PN532 has acknowledged it, without waiting for the card's
+             answer. The host is free while the card computes; poll
+             isExchangeComplete() (cheap with the IRQ line enabled) and
+             collect the response with finishDataExchange(). Only the last
+             frame of a chained command is left pending. No other command
+             may be sent to the PN532 in between.
+
+    @param   send        Pointer to data to send, may be the beginFrame()
+                         buffer
+    @param   sendLength  Length of the data, at most PN532_FRAME_DATA_MAX
+    @return  true if the exchange is pending, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::beginDataExchange(const uint8_t *send,
+                                       uint8_t sendLength) {
+  _exchangePending = false;
+  if (!sendLeadingFrames(&send, &sendLength) ||
+      !sendDataFrame(_inListedTag, send, sendLength)) {
+    _expectSW = false;
+    return false;
+  }
+
+  // I2C TUNING: the status polls of isExchangeComplete() may follow at once
+  if (onI2C() || onSPI())
+    pauseMicros(_responseDelayUs);
+
+  _exchangePending = true;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges all but the last frame of a command longer than one
+             InDataExchange chunk. The leading frames only get an empty
+             answer; from the beginFrame() buffer, each answer overwrites
+             data already sent.
+
+    @param   send        In: data to send; Out: data of the last frame
+    @param   sendLength  In: length of the data, at most
+                         PN532_FRAME_DATA_MAX; Out: length of the last frame
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::sendLeadingFrames(const uint8_t **send,
+                                       uint8_t *sendLength) {
+  uint8_t maxChunk = dataExchangeChunk();
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  if (*sendLength > PN532_FRAME_DATA_MAX) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
+#endif
+    _expectSW = false;
+    return false;
+  }
+
+  while (*sendLength > maxChunk) {
+    if (!exchangeDataFrame(_inListedTag | PN532_DATAEXCHANGE_MI, *send,
+                           maxChunk, &status, &length)) {
+      _expectSW = false;
+      return false;
+    }
+    *send += maxChunk;
+    *sendLength -= maxChunk;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Checks without waiting whether the card's answer to
+             beginDataExchange() has arrived.
+    @return  true if finishDataExchange() will not wait for the card.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::isExchangeComplete(void) {
+  return (!_exchangePending || isready());
+}
+
+/**************************************************************************/
+/*!
+    @brief   Waits for the answer to beginDataExchange(), bounded by the
+             exchange timeout, and collects it like commitFrame(): chained
+             response frames are fetched and expectStatusWord() applies.
+
+    @param   response        Pointer to response data
+    @param   responseLength  Input: size of response; Output: bytes received
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::finishDataExchange(uint8_t *response,
+                                        size_t *responseLength) {
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  if (!_exchangePending) {
+    _expectSW = false;
+    return false;
+  }
+  _exchangePending = false;
+
+  if (!waitready(_exchangeTimeoutMs)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+#endif
+    // The PN532 still waits for the card: free it for the next command
+    abortCommand();
+    _expectSW = false;
+    return false;
+  }
+
+  if (!readDataFrame(&status, &length)) {
+    _expectSW = false;
+    return false;
+  }
+
+  return readChainedResponse(status, length, response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Like finishDataExchange(), but hands back a view of the answer
+             where it landed in the packet buffer instead of a copy.
+
+    @param   response        Set to the answer, valid until the next command
+    @param   responseLength  Set to the length of the answer
+    @return  true on success, false otherwise (see viewResponse()).
+*/
+/**************************************************************************/
+bool Adafruit_PN532::finishDataExchangeView(const uint8_t **response,
+                                            uint8_t *responseLength) {
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  if (!_exchangePending) {
+    _expectSW = false;
+    return false;
+  }
+  _exchangePending = false;
+
+  if (!waitready(_exchangeTimeoutMs)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+#endif
+    abortCommand();
+    _expectSW = false;
+    return false;
+  }
+
+  if (!readDataFrame(&status, &length)) {
+    _expectSW = false;
+    return false;
+  }
+
+  return viewResponse(status, length, response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends the data built in the beginFrame() buffer like
+             commitFrame(), but hands back a view of the answer where it
+             landed in the packet buffer: no copy is made, and the data
+             stays valid until the next command is sent to the PN532.
+
+    @param   len             Number of data bytes written after beginFrame()
+    @param   response        Set to the answer
+    @param   responseLength  Set to the length of the answer
+    @return  true on success, false otherwise (see viewResponse()).
+*/
+/**************************************************************************/
+bool Adafruit_PN532::commitFrameView(uint8_t len, const uint8_t **response,
+                                     uint8_t *responseLength) {
+  const uint8_t *send = beginFrame();
+  uint8_t status = 0;
+  uint8_t length = 0;
+
+  if (!sendLeadingFrames(&send, &len) ||
+      !exchangeDataFrame(_inListedTag, send, len, &status, &length)) {
+    _expectSW = false;
+    return false;
+  }
+
+  return viewResponse(status, length, response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Points at the answer left in the packet buffer by
+             exchangeDataFrame() or readDataFrame(). An answer chained over
+             several frames (MI bit) does not fit one view: it fails with
+             PN532_EXCHANGE_OVERFLOW and the rest is not fetched. A status
+             word other than the expectStatusWord() one fails with
+             PN532_EXCHANGE_STATUS and the view covers SW1 SW2 only.
+
+    @param   status          Status byte of the response frame
+    @param   length          Payload length of the response frame
+    @param   response        Set to the payload
+    @param   responseLength  Set to the payload length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::viewResponse(uint8_t status, uint8_t length,
+                                  const uint8_t **response,
+                                  uint8_t *responseLength) {
+  const uint8_t *payload = pn532_packetbuffer + 8;
+  bool expectSW = _expectSW;
+
+  _expectSW = false;
+  if ((status & PN532_DATAEXCHANGE_MI) != 0) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Chained response, no view possible"));
+#endif
+    _exchangeError = PN532_EXCHANGE_OVERFLOW;
+    return false;
+  }
+
+  *response = payload;
+  *responseLength = length;
+  if (expectSW && (length >= 2) &&
+      (payload[length - 2] != PN532_SW1_MORE_DATA) &&
+      ((((uint16_t)payload[length - 2] << 8) | payload[length - 1]) !=
+       _expectedSW)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unexpected status word"));
+#endif
+    *response = payload + length - 2;
+    *responseLength = 2;
+    _exchangeError = PN532_EXCHANGE_STATUS;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   'InLists' a passive target. PN532 acting as reader/initiator,
+             peer acting as card/responder.
+    @param   maxTargets  Number of targets to inlist, 1 or 2. With 2 the
+                         PN532 also activates a second card stacked on the
+                         antenna; use selectInListedTarget() to address it.
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inListPassiveTarget(uint8_t maxTargets) {
+  if (!startInListPassiveTarget(maxTargets)) {
+    return false;
+  }
+
+  // I2C TUNING
+  if (onI2C() || onSPI())
+    pauseMicros(_responseDelayUs);
+
+  // Bounded wait for a card; the still searching PN532 is then stopped so
+  // it takes the next command
+  if (!waitready(_inListTimeoutMs)) {
+    abortCommand();
+    return false;
+  }
+
+  return readInListedPassiveTarget();
+}
+
+/**************************************************************************/
+/*!
+    @brief   Starts inlisting a passive target without waiting for a card.
+             Poll isready() and call readInListedPassiveTarget() once the
+             PN532 has a response.
+    @param   maxTargets  Number of targets to inlist, 1 or 2
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startInListPassiveTarget(uint8_t maxTargets) {
+  _inListedCount = 0;
+  _inListedIndex = 0;
+  if ((maxTargets == 0) || (maxTargets > PN532_MAX_INLISTED)) {
+    return false;
+  }
+  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
+  pn532_packetbuffer[1] = maxTargets;
+  pn532_packetbuffer[2] = 0;
+
+#ifdef PN532DEBUG
+  PN532DEBUGPRINT.print(F("About to inList passive target"));
+#endif
+
+  if (!sendCommand(pn532_packetbuffer, 3, 1000)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Could not send inlist message"));
+#endif
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Reads and checks the response of an inlist command started with
+             startInListPassiveTarget(). The first target becomes the one
+             addressed by the data exchange functions.
+    @return  true if one or two targets were inlisted, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readInListedPassiveTarget() {
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_INLISTPASSIVETARGET, &frame) ||
+      (frame.length < 1)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.print(F("Unexpected response to inlist passive host"));
+#endif
+    return false;
+  }
+
+  uint8_t count = frame.payload[0];
+  // No target within MxRtyPassiveActivation retries is a timeout too
+  _timedOut = (count == 0);
+  if ((count == 0) || (count > PN532_MAX_INLISTED)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unhandled number of targets inlisted"));
+#endif
+    PN532DEBUGPRINT.println(F("Number of tags inlisted:"));
+    PN532DEBUGPRINT.println(count);
+    return false;
+  }
+
+  // Per target: Tg, SENS_RES (2), SEL_RES, NFCID length, NFCID and,
+  // for ISO-DEP targets (SEL_RES bit 5), the ATS starting with TL
+  uint8_t pos = 8;
+  uint8_t end = (frame.payload - pn532_packetbuffer) + frame.length;
+  for (uint8_t i = 0; i < count; i++) {
+    pos = storeTypeATarget(i, pos, end);
+    if (pos == 0) {
+      return false;
+    }
+  }
+
+  _inListedCount = count;
+  _inListedIndex = 0;
+  _inListedTag = _inListedTags[0];
+  PN532DEBUGPRINT.print(F("Tag number: "));
+  PN532DEBUGPRINT.println(_inListedTag);
+
+  return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief   Put the reader in detection mode, non blocking so interrupts
-             must be enabled.
-    @param   cardbaudrate  Baud rate of the card
-    @return  1 if everything executed properly, 0 for an error
+    @brief   Records one ISO14443A target from a response in the packet
+             buffer: Tg, SENS_RES (2), SEL_RES, NFCID length, NFCID and, for
+             ISO-DEP targets (SEL_RES bit 5), the ATS starting with TL. The
+             bit rates announced in TA(1) are kept for inPSL().
+    @param   slot  Inlisted target slot to fill
+    @param   pos   Offset of the Tg byte in the packet buffer
+    @param   end   Offset just past the frame data
+    @return  Offset of the next target, 0 if the data is truncated.
 */
 /**************************************************************************/
-bool Adafruit_PN532::startPassiveTargetIDDetection(uint8_t cardbaudrate) {
-  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
-  pn532_packetbuffer[1] = 1; // max 1 cards at once (we can set this to 2 later)
-  pn532_packetbuffer[2] = cardbaudrate;
-
-  return sendCommandCheckAck(pn532_packetbuffer, 3);
+uint8_t Adafruit_PN532::storeTypeATarget(uint8_t slot, uint8_t pos,
+                                         uint8_t end) {
+  if ((pos + 5) > end) {
+    return 0;
+  }
+  uint8_t selRes = pn532_packetbuffer[pos + 3];
+  uint8_t uidLen = pn532_packetbuffer[pos + 4];
+  if ((pos + 5 + uidLen) > end) {
+    return 0;
+  }
+  _inListedTags[slot] = pn532_packetbuffer[pos];
+  _inListedUidLen[slot] = (uidLen > sizeof(_inListedUid[slot]))
+                              ? sizeof(_inListedUid[slot])
+                              : uidLen;
+  memcpy(_inListedUid[slot], pn532_packetbuffer + pos + 5,
+         _inListedUidLen[slot]);
+  pos += 5 + uidLen;
+  _inListedTA1[slot] = 0;
+  if (((selRes & 0x20) != 0) && (pos < end)) {
+    uint8_t atsLen = pn532_packetbuffer[pos];
+    // ATS: TL, T0 (bit 4 announces TA(1)), TA(1) with the supported rates
+    if ((atsLen >= 3) && ((pos + 2) < end) &&
+        ((pn532_packetbuffer[pos + 1] & 0x10) != 0)) {
+      _inListedTA1[slot] = pn532_packetbuffer[pos + 2];
+    }
+    pos = (atsLen > (end - pos)) ? end : (uint8_t)(pos + atsLen);
+  }
+  return pos;
 }
 
 /**************************************************************************/
 /*!
-    Reads the ID of the passive target the reader has deteceted.
-
-    @param  uid           Pointer to the array that will be populated
-                          with the card's UID (up to 7 bytes)
-    @param  uidLength     Pointer to the variable that will hold the
-                          length of the card's UID.
-
-    @returns 1 if everything executed properly, 0 for an error
+    @brief   Starts InAutoPoll: the PN532 looks for the given target types
+             on its own, once per period, and answers (raising IRQ) only
+             when one shows up. Poll isready() or wait for IRQ, then call
+             readInAutoPoll().
+    @param   pollNr     Number of polling rounds, PN532_AUTOPOLL_ENDLESS to
+                        poll until a target is found
+    @param   period     Pause between rounds in units of 150 ms (1 to 15)
+    @param   types      Target types to look for, e.g.
+                        PN532_AUTOPOLL_TYPE_ISO14443_4A
+    @param   typeCount  Number of entries in types (1 to 15)
+    @return  true if the command was acknowledged, false otherwise.
 */
 /**************************************************************************/
-bool Adafruit_PN532::readDetectedPassiveTargetID(uint8_t *uid,
-                                                 uint8_t *uidLength) {
-  // read data packet
-  readdata(pn532_packetbuffer, 20);
-  // check some basic stuff
-
-  /* ISO14443A card response should be in the following format:
-
-    byte            Description
-    -------------   ------------------------------------------
-    b0..6           Frame header and preamble
-    b7              Tags Found
-    b8              Tag Number (only one used in this example)
-    b9..10          SENS_RES
-    b11             SEL_RES
-    b12             NFCID Length
-    b13..NFCIDLen   NFCID                                      */
+bool Adafruit_PN532::startInAutoPoll(uint8_t pollNr, uint8_t period,
+                                     const uint8_t *types, uint8_t typeCount) {
+  _inListedCount = 0;
+  _inListedIndex = 0;
+  if ((typeCount == 0) || (typeCount > PN532_AUTOPOLL_MAX_TYPES) ||
+      (period == 0) || (period > PN532_AUTOPOLL_MAX_PERIOD)) {
+    return false;
+  }
 
-#ifdef MIFAREDEBUG
-  PN532DEBUGPRINT.print(F("Found "));
-  PN532DEBUGPRINT.print(pn532_packetbuffer[7], DEC);
-  PN532DEBUGPRINT.println(F(" tags"));
-#endif
-  if (pn532_packetbuffer[7] != 1)
-    return 0;
+  pn532_packetbuffer[0] = PN532_COMMAND_INAUTOPOLL;
+  pn532_packetbuffer[1] = pollNr;
+  pn532_packetbuffer[2] = period;
+  memcpy(pn532_packetbuffer + 3, types, typeCount);
 
-  uint16_t sens_res = pn532_packetbuffer[9];
-  sens_res <<= 8;
-  sens_res |= pn532_packetbuffer[10];
-#ifdef MIFAREDEBUG
-  PN532DEBUGPRINT.print(F("ATQA: 0x"));
-  PN532DEBUGPRINT.println(sens_res, HEX);
-  PN532DEBUGPRINT.print(F("SAK: 0x"));
-  PN532DEBUGPRINT.println(pn532_packetbuffer[11], HEX);
-#endif
+  return sendCommand(pn532_packetbuffer, 3 + typeCount, 1000);
+}
 
-  /* Card appears to be Mifare Classic */
-  *uidLength = pn532_packetbuffer[12];
-#ifdef MIFAREDEBUG
-  PN532DEBUGPRINT.print(F("UID:"));
-#endif
-  for (uint8_t i = 0; i < pn532_packetbuffer[12]; i++) {
-    uid[i] = pn532_packetbuffer[13 + i];
-#ifdef MIFAREDEBUG
-    PN532DEBUGPRINT.print(F(" 0x"));
-    PN532DEBUGPRINT.print(uid[i], HEX);
+/**************************************************************************/
+/*!
+    @brief   Reads the result of startInAutoPoll(). An ISO14443A target is
+             recorded as the inlisted target, so getInListedUID() and the
+             data exchange functions work on it as after an inlist.
+    @param   type  Pointer to the variable that receives the type of the
+                   target found
+    @return  true if a target was found, false on timeout or error.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readInAutoPoll(uint8_t *type) {
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_INAUTOPOLL, &frame) || (frame.length < 1)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unexpected response to InAutoPoll"));
 #endif
+    return false;
+  }
+  if ((frame.payload[0] == 0) || (frame.length < 3)) {
+    return false; // every round came back empty
   }
-#ifdef MIFAREDEBUG
-  PN532DEBUGPRINT.println();
-#endif
 
-  return 1;
+  // NbTg, then Type, AutoPollTargetData length and the target data
+  *type = frame.payload[1];
+  uint8_t end = (frame.payload - pn532_packetbuffer) + frame.length;
+  uint16_t dataEnd = 10 + frame.payload[2];
+  if (dataEnd > end) {
+    return false;
+  }
+  if ((*type == PN532_AUTOPOLL_TYPE_GENERIC_106A) ||
+      (*type == PN532_AUTOPOLL_TYPE_MIFARE) ||
+      (*type == PN532_AUTOPOLL_TYPE_ISO14443_4A)) {
+    if (storeTypeATarget(0, 10, (uint8_t)dataEnd) == 0) {
+      return false;
+    }
+    _inListedCount = 1;
+    _inListedTag = _inListedTags[0];
+  }
+  return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief   Exchanges an APDU with the currently inlisted peer
-
-    @param   send            Pointer to data to send
-    @param   sendLength      Length of the data to send
-    @param   response        Pointer to response data
-    @param   responseLength  Pointer to the response data length
-    @return  true on success, false otherwise.
+    @brief   Aborts the command the PN532 is working on, e.g. an InAutoPoll
+             or InListPassiveTarget still waiting for a card, by sending it
+             an ACK frame. The PN532 is ready for a new command afterwards.
 */
 /**************************************************************************/
-bool Adafruit_PN532::inDataExchange(uint8_t *send, uint8_t sendLength,
-                                    uint8_t *response,
-                                    uint8_t *responseLength) {
-  if (sendLength > PN532_PACKBUFFSIZ - 2) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
-#endif
-    return false;
+void Adafruit_PN532::abortCommand(void) {
+  _irqFired = false;
+  if (onSPI()) {
+    uint8_t cmd = PN532_SPI_DATAWRITE;
+    spi_dev->write(pn532ack, sizeof(pn532ack), &cmd, 1);
+  } else if (onI2C()) {
+    i2c_dev->write(pn532ack, sizeof(pn532ack));
+  } else if (onHSU()) {
+    ser_dev->write(pn532ack, sizeof(pn532ack));
+  } else if (onMock()) {
+    mock_dev->write(pn532ack, sizeof(pn532ack));
   }
-  uint8_t i;
+}
 
-  pn532_packetbuffer[0] = 0x40; // PN532_COMMAND_INDATAEXCHANGE;
+/**************************************************************************/
+/*!
+    @brief   Changes the RF bit rates of the addressed ISO-DEP target (PPS)
+             or DEP target (PSL). Both sides switch once the PN532 answers;
+             on failure they stay at the previous rates.
+    @param   brit  Initiator to target rate, PN532_BITRATE_106 to _848
+    @param   brti  Target to initiator rate, PN532_BITRATE_106 to _848
+    @return  true if the target accepted the new rates, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inPSL(uint8_t brit, uint8_t brti) {
+  pn532_packetbuffer[0] = PN532_COMMAND_INPSL;
   pn532_packetbuffer[1] = _inListedTag;
-  for (i = 0; i < sendLength; ++i) {
-    pn532_packetbuffer[i + 2] = send[i];
-  }
+  pn532_packetbuffer[2] = brit;
+  pn532_packetbuffer[3] = brti;
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, sendLength + 2, 1000)) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Could not send APDU"));
-#endif
+  if (!sendCommandCheckAck(pn532_packetbuffer, 4)) {
     return false;
   }
 
-  if (!waitready(1000)) {
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_INPSL, &frame) || (frame.length < 1)) {
 #ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+    PN532DEBUGPRINT.println(F("Unexpected InPSL response"));
 #endif
     return false;
   }
 
-  readdata(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  _lastStatus = frame.payload[0] & 0x3f;
+  return (_lastStatus == 0);
+}
 
-  if (pn532_packetbuffer[0] == 0 && pn532_packetbuffer[1] == 0 &&
-      pn532_packetbuffer[2] == 0xff) {
-    uint8_t length = pn532_packetbuffer[3];
-    if (pn532_packetbuffer[4] != (uint8_t)(~length + 1)) {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.println(F("Length check invalid"));
-      PN532DEBUGPRINT.println(length, HEX);
-      PN532DEBUGPRINT.println((~length) + 1, HEX);
-#endif
-      return false;
-    }
-    if (pn532_packetbuffer[5] == PN532_PN532TOHOST &&
-        pn532_packetbuffer[6] == PN532_RESPONSE_INDATAEXCHANGE) {
-      if ((pn532_packetbuffer[7] & 0x3f) != 0) {
+/**************************************************************************/
+/*!
+    @brief   Checks that the addressed ISO-DEP target is still in the field
+             with Diagnose test 6 (card presence detection). The PN532 sends
+             a single R(NAK) or empty I-block, far cheaper than a new
+             InListPassiveTarget, and the target stays activated.
+    @return  true if the target answered, false if it is gone or on error.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inPresenceCheck(void) {
+  pn532_packetbuffer[0] = PN532_COMMAND_DIAGNOSE;
+  pn532_packetbuffer[1] = PN532_DIAGNOSE_PRESENCE;
+
+  if (!sendCommandCheckAck(pn532_packetbuffer, 2)) {
+    return false;
+  }
+
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_DIAGNOSE, &frame) || (frame.length < 1)) {
 #ifdef PN532DEBUG
-        PN532DEBUGPRINT.println(F("Status code indicates an error"));
+    PN532DEBUGPRINT.println(F("Unexpected Diagnose response"));
 #endif
-        return false;
-      }
+    return false;
+  }
 
-      length -= 3;
+  _lastStatus = frame.payload[0] & 0x3f;
+  return (_lastStatus == 0);
+}
 
-      if (length > *responseLength) {
-        return false;
-      }
+/**************************************************************************/
+/*!
+    @brief   Checks the host bus with Diagnose test 0 (communication line
+             test): the PN532 must echo a byte pattern unchanged.
+    @return  true if the echo matched, false on a bus or framing error.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::diagnoseLine(void) {
+  static const uint8_t pattern[] = {0x00, 0xFF, 0x55, 0xAA, 0x0F, 0xF0};
 
-      for (i = 0; i < length; ++i) {
-        response[i] = pn532_packetbuffer[8 + i];
-      }
-      *responseLength = length;
+  pn532_packetbuffer[0] = PN532_COMMAND_DIAGNOSE;
+  pn532_packetbuffer[1] = PN532_DIAGNOSE_LINE;
+  memcpy(pn532_packetbuffer + 2, pattern, sizeof(pattern));
 
-      return true;
-    } else {
-      PN532DEBUGPRINT.print(F("Don't know how to handle this command: "));
-      PN532DEBUGPRINT.println(pn532_packetbuffer[6], HEX);
-      return false;
-    }
-  } else {
-    PN532DEBUGPRINT.println(F("Preamble missing"));
+  if (!sendCommandCheckAck(pn532_packetbuffer, 2 + sizeof(pattern))) {
     return false;
   }
+
+  // The answer ends with the pattern, after the test number
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_DIAGNOSE, &frame) ||
+      (frame.length < sizeof(pattern))) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unexpected Diagnose response"));
+#endif
+    return false;
+  }
+
+  return (memcmp(frame.payload + frame.length - sizeof(pattern), pattern,
+                 sizeof(pattern)) == 0);
 }
 
 /**************************************************************************/
 /*!
-    @brief   'InLists' a passive target. PN532 acting as reader/initiator,
-             peer acting as card/responder.
-    @return  true on success, false otherwise.
+    @brief   Checks the antenna with Diagnose test 7 (antenna self test):
+             the PN532 measures the antenna driver current against the
+             thresholds of its antenna detector.
+    @param   detector  Antenna detector configuration (thresholds and
+                       enable bits of ANDET_CONTROL, see the PN532 user
+                       manual), specific to the antenna
+    @return  true if the antenna is within the thresholds, false if it is
+             open or shorted (status in getLastStatus()) or on error.
 */
 /**************************************************************************/
-bool Adafruit_PN532::inListPassiveTarget() {
-  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
-  pn532_packetbuffer[1] = 1;
-  pn532_packetbuffer[2] = 0;
+bool Adafruit_PN532::diagnoseAntenna(uint8_t detector) {
+  pn532_packetbuffer[0] = PN532_COMMAND_DIAGNOSE;
+  pn532_packetbuffer[1] = PN532_DIAGNOSE_ANTENNA;
+  pn532_packetbuffer[2] = detector;
 
-#ifdef PN532DEBUG
-  PN532DEBUGPRINT.print(F("About to inList passive target"));
-#endif
+  if (!sendCommandCheckAck(pn532_packetbuffer, 3)) {
+    return false;
+  }
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, 3, 1000)) {
+  PN532Frame frame;
+  if (!readResponse(PN532_COMMAND_DIAGNOSE, &frame) || (frame.length < 1)) {
 #ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Could not send inlist message"));
+    PN532DEBUGPRINT.println(F("Unexpected Diagnose response"));
 #endif
     return false;
   }
 
-  if (!waitready(30000)) {
-    return false;
-  }
+  _lastStatus = frame.payload[0] & 0x3f;
+  return (_lastStatus == 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief   TA(1) byte of the addressed target's ATS: bits 6..4 list the
+             212/424/848 kbps rates it can send at, bits 2..0 the rates it
+             can receive at, bit 7 requires the same rate both ways.
+    @return  TA(1), 0 if the target only supports 106 kbps.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::getInListedTA1(void) {
+  return (_inListedCount == 0) ? 0 : _inListedTA1[_inListedIndex];
+}
 
-  readdata(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+/**************************************************************************/
+/*!
+    @brief   Error code of the last failed InDataExchange or InPSL, e.g.
+             PN532_STATUS_CRC after a corrupted RF frame.
+    @return  Low 6 bits of the PN532 status byte, 0 if it succeeded.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::getLastStatus(void) { return _lastStatus; }
 
-  if (pn532_packetbuffer[0] == 0 && pn532_packetbuffer[1] == 0 &&
-      pn532_packetbuffer[2] == 0xff) {
-    uint8_t length = pn532_packetbuffer[3];
-    if (pn532_packetbuffer[4] != (uint8_t)(~length + 1)) {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.println(F("Length check invalid"));
-      PN532DEBUGPRINT.println(length, HEX);
-      PN532DEBUGPRINT.println((~length) + 1, HEX);
-#endif
-      return false;
-    }
-    if (pn532_packetbuffer[5] == PN532_PN532TOHOST &&
-        pn532_packetbuffer[6] == PN532_RESPONSE_INLISTPASSIVETARGET) {
-      if (pn532_packetbuffer[7] != 1) {
-#ifdef PN532DEBUG
-        PN532DEBUGPRINT.println(F("Unhandled number of targets inlisted"));
-#endif
-        PN532DEBUGPRINT.println(F("Number of tags inlisted:"));
-        PN532DEBUGPRINT.println(pn532_packetbuffer[7]);
-        return false;
-      }
+/**************************************************************************/
+/*!
+    @brief   Sets the status word the response of the next exchange must end
+             with. The check runs on the last frame before it is copied, so
+             a wrong status aborts at once and only SW1 SW2 are handed back;
+             getExchangeError() then returns PN532_EXCHANGE_STATUS. A 61xx
+             status is not checked: the expectation carries over to the GET
+             RESPONSE that follows it.
+    @param   sw1   Expected SW1
+    @param   sw2   Expected SW2
+*/
+/**************************************************************************/
+void Adafruit_PN532::expectStatusWord(uint8_t sw1, uint8_t sw2) {
+  _expectedSW = ((uint16_t)sw1 << 8) | sw2;
+  _expectSW = true;
+}
 
-      _inListedTag = pn532_packetbuffer[8];
-      PN532DEBUGPRINT.print(F("Tag number: "));
-      PN532DEBUGPRINT.println(_inListedTag);
+/**************************************************************************/
+/*!
+    @brief   Tells why the last data exchange failed, so a response larger
+             than the buffer can be told apart from a lost card.
+    @return  PN532_EXCHANGE_OK, _LINK, _OVERFLOW or _STATUS.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::getExchangeError(void) { return _exchangeError; }
 
-      return true;
-    } else {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.print(F("Unexpected response to inlist passive host"));
-#endif
-      return false;
-    }
-  } else {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Preamble missing"));
-#endif
+/**************************************************************************/
+/*!
+    @brief   Returns the NFCID of the target addressed by the data exchange
+             functions, selected by the last inlist or
+             selectInListedTarget().
+    @param   uid        Pointer to a buffer of at least 10 bytes
+    @param   uidLength  Pointer to the variable that will hold the length
+    @return  true if a target is inlisted, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::getInListedUID(uint8_t *uid, uint8_t *uidLength) {
+  if (_inListedCount == 0) {
     return false;
   }
+  memcpy(uid, _inListedUid[_inListedIndex], _inListedUidLen[_inListedIndex]);
+  *uidLength = _inListedUidLen[_inListedIndex];
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Number of targets inlisted by the last inlist command.
+    @return  0, 1 or 2.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::getInListedCount(void) { return _inListedCount; }
 
+/**************************************************************************/
+/*!
+    @brief   Chooses which inlisted target the data exchange functions
+             address. Both targets stay active in the PN532, so switching
+             needs no new detection.
+    @param   index  0 for the first target, 1 for the second
+    @return  true if that target was inlisted, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::selectInListedTarget(uint8_t index) {
+  if (index >= _inListedCount) {
+    return false;
+  }
+  _inListedIndex = index;
+  _inListedTag = _inListedTags[index];
   return true;
 }
 
+#if PN532_ENABLE_MIFARE
+
 /***** Mifare Classic Functions ******/
 
 /**************************************************************************/
@@ -981,6 +2608,64 @@ uint8_t Adafruit_PN532::mifareclassic_ReadDataBlock(uint8_t blockNumber,
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    Reads a whole Mifare Classic sector: the sector is authenticated once,
+    then every block (trailer included) is read.
+
+    @param  uid           Pointer to a byte array containing the card UID
+    @param  uidLen        The length (in bytes) of the card's UID
+    @param  sector        Sector number (0..15 for 1K, 0..39 for 4K)
+    @param  keyNumber     Which key type to use (0 = MIFARE_CMD_AUTH_A,
+                          1 = MIFARE_CMD_AUTH_B)
+    @param  keyData       Pointer to a byte array containing the 6 byte key
+    @param  data          Buffer of 64 bytes (sectors 0..31) or 256 bytes
+                          (sectors 32..39) for the block contents
+
+    @returns 1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::mifareclassic_ReadSector(uint8_t *uid, uint8_t uidLen,
+                                                 uint8_t sector,
+                                                 uint8_t keyNumber,
+                                                 uint8_t *keyData,
+                                                 uint8_t *data) {
+  uint8_t firstBlock;
+  uint8_t blocks;
+
+  if (sector < 32) {
+    firstBlock = sector * 4;
+    blocks = 4;
+  } else if (sector < 40) {
+    firstBlock = 128 + (sector - 32) * 16;
+    blocks = 16;
+  } else {
+    return 0;
+  }
+
+  if (!mifareclassic_AuthenticateBlock(uid, uidLen, firstBlock, keyNumber,
+                                       keyData)) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < blocks; i++) {
+    uint8_t cmd[2] = {MIFARE_CMD_READ, (uint8_t)(firstBlock + i)};
+    uint8_t status;
+    uint8_t length;
+    if (!exchangeDataFrame(1, cmd, sizeof(cmd), &status, &length) ||
+        (length < 16)) {
+#ifdef MIFAREDEBUG
+      PN532DEBUGPRINT.print(F("Failed to read block "));
+      PN532DEBUGPRINT.println(firstBlock + i);
+#endif
+      return 0;
+    }
+    memcpy(data + i * 16, pn532_packetbuffer + 8, 16);
+  }
+
+  return 1;
+}
+
 /**************************************************************************/
 /*!
     Tries to write an entire 16-byte data block at the specified block
@@ -1000,27 +2685,7 @@ uint8_t Adafruit_PN532::mifareclassic_WriteDataBlock(uint8_t blockNumber,
   PN532DEBUGPRINT.println(blockNumber);
 #endif
 
-  /* Prepare the first command */
-  pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = 1;                /* Card number */
-  pn532_packetbuffer[2] = MIFARE_CMD_WRITE; /* Mifare Write command = 0xA0 */
-  pn532_packetbuffer[3] =
-      blockNumber; /* Block Number (0..63 for 1K, 0..255 for 4K) */
-  memcpy(pn532_packetbuffer + 4, data, 16); /* Data Payload */
-
-  /* Send the command */
-  if (!sendCommandCheckAck(pn532_packetbuffer, 20)) {
-#ifdef MIFAREDEBUG
-    PN532DEBUGPRINT.println(F("Failed to receive ACK for write command"));
-#endif
-    return 0;
-  }
-  delay(10);
-
-  /* Read the response packet */
-  readdata(pn532_packetbuffer, 26);
-
-  return 1;
+  return writeTagData(MIFARE_CMD_WRITE, blockNumber, data, 16);
 }
 
 /**************************************************************************/
@@ -1255,29 +2920,43 @@ uint8_t Adafruit_PN532::mifareultralight_WritePage(uint8_t page,
   PN532DEBUGPRINT.println(page);
 #endif
 
-  /* Prepare the first command */
-  pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = 1; /* Card number */
-  pn532_packetbuffer[2] =
-      MIFARE_ULTRALIGHT_CMD_WRITE; /* Mifare Ultralight Write command = 0xA2 */
-  pn532_packetbuffer[3] = page;    /* Page Number (0..63 for most cases) */
-  memcpy(pn532_packetbuffer + 4, data, 4); /* Data Payload */
+  return writeTagData(MIFARE_ULTRALIGHT_CMD_WRITE, page, data, 4);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sends a tag write command (Mifare WRITE or Ultralight/NTAG
+            WRITE) to the inlisted tag.
+
+    The PN532 only answers InDataExchange once the tag has acknowledged the
+    write, so waiting for that response is the completion signal: no fixed
+    delay is needed, and a NAK from the tag is reported as a failure.
+
+    @param  command   Tag command byte
+    @param  address   Block or page number
+    @param  data      Bytes to write
+    @param  len       Number of bytes to write (16 or 4)
+
+    @returns 1 if the tag committed the write, 0 for an error
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::writeTagData(uint8_t command, uint8_t address,
+                                     const uint8_t *data, uint8_t len) {
+  uint8_t *frame = beginFrame();
+  uint8_t status;
+  uint8_t length;
+
+  frame[0] = command;
+  frame[1] = address;
+  memcpy(frame + 2, data, len);
 
-  /* Send the command */
-  if (!sendCommandCheckAck(pn532_packetbuffer, 8)) {
+  if (!exchangeDataFrame(1, frame, len + 2, &status, &length)) {
 #ifdef MIFAREDEBUG
-    PN532DEBUGPRINT.println(F("Failed to receive ACK for write command"));
+    PN532DEBUGPRINT.println(F("Write command failed"));
 #endif
-
-    // Return Failed Signal
     return 0;
   }
-  delay(10);
-
-  /* Read the response packet */
-  readdata(pn532_packetbuffer, 26);
 
-  // Return OK Signal
   return 1;
 }
 
@@ -1362,6 +3041,55 @@ uint8_t Adafruit_PN532::ntag2xx_ReadPage(uint8_t page, uint8_t *buffer) {
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Reads a range of pages with the NTAG21x FAST_READ command, up
+            to NTAG2XX_FAST_READ_MAX_PAGES pages per exchange instead of
+            one READ per page.
+
+    @param  startPage  First page to read
+    @param  endPage    Last page to read (inclusive)
+    @param  buffer     Buffer of 4 * (endPage - startPage + 1) bytes
+
+    @returns 1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::ntag2xx_FastRead(uint8_t startPage, uint8_t endPage,
+                                         uint8_t *buffer) {
+  if ((endPage < startPage) || (endPage >= 231)) {
+#ifdef MIFAREDEBUG
+    PN532DEBUGPRINT.println(F("Page range out of range"));
+#endif
+    return 0;
+  }
+
+  uint16_t page = startPage;
+  while (page <= endPage) {
+    uint16_t last = page + NTAG2XX_FAST_READ_MAX_PAGES - 1;
+    if (last > endPage) {
+      last = endPage;
+    }
+    uint8_t cmd[3] = {NTAG2XX_CMD_FAST_READ, (uint8_t)page, (uint8_t)last};
+    uint8_t status;
+    uint8_t length;
+    uint8_t expected = (uint8_t)((last - page + 1) * 4);
+
+    if (!exchangeDataFrame(1, cmd, sizeof(cmd), &status, &length) ||
+        (length < expected)) {
+#ifdef MIFAREDEBUG
+      PN532DEBUGPRINT.print(F("FAST_READ failed at page "));
+      PN532DEBUGPRINT.println(page);
+#endif
+      return 0;
+    }
+    memcpy(buffer, pn532_packetbuffer + 8, expected);
+    buffer += expected;
+    page = last + 1;
+  }
+
+  return 1;
+}
+
 /**************************************************************************/
 /*!
     Tries to write an entire 4-byte page at the specified block
@@ -1395,30 +3123,7 @@ uint8_t Adafruit_PN532::ntag2xx_WritePage(uint8_t page, uint8_t *data) {
   PN532DEBUGPRINT.println(page);
 #endif
 
-  /* Prepare the first command */
-  pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = 1; /* Card number */
-  pn532_packetbuffer[2] =
-      MIFARE_ULTRALIGHT_CMD_WRITE; /* Mifare Ultralight Write command = 0xA2 */
-  pn532_packetbuffer[3] = page;    /* Page Number (0..63 for most cases) */
-  memcpy(pn532_packetbuffer + 4, data, 4); /* Data Payload */
-
-  /* Send the command */
-  if (!sendCommandCheckAck(pn532_packetbuffer, 8)) {
-#ifdef MIFAREDEBUG
-    PN532DEBUGPRINT.println(F("Failed to receive ACK for write command"));
-#endif
-
-    // Return Failed Signal
-    return 0;
-  }
-  delay(10);
-
-  /* Read the response packet */
-  readdata(pn532_packetbuffer, 26);
-
-  // Return OK Signal
-  return 1;
+  return writeTagData(MIFARE_ULTRALIGHT_CMD_WRITE, page, data, 4);
 }
 
 /**************************************************************************/
@@ -1519,6 +3224,8 @@ uint8_t Adafruit_PN532::ntag2xx_WriteNDEFURI(uint8_t uriIdentifier, char *url,
   // Seems that everything was OK (?!)
   return 1;
 }
+#endif // PN532_ENABLE_MIFARE
+
 
 /************** high level communication functions (handles both I2C and SPI) */
 
@@ -1530,10 +3237,10 @@ uint8_t Adafruit_PN532::ntag2xx_WriteNDEFURI(uint8_t uriIdentifier, char *url,
 bool Adafruit_PN532::readack() {
   uint8_t ackbuff[6];
 
-  if (spi_dev) {
+  if (onSPI()) {
     uint8_t cmd = PN532_SPI_DATAREAD;
     spi_dev->write_then_read(&cmd, 1, ackbuff, 6);
-  } else if (i2c_dev || ser_dev) {
+  } else if (onI2C() || onStream()) {
     readdata(ackbuff, 6);
   }
 
@@ -1546,20 +3253,26 @@ bool Adafruit_PN532::readack() {
 */
 /**************************************************************************/
 bool Adafruit_PN532::isready() {
-  if (spi_dev) {
+  if (_irqEnabled) {
+    // IRQ is held low while a response is pending
+    return _irqFired || (digitalRead(_irq) == LOW);
+  } else if (onSPI()) {
     // SPI ready check via Status Request
     uint8_t cmd = PN532_SPI_STATREAD;
     uint8_t reply;
     spi_dev->write_then_read(&cmd, 1, &reply, 1);
     return reply == PN532_SPI_READY;
-  } else if (i2c_dev) {
+  } else if (onI2C()) {
     // I2C ready check via reading RDY byte
     uint8_t rdy[1];
-    i2c_dev->read(rdy, 1);
+    if (!readI2CIdle(rdy, 1)) {
+      i2c_dev->read(rdy, 1);
+    }
     return rdy[0] == PN532_I2C_READY;
-  } else if (ser_dev) {
-    // Serial ready check based on non-zero read buffer
-    return (ser_dev->available() != 0);
+  } else if (onStream()) {
+    // Serial ready check based on a non-empty receive ring
+    pumpSerial();
+    return (_rxHead != _rxTail);
   } else if (_irq != -1) {
     uint8_t x = digitalRead(_irq);
     return x == 0;
@@ -1575,45 +3288,68 @@ bool Adafruit_PN532::isready() {
 */
 /**************************************************************************/
 bool Adafruit_PN532::waitready(uint16_t timeout) {
-  uint16_t timer = 0;
-  while (!isready()) {
-    if (timeout != 0) {
-      timer += 10;
-      if (timer > timeout) {
+  _timedOut = false;
+  if (_irqEnabled) {
+    // No bus traffic and no 10ms quantum: sleep until IRQ asserts
+    unsigned long start = millis();
+    while (!isready()) {
+      unsigned long elapsed = millis() - start;
+      if ((timeout != 0) && (elapsed > timeout)) {
 #ifdef PN532DEBUG
         PN532DEBUGPRINT.println("TIMEOUT!");
 #endif
+        _timedOut = true;
         return false;
       }
+      if (_idleCallback != NULL) {
+        // Come back every millisecond for the idle work
+        _idleCallback(_idleContext);
+        waitForIRQ(1);
+      } else {
+        waitForIRQ((timeout != 0) ? (uint16_t)(timeout - elapsed + 1) : 0);
+      }
+    }
+    _irqFired = false;
+    return true;
+  }
+
+  // Poll at the profile interval, timeout measured on the clock
+  unsigned long start = millis();
+  while (!isready()) {
+    if ((timeout != 0) && ((millis() - start) > timeout)) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println("TIMEOUT!");
+#endif
+      _timedOut = true;
+      return false;
+    }
+    if (_idleCallback != NULL) {
+      _idleCallback(_idleContext);
     }
-    delay(10);
+    pauseMicros(_pollIntervalUs);
   }
   return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Reads n bytes of data from the PN532 via SPI or I2C.
+    @brief  Reads n bytes of data from the PN532 via SPI, I2C or HSU.
 
     @param  buff      Pointer to the buffer where data will be written
     @param  n         Number of bytes to be read
 */
 /**************************************************************************/
 void Adafruit_PN532::readdata(uint8_t *buff, uint8_t n) {
-  if (spi_dev) {
+  if (onSPI()) {
     // SPI read
     uint8_t cmd = PN532_SPI_DATAREAD;
     spi_dev->write_then_read(&cmd, 1, buff, n);
-  } else if (i2c_dev) {
-    // I2C read
-    uint8_t rbuff[n + 1]; // +1 for leading RDY byte
-    i2c_dev->read(rbuff, n + 1);
-    for (uint8_t i = 0; i < n; i++) {
-      buff[i] = rbuff[i + 1];
-    }
-  } else if (ser_dev) {
-    // Serial read
-    ser_dev->readBytes(buff, n);
+  } else if (onI2C()) {
+    // I2C read, the leading RDY byte is dropped by the device
+    i2c_dev->read_skip(buff, n, 1);
+  } else if (onStream()) {
+    // Serial read from the receive ring
+    readSerial(buff, n);
   }
 #ifdef PN532DEBUG
   PN532DEBUGPRINT.print(F("Reading: "));
@@ -1625,6 +3361,179 @@ void Adafruit_PN532::readdata(uint8_t *buff, uint8_t n) {
 #endif
 }
 
+/**************************************************************************/
+/*!
+    @brief  Reads n bytes over I2C in the background, calling the idle
+            callback until they are in. Only on cores with asynchronous Wire
+            transfers (BUSIO_HAS_I2C_ASYNC) and with an idle callback set:
+            otherwise there is nothing to do meanwhile and the caller reads
+            synchronously.
+
+    @param  buff      Pointer to the buffer where data will be written
+    @param  n         Number of bytes to be read, RDY byte included
+
+    @return true if the bytes were read, false if the read was not started
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readI2CIdle(uint8_t *buff, uint8_t n) {
+#ifdef BUSIO_HAS_I2C_ASYNC
+  if ((_idleCallback != NULL) && i2c_dev->readAsync(buff, n)) {
+    while (!i2c_dev->asyncDone()) {
+      _idleCallback(_idleContext);
+    }
+    return true;
+  }
+#else
+  (void)buff;
+  (void)n;
+#endif
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads one response frame, clocking only the bytes announced by
+            its LEN field instead of a fixed-size buffer.
+
+            The header (preamble, start code, LEN, LCS) is read first, then
+            LEN bytes of TFI and data followed by DCS and postamble. Over I2C
+            every read restarts at the beginning of the frame, so the PN532
+            is asked to resend it with a NACK before the second read.
+
+    @param  buff      Pointer to the buffer where the frame will be written
+    @param  maxlen    Size of buff in bytes, longer frames are truncated
+
+    @return Number of bytes written to buff, 0 if no valid header was read
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::readframe(uint8_t *buff, uint8_t maxlen) {
+  uint8_t total;
+
+  if (maxlen < PN532_FRAME_HEADER_LEN) {
+    return 0;
+  }
+
+  if (onSPI()) {
+    // Both phases inside one chip select so the frame is read only once
+    spi_dev->beginTransactionWithAssertingCS();
+    spi_dev->transfer(PN532_SPI_DATAREAD);
+    memset(buff, 0xFF, PN532_FRAME_HEADER_LEN);
+    spi_dev->transfer(buff, PN532_FRAME_HEADER_LEN);
+  } else {
+    readdata(buff, PN532_FRAME_HEADER_LEN);
+  }
+
+  if ((buff[0] != PN532_PREAMBLE) || (buff[1] != PN532_STARTCODE1) ||
+      (buff[2] != PN532_STARTCODE2) || ((uint8_t)(buff[3] + buff[4]) != 0)) {
+    if (onSPI()) {
+      spi_dev->endTransactionWithDeassertingCS();
+    }
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Invalid frame header"));
+#endif
+    return 0;
+  }
+
+  uint16_t framelen =
+      PN532_FRAME_HEADER_LEN + buff[3] + PN532_FRAME_TRAILER_LEN;
+  total = (framelen > maxlen) ? maxlen : (uint8_t)framelen;
+
+  if (onSPI()) {
+    memset(buff + PN532_FRAME_HEADER_LEN, 0xFF,
+           total - PN532_FRAME_HEADER_LEN);
+    spi_dev->transfer(buff + PN532_FRAME_HEADER_LEN,
+                      total - PN532_FRAME_HEADER_LEN);
+    spi_dev->endTransactionWithDeassertingCS();
+  } else if (onI2C()) {
+    const uint8_t nack[] = {PN532_PREAMBLE,   PN532_STARTCODE1,
+                            PN532_STARTCODE2, 0xFF,
+                            0x00,             PN532_POSTAMBLE};
+    i2c_dev->write(nack, sizeof(nack));
+    if (!waitready(PN532_I2C_READYTIMEOUT)) {
+      return 0;
+    }
+    // In the background when possible: RDY byte read into buff, then dropped
+    if ((total < maxlen) && readI2CIdle(buff, total + 1)) {
+      memmove(buff, buff + 1, total);
+    } else {
+      readdata(buff, total);
+    }
+  } else {
+    readdata(buff + PN532_FRAME_HEADER_LEN, total - PN532_FRAME_HEADER_LEN);
+  }
+
+  return total;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Validates a response frame read by readframe().
+
+    @param  buff      Frame, starting with the preamble
+    @param  total     Number of bytes of the frame held in buff
+    @param  response  Expected response code (command code + 1)
+
+    @return true if the frame is complete, carries the expected response
+            and its checksums match, false otherwise
+*/
+/**************************************************************************/
+bool PN532Frame::parse(const uint8_t *buff, uint8_t total, uint8_t response) {
+  payload = nullptr;
+  length = 0;
+
+  if ((total < PN532_FRAME_HEADER_LEN) || (buff[0] != PN532_PREAMBLE) ||
+      (buff[1] != PN532_STARTCODE1) || (buff[2] != PN532_STARTCODE2) ||
+      ((uint8_t)(buff[3] + buff[4]) != 0)) {
+    return false;
+  }
+
+  // TFI and response code, then the DCS must all have been read
+  uint8_t len = buff[3];
+  if ((len < 2) || (total < PN532_FRAME_HEADER_LEN + len + 1)) {
+    return false;
+  }
+  if ((buff[5] != PN532_PN532TOHOST) || (buff[6] != response)) {
+    return false;
+  }
+
+  // DCS: TFI + data + DCS sums to zero
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i <= len; i++) {
+    sum += buff[PN532_FRAME_HEADER_LEN + i];
+  }
+  if (sum != 0) {
+    return false;
+  }
+
+  payload = buff + PN532_FRAME_HEADER_LEN + 2;
+  length = len - 2;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the response to a command into pn532_packetbuffer and
+            validates it.
+
+    @param  command   Command the response answers
+    @param  frame     Receives the view of the response payload
+
+    @return true if a valid response to command was read, false otherwise
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readResponse(uint8_t command, PN532Frame *frame) {
+  uint8_t total = readframe(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  if (!frame->parse(pn532_packetbuffer, total, command + 1)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Invalid response frame"));
+#endif
+    return false;
+  }
+  return true;
+}
+
+#if PN532_ENABLE_TARGET
+
 /**************************************************************************/
 /*!
     @brief   set the PN532 as iso14443a Target behaving as a SmartCard
@@ -1723,98 +3632,312 @@ uint8_t Adafruit_PN532::setDataTarget(uint8_t *cmd, uint8_t cmdlen) {
   return (pn532_packetbuffer[offset] == 0x15);
 }
 
+/**************************************************************************/
+/*!
+    @brief   Sends TgGetData without waiting for the initiator's data, so the
+             caller can do other work until the PN532 raises IRQ (or
+             isready() returns true) and then call readTargetData().
+    @return  true if the PN532 acknowledged the command, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startTargetGetData(void) {
+  pn532_packetbuffer[0] = PN532_COMMAND_TGGETDATA;
+  return sendCommand(pn532_packetbuffer, 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Reads the answer to startTargetGetData() straight into the
+             caller's buffer. While the initiator chains its frames (MI bit
+             in the status byte) the next TgGetData is issued at once, so a
+             long payload is received at the RF rate.
+    @param   buffer  Pointer to the receive buffer
+    @param   length  Input: size of buffer; Output: bytes received
+    @return  true on success, false on error or if buffer is too small.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readTargetData(uint8_t *buffer, size_t *length) {
+  size_t capacity = *length;
+  size_t received = 0;
+
+  while (true) {
+    PN532Frame frame;
+    if (!readResponse(PN532_COMMAND_TGGETDATA, &frame) ||
+        (frame.length < 1)) {
+      return false;
+    }
+    uint8_t status = frame.payload[0];
+    _lastStatus = status & 0x3f;
+    if (_lastStatus != 0) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("TgGetData status indicates an error"));
+#endif
+      return false;
+    }
+
+    uint8_t chunk = frame.length - 1;
+    if (chunk > (capacity - received)) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("Target receive buffer too small"));
+#endif
+      return false;
+    }
+    memcpy(buffer + received, frame.payload + 1, chunk);
+    received += chunk;
+
+    if ((status & PN532_DATAEXCHANGE_MI) == 0) {
+      break;
+    }
+    if (!startTargetGetData() || !waitready(_exchangeTimeoutMs)) {
+      return false;
+    }
+  }
+
+  *length = received;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Receives one (possibly chained) command from the initiator.
+             Waiting uses the IRQ pin when enabled.
+    @param   buffer   Pointer to the receive buffer
+    @param   length   Input: size of buffer; Output: bytes received
+    @param   timeout  Time to wait for the first frame in ms, 0 means wait
+                      forever
+    @return  true on success, false on timeout or error.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::tgGetData(uint8_t *buffer, size_t *length,
+                               uint16_t timeout) {
+  if (!startTargetGetData()) {
+    return false;
+  }
+  if (!waitready(timeout)) {
+    abortCommand();
+    return false;
+  }
+  return readTargetData(buffer, length);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends a response of any length to the initiator. Every chunk
+             but the last goes out with TgSetMetaData (MI bit set), the last
+             one with TgSetData.
+    @param   data    Pointer to the data to send
+    @param   length  Number of bytes to send
+    @return  true if every chunk was accepted, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::tgSetData(const uint8_t *data, size_t length) {
+  uint8_t maxChunk = dataExchangeChunk();
+
+  do {
+    uint8_t chunk = (length > maxChunk) ? maxChunk : (uint8_t)length;
+    uint8_t command = (length > chunk) ? PN532_COMMAND_TGSETMETADATA
+                                       : PN532_COMMAND_TGSETDATA;
+
+    pn532_packetbuffer[0] = command;
+    memcpy(pn532_packetbuffer + 1, data, chunk);
+    if (!sendCommandCheckAck(pn532_packetbuffer, chunk + 1,
+                             _exchangeTimeoutMs)) {
+      return false;
+    }
+
+    PN532Frame frame;
+    if (!readResponse(command, &frame) || (frame.length < 1)) {
+      return false;
+    }
+    _lastStatus = frame.payload[0] & 0x3f;
+    if (_lastStatus != 0) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("TgSetData status indicates an error"));
+#endif
+      return false;
+    }
+
+    data += chunk;
+    length -= chunk;
+  } while (length > 0);
+
+  return true;
+}
+#endif // PN532_ENABLE_TARGET
+
+
 /**************************************************************************/
 /*!
     @brief  Writes a command to the PN532, automatically inserting the
             preamble and required frame details (checksum, len, etc.)
 
+            The frame is streamed: the header is sent from a small local
+            array, the command bytes straight from cmd, then the DCS and
+            postamble trailer. No frame-sized buffer is needed.
+
     @param  cmd       Pointer to the command buffer
     @param  cmdlen    Command length in bytes
 */
 /**************************************************************************/
 void Adafruit_PN532::writecommand(uint8_t *cmd, uint8_t cmdlen) {
-  if (spi_dev) {
-    // SPI command write.
-    uint8_t checksum;
-    uint8_t packet[9 + cmdlen];
-    uint8_t *p = packet;
-    cmdlen++;
-
-    p[0] = PN532_SPI_DATAWRITE;
-    p++;
-
-    p[0] = PN532_PREAMBLE;
-    p++;
-    p[0] = PN532_STARTCODE1;
-    p++;
-    p[0] = PN532_STARTCODE2;
-    p++;
-    checksum = PN532_PREAMBLE + PN532_STARTCODE1 + PN532_STARTCODE2;
-
-    p[0] = cmdlen;
-    p++;
-    p[0] = ~cmdlen + 1;
-    p++;
-
-    p[0] = PN532_HOSTTOPN532;
-    p++;
-    checksum += PN532_HOSTTOPN532;
-
-    for (uint8_t i = 0; i < cmdlen - 1; i++) {
-      p[0] = cmd[i];
-      p++;
-      checksum += cmd[i];
-    }
-
-    p[0] = ~checksum;
-    p++;
-    p[0] = PN532_POSTAMBLE;
-    p++;
+  // LEN covers TFI and the command bytes
+  uint8_t LEN = cmdlen + 1;
+  // SPI direction byte, preamble, start codes, LEN, LCS and TFI
+  uint8_t header[PN532_FRAME_HEADER_LEN + 2] = {
+      PN532_SPI_DATAWRITE, PN532_PREAMBLE,         PN532_STARTCODE1,
+      PN532_STARTCODE2,    LEN,                    (uint8_t)(~LEN + 1),
+      PN532_HOSTTOPN532};
+  uint8_t trailer[PN532_FRAME_TRAILER_LEN];
+  uint8_t sum = PN532_HOSTTOPN532;
+
+  // any earlier edge belongs to a previous frame
+  _irqFired = false;
+
+  for (uint8_t i = 0; i < cmdlen; i++) {
+    sum += cmd[i];
+  }
+  trailer[0] = ~sum + 1;
+  trailer[1] = PN532_POSTAMBLE;
 
 #ifdef PN532DEBUG
-    Serial.print("Sending : ");
-    for (int i = 1; i < 8 + cmdlen; i++) {
-      Serial.print("0x");
-      Serial.print(packet[i], HEX);
-      Serial.print(", ");
-    }
-    Serial.println();
-#endif
-
-    spi_dev->write(packet, 8 + cmdlen);
-  } else if (i2c_dev || ser_dev) {
-    // I2C or Serial command write.
-    uint8_t packet[8 + cmdlen];
-    uint8_t LEN = cmdlen + 1;
-
-    packet[0] = PN532_PREAMBLE;
-    packet[1] = PN532_STARTCODE1;
-    packet[2] = PN532_STARTCODE2;
-    packet[3] = LEN;
-    packet[4] = ~LEN + 1;
-    packet[5] = PN532_HOSTTOPN532;
-    uint8_t sum = 0;
-    for (uint8_t i = 0; i < cmdlen; i++) {
-      packet[6 + i] = cmd[i];
-      sum += cmd[i];
-    }
-    packet[6 + cmdlen] = ~(PN532_HOSTTOPN532 + sum) + 1;
-    packet[7 + cmdlen] = PN532_POSTAMBLE;
+  Serial.print("Sending : ");
+  for (uint8_t i = 1; i < sizeof(header); i++) {
+    Serial.print("0x");
+    Serial.print(header[i], HEX);
+    Serial.print(", ");
+  }
+  for (uint8_t i = 0; i < cmdlen; i++) {
+    Serial.print("0x");
+    Serial.print(cmd[i], HEX);
+    Serial.print(", ");
+  }
+#endif
 
 #ifdef PN532DEBUG
-    Serial.print("Sending : ");
-    for (int i = 1; i < 8 + cmdlen; i++) {
-      Serial.print("0x");
-      Serial.print(packet[i], HEX);
-      Serial.print(", ");
-    }
-    Serial.println();
+  Serial.print("0x");
+  Serial.print(trailer[0], HEX);
+  Serial.print(", 0x");
+  Serial.println(trailer[1], HEX);
 #endif
 
-    if (i2c_dev) {
-      i2c_dev->write(packet, 8 + cmdlen);
+  if (onSPI()) {
+    // SPI command write, three block writes under one CS assertion
+    spi_dev->beginTransactionWithAssertingCS();
+    spi_dev->transmit(header, sizeof(header));
+    spi_dev->transmit(cmd, cmdlen);
+    spi_dev->transmit(trailer, sizeof(trailer));
+    spi_dev->endTransactionWithDeassertingCS();
+  } else if (onI2C() || onStream()) {
+    // I2C or Serial command write, without the SPI direction byte
+    if (onI2C()) {
+      i2c_dev->write(cmd, cmdlen, true, header + 1, sizeof(header) - 1,
+                     trailer, sizeof(trailer));
+    } else {
+      // An answer left unread (e.g. RFConfiguration's) would be taken for
+      // the ACK of this command
+      pumpSerial();
+      _rxTail = _rxHead;
+      if (onMock()) {
+        mock_dev->write(header + 1, sizeof(header) - 1);
+        mock_dev->write(cmd, cmdlen);
+        mock_dev->write(trailer, sizeof(trailer));
+      } else {
+        ser_dev->write(header + 1, sizeof(header) - 1);
+        ser_dev->write(cmd, cmdlen);
+        ser_dev->write(trailer, sizeof(trailer));
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a scheduler over a set of initialised readers.
+
+    @param  readers       Array of readers, each already begun
+    @param  count         Number of readers in the array (at most 32)
+    @param  cardbaudrate  Baud rate of the cards to detect
+*/
+/**************************************************************************/
+Adafruit_PN532_Scheduler::Adafruit_PN532_Scheduler(Adafruit_PN532 **readers,
+                                                   uint8_t count,
+                                                   uint8_t cardbaudrate)
+    : _readers(readers), _count((count > 32) ? 32 : count),
+      _baud(cardbaudrate) {}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a detection on every reader. The PN532s then search for
+            cards in parallel while the host only collects the results.
+*/
+/**************************************************************************/
+void Adafruit_PN532_Scheduler::begin(void) {
+  _armed = 0;
+  _held = 0;
+  _next = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    rearm(i);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a new detection on one reader, e.g. once the card it
+            reported has been handled.
+
+    @param  reader  Index of the reader in the array
+*/
+/**************************************************************************/
+void Adafruit_PN532_Scheduler::rearm(uint8_t reader) {
+  if (reader >= _count) {
+    return;
+  }
+  _held &= ~(1UL << reader);
+  if (_readers[reader]->startPassiveTargetIDDetection(_baud)) {
+    _armed |= (1UL << reader);
+  } else {
+    _armed &= ~(1UL << reader);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Serves the next reader in turn. A reader whose detection is
+            still running costs one status read; one whose command could not
+            be sent is rearmed. Each call touches a single reader, so none of them
+            holds the bus while another has a card.
+
+            The reader that reported a card is left idle until rearm() is
+            called, which leaves the caller free to talk to that card first.
+
+    @param  uid        Pointer to the array that receives the card's UID
+    @param  uidLength  Pointer to the variable that receives the UID length
+    @return Index of the reader that detected a card, -1 if none did.
+*/
+/**************************************************************************/
+int8_t Adafruit_PN532_Scheduler::poll(uint8_t *uid, uint8_t *uidLength) {
+  int8_t found = -1;
+
+  if (_count == 0) {
+    return -1;
+  }
+
+  uint8_t reader = _next;
+  _next = (uint8_t)((_next + 1) % _count);
+
+  if ((_held & (1UL << reader)) != 0) {
+    // card still being handled by the caller
+  } else if ((_armed & (1UL << reader)) == 0) {
+    rearm(reader);
+  } else if (_readers[reader]->isready()) {
+    _armed &= ~(1UL << reader);
+    if (_readers[reader]->readDetectedPassiveTargetID(uid, uidLength)) {
+      _held |= (1UL << reader);
+      found = (int8_t)reader;
     } else {
-      ser_dev->write(packet, 8 + cmdlen);
+      rearm(reader);
     }
   }
+
+  return found;
 }
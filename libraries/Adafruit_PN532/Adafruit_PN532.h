@@ -17,6 +17,19 @@
 
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_SPIDevice.h>
+#include <new>
+
+// On FreeRTOS builds waitready() blocks the calling task on a notification
+// given by the IRQ handler instead of spinning until the line asserts
+#if defined(ESP32)
+#define PN532_RTOS_WAIT (1) ///< Wait for IRQ on a task notification
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(ARDUINO_ARCH_RP2040) && defined(__FREERTOS)
+#define PN532_RTOS_WAIT (1) ///< Wait for IRQ on a task notification
+#include <FreeRTOS.h>
+#include <task.h>
+#endif
 
 #define PN532_PREAMBLE (0x00)   ///< Command sequence start, byte 1/3
 #define PN532_STARTCODE1 (0x00) ///< Command sequence start, byte 2/3
@@ -62,13 +75,66 @@
 
 #define PN532_RESPONSE_INDATAEXCHANGE (0x41)      ///< Data exchange
 #define PN532_RESPONSE_INLISTPASSIVETARGET (0x4B) ///< List passive target
+#define PN532_RESPONSE_INAUTOPOLL (0x61)          ///< Auto poll
+#define PN532_RESPONSE_INPSL (0x4F)               ///< PSL
+#define PN532_RESPONSE_POWERDOWN (0x17)           ///< Power down
 
 #define PN532_WAKEUP (0x55) ///< Wake
 
+// PowerDown wake-up sources
+#define PN532_WAKEUP_SOURCE_I2C (0x80)  ///< I2C bus activity
+#define PN532_WAKEUP_SOURCE_GPIO (0x40) ///< P32 or P34 low
+#define PN532_WAKEUP_SOURCE_SPI (0x20)  ///< SPI bus activity
+#define PN532_WAKEUP_SOURCE_HSU (0x10)  ///< HSU bus activity
+#define PN532_WAKEUP_SOURCE_RF (0x08)   ///< External RF field detected
+#define PN532_WAKEUP_SOURCE_INT1 (0x02) ///< INT1 pin low
+#define PN532_WAKEUP_SOURCE_INT0 (0x01) ///< INT0 pin low
+#define PN532_WAKEUP_DELAY_US (2000)    ///< Oscillator start after wake-up
+
 #define PN532_SPI_STATREAD (0x02)  ///< Stat read
 #define PN532_SPI_DATAWRITE (0x01) ///< Data write
 #define PN532_SPI_DATAREAD (0x03)  ///< Data read
 #define PN532_SPI_READY (0x01)     ///< Ready
+#define PN532_SPI_CLOCK (1000000UL)     ///< Default SPI clock
+#define PN532_SPI_MAX_CLOCK (5000000UL) ///< Highest SPI clock of the PN532
+
+// Bus of the reader. With a fixed transport, the other constructors are
+// compiled out and every bus test folds to a constant. It changes the class
+// layout: set it for the whole build (compiler flags), not in one sketch.
+#define PN532_TRANSPORT_ANY (0) ///< Picked by the constructor at run time
+#define PN532_TRANSPORT_SPI (1) ///< Hardware or software SPI only
+#define PN532_TRANSPORT_I2C (2) ///< I2C only
+#define PN532_TRANSPORT_HSU (3) ///< HSU (UART) only
+#define PN532_TRANSPORT_MOCK (4) ///< Adafruit_PN532_MockLink only (host builds)
+#ifndef PN532_TRANSPORT
+#define PN532_TRANSPORT PN532_TRANSPORT_ANY ///< Bus compiled in
+#endif
+#define PN532_HAS_SPI                                                          \
+  ((PN532_TRANSPORT == PN532_TRANSPORT_ANY) ||                                 \
+   (PN532_TRANSPORT == PN532_TRANSPORT_SPI)) ///< SPI constructors available
+#define PN532_HAS_I2C                                                          \
+  ((PN532_TRANSPORT == PN532_TRANSPORT_ANY) ||                                 \
+   (PN532_TRANSPORT == PN532_TRANSPORT_I2C)) ///< I2C constructor available
+#define PN532_HAS_HSU                                                          \
+  ((PN532_TRANSPORT == PN532_TRANSPORT_ANY) ||                                 \
+   (PN532_TRANSPORT == PN532_TRANSPORT_HSU)) ///< HSU constructor available
+#define PN532_HAS_MOCK                                                         \
+  ((PN532_TRANSPORT == PN532_TRANSPORT_ANY) ||                                 \
+   (PN532_TRANSPORT == PN532_TRANSPORT_MOCK)) ///< Mock constructor available
+
+// Optional parts of the driver. A wallet reader only needs ISO-DEP: build
+// with PN532_ENABLE_MIFARE, PN532_ENABLE_TARGET and PN532_ENABLE_PRINTHEX set
+// to 0 to leave out the tag helpers, target mode and hex dumps. Like
+// PN532_TRANSPORT, set them for the whole build.
+#ifndef PN532_ENABLE_MIFARE
+#define PN532_ENABLE_MIFARE (1) ///< Mifare Classic, Ultralight, NTAG2xx, NDEF
+#endif
+#ifndef PN532_ENABLE_TARGET
+#define PN532_ENABLE_TARGET (1) ///< Card emulation (TgInitAsTarget...)
+#endif
+#ifndef PN532_ENABLE_PRINTHEX
+#define PN532_ENABLE_PRINTHEX (1) ///< PrintHex(), needed by the debug output
+#endif
 
 #define PN532_I2C_ADDRESS (0x48 >> 1) ///< Default I2C address
 #define PN532_I2C_READBIT (0x01)      ///< Read bit
@@ -76,8 +142,68 @@
 #define PN532_I2C_READY (0x01)        ///< Ready
 #define PN532_I2C_READYTIMEOUT (20)   ///< Ready timeout
 
+#define PN532_HSU_DEFAULT_BAUD (115200UL) ///< HSU baud rate after reset
+#ifndef PN532_HSU_RING_SIZE
+#define PN532_HSU_RING_SIZE (128) ///< HSU receive ring size, at most 256
+#endif
+#define PN532_HSU_FIRST_BYTE_TIMEOUT_MS                                        \
+  (1000) ///< Longest wait for the start of an HSU frame
+#define PN532_HSU_BYTE_TIMEOUT_MS (10) ///< Longest gap inside an HSU frame
+#define PN532_HSU_SWITCH_DELAY_US (1000) ///< Settle time after a baud change
+
+#define PN532_PACKBUFFSIZ (255) ///< Packet buffer size in bytes
+#define PN532_MAX_INLISTED (2)  ///< Targets the PN532 can inlist at once
+
+#define PN532_FRAME_HEADER_LEN (5) ///< Preamble, start code, LEN and LCS
+#define PN532_FRAME_TRAILER_LEN (2) ///< DCS and postamble
+
+#define PN532_DATAEXCHANGE_MI (0x40) ///< More Information (chaining) bit
+#define PN532_FRAME_DATA_MAX (252) ///< Bytes available from beginFrame()
+
+#define PN532_DEFAULT_ACK_DELAY_US (1000) ///< Pause before polling for ACK
+#define PN532_DEFAULT_RESPONSE_DELAY_US                                        \
+  (1000) ///< Pause before polling for a response
+#define PN532_DEFAULT_POLL_INTERVAL_US (10000) ///< Pause between ready polls
+#define PN532_MIN_POLL_INTERVAL_US (100) ///< Shortest calibrated poll interval
+#define PN532_DEFAULT_INLIST_TIMEOUT_MS (1000) ///< Longest wait for a card
+#define PN532_DEFAULT_EXCHANGE_TIMEOUT_MS                                      \
+  (1000) ///< Longest wait for an InDataExchange answer
+#define PN532_CALIBRATION_TIMEOUT_US                                           \
+  (100000) ///< Give up a calibration sample after this long
+
 #define PN532_MIFARE_ISO14443A (0x00) ///< MiFare
 
+// InPSL bit rates
+#define PN532_BITRATE_106 (0x00) ///< 106 kbps
+#define PN532_BITRATE_212 (0x01) ///< 212 kbps
+#define PN532_BITRATE_424 (0x02) ///< 424 kbps
+#define PN532_BITRATE_848 (0x03) ///< 848 kbps
+
+// Diagnose test numbers
+#define PN532_DIAGNOSE_LINE (0x00)     ///< Communication line test (echo)
+#define PN532_DIAGNOSE_PRESENCE (0x06) ///< ISO-DEP card presence detection
+#define PN532_DIAGNOSE_ANTENNA (0x07)  ///< Antenna self test
+
+// InDataExchange / InPSL status codes (low 6 bits of the status byte)
+#define PN532_STATUS_TIMEOUT (0x01) ///< Target did not answer
+#define PN532_STATUS_CRC (0x02)     ///< CRC error on the RF frame
+#define PN532_STATUS_PARITY (0x03)  ///< Parity error on the RF frame
+
+// Why the last data exchange failed, see getExchangeError()
+#define PN532_EXCHANGE_OK (0)        ///< Response received and accepted
+#define PN532_EXCHANGE_LINK (1)      ///< No valid answer from PN532 or card
+#define PN532_EXCHANGE_OVERFLOW (2)  ///< Response larger than the buffer
+#define PN532_EXCHANGE_STATUS (3)    ///< Not the status word expected
+#define PN532_SW1_MORE_DATA (0x61)   ///< SW1 announcing GET RESPONSE data
+
+// InAutoPoll target types
+#define PN532_AUTOPOLL_TYPE_GENERIC_106A (0x00) ///< Any ISO14443A at 106 kbps
+#define PN532_AUTOPOLL_TYPE_MIFARE (0x10)       ///< Mifare card
+#define PN532_AUTOPOLL_TYPE_ISO14443_4A (0x20)  ///< ISO14443-4A (ISO-DEP)
+#define PN532_AUTOPOLL_ENDLESS (0xFF)   ///< Poll until a target is found
+#define PN532_AUTOPOLL_MAX_TYPES (15)   ///< Most types per InAutoPoll
+#define PN532_AUTOPOLL_MAX_PERIOD (15)  ///< Longest period, in 150 ms units
+
 // Mifare Commands
 #define MIFARE_CMD_AUTH_A (0x60)           ///< Auth A
 #define MIFARE_CMD_AUTH_B (0x61)           ///< Auth B
@@ -88,6 +214,8 @@
 #define MIFARE_CMD_INCREMENT (0xC1)        ///< Increment
 #define MIFARE_CMD_STORE (0xC2)            ///< Store
 #define MIFARE_ULTRALIGHT_CMD_WRITE (0xA2) ///< Write (MiFare Ultralight)
+#define NTAG2XX_CMD_FAST_READ (0x3A)       ///< Fast read (NTAG21x)
+#define NTAG2XX_FAST_READ_MAX_PAGES (60)   ///< Pages per FAST_READ exchange
 
 // Prefixes for NDEF Records (to identify record type)
 #define NDEF_URIPREFIX_NONE (0x00)         ///< No prefix
@@ -135,30 +263,103 @@
 #define PN532_GPIO_P34 (4)              ///< GPIO 34
 #define PN532_GPIO_P35 (5)              ///< GPIO 35
 
+/**
+ * @brief View of a validated PN532 response frame.
+ *
+ * parse() checks the frame once (preamble, LEN/LCS, TFI, response code and
+ * DCS); the payload then points into the frame, just after the response
+ * code, so nothing is copied.
+ */
+struct PN532Frame {
+  const uint8_t *payload = nullptr; ///< First byte after the response code
+  uint8_t length = 0;               ///< Number of payload bytes
+
+  bool parse(const uint8_t *buff, uint8_t total, uint8_t response);
+};
+
+/**
+ * @brief Byte stream standing in for the PN532 and its bus, e.g. a PN532
+ *        emulator replaying a recorded session on a host without hardware.
+ *
+ * The driver talks to it like to the HSU: host frames (commands, and the
+ * ACK frame of abortCommand()) are written in order, possibly split over
+ * several write() calls, and the ACK and response frames of the PN532 are
+ * read back byte by byte. available() returning 0 is seen as the PN532
+ * still working, so a link can simulate its latency there.
+ */
+class Adafruit_PN532_MockLink {
+public:
+  virtual ~Adafruit_PN532_MockLink() {}
+  /// Called by Adafruit_PN532::begin(), before the first frame
+  virtual void begin(void) {}
+  /// Takes bytes sent by the host
+  virtual void write(const uint8_t *data, size_t len) = 0;
+  /// Number of PN532 bytes ready to be read
+  virtual int available(void) = 0;
+  /// Next PN532 byte, -1 if none is available
+  virtual int read(void) = 0;
+};
+
 /**
  * @brief Class for working with Adafruit PN532 NFC/RFID breakout boards.
  */
 class Adafruit_PN532 {
 public:
-  Adafruit_PN532(uint8_t clk, uint8_t miso, uint8_t mosi,
-                 uint8_t ss);                          // Software SPI
-  Adafruit_PN532(uint8_t ss, SPIClass *theSPI = &SPI); // Hardware SPI
+  /// Callback run while waiting for the PN532 to become ready
+  typedef void (*idleCallback_t)(void *context);
+
+#if PN532_HAS_SPI
+  Adafruit_PN532(uint8_t clk, uint8_t miso, uint8_t mosi, uint8_t ss,
+                 uint32_t spiClock = PN532_SPI_CLOCK); // Software SPI
+  Adafruit_PN532(uint8_t ss, SPIClass *theSPI = &SPI,
+                 uint32_t spiClock = PN532_SPI_CLOCK); // Hardware SPI
+#endif
+#if PN532_HAS_I2C
   Adafruit_PN532(uint8_t irq, uint8_t reset,
-                 TwoWire *theWire = &Wire);              // Hardware I2C
+                 TwoWire *theWire = &Wire); // Hardware I2C
+#endif
+#if PN532_HAS_HSU
   Adafruit_PN532(uint8_t reset, HardwareSerial *theSer); // Hardware UART
+#endif
+#if PN532_HAS_MOCK
+  Adafruit_PN532(Adafruit_PN532_MockLink *theMock); // Mock link
+#endif
+  ~Adafruit_PN532();
   bool begin(void);
 
   void reset(void);
   void wakeup(void);
+  bool powerDown(uint8_t wakeUpSources, bool generateIrq = true);
+  void wakeFromPowerDown(void);
+  uint8_t hostWakeUpSource(void);
 
   // Generic PN532 functions
   bool SAMConfig(void);
   uint32_t getFirmwareVersion(void);
   bool sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
                            uint16_t timeout = 100);
+  bool sendCommand(uint8_t *cmd, uint8_t cmdlen, uint16_t timeout = 100);
+  uint32_t getAckWaitMicros(void);
+  void setTiming(uint16_t ackDelayUs, uint16_t responseDelayUs,
+                 uint16_t pollIntervalUs);
+  bool calibrateTiming(uint8_t samples = 4);
+  void setTimeouts(uint16_t inListTimeoutMs, uint16_t exchangeTimeoutMs);
+  bool timedOut(void);
+  bool setI2CClock(uint32_t clock);
+  bool setSPIClock(uint32_t clock);
+  uint32_t getSPIClock(void);
+  bool setSerialBaudRate(uint32_t baud);
+  void pumpSerial(void);
+  bool isready();
   bool writeGPIO(uint8_t pinstate);
   uint8_t readGPIO(void);
   bool setPassiveActivationRetries(uint8_t maxRetries);
+  bool setCommunicationRetries(uint8_t maxRetries);
+  void invalidateConfig(void);
+  bool restoreConfig(void);
+  void setIdleCallback(idleCallback_t callback, void *context = NULL);
+  bool enableIRQ(int8_t irq = -1);
+  void disableIRQ(void);
 
   // ISO14443A functions
   bool readPassiveTargetID(
@@ -166,13 +367,50 @@ public:
       uint16_t timeout = 0); // timeout 0 means no timeout - will block forever.
   bool startPassiveTargetIDDetection(uint8_t cardbaudrate);
   bool readDetectedPassiveTargetID(uint8_t *uid, uint8_t *uidLength);
+  bool inDataExchangeChained(const uint8_t *send, size_t sendLength,
+                             uint8_t *response, size_t *responseLength);
   bool inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response,
                       uint8_t *responseLength);
-  bool inListPassiveTarget();
+  uint8_t *beginFrame(void);
+  bool commitFrame(uint8_t len, uint8_t *response, size_t *responseLength);
+  bool beginDataExchange(const uint8_t *send, uint8_t sendLength);
+  bool isExchangeComplete(void);
+  bool finishDataExchange(uint8_t *response, size_t *responseLength);
+  bool finishDataExchangeView(const uint8_t **response,
+                              uint8_t *responseLength);
+  bool commitFrameView(uint8_t len, const uint8_t **response,
+                       uint8_t *responseLength);
+  void expectStatusWord(uint8_t sw1, uint8_t sw2);
+  uint8_t getExchangeError(void);
+  bool inListPassiveTarget(uint8_t maxTargets = 1);
+  bool startInListPassiveTarget(uint8_t maxTargets = 1);
+  bool readInListedPassiveTarget();
+  bool getInListedUID(uint8_t *uid, uint8_t *uidLength);
+  uint8_t getInListedCount(void);
+  bool selectInListedTarget(uint8_t index);
+  bool startInAutoPoll(uint8_t pollNr, uint8_t period, const uint8_t *types,
+                       uint8_t typeCount);
+  bool readInAutoPoll(uint8_t *type);
+  void abortCommand(void);
+  bool inPSL(uint8_t brit, uint8_t brti);
+  bool inPresenceCheck(void);
+  bool diagnoseLine(void);
+  bool diagnoseAntenna(uint8_t detector);
+  uint8_t getInListedTA1(void);
+  uint8_t getLastStatus(void);
+
+#if PN532_ENABLE_TARGET
+  // Target mode functions
   uint8_t AsTarget();
   uint8_t getDataTarget(uint8_t *cmd, uint8_t *cmdlen);
   uint8_t setDataTarget(uint8_t *cmd, uint8_t cmdlen);
+  bool startTargetGetData(void);
+  bool readTargetData(uint8_t *buffer, size_t *length);
+  bool tgGetData(uint8_t *buffer, size_t *length, uint16_t timeout = 1000);
+  bool tgSetData(const uint8_t *data, size_t length);
+#endif
 
+#if PN532_ENABLE_MIFARE
   // Mifare Classic functions
   bool mifareclassic_IsFirstBlock(uint32_t uiBlock);
   bool mifareclassic_IsTrailerBlock(uint32_t uiBlock);
@@ -180,6 +418,9 @@ public:
                                           uint32_t blockNumber,
                                           uint8_t keyNumber, uint8_t *keyData);
   uint8_t mifareclassic_ReadDataBlock(uint8_t blockNumber, uint8_t *data);
+  uint8_t mifareclassic_ReadSector(uint8_t *uid, uint8_t uidLen,
+                                   uint8_t sector, uint8_t keyNumber,
+                                   uint8_t *keyData, uint8_t *data);
   uint8_t mifareclassic_WriteDataBlock(uint8_t blockNumber, uint8_t *data);
   uint8_t mifareclassic_FormatNDEF(void);
   uint8_t mifareclassic_WriteNDEFURI(uint8_t sectorNumber,
@@ -191,31 +432,165 @@ public:
 
   // NTAG2xx functions
   uint8_t ntag2xx_ReadPage(uint8_t page, uint8_t *buffer);
+  uint8_t ntag2xx_FastRead(uint8_t startPage, uint8_t endPage,
+                           uint8_t *buffer);
   uint8_t ntag2xx_WritePage(uint8_t page, uint8_t *data);
   uint8_t ntag2xx_WriteNDEFURI(uint8_t uriIdentifier, char *url,
                                uint8_t dataLen);
+#endif
 
+#if PN532_ENABLE_PRINTHEX
   // Help functions to display formatted text
   static void PrintHex(const byte *data, const uint32_t numBytes);
   static void PrintHexChar(const byte *pbtData, const uint32_t numBytes);
+#endif
+
+protected:
+  bool waitready(uint16_t timeout);
 
 private:
   int8_t _irq = -1, _reset = -1, _cs = -1;
+#if PN532_ENABLE_MIFARE
   int8_t _uid[7];      // ISO14443A uid
   int8_t _uidLen;      // uid len
   int8_t _key[6];      // Mifare Classic key
-  int8_t _inListedTag; // Tg number of inlisted tag.
+#endif
+  int8_t _inListedTag; // Tg number of the inlisted tag being addressed
+  uint8_t _inListedCount = 0; // targets inlisted by the last inlist
+  uint8_t _inListedIndex = 0; // index of _inListedTag among them
+  uint8_t _inListedTags[PN532_MAX_INLISTED];        // Tg of each target
+  uint8_t _inListedUid[PN532_MAX_INLISTED][10];     // NFCID of each target
+  uint8_t _inListedUidLen[PN532_MAX_INLISTED] = {}; // NFCID lengths
+  uint8_t _inListedTA1[PN532_MAX_INLISTED] = {};    // ATS TA(1) bit rates
+  uint8_t _lastStatus = 0; // status byte of the last failed exchange
+  uint8_t _exchangeError = PN532_EXCHANGE_OK; // see getExchangeError()
+  uint16_t _expectedSW = 0; // SW1 SW2 the next response must end with
+  bool _expectSW = false;   // _expectedSW armed by expectStatusWord()
+  bool _exchangePending = false; // beginDataExchange() awaiting its answer
+
+  // Configuration held by the PN532, to skip identical commands
+  bool _samConfigured = false; // SAM in normal mode
+  int16_t _maxRetries = -1;    // MxRtyPassiveActivation set, -1 if unknown
+  int16_t _wantedRetries = -1; // MxRtyPassiveActivation asked for, -1 if none
+  int16_t _comRetries = -1;    // MxRtyCOM set, -1 if unknown
+  int16_t _wantedComRetries = -1; // MxRtyCOM asked for, -1 if none
 
   // Low level communication functions that handle both SPI and I2C.
   void readdata(uint8_t *buff, uint8_t n);
+  bool readI2CIdle(uint8_t *buff, uint8_t n);
+  uint8_t readframe(uint8_t *buff, uint8_t maxlen);
+  bool readResponse(uint8_t command, PN532Frame *frame);
+  bool exchangeDataFrame(uint8_t tg, const uint8_t *data, uint8_t len,
+                         uint8_t *status, uint8_t *payloadLength);
+  bool sendDataFrame(uint8_t tg, const uint8_t *data, uint8_t len);
+  bool readDataFrame(uint8_t *status, uint8_t *payloadLength);
+  bool sendLeadingFrames(const uint8_t **send, uint8_t *sendLength);
+  bool viewResponse(uint8_t status, uint8_t length, const uint8_t **response,
+                    uint8_t *responseLength);
+  bool readChainedResponse(uint8_t status, uint8_t length, uint8_t *response,
+                           size_t *responseLength);
+  uint8_t dataExchangeChunk(void);
+#if PN532_ENABLE_MIFARE
+  uint8_t writeTagData(uint8_t command, uint8_t address, const uint8_t *data,
+                       uint8_t len);
+#endif
+  uint8_t storeTypeATarget(uint8_t slot, uint8_t pos, uint8_t end);
+  void wakeInterface(void);
   void writecommand(uint8_t *cmd, uint8_t cmdlen);
-  bool isready();
-  bool waitready(uint16_t timeout);
   bool readack();
 
+  bool _irqEnabled = false;          // ready state taken from the IRQ pin
+  volatile bool _irqFired = false;   // set by the IRQ falling edge ISR
+  static Adafruit_PN532 *_irqOwner; // instance served by the ISR
+  static void irqHandler(void);
+  void waitForIRQ(uint16_t maxMs);
+#ifdef PN532_RTOS_WAIT
+  volatile TaskHandle_t _irqWaiter = NULL; // task blocked in waitForIRQ()
+#endif
+
+  uint32_t _ackWaitMicros = 0; // accumulated ACK wait time
+
+  // I2C/SPI timing profile, see setTiming()
+  uint16_t _ackDelayUs = PN532_DEFAULT_ACK_DELAY_US;
+  uint16_t _responseDelayUs = PN532_DEFAULT_RESPONSE_DELAY_US;
+  uint16_t _pollIntervalUs = PN532_DEFAULT_POLL_INTERVAL_US;
+  void pauseMicros(uint16_t us);
+  bool holdSPI(void);
+
+  // Card operation deadlines, see setTimeouts()
+  uint16_t _inListTimeoutMs = PN532_DEFAULT_INLIST_TIMEOUT_MS;
+  uint16_t _exchangeTimeoutMs = PN532_DEFAULT_EXCHANGE_TIMEOUT_MS;
+  bool _timedOut = false; // last failure was a deadline, see timedOut()
+
+  idleCallback_t _idleCallback = NULL; // run between ready polls
+  void *_idleContext = NULL;           // argument of _idleCallback
+
+  // Packet buffer used in various transactions, one per reader so several
+  // instances can share a bus
+  uint8_t pn532_packetbuffer[PN532_PACKBUFFSIZ];
+
+  // HSU receive ring, fed by pumpSerial()
+  uint8_t _rxRing[PN532_HSU_RING_SIZE];
+  volatile uint8_t _rxHead = 0;
+  volatile uint8_t _rxTail = 0;
+  uint8_t readSerial(uint8_t *buff, uint8_t n);
+
   Adafruit_SPIDevice *spi_dev = NULL;
   Adafruit_I2CDevice *i2c_dev = NULL;
   HardwareSerial *ser_dev = NULL;
+  Adafruit_PN532_MockLink *mock_dev = NULL;
+
+  // Bus tests of the hot path, constant with a fixed PN532_TRANSPORT
+#if PN532_TRANSPORT == PN532_TRANSPORT_ANY
+  bool onSPI(void) const { return spi_dev != NULL; }
+  bool onI2C(void) const { return i2c_dev != NULL; }
+  bool onHSU(void) const { return ser_dev != NULL; }
+  bool onMock(void) const { return mock_dev != NULL; }
+#else
+  bool onSPI(void) const { return PN532_TRANSPORT == PN532_TRANSPORT_SPI; }
+  bool onI2C(void) const { return PN532_TRANSPORT == PN532_TRANSPORT_I2C; }
+  bool onHSU(void) const { return PN532_TRANSPORT == PN532_TRANSPORT_HSU; }
+  bool onMock(void) const { return PN532_TRANSPORT == PN532_TRANSPORT_MOCK; }
+#endif
+  // HSU and mock link: frames go through the receive ring
+  bool onStream(void) const { return onHSU() || onMock(); }
+
+  // The bus device is built in place by the constructor, never on the heap
+#if PN532_TRANSPORT == PN532_TRANSPORT_ANY
+  alignas(Adafruit_SPIDevice) alignas(Adafruit_I2CDevice) uint8_t
+      _busStorage[(sizeof(Adafruit_SPIDevice) > sizeof(Adafruit_I2CDevice))
+                      ? sizeof(Adafruit_SPIDevice)
+                      : sizeof(Adafruit_I2CDevice)];
+#elif PN532_TRANSPORT == PN532_TRANSPORT_SPI
+  alignas(Adafruit_SPIDevice) uint8_t _busStorage[sizeof(Adafruit_SPIDevice)];
+#elif PN532_TRANSPORT == PN532_TRANSPORT_I2C
+  alignas(Adafruit_I2CDevice) uint8_t _busStorage[sizeof(Adafruit_I2CDevice)];
+#endif
+
+  // spi_dev/i2c_dev point into _busStorage: not copyable
+  Adafruit_PN532(const Adafruit_PN532 &);
+  Adafruit_PN532 &operator=(const Adafruit_PN532 &);
+};
+
+/**
+ * @brief Round-robin card detection over several PN532 readers, typically
+ *        sharing one SPI bus with a distinct SS pin each.
+ */
+class Adafruit_PN532_Scheduler {
+public:
+  Adafruit_PN532_Scheduler(Adafruit_PN532 **readers, uint8_t count,
+                           uint8_t cardbaudrate = PN532_MIFARE_ISO14443A);
+  void begin(void);
+  int8_t poll(uint8_t *uid, uint8_t *uidLength);
+  void rearm(uint8_t reader);
+
+private:
+  Adafruit_PN532 **_readers; // readers served in turn
+  uint8_t _count;            // number of readers, at most 32
+  uint8_t _next = 0;         // reader visited by the next poll()
+  uint8_t _baud;             // card baud rate passed to InListPassiveTarget
+  uint32_t _armed = 0;       // readers with a detection in progress
+  uint32_t _held = 0;        // readers waiting for rearm() after a card
 };
 
 #endif
@@ -0,0 +1,57 @@
+/**************************************************************************/
+/*!
+    @file     readMultipleReaders.ino
+    @author   Adafruit Industries
+    @license  BSD (see license.txt)
+
+    This example watches four PN532 breakouts sharing one hardware SPI
+    bus. Each reader has its own SS pin; SCK, MISO and MOSI are common.
+
+    The readers search for ISO14443A cards in parallel. The scheduler
+    visits them in turn and reports the UID of any card that shows up,
+    then restarts the detection on that reader.
+*/
+/**************************************************************************/
+#include <SPI.h>
+#include <Adafruit_PN532.h>
+
+#define READER_COUNT (4)
+
+Adafruit_PN532 nfc0(7);
+Adafruit_PN532 nfc1(8);
+Adafruit_PN532 nfc2(9);
+Adafruit_PN532 nfc3(10);
+
+Adafruit_PN532 *readers[READER_COUNT] = {&nfc0, &nfc1, &nfc2, &nfc3};
+Adafruit_PN532_Scheduler scheduler(readers, READER_COUNT);
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // for Leonardo/Micro/Zero
+
+  for (uint8_t i = 0; i < READER_COUNT; i++) {
+    readers[i]->begin();
+    if (!readers[i]->getFirmwareVersion()) {
+      Serial.print("Didn't find PN53x board #");
+      Serial.println(i);
+      while (1); // halt
+    }
+  }
+
+  scheduler.begin();
+  Serial.println("Waiting for an ISO14443A card on any reader ...");
+}
+
+void loop(void) {
+  uint8_t uid[7];
+  uint8_t uidLength;
+
+  int8_t reader = scheduler.poll(uid, &uidLength);
+  if (reader >= 0) {
+    Serial.print("Reader #");
+    Serial.print(reader);
+    Serial.print(" UID:");
+    Adafruit_PN532::PrintHex(uid, uidLength);
+    scheduler.rearm(reader);
+  }
+}
@@ -26,6 +26,7 @@ This example runs tests on the BLAKE2s implementation to verify correct behaviou
 
 #include <Crypto.h>
 #include <BLAKE2s.h>
+#include <BLAKE2sMAC.h>
 #include <string.h>
 #if defined(ESP8266) || defined(ESP32)
 #include <pgmspace.h>
@@ -308,6 +309,79 @@ void testRFC7693()
         Serial.println("Failed");
 }
 
+void testMAC()
+{
+    static size_t const lengths[] = {0, 1, 59, 60, 64, 65, 128};
+    BLAKE2sMAC mac;
+    uint8_t key[32];
+    uint8_t tag[HASH_SIZE];
+    uint8_t expected[HASH_SIZE];
+    uint8_t label[4] = {0x78, 0x56, 0x34, 0x12};
+    bool ok = true;
+
+    Serial.print("BLAKE2sMAC ... ");
+
+    for (size_t posn = 0; posn < sizeof(buffer); ++posn)
+        buffer[posn] = (uint8_t)(posn * 7);
+    for (size_t posn = 0; posn < sizeof(key); ++posn)
+        key[posn] = (uint8_t)(0x40 + posn);
+
+    // Tags must match the plain BLAKE2s keyed hash, cached key or not.
+    mac.setKey(key, sizeof(key), 20);
+    for (size_t index = 0; index < sizeof(lengths) / sizeof(lengths[0]); ++index) {
+        blake2s.reset(key, sizeof(key), 20);
+        blake2s.update(buffer, lengths[index]);
+        blake2s.finalize(expected, 20);
+        mac.mac(tag, buffer, lengths[index]);
+        if (memcmp(tag, expected, 20) != 0)
+            ok = false;
+    }
+
+    // A sealed record is the keyed hash of the label and the data.
+    mac.setKey(key, 16);
+    mac.seal(buffer, 40, 0x12345678);
+    blake2s.reset(key, 16, BLAKE2sMAC::TAG_SIZE);
+    blake2s.update(label, sizeof(label));
+    blake2s.update(buffer, 40);
+    blake2s.finalize(expected, BLAKE2sMAC::TAG_SIZE);
+    if (memcmp(buffer + 40, expected, BLAKE2sMAC::TAG_SIZE) != 0)
+        ok = false;
+    if (!mac.open(buffer, 40, 0x12345678))
+        ok = false;
+    if (mac.open(buffer, 40, 0x12345679))
+        ok = false;
+    buffer[3] ^= 0x01;
+    if (mac.open(buffer, 40, 0x12345678))
+        ok = false;
+
+    if (ok)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
+void perfMAC()
+{
+    BLAKE2sMAC mac;
+    unsigned long start;
+    unsigned long elapsed;
+    int count;
+
+    Serial.print("BLAKE2sMAC 48-byte record ... ");
+
+    mac.setKey(buffer, 32);
+    start = micros();
+    for (count = 0; count < 1000; ++count) {
+        mac.seal(buffer, 48, count);
+    }
+    elapsed = micros() - start;
+
+    Serial.print(elapsed / 1000.0);
+    Serial.print("us per op, ");
+    Serial.print((1000.0 * 1000000.0) / elapsed);
+    Serial.println(" ops per second");
+}
+
 void perfFinalize(Hash *hash)
 {
     unsigned long start;
@@ -414,6 +488,7 @@ void setup()
     testHMAC(&blake2s, BLOCK_SIZE + 1);
     testHMAC(&blake2s, sizeof(buffer));
     testRFC7693();
+    testMAC();
 
     Serial.println();
 
@@ -422,6 +497,7 @@ void setup()
     perfFinalize(&blake2s);
     perfKeyed(&blake2s);
     perfHMAC(&blake2s);
+    perfMAC();
 }
 
 void loop()
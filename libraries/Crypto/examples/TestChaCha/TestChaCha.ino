@@ -222,6 +222,9 @@ TestVector testVector;
 ChaCha chacha;
 
 byte buffer[128];
+byte bulkInput[259];
+byte bulkOutput[259];
+byte bulkExpected[259];
 
 bool testCipher_N(ChaCha *cipher, const struct TestVector *test, size_t inc)
 {
@@ -301,6 +304,45 @@ void testCipher(ChaCha *cipher, const struct TestVector *test)
         Serial.println("Failed");
 }
 
+// Checks that bulk encryption, which may use the multi-block keystream
+// path, matches byte-at-a-time encryption for aligned and unaligned
+// buffers and for data that starts part way through a block.
+void testBulk(ChaCha *cipher, const struct TestVector *test, size_t offset, size_t prefix)
+{
+    size_t len = sizeof(bulkInput) - offset;
+    size_t posn;
+
+    memcpy_P(&testVector, test, sizeof(TestVector));
+    test = &testVector;
+
+    Serial.print(test->name);
+    Serial.print(" Bulk ");
+    Serial.print(offset);
+    Serial.print("/");
+    Serial.print(prefix);
+    Serial.print(" ... ");
+
+    for (posn = 0; posn < sizeof(bulkInput); ++posn)
+        bulkInput[posn] = (byte)(posn * 37 + 11);
+
+    cipher->setNumRounds(test->rounds);
+    cipher->setKey(test->key, test->keySize);
+    cipher->setIV(test->iv, cipher->ivSize());
+    for (posn = 0; posn < len; ++posn)
+        cipher->encrypt(bulkExpected + offset + posn, bulkInput + offset + posn, 1);
+
+    memset(bulkOutput, 0xBA, sizeof(bulkOutput));
+    cipher->setKey(test->key, test->keySize);
+    cipher->setIV(test->iv, cipher->ivSize());
+    cipher->encrypt(bulkOutput + offset, bulkInput + offset, prefix);
+    cipher->encrypt(bulkOutput + offset + prefix, bulkInput + offset + prefix, len - prefix);
+
+    if (memcmp(bulkOutput + offset, bulkExpected + offset, len) == 0)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
 void perfCipherSetKey(ChaCha *cipher, const struct TestVector *test)
 {
     unsigned long start;
@@ -405,6 +447,11 @@ void setup()
     testCipher(&chacha, &testVectorChaCha12_256);
     testCipher(&chacha, &testVectorChaCha8_128);
     testCipher(&chacha, &testVectorChaCha8_256);
+    testBulk(&chacha, &testVectorChaCha20_256, 0, 0);
+    testBulk(&chacha, &testVectorChaCha20_256, 1, 0);
+    testBulk(&chacha, &testVectorChaCha20_256, 0, 64);
+    testBulk(&chacha, &testVectorChaCha20_256, 3, 5);
+    testBulk(&chacha, &testVectorChaCha8_128, 0, 0);
 
     Serial.println();
 
@@ -262,6 +262,50 @@ bool testCipher_N(ChaChaPoly *cipher, const struct TestVector *test, size_t inc)
     return true;
 }
 
+bool testCipher_seal(ChaChaPoly *cipher, const struct TestVector *test)
+{
+    uint8_t tag[16];
+
+    cipher->clear();
+    cipher->setKey(test->key, 32);
+    cipher->setIV(test->iv, test->ivsize);
+
+    memcpy(buffer, test->plaintext, test->datasize);
+    cipher->seal(buffer, test->datasize, test->authdata, test->authsize, tag);
+    if (memcmp(buffer, test->ciphertext, test->datasize) != 0) {
+        Serial.print("seal ");
+        return false;
+    }
+    if (memcmp(tag, test->tag, sizeof(tag)) != 0) {
+        Serial.print("seal tag ");
+        return false;
+    }
+
+    cipher->setKey(test->key, 32);
+    cipher->setIV(test->iv, test->ivsize);
+    if (!cipher->open(buffer, test->datasize, test->authdata, test->authsize, tag)) {
+        Serial.print("open ");
+        return false;
+    }
+    if (memcmp(buffer, test->plaintext, test->datasize) != 0)
+        return false;
+
+    // A corrupted tag must fail and wipe the buffer.
+    memcpy(buffer, test->ciphertext, test->datasize);
+    tag[0] ^= 0x01;
+    cipher->setIV(test->iv, test->ivsize);
+    if (cipher->open(buffer, test->datasize, test->authdata, test->authsize, tag)) {
+        Serial.print("open accepted bad tag ");
+        return false;
+    }
+    for (size_t posn = 0; posn < test->datasize; ++posn) {
+        if (buffer[posn] != 0)
+            return false;
+    }
+
+    return true;
+}
+
 void testCipher(ChaChaPoly *cipher, const struct TestVector *test)
 {
     bool ok;
@@ -279,6 +323,7 @@ void testCipher(ChaChaPoly *cipher, const struct TestVector *test)
     ok &= testCipher_N(cipher, test, 8);
     ok &= testCipher_N(cipher, test, 13);
     ok &= testCipher_N(cipher, test, 16);
+    ok &= testCipher_seal(cipher, test);
 
     if (ok)
         Serial.println("Passed");
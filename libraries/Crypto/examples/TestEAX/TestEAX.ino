@@ -235,6 +235,33 @@ static TestVector const testVectorEAX10 PROGMEM = {
     .ivsize      = 16
 };
 
+// CMAC test vectors for AES-128 from RFC 4493, which are OMAC1 with no tag.
+static uint8_t const testCMACKey[16] PROGMEM = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+static uint8_t const testCMACMessage[64] PROGMEM = {
+    0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96,
+    0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+    0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C,
+    0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+    0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11,
+    0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+    0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17,
+    0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+};
+static uint8_t const testCMACTags[4][16] PROGMEM = {
+    {0xBB, 0x1D, 0x69, 0x29, 0xE9, 0x59, 0x37, 0x28,
+     0x7F, 0xA3, 0x7D, 0x12, 0x9B, 0x75, 0x67, 0x46},
+    {0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44,
+     0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C},
+    {0xDF, 0xA6, 0x67, 0x47, 0xDE, 0x9A, 0xE6, 0x30,
+     0x30, 0xCA, 0x32, 0x61, 0x14, 0x97, 0xC8, 0x27},
+    {0x51, 0xF0, 0xBE, 0xBF, 0x7E, 0x3B, 0x9D, 0x92,
+     0xFC, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3C, 0xFE}
+};
+static size_t const testCMACSizes[4] = {0, 16, 40, 64};
+
 TestVector testVector;
 
 EAX<AES128> *eax;
@@ -504,6 +531,49 @@ void perfCipher(AuthenticatedCipher *cipher, const struct TestVector *test, cons
     perfCipherComputeTag(cipher, test, cipherName);
 }
 
+void testCMAC()
+{
+    AES128 aes;
+    OMAC cmac;
+    uint8_t key[16];
+    uint8_t message[64];
+    uint8_t expected[16];
+    uint8_t mac[16];
+    bool ok = true;
+
+    Serial.print("CMAC-AES-128 ... ");
+
+    memcpy_P(key, testCMACKey, sizeof(key));
+    memcpy_P(message, testCMACMessage, sizeof(message));
+    aes.setKey(key, sizeof(key));
+    cmac.setBlockCipher(&aes);
+    cmac.initKey();
+
+    // Hash each message in one call and then as a 5-byte header
+    // followed by the body, reusing the subkeys from initKey().
+    for (uint8_t index = 0; index < 4; ++index) {
+        size_t size = testCMACSizes[index];
+        size_t split = size < 5 ? size : 5;
+        memcpy_P(expected, testCMACTags[index], sizeof(expected));
+
+        cmac.initCMAC(mac);
+        cmac.update(mac, message, size);
+        cmac.finalize(mac);
+        ok &= !memcmp(mac, expected, sizeof(mac));
+
+        cmac.initCMAC(mac);
+        cmac.update(mac, message, split);
+        cmac.update(mac, message + split, size - split);
+        cmac.finalize(mac);
+        ok &= !memcmp(mac, expected, sizeof(mac));
+    }
+
+    if (ok)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
 void setup()
 {
     Serial.begin(9600);
@@ -533,6 +603,7 @@ void setup()
     testCipher(eax, &testVectorEAX8);
     testCipher(eax, &testVectorEAX9);
     testCipher(eax, &testVectorEAX10);
+    testCMAC();
 
     Serial.println();
 
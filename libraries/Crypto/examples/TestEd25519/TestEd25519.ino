@@ -87,6 +87,27 @@ static TestVector const testVectorEd25519_2 PROGMEM = {
 
 static TestVector testVector;
 
+// Encodings of points of small order: the neutral point (order 1),
+// (0, -1) (order 2), and two points of order 8.
+static uint8_t const smallOrderPoints[4][32] PROGMEM = {
+    {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xec, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f},
+    {0x26, 0xe8, 0x95, 0x8f, 0xc2, 0xb2, 0x27, 0xb0,
+     0x45, 0xc3, 0xf4, 0x89, 0xf2, 0xef, 0x98, 0xf0,
+     0xd5, 0xdf, 0xac, 0x05, 0xd3, 0xc6, 0x33, 0x39,
+     0xb1, 0x38, 0x02, 0x88, 0x6d, 0x53, 0xfc, 0x05},
+    {0xc7, 0x17, 0x6a, 0x70, 0x3d, 0x4d, 0xd8, 0x4f,
+     0xba, 0x3c, 0x0b, 0x76, 0x0d, 0x10, 0x67, 0x0f,
+     0x2a, 0x20, 0x53, 0xfa, 0x2c, 0x39, 0xcc, 0xc6,
+     0x4e, 0xc7, 0xfd, 0x77, 0x92, 0xac, 0x03, 0x7a}
+};
+
 void printNumber(const char *name, const uint8_t *x, uint8_t len)
 {
     static const char hexchars[] = "0123456789ABCDEF";
@@ -166,6 +187,92 @@ void testFixedVectors()
     testFixedVectors(&testVectorEd25519_2);
 }
 
+void testBatch()
+{
+    static uint8_t const numSignatures = 4;
+    uint8_t privateKey[32];
+    uint8_t publicKeys[numSignatures][32];
+    uint8_t messages[numSignatures][8];
+    uint8_t signatures[numSignatures][64];
+    const uint8_t *signaturePtrs[numSignatures];
+    const uint8_t *publicKeyPtrs[numSignatures];
+    const void *messagePtrs[numSignatures];
+    size_t lens[numSignatures];
+    uint8_t i;
+
+    // Sign a few messages under different keys.
+    for (i = 0; i < numSignatures; ++i) {
+        Ed25519::generatePrivateKey(privateKey);
+        Ed25519::derivePublicKey(publicKeys[i], privateKey);
+        memset(messages[i], 'a' + i, sizeof(messages[i]));
+        Ed25519::sign(signatures[i], privateKey, publicKeys[i],
+                      messages[i], sizeof(messages[i]));
+        signaturePtrs[i] = signatures[i];
+        publicKeyPtrs[i] = publicKeys[i];
+        messagePtrs[i] = messages[i];
+        lens[i] = sizeof(messages[i]);
+    }
+
+    Serial.print("verify batch ... ");
+    Serial.flush();
+    unsigned long start = micros();
+    bool verified = Ed25519::verifyBatch(numSignatures, signaturePtrs,
+                                         publicKeyPtrs, messagePtrs, lens);
+    unsigned long elapsed = micros() - start;
+    if (verified) {
+        Serial.print("ok");
+    } else {
+        Serial.print("failed");
+    }
+    Serial.print(" (elapsed ");
+    Serial.print(elapsed);
+    Serial.println(" us)");
+
+    // Corrupting any one signature must fail the whole batch.
+    Serial.print("verify batch corrupted ... ");
+    Serial.flush();
+    signatures[2][40] ^= 0x01;
+    if (!Ed25519::verifyBatch(numSignatures, signaturePtrs,
+                              publicKeyPtrs, messagePtrs, lens)) {
+        Serial.println("ok");
+    } else {
+        Serial.println("failed");
+    }
+}
+
+void testSmallOrder()
+{
+    uint8_t publicKey[32];
+    uint8_t signature[64];
+    uint8_t message[8];
+    const uint8_t *signaturePtr = signature;
+    const uint8_t *publicKeyPtr = publicKey;
+    const void *messagePtr = message;
+    size_t len = sizeof(message);
+    uint8_t i;
+
+    // A = R = T and s = 0 satisfies 8 * s * B = 8 * R + 8 * k * A for
+    // any message, so both verify() and verifyBatch() must reject it.
+    memset(message, 'x', sizeof(message));
+    for (i = 0; i < 4; ++i) {
+        memcpy_P(publicKey, smallOrderPoints[i], 32);
+        memcpy(signature, publicKey, 32);
+        memset(signature + 32, 0, 32);
+
+        Serial.print("verify small order ");
+        Serial.print(i);
+        Serial.print(" ... ");
+        bool single = Ed25519::verify(signature, publicKey, message, len);
+        bool batch = Ed25519::verifyBatch(1, &signaturePtr, &publicKeyPtr,
+                                          &messagePtr, &len);
+        if (!single && !batch) {
+            Serial.println("ok");
+        } else {
+            Serial.println("failed");
+        }
+    }
+}
+
 void setup()
 {
     Serial.begin(9600);
@@ -177,6 +284,8 @@ void setup()
 
     // Perform the tests.
     testFixedVectors();
+    testBatch();
+    testSmallOrder();
     Serial.println();
 }
 
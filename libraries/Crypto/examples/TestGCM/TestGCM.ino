@@ -267,6 +267,9 @@ GCM<AES192> *gcmaes192 = 0;
 GCM<AES256> *gcmaes256 = 0;
 GCM<Speck> *gcmspeck = 0;
 GCM<SpeckTiny> *gcmspecklm = 0;
+#if !defined(__AVR__)
+GHASH::Table hashTable;
+#endif
 
 byte buffer[128];
 
@@ -554,6 +557,21 @@ void setup()
     gcmaes256 = new GCM<AES256>();
     testCipher(gcmaes256, &testVectorGCM16);
     delete gcmaes256;
+#if !defined(__AVR__)
+    Serial.println("Table-driven GHASH:");
+    gcmaes128 = new GCM<AES128>();
+    gcmaes128->setHashTable(&hashTable);
+    testCipher(gcmaes128, &testVectorGCM1);
+    testCipher(gcmaes128, &testVectorGCM2);
+    testCipher(gcmaes128, &testVectorGCM3);
+    testCipher(gcmaes128, &testVectorGCM4);
+    testCipher(gcmaes128, &testVectorGCM5);
+    delete gcmaes128;
+    gcmaes256 = new GCM<AES256>();
+    gcmaes256->setHashTable(&hashTable);
+    testCipher(gcmaes256, &testVectorGCM16);
+    delete gcmaes256;
+#endif
 
     Serial.println();
 
@@ -569,6 +587,12 @@ void setup()
     perfCipher(gcmaes256, &testVectorGCM16, testVectorGCM16.name);
     delete gcmaes256;
 #endif
+#if !defined(__AVR__)
+    gcmaes256 = new GCM<AES256>();
+    gcmaes256->setHashTable(&hashTable);
+    perfCipher(gcmaes256, &testVectorGCM16, "AES-256 GCM (table GHASH)");
+    delete gcmaes256;
+#endif
 #if defined(TEST_SPECK) || !defined(__AVR__)
     gcmspeck = new GCM<Speck>();
     perfCipher(gcmspeck, &testVectorGCM16, "GCM-Speck-256");
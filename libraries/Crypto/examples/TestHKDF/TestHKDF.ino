@@ -78,6 +78,7 @@ static TestHKDFVector const testVectorHKDF_1 = {
 };
 
 HKDF<SHA256> hkdf_context;
+HKDFT<SHA256> hkdft_context;
 
 uint8_t buffer[128];
 
@@ -123,6 +124,119 @@ void testHKDF(HKDFCommon *hkdf, const TestHKDFVector *test)
         Serial.println("Failed");
 }
 
+void testHKDFT(const TestHKDFVector *test)
+{
+    size_t size = test->out_len;
+    size_t posn, len;
+    bool ok;
+
+    Serial.print(test->name);
+    Serial.print(" static ... ");
+
+    hkdft_context.setKey(test->key, test->key_len, test->salt, test->salt_len);
+    for (posn = 0; posn < size; posn += 13) {
+        len = size - posn;
+        if (len > 13)
+            len = 13;
+        hkdft_context.extract(buffer + posn, len, test->info, test->info_len);
+    }
+    ok = memcmp(buffer, test->out, test->out_len) == 0;
+
+    memset(buffer, 0, sizeof(buffer));
+    hkdf<SHA256>(buffer, test->out_len, test->key, test->key_len,
+                 test->salt, test->salt_len, test->info, test->info_len);
+    ok &= memcmp(buffer, test->out, test->out_len) == 0;
+
+    if (ok)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
+// Session style derivation: one extract, then several labelled outputs.
+// Each output must match a fresh one-shot hkdf() with the same label.
+void testHKDFExpandMany(HKDFCommon *context, const TestHKDFVector *test, bool cached)
+{
+    static const char label0[] = "enc";
+    static const char label1[] = "mac";
+    uint8_t key0[32];
+    uint8_t key1[16];
+    uint8_t expected[42];
+    const void *info[3] = {label0, label1, test->info};
+    const size_t infoLen[3] = {3, 3, test->info_len};
+    void *out[3] = {key0, key1, buffer};
+    const size_t outLen[3] = {sizeof(key0), sizeof(key1), test->out_len};
+    bool ok;
+
+    Serial.print(test->name);
+    Serial.print(cached ? " expandMany static ... " : " expandMany ... ");
+
+    memset(buffer, 0, sizeof(buffer));
+    if (cached) {
+        hkdft_context.setKey(test->key, test->key_len, test->salt, test->salt_len);
+        hkdft_context.expandMany(info, infoLen, out, outLen, 3);
+    } else {
+        context->setKey(test->key, test->key_len, test->salt, test->salt_len);
+        context->expandMany(info, infoLen, out, outLen, 3);
+    }
+    ok = memcmp(buffer, test->out, test->out_len) == 0;
+
+    hkdf<SHA256>(expected, sizeof(key0), test->key, test->key_len,
+                 test->salt, test->salt_len, label0, 3);
+    ok &= memcmp(key0, expected, sizeof(key0)) == 0;
+    hkdf<SHA256>(expected, sizeof(key1), test->key, test->key_len,
+                 test->salt, test->salt_len, label1, 3);
+    ok &= memcmp(key1, expected, sizeof(key1)) == 0;
+
+    // A single expand() after expandMany() starts again from the PRK.
+    memset(buffer, 0, sizeof(buffer));
+    if (cached)
+        hkdft_context.expand(buffer, test->out_len, test->info, test->info_len);
+    else
+        context->expand(buffer, test->out_len, test->info, test->info_len);
+    ok &= memcmp(buffer, test->out, test->out_len) == 0;
+
+    if (ok)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
+void perfHKDF()
+{
+    static const char label0[] = "enc";
+    static const char label1[] = "mac";
+    uint8_t key0[32];
+    uint8_t key1[32];
+    const void *info[2] = {label0, label1};
+    const size_t infoLen[2] = {3, 3};
+    void *out[2] = {key0, key1};
+    const size_t outLen[2] = {sizeof(key0), sizeof(key1)};
+    unsigned long start;
+    unsigned long elapsed;
+    int count;
+
+    Serial.print("Two Session Keys ... ");
+    start = micros();
+    for (count = 0; count < 100; ++count) {
+        hkdf_context.setKey(key_1, sizeof(key_1), salt_1, sizeof(salt_1));
+        hkdf_context.expandMany(info, infoLen, out, outLen, 2);
+    }
+    elapsed = micros() - start;
+    Serial.print(elapsed / 100.0);
+    Serial.println("us per derivation");
+
+    Serial.print("Two Session Keys Static ... ");
+    start = micros();
+    for (count = 0; count < 100; ++count) {
+        hkdft_context.setKey(key_1, sizeof(key_1), salt_1, sizeof(salt_1));
+        hkdft_context.expandMany(info, infoLen, out, outLen, 2);
+    }
+    elapsed = micros() - start;
+    Serial.print(elapsed / 100.0);
+    Serial.println("us per derivation");
+}
+
 void setup()
 {
     Serial.begin(9600);
@@ -137,6 +251,15 @@ void setup()
 
     Serial.println("Test Vectors:");
     testHKDF(&hkdf_context, &testVectorHKDF_1);
+    testHKDFT(&testVectorHKDF_1);
+    testHKDF(&hkdft_context, &testVectorHKDF_1);
+    testHKDFExpandMany(&hkdf_context, &testVectorHKDF_1, false);
+    testHKDFExpandMany(&hkdf_context, &testVectorHKDF_1, true);
+    testHKDFExpandMany(&hkdft_context, &testVectorHKDF_1, false);
+    Serial.println();
+
+    Serial.println("Performance Tests:");
+    perfHKDF();
     Serial.println();
 }
 
@@ -26,6 +26,8 @@ This example runs tests on the SHA256 implementation to verify correct behaviour
 
 #include <Crypto.h>
 #include <SHA256.h>
+#include <HMACKey.h>
+#include <SHA256Multi.h>
 #include <string.h>
 
 #define HASH_SIZE 32
@@ -211,6 +213,114 @@ void testHMAC(Hash *hash, const struct TestHashVector *test)
         Serial.println("Failed");
 }
 
+void testHMACKey(const struct TestHashVector *test)
+{
+    HMACKey<SHA256> key;
+    SHA256 hash;
+    uint8_t result[HASH_SIZE];
+
+    Serial.print(test->name);
+    Serial.print(" (cached key) ... ");
+
+    // Compute the HMAC twice to check that the cached states are reused.
+    key.setKey(test->key, strlen(test->key));
+    key.reset(hash);
+    hash.update(test->data, strlen(test->data));
+    key.finalize(hash, result, sizeof(result));
+    if (!memcmp(result, test->hash, HASH_SIZE)) {
+        memset(result, 0xAA, sizeof(result));
+        key.mac(result, sizeof(result), test->data, strlen(test->data));
+    }
+
+    if (!memcmp(result, test->hash, HASH_SIZE))
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
+void testHashMany()
+{
+    // Lengths on both sides of the one and two padding block cases.
+    static size_t const lens[8] = {0, 1, 55, 56, 63, 64, 119, 128};
+    const void *messages[8];
+    uint8_t results[8][HASH_SIZE];
+    uint8_t *hashes[8];
+    uint8_t expected[HASH_SIZE];
+    bool ok = true;
+    size_t count, index;
+
+    Serial.print("SHA-256 hashMany ... ");
+
+    for (index = 0; index < sizeof(buffer); ++index)
+        buffer[index] = (uint8_t)(index * 13 + 5);
+    for (index = 0; index < 8; ++index) {
+        messages[index] = buffer + sizeof(buffer) - lens[index];
+        hashes[index] = results[index];
+    }
+
+    // Odd counts leave a lane to finish on its own.
+    for (count = 1; count <= 8; ++count) {
+        memset(results, 0xAA, sizeof(results));
+        SHA256Multi::hashMany(count, hashes, messages, lens);
+        for (index = 0; index < count; ++index) {
+            sha256.reset();
+            sha256.update(messages[index], lens[index]);
+            sha256.finalize(expected, sizeof(expected));
+            if (memcmp(results[index], expected, HASH_SIZE) != 0)
+                ok = false;
+        }
+    }
+
+    if (ok)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
+void perfHashMany()
+{
+    const void *messages[8];
+    size_t lens[8];
+    uint8_t results[8][HASH_SIZE];
+    uint8_t *hashes[8];
+    unsigned long start;
+    unsigned long elapsed;
+    int count;
+
+    Serial.print("48-byte records, one by one ... ");
+
+    start = micros();
+    for (count = 0; count < 1000; ++count) {
+        sha256.reset();
+        sha256.update(buffer, 48);
+        sha256.finalize(results[0], HASH_SIZE);
+    }
+    elapsed = micros() - start;
+
+    Serial.print(elapsed / 1000.0);
+    Serial.print("us per record, ");
+    Serial.print((1000.0 * 1000000.0) / elapsed);
+    Serial.println(" records per second");
+
+    Serial.print("48-byte records, hashMany ... ");
+
+    for (count = 0; count < 8; ++count) {
+        messages[count] = buffer + count * 10;
+        lens[count] = 48;
+        hashes[count] = results[count];
+    }
+    start = micros();
+    for (count = 0; count < 125; ++count) {
+        SHA256Multi::hashMany(8, hashes, messages, lens);
+    }
+    elapsed = micros() - start;
+
+    Serial.print(elapsed / 1000.0);
+    Serial.print("us per record, ");
+    Serial.print((1000.0 * 1000000.0) / elapsed);
+    Serial.println(" records per second");
+}
+
 void perfHash(Hash *hash)
 {
     unsigned long start;
@@ -293,6 +403,21 @@ void perfHMAC(Hash *hash)
     Serial.print("us per op, ");
     Serial.print((1000.0 * 1000000.0) / elapsed);
     Serial.println(" ops per second");
+
+    Serial.print("HMAC Cached Key ... ");
+
+    HMACKey<SHA256> key;
+    key.setKey(buffer, HASH_SIZE);
+    start = micros();
+    for (count = 0; count < 1000; ++count) {
+        key.mac(buffer, HASH_SIZE, "abc", 3);
+    }
+    elapsed = micros() - start;
+
+    Serial.print(elapsed / 1000.0);
+    Serial.print("us per op, ");
+    Serial.print((1000.0 * 1000000.0) / elapsed);
+    Serial.println(" ops per second");
 }
 
 void setup()
@@ -310,12 +435,15 @@ void setup()
     testHash(&sha256, &testVectorSHA256_2);
     testHMAC(&sha256, &testVectorHMAC_SHA256_1);
     testHMAC(&sha256, &testVectorHMAC_SHA256_2);
+    testHMACKey(&testVectorHMAC_SHA256_1);
+    testHMACKey(&testVectorHMAC_SHA256_2);
     testHMAC(&sha256, (size_t)0);
     testHMAC(&sha256, 1);
     testHMAC(&sha256, HASH_SIZE);
     testHMAC(&sha256, BLOCK_SIZE);
     testHMAC(&sha256, BLOCK_SIZE + 1);
     testHMAC(&sha256, sizeof(buffer));
+    testHashMany();
 
     Serial.println();
 
@@ -323,6 +451,7 @@ void setup()
     perfHash(&sha256);
     perfFinalize(&sha256);
     perfHMAC(&sha256);
+    perfHashMany();
 }
 
 void loop()
@@ -124,6 +124,29 @@ void testHash(Hash *hash, const struct TestHashVector *test)
         Serial.println("Failed");
 }
 
+void testDigestV(Hash *hash, const struct TestHashVector *test)
+{
+    size_t size = strlen(test->data);
+    uint8_t first[HASH_SIZE / 2];
+    uint8_t second[HASH_SIZE / 2];
+    HashInput in[3] = {
+        {test->data, size / 3},
+        {test->data + size / 3, size / 3},
+        {test->data + 2 * (size / 3), size - 2 * (size / 3)}
+    };
+    HashOutput out[2] = {{first, sizeof(first)}, {second, sizeof(second)}};
+
+    Serial.print(test->name);
+    Serial.print(" digestv ... ");
+
+    hash->digestv(in, 3, out, 2);
+    if (memcmp(first, test->hash, sizeof(first)) == 0 &&
+            memcmp(second, test->hash + sizeof(first), sizeof(second)) == 0)
+        Serial.println("Passed");
+    else
+        Serial.println("Failed");
+}
+
 void perfHash(Hash *hash)
 {
     unsigned long start;
@@ -247,6 +270,7 @@ void setup()
     testHash(&sha512, &testVectorSHA512_1);
     testHash(&sha512, &testVectorSHA512_2);
     testHash(&sha512, &testVectorSHA512_3);
+    testDigestV(&sha512, &testVectorSHA512_3);
     testHMAC(&sha512, (size_t)0);
     testHMAC(&sha512, 1);
     testHMAC(&sha512, HASH_SIZE);
@@ -262,6 +262,49 @@ void testXTS(XTSCommon *cipher, const struct TestVector *test)
         printlnProgMem("Failed");
 }
 
+// The vectors' tweaks are little-endian data unit numbers, so they double
+// as sector numbers for the multi-sector API.
+void testXTSSectors(XTSCommon *cipher, const struct TestVector *test)
+{
+    static byte multi[MAX_SECTOR_SIZE * 3];
+    uint64_t sector = 0;
+    bool ok;
+
+    crypto_feed_watchdog();
+
+    memcpy_P(&testVector, test, sizeof(testVector));
+    for (uint8_t posn = 8; posn > 0; --posn)
+        sector = (sector << 8) | testVector.tweak[posn - 1];
+
+    Serial.print(testVector.name);
+    printProgMem(" Sectors ... ");
+
+    cipher->setSectorSize(testVector.sectorSize);
+    cipher->setKey(testVector.key1, 32);
+    cipher->encryptSectors(buffer, testVector.plaintext, sector, 1);
+    ok = !memcmp(buffer, testVector.ciphertext, testVector.sectorSize);
+    cipher->decryptSectors(buffer, testVector.ciphertext, sector, 1);
+    ok &= !memcmp(buffer, testVector.plaintext, testVector.sectorSize);
+
+    // Three consecutive sectors in one call, with the vector's sector in
+    // the middle, against one sector at a time.
+    for (uint8_t index = 0; index < 3; ++index)
+        memcpy(multi + index * testVector.sectorSize, testVector.plaintext, testVector.sectorSize);
+    cipher->encryptSectors(multi, multi, sector - 1, 3);
+    ok &= !memcmp(multi + testVector.sectorSize, testVector.ciphertext, testVector.sectorSize);
+    cipher->encryptSectors(buffer, testVector.plaintext, sector + 1, 1);
+    ok &= !memcmp(multi + 2 * testVector.sectorSize, buffer, testVector.sectorSize);
+    ok &= memcmp(multi, multi + 2 * testVector.sectorSize, testVector.sectorSize) != 0;
+    cipher->decryptSectors(multi, multi, sector - 1, 3);
+    for (uint8_t index = 0; index < 3; ++index)
+        ok &= !memcmp(multi + index * testVector.sectorSize, testVector.plaintext, testVector.sectorSize);
+
+    if (ok)
+        printlnProgMem("Passed");
+    else
+        printlnProgMem("Failed");
+}
+
 void perfEncrypt(const char *name, XTSCommon *cipher, const struct TestVector *test, size_t keySize = 32)
 {
     unsigned long start;
@@ -406,6 +449,11 @@ void setup()
     testXTS(xtsaes128, &testVectorXTSAES128_4);
     testXTS(xtsaes128, &testVectorXTSAES128_15);
     testXTS(xtsaes128, &testVectorXTSAES128_16);
+    testXTSSectors(xtsaes128, &testVectorXTSAES128_1);
+    testXTSSectors(xtsaes128, &testVectorXTSAES128_2);
+    testXTSSectors(xtsaes128, &testVectorXTSAES128_4);
+    testXTSSectors(xtsaes128, &testVectorXTSAES128_15);
+    testXTSSectors(xtsaes128, &testVectorXTSAES128_16);
 
     Serial.println();
 
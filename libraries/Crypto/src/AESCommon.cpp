@@ -24,6 +24,27 @@
 #include "Crypto.h"
 #include "utility/ProgMemUtil.h"
 
+// Selects how AES128, AES192, and AES256 process a block.  The byte
+// version suits AVR, with only the S-boxes in program memory.  The 32-bit
+// version keeps each column of the state in a 32-bit word and combines
+// SubBytes, ShiftRows, and MixColumns into four lookups per column in a
+// 1K table, which is several times faster on 32-bit cores.
+//
+// Define CRYPTO_AES_CONSTANT_TIME to 1 for side-channel sensitive builds.
+// The 32-bit version then computes the S-box arithmetically, four bytes at
+// a time, with no secret-dependent memory accesses or branches.  It is
+// slower than the table version but does not depend on cache behaviour.
+#if !defined(CRYPTO_AES_CONSTANT_TIME)
+#define CRYPTO_AES_CONSTANT_TIME 0
+#endif
+#if !defined(CRYPTO_AES_32BIT)
+#if !defined(__AVR__) || CRYPTO_AES_CONSTANT_TIME
+#define CRYPTO_AES_32BIT 1
+#else
+#define CRYPTO_AES_32BIT 0
+#endif
+#endif
+
 #if defined(CRYPTO_AES_DEFAULT) || defined(CRYPTO_DOC)
 
 /**
@@ -39,6 +60,8 @@
  * in an environment where the attacker can observe the timing of encryption
  * and decryption operations.  Unless AES compatibility is required,
  * it is recommended that the ChaCha stream cipher be used instead.
+ * Building with CRYPTO_AES_CONSTANT_TIME defined to 1 replaces the
+ * lookups of AES128, AES192, and AES256 with constant-time arithmetic.
  *
  * Reference: http://en.wikipedia.org/wiki/Advanced_Encryption_Standard
  *
@@ -267,6 +290,281 @@ void AESCommon::inverseMixColumn(uint8_t *output, const uint8_t *input)
 
 /** @endcond */
 
+#if CRYPTO_AES_32BIT
+
+/** @cond aes_32bit */
+
+// Columns are held little-endian: row 0 in the low byte.
+static inline uint32_t loadColumn(const uint8_t *data)
+{
+    return ((uint32_t)data[0]) | (((uint32_t)data[1]) << 8) |
+           (((uint32_t)data[2]) << 16) | (((uint32_t)data[3]) << 24);
+}
+
+static inline void storeColumn(uint8_t *data, uint32_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+    data[2] = (uint8_t)(value >> 16);
+    data[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint32_t rotateColumn(uint32_t value, uint8_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Multiply each byte of x by 2 in the Galois field, without branches.
+static inline uint32_t gmul2Column(uint32_t x)
+{
+    return ((x & 0x7F7F7F7FU) << 1) ^ (((x >> 7) & 0x01010101U) * 0x1BU);
+}
+
+// MixColumns on one column.
+static inline uint32_t mixColumn32(uint32_t x)
+{
+    uint32_t x2 = gmul2Column(x);
+    return x2 ^ rotateColumn(x ^ x2, 24) ^ rotateColumn(x, 16) ^ rotateColumn(x, 8);
+}
+
+// InvMixColumns on one column: multiplying by (4x^2 + 5) first turns
+// it into MixColumns.
+static inline uint32_t inverseMixColumn32(uint32_t x)
+{
+    uint32_t x4 = gmul2Column(gmul2Column(x));
+    return mixColumn32(x ^ x4 ^ rotateColumn(x4, 16));
+}
+
+#if CRYPTO_AES_CONSTANT_TIME
+
+// Multiply the four bytes of a by the four bytes of b in the Galois field.
+static uint32_t gmulColumn(uint32_t a, uint32_t b)
+{
+    uint32_t r = 0;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+        r ^= a & (((b >> bit) & 0x01010101U) * 0xFFU);
+        a = gmul2Column(a);
+    }
+    return r;
+}
+
+// Inverse of each byte in the Galois field (x^254, with 0 mapping to 0).
+static uint32_t inverseColumn(uint32_t x)
+{
+    uint32_t square = gmulColumn(x, x);
+    uint32_t result = square;
+    for (uint8_t posn = 2; posn < 8; ++posn) {
+        square = gmulColumn(square, square);
+        result = gmulColumn(result, square);
+    }
+    return result;
+}
+
+// Rotate each byte left by 0 < bits < 8.
+static inline uint32_t rotateBytes(uint32_t x, uint8_t bits)
+{
+    uint32_t high = (0xFFU << bits) & 0xFFU;
+    return ((x << bits) & (high * 0x01010101U)) |
+           ((x >> (8 - bits)) & ((~high & 0xFFU) * 0x01010101U));
+}
+
+// S-box of each byte: inversion followed by the affine transformation.
+static uint32_t subColumn(uint32_t x)
+{
+    x = inverseColumn(x);
+    return x ^ rotateBytes(x, 1) ^ rotateBytes(x, 2) ^ rotateBytes(x, 3) ^
+           rotateBytes(x, 4) ^ 0x63636363U;
+}
+
+// Inverse S-box of each byte: inverse affine transformation, then inversion.
+static uint32_t inverseSubColumn(uint32_t x)
+{
+    x = rotateBytes(x, 1) ^ rotateBytes(x, 3) ^ rotateBytes(x, 6) ^ 0x05050505U;
+    return inverseColumn(x);
+}
+
+#else // !CRYPTO_AES_CONSTANT_TIME
+
+// Round table: byte x of the state contributes the column
+// (2 * S(x), S(x), S(x), 3 * S(x)) to MixColumns.  The other rows use
+// the same entry rotated by 8, 16, or 24 bits.
+static uint32_t const te0[256] PROGMEM = {
+    0xA56363C6, 0x847C7CF8, 0x997777EE, 0x8D7B7BF6, 0x0DF2F2FF, 0xBD6B6BD6,
+    0xB16F6FDE, 0x54C5C591, 0x50303060, 0x03010102, 0xA96767CE, 0x7D2B2B56,
+    0x19FEFEE7, 0x62D7D7B5, 0xE6ABAB4D, 0x9A7676EC, 0x45CACA8F, 0x9D82821F,
+    0x40C9C989, 0x877D7DFA, 0x15FAFAEF, 0xEB5959B2, 0xC947478E, 0x0BF0F0FB,
+    0xECADAD41, 0x67D4D4B3, 0xFDA2A25F, 0xEAAFAF45, 0xBF9C9C23, 0xF7A4A453,
+    0x967272E4, 0x5BC0C09B, 0xC2B7B775, 0x1CFDFDE1, 0xAE93933D, 0x6A26264C,
+    0x5A36366C, 0x413F3F7E, 0x02F7F7F5, 0x4FCCCC83, 0x5C343468, 0xF4A5A551,
+    0x34E5E5D1, 0x08F1F1F9, 0x937171E2, 0x73D8D8AB, 0x53313162, 0x3F15152A,
+    0x0C040408, 0x52C7C795, 0x65232346, 0x5EC3C39D, 0x28181830, 0xA1969637,
+    0x0F05050A, 0xB59A9A2F, 0x0907070E, 0x36121224, 0x9B80801B, 0x3DE2E2DF,
+    0x26EBEBCD, 0x6927274E, 0xCDB2B27F, 0x9F7575EA, 0x1B090912, 0x9E83831D,
+    0x742C2C58, 0x2E1A1A34, 0x2D1B1B36, 0xB26E6EDC, 0xEE5A5AB4, 0xFBA0A05B,
+    0xF65252A4, 0x4D3B3B76, 0x61D6D6B7, 0xCEB3B37D, 0x7B292952, 0x3EE3E3DD,
+    0x712F2F5E, 0x97848413, 0xF55353A6, 0x68D1D1B9, 0x00000000, 0x2CEDEDC1,
+    0x60202040, 0x1FFCFCE3, 0xC8B1B179, 0xED5B5BB6, 0xBE6A6AD4, 0x46CBCB8D,
+    0xD9BEBE67, 0x4B393972, 0xDE4A4A94, 0xD44C4C98, 0xE85858B0, 0x4ACFCF85,
+    0x6BD0D0BB, 0x2AEFEFC5, 0xE5AAAA4F, 0x16FBFBED, 0xC5434386, 0xD74D4D9A,
+    0x55333366, 0x94858511, 0xCF45458A, 0x10F9F9E9, 0x06020204, 0x817F7FFE,
+    0xF05050A0, 0x443C3C78, 0xBA9F9F25, 0xE3A8A84B, 0xF35151A2, 0xFEA3A35D,
+    0xC0404080, 0x8A8F8F05, 0xAD92923F, 0xBC9D9D21, 0x48383870, 0x04F5F5F1,
+    0xDFBCBC63, 0xC1B6B677, 0x75DADAAF, 0x63212142, 0x30101020, 0x1AFFFFE5,
+    0x0EF3F3FD, 0x6DD2D2BF, 0x4CCDCD81, 0x140C0C18, 0x35131326, 0x2FECECC3,
+    0xE15F5FBE, 0xA2979735, 0xCC444488, 0x3917172E, 0x57C4C493, 0xF2A7A755,
+    0x827E7EFC, 0x473D3D7A, 0xAC6464C8, 0xE75D5DBA, 0x2B191932, 0x957373E6,
+    0xA06060C0, 0x98818119, 0xD14F4F9E, 0x7FDCDCA3, 0x66222244, 0x7E2A2A54,
+    0xAB90903B, 0x8388880B, 0xCA46468C, 0x29EEEEC7, 0xD3B8B86B, 0x3C141428,
+    0x79DEDEA7, 0xE25E5EBC, 0x1D0B0B16, 0x76DBDBAD, 0x3BE0E0DB, 0x56323264,
+    0x4E3A3A74, 0x1E0A0A14, 0xDB494992, 0x0A06060C, 0x6C242448, 0xE45C5CB8,
+    0x5DC2C29F, 0x6ED3D3BD, 0xEFACAC43, 0xA66262C4, 0xA8919139, 0xA4959531,
+    0x37E4E4D3, 0x8B7979F2, 0x32E7E7D5, 0x43C8C88B, 0x5937376E, 0xB76D6DDA,
+    0x8C8D8D01, 0x64D5D5B1, 0xD24E4E9C, 0xE0A9A949, 0xB46C6CD8, 0xFA5656AC,
+    0x07F4F4F3, 0x25EAEACF, 0xAF6565CA, 0x8E7A7AF4, 0xE9AEAE47, 0x18080810,
+    0xD5BABA6F, 0x887878F0, 0x6F25254A, 0x722E2E5C, 0x241C1C38, 0xF1A6A657,
+    0xC7B4B473, 0x51C6C697, 0x23E8E8CB, 0x7CDDDDA1, 0x9C7474E8, 0x211F1F3E,
+    0xDD4B4B96, 0xDCBDBD61, 0x868B8B0D, 0x858A8A0F, 0x907070E0, 0x423E3E7C,
+    0xC4B5B571, 0xAA6666CC, 0xD8484890, 0x05030306, 0x01F6F6F7, 0x120E0E1C,
+    0xA36161C2, 0x5F35356A, 0xF95757AE, 0xD0B9B969, 0x91868617, 0x58C1C199,
+    0x271D1D3A, 0xB99E9E27, 0x38E1E1D9, 0x13F8F8EB, 0xB398982B, 0x33111122,
+    0xBB6969D2, 0x70D9D9A9, 0x898E8E07, 0xA7949433, 0xB69B9B2D, 0x221E1E3C,
+    0x92878715, 0x20E9E9C9, 0x49CECE87, 0xFF5555AA, 0x78282850, 0x7ADFDFA5,
+    0x8F8C8C03, 0xF8A1A159, 0x80898909, 0x170D0D1A, 0xDABFBF65, 0x31E6E6D7,
+    0xC6424284, 0xB86868D0, 0xC3414182, 0xB0999929, 0x772D2D5A, 0x110F0F1E,
+    0xCBB0B07B, 0xFC5454A8, 0xD6BBBB6D, 0x3A16162C
+};
+
+static inline uint32_t subColumn(uint32_t x)
+{
+    return ((uint32_t)pgm_read_byte(sbox + (x & 0xFF))) |
+           (((uint32_t)pgm_read_byte(sbox + ((x >> 8) & 0xFF))) << 8) |
+           (((uint32_t)pgm_read_byte(sbox + ((x >> 16) & 0xFF))) << 16) |
+           (((uint32_t)pgm_read_byte(sbox + (x >> 24))) << 24);
+}
+
+static inline uint32_t inverseSubColumn(uint32_t x)
+{
+    return ((uint32_t)pgm_read_byte(sbox_inverse + (x & 0xFF))) |
+           (((uint32_t)pgm_read_byte(sbox_inverse + ((x >> 8) & 0xFF))) << 8) |
+           (((uint32_t)pgm_read_byte(sbox_inverse + ((x >> 16) & 0xFF))) << 16) |
+           (((uint32_t)pgm_read_byte(sbox_inverse + (x >> 24))) << 24);
+}
+
+#endif // !CRYPTO_AES_CONSTANT_TIME
+
+// ShiftRows: output column n takes row r from input column n + r.
+#define SHIFT_ROWS(s0, s1, s2, s3) \
+    (((s0) & 0x000000FFU) | ((s1) & 0x0000FF00U) | \
+     ((s2) & 0x00FF0000U) | ((s3) & 0xFF000000U))
+
+// InvShiftRows: output column n takes row r from input column n - r.
+#define INVERSE_SHIFT_ROWS(s0, s1, s2, s3) \
+    (((s0) & 0x000000FFU) | ((s3) & 0x0000FF00U) | \
+     ((s2) & 0x00FF0000U) | ((s1) & 0xFF000000U))
+
+/** @endcond */
+
+void AESCommon::encryptBlock(uint8_t *output, const uint8_t *input)
+{
+    const uint8_t *roundKey = schedule;
+    uint32_t s0, s1, s2, s3;
+    uint32_t t0, t1, t2, t3;
+    uint8_t round;
+
+    // Copy the input into the state and XOR with the first round key.
+    s0 = loadColumn(input)      ^ loadColumn(roundKey);
+    s1 = loadColumn(input + 4)  ^ loadColumn(roundKey + 4);
+    s2 = loadColumn(input + 8)  ^ loadColumn(roundKey + 8);
+    s3 = loadColumn(input + 12) ^ loadColumn(roundKey + 12);
+    roundKey += 16;
+
+    // Perform all rounds except the last.
+    for (round = rounds; round > 1; --round) {
+#if CRYPTO_AES_CONSTANT_TIME
+        t0 = subColumn(s0);
+        t1 = subColumn(s1);
+        t2 = subColumn(s2);
+        t3 = subColumn(s3);
+        s0 = mixColumn32(SHIFT_ROWS(t0, t1, t2, t3)) ^ loadColumn(roundKey);
+        s1 = mixColumn32(SHIFT_ROWS(t1, t2, t3, t0)) ^ loadColumn(roundKey + 4);
+        s2 = mixColumn32(SHIFT_ROWS(t2, t3, t0, t1)) ^ loadColumn(roundKey + 8);
+        s3 = mixColumn32(SHIFT_ROWS(t3, t0, t1, t2)) ^ loadColumn(roundKey + 12);
+#else
+        #define TE(s0, s1, s2, s3) \
+            (pgm_read_dword(te0 + ((s0) & 0xFF)) ^ \
+             rotateColumn(pgm_read_dword(te0 + (((s1) >> 8) & 0xFF)), 8) ^ \
+             rotateColumn(pgm_read_dword(te0 + (((s2) >> 16) & 0xFF)), 16) ^ \
+             rotateColumn(pgm_read_dword(te0 + ((s3) >> 24)), 24))
+        t0 = TE(s0, s1, s2, s3) ^ loadColumn(roundKey);
+        t1 = TE(s1, s2, s3, s0) ^ loadColumn(roundKey + 4);
+        t2 = TE(s2, s3, s0, s1) ^ loadColumn(roundKey + 8);
+        t3 = TE(s3, s0, s1, s2) ^ loadColumn(roundKey + 12);
+        #undef TE
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+#endif
+        roundKey += 16;
+    }
+
+    // Perform the final round, which has no MixColumns.
+    t0 = subColumn(SHIFT_ROWS(s0, s1, s2, s3));
+    t1 = subColumn(SHIFT_ROWS(s1, s2, s3, s0));
+    t2 = subColumn(SHIFT_ROWS(s2, s3, s0, s1));
+    t3 = subColumn(SHIFT_ROWS(s3, s0, s1, s2));
+    storeColumn(output,      t0 ^ loadColumn(roundKey));
+    storeColumn(output + 4,  t1 ^ loadColumn(roundKey + 4));
+    storeColumn(output + 8,  t2 ^ loadColumn(roundKey + 8));
+    storeColumn(output + 12, t3 ^ loadColumn(roundKey + 12));
+
+    // Attempt to clean up the stack.
+    s0 = s1 = s2 = s3 = t0 = t1 = t2 = t3 = 0;
+}
+
+void AESCommon::decryptBlock(uint8_t *output, const uint8_t *input)
+{
+    const uint8_t *roundKey = schedule + rounds * 16;
+    uint32_t s0, s1, s2, s3;
+    uint32_t t0, t1, t2, t3;
+    uint8_t round;
+
+    // Copy the input into the state and reverse the final round.
+    t0 = loadColumn(input)      ^ loadColumn(roundKey);
+    t1 = loadColumn(input + 4)  ^ loadColumn(roundKey + 4);
+    t2 = loadColumn(input + 8)  ^ loadColumn(roundKey + 8);
+    t3 = loadColumn(input + 12) ^ loadColumn(roundKey + 12);
+    s0 = inverseSubColumn(INVERSE_SHIFT_ROWS(t0, t1, t2, t3));
+    s1 = inverseSubColumn(INVERSE_SHIFT_ROWS(t1, t2, t3, t0));
+    s2 = inverseSubColumn(INVERSE_SHIFT_ROWS(t2, t3, t0, t1));
+    s3 = inverseSubColumn(INVERSE_SHIFT_ROWS(t3, t0, t1, t2));
+
+    // Perform all other rounds in reverse.
+    for (round = rounds; round > 1; --round) {
+        roundKey -= 16;
+        t0 = inverseMixColumn32(s0 ^ loadColumn(roundKey));
+        t1 = inverseMixColumn32(s1 ^ loadColumn(roundKey + 4));
+        t2 = inverseMixColumn32(s2 ^ loadColumn(roundKey + 8));
+        t3 = inverseMixColumn32(s3 ^ loadColumn(roundKey + 12));
+        s0 = inverseSubColumn(INVERSE_SHIFT_ROWS(t0, t1, t2, t3));
+        s1 = inverseSubColumn(INVERSE_SHIFT_ROWS(t1, t2, t3, t0));
+        s2 = inverseSubColumn(INVERSE_SHIFT_ROWS(t2, t3, t0, t1));
+        s3 = inverseSubColumn(INVERSE_SHIFT_ROWS(t3, t0, t1, t2));
+    }
+
+    // Reverse the initial round and create the output words.
+    roundKey -= 16;
+    storeColumn(output,      s0 ^ loadColumn(roundKey));
+    storeColumn(output + 4,  s1 ^ loadColumn(roundKey + 4));
+    storeColumn(output + 8,  s2 ^ loadColumn(roundKey + 8));
+    storeColumn(output + 12, s3 ^ loadColumn(roundKey + 12));
+
+    // Attempt to clean up the stack.
+    s0 = s1 = s2 = s3 = t0 = t1 = t2 = t3 = 0;
+}
+
+#else // !CRYPTO_AES_32BIT
+
 void AESCommon::encryptBlock(uint8_t *output, const uint8_t *input)
 {
     const uint8_t *roundKey = schedule;
@@ -329,6 +627,8 @@ void AESCommon::decryptBlock(uint8_t *output, const uint8_t *input)
         output[posn] = state2[posn] ^ roundKey[posn];
 }
 
+#endif // !CRYPTO_AES_32BIT
+
 void AESCommon::clear()
 {
     clean(schedule, (rounds + 1) * 16);
@@ -344,18 +644,28 @@ void AESCommon::keyScheduleCore(uint8_t *output, const uint8_t *input, uint8_t i
         0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,     // 0x00
         0x80, 0x1B, 0x36
     };
+#if CRYPTO_AES_32BIT && CRYPTO_AES_CONSTANT_TIME
+    // RotWord then SubWord, with the arithmetic S-box.
+    storeColumn(output, subColumn(rotateColumn(loadColumn(input), 24)) ^
+                        pgm_read_byte(rcon + iteration));
+#else
     output[0] = pgm_read_byte(sbox + input[1]) ^ pgm_read_byte(rcon + iteration);
     output[1] = pgm_read_byte(sbox + input[2]);
     output[2] = pgm_read_byte(sbox + input[3]);
     output[3] = pgm_read_byte(sbox + input[0]);
+#endif
 }
 
 void AESCommon::applySbox(uint8_t *output, const uint8_t *input)
 {
+#if CRYPTO_AES_32BIT && CRYPTO_AES_CONSTANT_TIME
+    storeColumn(output, subColumn(loadColumn(input)));
+#else
     output[0] = pgm_read_byte(sbox + input[0]);
     output[1] = pgm_read_byte(sbox + input[1]);
     output[2] = pgm_read_byte(sbox + input[2]);
     output[3] = pgm_read_byte(sbox + input[3]);
+#endif
 }
 
 /** @endcond */
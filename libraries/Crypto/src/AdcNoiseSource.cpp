@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AdcNoiseSource.h"
+#include "Crypto.h"
+#include <Arduino.h>
+#include <string.h>
+
+#if CRYPTO_ADC_NOISE_DMA
+#include <hardware/adc.h>
+#include <hardware/dma.h>
+#endif
+
+// Health tests of NIST SP 800-90B section 4.4, on the raw samples, for a
+// claimed min-entropy of 1 bit per sample and a false alarm rate of 2^-20.
+#define ADC_NOISE_RCT_CUTOFF    21      // 1 + ceil(20 / H)
+#define ADC_NOISE_APT_WINDOW    512
+#define ADC_NOISE_APT_CUTOFF    410
+#define ADC_NOISE_STARTUP       1024    // Samples tested before any credit
+
+// First GPIO with an ADC input on RP2040 (A0).
+#define ADC_NOISE_FIRST_ADC_PIN 26
+#define ADC_NOISE_LAST_ADC_PIN  29
+
+/**
+ * \class AdcNoiseSource AdcNoiseSource.h <AdcNoiseSource.h>
+ * \brief Noise source sampling a floating analog input.
+ *
+ * The two least significant bits of each conversion of an unconnected ADC
+ * pin are mostly thermal and quantization noise.  Samples are collected in
+ * batches of ADC_NOISE_SAMPLES, checked with the repetition count and
+ * adaptive proportion tests of NIST SP 800-90B, and their low bits packed
+ * into the pool, where the rekeying of RNG does the conditioning.
+ *
+ * On RP2040 the ADC runs free at 500k samples per second and a DMA channel
+ * fills the next batch in the background, so stir() only has to look at a
+ * finished one: the pool reaches full entropy a few milliseconds after
+ * begin.  Elsewhere stir() takes ADC_NOISE_POLLED_SAMPLES conversions with
+ * analogRead() each time.
+ *
+ * No entropy is credited for the first ADC_NOISE_STARTUP samples, nor again
+ * for as long after a health test failure, for example when the pin is
+ * pulled to a rail.  calibrating() is true during that time.
+ *
+ * \code
+ * AdcNoiseSource noise(A0);
+ *
+ * void setup() {
+ *     RNG.begin("MyApp 1.0");
+ *     RNG.addNoiseSource(noise);
+ * }
+ *
+ * void loop() {
+ *     RNG.loop();
+ * }
+ * \endcode
+ *
+ * On RP2040 do not call analogRead() while a batch is being sampled.
+ *
+ * \sa RNGClass, NoiseSource
+ */
+
+/**
+ * \brief Constructs a new ADC noise source.
+ *
+ * \param pin Analog pin left unconnected.  With DMA it must be one of the
+ * ADC GPIOs (A0 to A3), otherwise analogRead() is used.
+ */
+AdcNoiseSource::AdcNoiseSource(uint8_t pin)
+    : pin(pin)
+    , count(0)
+    , startup(ADC_NOISE_STARTUP)
+    , lastSample(0)
+    , repeat(0)
+    , aptSample(0)
+    , aptCount(0)
+    , aptSeen(0)
+#if CRYPTO_ADC_NOISE_DMA
+    , dmaChannel(-1)
+#endif
+{
+    memset(pool, 0, sizeof(pool));
+}
+
+/**
+ * \brief Destroys this ADC noise source.
+ */
+AdcNoiseSource::~AdcNoiseSource()
+{
+#if CRYPTO_ADC_NOISE_DMA
+    if (dmaChannel >= 0) {
+        adc_run(false);
+        dma_channel_abort(dmaChannel);
+        dma_channel_unclaim(dmaChannel);
+    }
+    clean(samples);
+#endif
+    clean(pool);
+}
+
+bool AdcNoiseSource::calibrating() const
+{
+    return startup > 0;
+}
+
+void AdcNoiseSource::stir()
+{
+#if CRYPTO_ADC_NOISE_DMA
+    if (dmaChannel >= 0) {
+        if (dma_channel_is_busy(dmaChannel))
+            return;
+        adc_run(false);
+        for (uint16_t posn = 0; posn < ADC_NOISE_SAMPLES; ++posn)
+            addSample(samples[posn]);
+        flush();
+        startBatch();
+        return;
+    }
+#endif
+    for (uint8_t posn = 0; posn < ADC_NOISE_POLLED_SAMPLES; ++posn) {
+        addSample((uint16_t)analogRead(pin));
+        if (count >= ADC_NOISE_SAMPLES)
+            flush();
+    }
+}
+
+void AdcNoiseSource::added()
+{
+#if CRYPTO_ADC_NOISE_DMA
+    // Conversions paced into the ADC FIFO, one DMA request per sample.
+    if (dmaChannel < 0 && pin >= ADC_NOISE_FIRST_ADC_PIN &&
+            pin <= ADC_NOISE_LAST_ADC_PIN) {
+        dmaChannel = dma_claim_unused_channel(false);
+        if (dmaChannel >= 0) {
+            adc_init();
+            adc_gpio_init(pin);
+            adc_fifo_setup(true, true, 1, false, false);
+            adc_set_clkdiv(0);
+            startBatch();
+        }
+    }
+#endif
+}
+
+#if CRYPTO_ADC_NOISE_DMA
+
+/**
+ * \brief Starts the background sampling of the next batch.
+ */
+void AdcNoiseSource::startBatch()
+{
+    dma_channel_config config = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_dreq(&config, DREQ_ADC);
+
+    // analogRead() may have selected another input meanwhile.
+    adc_select_input(pin - ADC_NOISE_FIRST_ADC_PIN);
+    adc_fifo_drain();
+    dma_channel_configure(dmaChannel, &config, samples, &adc_hw->fifo,
+                          ADC_NOISE_SAMPLES, true);
+    adc_run(true);
+}
+
+#endif
+
+/**
+ * \brief Runs the health tests on a sample and packs its two low bits.
+ *
+ * \param sample Raw ADC conversion.
+ */
+void AdcNoiseSource::addSample(uint16_t sample)
+{
+    bool failure = false;
+
+    // Repetition count test: the same value too many times in a row.
+    if (sample != lastSample) {
+        lastSample = sample;
+        repeat = 1;
+    } else if (++repeat >= ADC_NOISE_RCT_CUTOFF) {
+        repeat = ADC_NOISE_RCT_CUTOFF;
+        failure = true;
+    }
+
+    // Adaptive proportion test: the first value of a window coming back
+    // too often within the window.
+    if (aptSeen == 0) {
+        aptSample = sample;
+        aptCount = 1;
+    } else if (sample == aptSample && ++aptCount >= ADC_NOISE_APT_CUTOFF) {
+        failure = true;
+    }
+    if (++aptSeen >= ADC_NOISE_APT_WINDOW)
+        aptSeen = 0;
+
+    if (failure)
+        startup = ADC_NOISE_STARTUP;
+    else if (startup > 0)
+        --startup;
+
+    pool[count / 4] |= (uint8_t)((sample & 0x03) << ((count % 4) * 2));
+    ++count;
+}
+
+/**
+ * \brief Stirs the packed bits of a full batch into the global pool.
+ *
+ * The batch is always mixed in, but only credited once the startup and
+ * health test period is over.
+ */
+void AdcNoiseSource::flush()
+{
+    output(pool, sizeof(pool), (startup > 0) ? 0 : ADC_NOISE_CREDIT);
+    clean(pool);
+    count = 0;
+}
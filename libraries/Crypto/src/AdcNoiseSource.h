@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CRYPTO_ADCNOISESOURCE_H
+#define CRYPTO_ADCNOISESOURCE_H
+
+#include "NoiseSource.h"
+
+// Sample the ADC with DMA in the background instead of with analogRead()
+// from stir().  Only on RP2040 cores with the Pico SDK; define
+// CRYPTO_ADC_NOISE_DMA to 0 to always use analogRead().
+#if !defined(CRYPTO_ADC_NOISE_DMA)
+#if defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED)
+#define CRYPTO_ADC_NOISE_DMA 1
+#else
+#define CRYPTO_ADC_NOISE_DMA 0
+#endif
+#endif
+
+// Samples per batch.  The two low bits of each sample are packed into the
+// pool, four samples per byte: 192 samples give 48 bytes, one stir() chunk.
+#if !defined(ADC_NOISE_SAMPLES)
+#define ADC_NOISE_SAMPLES       192
+#endif
+
+// Entropy bits credited for a batch that passed the health tests: one bit
+// for every four samples, well below what a floating input gives.
+#if !defined(ADC_NOISE_CREDIT)
+#define ADC_NOISE_CREDIT        (ADC_NOISE_SAMPLES / 4)
+#endif
+
+// analogRead() calls per stir() without DMA, to keep loop() short.
+#if !defined(ADC_NOISE_POLLED_SAMPLES)
+#define ADC_NOISE_POLLED_SAMPLES 16
+#endif
+
+class AdcNoiseSource : public NoiseSource
+{
+public:
+    explicit AdcNoiseSource(uint8_t pin);
+    virtual ~AdcNoiseSource();
+
+    bool calibrating() const;
+    void stir();
+    void added();
+
+private:
+    uint8_t pin;
+    uint16_t count;
+    uint16_t startup;
+    uint16_t lastSample;
+    uint8_t repeat;
+    uint16_t aptSample;
+    uint16_t aptCount;
+    uint16_t aptSeen;
+    uint8_t pool[ADC_NOISE_SAMPLES / 4];
+#if CRYPTO_ADC_NOISE_DMA
+    int dmaChannel;
+    uint16_t samples[ADC_NOISE_SAMPLES];
+    void startBatch();
+#endif
+
+    void addSample(uint16_t sample);
+    void flush();
+
+    // The DMA channel writes into the object, so it cannot be copied.
+    AdcNoiseSource(const AdcNoiseSource &);
+    AdcNoiseSource &operator=(const AdcNoiseSource &);
+};
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include "AuthenticatedCipher.h"
+#include "Crypto.h"
 
 /**
  * \class AuthenticatedCipher AuthenticatedCipher.h <AuthenticatedCipher.h>
@@ -128,3 +129,54 @@ AuthenticatedCipher::~AuthenticatedCipher()
  *
  * \sa computeTag()
  */
+
+/**
+ * \brief Encrypts and authenticates a buffer in place.
+ *
+ * \param buf The plaintext on entry and the ciphertext on exit.
+ * \param len The number of bytes in \a buf.
+ * \param aad Associated data to authenticate but not encrypt.
+ * \param aadLen The number of bytes of associated data, which may be zero.
+ * \param tag Returns the authentication tag, of tagSize() bytes.
+ *
+ * This is equivalent to calling addAuthData(), encrypt() and computeTag()
+ * in turn, and is intended to be called once after setIV().  Subclasses
+ * may override it to encrypt and authenticate \a buf in a single pass.
+ *
+ * \sa open()
+ */
+void AuthenticatedCipher::seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag)
+{
+    addAuthData(aad, aadLen);
+    encrypt(buf, buf, len);
+    computeTag(tag, tagSize());
+}
+
+/**
+ * \brief Decrypts and checks a buffer in place.
+ *
+ * \param buf The ciphertext on entry and the plaintext on exit.
+ * \param len The number of bytes in \a buf.
+ * \param aad Associated data that was authenticated with the ciphertext.
+ * \param aadLen The number of bytes of associated data, which may be zero.
+ * \param tag The authentication tag to check, of tagSize() bytes.
+ *
+ * \return Returns true if the tag is valid, or false if the data or the
+ * tag has been tampered with.  On failure \a buf is cleared so that
+ * unauthenticated plaintext is never returned.
+ *
+ * This is equivalent to calling addAuthData(), decrypt() and checkTag()
+ * in turn, and is intended to be called once after setIV().
+ *
+ * \sa seal()
+ */
+bool AuthenticatedCipher::open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag)
+{
+    addAuthData(aad, aadLen);
+    decrypt(buf, buf, len);
+    if (!checkTag(tag, tagSize())) {
+        clean(buf, len);
+        return false;
+    }
+    return true;
+}
@@ -37,6 +37,9 @@ public:
 
     virtual void computeTag(void *tag, size_t len) = 0;
     virtual bool checkTag(const void *tag, size_t len) = 0;
+
+    virtual void seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag);
+    virtual bool open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag);
 };
 
 #endif
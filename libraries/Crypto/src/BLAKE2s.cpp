@@ -259,6 +259,98 @@ void BLAKE2s::finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t ha
     clean(temp);
 }
 
+// Fully unroll the rounds with constant message word indices on 32-bit
+// targets, where the working state fits in registers and the sigma table
+// lookups dominate.  AVR keeps the compact table-driven loop.
+#if !defined(BLAKE2S_UNROLL_ROUNDS)
+#if defined(__AVR__)
+#define BLAKE2S_UNROLL_ROUNDS 0
+#else
+#define BLAKE2S_UNROLL_ROUNDS 1
+#endif
+#endif
+
+#if BLAKE2S_UNROLL_ROUNDS
+
+// Perform a BLAKE2s quarter round operation on local state words.
+#define quarterRound(a, b, c, d, x, y)    \
+    do { \
+        a += b + m[x]; \
+        d = rightRotate16(d ^ a); \
+        c += d; \
+        b = rightRotate12(b ^ c); \
+        a += b + m[y]; \
+        d = rightRotate8(d ^ a); \
+        c += d; \
+        b = rightRotate7(b ^ c); \
+    } while (0)
+
+// Perform a BLAKE2s column and diagonal round with a message permutation.
+#define fullRound(s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10, s11, s12, s13, s14, s15) \
+    do { \
+        quarterRound(v0, v4, v8,  v12, s0,  s1); \
+        quarterRound(v1, v5, v9,  v13, s2,  s3); \
+        quarterRound(v2, v6, v10, v14, s4,  s5); \
+        quarterRound(v3, v7, v11, v15, s6,  s7); \
+        quarterRound(v0, v5, v10, v15, s8,  s9); \
+        quarterRound(v1, v6, v11, v12, s10, s11); \
+        quarterRound(v2, v7, v8,  v13, s12, s13); \
+        quarterRound(v3, v4, v9,  v14, s14, s15); \
+    } while (0)
+
+void BLAKE2s::processChunk(uint32_t f0)
+{
+    const uint32_t *m = state.m;
+
+    // Byte-swap the message buffer into little-endian if necessary.
+#if !defined(CRYPTO_LITTLE_ENDIAN)
+    for (uint8_t index = 0; index < 16; ++index)
+        state.m[index] = le32toh(state.m[index]);
+#endif
+
+    // Format the block to be hashed.
+    uint32_t v0  = state.h[0];
+    uint32_t v1  = state.h[1];
+    uint32_t v2  = state.h[2];
+    uint32_t v3  = state.h[3];
+    uint32_t v4  = state.h[4];
+    uint32_t v5  = state.h[5];
+    uint32_t v6  = state.h[6];
+    uint32_t v7  = state.h[7];
+    uint32_t v8  = BLAKE2s_IV0;
+    uint32_t v9  = BLAKE2s_IV1;
+    uint32_t v10 = BLAKE2s_IV2;
+    uint32_t v11 = BLAKE2s_IV3;
+    uint32_t v12 = BLAKE2s_IV4 ^ (uint32_t)(state.length);
+    uint32_t v13 = BLAKE2s_IV5 ^ (uint32_t)(state.length >> 32);
+    uint32_t v14 = BLAKE2s_IV6 ^ f0;
+    uint32_t v15 = BLAKE2s_IV7;
+
+    // Perform the 10 BLAKE2s rounds, with the rows of sigma inlined.
+    fullRound( 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15);
+    fullRound(14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3);
+    fullRound(11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4);
+    fullRound( 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8);
+    fullRound( 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13);
+    fullRound( 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9);
+    fullRound(12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11);
+    fullRound(13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10);
+    fullRound( 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5);
+    fullRound(10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0);
+
+    // Combine the new and old hash values.
+    state.h[0] ^= (v0 ^ v8);
+    state.h[1] ^= (v1 ^ v9);
+    state.h[2] ^= (v2 ^ v10);
+    state.h[3] ^= (v3 ^ v11);
+    state.h[4] ^= (v4 ^ v12);
+    state.h[5] ^= (v5 ^ v13);
+    state.h[6] ^= (v6 ^ v14);
+    state.h[7] ^= (v7 ^ v15);
+}
+
+#else // !BLAKE2S_UNROLL_ROUNDS
+
 // Permutation on the message input state for BLAKE2s.
 static const uint8_t sigma[10][16] PROGMEM = {
     { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
@@ -330,3 +422,5 @@ void BLAKE2s::processChunk(uint32_t f0)
     for (index = 0; index < 8; ++index)
         state.h[index] ^= (v[index] ^ v[index + 8]);
 }
+
+#endif // !BLAKE2S_UNROLL_ROUNDS
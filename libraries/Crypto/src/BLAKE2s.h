@@ -58,6 +58,8 @@ private:
     } state;
 
     void processChunk(uint32_t f0);
+
+    friend class BLAKE2sMAC;
 };
 
 #endif
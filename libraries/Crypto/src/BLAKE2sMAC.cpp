@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "BLAKE2sMAC.h"
+#include "Crypto.h"
+#include "utility/EndianUtil.h"
+#include <string.h>
+
+/**
+ * \class BLAKE2sMAC BLAKE2sMAC.h <BLAKE2sMAC.h>
+ * \brief Keyed BLAKE2s message authentication code with a cached key block.
+ *
+ * The BLAKE2s keyed hash puts the key in a first block of its own.
+ * setKey() compresses that block once and every later MAC starts from the
+ * resulting state, so a message of up to 64 bytes costs one compression.
+ * HMAC-SHA256 needs four for the same message, or two with HMACKey.
+ *
+ * The tags are those of BLAKE2s::reset(key, keyLen, tagLen) followed by
+ * update() and finalize(), so they can be checked with plain BLAKE2s.
+ *
+ * seal() and open() protect small fixed-layout records, such as entries of
+ * a cache or a store, with the tag placed right after the record data:
+ *
+ * \code
+ * BLAKE2sMAC mac;
+ * mac.setKey(key, sizeof(key));
+ *
+ * uint8_t record[24 + BLAKE2sMAC::TAG_SIZE];
+ * ...
+ * mac.seal(record, 24, sequence);
+ * ...
+ * if (!mac.open(record, 24, sequence)) {
+ *     // Corrupted, forged or from another sequence number.
+ * }
+ * \endcode
+ *
+ * \sa BLAKE2s, HMACKey
+ */
+
+/**
+ * \var BLAKE2sMAC::TAG_SIZE
+ * \brief Default size of the tags, in bytes.
+ */
+
+/**
+ * \brief Constructs a BLAKE2s MAC object with an empty key.
+ */
+BLAKE2sMAC::BLAKE2sMAC()
+    : tagLen(TAG_SIZE)
+{
+    keyed.reset((uint8_t)TAG_SIZE);
+    primed = keyed;
+}
+
+/**
+ * \brief Destroys this BLAKE2s MAC object after clearing the key states.
+ */
+BLAKE2sMAC::~BLAKE2sMAC()
+{
+    clear();
+}
+
+/**
+ * \brief Sets the key and compresses the key block once.
+ *
+ * \param key Points to the key.
+ * \param keyLen The length of the key in bytes, between 0 and 32.  Longer
+ * keys are truncated to the first 32 bytes, as in BLAKE2s::reset().
+ * \param tagLen The size of the tags in bytes, between 1 and 32.
+ */
+void BLAKE2sMAC::setKey(const void *key, size_t keyLen, uint8_t tagLen)
+{
+    if (tagLen < 1)
+        tagLen = 1;
+    else if (tagLen > 32)
+        tagLen = 32;
+    this->tagLen = tagLen;
+
+    keyed.reset(key, keyLen, tagLen);
+    primed = keyed;
+    if (primed.state.chunkSize == 64) {
+        // The key block is never the last one when data follows.
+        primed.processChunk(0);
+        primed.state.chunkSize = 0;
+        clean(primed.state.m);
+    }
+}
+
+/**
+ * \fn size_t BLAKE2sMAC::tagSize() const
+ * \brief Returns the size of the tags, as set by setKey().
+ */
+
+/**
+ * \brief Computes the tag of a message.
+ *
+ * \param tag The buffer for the tag, tagSize() bytes in size.
+ * \param data Points to the message.
+ * \param len The length of the message in bytes.
+ */
+void BLAKE2sMAC::mac(void *tag, const void *data, size_t len) const
+{
+    // An empty message leaves the key block as the final block.
+    BLAKE2s hash(len > 0 ? primed : keyed);
+    hash.update(data, len);
+    hash.finalize(tag, tagLen);
+}
+
+/**
+ * \brief Appends the tag to a record.
+ *
+ * \param record Points to the record: \a len bytes of data followed by
+ * room for tagSize() bytes of tag.
+ * \param len The length of the record data in bytes.
+ * \param label Value bound to the tag without being stored in the record,
+ * such as a record type, slot number or sequence number.
+ *
+ * \sa open()
+ */
+void BLAKE2sMAC::seal(void *record, size_t len, uint32_t label) const
+{
+    computeRecord(((uint8_t *)record) + len, record, len, label);
+}
+
+/**
+ * \brief Checks the tag of a record sealed by seal().
+ *
+ * \param record Points to the record data followed by its tag.
+ * \param len The length of the record data in bytes.
+ * \param label Value the record was sealed with.
+ * \return Returns true if the tag matches; false otherwise.
+ *
+ * The tag is compared in constant time.
+ *
+ * \sa seal()
+ */
+bool BLAKE2sMAC::open(const void *record, size_t len, uint32_t label) const
+{
+    uint8_t tag[32];
+    bool ok;
+    computeRecord(tag, record, len, label);
+    ok = secure_compare(tag, ((const uint8_t *)record) + len, tagLen);
+    clean(tag);
+    return ok;
+}
+
+/**
+ * \brief Clears the key and resets to an empty key.
+ */
+void BLAKE2sMAC::clear()
+{
+    keyed.clear();
+    primed.clear();
+    tagLen = TAG_SIZE;
+    keyed.reset((uint8_t)TAG_SIZE);
+    primed = keyed;
+}
+
+/**
+ * \brief Computes the tag of the label followed by the record data.
+ *
+ * The label always makes the message non-empty, so the cached state is
+ * used even for an empty record.
+ */
+void BLAKE2sMAC::computeRecord(uint8_t *tag, const void *record, size_t len,
+                               uint32_t label) const
+{
+    BLAKE2s hash(primed);
+    label = htole32(label);
+    hash.update(&label, sizeof(label));
+    hash.update(record, len);
+    hash.finalize(tag, tagLen);
+}
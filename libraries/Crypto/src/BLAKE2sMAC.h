@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CRYPTO_BLAKE2SMAC_h
+#define CRYPTO_BLAKE2SMAC_h
+
+#include "BLAKE2s.h"
+
+class BLAKE2sMAC
+{
+public:
+    BLAKE2sMAC();
+    ~BLAKE2sMAC();
+
+    void setKey(const void *key, size_t keyLen, uint8_t tagLen = TAG_SIZE);
+    size_t tagSize() const { return tagLen; }
+
+    void mac(void *tag, const void *data, size_t len) const;
+
+    void seal(void *record, size_t len, uint32_t label = 0) const;
+    bool open(const void *record, size_t len, uint32_t label = 0) const;
+
+    void clear();
+
+    static const size_t TAG_SIZE = 16;
+
+private:
+    BLAKE2s keyed;
+    BLAKE2s primed;
+    uint8_t tagLen;
+
+    void computeRecord(uint8_t *tag, const void *record, size_t len,
+                       uint32_t label) const;
+};
+
+#endif
@@ -99,6 +99,34 @@ BlockCipher::~BlockCipher()
  * \sa decryptBlock(), blockSize()
  */
 
+/**
+ * \brief Encrypts several consecutive blocks using this cipher.
+ *
+ * \param output The output buffer to put the ciphertext into.
+ * Must be at least \a count * blockSize() bytes in length.
+ * \param input The input buffer to read the plaintext from which is
+ * allowed to be the same as \a output.  Must be at least
+ * \a count * blockSize() bytes in length.
+ * \param count The number of blocks to encrypt.
+ *
+ * The default implementation calls encryptBlock() for each block.
+ * Subclasses backed by pipelined or hardware implementations can override
+ * this to process the blocks together.  Modes that know several blocks in
+ * advance, such as CTR, call this instead of encryptBlock().
+ *
+ * \sa encryptBlock()
+ */
+void BlockCipher::encryptBlocks(uint8_t *output, const uint8_t *input, size_t count)
+{
+    size_t size = blockSize();
+    while (count > 0) {
+        encryptBlock(output, input);
+        output += size;
+        input += size;
+        --count;
+    }
+}
+
 /**
  * \fn void BlockCipher::decryptBlock(uint8_t *output, const uint8_t *input)
  * \brief Decrypts a single block using this cipher.
@@ -40,8 +40,8 @@
  * This constructor should be followed by a call to setBlockCipher().
  */
 CTRCommon::CTRCommon()
-    : blockCipher(0)
-    , posn(16)
+    : posn(16)
+    , blockCipher(0)
     , counterStart(0)
 {
 }
@@ -128,23 +128,37 @@ bool CTRCommon::setIV(const uint8_t *iv, size_t len)
 void CTRCommon::encrypt(uint8_t *output, const uint8_t *input, size_t len)
 {
     while (len > 0) {
+        if (posn >= 16 && len >= 16) {
+            // Whole blocks left: encrypt a batch of counter blocks in one
+            // call and XOR the keystream a word at a time.
+            uint8_t keystream[CRYPTO_CTR_BATCH_BLOCKS * 16];
+            size_t blocks = len / 16;
+            size_t index;
+            if (blocks > CRYPTO_CTR_BATCH_BLOCKS)
+                blocks = CRYPTO_CTR_BATCH_BLOCKS;
+            for (index = 0; index < blocks; ++index) {
+                memcpy(keystream + index * 16, counter, 16);
+                incrementCounter();
+            }
+            blockCipher->encryptBlocks(keystream, keystream, blocks);
+            for (index = 0; index < blocks * 16; index += 4) {
+                uint32_t word, key;
+                memcpy(&word, input + index, 4);
+                memcpy(&key, keystream + index, 4);
+                word ^= key;
+                memcpy(output + index, &word, 4);
+            }
+            input += blocks * 16;
+            output += blocks * 16;
+            len -= blocks * 16;
+            clean(keystream);
+            continue;
+        }
         if (posn >= 16) {
             // Generate a new encrypted counter block.
             blockCipher->encryptBlock(state, counter);
             posn = 0;
-
-            // Increment the counter, taking care not to reveal
-            // any timing information about the starting value.
-            // We iterate through the entire counter region even
-            // if we could stop earlier because a byte is non-zero.
-            uint16_t temp = 1;
-            uint8_t index = 16;
-            while (index > counterStart) {
-                --index;
-                temp += counter[index];
-                counter[index] = (uint8_t)temp;
-                temp >>= 8;
-            }
+            incrementCounter();
         }
         uint8_t templen = 16 - posn;
         if (templen > len)
@@ -162,6 +176,25 @@ void CTRCommon::decrypt(uint8_t *output, const uint8_t *input, size_t len)
     encrypt(output, input, len);
 }
 
+/**
+ * \brief Increments the counter block.
+ *
+ * The increment does not reveal any timing information about the starting
+ * value: it iterates through the entire counter region even if it could
+ * stop earlier because a byte is non-zero.
+ */
+void CTRCommon::incrementCounter()
+{
+    uint16_t temp = 1;
+    uint8_t index = 16;
+    while (index > counterStart) {
+        --index;
+        temp += counter[index];
+        counter[index] = (uint8_t)temp;
+        temp >>= 8;
+    }
+}
+
 void CTRCommon::clear()
 {
     blockCipher->clear();
@@ -218,3 +251,29 @@ void CTRCommon::clear()
  * \fn CTR::CTR()
  * \brief Constructs a new CTR object for the 128-bit block cipher T.
  */
+
+/**
+ * \class CTRT CTR.h <CTR.h>
+ * \brief CTR mode for 128-bit block ciphers with static dispatch.
+ *
+ * This class behaves exactly like CTR, but its encrypt() and decrypt()
+ * functions are expanded for the specific block cipher T and call
+ * T::encryptBlock() directly rather than through the BlockCipher vtable.
+ * The compiler can then inline the block cipher into the keystream loop
+ * where its implementation is visible, at the cost of a copy of that
+ * loop for every cipher it is used with.
+ *
+ * \code
+ * CTRT<AES256> ctr;
+ * ctr.setKey(key, 32);
+ * ctr.setIV(iv, 16);
+ * ctr.encrypt(output, input, len);
+ * \endcode
+ *
+ * \sa CTR
+ */
+
+/**
+ * \fn CTRT::CTRT()
+ * \brief Constructs a new CTRT object for the 128-bit block cipher T.
+ */
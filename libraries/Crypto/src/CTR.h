@@ -25,6 +25,14 @@
 
 #include "Cipher.h"
 #include "BlockCipher.h"
+#include "Crypto.h"
+#include <string.h>
+
+// Number of counter blocks CTRCommon::encrypt() hands to the block
+// cipher at once when the message has enough whole blocks left.
+#ifndef CRYPTO_CTR_BATCH_BLOCKS
+#define CRYPTO_CTR_BATCH_BLOCKS 4
+#endif
 
 class CTRCommon : public Cipher
 {
@@ -48,11 +56,14 @@ protected:
     CTRCommon();
     void setBlockCipher(BlockCipher *cipher) { blockCipher = cipher; }
 
-private:
-    BlockCipher *blockCipher;
+    void incrementCounter();
+
     uint8_t counter[16];
     uint8_t state[16];
     uint8_t posn;
+
+private:
+    BlockCipher *blockCipher;
     uint8_t counterStart;
 };
 
@@ -66,4 +77,61 @@ private:
     T cipher;
 };
 
+template <typename T>
+class CTRT : public CTRCommon
+{
+public:
+    CTRT() { setBlockCipher(&cipher); }
+
+    void encrypt(uint8_t *output, const uint8_t *input, size_t len)
+    {
+        while (len > 0) {
+            if (posn >= 16 && len >= 16) {
+                uint8_t keystream[CRYPTO_CTR_BATCH_BLOCKS * 16];
+                size_t blocks = len / 16;
+                size_t index;
+                if (blocks > CRYPTO_CTR_BATCH_BLOCKS)
+                    blocks = CRYPTO_CTR_BATCH_BLOCKS;
+                for (index = 0; index < blocks; ++index) {
+                    cipher.T::encryptBlock(keystream + index * 16, counter);
+                    incrementCounter();
+                }
+                for (index = 0; index < blocks * 16; index += 4) {
+                    uint32_t word, key;
+                    memcpy(&word, input + index, 4);
+                    memcpy(&key, keystream + index, 4);
+                    word ^= key;
+                    memcpy(output + index, &word, 4);
+                }
+                input += blocks * 16;
+                output += blocks * 16;
+                len -= blocks * 16;
+                ::clean(keystream, sizeof(keystream));
+                continue;
+            }
+            if (posn >= 16) {
+                cipher.T::encryptBlock(state, counter);
+                posn = 0;
+                incrementCounter();
+            }
+            uint8_t templen = 16 - posn;
+            if (templen > len)
+                templen = len;
+            len -= templen;
+            while (templen > 0) {
+                *output++ = *input++ ^ state[posn++];
+                --templen;
+            }
+        }
+    }
+
+    void decrypt(uint8_t *output, const uint8_t *input, size_t len)
+    {
+        encrypt(output, input, len);
+    }
+
+private:
+    T cipher;
+};
+
 #endif
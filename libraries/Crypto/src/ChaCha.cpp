@@ -157,24 +157,43 @@ bool ChaCha::setCounter(const uint8_t *counter, size_t len)
 
 void ChaCha::encrypt(uint8_t *output, const uint8_t *input, size_t len)
 {
+#if CHACHA_PARALLEL_BLOCKS > 1
+    // Generate several keystream blocks at once for bulk data that starts
+    // on a block boundary, and XOR a word at a time if the buffers allow it.
+    if (posn >= 64 && len >= (64 * CHACHA_PARALLEL_BLOCKS)) {
+        uint32_t keystream[16 * CHACHA_PARALLEL_BLOCKS];
+        bool aligned = ((((uintptr_t)output) | ((uintptr_t)input)) & 3) == 0;
+        do {
+            hashCoreParallel(keystream, (const uint32_t *)block, rounds);
+            incrementCounter(CHACHA_PARALLEL_BLOCKS);
+            uint8_t index;
+            if (aligned) {
+                for (index = 0; index < (16 * CHACHA_PARALLEL_BLOCKS); ++index) {
+                    ((uint32_t *)output)[index] =
+                        ((const uint32_t *)input)[index] ^ keystream[index];
+                }
+            } else {
+                const uint8_t *ks = (const uint8_t *)keystream;
+                for (index = 0; index < (16 * CHACHA_PARALLEL_BLOCKS); ++index) {
+                    output[index * 4]     = input[index * 4]     ^ ks[index * 4];
+                    output[index * 4 + 1] = input[index * 4 + 1] ^ ks[index * 4 + 1];
+                    output[index * 4 + 2] = input[index * 4 + 2] ^ ks[index * 4 + 2];
+                    output[index * 4 + 3] = input[index * 4 + 3] ^ ks[index * 4 + 3];
+                }
+            }
+            output += 64 * CHACHA_PARALLEL_BLOCKS;
+            input += 64 * CHACHA_PARALLEL_BLOCKS;
+            len -= 64 * CHACHA_PARALLEL_BLOCKS;
+        } while (len >= (64 * CHACHA_PARALLEL_BLOCKS));
+        clean(keystream);
+    }
+#endif
     while (len > 0) {
         if (posn >= 64) {
             // Generate a new encrypted counter block.
             hashCore((uint32_t *)stream, (const uint32_t *)block, rounds);
             posn = 0;
-
-            // Increment the counter, taking care not to reveal
-            // any timing information about the starting value.
-            // We iterate through the entire counter region even
-            // if we could stop earlier because a byte is non-zero.
-            uint16_t temp = 1;
-            uint8_t index = 48;
-            while (index < 56) {
-                temp += block[index];
-                block[index] = (uint8_t)temp;
-                temp >>= 8;
-                ++index;
-            }
+            incrementCounter(1);
         }
         uint8_t templen = 64 - posn;
         if (templen > len)
@@ -215,6 +234,27 @@ void ChaCha::keystreamBlock(uint32_t *output)
     block[48] = 1;
 }
 
+/**
+ * \brief Adds a number of blocks to the 64-bit counter in the input block.
+ *
+ * \param amount The number of blocks to add.
+ */
+void ChaCha::incrementCounter(uint8_t amount)
+{
+    // Increment the counter, taking care not to reveal
+    // any timing information about the starting value.
+    // We iterate through the entire counter region even
+    // if we could stop earlier because a byte is non-zero.
+    uint16_t temp = amount;
+    uint8_t index = 48;
+    while (index < 56) {
+        temp += block[index];
+        block[index] = (uint8_t)temp;
+        temp >>= 8;
+        ++index;
+    }
+}
+
 void ChaCha::clear()
 {
     clean(block);
@@ -279,3 +319,112 @@ void ChaCha::hashCore(uint32_t *output, const uint32_t *input, uint8_t rounds)
     for (posn = 0; posn < 16; ++posn)
         output[posn] = htole32(output[posn] + le32toh(input[posn]));
 }
+
+#if CHACHA_PARALLEL_BLOCKS > 1
+
+#if CHACHA_PARALLEL_BLOCKS != 2 && CHACHA_PARALLEL_BLOCKS != 4
+#error "CHACHA_PARALLEL_BLOCKS must be 1, 2, or 4"
+#endif
+
+// Perform two independent ChaCha quarter round operations with their
+// instructions interleaved so that each one fills the other's stalls.
+#define quarterRound2(a, b, c, d, e, f, g, h)    \
+    do { \
+        uint32_t _b = (b); \
+        uint32_t _f = (f); \
+        uint32_t _a = (a) + _b; \
+        uint32_t _e = (e) + _f; \
+        uint32_t _d = leftRotate((d) ^ _a, 16); \
+        uint32_t _h = leftRotate((h) ^ _e, 16); \
+        uint32_t _c = (c) + _d; \
+        uint32_t _g = (g) + _h; \
+        _b = leftRotate12(_b ^ _c); \
+        _f = leftRotate12(_f ^ _g); \
+        _a += _b; \
+        _e += _f; \
+        (d) = _d = leftRotate(_d ^ _a, 8); \
+        (h) = _h = leftRotate(_h ^ _e, 8); \
+        _c += _d; \
+        _g += _h; \
+        (a) = _a; \
+        (e) = _e; \
+        (b) = leftRotate7(_b ^ _c); \
+        (f) = leftRotate7(_f ^ _g); \
+        (c) = _c; \
+        (g) = _g; \
+    } while (0)
+
+/**
+ * \brief Executes the ChaCha hash core on several consecutive counter
+ * values at once.
+ *
+ * \param output Output memory block, must be at least
+ * 16 * CHACHA_PARALLEL_BLOCKS words in length and must not overlap
+ * with \a input.
+ * \param input Input memory block, must be at least 16 words in length.
+ * \param rounds Number of ChaCha rounds to perform; usually 8, 12, or 20.
+ *
+ * Block \c i of the output is the same as calling hashCore() on \a input
+ * with \c i added to the 64-bit counter in words 12 and 13.  The blocks
+ * are processed in pairs with their rounds interleaved, which gives
+ * 32-bit processors independent work to schedule between the dependent
+ * add-xor-rotate steps of each quarter round.
+ *
+ * This function is only available when CHACHA_PARALLEL_BLOCKS is greater
+ * than 1, which is the default on everything except AVR.
+ *
+ * \sa hashCore()
+ */
+void ChaCha::hashCoreParallel(uint32_t *output, const uint32_t *input, uint8_t rounds)
+{
+    uint32_t counterLow = le32toh(input[12]);
+    uint32_t counterHigh = le32toh(input[13]);
+    uint8_t lane, posn;
+
+    // Copy the input buffer to each output block and give every block
+    // its own counter value.
+    for (lane = 0; lane < CHACHA_PARALLEL_BLOCKS; ++lane) {
+        uint32_t *x = output + lane * 16;
+        for (posn = 0; posn < 16; ++posn)
+            x[posn] = le32toh(input[posn]);
+        x[12] = counterLow + lane;
+        x[13] = counterHigh + (x[12] < counterLow);
+    }
+
+    // Perform the ChaCha rounds on each pair of blocks.
+    for (lane = 0; lane < CHACHA_PARALLEL_BLOCKS; lane += 2) {
+        uint32_t *x = output + lane * 16;
+        uint32_t *y = x + 16;
+        uint8_t r;
+        for (r = rounds; r >= 2; r -= 2) {
+            // Column round.
+            quarterRound2(x[0], x[4], x[8],  x[12], y[0], y[4], y[8],  y[12]);
+            quarterRound2(x[1], x[5], x[9],  x[13], y[1], y[5], y[9],  y[13]);
+            quarterRound2(x[2], x[6], x[10], x[14], y[2], y[6], y[10], y[14]);
+            quarterRound2(x[3], x[7], x[11], x[15], y[3], y[7], y[11], y[15]);
+
+            // Diagonal round.
+            quarterRound2(x[0], x[5], x[10], x[15], y[0], y[5], y[10], y[15]);
+            quarterRound2(x[1], x[6], x[11], x[12], y[1], y[6], y[11], y[12]);
+            quarterRound2(x[2], x[7], x[8],  x[13], y[2], y[7], y[8],  y[13]);
+            quarterRound2(x[3], x[4], x[9],  x[14], y[3], y[4], y[9],  y[14]);
+        }
+    }
+
+    // Add the original input to the final output, convert back to
+    // little-endian, and return the result.
+    for (lane = 0; lane < CHACHA_PARALLEL_BLOCKS; ++lane) {
+        uint32_t *x = output + lane * 16;
+        uint32_t low = counterLow + lane;
+        for (posn = 0; posn < 16; ++posn) {
+            if (posn == 12)
+                x[posn] = htole32(x[posn] + low);
+            else if (posn == 13)
+                x[posn] = htole32(x[posn] + counterHigh + (low < counterLow));
+            else
+                x[posn] = htole32(x[posn] + le32toh(input[posn]));
+        }
+    }
+}
+
+#endif // CHACHA_PARALLEL_BLOCKS > 1
@@ -25,6 +25,17 @@
 
 #include "Cipher.h"
 
+// Number of keystream blocks generated at once by encrypt() on bulk data.
+// Interleaving independent blocks gives 32-bit cores more instructions to
+// schedule between dependent rotates; AVR has too few registers to benefit.
+#ifndef CHACHA_PARALLEL_BLOCKS
+#if defined(__AVR__)
+#define CHACHA_PARALLEL_BLOCKS 1
+#else
+#define CHACHA_PARALLEL_BLOCKS 2
+#endif
+#endif
+
 class ChaChaPoly;
 
 class ChaCha : public Cipher
@@ -49,6 +60,9 @@ public:
     void clear();
 
     static void hashCore(uint32_t *output, const uint32_t *input, uint8_t rounds);
+#if CHACHA_PARALLEL_BLOCKS > 1
+    static void hashCoreParallel(uint32_t *output, const uint32_t *input, uint8_t rounds);
+#endif
 
 private:
     uint8_t block[64];
@@ -57,6 +71,7 @@ private:
     uint8_t posn;
 
     void keystreamBlock(uint32_t *output);
+    void incrementCounter(uint8_t amount);
 
     friend class ChaChaPoly;
 };
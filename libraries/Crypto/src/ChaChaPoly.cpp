@@ -25,6 +25,10 @@
 #include "utility/EndianUtil.h"
 #include <string.h>
 
+// Size of the chunks that seal() and open() pass through ChaCha and
+// Poly1305 together; large enough for the multi-block keystream path.
+#define CHACHAPOLY_CHUNK_SIZE   (64 * CHACHA_PARALLEL_BLOCKS)
+
 /**
  * \class ChaChaPoly ChaChaPoly.h <ChaChaPoly.h>
  * \brief Authenticated cipher based on ChaCha and Poly1305
@@ -161,6 +165,54 @@ bool ChaChaPoly::checkTag(const void *tag, size_t len)
     return equal;
 }
 
+/**
+ * \brief Encrypts and authenticates a buffer in place in a single pass.
+ *
+ * Each group of CHACHA_PARALLEL_BLOCKS 64 byte ChaCha blocks is fed to
+ * Poly1305 as soon as it has been encrypted, while it is still in the
+ * cache, rather than after the whole buffer.
+ *
+ * \sa AuthenticatedCipher::seal()
+ */
+void ChaChaPoly::seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag)
+{
+    ChaChaPoly::addAuthData(aad, aadLen);
+    while (len > 0) {
+        size_t size = (len < CHACHAPOLY_CHUNK_SIZE) ? len : CHACHAPOLY_CHUNK_SIZE;
+        ChaChaPoly::encrypt(buf, buf, size);
+        buf += size;
+        len -= size;
+    }
+    ChaChaPoly::computeTag(tag, 16);
+}
+
+/**
+ * \brief Decrypts and checks a buffer in place in a single pass.
+ *
+ * Each group of CHACHA_PARALLEL_BLOCKS 64 byte blocks is fed to Poly1305
+ * just before it is decrypted.
+ * On failure the buffer is cleared.
+ *
+ * \sa AuthenticatedCipher::open()
+ */
+bool ChaChaPoly::open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag)
+{
+    uint8_t *start = buf;
+    size_t total = len;
+    ChaChaPoly::addAuthData(aad, aadLen);
+    while (len > 0) {
+        size_t size = (len < CHACHAPOLY_CHUNK_SIZE) ? len : CHACHAPOLY_CHUNK_SIZE;
+        ChaChaPoly::decrypt(buf, buf, size);
+        buf += size;
+        len -= size;
+    }
+    if (!ChaChaPoly::checkTag(tag, 16)) {
+        clean(start, total);
+        return false;
+    }
+    return true;
+}
+
 void ChaChaPoly::clear()
 {
     chacha.clear();
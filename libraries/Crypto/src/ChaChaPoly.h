@@ -48,6 +48,9 @@ public:
     void computeTag(void *tag, size_t len);
     bool checkTag(const void *tag, size_t len);
 
+    void seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag);
+    bool open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag);
+
     void clear();
 
 private:
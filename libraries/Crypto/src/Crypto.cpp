@@ -22,6 +22,13 @@
 
 #include "Crypto.h"
 
+#if !defined(__AVR__)
+// Word type for the clean() and secure_compare() loops on 32-bit and
+// wider cores.  may_alias lets it read and write byte buffers legally.
+typedef uint32_t __attribute__((__may_alias__)) crypto_word_t;
+#define CRYPTO_WORD_ALIGNED(ptr) ((((uintptr_t)(ptr)) & (sizeof(crypto_word_t) - 1)) == 0)
+#endif
+
 /**
  * \brief Cleans a block of bytes.
  *
@@ -37,6 +44,20 @@ void clean(void *dest, size_t size)
     // Otherwise the compiler might optimise the entire contents of this
     // function away, which will not be secure.
     volatile uint8_t *d = (volatile uint8_t *)dest;
+#if !defined(__AVR__)
+    // Align on a word, then clear a word at a time.  The stores are
+    // still volatile so they cannot be dropped either.
+    while (size > 0 && !CRYPTO_WORD_ALIGNED(d)) {
+        *d++ = 0;
+        --size;
+    }
+    volatile crypto_word_t *w = (volatile crypto_word_t *)d;
+    while (size >= sizeof(crypto_word_t)) {
+        *w++ = 0;
+        size -= sizeof(crypto_word_t);
+    }
+    d = (volatile uint8_t *)w;
+#endif
     while (size > 0) {
         *d++ = 0;
         --size;
@@ -71,6 +92,24 @@ bool secure_compare(const void *data1, const void *data2, size_t len)
     uint8_t result = 0;
     const uint8_t *d1 = (const uint8_t *)data1;
     const uint8_t *d2 = (const uint8_t *)data2;
+#if !defined(__AVR__)
+    // Compare a word at a time when both blocks are aligned, which is
+    // the usual case for tags and keys.  The branch depends only on the
+    // addresses, never on the data.
+    if (CRYPTO_WORD_ALIGNED(d1) && CRYPTO_WORD_ALIGNED(d2)) {
+        const crypto_word_t *w1 = (const crypto_word_t *)d1;
+        const crypto_word_t *w2 = (const crypto_word_t *)d2;
+        crypto_word_t diff = 0;
+        while (len >= sizeof(crypto_word_t)) {
+            diff |= (*w1++ ^ *w2++);
+            len -= sizeof(crypto_word_t);
+        }
+        diff |= (diff >> 16);
+        result = (uint8_t)(diff | (diff >> 8));
+        d1 = (const uint8_t *)w1;
+        d2 = (const uint8_t *)w2;
+    }
+#endif
     while (len > 0) {
         result |= (*d1++ ^ *d2++);
         --len;
@@ -47,6 +47,18 @@
 //#define CURVE25519_ASM_AVR 1
 #endif
 
+// Global switch to enable/disable the ARMv7E-M (Cortex-M4 and M7) UMAAL
+// optimizations.  UMAAL computes hi:lo = a * b + lo + hi without overflow,
+// which is a whole step of a multi-precision multiply in one instruction.
+#if defined(__ARM_ARCH_7EM__) && BIGNUMBER_LIMB_32BIT
+#define CURVE25519_ASM_ARM 1
+#endif
+
+#if defined(CURVE25519_ASM_ARM)
+#define umaal(lo, hi, a, b) \
+    __asm__ ("umaal %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b))
+#endif
+
 // The overhead of clean() calls in mul(), reduceQuick(), etc can
 // add up to a lot of processing time during eval().  Only do such
 // cleanups if strict mode has been enabled.  Other implementations
@@ -415,12 +427,26 @@ void Curve25519::reduce(limb_t *result, limb_t *x, uint8_t size)
     // value of the form "answer + j * (2^255 - 19)".
     carry = ((dlimb_t)(x[NUM_LIMBS_256BIT - 1] >> (LIMB_BITS - 1))) * 19U;
     x[NUM_LIMBS_256BIT - 1] &= ((((limb_t)1) << (LIMB_BITS - 1)) - 1);
+#if defined(CURVE25519_ASM_ARM)
+    {
+        limb_t low;
+        limb_t high = (limb_t)carry;
+        limb_t factor = 38U;
+        for (posn = 0; posn < size; ++posn) {
+            low = x[posn];
+            umaal(low, high, x[posn + NUM_LIMBS_256BIT], factor);
+            x[posn] = low;
+        }
+        carry = high;
+    }
+#else
     for (posn = 0; posn < size; ++posn) {
         carry += ((dlimb_t)(x[posn + NUM_LIMBS_256BIT])) * 38U;
         carry += x[posn];
         x[posn] = (limb_t)carry;
         carry >>= LIMB_BITS;
     }
+#endif
     if (size < NUM_LIMBS_256BIT) {
         // The high order half of the number is short; e.g. for mulA24().
         // Propagate the carry through the rest of the low order part.
@@ -778,7 +804,26 @@ limb_t Curve25519::reduceQuick(limb_t *x)
  */
 void Curve25519::mulNoReduce(limb_t *result, const limb_t *x, const limb_t *y)
 {
-#if !defined(CURVE25519_ASM_AVR)
+#if defined(CURVE25519_ASM_ARM)
+    uint8_t i, j;
+    limb_t word, limb, carry;
+    limb_t *rr;
+
+    // Each row adds x[i] * y into result[i..i + 8].  UMAAL adds both the
+    // previous limb of the row and the carry, so a column is one instruction.
+    memset(result, 0, NUM_LIMBS_256BIT * sizeof(limb_t));
+    for (i = 0; i < NUM_LIMBS_256BIT; ++i) {
+        word = x[i];
+        carry = 0;
+        rr = result + i;
+        for (j = 0; j < NUM_LIMBS_256BIT; ++j) {
+            limb = rr[j];
+            umaal(limb, carry, word, y[j]);
+            rr[j] = limb;
+        }
+        rr[NUM_LIMBS_256BIT] = carry;
+    }
+#elif !defined(CURVE25519_ASM_AVR)
     uint8_t i, j;
     dlimb_t carry;
     limb_t word;
@@ -938,7 +983,6 @@ void Curve25519::mul(limb_t *result, const limb_t *x, const limb_t *y)
 }
 
 /**
- * \fn void Curve25519::square(limb_t *result, const limb_t *x)
  * \brief Squares a value and then reduces it modulo 2^255 - 19.
  *
  * \param result The result, which must be NUM_LIMBS_256BIT limbs in size and
@@ -946,6 +990,71 @@ void Curve25519::mul(limb_t *result, const limb_t *x, const limb_t *y)
  * \param x The value to square, which must be NUM_LIMBS_256BIT limbs in size
  * and less than 2^255 - 19.
  */
+void Curve25519::square(limb_t *result, const limb_t *x)
+{
+#if defined(CURVE25519_ASM_ARM)
+    limb_t temp[NUM_LIMBS_512BIT];
+    squareNoReduce(temp, x);
+    reduce(result, temp, NUM_LIMBS_256BIT);
+    strict_clean(temp);
+    crypto_feed_watchdog();
+#else
+    mul(result, x, x);
+#endif
+}
+
+#if defined(CURVE25519_ASM_ARM)
+
+/**
+ * \brief Squares a 256-bit value to produce a 512-bit result.
+ *
+ * \param result The result, which must be NUM_LIMBS_512BIT limbs in size
+ * and must not overlap with \a x.
+ * \param x The value to square, which must be NUM_LIMBS_256BIT limbs in size.
+ *
+ * The 28 products x[i] * x[j] with i < j are computed once and doubled,
+ * and then the 8 squares x[i] * x[i] are added, instead of computing all
+ * 64 products as mulNoReduce() does.
+ *
+ * \sa square()
+ */
+void Curve25519::squareNoReduce(limb_t *result, const limb_t *x)
+{
+    uint8_t i, j;
+    limb_t word, limb, carry;
+    dlimb_t sum;
+
+    // Sum the products x[i] * x[j] for i < j.
+    memset(result, 0, NUM_LIMBS_512BIT * sizeof(limb_t));
+    for (i = 0; i < (NUM_LIMBS_256BIT - 1); ++i) {
+        word = x[i];
+        carry = 0;
+        for (j = i + 1; j < NUM_LIMBS_256BIT; ++j) {
+            limb = result[i + j];
+            umaal(limb, carry, word, x[j]);
+            result[i + j] = limb;
+        }
+        result[i + NUM_LIMBS_256BIT] = carry;
+    }
+
+    // Double the products.  The top limb is still zero at this point.
+    for (i = NUM_LIMBS_512BIT - 1; i > 0; --i)
+        result[i] = (result[i] << 1) | (result[i - 1] >> (LIMB_BITS - 1));
+
+    // Add the squares x[i] * x[i] along the diagonal.
+    carry = 0;
+    for (i = 0; i < NUM_LIMBS_256BIT; ++i) {
+        word = x[i];
+        limb = result[2 * i];
+        umaal(limb, carry, word, word);
+        result[2 * i] = limb;
+        sum = ((dlimb_t)(result[2 * i + 1])) + carry;
+        result[2 * i + 1] = (limb_t)sum;
+        carry = (limb_t)(sum >> LIMB_BITS);
+    }
+}
+
+#endif // CURVE25519_ASM_ARM
 
 /**
  * \brief Multiplies a value by the a24 constant and then reduces the result
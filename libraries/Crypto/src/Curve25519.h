@@ -46,12 +46,10 @@ private:
     static limb_t reduceQuick(limb_t *x);
 
     static void mulNoReduce(limb_t *result, const limb_t *x, const limb_t *y);
+    static void squareNoReduce(limb_t *result, const limb_t *x);
 
     static void mul(limb_t *result, const limb_t *x, const limb_t *y);
-    static void square(limb_t *result, const limb_t *x)
-    {
-        mul(result, x, x);
-    }
+    static void square(limb_t *result, const limb_t *x);
 
     static void mulA24(limb_t *result, const limb_t *x);
 
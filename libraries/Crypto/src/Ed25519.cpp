@@ -73,6 +73,27 @@
  * \sa Curve25519
  */
 
+// Define to 1 to multiply by the base point with a 4-tooth comb over a
+// 1.5K table in flash, which needs 64 doublings and additions instead
+// of 255 of each.  The default is to use it except on AVR.
+#if !defined(CRYPTO_ED25519_BASE_TABLE)
+#if defined(__AVR__)
+#define CRYPTO_ED25519_BASE_TABLE 0
+#else
+#define CRYPTO_ED25519_BASE_TABLE 1
+#endif
+#endif
+
+// Number of signatures that verifyBatch() combines into one equation.
+// Each one needs 320 bytes of stack for its points and scalars.
+#if !defined(CRYPTO_ED25519_BATCH_SIZE)
+#if defined(__AVR__)
+#define CRYPTO_ED25519_BATCH_SIZE 2
+#else
+#define CRYPTO_ED25519_BATCH_SIZE 8
+#endif
+#endif
+
 /** @cond */
 
 // 37095705934669439343138083508754565189542113879843219016388785533085940283555
@@ -111,6 +132,144 @@ static limb_t const numQ[NUM_LIMBS_256BIT] PROGMEM = {
     LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x10000000)
 };
 
+#if CRYPTO_ED25519_BASE_TABLE
+
+// Comb table for the base point B.  Entry i is the sum of 2^(64 * j) * B
+// for the bits j that are set in i, so entry 0 is the neutral point, and
+// holds (y + x, y - x, 2 * d * x * y) of the affine point (x, y).
+static limb_t const baseTable[16][3][NUM_LIMBS_256BIT] PROGMEM = {
+    {
+        {LIMB_PAIR(0x00000001, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000)},
+        {LIMB_PAIR(0x00000001, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000)},
+        {LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000)}
+    },
+    {
+        {LIMB_PAIR(0xF58C3B85, 0x2FBC93C6), LIMB_PAIR(0xFB8C0E19, 0xCF932DC6),
+         LIMB_PAIR(0x643D42C2, 0x270B4898), LIMB_PAIR(0x33D4BA65, 0x07CF9D3A)},
+        {LIMB_PAIR(0xD740913E, 0x9D103905), LIMB_PAIR(0xD140BEB3, 0xFD399F05),
+         LIMB_PAIR(0x688F8A09, 0xA5C18434), LIMB_PAIR(0x98F81267, 0x44FD2F92)},
+        {LIMB_PAIR(0x877AAA68, 0xABC91205), LIMB_PAIR(0xCCAAC49E, 0x26D9E823),
+         LIMB_PAIR(0xDD43598C, 0x5A1B7DCB), LIMB_PAIR(0x9F0C65A8, 0x6F117B68)}
+    },
+    {
+        {LIMB_PAIR(0x77D1F515, 0xCD2A65E7), LIMB_PAIR(0x8FAA60F1, 0x54899187),
+         LIMB_PAIR(0xDABC06E5, 0xB1B73BBC), LIMB_PAIR(0xA97CC9FB, 0x654878CB)},
+        {LIMB_PAIR(0x8DF6B0FE, 0x51138EC7), LIMB_PAIR(0xE575F51B, 0x5397DA89),
+         LIMB_PAIR(0x717AF1B9, 0x09207A1D), LIMB_PAIR(0x2B20D650, 0x2102FDBA)},
+        {LIMB_PAIR(0x055CE6A1, 0x969EE405), LIMB_PAIR(0x1251AD29, 0x36BCA768),
+         LIMB_PAIR(0xAA7DA415, 0x3A1AF517), LIMB_PAIR(0x29ECB2BA, 0x0AD725DB)}
+    },
+    {
+        {LIMB_PAIR(0x601E59E8, 0x0055C585), LIMB_PAIR(0x66480E60, 0x8793342B),
+         LIMB_PAIR(0xFE45E44C, 0x3E14AAD0), LIMB_PAIR(0x4813CF2B, 0x26EAD8E6)},
+        {LIMB_PAIR(0x9C8462A4, 0xCB75B8B6), LIMB_PAIR(0x67D31CD7, 0x2DD86FC5),
+         LIMB_PAIR(0x881342F6, 0xCD1972EC), LIMB_PAIR(0x0FC12F2F, 0x0975B597)},
+        {LIMB_PAIR(0xDA5BA743, 0x63CF2303), LIMB_PAIR(0x52F1BA6E, 0x04BF9D81),
+         LIMB_PAIR(0xAA7367DA, 0x333790D0), LIMB_PAIR(0x9DF6C5EA, 0x53467047)}
+    },
+    {
+        {LIMB_PAIR(0xACAD8EA2, 0x583B04BF), LIMB_PAIR(0x148BE884, 0x29B743E8),
+         LIMB_PAIR(0x0810C5DB, 0x2B1E583B), LIMB_PAIR(0x8EB3BBAA, 0x2B5449E5)},
+        {LIMB_PAIR(0xEB3DBE47, 0x5F3A7562), LIMB_PAIR(0x8EBDA0B8, 0xF7EA3854),
+         LIMB_PAIR(0x45747299, 0x00C3E531), LIMB_PAIR(0x1627D551, 0x1304E9E7)},
+        {LIMB_PAIR(0x6ADC9CFE, 0x789814D2), LIMB_PAIR(0x8B48DD0B, 0x3C1BAB3F),
+         LIMB_PAIR(0xF979C60A, 0xDA0FE1FF), LIMB_PAIR(0x7C2DD693, 0x4468DE2D)}
+    },
+    {
+        {LIMB_PAIR(0xE3BC6748, 0x2118278D), LIMB_PAIR(0xD0B20EF7, 0xE71FFD60),
+         LIMB_PAIR(0xC67BB198, 0xF551BE51), LIMB_PAIR(0xD0543D4D, 0x26A13664)},
+        {LIMB_PAIR(0x13A339EE, 0x29522D3B), LIMB_PAIR(0x6CD89529, 0x85522550),
+         LIMB_PAIR(0xACF4F0F1, 0xDFEA3AD4), LIMB_PAIR(0x7942742E, 0x49D76BBA)},
+        {LIMB_PAIR(0x8D56E61D, 0x14FA4233), LIMB_PAIR(0xC351299A, 0x191D3946),
+         LIMB_PAIR(0xA7ADB185, 0x247D576D), LIMB_PAIR(0xA8FCEDC2, 0x4E1FAFE3)}
+    },
+    {
+        {LIMB_PAIR(0x236A044C, 0x15E7053D), LIMB_PAIR(0x3B8D87E3, 0x3CDDBCB1),
+         LIMB_PAIR(0xD321A828, 0x519960D2), LIMB_PAIR(0x0FC5BBA4, 0x4E559A0F)},
+        {LIMB_PAIR(0x9C12701C, 0xFE00E876), LIMB_PAIR(0x039C3B5F, 0x95DCDC0A),
+         LIMB_PAIR(0x0C02EB1B, 0xC169454B), LIMB_PAIR(0x5F87530C, 0x727021D3)},
+        {LIMB_PAIR(0x27DF241E, 0xA5710407), LIMB_PAIR(0xB2900D36, 0xDF45EFAA),
+         LIMB_PAIR(0x60A69ADE, 0xFE6EDB5C), LIMB_PAIR(0x07BBC01D, 0x64FCB730)}
+    },
+    {
+        {LIMB_PAIR(0x6FD390CA, 0x38EF58CC), LIMB_PAIR(0x171A98FC, 0xEF786575),
+         LIMB_PAIR(0xC442D65F, 0x8850B78F), LIMB_PAIR(0x6FD086EF, 0x6F34C66D)},
+        {LIMB_PAIR(0x3898DC04, 0x93F3CBB4), LIMB_PAIR(0x4307B727, 0x0791FFB2),
+         LIMB_PAIR(0xCE34981D, 0xD7BD8096), LIMB_PAIR(0x8B849F6D, 0x0B598B8E)},
+        {LIMB_PAIR(0x0CC2F689, 0x11CFC18A), LIMB_PAIR(0xB529CE2A, 0x81114607),
+         LIMB_PAIR(0xC00B5940, 0x0A9BC046), LIMB_PAIR(0xB1AC66C8, 0x412128B0)}
+    },
+    {
+        {LIMB_PAIR(0xC80C1AC0, 0xA66DCC9D), LIMB_PAIR(0x1B38A436, 0x97A05CF4),
+         LIMB_PAIR(0x95DBD7C6, 0xA7EBF3BE), LIMB_PAIR(0x8D7E7DAB, 0x7DA0B8F6)},
+        {LIMB_PAIR(0x385675A6, 0xEF782014), LIMB_PAIR(0xAAFDA9E8, 0xA2649F30),
+         LIMB_PAIR(0x5CDFA8CB, 0x4CD1EB50), LIMB_PAIR(0x1D4DC0B3, 0x46115ABA)},
+        {LIMB_PAIR(0xC3B5DA76, 0xD40F1953), LIMB_PAIR(0x21119E9B, 0x1DAC6F73),
+         LIMB_PAIR(0xFEB25960, 0x03CC6021), LIMB_PAIR(0x83674B4B, 0x5A5F887E)}
+    },
+    {
+        {LIMB_PAIR(0x0CA2C1F4, 0x0A8D6018), LIMB_PAIR(0xCC68DF40, 0x815EB0DB),
+         LIMB_PAIR(0xB82F4E99, 0xD7E67A47), LIMB_PAIR(0x607F15C0, 0x45A02890)},
+        {LIMB_PAIR(0xFD41F184, 0xFEF366D1), LIMB_PAIR(0x01CFE11E, 0x8B694A11),
+         LIMB_PAIR(0x0150A74D, 0x4B39E15E), LIMB_PAIR(0x6AD351BA, 0x4013F03D)},
+        {LIMB_PAIR(0x6EE065CC, 0xBD0282DC), LIMB_PAIR(0x224AE646, 0x36B994FD),
+         LIMB_PAIR(0xFEBCE874, 0x534E9AD8), LIMB_PAIR(0xD9F06E4F, 0x482255C1)}
+    },
+    {
+        {LIMB_PAIR(0x71CEF800, 0x3C03EACF), LIMB_PAIR(0xCA8AFEBB, 0x90367544),
+         LIMB_PAIR(0x6A29C477, 0x383FEA28), LIMB_PAIR(0xBC655462, 0x4E8593B0)},
+        {LIMB_PAIR(0xA3E5638C, 0x12DE114A), LIMB_PAIR(0x29C4F20D, 0xBA2A4AA9),
+         LIMB_PAIR(0x7B8B13A3, 0x56B0D29D), LIMB_PAIR(0x7B9B7944, 0x6BB91A49)},
+        {LIMB_PAIR(0xC5E7D206, 0x2A49E646), LIMB_PAIR(0x9263C445, 0xB13EF9CD),
+         LIMB_PAIR(0xEDAB529E, 0x50AB6CE8), LIMB_PAIR(0xB0EBE39B, 0x20CF7D79)}
+    },
+    {
+        {LIMB_PAIR(0x8AE75C48, 0xCBD28F4E), LIMB_PAIR(0x44000B60, 0x3CDE0291),
+         LIMB_PAIR(0x98BC2170, 0x373BB9C8), LIMB_PAIR(0x9F570886, 0x7C118853)},
+        {LIMB_PAIR(0xF0FE7DCA, 0x7DB4939D), LIMB_PAIR(0xCBA951CE, 0xF50EB90F),
+         LIMB_PAIR(0x357E1D1D, 0x098BE61C), LIMB_PAIR(0x8899469D, 0x02356237)},
+        {LIMB_PAIR(0xE15A4C03, 0x20F6EFFA), LIMB_PAIR(0x3C778E05, 0x2F470A94),
+         LIMB_PAIR(0xFC99DE67, 0x79F50A03), LIMB_PAIR(0xD1061483, 0x38D20188)}
+    },
+    {
+        {LIMB_PAIR(0x0E6315DF, 0x23E811AD), LIMB_PAIR(0xE2AEB290, 0x0B650D05),
+         LIMB_PAIR(0xA75D586C, 0xB7BA0F59), LIMB_PAIR(0x5E1F4DEE, 0x043EEDD4)},
+        {LIMB_PAIR(0xC7073217, 0xF6C147F2), LIMB_PAIR(0xF3AFD20C, 0xC651B919),
+         LIMB_PAIR(0x7041F802, 0x258FDBFD), LIMB_PAIR(0x4F45073E, 0x173C4FA9)},
+        {LIMB_PAIR(0x928DF9C4, 0x3D71EA60), LIMB_PAIR(0x3373562D, 0x5B7E7806),
+         LIMB_PAIR(0xA29552B2, 0xD9B0514C), LIMB_PAIR(0x993CC472, 0x1E2A7024)}
+    },
+    {
+        {LIMB_PAIR(0xD45C811F, 0x601A0FBC), LIMB_PAIR(0x92EC0803, 0x24B7BC7D),
+         LIMB_PAIR(0x17D2407F, 0xA0CAE62B), LIMB_PAIR(0x06225B26, 0x5FCB43EE)},
+        {LIMB_PAIR(0x3509FBA4, 0x310509B9), LIMB_PAIR(0x05631B75, 0x0D8DB376),
+         LIMB_PAIR(0x52401C87, 0x97DECCBA), LIMB_PAIR(0x11B2E773, 0x044649F4)},
+        {LIMB_PAIR(0x9598215F, 0x0C0D24AD), LIMB_PAIR(0xCC36628C, 0x1B7F9026),
+         LIMB_PAIR(0x7016DCEA, 0x338E2F55), LIMB_PAIR(0x5CC0E58F, 0x0C8A1BFA)}
+    },
+    {
+        {LIMB_PAIR(0x681D104C, 0x8DE703B5), LIMB_PAIR(0x1263CB45, 0x3D2F7A59),
+         LIMB_PAIR(0x1CE56C63, 0xAE710C17), LIMB_PAIR(0xFCC3E6CA, 0x6B857C7E)},
+        {LIMB_PAIR(0x8B2801C0, 0x79D256B4), LIMB_PAIR(0x3C400FC4, 0x7E9FBEAC),
+         LIMB_PAIR(0x4733BA41, 0xA751AB1D), LIMB_PAIR(0xDD418ACA, 0x09DE2BF5)},
+        {LIMB_PAIR(0xEFF0687F, 0x3BF10FF3), LIMB_PAIR(0xF1E37BA2, 0x5EBAEA34),
+         LIMB_PAIR(0x1D66034D, 0xE49E6126), LIMB_PAIR(0xC3B242CA, 0x5B466E2A)}
+    },
+    {
+        {LIMB_PAIR(0x47FBB842, 0x137EEB67), LIMB_PAIR(0x60811A8B, 0x79DF5C75),
+         LIMB_PAIR(0x71F8C89A, 0x5A2BA76F), LIMB_PAIR(0x3BC8FFC2, 0x09952A56)},
+        {LIMB_PAIR(0xDC7EF83C, 0xA2A8CB4B), LIMB_PAIR(0x5F93C226, 0x96B5C6FA),
+         LIMB_PAIR(0x0664E3A5, 0xD4EBEB1B), LIMB_PAIR(0xE5C6CF2F, 0x409B4ADC)},
+        {LIMB_PAIR(0x834350C4, 0x44D53DB9), LIMB_PAIR(0xA5F505B4, 0x89299305),
+         LIMB_PAIR(0x5949FF2F, 0xFB22FAA2), LIMB_PAIR(0x04657D64, 0x69B968A7)}
+    }
+};
+
+#endif
+
 /** @endcond */
 
 /**
@@ -184,7 +343,11 @@ void Ed25519::sign(uint8_t signature[64], const uint8_t privateKey[32],
  * \return Returns true if the \a signature is valid for \a message;
  * or false if the \a signature is not valid.
  *
- * \sa sign()
+ * The equation 8 * s * B = 8 * R + 8 * k * A is checked with the cofactor
+ * as in RFC 8032, and public keys or R values of small order are rejected,
+ * so that verify() and verifyBatch() always give the same answer.
+ *
+ * \sa sign(), verifyBatch()
  */
 bool Ed25519::verify(const uint8_t signature[64], const uint8_t publicKey[32],
                      const void *message, size_t len)
@@ -197,8 +360,10 @@ bool Ed25519::verify(const uint8_t signature[64], const uint8_t publicKey[32],
     uint8_t *k = (uint8_t *)(hash.state.w); // Reuse hash buffer to save memory.
     bool result = false;
 
-    // Decode the public key and the R component of the signature.
-    if (decodePoint(A, publicKey) && decodePoint(R, signature)) {
+    // Decode the public key and the R component of the signature,
+    // using sB as scratch to reject points of small order.
+    if (decodePoint(A, publicKey) && decodePoint(R, signature) &&
+            !isSmallOrder(A, sB) && !isSmallOrder(R, sB)) {
         // Reconstruct the k value from the signing step.
         hash.reset();
         hash.update(signature, 32);
@@ -206,18 +371,27 @@ bool Ed25519::verify(const uint8_t signature[64], const uint8_t publicKey[32],
         hash.update(message, len);
         hash.finalize(k, 0);
 
+        // Calculate R + k * A.  sB is not needed until later,
+        // so we reuse sB.t as a temporary buffer when reducing k.
+        reduceQFromBuffer(sB.t, k, kA.x);
+        mul(kA, sB.t, A, false);
+        add(R, kA);
+
         // Calculate s * B.  The s value is stored temporarily in kA.t.
         BigNumberUtil::unpackLE(kA.t, NUM_LIMBS_256BIT, signature + 32, 32);
         mul(sB, kA.t, false);
 
-        // Calculate R + k * A.  We don't need sB.t in equal() below,
-        // so we reuse that as a temporary buffer when reducing k.
-        reduceQFromBuffer(sB.t, k, kA.x);
-        mul(kA, sB.t, A, false);
-        add(R, kA);
+        // Subtract R + k * A, which is negated by negating x and t.
+        memset(kA.x, 0, sizeof(kA.x));
+        Curve25519::sub(R.x, kA.x, R.x);
+        Curve25519::sub(R.t, kA.x, R.t);
+        add(sB, R);
 
-        // Compare s * B and R + k * A for equality.
-        result = equal(sB, R);
+        // Multiply by the cofactor and compare with the neutral point.
+        dbl(sB);
+        dbl(sB);
+        dbl(sB);
+        result = isNeutral(sB);
     }
 
     // Clean up and exit.
@@ -228,6 +402,59 @@ bool Ed25519::verify(const uint8_t signature[64], const uint8_t publicKey[32],
     return result;
 }
 
+/**
+ * \brief Verifies a batch of signatures in one pass.
+ *
+ * \param count The number of signatures to verify.
+ * \param signatures The signature values to be verified.
+ * \param publicKeys The public keys to use to verify each signature.
+ * \param messages The messages whose signatures are to be verified.
+ * \param lens The lengths of each of the \a messages.
+ *
+ * \return Returns true if all \a count signatures are valid; or false if
+ * at least one of them is not valid.
+ *
+ * The signatures are checked in groups of up to 8 (2 on AVR) by a random
+ * linear combination: for random 128-bit z[i], the group is accepted if
+ * (sum of z[i] * s[i]) * B equals the sum of z[i] * R[i] + z[i] * k[i] * A[i].
+ * The right hand side is one multi-scalar multiplication that shares its
+ * 253 doublings across the group, so a group of 8 costs about 60% of
+ * 8 calls to verify().
+ *
+ * The coefficients are derived from RNG.rand() and from the signatures,
+ * keys, and messages of the group.  Only the signer must not be able to predict
+ * them, so this is still sound if the random pool has not been seeded yet
+ * when the batch is checked.
+ *
+ * The equation is multiplied by the cofactor 8 and public keys or R values
+ * of small order are rejected, exactly as in verify().  Without the
+ * cofactor a random combination could not be sound: a small-order
+ * component of a bad signature vanishes from it for up to half of the z[i].
+ * So the batch is accepted if and only if verify() accepts every
+ * signature in it, except with probability 2^-128.
+ *
+ * If this function returns false, call verify() on each signature to
+ * find out which ones are invalid.
+ *
+ * \sa verify()
+ */
+bool Ed25519::verifyBatch(size_t count, const uint8_t *const signatures[],
+                          const uint8_t *const publicKeys[],
+                          const void *const messages[], const size_t lens[])
+{
+    bool result = true;
+    size_t posn, n;
+
+    for (posn = 0; result && posn < count; posn += n) {
+        n = count - posn;
+        if (n > CRYPTO_ED25519_BATCH_SIZE)
+            n = CRYPTO_ED25519_BATCH_SIZE;
+        result = verifyGroup((uint8_t)n, signatures + posn, publicKeys + posn,
+                             messages + posn, lens + posn);
+    }
+    return result;
+}
+
 /**
  * \brief Generates a private key for Ed25519 signing operations.
  *
@@ -453,6 +680,88 @@ void Ed25519::mul(Point &result, const limb_t *s, Point &p, bool constTime)
  */
 void Ed25519::mul(Point &result, const limb_t *s, bool constTime)
 {
+#if CRYPTO_ED25519_BASE_TABLE
+    limb_t A[NUM_LIMBS_256BIT];
+    limb_t B[NUM_LIMBS_256BIT];
+    limb_t C[NUM_LIMBS_256BIT];
+    limb_t D[NUM_LIMBS_256BIT];
+    limb_t entry[3][NUM_LIMBS_256BIT];
+    limb_t temp[NUM_LIMBS_256BIT];
+    uint8_t posn, index, i, j;
+
+    // The table lookup is always constant-time, so constTime is not needed.
+    (void)constTime;
+
+    // Initialize the result to (0, 1, 1, 0).
+    memset(&result, 0, sizeof(Point));
+    result.y[0] = 1;
+    result.z[0] = 1;
+
+    // Process the comb from the top: result = 2 * result + T[index], where
+    // the bits of index are the bits posn, posn + 64, posn + 128, and
+    // posn + 192 of s.
+    for (posn = 64; posn > 0; --posn) {
+        // Double the result.
+        Curve25519::sub(A, result.y, result.x);
+        Curve25519::square(A, A);
+        Curve25519::add(B, result.y, result.x);
+        Curve25519::square(B, B);
+        Curve25519::square(C, result.t);
+        Curve25519::mul_P(C, C, numDx2);
+        Curve25519::square(D, result.z);
+        Curve25519::add(D, D, D);
+        Curve25519::sub(result.t, B, A);        // E = B - A
+        Curve25519::sub(result.z, D, C);        // F = D - C
+        Curve25519::add(D, D, C);               // G = D + C
+        Curve25519::add(B, B, A);               // H = B + A
+        Curve25519::mul(result.x, result.t, result.z);
+        Curve25519::mul(result.y, D, B);
+        Curve25519::mul(result.z, result.z, D);
+        Curve25519::mul(result.t, result.t, B);
+
+        // Select the table entry without revealing the index in the
+        // memory access pattern: read every entry and keep the right one.
+        index = 0;
+        for (j = 0; j < 4; ++j) {
+            uint8_t bit = (posn - 1) + j * 64;
+            index |= ((s[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1) << j;
+        }
+        for (i = 0; i < 16; ++i) {
+            limb_t select = (limb_t)((((uint16_t)(index ^ i)) - 1) >> 8) & 1;
+            for (j = 0; j < 3; ++j) {
+                memcpy_P(temp, baseTable[i][j], sizeof(temp));
+                if (i == 0)
+                    memcpy(entry[j], temp, sizeof(temp));
+                else
+                    Curve25519::cmove(select, entry[j], temp);
+            }
+        }
+
+        // Add the entry, which has z = 1, to the result.
+        Curve25519::sub(A, result.y, result.x);
+        Curve25519::mul(A, A, entry[1]);
+        Curve25519::add(B, result.y, result.x);
+        Curve25519::mul(B, B, entry[0]);
+        Curve25519::mul(C, result.t, entry[2]);
+        Curve25519::add(D, result.z, result.z);
+        Curve25519::sub(result.t, B, A);        // E = B - A
+        Curve25519::sub(result.z, D, C);        // F = D - C
+        Curve25519::add(D, D, C);               // G = D + C
+        Curve25519::add(B, B, A);               // H = B + A
+        Curve25519::mul(result.x, result.t, result.z);
+        Curve25519::mul(result.y, D, B);
+        Curve25519::mul(result.z, result.z, D);
+        Curve25519::mul(result.t, result.t, B);
+    }
+
+    // Clean up.
+    clean(A);
+    clean(B);
+    clean(C);
+    clean(D);
+    clean(entry);
+    clean(temp);
+#else
     Point P;
     memcpy_P(P.x, numBx, sizeof(P.x));
     memcpy_P(P.y, numBy, sizeof(P.y));
@@ -460,6 +769,7 @@ void Ed25519::mul(Point &result, const limb_t *s, bool constTime)
     memcpy_P(P.t, numBt, sizeof(P.t));
     mul(result, s, P, constTime);
     clean(P);
+#endif
 }
 
 /**
@@ -500,6 +810,171 @@ void Ed25519::add(Point &p, const Point &q)
     clean(D);
 }
 
+/**
+ * \brief Verifies a group of signatures for verifyBatch().
+ *
+ * \param count The number of signatures, at most CRYPTO_ED25519_BATCH_SIZE.
+ * \param signatures The signature values to be verified.
+ * \param publicKeys The public keys to use to verify each signature.
+ * \param messages The messages whose signatures are to be verified.
+ * \param lens The lengths of each of the \a messages.
+ *
+ * \return Returns true if all \a count signatures are valid.
+ */
+bool Ed25519::verifyGroup(uint8_t count, const uint8_t *const signatures[],
+                          const uint8_t *const publicKeys[],
+                          const void *const messages[], const size_t lens[])
+{
+    SHA512 hash;
+    Point A[CRYPTO_ED25519_BATCH_SIZE];
+    Point R[CRYPTO_ED25519_BATCH_SIZE];
+    Point sum;
+    Point sB;
+    limb_t z[CRYPTO_ED25519_BATCH_SIZE][NUM_LIMBS_128BIT];
+    limb_t zk[CRYPTO_ED25519_BATCH_SIZE][NUM_LIMBS_256BIT];
+    limb_t s[NUM_LIMBS_256BIT];
+    limb_t zs[NUM_LIMBS_256BIT];
+    limb_t temp[NUM_LIMBS_512BIT + 1];
+    uint8_t seed[32];
+    uint8_t *k = (uint8_t *)(hash.state.w); // Reuse hash buffer to save memory.
+    bool result = true;
+    uint8_t i;
+    int bit;
+
+    // Bind the coefficients to fresh randomness and to the whole group.
+    RNG.rand(seed, sizeof(seed));
+    hash.reset();
+    hash.update(seed, sizeof(seed));
+    for (i = 0; i < count; ++i) {
+        hash.update(signatures[i], 64);
+        hash.update(publicKeys[i], 32);
+    }
+    hash.finalize(k, 0);
+    memcpy(seed, k, sizeof(seed));
+
+    // Decode the points and compute z[i], z[i] * k[i] mod q, and the
+    // sum of z[i] * s[i] mod q, which is accumulated in s.
+    memset(s, 0, sizeof(s));
+    for (i = 0; i < count; ++i) {
+        // sum is not needed until later, so use it as scratch.
+        if (!decodePoint(A[i], publicKeys[i]) ||
+                !decodePoint(R[i], signatures[i]) ||
+                isSmallOrder(A[i], sum) || isSmallOrder(R[i], sum)) {
+            result = false;
+            break;
+        }
+
+        // Reconstruct the k value from the signing step.
+        hash.reset();
+        hash.update(signatures[i], 32);
+        hash.update(publicKeys[i], 32);
+        hash.update(messages[i], lens[i]);
+        hash.finalize(k, 0);
+        reduceQFromBuffer(zk[i], k, temp);
+
+        // z[i] is the first 128 bits of H(seed || signature || k mod q).
+        hash.reset();
+        hash.update(seed, sizeof(seed));
+        hash.update(signatures[i], 64);
+        hash.update(zk[i], sizeof(zk[i]));
+        hash.finalize(k, 0);
+        BigNumberUtil::unpackLE(z[i], NUM_LIMBS_128BIT, k, 16);
+
+        // zk[i] = z[i] * k[i] mod q.
+        memset(temp, 0, sizeof(temp));
+        BigNumberUtil::mul(temp, z[i], NUM_LIMBS_128BIT, zk[i], NUM_LIMBS_256BIT);
+        reduceQ(zk[i], temp);
+
+        // s += z[i] * s[i] mod q.
+        BigNumberUtil::unpackLE(zs, NUM_LIMBS_256BIT, signatures[i] + 32, 32);
+        memset(temp, 0, sizeof(temp));
+        BigNumberUtil::mul(temp, z[i], NUM_LIMBS_128BIT, zs, NUM_LIMBS_256BIT);
+        reduceQ(zs, temp);
+        BigNumberUtil::add(s, s, zs, NUM_LIMBS_256BIT);
+        BigNumberUtil::reduceQuick_P(s, s, numQ, NUM_LIMBS_256BIT);
+    }
+
+    if (result) {
+        // Calculate the sum of z[i] * R[i] + zk[i] * A[i] from the top bit
+        // down, sharing the doublings between all of the points.  The
+        // scalars are public so there is no need for constant time.
+        memset(&sum, 0, sizeof(Point));
+        sum.y[0] = 1;
+        sum.z[0] = 1;
+        for (bit = 252; bit >= 0; --bit) {
+            dbl(sum);
+            for (i = 0; i < count; ++i) {
+                if (bit < 128 &&
+                        ((z[i][bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1) != 0)
+                    add(sum, R[i]);
+                if (((zk[i][bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1) != 0)
+                    add(sum, A[i]);
+            }
+        }
+
+        // Subtract s * B, which is negated by negating x and t.
+        mul(sB, s, false);
+        memset(temp, 0, sizeof(temp));
+        Curve25519::sub(sB.x, temp, sB.x);
+        Curve25519::sub(sB.t, temp, sB.t);
+        add(sum, sB);
+
+        // Multiply by the cofactor and compare with the neutral point.
+        dbl(sum);
+        dbl(sum);
+        dbl(sum);
+        result = isNeutral(sum);
+    }
+
+    // Clean up and exit.
+    clean(A);
+    clean(R);
+    clean(sum);
+    clean(sB);
+    clean(z);
+    clean(zk);
+    clean(s);
+    clean(zs);
+    clean(temp);
+    clean(seed);
+    return result;
+}
+
+/**
+ * \brief Doubles a curve point.
+ *
+ * \param p The point to double and the result.
+ */
+void Ed25519::dbl(Point &p)
+{
+    limb_t A[NUM_LIMBS_256BIT];
+    limb_t B[NUM_LIMBS_256BIT];
+    limb_t C[NUM_LIMBS_256BIT];
+    limb_t D[NUM_LIMBS_256BIT];
+
+    Curve25519::sub(A, p.y, p.x);
+    Curve25519::square(A, A);
+    Curve25519::add(B, p.y, p.x);
+    Curve25519::square(B, B);
+    Curve25519::square(C, p.t);
+    Curve25519::mul_P(C, C, numDx2);
+    Curve25519::square(D, p.z);
+    Curve25519::add(D, D, D);
+    Curve25519::sub(p.t, B, A);             // E = B - A
+    Curve25519::sub(p.z, D, C);             // F = D - C
+    Curve25519::add(D, D, C);               // G = D + C
+    Curve25519::add(B, B, A);               // H = B + A
+    Curve25519::mul(p.x, p.t, p.z);         // p.x = E * F
+    Curve25519::mul(p.y, D, B);             // p.y = G * H
+    Curve25519::mul(p.z, p.z, D);           // p.z = F * G
+    Curve25519::mul(p.t, p.t, B);           // p.t = E * H
+
+    clean(A);
+    clean(B);
+    clean(C);
+    clean(D);
+}
+
 /**
  * \brief Determine if two curve points are equal.
  *
@@ -527,6 +1002,53 @@ bool Ed25519::equal(const Point &p, const Point &q)
     return result;
 }
 
+/**
+ * \brief Determine if a curve point is the neutral point (0, 1).
+ *
+ * \param p The curve point.
+ *
+ * \return Returns true if \a p is the neutral point; false otherwise.
+ */
+bool Ed25519::isNeutral(const Point &p)
+{
+    limb_t a[NUM_LIMBS_256BIT];
+    limb_t b[NUM_LIMBS_256BIT];
+    limb_t x = 0;
+    bool result;
+
+    // x / z = 0 and y / z = 1, with z non-zero.
+    Curve25519::mul(a, p.x, p.z);
+    for (uint8_t posn = 0; posn < NUM_LIMBS_256BIT; ++posn)
+        x |= a[posn];
+    Curve25519::mul(a, p.y, p.z);
+    Curve25519::square(b, p.z);
+    result = (x == 0) & secure_compare(a, b, sizeof(a));
+
+    clean(a);
+    clean(b);
+    return result;
+}
+
+/**
+ * \brief Determine if a curve point has small order, which is 1, 2, 4 or 8.
+ *
+ * \param p The curve point.
+ * \param temp Scratch point, overwritten.
+ *
+ * \return Returns true if 8 * \a p is the neutral point.
+ *
+ * Such points only appear in crafted keys and signatures: they would let
+ * a signature pass the equation with the cofactor for any message.
+ */
+bool Ed25519::isSmallOrder(const Point &p, Point &temp)
+{
+    temp = p;
+    dbl(temp);
+    dbl(temp);
+    dbl(temp);
+    return isNeutral(temp);
+}
+
 /**
  * \brief Encodes a curve point into a 32-byte buffer.
  *
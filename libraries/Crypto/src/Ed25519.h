@@ -34,6 +34,9 @@ public:
                      size_t len);
     static bool verify(const uint8_t signature[64], const uint8_t publicKey[32],
                        const void *message, size_t len);
+    static bool verifyBatch(size_t count, const uint8_t *const signatures[],
+                            const uint8_t *const publicKeys[],
+                            const void *const messages[], const size_t lens[]);
 
     static void generatePrivateKey(uint8_t privateKey[32]);
     static void derivePublicKey(uint8_t publicKey[32], const uint8_t privateKey[32]);
@@ -58,9 +61,16 @@ private:
     static void mul(Point &result, const limb_t *s, Point &p, bool constTime = true);
     static void mul(Point &result, const limb_t *s, bool constTime = true);
 
+    static bool verifyGroup(uint8_t count, const uint8_t *const signatures[],
+                            const uint8_t *const publicKeys[],
+                            const void *const messages[], const size_t lens[]);
+
     static void add(Point &p, const Point &q);
+    static void dbl(Point &p);
 
     static bool equal(const Point &p, const Point &q);
+    static bool isNeutral(const Point &p);
+    static bool isSmallOrder(const Point &p, Point &temp);
 
     static void encodePoint(uint8_t *buf, Point &point);
     static bool decodePoint(Point &point, const uint8_t *buf);
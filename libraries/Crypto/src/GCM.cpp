@@ -250,6 +250,56 @@ bool GCMCommon::checkTag(const void *tag, size_t len)
     return secure_compare(state.counter, tag, len);
 }
 
+/**
+ * \brief Encrypts and authenticates a buffer in place in a single pass.
+ *
+ * Each 16 byte block is hashed by GHASH as soon as it has been encrypted,
+ * while it is still in the cache, rather than after the whole buffer.
+ *
+ * \sa AuthenticatedCipher::seal()
+ */
+void GCMCommon::seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag)
+{
+    GCMCommon::addAuthData(aad, aadLen);
+    while (len > 0) {
+        size_t size = (state.posn < 16) ? (16 - state.posn) : 16;
+        if (size > len)
+            size = len;
+        GCMCommon::encrypt(buf, buf, size);
+        buf += size;
+        len -= size;
+    }
+    GCMCommon::computeTag(tag, 16);
+}
+
+/**
+ * \brief Decrypts and checks a buffer in place in a single pass.
+ *
+ * Each 16 byte block is hashed by GHASH just before it is decrypted.
+ * On failure the buffer is cleared.
+ *
+ * \sa AuthenticatedCipher::open()
+ */
+bool GCMCommon::open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag)
+{
+    uint8_t *start = buf;
+    size_t total = len;
+    GCMCommon::addAuthData(aad, aadLen);
+    while (len > 0) {
+        size_t size = (state.posn < 16) ? (16 - state.posn) : 16;
+        if (size > len)
+            size = len;
+        GCMCommon::decrypt(buf, buf, size);
+        buf += size;
+        len -= size;
+    }
+    if (!GCMCommon::checkTag(tag, 16)) {
+        clean(start, total);
+        return false;
+    }
+    return true;
+}
+
 void GCMCommon::clear()
 {
     blockCipher->clear();
@@ -258,6 +308,33 @@ void GCMCommon::clear()
     state.posn = 16;
 }
 
+/**
+ * \brief Selects table-driven GHASH for this GCM object.
+ *
+ * \param table Points to the 256 byte table to use, or NULL to return
+ * to the default constant-time GHASH.
+ *
+ * The table-driven GHASH is several times faster on 32-bit platforms
+ * but its memory accesses depend upon the data being authenticated.
+ * The default bit by bit GHASH is resistant to cache timing attacks and
+ * should be kept where that matters.  The table must remain valid while
+ * this object uses it and is wiped by clear():
+ *
+ * \code
+ * GCM<AES256> gcm;
+ * GHASH::Table table;
+ * gcm.setHashTable(&table);
+ * gcm.setKey(key, sizeof(key));
+ * gcm.setIV(iv, sizeof(iv));
+ * \endcode
+ *
+ * \sa GHASH::setTable()
+ */
+void GCMCommon::setHashTable(GHASH::Table *table)
+{
+    ghash.setTable(table);
+}
+
 /**
  * \fn void GCMCommon::setBlockCipher(BlockCipher *cipher)
  * \brief Sets the block cipher to use for this GCM object.
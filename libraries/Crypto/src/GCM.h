@@ -47,8 +47,13 @@ public:
     void computeTag(void *tag, size_t len);
     bool checkTag(const void *tag, size_t len);
 
+    void seal(uint8_t *buf, size_t len, const void *aad, size_t aadLen, void *tag);
+    bool open(uint8_t *buf, size_t len, const void *aad, size_t aadLen, const void *tag);
+
     void clear();
 
+    void setHashTable(GHASH::Table *table);
+
 protected:
     GCMCommon();
     void setBlockCipher(BlockCipher *cipher) { blockCipher = cipher; }
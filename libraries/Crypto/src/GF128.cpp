@@ -22,6 +22,7 @@
 
 #include "GF128.h"
 #include "utility/EndianUtil.h"
+#include "utility/ProgMemUtil.h"
 #include <string.h>
 
 /**
@@ -298,6 +299,115 @@ void GF128::mul(uint32_t Y[4], const uint32_t H[4])
 #endif // !__AVR__
 }
 
+// Reduction of the four bits shifted out of the bottom of Z by mulTable(),
+// to be XOR'ed into the top 16 bits of Z0.
+static uint16_t const reduce4[16] PROGMEM = {
+    0x0000, 0x1C20, 0x3840, 0x2460, 0x7080, 0x6CA0, 0x48C0, 0x54E0,
+    0xE100, 0xFD20, 0xD940, 0xC560, 0x9180, 0x8DA0, 0xA9C0, 0xB5E0
+};
+
+/**
+ * \brief Initialize table-driven multiplication in the GF(2^128) field.
+ *
+ * \param M The 256 byte table to be initialized with the products of H
+ * and all 4-bit values.
+ * \param H The hash key, which must have been initialized by mulInit().
+ *
+ * The table is used by mulTable(), which implements the 4-bit method of
+ * Shoup and is several times faster than mul() on 32-bit platforms.
+ * The table contains secret material and should be cleaned after use.
+ *
+ * \sa mulTable(), mulInit()
+ */
+void GF128::mulInitTable(uint32_t M[16][4], const uint32_t H[4])
+{
+#if defined(__AVR__)
+    // mulInit() leaves H in big endian order on AVR.
+    uint32_t V0 = be32toh(H[0]);
+    uint32_t V1 = be32toh(H[1]);
+    uint32_t V2 = be32toh(H[2]);
+    uint32_t V3 = be32toh(H[3]);
+#else
+    uint32_t V0 = H[0];
+    uint32_t V1 = H[1];
+    uint32_t V2 = H[2];
+    uint32_t V3 = H[3];
+#endif
+    uint8_t i, j;
+
+    // The top bit of each 4-bit index is the x^0 coefficient, so
+    // M[8] = H, M[4] = H * x, M[2] = H * x^2, and M[1] = H * x^3.
+    M[0][0] = M[0][1] = M[0][2] = M[0][3] = 0;
+    for (i = 8; i > 0; i >>= 1) {
+        M[i][0] = V0;
+        M[i][1] = V1;
+        M[i][2] = V2;
+        M[i][3] = V3;
+        uint32_t mask = ((~(V3 & 0x01)) + 1) & 0xE1000000;
+        V3 = (V3 >> 1) | (V2 << 31);
+        V2 = (V2 >> 1) | (V1 << 31);
+        V1 = (V1 >> 1) | (V0 << 31);
+        V0 = (V0 >> 1) ^ mask;
+    }
+
+    // The remaining entries are sums of the powers above.
+    for (i = 2; i < 16; i <<= 1) {
+        for (j = 1; j < i; ++j) {
+            M[i + j][0] = M[i][0] ^ M[j][0];
+            M[i + j][1] = M[i][1] ^ M[j][1];
+            M[i + j][2] = M[i][2] ^ M[j][2];
+            M[i + j][3] = M[i][3] ^ M[j][3];
+        }
+    }
+    V0 = V1 = V2 = V3 = 0;
+}
+
+/**
+ * \brief Perform a table-driven multiplication in the GF(2^128) field.
+ *
+ * \param Y The first value to multiply, and the result.  This array is
+ * assumed to be in big-endian order on entry and exit.
+ * \param M The table for the second value, which must have been
+ * initialized by the mulInitTable() function.
+ *
+ * Unlike mul(), the memory accesses of this function depend upon the
+ * value of \a Y, so it may be vulnerable to cache timing attacks on
+ * platforms with a data cache.
+ *
+ * \sa mulInitTable(), mul()
+ */
+void GF128::mulTable(uint32_t Y[4], const uint32_t M[16][4])
+{
+    uint32_t Z0 = 0;        // Z = 0
+    uint32_t Z1 = 0;
+    uint32_t Z2 = 0;
+    uint32_t Z3 = 0;
+
+    // Horner's rule over the 4-bit digits of Y, starting at the
+    // x^124 end: Z = Z * x^4 + digit * H.
+    for (uint8_t posn = 16; posn > 0; --posn) {
+        uint8_t value = ((const uint8_t *)Y)[posn - 1];
+        for (uint8_t half = 0; half < 2; ++half, value >>= 4) {
+            uint8_t digit = value & 0x0F;
+            uint32_t reduce = ((uint32_t)pgm_read_word(reduce4 + (Z3 & 0x0F))) << 16;
+            Z3 = (Z3 >> 4) | (Z2 << 28);
+            Z2 = (Z2 >> 4) | (Z1 << 28);
+            Z1 = (Z1 >> 4) | (Z0 << 28);
+            Z0 = (Z0 >> 4) ^ reduce;
+            Z0 ^= M[digit][0];
+            Z1 ^= M[digit][1];
+            Z2 ^= M[digit][2];
+            Z3 ^= M[digit][3];
+        }
+    }
+
+    // Copy Z into Y and byte-swap.
+    Y[0] = htobe32(Z0);
+    Y[1] = htobe32(Z1);
+    Y[2] = htobe32(Z2);
+    Y[3] = htobe32(Z3);
+}
+
 /**
  * \brief Doubles a value in the GF(2^128) field.
  *
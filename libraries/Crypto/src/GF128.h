@@ -34,6 +34,8 @@ private:
 public:
     static void mulInit(uint32_t H[4], const void *key);
     static void mul(uint32_t Y[4], const uint32_t H[4]);
+    static void mulInitTable(uint32_t M[16][4], const uint32_t H[4]);
+    static void mulTable(uint32_t Y[4], const uint32_t M[16][4]);
     static void dbl(uint32_t V[4]);
     static void dblEAX(uint32_t V[4]);
     static void dblXTS(uint32_t V[4]);
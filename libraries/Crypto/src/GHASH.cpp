@@ -45,8 +45,9 @@
  * \brief Constructs a new GHASH message authenticator.
  */
 GHASH::GHASH()
+    : table(0)
 {
-    state.posn = 0;
+    memset(&state, 0, sizeof(state));
 }
 
 /**
@@ -54,7 +55,33 @@ GHASH::GHASH()
  */
 GHASH::~GHASH()
 {
-    clean(state);
+    clear();
+}
+
+/**
+ * \brief Selects table-driven multiplication for this authenticator.
+ *
+ * \param table Points to the 256 byte table to use, or NULL to return
+ * to the default bit by bit multiplication.
+ *
+ * The table-driven mode is several times faster on 32-bit platforms but
+ * its memory accesses depend upon the data being hashed, so it may leak
+ * timing information on platforms with a data cache.  The table is owned
+ * by the caller, must remain valid while this object uses it, and is
+ * filled in by reset() and wiped by clear().
+ *
+ * If the authenticator has already been reset(), then the table is
+ * initialized from the current key.
+ *
+ * \sa reset()
+ */
+void GHASH::setTable(Table *table)
+{
+    if (this->table && this->table != table)
+        clean(*(this->table));
+    this->table = table;
+    if (table)
+        GF128::mulInitTable(table->M, state.H);
 }
 
 /**
@@ -67,6 +94,8 @@ GHASH::~GHASH()
 void GHASH::reset(const void *key)
 {
     GF128::mulInit(state.H, key);
+    if (table)
+        GF128::mulInitTable(table->M, state.H);
     memset(state.Y, 0, sizeof(state.Y));
     state.posn = 0;
 }
@@ -97,7 +126,7 @@ void GHASH::update(const void *data, size_t len)
         len -= size;
         d += size;
         if (state.posn == 16) {
-            GF128::mul(state.Y, state.H);
+            mul();
             state.posn = 0;
         }
     }
@@ -139,7 +168,7 @@ void GHASH::pad()
     if (state.posn != 0) {
         // Padding involves XOR'ing the rest of state.Y with zeroes,
         // which does nothing.  Immediately process the next chunk.
-        GF128::mul(state.Y, state.H);
+        mul();
         state.posn = 0;
     }
 }
@@ -150,4 +179,17 @@ void GHASH::pad()
 void GHASH::clear()
 {
     clean(state);
+    if (table)
+        clean(*table);
+}
+
+/**
+ * \brief Multiplies Y by H using the selected method.
+ */
+void GHASH::mul()
+{
+    if (table)
+        GF128::mulTable(state.Y, table->M);
+    else
+        GF128::mul(state.Y, state.H);
 }
@@ -29,9 +29,17 @@
 class GHASH
 {
 public:
+    /** Precomputed products of the hash key for table-driven GHASH. */
+    struct Table
+    {
+        uint32_t M[16][4];
+    };
+
     GHASH();
     ~GHASH();
 
+    void setTable(Table *table);
+
     void reset(const void *key);
     void update(const void *data, size_t len);
     void finalize(void *token, size_t len);
@@ -41,11 +49,14 @@ public:
     void clear();
 
 private:
+    Table *table;
     struct {
         uint32_t H[4];
         uint32_t Y[4];
         uint8_t posn;
     } state;
+
+    void mul();
 };
 
 #endif
@@ -39,10 +39,10 @@
  * This constructor must be followed by a call to setHashAlgorithm().
  */
 HKDFCommon::HKDFCommon()
-    : hash(0)
-    , buf(0)
+    : buf(0)
     , counter(1)
     , posn(255)
+    , hash(0)
 {
 }
 
@@ -122,6 +122,63 @@ void HKDFCommon::extract(void *out, size_t outLen, const void *info, size_t info
     }
 }
 
+/**
+ * \brief Expands one output of a HKDF session with its own \a info string.
+ *
+ * \param out Points to the buffer to fill with the output.
+ * \param outLen Number of bytes to write to the \a out buffer.
+ * \param info Points to the application-specific information string.
+ * \param infoLen Length of the \a info string in bytes.
+ *
+ * Unlike extract(), every call starts a new HKDF-Expand from the PRK set
+ * by setKey(), so the output is the same as a fresh setKey() followed by
+ * extract() with this \a info.  extract() calls that follow continue this
+ * output.
+ *
+ * \sa expandMany()
+ */
+void HKDFCommon::expand(void *out, size_t outLen, const void *info, size_t infoLen)
+{
+    counter = 1;
+    posn = hash->hashSize();
+    extract(out, outLen, info, infoLen);
+}
+
+/**
+ * \brief Expands several outputs of a HKDF session, one per \a info string.
+ *
+ * \param info Array of \a count application-specific information strings.
+ * \param infoLen Array of \a count lengths of the \a info strings in bytes.
+ * \param out Array of \a count output buffers.
+ * \param outLen Array of \a count output lengths in bytes.
+ * \param count Number of outputs to derive.
+ *
+ * This is equivalent to calling expand() for each output in turn, and is
+ * how session keys would normally be derived from a shared secret:
+ *
+ * \code
+ * static const char labelEnc[] = "enc";
+ * static const char labelMac[] = "mac";
+ * const void *info[2] = {labelEnc, labelMac};
+ * const size_t infoLen[2] = {3, 3};
+ * void *out[2] = {kEnc, kMac};
+ * const size_t outLen[2] = {sizeof(kEnc), sizeof(kMac)};
+ *
+ * HKDFT<SHA256> hkdf;
+ * hkdf.setKey(secret, sizeof(secret), salt, sizeof(salt));
+ * hkdf.expandMany(info, infoLen, out, outLen, 2);
+ * hkdf.clear();
+ * \endcode
+ *
+ * \sa expand()
+ */
+void HKDFCommon::expandMany(const void *const info[], const size_t infoLen[],
+                            void *const out[], const size_t outLen[], size_t count)
+{
+    for (size_t index = 0; index < count; ++index)
+        expand(out[index], outLen[index], info[index], infoLen[index]);
+}
+
 /**
  * \brief Clears sensitive information from this HKDF instance.
  */
@@ -192,6 +249,42 @@ void HKDFCommon::clear()
  * \brief Destroys a HKDF instance and all sensitive data within it.
  */
 
+/**
+ * \class HKDFT HKDF.h <HKDF.h>
+ * \brief HKDF mode for hash algorithms with static dispatch.
+ *
+ * This class behaves exactly like HKDF, but its setKey() and extract()
+ * functions are expanded for the specific hash algorithm T and call the
+ * HMAC functions of T directly rather than through the Hash vtable.
+ * The hash size is also a compile-time constant.  hkdf() uses this class.
+ *
+ * setKey() keeps the HMAC midstates of the PRK, which costs two extra hash
+ * states, so each output block of extract(), expand() or expandMany()
+ * hashes only the block of data instead of the key pads as well.
+ *
+ * These functions override the virtual ones of HKDFCommon, so an HKDFT
+ * object can also be used through a HKDFCommon pointer or reference.
+ * Calls on an object of known type are still resolved at compile time.
+ *
+ * \sa HKDF, hkdf()
+ */
+
+/**
+ * \fn HKDFT::HKDFT()
+ * \brief Constructs a new HKDFT object for the hash algorithm T.
+ */
+
+/**
+ * \fn HKDFT::~HKDFT()
+ * \brief Destroys a HKDFT instance and all sensitive data within it.
+ */
+
+/**
+ * \fn void HKDFT::clear()
+ * \brief Clears sensitive information, including the PRK midstates, from
+ * this HKDFT instance.
+ */
+
 /**
  * \fn void hkdf<T>(void *out, size_t outLen, const void *key, size_t keyLen, const void *salt, size_t saltLen, const void *info, size_t infoLen)
  * \brief All-in-one implementation of HKDF using a hash algorithm.
@@ -24,18 +24,24 @@
 #define CRYPTO_HKDF_h
 
 #include "Hash.h"
+#include "HMACKey.h"
 #include "Crypto.h"
+#include <string.h>
 
 class HKDFCommon
 {
 public:
     virtual ~HKDFCommon();
 
-    void setKey(const void *key, size_t keyLen, const void *salt = 0, size_t saltLen = 0);
+    virtual void setKey(const void *key, size_t keyLen, const void *salt = 0, size_t saltLen = 0);
 
-    void extract(void *out, size_t outLen, const void *info = 0, size_t infoLen = 0);
+    virtual void extract(void *out, size_t outLen, const void *info = 0, size_t infoLen = 0);
 
-    void clear();
+    virtual void expand(void *out, size_t outLen, const void *info = 0, size_t infoLen = 0);
+    virtual void expandMany(const void *const info[], const size_t infoLen[],
+                            void *const out[], const size_t outLen[], size_t count);
+
+    virtual void clear();
 
 protected:
     HKDFCommon();
@@ -45,11 +51,12 @@ protected:
         buf = buffer;
     }
 
-private:
-    Hash *hash;
     uint8_t *buf;
     uint8_t counter;
     uint8_t posn;
+
+private:
+    Hash *hash;
 };
 
 template <typename T>
@@ -64,11 +71,87 @@ private:
     uint8_t buffer[T::HASH_SIZE * 2];
 };
 
+template <typename T>
+class HKDFT : public HKDFCommon
+{
+public:
+    HKDFT() { setHashAlgorithm(&hashAlg, buffer); }
+    ~HKDFT() { ::clean(buffer, sizeof(buffer)); }
+
+    void setKey(const void *key, size_t keyLen, const void *salt = 0, size_t saltLen = 0)
+    {
+        // The PRK only ever keys HMAC: keep its midstates for extract().
+        if (salt && saltLen) {
+            hashAlg.T::resetHMAC(salt, saltLen);
+            hashAlg.T::update(key, keyLen);
+            hashAlg.T::finalizeHMAC(salt, saltLen, buffer + T::HASH_SIZE, T::HASH_SIZE);
+        } else {
+            memset(buffer, 0, T::HASH_SIZE);
+            hashAlg.T::resetHMAC(buffer, T::HASH_SIZE);
+            hashAlg.T::update(key, keyLen);
+            hashAlg.T::finalizeHMAC(buffer, T::HASH_SIZE, buffer + T::HASH_SIZE, T::HASH_SIZE);
+        }
+        prk.setKey(buffer + T::HASH_SIZE, T::HASH_SIZE);
+        counter = 1;
+        posn = T::HASH_SIZE;
+    }
+
+    void extract(void *out, size_t outLen, const void *info = 0, size_t infoLen = 0)
+    {
+        uint8_t *outPtr = (uint8_t *)out;
+        while (outLen > 0) {
+            if (posn >= T::HASH_SIZE) {
+                prk.reset(hashAlg);
+                if (counter != 1)
+                    hashAlg.T::update(buffer, T::HASH_SIZE);
+                if (info && infoLen)
+                    hashAlg.T::update(info, infoLen);
+                hashAlg.T::update(&counter, 1);
+                prk.finalize(hashAlg, buffer, T::HASH_SIZE);
+                ++counter;
+                posn = 0;
+            }
+            size_t len = T::HASH_SIZE - posn;
+            if (len > outLen)
+                len = outLen;
+            memcpy(outPtr, buffer + posn, len);
+            posn += len;
+            outPtr += len;
+            outLen -= len;
+        }
+    }
+
+    void expand(void *out, size_t outLen, const void *info = 0, size_t infoLen = 0)
+    {
+        counter = 1;
+        posn = T::HASH_SIZE;
+        HKDFT::extract(out, outLen, info, infoLen);
+    }
+
+    void expandMany(const void *const info[], const size_t infoLen[],
+                    void *const out[], const size_t outLen[], size_t count)
+    {
+        for (size_t index = 0; index < count; ++index)
+            HKDFT::expand(out[index], outLen[index], info[index], infoLen[index]);
+    }
+
+    void clear()
+    {
+        prk.clear();
+        HKDFCommon::clear();
+    }
+
+private:
+    T hashAlg;
+    HMACKey<T> prk;
+    uint8_t buffer[T::HASH_SIZE * 2];
+};
+
 template <typename T> void hkdf
     (void *out, size_t outLen, const void *key, size_t keyLen,
      const void *salt, size_t saltLen, const void *info, size_t infoLen)
 {
-    HKDF<T> context;
+    HKDFT<T> context;
     context.setKey(key, keyLen, salt, saltLen);
     context.extract(out, outLen, info, infoLen);
 }
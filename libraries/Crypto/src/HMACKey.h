@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CRYPTO_HMACKEY_h
+#define CRYPTO_HMACKEY_h
+
+#include "Hash.h"
+#include "Crypto.h"
+#include <string.h>
+
+template <typename T>
+class HMACKey
+{
+public:
+    HMACKey() {}
+    ~HMACKey() { clear(); }
+
+    void setKey(const void *key, size_t keyLen)
+    {
+        uint8_t block[T::BLOCK_SIZE];
+        size_t posn;
+
+        // Keys longer than a block are hashed first, as in formatHMACKey().
+        if (keyLen > T::BLOCK_SIZE) {
+            inner.reset();
+            inner.update(key, keyLen);
+            inner.finalize(block, T::HASH_SIZE);
+            keyLen = T::HASH_SIZE;
+        } else {
+            memcpy(block, key, keyLen);
+        }
+        memset(block + keyLen, 0, T::BLOCK_SIZE - keyLen);
+
+        // Hash the ipad and opad blocks once and keep the midstates.
+        for (posn = 0; posn < T::BLOCK_SIZE; ++posn)
+            block[posn] ^= 0x36;
+        inner.reset();
+        inner.update(block, T::BLOCK_SIZE);
+        for (posn = 0; posn < T::BLOCK_SIZE; ++posn)
+            block[posn] ^= (0x36 ^ 0x5c);
+        outer.reset();
+        outer.update(block, T::BLOCK_SIZE);
+        ::clean(block, sizeof(block));
+    }
+
+    void reset(T &hash) const { hash = inner; }
+
+    void finalize(T &hash, void *mac, size_t macLen) const
+    {
+        uint8_t temp[T::HASH_SIZE];
+        hash.finalize(temp, sizeof(temp));
+        hash = outer;
+        hash.update(temp, sizeof(temp));
+        hash.finalize(mac, macLen);
+        ::clean(temp, sizeof(temp));
+    }
+
+    void mac(void *out, size_t outLen, const void *data, size_t dataLen) const
+    {
+        T hash(inner);
+        hash.update(data, dataLen);
+        finalize(hash, out, outLen);
+    }
+
+    void clear()
+    {
+        inner.clear();
+        outer.clear();
+    }
+
+private:
+    T inner;
+    T outer;
+};
+
+#endif
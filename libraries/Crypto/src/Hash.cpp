@@ -21,6 +21,7 @@
  */
 
 #include "Hash.h"
+#include "Crypto.h"
 #include <string.h>
 
 /**
@@ -145,6 +146,68 @@ Hash::~Hash()
  * \sa resetHMAC(), finalize()
  */
 
+/**
+ * \brief Hashes a list of separate buffers in one call.
+ *
+ * \param in Array of \a inCount input segments, hashed in order as if
+ * they were one contiguous message.
+ * \param inCount Number of input segments.
+ * \param hash The buffer to return the hash value in.
+ * \param len The length of the \a hash buffer, normally hashSize().
+ *
+ * This resets the hash first, so the caller does not need to concatenate
+ * the message parts into a temporary buffer:
+ *
+ * \code
+ * HashInput in[3] = {{secret, 32}, {label, labelLen}, {salt, 32}};
+ * sha512.digestv(in, 3, digest, sizeof(digest));
+ * \endcode
+ *
+ * \sa reset(), update(), finalize()
+ */
+void Hash::digestv(const HashInput *in, size_t inCount, void *hash, size_t len)
+{
+    reset();
+    for (size_t i = 0; i < inCount; ++i)
+        update(in[i].data, in[i].len);
+    finalize(hash, len);
+}
+
+/**
+ * \brief Hashes a list of separate buffers and splits the hash value
+ * across separate output buffers.
+ *
+ * \param in Array of \a inCount input segments, hashed in order.
+ * \param inCount Number of input segments.
+ * \param out Array of \a outCount output segments, filled in order with
+ * consecutive bytes of the hash value.
+ * \param outCount Number of output segments.
+ *
+ * This is intended for key derivation where the hash value is cut into
+ * several keys, each written straight to where it is stored.  Output
+ * beyond hashSize() (or MAX_HASH_SIZE) bytes is left unchanged.
+ *
+ * \sa digestv()
+ */
+void Hash::digestv(const HashInput *in, size_t inCount,
+                   const HashOutput *out, size_t outCount)
+{
+    uint8_t result[MAX_HASH_SIZE];
+    size_t size = hashSize();
+    size_t posn = 0;
+    if (size > MAX_HASH_SIZE)
+        size = MAX_HASH_SIZE;
+    digestv(in, inCount, result, size);
+    for (size_t i = 0; i < outCount && posn < size; ++i) {
+        size_t len = out[i].len;
+        if (len > (size - posn))
+            len = size - posn;
+        memcpy(out[i].data, result + posn, len);
+        posn += len;
+    }
+    clean(result);
+}
+
 /**
  * \brief Formats a HMAC key into a block.
  *
@@ -200,3 +263,80 @@ void Hash::formatHMACKey(void *block, const void *key, size_t len, uint8_t pad)
  * hmac<SHA256>(out, sizeof(out), key, keyLen, data, dataLen);
  * \endcode
  */
+
+/**
+ * \class HMACKey HMACKey.h <HMACKey.h>
+ * \brief HMAC key with cached inner and outer hash states.
+ *
+ * Hash::resetHMAC() and Hash::finalizeHMAC() hash the padded key block
+ * on every call, which costs two extra compressions per HMAC value.
+ * HMACKey hashes the two padded blocks once in setKey() and starts each
+ * HMAC from a copy of the resulting states.  This halves the cost of a
+ * short HMAC when many values are computed under the same key.
+ *
+ * The template argument T must be the name of a class that inherits
+ * from Hash and defines HASH_SIZE and BLOCK_SIZE, such as SHA256:
+ *
+ * \code
+ * HMACKey<SHA256> key;
+ * SHA256 hash;
+ * key.setKey(secret, sizeof(secret));
+ * for (...) {
+ *     key.reset(hash);
+ *     hash.update(msg, msgLen);
+ *     key.finalize(hash, mac, sizeof(mac));
+ * }
+ * \endcode
+ *
+ * \sa hmac(), Hash::resetHMAC()
+ */
+
+/**
+ * \fn void HMACKey::setKey(const void *key, size_t keyLen)
+ * \brief Sets the HMAC key and computes the cached hash states.
+ *
+ * \param key Points to the HMAC key.
+ * \param keyLen Length of the \a key in bytes, which may be longer than
+ * the block size of T.
+ */
+
+/**
+ * \fn void HMACKey::reset(T &hash) const
+ * \brief Starts a new HMAC computation in \a hash.
+ *
+ * \param hash The hash object to load with the cached inner state.
+ *
+ * The data to authenticate is then fed to \a hash with update().
+ *
+ * \sa finalize()
+ */
+
+/**
+ * \fn void HMACKey::finalize(T &hash, void *mac, size_t macLen) const
+ * \brief Finalizes a HMAC computation that was started with reset().
+ *
+ * \param hash The hash object that holds the inner hash state.
+ * \param mac Points to the buffer to receive the HMAC value.
+ * \param macLen Length of the \a mac buffer, up to T::HASH_SIZE.
+ *
+ * On return, \a hash holds the outer hash state and must be reset before
+ * it is used again.
+ *
+ * \sa reset()
+ */
+
+/**
+ * \fn void HMACKey::mac(void *out, size_t outLen, const void *data, size_t dataLen) const
+ * \brief Computes the HMAC of a single block of data.
+ *
+ * \param out Points to the buffer to receive the HMAC value.
+ * \param outLen Length of the \a out buffer, up to T::HASH_SIZE.
+ * \param data Points to the data to authenticate.
+ * \param dataLen Length of the \a data in bytes.
+ */
+
+/**
+ * \fn void HMACKey::clear()
+ * \brief Clears the cached hash states, which must then be recomputed
+ * with setKey() before use.
+ */
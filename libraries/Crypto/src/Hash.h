@@ -26,6 +26,18 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+struct HashInput
+{
+    const void *data;
+    size_t len;
+};
+
+struct HashOutput
+{
+    void *data;
+    size_t len;
+};
+
 class Hash
 {
 public:
@@ -44,6 +56,12 @@ public:
     virtual void resetHMAC(const void *key, size_t keyLen) = 0;
     virtual void finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t hashLen) = 0;
 
+    void digestv(const HashInput *in, size_t inCount, void *hash, size_t len);
+    void digestv(const HashInput *in, size_t inCount,
+                 const HashOutput *out, size_t outCount);
+
+    static const size_t MAX_HASH_SIZE = 64;
+
 protected:
     void formatHMACKey(void *block, const void *key, size_t len, uint8_t pad);
 };
@@ -44,6 +44,16 @@
 #error "KeccakCore is not supported on big-endian platforms yet - todo"
 #endif
 
+// Define to 1 to run KECCAK-p on bit-interleaved 32-bit words, which avoids
+// the multi-instruction 64-bit rotations of the generic code on 32-bit cores.
+#if !defined(CRYPTO_KECCAK_32BIT)
+#if (defined(__arm__) && !defined(__aarch64__)) || defined(__XTENSA__)
+#define CRYPTO_KECCAK_32BIT 1
+#else
+#define CRYPTO_KECCAK_32BIT 0
+#endif
+#endif
+
 /**
  * \brief Constructs a new Keccak sponge function.
  *
@@ -318,6 +328,160 @@ void KeccakCore::setHMACKey(const void *key, size_t len, uint8_t pad, size_t has
     keccakp();
 }
 
+#if CRYPTO_KECCAK_32BIT && !defined(__AVR__)
+
+// Moves the even-numbered bits of a word into the low half and the
+// odd-numbered bits into the high half, and back again.  Each step is
+// a delta swap, so the inverse applies the same steps in reverse order.
+static inline uint32_t unzip32(uint32_t x)
+{
+    uint32_t t;
+    t = (x ^ (x >> 1)) & 0x22222222UL; x ^= t ^ (t << 1);
+    t = (x ^ (x >> 2)) & 0x0C0C0C0CUL; x ^= t ^ (t << 2);
+    t = (x ^ (x >> 4)) & 0x00F000F0UL; x ^= t ^ (t << 4);
+    t = (x ^ (x >> 8)) & 0x0000FF00UL; x ^= t ^ (t << 8);
+    return x;
+}
+static inline uint32_t zip32(uint32_t x)
+{
+    uint32_t t;
+    t = (x ^ (x >> 8)) & 0x0000FF00UL; x ^= t ^ (t << 8);
+    t = (x ^ (x >> 4)) & 0x00F000F0UL; x ^= t ^ (t << 4);
+    t = (x ^ (x >> 2)) & 0x0C0C0C0CUL; x ^= t ^ (t << 2);
+    t = (x ^ (x >> 1)) & 0x22222222UL; x ^= t ^ (t << 1);
+    return x;
+}
+
+// Rotates a 32-bit word left, allowing a rotation of zero.
+#define rotI(x, n)  \
+    (((n) & 31) ? (((x) << ((n) & 31)) | ((x) >> ((32 - (n)) & 31))) : (x))
+
+/**
+ * \brief Transform the state with the KECCAK-p sponge function with b = 1600.
+ *
+ * Each 64-bit lane is split into a word of its even bits (E) and a word of
+ * its odd bits (O) for the duration of the permutation.  A 64-bit rotation
+ * by 2n then becomes two 32-bit rotations by n, and a rotation by 2n + 1
+ * swaps the halves with rotations by n + 1 and n.  The interleaved words
+ * are kept in place of the lanes in state.A, E first.
+ */
+void KeccakCore::keccakp()
+{
+    // Round constants in bit-interleaved form, {E, O}.
+    static uint32_t const RC[24][2] PROGMEM = {
+        {0x00000001UL, 0x00000000UL}, {0x00000000UL, 0x00000089UL}, {0x00000000UL, 0x8000008BUL},
+        {0x00000000UL, 0x80008080UL}, {0x00000001UL, 0x0000008BUL}, {0x00000001UL, 0x00008000UL},
+        {0x00000001UL, 0x80008088UL}, {0x00000001UL, 0x80000082UL}, {0x00000000UL, 0x0000000BUL},
+        {0x00000000UL, 0x0000000AUL}, {0x00000001UL, 0x00008082UL}, {0x00000000UL, 0x00008003UL},
+        {0x00000001UL, 0x0000808BUL}, {0x00000001UL, 0x8000000BUL}, {0x00000001UL, 0x8000008AUL},
+        {0x00000001UL, 0x80000081UL}, {0x00000000UL, 0x80000081UL}, {0x00000000UL, 0x80000008UL},
+        {0x00000000UL, 0x00000083UL}, {0x00000000UL, 0x80008003UL}, {0x00000001UL, 0x80008088UL},
+        {0x00000000UL, 0x80000088UL}, {0x00000001UL, 0x00008000UL}, {0x00000000UL, 0x80008082UL}
+    };
+    uint32_t *A = (uint32_t *)(state.A);
+    uint32_t BE[25], BO[25];
+    uint32_t CE[5], CO[5];
+    uint32_t DE, DO, lo, hi;
+    uint8_t index, index2;
+
+    #define AE(i) (A[(i) * 2])
+    #define AO(i) (A[(i) * 2 + 1])
+    #define RHO_PI(b, a, r) \
+        do { \
+            if ((r) & 1) { \
+                BE[(b)] = rotI(AO((a)), ((r) + 1) / 2); \
+                BO[(b)] = rotI(AE((a)), (r) / 2); \
+            } else { \
+                BE[(b)] = rotI(AE((a)), (r) / 2); \
+                BO[(b)] = rotI(AO((a)), (r) / 2); \
+            } \
+        } while (0)
+
+    // Convert the lanes into bit-interleaved form.
+    for (index = 0; index < 25; ++index) {
+        lo = unzip32(A[index * 2]);
+        hi = unzip32(A[index * 2 + 1]);
+        AE(index) = (lo & 0x0000FFFFUL) | (hi << 16);
+        AO(index) = (lo >> 16) | (hi & 0xFFFF0000UL);
+    }
+
+    for (uint8_t round = 0; round < 24; ++round) {
+        // Step mapping theta.  Rotating C by 1 swaps its halves.
+        for (index = 0; index < 5; ++index) {
+            CE[index] = AE(index) ^ AE(index + 5) ^ AE(index + 10) ^
+                        AE(index + 15) ^ AE(index + 20);
+            CO[index] = AO(index) ^ AO(index + 5) ^ AO(index + 10) ^
+                        AO(index + 15) ^ AO(index + 20);
+        }
+        for (index = 0; index < 5; ++index) {
+            uint8_t prev = (index + 4) % 5;
+            uint8_t next = (index + 1) % 5;
+            DE = CE[prev] ^ rotI(CO[next], 1);
+            DO = CO[prev] ^ CE[next];
+            for (index2 = 0; index2 < 25; index2 += 5) {
+                AE(index + index2) ^= DE;
+                AO(index + index2) ^= DO;
+            }
+        }
+
+        // Step mapping rho and pi combined into a single step.
+        BE[0] = AE(0);
+        BO[0] = AO(0);
+        RHO_PI( 5,  3, 28);
+        RHO_PI(10,  1, 1);
+        RHO_PI(15,  4, 27);
+        RHO_PI(20,  2, 62);
+        RHO_PI( 1,  6, 44);
+        RHO_PI( 6,  9, 20);
+        RHO_PI(11,  7, 6);
+        RHO_PI(16,  5, 36);
+        RHO_PI(21,  8, 55);
+        RHO_PI( 2, 12, 43);
+        RHO_PI( 7, 10, 3);
+        RHO_PI(12, 13, 25);
+        RHO_PI(17, 11, 10);
+        RHO_PI(22, 14, 39);
+        RHO_PI( 3, 18, 21);
+        RHO_PI( 8, 16, 45);
+        RHO_PI(13, 19, 8);
+        RHO_PI(18, 17, 15);
+        RHO_PI(23, 15, 41);
+        RHO_PI( 4, 24, 14);
+        RHO_PI( 9, 22, 61);
+        RHO_PI(14, 20, 18);
+        RHO_PI(19, 23, 56);
+        RHO_PI(24, 21, 2);
+
+        // Step mapping chi.  Combine each lane with two other lanes in its row.
+        for (index2 = 0; index2 < 25; index2 += 5) {
+            for (index = 0; index < 5; ++index) {
+                uint8_t next = index2 + (index + 1) % 5;
+                uint8_t next2 = index2 + (index + 2) % 5;
+                AE(index2 + index) = BE[index2 + index] ^ ((~BE[next]) & BE[next2]);
+                AO(index2 + index) = BO[index2 + index] ^ ((~BO[next]) & BO[next2]);
+            }
+        }
+
+        // Step mapping iota.  XOR A[0][0] with the round constant.
+        AE(0) ^= pgm_read_dword(&(RC[round][0]));
+        AO(0) ^= pgm_read_dword(&(RC[round][1]));
+    }
+
+    // Convert the lanes back into standard form.
+    for (index = 0; index < 25; ++index) {
+        lo = (AE(index) & 0x0000FFFFUL) | (AO(index) << 16);
+        hi = (AE(index) >> 16) | (AO(index) & 0xFFFF0000UL);
+        A[index * 2] = zip32(lo);
+        A[index * 2 + 1] = zip32(hi);
+    }
+
+    #undef AE
+    #undef AO
+    #undef RHO_PI
+}
+
+#else // !CRYPTO_KECCAK_32BIT
+
 /**
  * \brief Transform the state with the KECCAK-p sponge function with b = 1600.
  */
@@ -2011,3 +2175,5 @@ void KeccakCore::keccakp()
         state.A[0][0] ^= pgm_read_qword(RC + round);
     }
 }
+
+#endif // !CRYPTO_KECCAK_32BIT
@@ -36,6 +36,26 @@
  * References: https://en.wikipedia.org/wiki/EAX_mode,
  * http://web.cs.ucdavis.edu/~rogaway/papers/eax.html
  *
+ * OMAC1 with no tag prefix is the CMAC algorithm from NIST SP 800-38B.
+ * For a session that authenticates many messages under the same key,
+ * call initKey() once after the key is set and then start each message
+ * with initCMAC().  The subkeys are kept in this object, so each message
+ * costs one block encryption per 16 bytes of data:
+ *
+ * \code
+ * AES128 aes;
+ * OMAC cmac;
+ * uint8_t mac[16];
+ * aes.setKey(kmac, 16);
+ * cmac.setBlockCipher(&aes);
+ * cmac.initKey();
+ * ...
+ * cmac.initCMAC(mac);
+ * cmac.update(mac, header, sizeof(header));
+ * cmac.update(mac, body, bodyLen);
+ * cmac.finalize(mac);
+ * \endcode
+ *
  * \sa EAX
  */
 
@@ -59,6 +79,7 @@ OMAC::OMAC()
 OMAC::~OMAC()
 {
     clean(b);
+    clean(p);
 }
 
 /**
@@ -107,10 +128,46 @@ void OMAC::initFirst(uint8_t omac[16])
     _blockCipher->encryptBlock(omac, omac);
     posn = 0;
 
-    // Generate the B value from the encrypted block of zeroes.
-    // We will need this later when finalising the OMAC hashes.
+    // Generate the B and P values from the encrypted block of zeroes.
+    // We will need these later when finalising the OMAC hashes.
     memcpy(b, omac, 16);
     GF128::dblEAX(b);
+    memcpy(p, b, 16);
+    GF128::dblEAX(p);
+}
+
+/**
+ * \brief Derives the B and P values (CMAC subkeys K1 and K2) for the
+ * current key of the block cipher.
+ *
+ * This has the same effect as initFirst() on the subkeys but does not
+ * start a hashing context.  It must be called again whenever the block
+ * cipher or the key changes.
+ *
+ * \sa initCMAC(), initFirst()
+ */
+void OMAC::initKey()
+{
+    uint8_t l[16];
+    initFirst(l);
+    clean(l);
+}
+
+/**
+ * \brief Initialises or restarts a CMAC hashing context.
+ *
+ * \param omac The OMAC hashing context.
+ *
+ * The context has no tag prefix, so the value produced by finalize() is
+ * the CMAC of the data passed to update().  It is assumed that initKey()
+ * or initFirst() was called previously to derive the subkeys.
+ *
+ * \sa initKey(), update(), finalize()
+ */
+void OMAC::initCMAC(uint8_t omac[16])
+{
+    memset(omac, 0, 16);
+    posn = 0;
 }
 
 /**
@@ -174,13 +231,9 @@ void OMAC::finalize(uint8_t omac[16])
     // Apply padding if necessary.
     if (posn != 16) {
         // Need padding: XOR with P = 2 * B.
-        uint32_t p[4];
-        memcpy(p, b, 16);
-        GF128::dblEAX(p);
         omac[posn] ^= 0x80;
         for (uint8_t index = 0; index < 16; ++index)
             omac[index] ^= ((const uint8_t *)p)[index];
-        clean(p);
     } else {
         // No padding necessary: XOR with B.
         for (uint8_t index = 0; index < 16; ++index)
@@ -197,4 +250,5 @@ void OMAC::finalize(uint8_t omac[16])
 void OMAC::clear()
 {
     clean(b);
+    clean(p);
 }
@@ -35,6 +35,8 @@ public:
     void setBlockCipher(BlockCipher *cipher) { _blockCipher = cipher; }
 
     void initFirst(uint8_t omac[16]);
+    void initKey();
+    void initCMAC(uint8_t omac[16]);
     void initNext(uint8_t omac[16], uint8_t tag);
     void update(uint8_t omac[16], const uint8_t *data, size_t size);
     void finalize(uint8_t omac[16]);
@@ -44,6 +46,7 @@ public:
 private:
     BlockCipher *_blockCipher;
     uint32_t b[4];
+    uint32_t p[4];
     uint8_t posn;
 };
 
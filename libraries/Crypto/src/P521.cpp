@@ -63,6 +63,18 @@
 #define strict_clean(x)     do { ; } while (0)
 #endif
 
+// Define to 1 to evaluate the curve function with 4-bit signed windows over
+// a table of 8 multiples of the point in RAM, and to multiply the generator
+// with a 5-tooth comb over a 4K table in flash.  The default is to use them
+// except on AVR, which does not have the RAM for the table.
+#if !defined(CRYPTO_P521_WINDOW)
+#if defined(__AVR__)
+#define CRYPTO_P521_WINDOW 0
+#else
+#define CRYPTO_P521_WINDOW 1
+#endif
+#endif
+
 // Expand the partial 9-bit left over limb at the top of a 521-bit number.
 #if BIGNUMBER_LIMB_8BIT
 #define LIMB_PARTIAL(value) ((uint8_t)(value)), \
@@ -110,6 +122,400 @@ static limb_t const P521_Gy[NUM_LIMBS_521BIT] PROGMEM = {
     LIMB_PARTIAL(0x118)
 };
 
+#if CRYPTO_P521_WINDOW
+
+// Comb table for the generator G.  Entry i is the sum of 2^(105 * j) * G
+// for the bits j that are set in i, in affine co-ordinates.  Entry 0 would
+// be the point at infinity and is never used.
+static limb_t const P521_comb[32][2][NUM_LIMBS_521BIT] PROGMEM = {
+    {
+        {LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PARTIAL(0x000)},
+        {LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PAIR(0x00000000, 0x00000000), LIMB_PAIR(0x00000000, 0x00000000),
+         LIMB_PARTIAL(0x000)}
+    },
+    {
+        {LIMB_PAIR(0xc2e5bd66, 0xf97e7e31), LIMB_PAIR(0x856a429b, 0x3348b3c1),
+         LIMB_PAIR(0xa2ffa8de, 0xfe1dc127), LIMB_PAIR(0xefe75928, 0xa14b5e77),
+         LIMB_PAIR(0x6b4d3dba, 0xf828af60), LIMB_PAIR(0x053fb521, 0x9c648139),
+         LIMB_PAIR(0x2395b442, 0x9e3ecb66), LIMB_PAIR(0x0404e9cd, 0x858e06b7),
+         LIMB_PARTIAL(0x0c6)},
+        {LIMB_PAIR(0x9fd16650, 0x88be9476), LIMB_PAIR(0xa272c240, 0x353c7086),
+         LIMB_PAIR(0x3fad0761, 0xc550b901), LIMB_PAIR(0x5ef42640, 0x97ee7299),
+         LIMB_PAIR(0x273e662c, 0x17afbd17), LIMB_PAIR(0x579b4468, 0x98f54449),
+         LIMB_PAIR(0x2c7d1bd9, 0x5c8a5fb4), LIMB_PAIR(0x9a3bc004, 0x39296a78),
+         LIMB_PARTIAL(0x118)}
+    },
+    {
+        {LIMB_PAIR(0x876b33ac, 0x45d90cf8), LIMB_PAIR(0x3ed58f0b, 0xe53e1a99),
+         LIMB_PAIR(0x49d916b3, 0xd5d181f5), LIMB_PAIR(0x2ec09be2, 0x1b1ef040),
+         LIMB_PAIR(0xb2113b57, 0xe5787176), LIMB_PAIR(0x8073044e, 0x11d02e70),
+         LIMB_PAIR(0xa2ae38dd, 0x9d1c19e7), LIMB_PAIR(0x3634f6fa, 0x2662d494),
+         LIMB_PARTIAL(0x130)},
+        {LIMB_PAIR(0x6bd6208e, 0x454c8a73), LIMB_PAIR(0xae37911a, 0xd2447cef),
+         LIMB_PAIR(0x69b8c5ae, 0x56ac592e), LIMB_PAIR(0x9b615bfc, 0xe7f56483),
+         LIMB_PAIR(0xbbe7fe62, 0xfac066e1), LIMB_PAIR(0xb7777b32, 0xb2ac3ee1),
+         LIMB_PAIR(0x15114ada, 0x55f86533), LIMB_PAIR(0x46497cc9, 0x15cba83e),
+         LIMB_PARTIAL(0x1ef)}
+    },
+    {
+        {LIMB_PAIR(0xe371375d, 0x863b3adb), LIMB_PAIR(0x89cf187b, 0xf2ddd842),
+         LIMB_PAIR(0x6ab24b10, 0x80cf70e7), LIMB_PAIR(0x57d81a93, 0x78063ae6),
+         LIMB_PAIR(0xc87491c5, 0x88aeb0b1), LIMB_PAIR(0x2e17fbf9, 0x5ebe733a),
+         LIMB_PAIR(0x52ad31ba, 0xc205cbcd), LIMB_PAIR(0xed66a7f8, 0xa13230f9),
+         LIMB_PARTIAL(0x117)},
+        {LIMB_PAIR(0x03a6ec5d, 0x224d9a3b), LIMB_PAIR(0xbe627be3, 0xe1efca41),
+         LIMB_PAIR(0x22abca89, 0x34df229c), LIMB_PAIR(0x8153b848, 0x11c526a0),
+         LIMB_PAIR(0xcbb59e96, 0x26879bd9), LIMB_PAIR(0x8d1298ed, 0x77eccc36),
+         LIMB_PAIR(0xd6560f21, 0xaf68677b), LIMB_PAIR(0x242b365b, 0xe5ddc615),
+         LIMB_PARTIAL(0x17f)}
+    },
+    {
+        {LIMB_PAIR(0x155c337b, 0x7eaefe12), LIMB_PAIR(0xc7186596, 0x357f27ce),
+         LIMB_PAIR(0x654dbbeb, 0x90c26c69), LIMB_PAIR(0xa1b63a6a, 0x6bcca278),
+         LIMB_PAIR(0x8edd9123, 0x776b7a92), LIMB_PAIR(0x6c6da5e9, 0xb2bef507),
+         LIMB_PAIR(0x0e3c747b, 0x805ed3aa), LIMB_PAIR(0x659df2ef, 0x298ef458),
+         LIMB_PARTIAL(0x098)},
+        {LIMB_PAIR(0x35a79f8d, 0xe3dd8939), LIMB_PAIR(0xa1972c6b, 0x672b109c),
+         LIMB_PAIR(0x07953a4d, 0xad41cbae), LIMB_PAIR(0xd206de77, 0xde07527f),
+         LIMB_PAIR(0xb61d9811, 0x1f55a4c0), LIMB_PAIR(0x7a75360e, 0x929d56d5),
+         LIMB_PAIR(0x5032efe6, 0x9f2becff), LIMB_PAIR(0x60f0622c, 0x0de654c7),
+         LIMB_PARTIAL(0x018)}
+    },
+    {
+        {LIMB_PAIR(0x8445216b, 0xd9e465af), LIMB_PAIR(0xc57ae51b, 0x7d12c12b),
+         LIMB_PAIR(0xab01f4d2, 0xaf65fd9b), LIMB_PAIR(0xb3c1d722, 0xf2fd8a84),
+         LIMB_PAIR(0xf5123832, 0x8870dc27), LIMB_PAIR(0x8c85325e, 0xe8b51d16),
+         LIMB_PAIR(0x92e31759, 0x1a03d5df), LIMB_PAIR(0xefdb49c3, 0x7b5e6c46),
+         LIMB_PARTIAL(0x05e)},
+        {LIMB_PAIR(0x137a651a, 0xb427174d), LIMB_PAIR(0x256229cb, 0xf9e661d4),
+         LIMB_PAIR(0xed3aeb3f, 0xbbd04d0f), LIMB_PAIR(0x5bb3fae1, 0xc31eef45),
+         LIMB_PAIR(0x07a35089, 0x52df99e4), LIMB_PAIR(0xed429e1a, 0x6514b9bd),
+         LIMB_PAIR(0x67ecbd97, 0x757977bf), LIMB_PAIR(0xb2725c6d, 0x70a2b55f),
+         LIMB_PARTIAL(0x0a7)}
+    },
+    {
+        {LIMB_PAIR(0x8913355a, 0xdd2cd8ae), LIMB_PAIR(0xba2f3522, 0x02114bfc),
+         LIMB_PAIR(0x22446abf, 0xe62184f5), LIMB_PAIR(0x68e6d0c5, 0xe8d75651),
+         LIMB_PAIR(0x19ad9ebc, 0x580f6c03), LIMB_PAIR(0xc2953557, 0x8b9d5d55),
+         LIMB_PAIR(0x618534df, 0x234640a5), LIMB_PAIR(0xfed9e6b6, 0xf452a772),
+         LIMB_PARTIAL(0x1b7)},
+        {LIMB_PAIR(0x16211bb5, 0x0952e477), LIMB_PAIR(0x5cedf594, 0xd3d874ae),
+         LIMB_PAIR(0x85328765, 0x2c21a7bd), LIMB_PAIR(0xec333d98, 0x44b3033c),
+         LIMB_PAIR(0x3c587cd5, 0x0474258d), LIMB_PAIR(0x4962e19e, 0x527c162f),
+         LIMB_PAIR(0x5b356dd3, 0x0dbf0f7a), LIMB_PAIR(0x95bbfc9b, 0x8d683b71),
+         LIMB_PARTIAL(0x1bc)}
+    },
+    {
+        {LIMB_PAIR(0x94bb174c, 0xff99f7cd), LIMB_PAIR(0x96566e5e, 0x905b42bd),
+         LIMB_PAIR(0xebae3baa, 0xda1abf35), LIMB_PAIR(0x7644ce21, 0x15ddf71b),
+         LIMB_PAIR(0x50e83a0c, 0x2920c1c0), LIMB_PAIR(0x0f7b1973, 0x237776ed),
+         LIMB_PAIR(0x57adf3a6, 0x7e393449), LIMB_PAIR(0x9160ead0, 0xd9e08cf9),
+         LIMB_PARTIAL(0x100)},
+        {LIMB_PAIR(0x675707da, 0x54f0135e), LIMB_PAIR(0x2e5596b0, 0x5976788e),
+         LIMB_PAIR(0xf3ac4001, 0x73dd4b88), LIMB_PAIR(0xfbacbfe7, 0x7f5453e3),
+         LIMB_PAIR(0x426b2080, 0x551dc249), LIMB_PAIR(0xe33f8f92, 0x528ff571),
+         LIMB_PAIR(0x95834f88, 0xd78d1e40), LIMB_PAIR(0x7d07a77c, 0x20405c91),
+         LIMB_PARTIAL(0x114)}
+    },
+    {
+        {LIMB_PAIR(0xec3d1383, 0xd1ce126e), LIMB_PAIR(0x4805b18e, 0x0c7f980a),
+         LIMB_PAIR(0xfc1b1f4e, 0x65945086), LIMB_PAIR(0x092e0ca0, 0xac1703ae),
+         LIMB_PAIR(0x8b5ee5c0, 0x834c77f9), LIMB_PAIR(0x6d19fbb5, 0x3e722f57),
+         LIMB_PAIR(0xf6770bd1, 0xae8a944a), LIMB_PAIR(0x2a7c7101, 0xe1d11050),
+         LIMB_PARTIAL(0x0d7)},
+        {LIMB_PAIR(0xca303000, 0x62029fd2), LIMB_PAIR(0xacb52ecd, 0x366c72c9),
+         LIMB_PAIR(0xcc8dd8a2, 0xcf89c1aa), LIMB_PAIR(0x5d1b984d, 0x95c235bf),
+         LIMB_PAIR(0xd1a80d52, 0x3434d10d), LIMB_PAIR(0x77e95add, 0x094d0a8f),
+         LIMB_PAIR(0xd1203660, 0x03890027), LIMB_PAIR(0x29791ab3, 0x32faf273),
+         LIMB_PARTIAL(0x075)}
+    },
+    {
+        {LIMB_PAIR(0x075a4208, 0x9281b5c1), LIMB_PAIR(0x471c7fcc, 0xafc5e0e5),
+         LIMB_PAIR(0xc8704f00, 0x9a6e82f3), LIMB_PAIR(0x62960946, 0x4320c31a),
+         LIMB_PAIR(0x513c571f, 0xe673b4bd), LIMB_PAIR(0x3dc4d8fb, 0x9b68532a),
+         LIMB_PAIR(0x2c95dbe9, 0xa8cbe344), LIMB_PAIR(0x229c47b7, 0x0f6ac257),
+         LIMB_PARTIAL(0x14a)},
+        {LIMB_PAIR(0xc1411542, 0x1b4c092d), LIMB_PAIR(0x7747beaf, 0xc4bb45d6),
+         LIMB_PAIR(0x8d55735e, 0x685c4be4), LIMB_PAIR(0x6383fd44, 0x9e72fcc8),
+         LIMB_PAIR(0x203ff740, 0x615bdc52), LIMB_PAIR(0x5b1a64ad, 0xcc19dafb),
+         LIMB_PAIR(0x2b782e96, 0x28ef0d34), LIMB_PAIR(0x05e3ae87, 0x21d84532),
+         LIMB_PARTIAL(0x052)}
+    },
+    {
+        {LIMB_PAIR(0x72656971, 0x6a884570), LIMB_PAIR(0xa7f20efe, 0xdc4fcb92),
+         LIMB_PAIR(0xdc31417c, 0x759db4ff), LIMB_PAIR(0xf95dc14f, 0xf1bf0345),
+         LIMB_PAIR(0x0fd656f0, 0x0686bd5b), LIMB_PAIR(0x6f4440f7, 0x9c5ea036),
+         LIMB_PAIR(0x3887f6e1, 0x207619ce), LIMB_PAIR(0xa211de2d, 0xa9ef8d60),
+         LIMB_PARTIAL(0x07d)},
+        {LIMB_PAIR(0x8e5a6c11, 0xd0bce7f9), LIMB_PAIR(0xedc82b6c, 0xab338406),
+         LIMB_PAIR(0x7cb589b2, 0x36726a50), LIMB_PAIR(0x02cc7eb7, 0x887b6cfc),
+         LIMB_PAIR(0x28ace2ab, 0x651f7903), LIMB_PAIR(0x06ba6057, 0x8e7f8436),
+         LIMB_PAIR(0xbff72afe, 0xd103b1b2), LIMB_PAIR(0x46959145, 0x942cf0c6),
+         LIMB_PARTIAL(0x033)}
+    },
+    {
+        {LIMB_PAIR(0x5805d03e, 0x204b0833), LIMB_PAIR(0x5a1ab8cf, 0x3c03ae7a),
+         LIMB_PAIR(0xead6f888, 0x3376e27b), LIMB_PAIR(0x94a53e60, 0xb0e6713a),
+         LIMB_PAIR(0x3f0b8ee9, 0x790f9e81), LIMB_PAIR(0x4b4896e3, 0x21b2ac27),
+         LIMB_PAIR(0xe7fafecc, 0xce7c291b), LIMB_PAIR(0x1c1049ca, 0x10fe14a2),
+         LIMB_PARTIAL(0x04d)},
+        {LIMB_PAIR(0xd2130d68, 0x95bb30a7), LIMB_PAIR(0x4c891468, 0xc2a8f2a5),
+         LIMB_PAIR(0xb1608a4a, 0x5236ae15), LIMB_PAIR(0xc50f2485, 0xbd832829),
+         LIMB_PAIR(0x435254ed, 0xc87af748), LIMB_PAIR(0x3a80dc29, 0xc76d7df6),
+         LIMB_PAIR(0x5d881936, 0x7ce57b49), LIMB_PAIR(0xc0aeaa0d, 0x8e95cb82),
+         LIMB_PARTIAL(0x17f)}
+    },
+    {
+        {LIMB_PAIR(0x829a40a3, 0x21a193c7), LIMB_PAIR(0x05f32f41, 0x87b759a9),
+         LIMB_PAIR(0x6e143537, 0xba154763), LIMB_PAIR(0x6b5a6433, 0xfb951864),
+         LIMB_PAIR(0xd8e9be43, 0x81c1dadf), LIMB_PAIR(0xb5173d47, 0x3145a42c),
+         LIMB_PAIR(0xe5c9b799, 0x22d5ef4b), LIMB_PAIR(0xffe36ee4, 0x0bde5942),
+         LIMB_PARTIAL(0x10a)},
+        {LIMB_PAIR(0xf4bc58e5, 0xafc83ba5), LIMB_PAIR(0xd58698e3, 0xb418e478),
+         LIMB_PAIR(0x1726d889, 0x1f60371a), LIMB_PAIR(0x2f0a291a, 0xa5a58b57),
+         LIMB_PAIR(0xfd356626, 0x0e44da0a), LIMB_PAIR(0x2d89342f, 0xa3e9be34),
+         LIMB_PAIR(0xc3c1b4a2, 0x9195921b), LIMB_PAIR(0x25e4191e, 0xbcb21228),
+         LIMB_PARTIAL(0x135)}
+    },
+    {
+        {LIMB_PAIR(0x0eba209a, 0xa1b5f88d), LIMB_PAIR(0x3c5e2880, 0x04b54668),
+         LIMB_PAIR(0xefbb25f1, 0xe93591a0), LIMB_PAIR(0xe9729982, 0x1678d5f7),
+         LIMB_PAIR(0x7d430831, 0x6eb992da), LIMB_PAIR(0x0b7c198f, 0x1a4a91f7),
+         LIMB_PAIR(0x6ed1ff3e, 0x3a679847), LIMB_PAIR(0x5465e131, 0x18a5e132),
+         LIMB_PARTIAL(0x042)},
+        {LIMB_PAIR(0x59486fc8, 0xaf8471eb), LIMB_PAIR(0x9b6ab9e2, 0x397d8cab),
+         LIMB_PAIR(0x10c0f9ea, 0x942279c2), LIMB_PAIR(0xdddf11b9, 0xb3186547),
+         LIMB_PAIR(0x7e0e49b0, 0x2910861a), LIMB_PAIR(0x4c374108, 0x0ac066ab),
+         LIMB_PAIR(0x9c34f007, 0x67c76f4c), LIMB_PAIR(0x6a9e031f, 0x3635edbe),
+         LIMB_PARTIAL(0x0f7)}
+    },
+    {
+        {LIMB_PAIR(0x4ccfa596, 0x2e91929f), LIMB_PAIR(0x844098cf, 0x3b168733),
+         LIMB_PAIR(0x616a36df, 0x0fea437e), LIMB_PAIR(0xe0dc39ae, 0xbea5755d),
+         LIMB_PAIR(0xca20c73a, 0x721050e6), LIMB_PAIR(0xa6534de2, 0x5d86bb64),
+         LIMB_PAIR(0xaf758aef, 0x0c65ff4f), LIMB_PAIR(0x33832cca, 0x38d7bd4d),
+         LIMB_PARTIAL(0x127)},
+        {LIMB_PAIR(0xf7b22fc2, 0xaabe7e25), LIMB_PAIR(0x138537be, 0x44ec7b6e),
+         LIMB_PAIR(0x5ad7c324, 0x33cd05c9), LIMB_PAIR(0xc1602459, 0x28a6115c),
+         LIMB_PAIR(0xdf229461, 0x05c1aa34), LIMB_PAIR(0xbdb1d24d, 0x39fc35d8),
+         LIMB_PAIR(0x4b5f6223, 0x536aa0d5), LIMB_PAIR(0x703bd0f3, 0x1d5287e3),
+         LIMB_PARTIAL(0x186)}
+    },
+    {
+        {LIMB_PAIR(0x5e6a7807, 0x9f9a072d), LIMB_PAIR(0x39eeb105, 0xf9a38a83),
+         LIMB_PAIR(0x17ddb1b4, 0x1503495f), LIMB_PAIR(0x732310b4, 0xda780a6c),
+         LIMB_PAIR(0x403a5d57, 0x7b287813), LIMB_PAIR(0xe7c481e7, 0x6bb08815),
+         LIMB_PAIR(0x574c23e2, 0x1198c8a4), LIMB_PAIR(0x673dfc44, 0xa8da92a4),
+         LIMB_PARTIAL(0x02a)},
+        {LIMB_PAIR(0xbfb7ce31, 0x92df33ae), LIMB_PAIR(0x4a686f13, 0x1648e528),
+         LIMB_PAIR(0xe45ba7f2, 0x4429b3af), LIMB_PAIR(0x397c1d83, 0x216c5137),
+         LIMB_PAIR(0xc8c8ee26, 0xcac9d3c3), LIMB_PAIR(0x40c73424, 0x0711605e),
+         LIMB_PAIR(0x219c8c3f, 0x008b93a5), LIMB_PAIR(0xc6f10bb3, 0xab1ee7b8),
+         LIMB_PARTIAL(0x0e0)}
+    },
+    {
+        {LIMB_PAIR(0x10a8c4fb, 0x73a6ba38), LIMB_PAIR(0xecc93e5d, 0x5153d959),
+         LIMB_PAIR(0xb59e9871, 0x7ca58012), LIMB_PAIR(0xafd442f1, 0xedc0dbef),
+         LIMB_PAIR(0xb9cf7691, 0xb9050a22), LIMB_PAIR(0x464d017d, 0x3d1e96fe),
+         LIMB_PAIR(0x82074dca, 0x541781a4), LIMB_PAIR(0x8b355413, 0xedce0db3),
+         LIMB_PARTIAL(0x06b)},
+        {LIMB_PAIR(0xae2b39c2, 0x1a13e3ee), LIMB_PAIR(0x3c218179, 0xc431081d),
+         LIMB_PAIR(0xae68b7c6, 0x5cbc14c1), LIMB_PAIR(0x9005a304, 0xcf2559bb),
+         LIMB_PAIR(0x2ec7aed5, 0x14d7c1e9), LIMB_PAIR(0x1e2e2f0d, 0x5c379bfe),
+         LIMB_PAIR(0x886f0cf9, 0xfc33e4d2), LIMB_PAIR(0xac4e1d17, 0x2f14e7d0),
+         LIMB_PARTIAL(0x071)}
+    },
+    {
+        {LIMB_PAIR(0xedde488a, 0x2f1f1497), LIMB_PAIR(0x31ee698e, 0x3d0364b2),
+         LIMB_PAIR(0xa47e048e, 0x88a32c39), LIMB_PAIR(0x86da37c4, 0x80abd8de),
+         LIMB_PAIR(0x07895c9c, 0x6608eed9), LIMB_PAIR(0xd18a7081, 0xcca6b9e6),
+         LIMB_PAIR(0x0ca87303, 0x44f63aa9), LIMB_PAIR(0x094f9789, 0x84281eed),
+         LIMB_PARTIAL(0x17f)},
+        {LIMB_PAIR(0x6aa5f7a3, 0x5703727d), LIMB_PAIR(0x09da94a2, 0xd9c33512),
+         LIMB_PAIR(0xaddccfd6, 0x80572f9e), LIMB_PAIR(0x45febcc1, 0xf95bf8b0),
+         LIMB_PAIR(0x30a48dac, 0x4bcd4b12), LIMB_PAIR(0xf00f8619, 0x32a16a21),
+         LIMB_PAIR(0x1bcad341, 0x612d82b9), LIMB_PAIR(0xe2babc4a, 0xf42138da),
+         LIMB_PARTIAL(0x14b)}
+    },
+    {
+        {LIMB_PAIR(0x1510e086, 0x7e9364ea), LIMB_PAIR(0x31d0f679, 0x524b63b1),
+         LIMB_PAIR(0x9aeae146, 0xf8f3cc52), LIMB_PAIR(0x36f90818, 0x8c05c88d),
+         LIMB_PAIR(0x80d7dab5, 0x16ed75e5), LIMB_PAIR(0x54000c49, 0x8f872700),
+         LIMB_PAIR(0x843c5f7a, 0x9740a2a1), LIMB_PAIR(0x6e680411, 0x8dc46ac5),
+         LIMB_PARTIAL(0x0d8)},
+        {LIMB_PAIR(0xbac1fcbc, 0x9492a1d6), LIMB_PAIR(0x8a9ca207, 0xcd7cd811),
+         LIMB_PAIR(0xcded0753, 0xd61403a1), LIMB_PAIR(0x6702b3fa, 0x2d232e49),
+         LIMB_PAIR(0x83e33229, 0x5bd01fc9), LIMB_PAIR(0x4dbe98f9, 0x157c427c),
+         LIMB_PAIR(0x1c5b4229, 0xd2594a9f), LIMB_PAIR(0xe6318047, 0xe0207b85),
+         LIMB_PARTIAL(0x1f5)}
+    },
+    {
+        {LIMB_PAIR(0x71aaef75, 0x6bf98381), LIMB_PAIR(0xc14b076a, 0x479cc2a8),
+         LIMB_PAIR(0xcc783dc5, 0xc0466ec4), LIMB_PAIR(0x682e48f9, 0x7f120da2),
+         LIMB_PAIR(0x4a4ed12f, 0xe02258ac), LIMB_PAIR(0x83da05ed, 0x8d8ab9b9),
+         LIMB_PAIR(0x394701b0, 0xb1b1ec54), LIMB_PAIR(0x82d2c76e, 0x8fc99926),
+         LIMB_PARTIAL(0x079)},
+        {LIMB_PAIR(0x96c5465a, 0x0a611bf4), LIMB_PAIR(0x74f20f8f, 0xd0a6b210),
+         LIMB_PAIR(0xb7200111, 0x2178f283), LIMB_PAIR(0x48705a27, 0xbd71855c),
+         LIMB_PAIR(0xe797aa46, 0x204b17eb), LIMB_PAIR(0x1a418c95, 0x8200553c),
+         LIMB_PAIR(0x7c5363e9, 0x0ac39a6a), LIMB_PAIR(0x38e587ec, 0x41e58ba1),
+         LIMB_PARTIAL(0x092)}
+    },
+    {
+        {LIMB_PAIR(0xd580c2bf, 0x7a1128d3), LIMB_PAIR(0x33cb48ff, 0x54cb80b9),
+         LIMB_PAIR(0x124988a8, 0x12e00e24), LIMB_PAIR(0x8973b0b6, 0x2e41bd3e),
+         LIMB_PAIR(0x0729f811, 0x81f9b249), LIMB_PAIR(0x0b26f7d0, 0x82b1e837),
+         LIMB_PAIR(0x453d977e, 0x66102520), LIMB_PAIR(0x76af2ff3, 0x86404fbf),
+         LIMB_PARTIAL(0x122)},
+        {LIMB_PAIR(0xda706520, 0x935eed87), LIMB_PAIR(0x72990fdc, 0x35aeff20),
+         LIMB_PAIR(0x75f99b1d, 0xf65cfb16), LIMB_PAIR(0x8369d686, 0x0e6d254d),
+         LIMB_PAIR(0x0882827e, 0xc3493c5e), LIMB_PAIR(0x4f166119, 0xa0edf2da),
+         LIMB_PAIR(0x59363a25, 0x7638d201), LIMB_PAIR(0x76088e6b, 0xece18042),
+         LIMB_PARTIAL(0x138)}
+    },
+    {
+        {LIMB_PAIR(0xf8913cc2, 0x02fb999b), LIMB_PAIR(0xc961f4d7, 0x81688347),
+         LIMB_PAIR(0x8d0435c3, 0xd54c91f7), LIMB_PAIR(0x990e6ab3, 0xcbd0bcca),
+         LIMB_PAIR(0xd848398a, 0x3c8bce08), LIMB_PAIR(0xd5370ed6, 0x83f3f979),
+         LIMB_PAIR(0x74fd3ac3, 0x7449bbd2), LIMB_PAIR(0x4e73cfaa, 0xe6145db8),
+         LIMB_PARTIAL(0x15e)},
+        {LIMB_PAIR(0x58044777, 0x8a435e24), LIMB_PAIR(0x937e7687, 0x29b9d279),
+         LIMB_PAIR(0xe44d2874, 0x42c2e303), LIMB_PAIR(0x9845f55f, 0xfde623ca),
+         LIMB_PAIR(0x2fa1bc3e, 0x752c258f), LIMB_PAIR(0xce8a096a, 0x198db2b3),
+         LIMB_PAIR(0x6f2ec50f, 0x59b5361b), LIMB_PAIR(0x1a2aa43f, 0x5a4f209c),
+         LIMB_PARTIAL(0x14a)}
+    },
+    {
+        {LIMB_PAIR(0x4f005da0, 0xfcbb48b5), LIMB_PAIR(0x50cbc0c5, 0x2a8d3120),
+         LIMB_PAIR(0xe9ac811d, 0xb33c1526), LIMB_PAIR(0x586013f2, 0x91e493ce),
+         LIMB_PAIR(0x488d1688, 0x99412264), LIMB_PAIR(0x875c45e1, 0x7966c1c1),
+         LIMB_PAIR(0xbe0d5b72, 0x9dbc86d2), LIMB_PAIR(0x1553d029, 0x63a83498),
+         LIMB_PARTIAL(0x068)},
+        {LIMB_PAIR(0x9d44055b, 0x184f3300), LIMB_PAIR(0xd232a2f5, 0xadbec2bb),
+         LIMB_PAIR(0x5a2a5eb5, 0x4e0b32a8), LIMB_PAIR(0xe3535f4c, 0x938d776c),
+         LIMB_PAIR(0x0f169cf8, 0xd2591a1a), LIMB_PAIR(0xe7a2093d, 0x8dca29f4),
+         LIMB_PAIR(0x145f902b, 0xb8746330), LIMB_PAIR(0xfe2cebec, 0x816d6f86),
+         LIMB_PARTIAL(0x068)}
+    },
+    {
+        {LIMB_PAIR(0x2a7fabd6, 0x5b774088), LIMB_PAIR(0x826f236e, 0x0911e7f0),
+         LIMB_PAIR(0x84f0bbd3, 0xbc4d014c), LIMB_PAIR(0x2e000c1a, 0x0b8bcd8f),
+         LIMB_PAIR(0x2ddeb721, 0xd5ff7778), LIMB_PAIR(0x7ef826a9, 0x0f7a76f9),
+         LIMB_PAIR(0x644d2f94, 0x031ce26f), LIMB_PAIR(0x78fdc7ed, 0x1eafdc82),
+         LIMB_PARTIAL(0x1e2)},
+        {LIMB_PAIR(0xa60bc2a1, 0x16bf1952), LIMB_PAIR(0x3dd7dcd5, 0x2ce4110c),
+         LIMB_PAIR(0x78e260c3, 0x3df02bf1), LIMB_PAIR(0x3944b29c, 0x132208c2),
+         LIMB_PAIR(0x59682e01, 0x13add246), LIMB_PAIR(0x133b08c5, 0x87922b46),
+         LIMB_PAIR(0x51c7aea4, 0x5b3e4932), LIMB_PAIR(0x9380bdff, 0x9e77c83b),
+         LIMB_PARTIAL(0x0e0)}
+    },
+    {
+        {LIMB_PAIR(0x54746586, 0x3ce44040), LIMB_PAIR(0x31e2cb31, 0x5260f1be),
+         LIMB_PAIR(0x1c0a1dc6, 0x802e6890), LIMB_PAIR(0xf84363bb, 0x5e9aaea8),
+         LIMB_PAIR(0x4cccca39, 0xffd8a962), LIMB_PAIR(0xfa9ef6e4, 0xe12a8be6),
+         LIMB_PAIR(0x31be868f, 0x85338185), LIMB_PAIR(0xa23a3b36, 0x25878406),
+         LIMB_PARTIAL(0x03c)},
+        {LIMB_PAIR(0x96e54499, 0x14827414), LIMB_PAIR(0x8e050034, 0xa0732f96),
+         LIMB_PAIR(0x467cadc7, 0x1c6fa676), LIMB_PAIR(0x98d6927c, 0xa63ba10c),
+         LIMB_PAIR(0xdcc2500f, 0x58cb6f96), LIMB_PAIR(0xea4fd9c5, 0xaccb76d6),
+         LIMB_PAIR(0x30786990, 0xe2a2f59b), LIMB_PAIR(0xd224ccfe, 0xd8b24679),
+         LIMB_PARTIAL(0x1b2)}
+    },
+    {
+        {LIMB_PAIR(0xa84d476c, 0xdbe7bc43), LIMB_PAIR(0x0df0f82f, 0x80c66135),
+         LIMB_PAIR(0x7996b3dd, 0xfda3915e), LIMB_PAIR(0x5460b6a5, 0xd309856f),
+         LIMB_PAIR(0xfb5f2a03, 0xda60ecfb), LIMB_PAIR(0x87f5c81e, 0xb45421cc),
+         LIMB_PAIR(0x93297e69, 0xe78f50b7), LIMB_PAIR(0x92b7ab1b, 0xb57ef6e0),
+         LIMB_PARTIAL(0x020)},
+        {LIMB_PAIR(0xd5a7e947, 0x2fac246b), LIMB_PAIR(0x3c2c0e9e, 0xa3560f17),
+         LIMB_PAIR(0x99a15edc, 0x36f3bea7), LIMB_PAIR(0xf6df7626, 0x51e0953f),
+         LIMB_PAIR(0xe181410f, 0x791fb8f1), LIMB_PAIR(0x065b1cd7, 0x9e592427),
+         LIMB_PAIR(0x6e9a54b5, 0x492c7736), LIMB_PAIR(0xf664ead5, 0x8f186347),
+         LIMB_PARTIAL(0x1de)}
+    },
+    {
+        {LIMB_PAIR(0xcc9f295b, 0xf8b25de3), LIMB_PAIR(0xd481f758, 0x6a3a6afd),
+         LIMB_PAIR(0xd7194dd7, 0x0f362d65), LIMB_PAIR(0x72839c8b, 0xd0706b14),
+         LIMB_PAIR(0x86e79d73, 0x863fc677), LIMB_PAIR(0xbd51aa66, 0x7a312dd4),
+         LIMB_PAIR(0xe2fb1520, 0x4f54148b), LIMB_PAIR(0xd3fafaa8, 0xf819350e),
+         LIMB_PARTIAL(0x0a5)},
+        {LIMB_PAIR(0xd0ba1319, 0xdade2b22), LIMB_PAIR(0x0e128de4, 0xec0df712),
+         LIMB_PAIR(0xa47d34b8, 0xbfbb4a30), LIMB_PAIR(0x6c0fe4b4, 0x27a996fe),
+         LIMB_PAIR(0xfc390c4c, 0xf37ac376), LIMB_PAIR(0x8f1d9559, 0xa28f1992),
+         LIMB_PAIR(0x7917fb9e, 0x59a81149), LIMB_PAIR(0x24e5bb5e, 0x5658b74f),
+         LIMB_PARTIAL(0x1c1)}
+    },
+    {
+        {LIMB_PAIR(0xe090cb47, 0x0b8c54ed), LIMB_PAIR(0xabacc4b9, 0xddcef543),
+         LIMB_PAIR(0x6f45d144, 0xaa5d9f95), LIMB_PAIR(0x6d5b0b7d, 0x5829ea88),
+         LIMB_PAIR(0x5d9b5a9b, 0xa08415c0), LIMB_PAIR(0x9d469207, 0x0dcdd858),
+         LIMB_PAIR(0xad47d576, 0x91ef5090), LIMB_PAIR(0xfc9c5403, 0x286b59f7),
+         LIMB_PARTIAL(0x0a4)},
+        {LIMB_PAIR(0x681a6033, 0x51f28b4e), LIMB_PAIR(0x5586a02d, 0x92c8812f),
+         LIMB_PAIR(0x37f75be9, 0x65497752), LIMB_PAIR(0xe465ac3d, 0x39ed9c48),
+         LIMB_PAIR(0xea5746a3, 0x52b0558d), LIMB_PAIR(0x2281bf57, 0xb1ad72ea),
+         LIMB_PAIR(0xc29bc5ba, 0xfa48be23), LIMB_PAIR(0xb11e0b1a, 0x5ddd7e6b),
+         LIMB_PARTIAL(0x144)}
+    },
+    {
+        {LIMB_PAIR(0xdfbf1c5d, 0x6b91bd8f), LIMB_PAIR(0x35cbbe74, 0x29cbc8c5),
+         LIMB_PAIR(0xeca1f1e8, 0xf2bf1bf0), LIMB_PAIR(0x8b74129c, 0x64bc1b61),
+         LIMB_PAIR(0xa26db0ba, 0x5701d92d), LIMB_PAIR(0x629c49b0, 0x3bbbda1d),
+         LIMB_PAIR(0x628f9cf9, 0x77932b00), LIMB_PAIR(0xe3b93fd6, 0xf4dd2f98),
+         LIMB_PARTIAL(0x04e)},
+        {LIMB_PAIR(0xe84d1aa9, 0x50d3f239), LIMB_PAIR(0x80be7733, 0x76243d29),
+         LIMB_PAIR(0x5f3a7f3e, 0x8f1f1050), LIMB_PAIR(0xfcef3c41, 0x5b49d4a6),
+         LIMB_PAIR(0x15608cf3, 0x97025d37), LIMB_PAIR(0x0adcffe2, 0x8ce7fbda),
+         LIMB_PAIR(0xf8efc79a, 0xdb4849ec), LIMB_PAIR(0x67855d5b, 0xfe454312),
+         LIMB_PARTIAL(0x087)}
+    },
+    {
+        {LIMB_PAIR(0x643fa4ef, 0xc6d4508a), LIMB_PAIR(0x2f666f82, 0xa54e8cc0),
+         LIMB_PAIR(0x2dc798a4, 0x34a01969), LIMB_PAIR(0x111ebec5, 0x3b92fc56),
+         LIMB_PAIR(0xce2fedd7, 0x8f6bdc34), LIMB_PAIR(0x57cc1dc0, 0x9d5d1b75),
+         LIMB_PAIR(0xb8fef3f8, 0x8019d044), LIMB_PAIR(0xa5f3c3da, 0x8cb35753),
+         LIMB_PARTIAL(0x091)},
+        {LIMB_PAIR(0x1d608111, 0x81975cb9), LIMB_PAIR(0x6d5131e8, 0x423b14c7),
+         LIMB_PAIR(0x9822e028, 0xcd872107), LIMB_PAIR(0x55997e16, 0x3b325e7e),
+         LIMB_PAIR(0x77cb3c94, 0x076a9d7a), LIMB_PAIR(0xa0038852, 0xbc1550aa),
+         LIMB_PAIR(0xf47b925f, 0x4f0e3b8e), LIMB_PAIR(0xdaa979f8, 0xefd3da16),
+         LIMB_PARTIAL(0x117)}
+    },
+    {
+        {LIMB_PAIR(0x8d320182, 0x39d27f3b), LIMB_PAIR(0x57f13ad2, 0xaf725a25),
+         LIMB_PAIR(0x21f64d54, 0x776680a4), LIMB_PAIR(0x346ad04e, 0x8c76f109),
+         LIMB_PAIR(0x02313957, 0x1c57732c), LIMB_PAIR(0x0026d082, 0xd610c412),
+         LIMB_PAIR(0x9f070119, 0xbf2afd03), LIMB_PAIR(0x0fe119e2, 0xb78ab112),
+         LIMB_PARTIAL(0x195)},
+        {LIMB_PAIR(0xde80e59f, 0x6759cf0f), LIMB_PAIR(0x1c569a55, 0xbc9c518d),
+         LIMB_PAIR(0x6ccc33e7, 0x9ef3afb2), LIMB_PAIR(0x3b2b65a2, 0x54cd7e1c),
+         LIMB_PAIR(0x89020840, 0x056d2549), LIMB_PAIR(0xea20691f, 0x2b8c3c49),
+         LIMB_PAIR(0xecf9ed3d, 0xdd6f6cad), LIMB_PAIR(0xcd81c6b2, 0x0287ed9e),
+         LIMB_PARTIAL(0x1aa)}
+    },
+    {
+        {LIMB_PAIR(0x0886fce5, 0x0932a85e), LIMB_PAIR(0x539e0749, 0xf22990fc),
+         LIMB_PAIR(0x9622b480, 0x0900525d), LIMB_PAIR(0x2322a79e, 0xf8159fb8),
+         LIMB_PAIR(0x52225e4a, 0x16bc8fba), LIMB_PAIR(0x3a8b6083, 0x80aed84f),
+         LIMB_PAIR(0x7c8b52d4, 0x0ec2ea9e), LIMB_PAIR(0x8c474025, 0x88586280),
+         LIMB_PARTIAL(0x122)},
+        {LIMB_PAIR(0x1fa537fc, 0x7e82b98a), LIMB_PAIR(0xb07aee91, 0x06814d94),
+         LIMB_PAIR(0x39bbf49e, 0x2ace89a4), LIMB_PAIR(0x572f35de, 0x4272b632),
+         LIMB_PAIR(0xa6132d49, 0x4aa5ec9c), LIMB_PAIR(0x0ac0cc3e, 0x6da8505b),
+         LIMB_PAIR(0xf0b72ace, 0xe50b950f), LIMB_PAIR(0xeb7a6dcb, 0x38d4e07d),
+         LIMB_PARTIAL(0x0bb)}
+    }
+};
+
+#endif
+
 /** @endcond */
 
 /**
@@ -144,13 +550,14 @@ bool P521::eval(uint8_t result[132], const uint8_t f[66], const uint8_t point[13
         BigNumberUtil::unpackBE(y, NUM_LIMBS_521BIT, point + 66, 66);
         ok = validate(x, y);
     } else {
-        memcpy_P(x, P521_Gx, sizeof(x));
-        memcpy_P(y, P521_Gy, sizeof(y));
         ok = true;
     }
 
     // Evaluate the curve function.
-    evaluate(x, y, f);
+    if (point)
+        evaluate(x, y, f);
+    else
+        evaluateBase(x, y, f);
 
     // Pack the answer into the result array.
     BigNumberUtil::packBE(result, 66, x, NUM_LIMBS_521BIT);
@@ -310,9 +717,7 @@ void P521::sign(uint8_t signature[132], const uint8_t privateKey[66],
             generateK(k, hm, privateKey, count);
 
         // Generate r = kG.x mod q.
-        memcpy_P(x, P521_Gx, sizeof(x));
-        memcpy_P(y, P521_Gy, sizeof(y));
-        evaluate(x, y, k);
+        evaluateBase(x, y, k);
         BigNumberUtil::reduceQuick_P(x, x, P521_q, NUM_LIMBS_521BIT);
         BigNumberUtil::packBE(signature, 66, x, NUM_LIMBS_521BIT);
 
@@ -429,10 +834,8 @@ bool P521::verify(const uint8_t signature[132],
     // Compute the curve point R = u2 * publicKey + u1 * G.
     BigNumberUtil::packBE(t, 66, u2, NUM_LIMBS_521BIT);
     evaluate(x, y, t);
-    memcpy_P(u2, P521_Gx, sizeof(x));
-    memcpy_P(s, P521_Gy, sizeof(y));
     BigNumberUtil::packBE(t, 66, u1, NUM_LIMBS_521BIT);
-    evaluate(u2, s, t);
+    evaluateBase(u2, s, t);
     addAffine(u2, s, x, y);
 
     // If R.x = r mod q, then the signature is valid.
@@ -499,9 +902,7 @@ void P521::derivePublicKey(uint8_t publicKey[132], const uint8_t privateKey[66])
     // Evaluate the curve function starting with the generator.
     limb_t x[NUM_LIMBS_521BIT];
     limb_t y[NUM_LIMBS_521BIT];
-    memcpy_P(x, P521_Gx, sizeof(x));
-    memcpy_P(y, P521_Gy, sizeof(y));
-    evaluate(x, y, privateKey);
+    evaluateBase(x, y, privateKey);
 
     // Pack the (x, y) point into the public key.
     BigNumberUtil::packBE(publicKey, 66, x, NUM_LIMBS_521BIT);
@@ -584,6 +985,19 @@ bool P521::isValidPublicKey(const uint8_t publicKey[132])
  * two operations are equivalent.
  */
 
+#if CRYPTO_P521_WINDOW
+
+// Returns bit b of the 521-bit big-endian scalar f, counting from the
+// least significant bit.  Bits above 520 are zero.
+static inline uint8_t P521_bit(const uint8_t f[66], uint16_t b)
+{
+    if (b > 520)
+        return 0;
+    return (f[65 - (b >> 3)] >> (b & 7)) & 1;
+}
+
+#endif
+
 /**
  * \brief Evaluates the curve function by multiplying (x, y) by f.
  *
@@ -596,6 +1010,108 @@ bool P521::isValidPublicKey(const uint8_t publicKey[132])
  */
 void P521::evaluate(limb_t *x, limb_t *y, const uint8_t f[66])
 {
+#if CRYPTO_P521_WINDOW
+    limb_t table[8][2][NUM_LIMBS_521BIT];
+    limb_t zt[8][NUM_LIMBS_521BIT];
+    limb_t x1[NUM_LIMBS_521BIT];
+    limb_t y1[NUM_LIMBS_521BIT];
+    limb_t z1[NUM_LIMBS_521BIT];
+    limb_t *x2 = zt[0]; // Reuse the table z values once they are not needed.
+    limb_t *y2 = zt[1];
+    limb_t *z2 = zt[2];
+    limb_t *xe = zt[3];
+    limb_t *ye = zt[4];
+    uint8_t i, j, sign, digit;
+    uint8_t posn;
+
+    // Build the table of 1 * P to 8 * P in Jacobian co-ordinates.
+    memcpy(table[0][0], x, sizeof(table[0][0]));
+    memcpy(table[0][1], y, sizeof(table[0][1]));
+    memset(zt[0], 0, sizeof(zt[0]));
+    zt[0][0] = 1;
+    dblPoint(table[1][0], table[1][1], zt[1], x, y, zt[0]);
+    for (i = 2; i < 8; ++i) {
+        addPoint(table[i][0], table[i][1], zt[i], table[i - 1][0],
+                 table[i - 1][1], zt[i - 1], x, y);
+    }
+
+    // Convert the table to affine co-ordinates with a single inversion.
+    // y1 starts as the inverse of z[1] * ... * z[7], and then each 1 / z[i]
+    // is y1 multiplied by the z values below i.  z[0] is 1 already.
+    mul(x1, zt[1], zt[2]);
+    for (i = 3; i < 8; ++i)
+        mul(x1, x1, zt[i]);
+    recip(y1, x1);
+    for (i = 7; i > 0; --i) {
+        memcpy(z1, y1, sizeof(z1));
+        for (j = 1; j < i; ++j)
+            mul(z1, z1, zt[j]);
+        mul(y1, y1, zt[i]);
+        square(x1, z1);
+        mul(table[i][0], table[i][0], x1);
+        mul(x1, x1, z1);
+        mul(table[i][1], table[i][1], x1);
+    }
+
+    // Set the answer to the point-at-infinity initially (z = 0).
+    memset(x1, 0, sizeof(x1));
+    memset(y1, 0, sizeof(y1));
+    memset(z1, 0, sizeof(z1));
+
+    // Process the 131 windows of 4 bits from the highest.  Each window is
+    // recoded to a signed digit between -8 and 8 using the high bit of the
+    // window below (Booth recoding), so that only 8 multiples are needed.
+    for (posn = 131; posn > 0; --posn) {
+        // Make room for the next window.
+        if (posn != 131) {
+            dblPoint(x1, y1, z1, x1, y1, z1);
+            dblPoint(x1, y1, z1, x1, y1, z1);
+            dblPoint(x1, y1, z1, x1, y1, z1);
+            dblPoint(x1, y1, z1, x1, y1, z1);
+        }
+
+        // digit = b[4i - 1] + b[4i] + 2b[4i + 1] + 4b[4i + 2] - 8b[4i + 3].
+        i = posn - 1;
+        sign = P521_bit(f, i * 4 + 3);
+        digit = P521_bit(f, i * 4 + 2) * 4 + P521_bit(f, i * 4 + 1) * 2 +
+                P521_bit(f, i * 4) + (i ? P521_bit(f, i * 4 - 1) : 0);
+        digit ^= (uint8_t)(-sign) & (digit ^ (8 - digit));
+
+        // Select the multiple without revealing the digit in the memory
+        // access pattern, and negate it if the digit is negative.
+        memcpy(xe, table[0][0], sizeof(x1));
+        memcpy(ye, table[0][1], sizeof(y1));
+        for (j = 1; j < 8; ++j) {
+            limb_t select = (limb_t)((((uint16_t)(digit ^ (j + 1))) - 1) >> 8) & 1;
+            cmove(select, xe, table[j][0]);
+            cmove(select, ye, table[j][1]);
+        }
+        memset(x2, 0, sizeof(x1));
+        sub(x2, x2, ye);
+        cmove(sign, ye, x2);
+
+        // Add the multiple, unless the digit was zero.
+        addPoint(x2, y2, z2, x1, y1, z1, xe, ye);
+        cmove(digit, x1, x2);
+        cmove(digit, y1, y2);
+        cmove(digit, z1, z2);
+    }
+
+    // Convert from Jacobian co-ordinates back into affine co-ordinates.
+    // x = x1 * (z1^2)^-1, y = y1 * (z1^3)^-1.
+    recip(x2, z1);
+    square(y2, x2);
+    mul(x, x1, y2);
+    mul(y2, y2, x2);
+    mul(y, y1, y2);
+
+    // Clean up.
+    clean(table);
+    clean(zt);
+    clean(x1);
+    clean(y1);
+    clean(z1);
+#else
     limb_t x1[NUM_LIMBS_521BIT];
     limb_t y1[NUM_LIMBS_521BIT];
     limb_t z1[NUM_LIMBS_521BIT];
@@ -661,6 +1177,84 @@ void P521::evaluate(limb_t *x, limb_t *y, const uint8_t f[66])
     clean(x2);
     clean(y2);
     clean(z2);
+#endif
+}
+
+/**
+ * \brief Evaluates the curve function by multiplying the generator by f.
+ *
+ * \param x The X co-ordinate of the result on exit.
+ * \param y The Y co-ordinate of the result on exit.
+ * \param f The 521-bit scalar to multiply the generator by, most
+ * significant bit first.
+ */
+void P521::evaluateBase(limb_t *x, limb_t *y, const uint8_t f[66])
+{
+#if CRYPTO_P521_WINDOW
+    limb_t x1[NUM_LIMBS_521BIT];
+    limb_t y1[NUM_LIMBS_521BIT];
+    limb_t z1[NUM_LIMBS_521BIT];
+    limb_t x2[NUM_LIMBS_521BIT];
+    limb_t y2[NUM_LIMBS_521BIT];
+    limb_t z2[NUM_LIMBS_521BIT];
+    limb_t t[NUM_LIMBS_521BIT];
+    uint8_t posn, index, i, j;
+
+    // Set the answer to the point-at-infinity initially (z = 0).
+    memset(x1, 0, sizeof(x1));
+    memset(y1, 0, sizeof(y1));
+    memset(z1, 0, sizeof(z1));
+
+    // Process the comb from the top: the answer is doubled and then
+    // the table entry for the bits posn, posn + 105, ..., posn + 420
+    // of f is added.
+    for (posn = 105; posn > 0; --posn) {
+        dblPoint(x1, y1, z1, x1, y1, z1);
+
+        index = 0;
+        for (j = 0; j < 5; ++j)
+            index |= P521_bit(f, (posn - 1) + j * 105) << j;
+
+        // Select the table entry without revealing the index in the
+        // memory access pattern: read every entry and keep the right one.
+        memcpy_P(x, P521_comb[1][0], sizeof(x1));
+        memcpy_P(y, P521_comb[1][1], sizeof(y1));
+        for (i = 2; i < 32; ++i) {
+            limb_t select = (limb_t)((((uint16_t)(index ^ i)) - 1) >> 8) & 1;
+            memcpy_P(t, P521_comb[i][0], sizeof(t));
+            cmove(select, x, t);
+            memcpy_P(t, P521_comb[i][1], sizeof(t));
+            cmove(select, y, t);
+        }
+
+        // Add the entry, unless the index was zero.
+        addPoint(x2, y2, z2, x1, y1, z1, x, y);
+        cmove(index, x1, x2);
+        cmove(index, y1, y2);
+        cmove(index, z1, z2);
+    }
+
+    // Convert from Jacobian co-ordinates back into affine co-ordinates.
+    // x = x1 * (z1^2)^-1, y = y1 * (z1^3)^-1.
+    recip(x2, z1);
+    square(y2, x2);
+    mul(x, x1, y2);
+    mul(y2, y2, x2);
+    mul(y, y1, y2);
+
+    // Clean up.
+    clean(x1);
+    clean(y1);
+    clean(z1);
+    clean(x2);
+    clean(y2);
+    clean(z2);
+    clean(t);
+#else
+    memcpy_P(x, P521_Gx, NUM_LIMBS_521BIT * sizeof(limb_t));
+    memcpy_P(y, P521_Gy, NUM_LIMBS_521BIT * sizeof(limb_t));
+    evaluate(x, y, f);
+#endif
 }
 
 /**
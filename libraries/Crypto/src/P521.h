@@ -59,6 +59,7 @@ public:
 private:
 #endif
     static void evaluate(limb_t *x, limb_t *y, const uint8_t f[66]);
+    static void evaluateBase(limb_t *x, limb_t *y, const uint8_t f[66]);
 
     static void addAffine(limb_t *x1, limb_t *y1,
                           const limb_t *x2, const limb_t *y2);
@@ -86,6 +86,29 @@
     } while (0)
 #endif
 
+#if CRYPTO_POLY1305_26BIT
+
+// Mask for a 26-bit limb and the 2^128 bit that is added to full chunks.
+#define LIMB26_MASK         0x03FFFFFFUL
+#define POLY1305_HIBIT      (1UL << 24)
+
+// Loads a 32-bit little-endian value from an unaligned address.
+static inline uint32_t loadLE32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return le32toh(value);
+}
+
+// Stores a 32-bit little-endian value at an unaligned address.
+static inline void storeLE32(uint8_t *p, uint32_t value)
+{
+    value = htole32(value);
+    memcpy(p, &value, sizeof(value));
+}
+
+#endif
+
 /**
  * \brief Constructs a new Poly1305 message authenticator.
  */
@@ -112,6 +135,24 @@ Poly1305::~Poly1305()
  */
 void Poly1305::reset(const void *key)
 {
+#if CRYPTO_POLY1305_26BIT
+    // Split the key into 26-bit limbs and clear the bits we don't need.
+    // Also precompute 5 * r for the limbs that wrap around 2^130.
+    const uint8_t *k = (const uint8_t *)key;
+    state.r[0] = loadLE32(k) & 0x03FFFFFF;
+    state.r[1] = (loadLE32(k + 3) >> 2) & 0x03FFFF03;
+    state.r[2] = (loadLE32(k + 6) >> 4) & 0x03FFC0FF;
+    state.r[3] = (loadLE32(k + 9) >> 6) & 0x03F03FFF;
+    state.r[4] = (loadLE32(k + 12) >> 8) & 0x000FFFFF;
+    state.s[0] = state.r[1] * 5;
+    state.s[1] = state.r[2] * 5;
+    state.s[2] = state.r[3] * 5;
+    state.s[3] = state.r[4] * 5;
+
+    // Reset the hashing process.
+    state.chunkSize = 0;
+    memset(state.h, 0, sizeof(state.h));
+#else
     // Copy the key into place and clear the bits we don't need.
     uint8_t *r = (uint8_t *)state.r;
     memcpy(r, key, 16);
@@ -129,6 +170,7 @@ void Poly1305::reset(const void *key)
     // Reset the hashing process.
     state.chunkSize = 0;
     memset(state.h, 0, sizeof(state.h));
+#endif
 }
 
 /**
@@ -146,6 +188,28 @@ void Poly1305::update(const void *data, size_t len)
 {
     // Break the input up into 128-bit chunks and process each in turn.
     const uint8_t *d = (const uint8_t *)data;
+#if CRYPTO_POLY1305_26BIT
+    while (len > 0) {
+        if (state.chunkSize == 0 && len >= 16) {
+            // Whole chunks are processed directly from the input.
+            processChunk(d, POLY1305_HIBIT);
+            len -= 16;
+            d += 16;
+        } else {
+            uint8_t size = 16 - state.chunkSize;
+            if (size > len)
+                size = len;
+            memcpy(state.c + state.chunkSize, d, size);
+            state.chunkSize += size;
+            len -= size;
+            d += size;
+            if (state.chunkSize == 16) {
+                processChunk(state.c, POLY1305_HIBIT);
+                state.chunkSize = 0;
+            }
+        }
+    }
+#else
     while (len > 0) {
         uint8_t size = 16 - state.chunkSize;
         if (size > len)
@@ -161,6 +225,7 @@ void Poly1305::update(const void *data, size_t len)
             state.chunkSize = 0;
         }
     }
+#endif
 }
 
 /**
@@ -181,6 +246,67 @@ void Poly1305::update(const void *data, size_t len)
  */
 void Poly1305::finalize(const void *nonce, void *token, size_t len)
 {
+#if CRYPTO_POLY1305_26BIT
+    uint32_t h0, h1, h2, h3, h4;
+    uint32_t g0, g1, g2, g3, g4;
+    uint32_t carry, mask;
+    uint64_t f;
+    const uint8_t *n = (const uint8_t *)nonce;
+
+    // Pad and flush the final chunk.
+    if (state.chunkSize > 0) {
+        state.c[state.chunkSize] = 1;
+        memset(state.c + state.chunkSize + 1, 0, 16 - state.chunkSize - 1);
+        processChunk(state.c, 0);
+    }
+
+    // Fully propagate the carries that processChunk() left in h.
+    h0 = state.h[0];
+    h1 = state.h[1];
+    h2 = state.h[2];
+    h3 = state.h[3];
+    h4 = state.h[4];
+    carry = h1 >> 26; h1 &= LIMB26_MASK;
+    h2 += carry; carry = h2 >> 26; h2 &= LIMB26_MASK;
+    h3 += carry; carry = h3 >> 26; h3 &= LIMB26_MASK;
+    h4 += carry; carry = h4 >> 26; h4 &= LIMB26_MASK;
+    h0 += carry * 5; carry = h0 >> 26; h0 &= LIMB26_MASK;
+    h1 += carry;
+
+    // Compute g = h + 5 - 2^130 and select g if it did not borrow.
+    // The selection is done with masks to avoid giving away any
+    // information about the value of h in the instruction timing.
+    g0 = h0 + 5; carry = g0 >> 26; g0 &= LIMB26_MASK;
+    g1 = h1 + carry; carry = g1 >> 26; g1 &= LIMB26_MASK;
+    g2 = h2 + carry; carry = g2 >> 26; g2 &= LIMB26_MASK;
+    g3 = h3 + carry; carry = g3 >> 26; g3 &= LIMB26_MASK;
+    g4 = h4 + carry - (1UL << 26);
+    mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // Pack h modulo 2^128 into 32-bit words and add the encrypted nonce.
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+    f = (uint64_t)h0 + loadLE32(n);
+    storeLE32(state.c, (uint32_t)f);
+    f = (uint64_t)h1 + loadLE32(n + 4) + (f >> 32);
+    storeLE32(state.c + 4, (uint32_t)f);
+    f = (uint64_t)h2 + loadLE32(n + 8) + (f >> 32);
+    storeLE32(state.c + 8, (uint32_t)f);
+    f = (uint64_t)h3 + loadLE32(n + 12) + (f >> 32);
+    storeLE32(state.c + 12, (uint32_t)f);
+    if (len > 16)
+        len = 16;
+    memcpy(token, state.c, len);
+    h0 = h1 = h2 = h3 = h4 = 0;
+    g0 = g1 = g2 = g3 = g4 = 0;
+#else
     dlimb_t carry;
     uint8_t i;
     limb_t t[NUM_LIMBS_256BIT + 1];
@@ -244,6 +370,7 @@ void Poly1305::finalize(const void *nonce, void *token, size_t len)
     if (len > 16)
         len = 16;
     memcpy(token, state.h, len);
+#endif
 }
 
 /**
@@ -254,10 +381,15 @@ void Poly1305::finalize(const void *nonce, void *token, size_t len)
 void Poly1305::pad()
 {
     if (state.chunkSize != 0) {
+#if CRYPTO_POLY1305_26BIT
+        memset(state.c + state.chunkSize, 0, 16 - state.chunkSize);
+        processChunk(state.c, POLY1305_HIBIT);
+#else
         memset(((uint8_t *)state.c) + state.chunkSize, 0, 16 - state.chunkSize);
         littleToHost(state.c, NUM_LIMBS_128BIT);
         state.c[NUM_LIMBS_128BIT] = 1;
         processChunk();
+#endif
         state.chunkSize = 0;
     }
 }
@@ -270,6 +402,69 @@ void Poly1305::clear()
     clean(state);
 }
 
+#if CRYPTO_POLY1305_26BIT
+
+/**
+ * \brief Processes a single 128-bit chunk of input data.
+ *
+ * \param chunk Points to the 16 bytes of the chunk.
+ * \param hibit POLY1305_HIBIT for a full chunk, or zero for the final
+ * chunk that finalize() has already padded.
+ */
+void Poly1305::processChunk(const uint8_t *chunk, uint32_t hibit)
+{
+    uint32_t r0 = state.r[0];
+    uint32_t r1 = state.r[1];
+    uint32_t r2 = state.r[2];
+    uint32_t r3 = state.r[3];
+    uint32_t r4 = state.r[4];
+    uint32_t s1 = state.s[0];
+    uint32_t s2 = state.s[1];
+    uint32_t s3 = state.s[2];
+    uint32_t s4 = state.s[3];
+    uint32_t h0, h1, h2, h3, h4, carry;
+    uint64_t d0, d1, d2, d3, d4;
+
+    // h += c, splitting the chunk into 26-bit limbs as it is loaded.
+    h0 = state.h[0] + (loadLE32(chunk) & LIMB26_MASK);
+    h1 = state.h[1] + ((loadLE32(chunk + 3) >> 2) & LIMB26_MASK);
+    h2 = state.h[2] + ((loadLE32(chunk + 6) >> 4) & LIMB26_MASK);
+    h3 = state.h[3] + ((loadLE32(chunk + 9) >> 6) & LIMB26_MASK);
+    h4 = state.h[4] + ((loadLE32(chunk + 12) >> 8) | hibit);
+
+    // h *= r, folding the limbs above 2^130 back in by multiplying them
+    // by 5 (pre-multiplied into s).  Each column sum fits in 64 bits.
+    d0 = ((uint64_t)h0 * r0) + ((uint64_t)h1 * s4) + ((uint64_t)h2 * s3) +
+         ((uint64_t)h3 * s2) + ((uint64_t)h4 * s1);
+    d1 = ((uint64_t)h0 * r1) + ((uint64_t)h1 * r0) + ((uint64_t)h2 * s4) +
+         ((uint64_t)h3 * s3) + ((uint64_t)h4 * s2);
+    d2 = ((uint64_t)h0 * r2) + ((uint64_t)h1 * r1) + ((uint64_t)h2 * r0) +
+         ((uint64_t)h3 * s4) + ((uint64_t)h4 * s3);
+    d3 = ((uint64_t)h0 * r3) + ((uint64_t)h1 * r2) + ((uint64_t)h2 * r1) +
+         ((uint64_t)h3 * r0) + ((uint64_t)h4 * s4);
+    d4 = ((uint64_t)h0 * r4) + ((uint64_t)h1 * r3) + ((uint64_t)h2 * r2) +
+         ((uint64_t)h3 * r1) + ((uint64_t)h4 * r0);
+
+    // Partial carry propagation.  The carry out of h1 into h2 is left
+    // for the next chunk or for finalize(), which keeps every limb small
+    // enough for the next multiplication.
+    carry = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & LIMB26_MASK;
+    d1 += carry; carry = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & LIMB26_MASK;
+    d2 += carry; carry = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & LIMB26_MASK;
+    d3 += carry; carry = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & LIMB26_MASK;
+    d4 += carry; carry = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & LIMB26_MASK;
+    h0 += carry * 5; carry = h0 >> 26; h0 &= LIMB26_MASK;
+    h1 += carry;
+
+    state.h[0] = h0;
+    state.h[1] = h1;
+    state.h[2] = h2;
+    state.h[3] = h3;
+    state.h[4] = h4;
+}
+
+#else // !CRYPTO_POLY1305_26BIT
+
 /**
  * \brief Processes a single 128-bit chunk of input data.
  */
@@ -343,3 +538,5 @@ void Poly1305::processChunk()
     // Leave it as-is for now with h less than (2^130 - 5) * 6.  It is
     // still within a range where the next h * r step will not overflow.
 }
+
+#endif // !CRYPTO_POLY1305_26BIT
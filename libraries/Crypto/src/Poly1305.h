@@ -26,6 +26,17 @@
 #include "BigNumberUtil.h"
 #include <stddef.h>
 
+// Define to 1 to use five 26-bit limbs with 32x32->64 multiplies, which
+// is faster than the generic limb code on 32-bit cores.  The default is
+// to use them on all platforms except 8-bit AVR and 64-bit hosts.
+#if !defined(CRYPTO_POLY1305_26BIT)
+#if !defined(__AVR__) && !BIGNUMBER_LIMB_64BIT
+#define CRYPTO_POLY1305_26BIT 1
+#else
+#define CRYPTO_POLY1305_26BIT 0
+#endif
+#endif
+
 class Poly1305
 {
 public:
@@ -41,6 +52,17 @@ public:
     void clear();
 
 private:
+#if CRYPTO_POLY1305_26BIT
+    struct {
+        uint32_t h[5];
+        uint32_t r[5];
+        uint32_t s[4];
+        uint8_t c[16];
+        uint8_t chunkSize;
+    } state;
+
+    void processChunk(const uint8_t *chunk, uint32_t hibit);
+#else
     struct {
         limb_t h[(16 / sizeof(limb_t)) + 1];
         limb_t c[(16 / sizeof(limb_t)) + 1];
@@ -49,6 +71,7 @@ private:
     } state;
 
     void processChunk();
+#endif
 };
 
 #endif
@@ -49,9 +49,58 @@
 #define RNG_WORD_TRNG_GET() (esp_random())
 #define RNG_ESP_NVS 1
 #include <nvs.h>
+#elif defined(ARDUINO_ARCH_RENESAS_UNO) && defined(__has_include)
+#if __has_include(<hw_sce_trng_private.h>)
+// The RA4M1 on the Arduino Uno R4 has a TRNG in its Secure Crypto Engine.
+// The FSP driver returns 128 bits per read, handed out one word at a time.
+#define RNG_WORD_TRNG 1
+#define RNG_RA4M1_TRNG 1
+#define RNG_WORD_TRNG_GET() (ra4m1TRNGWord())
+#include <hw_sce_private.h>
+#include <hw_sce_trng_private.h>
+#endif
+#if __has_include(<EEPROM.h>)
+// The core's EEPROM library emulates EEPROM in the RA4M1 data flash.
+#define RNG_EEPROM_LIB 1
+#endif
+#elif defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED) && defined(__has_include)
+#if __has_include(<EEPROM.h>)
+// The RP2040 has no EEPROM; the core's EEPROM library emulates it in
+// the last sector of flash and needs begin() with a size and commit().
+#define RNG_EEPROM_LIB 1
+#define RNG_EEPROM_LIB_SIZE 4096
+#endif
+#endif
+#if defined(RNG_EEPROM_LIB)
+#include <EEPROM.h>
+// Number of seed slots that save() rotates through to spread the wear.
+#ifndef RNG_SEED_SLOTS
+#define RNG_SEED_SLOTS 4
+#endif
 #endif
 #include <string.h>
 
+#if defined(RNG_RA4M1_TRNG)
+static uint32_t ra4m1TRNGWord()
+{
+    static uint32_t words[4];
+    static uint8_t posn = 4;
+    static bool started = false;
+    if (!started) {
+        // Release the SCE from module stop before the first read.
+        HW_SCE_McuSpecificInit();
+        started = true;
+    }
+    if (posn >= 4) {
+        // On failure the stale words are XOR'ed in again, which adds
+        // nothing but does not weaken the pool either.
+        HW_SCE_RNG_Read(words);
+        posn = 0;
+    }
+    return words[posn++];
+}
+#endif
+
 // Throw a warning if there is no built-in hardware random number source.
 // If this happens, then you need to do one of two things:
 //    1. Edit RNG.cpp to add your platform's hardware TRNG.
@@ -148,6 +197,15 @@
  * also mix in data from other noise sources just in case the CPU's TRNG
  * is not trustworthy.
  *
+ * On the Arduino Uno R4 (RA4M1) and the RP2040 the seed is saved with the
+ * core's EEPROM library, which emulates EEPROM in data flash and program
+ * flash respectively.  The last RNG_SEED_SLOTS * 50 bytes of the EEPROM
+ * hold that many seed slots with a sequence number and CRC-8, and save()
+ * rewrites them in turn so that each one is written only every
+ * RNG_SEED_SLOTS saves.  On the RP2040 begin() calls EEPROM.begin(4096);
+ * applications that use the EEPROM library as well should request the
+ * same size and keep clear of the seed slots.
+ *
  * \sa NoiseSource
  */
 
@@ -175,6 +233,9 @@ RNGClass RNG;
 // Maximum entropy credit that can be contained in the pool.
 #define RNG_MAX_CREDITS     384u
 
+// Discard the buffered keystream reserve after this many milliseconds.
+#define RNG_RESERVE_TIMEOUT 1000UL
+
 /** @cond */
 
 // Imported from Crypto.cpp.
@@ -267,6 +328,11 @@ RNGClass::RNGClass()
     , timeout(3600000UL)    // 1 hour in milliseconds
     , count(0)
     , trngPosn(0)
+#if RNG_RESERVE_SIZE > 0
+    , reservePosn(RNG_RESERVE_SIZE)
+    , buffered(false)
+    , reserveTime(0)
+#endif
 {
 }
 
@@ -296,6 +362,9 @@ RNGClass::~RNGClass()
 #endif
     clean(block);
     clean(stream);
+#if RNG_RESERVE_SIZE > 0
+    clean(reserve);
+#endif
 }
 
 #if defined(RNG_DUE_TRNG)
@@ -369,6 +438,46 @@ static void eraseAndWriteSeed()
 
 #endif
 
+#if defined(RNG_EEPROM_LIB)
+
+// A saved seed in the EEPROM library's storage.  The slots sit at the
+// end of the EEPROM and save() writes the one after the newest slot.
+struct RNGSeedSlot
+{
+    uint8_t seed[RNGClass::SEED_SIZE];
+    uint8_t sequence;
+    uint8_t crc;
+};
+
+// Address of a seed slot.
+static int seedSlotAddress(uint8_t slot)
+{
+    return (int)EEPROM.length() -
+           (int)((RNG_SEED_SLOTS - slot) * sizeof(RNGSeedSlot));
+}
+
+// Finds the slot holding the newest valid seed, or returns RNG_SEED_SLOTS
+// if there is none.  Sequence numbers wrap so they are compared modulo 256.
+static uint8_t findNewestSeed(RNGSeedSlot &newest)
+{
+    RNGSeedSlot slot;
+    uint8_t found = RNG_SEED_SLOTS;
+    for (uint8_t posn = 0; posn < RNG_SEED_SLOTS; ++posn) {
+        EEPROM.get(seedSlotAddress(posn), slot);
+        if (crypto_crc8('S', &slot, sizeof(slot) - 1) != slot.crc)
+            continue;
+        if (found == RNG_SEED_SLOTS ||
+                (int8_t)(slot.sequence - newest.sequence) > 0) {
+            newest = slot;
+            found = posn;
+        }
+    }
+    clean(slot);
+    return found;
+}
+
+#endif
+
 /**
  * \brief Initializes the random number generator.
  *
@@ -418,6 +527,22 @@ void RNGClass::begin(const char *tag)
     REG_TRNG_IDR = TRNG_IDR_DATRDY; // Disable interrupts - we will poll.
     mixTRNG();
 #endif
+#if defined(RNG_EEPROM_LIB)
+    // Do we have a seed saved in one of the EEPROM library slots?
+#if defined(RNG_EEPROM_LIB_SIZE)
+    EEPROM.begin(RNG_EEPROM_LIB_SIZE);
+#endif
+    RNGSeedSlot slot;
+    if (findNewestSeed(slot) < RNG_SEED_SLOTS) {
+        // The slot is byte-aligned, so copy the seed out before using it.
+        uint32_t seed[12];
+        memcpy(seed, slot.seed, SEED_SIZE);
+        for (int posn = 0; posn < 12; ++posn)
+            block[posn + 4] ^= seed[posn];
+        clean(seed);
+    }
+    clean(slot);
+#endif
 #if defined(RNG_ESP_NVS)
     // Do we have a seed saved in ESP non-volatile storage (NVS)?
     nvs_handle handle = 0;
@@ -576,46 +701,60 @@ void RNGClass::rand(uint8_t *data, size_t len)
     else
         credits -= len * 8;
 
-    // If we have pending TRNG data from the loop() function,
-    // then force a stir on the state.  Otherwise mix in some
-    // fresh data from the TRNG because it is possible that
-    // the application forgot to call RNG.loop().
-    if (trngPending) {
-        stir(0, 0, 0);
-        trngPending = 0;
-        trngPosn = 0;
-    } else {
-        mixTRNG();
-    }
-
-    // Generate the random data.
-    uint8_t count = 0;
-    while (len > 0) {
-        // Force a rekey if we have generated too many blocks in this request.
-        if (count >= RNG_REKEY_BLOCKS) {
-            rekey();
-            count = 1;
-        } else {
-            ++count;
+#if RNG_RESERVE_SIZE > 0
+    if (buffered && len <= RNG_RESERVE_SIZE) {
+        // Refill the reserve if it cannot cover the request or is stale.
+        if (len > (size_t)(RNG_RESERVE_SIZE - reservePosn) ||
+                (millis() - reserveTime) >= RNG_RESERVE_TIMEOUT) {
+            generate(reserve, RNG_RESERVE_SIZE);
+            reservePosn = 0;
+            reserveTime = millis();
         }
 
-        // Increment the low counter word and generate a new keystream block.
-        ++(block[12]);
-        ChaCha::hashCore(stream, block, RNG_ROUNDS);
-
-        // Copy the data to the return buffer.
-        if (len < 64) {
-            memcpy(data, stream, len);
-            break;
-        } else {
-            memcpy(data, stream, 64);
-            data += 64;
-            len -= 64;
-        }
+        // Hand out the next bytes and erase them from the reserve so
+        // that they cannot be recovered from a later capture of the state.
+        memcpy(data, reserve + reservePosn, len);
+        memset(reserve + reservePosn, 0, len);
+        reservePosn += len;
+        return;
     }
+#endif
 
-    // Force a rekey after every request.
-    rekey();
+    generate(data, len);
+}
+
+/**
+ * \brief Enables or disables the buffered mode of rand().
+ *
+ * \param enable Set to true to serve small requests from a keystream
+ * reserve, or false to generate every request from a freshly rekeyed
+ * state.
+ *
+ * Without buffering every call to rand() mixes in the TRNG, generates at
+ * least one ChaCha block and rekeys, which costs two ChaCha blocks even
+ * for an 8 byte nonce.  In buffered mode a reserve of RNG_RESERVE_SIZE
+ * bytes is generated at once and the state is rekeyed straight away, so
+ * the reserve cannot be wound back from a later capture of the state.
+ * Requests that fit are copied out of the reserve and the bytes that were
+ * handed out are erased.  The reserve is refilled when it is exhausted,
+ * after stir() so that new entropy takes effect immediately, and when it
+ * is older than one second.  Requests larger than the reserve are always
+ * generated directly.
+ *
+ * This function does nothing if RNG_RESERVE_SIZE is zero, which is the
+ * default on AVR.
+ *
+ * \sa rand()
+ */
+void RNGClass::setBufferedMode(bool enable)
+{
+#if RNG_RESERVE_SIZE > 0
+    buffered = enable;
+    clean(reserve);
+    reservePosn = RNG_RESERVE_SIZE;
+#else
+    (void)enable;
+#endif
 }
 
 /**
@@ -724,6 +863,14 @@ void RNGClass::stir(const uint8_t *data, size_t len, unsigned int credit)
         rekey();
     }
 
+#if RNG_RESERVE_SIZE > 0
+    // Drop the reserve so that the next request sees the new data.
+    if (reservePosn < RNG_RESERVE_SIZE) {
+        clean(reserve);
+        reservePosn = RNG_RESERVE_SIZE;
+    }
+#endif
+
     // Save if this is the first time we have reached max entropy.
     // This provides some protection if the system is powered off before
     // the first auto-save timeout occurs.
@@ -790,6 +937,26 @@ void RNGClass::save()
         nvs_commit(handle);
         nvs_close(handle);
     }
+#elif defined(RNG_EEPROM_LIB)
+    // Write the slot after the newest one with the next sequence number
+    // and leave the older slots alone, so that each slot is rewritten
+    // only once every RNG_SEED_SLOTS saves.
+    RNGSeedSlot slot;
+    uint8_t posn = findNewestSeed(slot);
+    if (posn < RNG_SEED_SLOTS) {
+        posn = (posn + 1) % RNG_SEED_SLOTS;
+        ++(slot.sequence);
+    } else {
+        posn = 0;
+        slot.sequence = 0;
+    }
+    memcpy(slot.seed, stream, SEED_SIZE);
+    slot.crc = crypto_crc8('S', &slot, sizeof(slot) - 1);
+    EEPROM.put(seedSlotAddress(posn), slot);
+#if defined(RNG_EEPROM_LIB_SIZE)
+    EEPROM.commit();
+#endif
+    clean(slot);
 #endif
     rekey();
     timer = millis();
@@ -915,6 +1082,10 @@ void RNGClass::destroy()
 {
     clean(block);
     clean(stream);
+#if RNG_RESERVE_SIZE > 0
+    clean(reserve);
+    reservePosn = RNG_RESERVE_SIZE;
+#endif
 #if defined(RNG_EEPROM)
     int address = RNG_EEPROM_ADDRESS;
     for (int posn = 0; posn < SEED_SIZE; ++posn)
@@ -930,10 +1101,86 @@ void RNGClass::destroy()
         nvs_commit(handle);
         nvs_close(handle);
     }
+#elif defined(RNG_EEPROM_LIB)
+    for (uint8_t slot = 0; slot < RNG_SEED_SLOTS; ++slot) {
+        int address = seedSlotAddress(slot);
+        for (unsigned posn = 0; posn < sizeof(RNGSeedSlot); ++posn)
+            EEPROM.write(address + posn, 0xFF);
+    }
+#if defined(RNG_EEPROM_LIB_SIZE)
+    EEPROM.commit();
+#endif
 #endif
     initialized = 0;
 }
 
+/**
+ * \brief Generates random bytes directly from the pool and rekeys.
+ *
+ * \param data Points to the buffer to fill with random bytes.
+ * \param len Number of bytes to generate.
+ */
+void RNGClass::generate(uint8_t *data, size_t len)
+{
+    // If we have pending TRNG data from the loop() function,
+    // then force a stir on the state.  Otherwise mix in some
+    // fresh data from the TRNG because it is possible that
+    // the application forgot to call RNG.loop().
+    if (trngPending) {
+        stir(0, 0, 0);
+        trngPending = 0;
+        trngPosn = 0;
+    } else {
+        mixTRNG();
+    }
+
+    // Generate the random data.
+    uint8_t count = 0;
+    while (len > 0) {
+        // Force a rekey if we have generated too many blocks in this request.
+        if (count >= RNG_REKEY_BLOCKS) {
+            rekey();
+            count = 0;
+        }
+
+#if CHACHA_PARALLEL_BLOCKS > 1
+        // Generate several keystream blocks at once for large requests,
+        // as long as they all fit before the next forced rekey.
+        if (len >= (64 * CHACHA_PARALLEL_BLOCKS) &&
+                (RNG_REKEY_BLOCKS - count) >= CHACHA_PARALLEL_BLOCKS) {
+            uint32_t wide[16 * CHACHA_PARALLEL_BLOCKS];
+            ++(block[12]);
+            ChaCha::hashCoreParallel(wide, block, RNG_ROUNDS);
+            block[12] += CHACHA_PARALLEL_BLOCKS - 1;
+            memcpy(data, wide, sizeof(wide));
+            clean(wide);
+            data += sizeof(wide);
+            len -= sizeof(wide);
+            count += CHACHA_PARALLEL_BLOCKS;
+            continue;
+        }
+#endif
+        ++count;
+
+        // Increment the low counter word and generate a new keystream block.
+        ++(block[12]);
+        ChaCha::hashCore(stream, block, RNG_ROUNDS);
+
+        // Copy the data to the return buffer.
+        if (len < 64) {
+            memcpy(data, stream, len);
+            break;
+        } else {
+            memcpy(data, stream, 64);
+            data += 64;
+            len -= 64;
+        }
+    }
+
+    // Force a rekey after every request.
+    rekey();
+}
+
 /**
  * \brief Rekeys the random number generator.
  */
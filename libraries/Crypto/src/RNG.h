@@ -26,6 +26,17 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+// Size of the keystream reserve used by the buffered mode, or 0 to leave
+// the buffered mode out (at most 255).  Disabled by default on AVR to
+// save RAM.
+#if !defined(RNG_RESERVE_SIZE)
+#if defined(__AVR__)
+#define RNG_RESERVE_SIZE    0
+#else
+#define RNG_RESERVE_SIZE    64
+#endif
+#endif
+
 class NoiseSource;
 
 class RNGClass
@@ -38,6 +49,7 @@ public:
     void addNoiseSource(NoiseSource &source);
 
     void setAutoSaveTime(uint16_t minutes);
+    void setBufferedMode(bool enable);
 
     void rand(uint8_t *data, size_t len);
     bool available(size_t len) const;
@@ -64,9 +76,16 @@ private:
     NoiseSource *noiseSources[4];
     uint8_t count;
     uint8_t trngPosn;
+#if RNG_RESERVE_SIZE > 0
+    uint8_t reserve[RNG_RESERVE_SIZE];
+    uint8_t reservePosn;
+    bool buffered;
+    unsigned long reserveTime;
+#endif
 
     void rekey();
     void mixTRNG();
+    void generate(uint8_t *data, size_t len);
 };
 
 extern RNGClass RNG;
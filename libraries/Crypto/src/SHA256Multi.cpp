@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "SHA256Multi.h"
+#include "Crypto.h"
+#include "utility/RotateUtil.h"
+#include "utility/EndianUtil.h"
+#include "utility/ProgMemUtil.h"
+#include <string.h>
+
+/**
+ * \class SHA256Multi SHA256Multi.h <SHA256Multi.h>
+ * \brief SHA-256 of many independent messages, several at a time.
+ *
+ * Hashing a batch of short records one after the other through SHA256
+ * leaves the core waiting on the single dependency chain of the rounds,
+ * and pays the buffering and virtual call overhead of the Hash API on
+ * every record.  hashMany() reads full blocks straight from the messages,
+ * builds only the final padded blocks, and runs fully unrolled rounds.
+ * With SHA256_MULTI_LANES set to 2 (the default on Cortex-M7) it keeps two
+ * messages in flight and interleaves the rounds of their compressions,
+ * which share the round constants and give a dual-issue core independent
+ * work between the rotates of each chain.
+ *
+ * The results are the same as those of SHA256:
+ *
+ * \code
+ * const void *records[3] = {rec0, rec1, rec2};
+ * size_t lens[3] = {len0, len1, len2};
+ * uint8_t *hashes[3] = {hash0, hash1, hash2};
+ * SHA256Multi::hashMany(3, hashes, records, lens);
+ * \endcode
+ *
+ * The messages may have different lengths: a lane that finishes early is
+ * refilled with the next message of the batch.
+ *
+ * \sa SHA256
+ */
+
+/**
+ * \var SHA256Multi::HASH_SIZE
+ * \brief Constant for the size of each hash output, in bytes.
+ */
+
+// Round constants for SHA-256.
+static uint32_t const k[64] PROGMEM = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Lane phases: message data left, length block left, last block loaded.
+#define PHASE_DATA      0
+#define PHASE_LENGTH    1
+#define PHASE_DONE      2
+
+/**
+ * \brief Hashes a batch of independent messages with SHA-256.
+ *
+ * \param count The number of messages.
+ * \param hashes The output buffers, HASH_SIZE bytes each, one per message.
+ * \param messages Points to the messages.
+ * \param lens The lengths of the messages in bytes.
+ */
+void SHA256Multi::hashMany(size_t count, uint8_t *const hashes[],
+                           const void *const messages[], const size_t lens[])
+{
+    Lane lanes[SHA256_MULTI_LANES];
+    size_t slot[SHA256_MULTI_LANES];
+    uint8_t active = 0;
+    size_t next = 0;
+    uint8_t index;
+
+    // Fill the lanes with the first messages.
+    while (active < SHA256_MULTI_LANES && next < count) {
+        start(lanes[active], messages[next], lens[next]);
+        slot[active++] = next++;
+    }
+
+    while (active > 0) {
+        for (index = 0; index < active; ++index)
+            loadBlock(lanes[index]);
+#if SHA256_MULTI_LANES > 1
+        for (index = 0; (index + 1) < active; index += 2)
+            compress2(lanes[index], lanes[index + 1]);
+        if (index < active)
+            compress(lanes[index]);
+#else
+        compress(lanes[0]);
+#endif
+
+        // Retire the finished messages and refill their lanes.
+        index = 0;
+        while (index < active) {
+            if (lanes[index].phase != PHASE_DONE) {
+                ++index;
+                continue;
+            }
+            finish(lanes[index], hashes[slot[index]]);
+            if (next < count) {
+                start(lanes[index], messages[next], lens[next]);
+                slot[index] = next++;
+                ++index;
+            } else {
+                --active;
+                lanes[index] = lanes[active];
+                slot[index] = slot[active];
+            }
+        }
+    }
+
+    clean(lanes, sizeof(lanes));
+}
+
+/**
+ * \brief Starts hashing a message in a lane.
+ */
+void SHA256Multi::start(Lane &lane, const void *message, size_t len)
+{
+    lane.data = (const uint8_t *)message;
+    lane.len = len;
+    lane.bits = ((uint64_t)len) << 3;
+    lane.phase = PHASE_DATA;
+    lane.h[0] = 0x6a09e667;
+    lane.h[1] = 0xbb67ae85;
+    lane.h[2] = 0x3c6ef372;
+    lane.h[3] = 0xa54ff53a;
+    lane.h[4] = 0x510e527f;
+    lane.h[5] = 0x9b05688c;
+    lane.h[6] = 0x1f83d9ab;
+    lane.h[7] = 0x5be0cd19;
+}
+
+/**
+ * \brief Loads the next block of a lane into its message schedule, in
+ * host byte order.
+ *
+ * Full blocks come straight from the message; the tail, the 0x80 padding
+ * byte and the bit length are assembled in the schedule itself.
+ */
+void SHA256Multi::loadBlock(Lane &lane)
+{
+    uint8_t *wbytes = (uint8_t *)lane.w;
+    uint8_t index;
+
+    if (lane.phase == PHASE_DATA && lane.len >= 64) {
+        const uint8_t *d = lane.data;
+        for (index = 0; index < 16; ++index, d += 4) {
+            lane.w[index] = (((uint32_t)d[0]) << 24) |
+                            (((uint32_t)d[1]) << 16) |
+                            (((uint32_t)d[2]) << 8) |
+                             ((uint32_t)d[3]);
+        }
+        lane.data += 64;
+        lane.len -= 64;
+        return;
+    }
+
+    memset(wbytes, 0, 64);
+    if (lane.phase == PHASE_DATA) {
+        if (lane.len > 0)
+            memcpy(wbytes, lane.data, lane.len);
+        wbytes[lane.len] = 0x80;
+        if (lane.len > (64 - 9)) {
+            // No room for the length: it goes in one more block.
+            lane.phase = PHASE_LENGTH;
+            for (index = 0; index < 16; ++index)
+                lane.w[index] = be32toh(lane.w[index]);
+            return;
+        }
+    }
+    for (index = 0; index < 14; ++index)
+        lane.w[index] = be32toh(lane.w[index]);
+    lane.w[14] = (uint32_t)(lane.bits >> 32);
+    lane.w[15] = (uint32_t)lane.bits;
+    lane.phase = PHASE_DONE;
+}
+
+/**
+ * \brief Writes the hash of a lane whose last block has been compressed.
+ */
+void SHA256Multi::finish(Lane &lane, uint8_t *hash)
+{
+    for (uint8_t posn = 0; posn < 8; ++posn)
+        lane.w[posn] = htobe32(lane.h[posn]);
+    memcpy(hash, lane.w, HASH_SIZE);
+}
+
+// Expands the message schedule word for round i in place.
+#define expandWord(w, i) \
+    ((w)[(i) & 0x0F] += \
+        (rightRotate17((w)[((i) - 2) & 0x0F]) ^ \
+         rightRotate19((w)[((i) - 2) & 0x0F]) ^ \
+         ((w)[((i) - 2) & 0x0F] >> 10)) + \
+        (w)[((i) - 7) & 0x0F] + \
+        (rightRotate7((w)[((i) - 15) & 0x0F]) ^ \
+         rightRotate18((w)[((i) - 15) & 0x0F]) ^ \
+         ((w)[((i) - 15) & 0x0F] >> 3)))
+
+// Performs one SHA-256 round.  The caller rotates the names of the
+// working variables instead of moving their values.
+#define sha256Round(a, b, c, d, e, f, g, h, kw) \
+    do { \
+        uint32_t _t1 = (h) + (kw) + \
+            (rightRotate6(e) ^ rightRotate11(e) ^ rightRotate25(e)) + \
+            (((e) & (f)) ^ ((~(e)) & (g))); \
+        uint32_t _t2 = (rightRotate2(a) ^ rightRotate13(a) ^ rightRotate22(a)) + \
+            (((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c))); \
+        (d) += _t1; \
+        (h) = _t1 + _t2; \
+    } while (0)
+
+// Eight rounds of one lane, starting at round i.
+#define sha256Rounds8(v, w, i, expand) \
+    do { \
+        sha256Round(v##a, v##b, v##c, v##d, v##e, v##f, v##g, v##h, pgm_read_dword(k + (i)) + expand(w, (i))); \
+        sha256Round(v##h, v##a, v##b, v##c, v##d, v##e, v##f, v##g, pgm_read_dword(k + (i) + 1) + expand(w, (i) + 1)); \
+        sha256Round(v##g, v##h, v##a, v##b, v##c, v##d, v##e, v##f, pgm_read_dword(k + (i) + 2) + expand(w, (i) + 2)); \
+        sha256Round(v##f, v##g, v##h, v##a, v##b, v##c, v##d, v##e, pgm_read_dword(k + (i) + 3) + expand(w, (i) + 3)); \
+        sha256Round(v##e, v##f, v##g, v##h, v##a, v##b, v##c, v##d, pgm_read_dword(k + (i) + 4) + expand(w, (i) + 4)); \
+        sha256Round(v##d, v##e, v##f, v##g, v##h, v##a, v##b, v##c, pgm_read_dword(k + (i) + 5) + expand(w, (i) + 5)); \
+        sha256Round(v##c, v##d, v##e, v##f, v##g, v##h, v##a, v##b, pgm_read_dword(k + (i) + 6) + expand(w, (i) + 6)); \
+        sha256Round(v##b, v##c, v##d, v##e, v##f, v##g, v##h, v##a, pgm_read_dword(k + (i) + 7) + expand(w, (i) + 7)); \
+    } while (0)
+
+// Message word of the first 16 rounds, already loaded.
+#define loadedWord(w, i)    ((w)[(i)])
+
+/**
+ * \brief Compresses the loaded block of a single lane.
+ */
+void SHA256Multi::compress(Lane &lane)
+{
+    uint32_t xa = lane.h[0];
+    uint32_t xb = lane.h[1];
+    uint32_t xc = lane.h[2];
+    uint32_t xd = lane.h[3];
+    uint32_t xe = lane.h[4];
+    uint32_t xf = lane.h[5];
+    uint32_t xg = lane.h[6];
+    uint32_t xh = lane.h[7];
+    uint8_t index;
+
+    for (index = 0; index < 16; index += 8)
+        sha256Rounds8(x, lane.w, index, loadedWord);
+    for (; index < 64; index += 8)
+        sha256Rounds8(x, lane.w, index, expandWord);
+
+    lane.h[0] += xa;
+    lane.h[1] += xb;
+    lane.h[2] += xc;
+    lane.h[3] += xd;
+    lane.h[4] += xe;
+    lane.h[5] += xf;
+    lane.h[6] += xg;
+    lane.h[7] += xh;
+}
+
+#if SHA256_MULTI_LANES > 1
+
+// One round of two lanes, sharing the round constant.
+#define sha256Round2(a, b, c, d, e, f, g, h, i, expand) \
+    do { \
+        uint32_t _k = pgm_read_dword(k + (i)); \
+        sha256Round(x##a, x##b, x##c, x##d, x##e, x##f, x##g, x##h, _k + expand(x.w, (i))); \
+        sha256Round(y##a, y##b, y##c, y##d, y##e, y##f, y##g, y##h, _k + expand(y.w, (i))); \
+    } while (0)
+
+// Eight rounds of two lanes, starting at round i.
+#define sha256Rounds8x2(i, expand) \
+    do { \
+        sha256Round2(a, b, c, d, e, f, g, h, (i), expand); \
+        sha256Round2(h, a, b, c, d, e, f, g, (i) + 1, expand); \
+        sha256Round2(g, h, a, b, c, d, e, f, (i) + 2, expand); \
+        sha256Round2(f, g, h, a, b, c, d, e, (i) + 3, expand); \
+        sha256Round2(e, f, g, h, a, b, c, d, (i) + 4, expand); \
+        sha256Round2(d, e, f, g, h, a, b, c, (i) + 5, expand); \
+        sha256Round2(c, d, e, f, g, h, a, b, (i) + 6, expand); \
+        sha256Round2(b, c, d, e, f, g, h, a, (i) + 7, expand); \
+    } while (0)
+
+/**
+ * \brief Compresses the loaded blocks of two lanes with their rounds
+ * interleaved.
+ */
+void SHA256Multi::compress2(Lane &x, Lane &y)
+{
+    uint32_t xa = x.h[0], ya = y.h[0];
+    uint32_t xb = x.h[1], yb = y.h[1];
+    uint32_t xc = x.h[2], yc = y.h[2];
+    uint32_t xd = x.h[3], yd = y.h[3];
+    uint32_t xe = x.h[4], ye = y.h[4];
+    uint32_t xf = x.h[5], yf = y.h[5];
+    uint32_t xg = x.h[6], yg = y.h[6];
+    uint32_t xh = x.h[7], yh = y.h[7];
+    uint8_t index;
+
+    for (index = 0; index < 16; index += 8)
+        sha256Rounds8x2(index, loadedWord);
+    for (; index < 64; index += 8)
+        sha256Rounds8x2(index, expandWord);
+
+    x.h[0] += xa; y.h[0] += ya;
+    x.h[1] += xb; y.h[1] += yb;
+    x.h[2] += xc; y.h[2] += yc;
+    x.h[3] += xd; y.h[3] += yd;
+    x.h[4] += xe; y.h[4] += ye;
+    x.h[5] += xf; y.h[5] += yf;
+    x.h[6] += xg; y.h[6] += yg;
+    x.h[7] += xh; y.h[7] += yh;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CRYPTO_SHA256MULTI_h
+#define CRYPTO_SHA256MULTI_h
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Number of messages compressed together.  Interleaving two chains only
+// pays off on dual-issue cores with registers to hold both: Cortex-M7
+// (told apart from the M4 by its double-precision FPU).  Single-issue
+// cores such as the Cortex-M4 and Xtensa gain nothing and would spill the
+// second chain, so they hash one message at a time.
+#if !defined(SHA256_MULTI_LANES)
+#if defined(__ARM_ARCH_7EM__) && defined(__ARM_FP) && (__ARM_FP & 0x08)
+#define SHA256_MULTI_LANES 2
+#else
+#define SHA256_MULTI_LANES 1
+#endif
+#endif
+
+class SHA256Multi
+{
+public:
+    static void hashMany(size_t count, uint8_t *const hashes[],
+                         const void *const messages[], const size_t lens[]);
+
+    static const size_t HASH_SIZE = 32;
+
+private:
+    // Constructor and destructor are private - cannot instantiate this class.
+    SHA256Multi();
+    ~SHA256Multi();
+
+    // One message being hashed.
+    struct Lane
+    {
+        const uint8_t *data;
+        size_t len;
+        uint64_t bits;
+        uint8_t phase;
+        uint32_t h[8];
+        uint32_t w[16];
+    };
+
+    static void start(Lane &lane, const void *message, size_t len);
+    static void loadBlock(Lane &lane);
+    static void finish(Lane &lane, uint8_t *hash);
+    static void compress(Lane &lane);
+#if SHA256_MULTI_LANES > 1
+    static void compress2(Lane &x, Lane &y);
+#endif
+};
+
+#endif
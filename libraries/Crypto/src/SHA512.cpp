@@ -27,6 +27,20 @@
 #include "utility/ProgMemUtil.h"
 #include <string.h>
 
+// Selects the compression function.  The reference version works on
+// native 64-bit words.  The 32-bit version keeps every word as two 32-bit
+// halves and unrolls eight rounds so that the working variables are
+// renamed instead of being moved down one position per round.  It suits
+// 32-bit cores such as Cortex-M, where the compiler otherwise spills the
+// 64-bit working variables and shuffles them as register pairs.
+#if !defined(CRYPTO_SHA512_32BIT)
+#if defined(__arm__) && !defined(__aarch64__)
+#define CRYPTO_SHA512_32BIT 1
+#else
+#define CRYPTO_SHA512_32BIT 0
+#endif
+#endif
+
 /**
  * \class SHA512 SHA512.h <SHA512.h>
  * \brief SHA-512 hash algorithm.
@@ -169,44 +183,236 @@ void SHA512::finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t has
     clean(temp);
 }
 
+// Round constants for SHA-512.
+static uint64_t const k[80] PROGMEM = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL,
+    0xE9B5DBA58189DBBCULL, 0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL,
+    0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL, 0xD807AA98A3030242ULL,
+    0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL,
+    0xC19BF174CF692694ULL, 0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL,
+    0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL, 0x2DE92C6F592B0275ULL,
+    0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL,
+    0xBF597FC7BEEF0EE4ULL, 0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL,
+    0x06CA6351E003826FULL, 0x142929670A0E6E70ULL, 0x27B70A8546D22FFCULL,
+    0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL,
+    0x92722C851482353BULL, 0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL,
+    0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL, 0xD192E819D6EF5218ULL,
+    0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL,
+    0x34B0BCB5E19B48A8ULL, 0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL,
+    0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL, 0x748F82EE5DEFB2FCULL,
+    0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL,
+    0xC67178F2E372532BULL, 0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL,
+    0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL, 0x06F067AA72176FBAULL,
+    0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL,
+    0x431D67C49C100D4CULL, 0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL,
+    0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL
+};
+
+#if CRYPTO_SHA512_32BIT
+
+namespace {
+
+// 64-bit word held as two 32-bit halves.
+struct Word64
+{
+    uint32_t hi;
+    uint32_t lo;
+};
+
+inline Word64 load64(uint64_t value)
+{
+    Word64 r;
+    r.hi = (uint32_t)(value >> 32);
+    r.lo = (uint32_t)value;
+    return r;
+}
+
+inline uint64_t store64(Word64 x)
+{
+    return (((uint64_t)x.hi) << 32) | x.lo;
+}
+
+inline Word64 add64(Word64 x, Word64 y)
+{
+    Word64 r;
+    r.lo = x.lo + y.lo;
+    r.hi = x.hi + y.hi + (r.lo < x.lo);
+    return r;
+}
+
+inline Word64 xor64(Word64 x, Word64 y, Word64 z)
+{
+    Word64 r;
+    r.hi = x.hi ^ y.hi ^ z.hi;
+    r.lo = x.lo ^ y.lo ^ z.lo;
+    return r;
+}
+
+// Rotate right by 0 < n < 32.
+inline Word64 rotr64(Word64 x, uint8_t n)
+{
+    Word64 r;
+    r.hi = (x.hi >> n) | (x.lo << (32 - n));
+    r.lo = (x.lo >> n) | (x.hi << (32 - n));
+    return r;
+}
+
+// Rotate right by 32 + n, 0 < n < 32: the halves swap for free.
+inline Word64 rotr64High(Word64 x, uint8_t n)
+{
+    Word64 r;
+    r.hi = (x.lo >> n) | (x.hi << (32 - n));
+    r.lo = (x.hi >> n) | (x.lo << (32 - n));
+    return r;
+}
+
+// Shift right by 0 < n < 32.
+inline Word64 shr64(Word64 x, uint8_t n)
+{
+    Word64 r;
+    r.hi = x.hi >> n;
+    r.lo = (x.lo >> n) | (x.hi << (32 - n));
+    return r;
+}
+
+inline Word64 bigSigma0(Word64 a)
+{
+    return xor64(rotr64(a, 28), rotr64High(a, 2), rotr64High(a, 7));
+}
+
+inline Word64 bigSigma1(Word64 e)
+{
+    return xor64(rotr64(e, 14), rotr64(e, 18), rotr64High(e, 9));
+}
+
+inline Word64 smallSigma0(Word64 x)
+{
+    return xor64(rotr64(x, 1), rotr64(x, 8), shr64(x, 7));
+}
+
+inline Word64 smallSigma1(Word64 x)
+{
+    return xor64(rotr64(x, 19), rotr64High(x, 29), shr64(x, 6));
+}
+
+inline Word64 choose64(Word64 e, Word64 f, Word64 g)
+{
+    Word64 r;
+    r.hi = g.hi ^ (e.hi & (f.hi ^ g.hi));
+    r.lo = g.lo ^ (e.lo & (f.lo ^ g.lo));
+    return r;
+}
+
+inline Word64 majority64(Word64 a, Word64 b, Word64 c)
+{
+    Word64 r;
+    r.hi = (a.hi & b.hi) | (c.hi & (a.hi | b.hi));
+    r.lo = (a.lo & b.lo) | (c.lo & (a.lo | b.lo));
+    return r;
+}
+
+// Next message word, expanded in place in the 16-word window from round 16.
+inline Word64 schedule64(uint64_t *w, uint8_t index)
+{
+    if (index < 16)
+        return load64(w[index]);
+    Word64 r = add64(add64(load64(w[(index - 16) & 0x0F]),
+                           load64(w[(index - 7) & 0x0F])),
+                     add64(smallSigma0(load64(w[(index - 15) & 0x0F])),
+                           smallSigma1(load64(w[(index - 2) & 0x0F]))));
+    w[index & 0x0F] = store64(r);
+    return r;
+}
+
+} // namespace
+
+// One round.  Instead of moving every working variable down, the caller
+// rotates the argument names, so only d and h are written.
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, index) \
+    do { \
+        Word64 _t1 = add64(add64(h, bigSigma1(e)), \
+                           add64(add64(choose64(e, f, g), \
+                                       load64(pgm_read_qword(k + (index)))), \
+                                 schedule64(state.w, (index)))); \
+        d = add64(d, _t1); \
+        h = add64(_t1, add64(bigSigma0(a), majority64(a, b, c))); \
+    } while (0)
+
 /**
  * \brief Processes a single 1024-bit chunk with the core SHA-512 algorithm.
  *
+ * This is the 32-bit version selected by CRYPTO_SHA512_32BIT.  It computes
+ * the same function as the 64-bit reference version below.
+ *
  * Reference: http://en.wikipedia.org/wiki/SHA-2
  */
 void SHA512::processChunk()
 {
-    // Round constants for SHA-512.
-    static uint64_t const k[80] PROGMEM = {
-        0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL,
-        0xE9B5DBA58189DBBCULL, 0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL,
-        0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL, 0xD807AA98A3030242ULL,
-        0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
-        0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL,
-        0xC19BF174CF692694ULL, 0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL,
-        0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL, 0x2DE92C6F592B0275ULL,
-        0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
-        0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL,
-        0xBF597FC7BEEF0EE4ULL, 0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL,
-        0x06CA6351E003826FULL, 0x142929670A0E6E70ULL, 0x27B70A8546D22FFCULL,
-        0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
-        0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL,
-        0x92722C851482353BULL, 0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL,
-        0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL, 0xD192E819D6EF5218ULL,
-        0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
-        0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL,
-        0x34B0BCB5E19B48A8ULL, 0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL,
-        0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL, 0x748F82EE5DEFB2FCULL,
-        0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
-        0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL,
-        0xC67178F2E372532BULL, 0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL,
-        0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL, 0x06F067AA72176FBAULL,
-        0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
-        0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL,
-        0x431D67C49C100D4CULL, 0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL,
-        0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL
-    };
+    // Convert the first 16 words from big endian to host byte order.
+    uint8_t index;
+    for (index = 0; index < 16; ++index)
+        state.w[index] = be64toh(state.w[index]);
 
+    // Initialise working variables to the current hash value.
+    Word64 a = load64(state.h[0]);
+    Word64 b = load64(state.h[1]);
+    Word64 c = load64(state.h[2]);
+    Word64 d = load64(state.h[3]);
+    Word64 e = load64(state.h[4]);
+    Word64 f = load64(state.h[5]);
+    Word64 g = load64(state.h[6]);
+    Word64 h = load64(state.h[7]);
+
+    // Eight rounds per iteration bring the names back to their places.
+    for (index = 0; index < 80; index += 8) {
+        SHA512_ROUND(a, b, c, d, e, f, g, h, index);
+        SHA512_ROUND(h, a, b, c, d, e, f, g, index + 1);
+        SHA512_ROUND(g, h, a, b, c, d, e, f, index + 2);
+        SHA512_ROUND(f, g, h, a, b, c, d, e, index + 3);
+        SHA512_ROUND(e, f, g, h, a, b, c, d, index + 4);
+        SHA512_ROUND(d, e, f, g, h, a, b, c, index + 5);
+        SHA512_ROUND(c, d, e, f, g, h, a, b, index + 6);
+        SHA512_ROUND(b, c, d, e, f, g, h, a, index + 7);
+    }
+
+    // Add the compressed chunk to the current hash value.
+    state.h[0] = store64(add64(load64(state.h[0]), a));
+    state.h[1] = store64(add64(load64(state.h[1]), b));
+    state.h[2] = store64(add64(load64(state.h[2]), c));
+    state.h[3] = store64(add64(load64(state.h[3]), d));
+    state.h[4] = store64(add64(load64(state.h[4]), e));
+    state.h[5] = store64(add64(load64(state.h[5]), f));
+    state.h[6] = store64(add64(load64(state.h[6]), g));
+    state.h[7] = store64(add64(load64(state.h[7]), h));
+
+    // Attempt to clean up the stack.
+    clean(&a, sizeof(a));
+    clean(&b, sizeof(b));
+    clean(&c, sizeof(c));
+    clean(&d, sizeof(d));
+    clean(&e, sizeof(e));
+    clean(&f, sizeof(f));
+    clean(&g, sizeof(g));
+    clean(&h, sizeof(h));
+}
+
+#undef SHA512_ROUND
+
+#else // !CRYPTO_SHA512_32BIT
+
+/**
+ * \brief Processes a single 1024-bit chunk with the core SHA-512 algorithm.
+ *
+ * Reference: http://en.wikipedia.org/wiki/SHA-2
+ */
+void SHA512::processChunk()
+{
     // Convert the first 16 words from big endian to host byte order.
     uint8_t index;
     for (index = 0; index < 16; ++index)
@@ -283,3 +489,5 @@ void SHA512::processChunk()
     // Attempt to clean up the stack.
     a = b = c = d = e = f = g = h = temp1 = temp2 = 0;
 }
+
+#endif // !CRYPTO_SHA512_32BIT
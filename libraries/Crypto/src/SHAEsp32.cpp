@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SHAEsp32.h"
+#include "Crypto.h"
+#include <string.h>
+
+// SHA-256 and SHA-512 for ESP32 using the hardware crypto module.
+
+#if CRYPTO_SHA_ESP32
+
+#include "mbedtls/version.h"
+
+// mbedtls 3.x (esp-idf 5) dropped the "_ret" suffix that 2.x used for the
+// versions of these functions that return an error code.  The return
+// values are ignored: the Hash interface has no error path.
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define CRYPTO_SHA256_STARTS(ctx, is224)      mbedtls_sha256_starts((ctx), (is224))
+#define CRYPTO_SHA256_UPDATE(ctx, data, len)  mbedtls_sha256_update((ctx), (data), (len))
+#define CRYPTO_SHA256_FINISH(ctx, out)        mbedtls_sha256_finish((ctx), (out))
+#define CRYPTO_SHA512_STARTS(ctx, is384)      mbedtls_sha512_starts((ctx), (is384))
+#define CRYPTO_SHA512_UPDATE(ctx, data, len)  mbedtls_sha512_update((ctx), (data), (len))
+#define CRYPTO_SHA512_FINISH(ctx, out)        mbedtls_sha512_finish((ctx), (out))
+#else
+#define CRYPTO_SHA256_STARTS(ctx, is224)      mbedtls_sha256_starts_ret((ctx), (is224))
+#define CRYPTO_SHA256_UPDATE(ctx, data, len)  mbedtls_sha256_update_ret((ctx), (data), (len))
+#define CRYPTO_SHA256_FINISH(ctx, out)        mbedtls_sha256_finish_ret((ctx), (out))
+#define CRYPTO_SHA512_STARTS(ctx, is384)      mbedtls_sha512_starts_ret((ctx), (is384))
+#define CRYPTO_SHA512_UPDATE(ctx, data, len)  mbedtls_sha512_update_ret((ctx), (data), (len))
+#define CRYPTO_SHA512_FINISH(ctx, out)        mbedtls_sha512_finish_ret((ctx), (out))
+#endif
+
+/**
+ * \class SHA256Esp32 SHAEsp32.h <SHAEsp32.h>
+ * \brief SHA-256 hash algorithm using the ESP32 SHA peripheral.
+ *
+ * Same results as SHA256, computed by the hardware when it is free.
+ * Unlike SHA256, objects of this class cannot be copied.
+ *
+ * \sa SHA256
+ */
+
+SHA256Esp32::SHA256Esp32()
+{
+    mbedtls_sha256_init(&ctx);
+    reset();
+}
+
+SHA256Esp32::~SHA256Esp32()
+{
+    mbedtls_sha256_free(&ctx);
+    clean(ctx);
+}
+
+size_t SHA256Esp32::hashSize() const
+{
+    return 32;
+}
+
+size_t SHA256Esp32::blockSize() const
+{
+    return 64;
+}
+
+void SHA256Esp32::reset()
+{
+    CRYPTO_SHA256_STARTS(&ctx, 0);
+}
+
+void SHA256Esp32::update(const void *data, size_t len)
+{
+    CRYPTO_SHA256_UPDATE(&ctx, (const unsigned char *)data, len);
+}
+
+void SHA256Esp32::finalize(void *hash, size_t len)
+{
+    uint8_t temp[32];
+    CRYPTO_SHA256_FINISH(&ctx, temp);
+    if (len > sizeof(temp))
+        len = sizeof(temp);
+    memcpy(hash, temp, len);
+    clean(temp);
+}
+
+void SHA256Esp32::clear()
+{
+    mbedtls_sha256_free(&ctx);
+    clean(ctx);
+    mbedtls_sha256_init(&ctx);
+    reset();
+}
+
+void SHA256Esp32::resetHMAC(const void *key, size_t keyLen)
+{
+    uint8_t block[64];
+    formatHMACKey(block, key, keyLen, 0x36);
+    update(block, sizeof(block));
+    clean(block);
+}
+
+void SHA256Esp32::finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t hashLen)
+{
+    uint8_t block[64];
+    uint8_t temp[32];
+    finalize(temp, sizeof(temp));
+    formatHMACKey(block, key, keyLen, 0x5C);
+    update(block, sizeof(block));
+    update(temp, sizeof(temp));
+    finalize(hash, hashLen);
+    clean(block);
+    clean(temp);
+}
+
+/**
+ * \class SHA512Esp32 SHAEsp32.h <SHAEsp32.h>
+ * \brief SHA-512 hash algorithm using the ESP32 SHA peripheral.
+ *
+ * Same results as SHA512, computed by the hardware when it is free.
+ * Unlike SHA512, objects of this class cannot be copied.
+ *
+ * \sa SHA512
+ */
+
+SHA512Esp32::SHA512Esp32()
+{
+    mbedtls_sha512_init(&ctx);
+    reset();
+}
+
+SHA512Esp32::~SHA512Esp32()
+{
+    mbedtls_sha512_free(&ctx);
+    clean(ctx);
+}
+
+size_t SHA512Esp32::hashSize() const
+{
+    return 64;
+}
+
+size_t SHA512Esp32::blockSize() const
+{
+    return 128;
+}
+
+void SHA512Esp32::reset()
+{
+    CRYPTO_SHA512_STARTS(&ctx, 0);
+}
+
+void SHA512Esp32::update(const void *data, size_t len)
+{
+    CRYPTO_SHA512_UPDATE(&ctx, (const unsigned char *)data, len);
+}
+
+void SHA512Esp32::finalize(void *hash, size_t len)
+{
+    uint8_t temp[64];
+    CRYPTO_SHA512_FINISH(&ctx, temp);
+    if (len > sizeof(temp))
+        len = sizeof(temp);
+    memcpy(hash, temp, len);
+    clean(temp);
+}
+
+void SHA512Esp32::clear()
+{
+    mbedtls_sha512_free(&ctx);
+    clean(ctx);
+    mbedtls_sha512_init(&ctx);
+    reset();
+}
+
+void SHA512Esp32::resetHMAC(const void *key, size_t keyLen)
+{
+    uint8_t block[128];
+    formatHMACKey(block, key, keyLen, 0x36);
+    update(block, sizeof(block));
+    clean(block);
+}
+
+void SHA512Esp32::finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t hashLen)
+{
+    uint8_t block[128];
+    uint8_t temp[64];
+    finalize(temp, sizeof(temp));
+    formatHMACKey(block, key, keyLen, 0x5C);
+    update(block, sizeof(block));
+    update(temp, sizeof(temp));
+    finalize(hash, hashLen);
+    clean(block);
+    clean(temp);
+}
+
+#endif // CRYPTO_SHA_ESP32
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 Cryptnox
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CRYPTO_SHA_ESP32_h
+#define CRYPTO_SHA_ESP32_h
+
+#include "Hash.h"
+
+// Hardware-backed SHA-256 and SHA-512 for ESP32.  Hashing goes through
+// the mbedtls bundled with esp-idf, which drives the SHA peripheral and
+// falls back to software when the peripheral is busy or the chip has no
+// engine for the algorithm.  Define CRYPTO_SHA_ESP32 to 0 to leave them out.
+#if !defined(CRYPTO_SHA_ESP32)
+#if defined(ESP32)
+#define CRYPTO_SHA_ESP32 1
+#else
+#define CRYPTO_SHA_ESP32 0
+#endif
+#endif
+
+#if CRYPTO_SHA_ESP32
+
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+
+class SHA256Esp32 : public Hash
+{
+public:
+    SHA256Esp32();
+    virtual ~SHA256Esp32();
+
+    size_t hashSize() const;
+    size_t blockSize() const;
+
+    void reset();
+    void update(const void *data, size_t len);
+    void finalize(void *hash, size_t len);
+
+    void clear();
+
+    void resetHMAC(const void *key, size_t keyLen);
+    void finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t hashLen);
+
+    static const size_t HASH_SIZE  = 32;
+    static const size_t BLOCK_SIZE = 64;
+
+private:
+    mbedtls_sha256_context ctx;
+
+    // The context may refer to the peripheral, so it cannot be copied.
+    SHA256Esp32(const SHA256Esp32 &);
+    SHA256Esp32 &operator=(const SHA256Esp32 &);
+};
+
+class SHA512Esp32 : public Hash
+{
+public:
+    SHA512Esp32();
+    virtual ~SHA512Esp32();
+
+    size_t hashSize() const;
+    size_t blockSize() const;
+
+    void reset();
+    void update(const void *data, size_t len);
+    void finalize(void *hash, size_t len);
+
+    void clear();
+
+    void resetHMAC(const void *key, size_t keyLen);
+    void finalizeHMAC(const void *key, size_t keyLen, void *hash, size_t hashLen);
+
+    static const size_t HASH_SIZE  = 64;
+    static const size_t BLOCK_SIZE = 128;
+
+private:
+    mbedtls_sha512_context ctx;
+
+    SHA512Esp32(const SHA512Esp32 &);
+    SHA512Esp32 &operator=(const SHA512Esp32 &);
+};
+
+#endif // CRYPTO_SHA_ESP32
+
+#endif
@@ -260,6 +260,79 @@ void XTSCommon::decryptSector(uint8_t *output, const uint8_t *input)
     }
 }
 
+/**
+ * \brief Encrypts a run of consecutive sectors.
+ *
+ * \param output The output buffer to write the ciphertext to, which can
+ * be the same as \a input.
+ * \param input The input buffer to read the plaintext from.
+ * \param sector The number of the first sector.
+ * \param count The number of sectors to encrypt.
+ *
+ * The \a input and \a output buffers must be at least \a count times
+ * sectorSize() bytes in length.  The tweak of each sector is its number
+ * as a 128-bit little-endian value, the usual IEEE 1619 data unit
+ * numbering, so this gives the same result as calling setTweak() with the
+ * little-endian sector number and encryptSector() for every sector in turn.
+ * The tweak of the last sector is left set afterwards.
+ *
+ * \sa decryptSectors(), encryptSector()
+ */
+void XTSCommon::encryptSectors(uint8_t *output, const uint8_t *input,
+                               uint64_t sector, size_t count)
+{
+    while (count > 0) {
+        setSectorNumber(sector++);
+        encryptSector(output, input);
+        input += sectSize;
+        output += sectSize;
+        --count;
+    }
+}
+
+/**
+ * \brief Decrypts a run of consecutive sectors.
+ *
+ * \param output The output buffer to write the plaintext to, which can
+ * be the same as \a input.
+ * \param input The input buffer to read the ciphertext from.
+ * \param sector The number of the first sector.
+ * \param count The number of sectors to decrypt.
+ *
+ * The \a input and \a output buffers must be at least \a count times
+ * sectorSize() bytes in length.  Sector tweaks are numbered as for
+ * encryptSectors().
+ *
+ * \sa encryptSectors(), decryptSector()
+ */
+void XTSCommon::decryptSectors(uint8_t *output, const uint8_t *input,
+                               uint64_t sector, size_t count)
+{
+    while (count > 0) {
+        setSectorNumber(sector++);
+        decryptSector(output, input);
+        input += sectSize;
+        output += sectSize;
+        --count;
+    }
+}
+
+/**
+ * \brief Sets the tweak from a sector number, without going through bytes.
+ *
+ * \param sector The sector number, encoded as a 128-bit little-endian value.
+ */
+void XTSCommon::setSectorNumber(uint64_t sector)
+{
+    uint8_t *t = (uint8_t *)twk;
+    for (uint8_t posn = 0; posn < 8; ++posn) {
+        t[posn] = (uint8_t)sector;
+        sector >>= 8;
+    }
+    memset(t + 8, 0, 8);
+    blockCipher2->encryptBlock(t, t);
+}
+
 /**
  * \brief Clears all security-sensitive state from this XTS object.
  */
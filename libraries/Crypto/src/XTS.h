@@ -44,6 +44,11 @@ public:
     void encryptSector(uint8_t *output, const uint8_t *input);
     void decryptSector(uint8_t *output, const uint8_t *input);
 
+    void encryptSectors(uint8_t *output, const uint8_t *input,
+                        uint64_t sector, size_t count);
+    void decryptSectors(uint8_t *output, const uint8_t *input,
+                        uint64_t sector, size_t count);
+
     void clear();
 
 protected:
@@ -55,6 +60,8 @@ protected:
     }
 
 private:
+    void setSectorNumber(uint64_t sector);
+
     BlockCipher *blockCipher1;
     BlockCipher *blockCipher2;
     uint32_t twk[4];
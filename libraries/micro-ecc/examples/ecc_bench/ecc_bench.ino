@@ -0,0 +1,104 @@
+// Times secp256r1 key generation, ECDH, signing and verification, and checks the results, to
+// compare the multiply/square kernels selected at build time.
+//
+// On an ARMv7E-M board (Cortex-M4/M7, e.g. the Arduino Uno R4 and its RA4M1) the default build
+// uses the portable C path. To measure the opt-in UMAAL profile on the same board rebuild with
+//   -DuECC_ARM_V7EM=1
+// (for instance through compiler.c.extra_flags in platform.local.txt) and compare the timings.
+
+#include <uECC.h>
+#include <uECC_vli.h>
+
+#define BENCH_ROUNDS 8
+
+extern "C" {
+
+// Benchmark only: a xorshift generator is NOT suitable for real keys.
+static uint32_t rng_state = 0x2545F491;
+
+static int RNG(uint8_t *dest, unsigned size) {
+  while (size) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    *dest = (uint8_t)rng_state;
+    ++dest;
+    --size;
+  }
+  return 1;
+}
+
+}  // extern "C"
+
+static void printProfile() {
+  Serial.print("uECC_OPTIMIZATION_LEVEL = "); Serial.println(uECC_OPTIMIZATION_LEVEL);
+  Serial.print("uECC_SQUARE_FUNC = "); Serial.println(uECC_SQUARE_FUNC);
+  Serial.print("uECC_ARM_V7EM = "); Serial.println(uECC_ARM_V7EM);
+  Serial.print("uECC_ARM_USE_UMAAL = "); Serial.println(uECC_ARM_USE_UMAAL);
+}
+
+static void printTime(const char *label, unsigned long total) {
+  Serial.print(label);
+  Serial.print(total / BENCH_ROUNDS);
+  Serial.println(" us");
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+  }
+  Serial.print("Benchmarking secp256r1\n");
+  printProfile();
+  uECC_set_rng(&RNG);
+}
+
+void loop() {
+  const struct uECC_Curve_t * curve = uECC_secp256r1();
+  uint8_t private1[32];
+  uint8_t private2[32];
+  uint8_t public1[64];
+  uint8_t public2[64];
+  uint8_t secret1[32];
+  uint8_t secret2[32];
+  uint8_t hash[32];
+  uint8_t signature[64];
+  unsigned long keyTime = 0;
+  unsigned long ecdhTime = 0;
+  unsigned long signTime = 0;
+  unsigned long verifyTime = 0;
+  unsigned long a;
+  int ok = 1;
+
+  for (unsigned i = 0; i < BENCH_ROUNDS; ++i) {
+    a = micros();
+    ok &= uECC_make_key(public1, private1, curve);
+    keyTime += micros() - a;
+    ok &= uECC_make_key(public2, private2, curve);
+
+    a = micros();
+    ok &= uECC_shared_secret(public2, private1, secret1, curve);
+    ecdhTime += micros() - a;
+    ok &= uECC_shared_secret(public1, private2, secret2, curve);
+    ok &= (memcmp(secret1, secret2, sizeof(secret1)) == 0);
+
+    RNG(hash, sizeof(hash));
+    a = micros();
+    ok &= uECC_sign(private1, hash, sizeof(hash), signature, curve);
+    signTime += micros() - a;
+
+    a = micros();
+    ok &= uECC_verify(public1, hash, sizeof(hash), signature, curve);
+    verifyTime += micros() - a;
+  }
+
+  printTime("make_key: ", keyTime);
+  printTime("shared_secret: ", ecdhTime);
+  printTime("sign: ", signTime);
+  printTime("verify: ", verifyTime);
+  if (ok) {
+    Serial.print("All results are correct\n");
+  } else {
+    Serial.print("Results are WRONG!\n");
+  }
+  delay(5000);
+}
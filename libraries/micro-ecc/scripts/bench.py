@@ -0,0 +1,37 @@
+#!/usr/bin/env python
+
+# Builds test/bench.c once per uECC_OPTIMIZATION_LEVEL / uECC_SQUARE_FUNC setting with the host
+# compiler, runs each build and prints the CSV lines of all of them. Extra arguments are passed
+# to the compiler, eg "-DuECC_P256_ONLY=1 -DuECC_SUPPORTS_secp160r1=0 ..." to time the P-256
+# build or "-DuECC_WORD_SIZE=4" to time 32-bit words. CC overrides the compiler (default cc).
+
+import os
+import subprocess
+import sys
+import tempfile
+
+levels = [0, 1, 2, 3]
+square_funcs = [0, 1]
+
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+compiler = os.environ.get("CC", "cc")
+extra_flags = sys.argv[1:]
+
+build_dir = tempfile.mkdtemp()
+exe = os.path.join(build_dir, "bench")
+header = True
+for level in levels:
+    for square in square_funcs:
+        command = [compiler, "-std=c99", "-O2", "-I" + root,
+                   "-DuECC_OPTIMIZATION_LEVEL=%d" % (level), "-DuECC_SQUARE_FUNC=%d" % (square)]
+        command += extra_flags
+        command += [os.path.join(root, "test", "bench.c"), os.path.join(root, "uECC.c"), "-o", exe]
+        subprocess.check_call(command)
+        output = subprocess.check_output([exe]).decode()
+        for line in output.splitlines():
+            if header or not line.startswith("#"):
+                print(line)
+        header = False
+        sys.stdout.flush()
+os.remove(exe)
+os.rmdir(build_dir)
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+
+# Generates generator-table.inc, the comb table of secp256r1 generator multiples
+# used by EccPoint_compute_public_key() when uECC_GENERATOR_TABLE is enabled.
+#
+# For the comb with w teeth spaced d bits apart, entry i is
+#     T[i] = G + i_0 * 2^d * G + i_1 * 2^(2d) * G + ... + i_(w-2) * 2^((w-1)d) * G
+# where i_0 .. i_(w-2) are the bits of i. Only odd comb values are needed since
+# the scalar is recoded to odd signed digits.
+
+import sys
+
+p = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+a = p - 3
+b = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+Gx = 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296
+Gy = 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5
+
+teeth = 5
+if len(sys.argv) > 1:
+    teeth = int(sys.argv[1])
+spacing = (256 + teeth - 1) // teeth
+
+def inverse(x):
+    return pow(x, p - 2, p)
+
+def add(P, Q):
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0]:
+        if (P[1] + Q[1]) % p == 0:
+            return None
+        l = (3 * P[0] * P[0] + a) * inverse(2 * P[1]) % p
+    else:
+        l = (Q[1] - P[1]) * inverse(Q[0] - P[0]) % p
+    x = (l * l - P[0] - Q[0]) % p
+    return (x, (l * (P[0] - x) - P[1]) % p)
+
+def mult(k, P):
+    R = None
+    while k:
+        if k & 1:
+            R = add(R, P)
+        P = add(P, P)
+        k >>= 1
+    return R
+
+def words(value):
+    # Little-endian bytes, 8 per BYTES_TO_WORDS_8 group
+    digits = ["%02X" % ((value >> (8 * i)) & 0xFF) for i in range(32)]
+    return ["BYTES_TO_WORDS_8(%s)" % (", ".join(digits[i:i + 8])) for i in range(0, 32, 8)]
+
+G = (Gx, Gy)
+assert (Gy * Gy - (Gx * Gx * Gx + a * Gx + b)) % p == 0
+teeth_points = [mult(1 << (spacing * (j + 1)), G) for j in range(teeth - 1)]
+
+print("/* Copyright 2026, Cryptnox. Licensed under the BSD 2-clause license. */")
+print("")
+print("/* Generated by scripts/generator_table.py, do not edit. */")
+print("")
+print("#ifndef _UECC_GENERATOR_TABLE_H_")
+print("#define _UECC_GENERATOR_TABLE_H_")
+print("")
+print("#define uECC_COMB_TEETH %d" % (teeth))
+print("#define uECC_COMB_SPACING %d" % (spacing))
+print("#define uECC_COMB_POINTS %d" % (1 << (teeth - 1)))
+print("")
+print("/* T[i] = G + sum(i_j * 2^((j + 1) * uECC_COMB_SPACING) * G) */")
+print("static const uECC_word_t secp256r1_comb_table[uECC_COMB_POINTS][num_words_secp256r1 * 2] = {")
+for i in range(1 << (teeth - 1)):
+    P = G
+    for j in range(teeth - 1):
+        if (i >> j) & 1:
+            P = add(P, teeth_points[j])
+    lines = words(P[0]) + [""] + words(P[1])
+    print("    { " + lines[0] + ",")
+    for line in lines[1:-1]:
+        print(("        " + line + ",") if line else "")
+    print("        " + lines[-1] + " }" + ("," if i + 1 < (1 << (teeth - 1)) else ""))
+print("};")
+print("")
+print("#endif /* _UECC_GENERATOR_TABLE_H_ */")
@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+
+# Generates mult-square-unrolled.inc, the fully unrolled product-scanning
+# multiply and square used by the portable C code when uECC_P256_ONLY fixes
+# the integer width. Pass the word counts to generate, eg "4 8".
+
+import sys
+
+if len(sys.argv) < 2:
+    print("Provide the integer sizes in words")
+    sys.exit(1)
+
+sizes = [int(arg) for arg in sys.argv[1:]]
+
+def emit_macro(name, lines):
+    width = max(len(line) for line in lines) + 5
+    print(("#define " + name).ljust(width) + "\\")
+    for line in lines[:-1]:
+        print(("    " + line).ljust(width) + "\\")
+    print("    " + lines[-1])
+    print("")
+
+def column(k):
+    return "result[%d] = r0; r0 = r1; r1 = r2; r2 = 0;" % (k)
+
+def mult_lines(size):
+    lines = []
+    for k in range(size * 2 - 1):
+        for i in range(max(0, k - size + 1), min(k, size - 1) + 1):
+            lines.append("muladd(left[%d], right[%d], &r0, &r1, &r2);" % (i, k - i))
+        lines.append(column(k))
+    lines.append("result[%d] = r0;" % (size * 2 - 1))
+    return lines
+
+def square_lines(size):
+    lines = []
+    for k in range(size * 2 - 1):
+        for i in range(max(0, k - size + 1), k // 2 + 1):
+            if i < k - i:
+                lines.append("mul2add(left[%d], left[%d], &r0, &r1, &r2);" % (i, k - i))
+            else:
+                lines.append("muladd(left[%d], left[%d], &r0, &r1, &r2);" % (i, i))
+        lines.append(column(k))
+    lines.append("result[%d] = r0;" % (size * 2 - 1))
+    return lines
+
+print("/* Copyright 2026, Cryptnox. Licensed under the BSD 2-clause license. */")
+print("")
+print("/* Generated by scripts/mult_unrolled.py, do not edit. */")
+print("")
+print("#ifndef _UECC_MULT_SQUARE_UNROLLED_H_")
+print("#define _UECC_MULT_SQUARE_UNROLLED_H_")
+print("")
+for size in sizes:
+    emit_macro("FAST_MULT_C_%d" % (size), mult_lines(size))
+    emit_macro("FAST_SQUARE_C_%d" % (size), square_lines(size))
+print("#endif /* _UECC_MULT_SQUARE_UNROLLED_H_ */")
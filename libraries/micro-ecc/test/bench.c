@@ -0,0 +1,174 @@
+/* Copyright 2026, Cryptnox. Licensed under the BSD 2-clause license. */
+
+/* Host benchmark of the public API, one CSV line per curve and operation:
+
+    BENCH,<curve>,<operation>,<opt_level>,<square_func>,<samples>,<min_ns>,<mean_ns>,<max_ns>
+
+The build options are fixed at compile time, so compare settings by building this file once per
+setting; scripts/bench.py does that and prints all the lines together. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "uECC.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef uECC_BENCH_ITERATIONS
+#define uECC_BENCH_ITERATIONS   64
+#endif
+
+typedef struct {
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long total;
+    unsigned count;
+} Timing;
+
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+static void timing_add(Timing *timing, unsigned long long start) {
+    unsigned long long elapsed = now_ns() - start;
+    if (timing->count == 0 || elapsed < timing->min) {
+        timing->min = elapsed;
+    }
+    if (elapsed > timing->max) {
+        timing->max = elapsed;
+    }
+    timing->total += elapsed;
+    ++timing->count;
+}
+
+static void report(const char *curve, const char *operation, const Timing *timing) {
+    printf("BENCH,%s,%s,%d,%d,%u,%llu,%llu,%llu\n",
+           curve, operation, uECC_OPTIMIZATION_LEVEL, uECC_SQUARE_FUNC, timing->count,
+           timing->min, timing->count ? timing->total / timing->count : 0, timing->max);
+}
+
+int main() {
+    uint8_t private1[32] = {0};
+    uint8_t private2[32] = {0};
+    uint8_t public1[64] = {0};
+    uint8_t public2[64] = {0};
+    uint8_t secret[32] = {0};
+    uint8_t hash[32] = {0};
+    uint8_t sig[64] = {0};
+    uint8_t compressed[33] = {0};
+    uint8_t decompressed[64] = {0};
+    uECC_PublicKey loaded;
+
+    int i, c;
+    unsigned long long start;
+
+    const struct uECC_Curve_t * curves[5];
+    const char *names[5];
+    int num_curves = 0;
+#if uECC_SUPPORTS_secp160r1
+    names[num_curves] = "secp160r1";
+    curves[num_curves++] = uECC_secp160r1();
+#endif
+#if uECC_SUPPORTS_secp192r1
+    names[num_curves] = "secp192r1";
+    curves[num_curves++] = uECC_secp192r1();
+#endif
+#if uECC_SUPPORTS_secp224r1
+    names[num_curves] = "secp224r1";
+    curves[num_curves++] = uECC_secp224r1();
+#endif
+#if uECC_SUPPORTS_secp256r1
+    names[num_curves] = "secp256r1";
+    curves[num_curves++] = uECC_secp256r1();
+#endif
+#if uECC_SUPPORTS_secp256k1
+    names[num_curves] = "secp256k1";
+    curves[num_curves++] = uECC_secp256k1();
+#endif
+
+    printf("# BENCH,curve,operation,opt_level,square_func,samples,min_ns,mean_ns,max_ns\n");
+    printf("# uECC_P256_ONLY=%d uECC_FERMAT_INVERSE=%d\n", uECC_P256_ONLY, uECC_FERMAT_INVERSE);
+
+    for (c = 0; c < num_curves; ++c) {
+        Timing make_key, shared_secret, sign, verify, verify_loaded, compress, decompress;
+        memset(&make_key, 0, sizeof(Timing));
+        memset(&shared_secret, 0, sizeof(Timing));
+        memset(&sign, 0, sizeof(Timing));
+        memset(&verify, 0, sizeof(Timing));
+        memset(&verify_loaded, 0, sizeof(Timing));
+        memset(&compress, 0, sizeof(Timing));
+        memset(&decompress, 0, sizeof(Timing));
+
+        for (i = 0; i < uECC_BENCH_ITERATIONS; ++i) {
+            start = now_ns();
+            if (!uECC_make_key(public1, private1, curves[c])) {
+                printf("uECC_make_key() failed\n");
+                return 1;
+            }
+            timing_add(&make_key, start);
+            if (!uECC_make_key(public2, private2, curves[c])) {
+                printf("uECC_make_key() failed\n");
+                return 1;
+            }
+
+            start = now_ns();
+            if (!uECC_shared_secret(public2, private1, secret, curves[c])) {
+                printf("uECC_shared_secret() failed\n");
+                return 1;
+            }
+            timing_add(&shared_secret, start);
+
+            memcpy(hash, public2, sizeof(hash));
+            start = now_ns();
+            if (!uECC_sign(private1, hash, sizeof(hash), sig, curves[c])) {
+                printf("uECC_sign() failed\n");
+                return 1;
+            }
+            timing_add(&sign, start);
+
+            start = now_ns();
+            if (!uECC_verify(public1, hash, sizeof(hash), sig, curves[c])) {
+                printf("uECC_verify() failed\n");
+                return 1;
+            }
+            timing_add(&verify, start);
+
+            /* Loading is not timed: it is paid once per key */
+            if (!uECC_public_key_load(&loaded, public1, curves[c])) {
+                printf("uECC_public_key_load() failed\n");
+                return 1;
+            }
+            start = now_ns();
+            if (!uECC_verify_loaded(&loaded, hash, sizeof(hash), sig)) {
+                printf("uECC_verify_loaded() failed\n");
+                return 1;
+            }
+            timing_add(&verify_loaded, start);
+
+            start = now_ns();
+            uECC_compress(public1, compressed, curves[c]);
+            timing_add(&compress, start);
+
+            start = now_ns();
+            uECC_decompress(compressed, decompressed, curves[c]);
+            timing_add(&decompress, start);
+            if (memcmp(public1, decompressed, uECC_curve_public_key_size(curves[c])) != 0) {
+                printf("uECC_decompress() mismatch\n");
+                return 1;
+            }
+        }
+
+        report(names[c], "make_key", &make_key);
+        report(names[c], "shared_secret", &shared_secret);
+        report(names[c], "sign", &sign);
+        report(names[c], "verify", &verify);
+        report(names[c], "verify_loaded", &verify_loaded);
+        report(names[c], "compress", &compress);
+        report(names[c], "decompress", &decompress);
+    }
+
+    return 0;
+}
@@ -19,6 +19,9 @@ int main() {
     uint8_t private[32];
     uint8_t public[64];
     uint8_t public_computed[64];
+    uint8_t batch_private[6][32];
+    uint8_t batch_public[6][64];
+    uECC_Context context;
     
     int c;
     
@@ -75,6 +78,34 @@ int main() {
             printf("uECC_compute_public_key() should have failed\n");
         }
         printf("\n");
+
+        printf("Testing batch of 6 key pairs\n");
+        context.curve = curves[c];
+        context.rng = uECC_get_rng();
+        memset(batch_private, 0, sizeof(batch_private));
+        memset(batch_public, 0, sizeof(batch_public));
+        /* Keys are packed with the curve sizes; copy each one into a 32/64-byte slot */
+        if (!uECC_make_keys_batch(&context, 6, &batch_public[0][0], &batch_private[0][0])) {
+            printf("uECC_make_keys_batch() failed\n");
+            return 1;
+        }
+        for (i = 5; i >= 0; --i) {
+            int private_size = uECC_curve_private_key_size(curves[c]);
+            int public_size = uECC_curve_public_key_size(curves[c]);
+            memmove(batch_private[i], &batch_private[0][0] + i * private_size, private_size);
+            memmove(batch_public[i], &batch_public[0][0] + i * public_size, public_size);
+        }
+        for (i = 0; i < 6; ++i) {
+            memset(public_computed, 0, sizeof(public_computed));
+            if (!uECC_compute_public_key(batch_private[i], public_computed, curves[c]) ||
+                memcmp(batch_public[i], public_computed, uECC_curve_public_key_size(curves[c])) != 0) {
+                printf("Batch public key %d does not match\n", i);
+                vli_print("Computed public key = ", public_computed, sizeof(public_computed));
+                vli_print("Batch public key = ", batch_public[i], sizeof(batch_public[i]));
+                return 1;
+            }
+        }
+        printf("\n");
     }
     
     return 0;
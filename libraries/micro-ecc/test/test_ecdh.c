@@ -11,6 +11,12 @@ void vli_print(uint8_t *vli, unsigned int size) {
     }
 }
 
+static int failing_rng(uint8_t *dest, unsigned size) {
+    (void)dest;
+    (void)size;
+    return 0;
+}
+
 int main() {
     int i, c;
     uint8_t private1[32] = {0};
@@ -19,6 +25,7 @@ int main() {
     uint8_t public2[64] = {0};
     uint8_t secret1[32] = {0};
     uint8_t secret2[32] = {0};
+    uECC_Context context;
     
     const struct uECC_Curve_t * curves[5];
     int num_curves = 0;
@@ -85,6 +92,33 @@ int main() {
         }
         printf("\n");
     }
-    
+
+    printf("Testing context RNG with the global RNG failing\n");
+
+    context.rng = uECC_get_rng();
+    uECC_set_rng(&failing_rng);
+    for (c = 0; c < num_curves; ++c) {
+        context.curve = curves[c];
+        if (!uECC_make_key_ctx(&context, public1, private1) ||
+            !uECC_make_key_ctx(&context, public2, private2)) {
+            printf("uECC_make_key_ctx() failed\n");
+            return 1;
+        }
+        if (!uECC_shared_secret_ctx(&context, public2, private1, secret1) ||
+            !uECC_shared_secret_ctx(&context, public1, private2, secret2)) {
+            printf("uECC_shared_secret_ctx() failed\n");
+            return 1;
+        }
+        if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+            printf("Context shared secrets are not identical!\n");
+            return 1;
+        }
+    }
+    if (uECC_make_key(public1, private1, curves[0])) {
+        printf("uECC_make_key() ignored the global RNG\n");
+        return 1;
+    }
+    uECC_set_rng(context.rng);
+
     return 0;
 }
@@ -11,6 +11,9 @@ int main() {
     uint8_t public[64] = {0};
     uint8_t hash[32] = {0};
     uint8_t sig[64] = {0};
+    uint8_t hashes[4][32];
+    uint8_t sigs[4][64];
+    unsigned bad;
 
     const struct uECC_Curve_t * curves[5];
     int num_curves = 0;
@@ -54,6 +57,36 @@ int main() {
         }
         printf("\n");
     }
-    
+
+    printf("Testing batch verification\n");
+    for (c = 0; c < num_curves; ++c) {
+        if (!uECC_make_key(public, private, curves[c])) {
+            printf("uECC_make_key() failed\n");
+            return 1;
+        }
+        for (i = 0; i < 4; ++i) {
+            memcpy(hashes[i], public, sizeof(hashes[i]));
+            hashes[i][0] ^= (uint8_t)i;
+            if (!uECC_sign(private, hashes[i], sizeof(hashes[i]), sigs[i], curves[c])) {
+                printf("uECC_sign() failed\n");
+                return 1;
+            }
+            /* Signatures are packed at twice the curve size */
+            memmove((uint8_t *)sigs + i * uECC_curve_public_key_size(curves[c]),
+                    sigs[i], uECC_curve_public_key_size(curves[c]));
+        }
+        if (!uECC_verify_batch(public, 4, &hashes[0][0], 32, &sigs[0][0], &bad, curves[c])) {
+            printf("uECC_verify_batch() failed\n");
+            return 1;
+        }
+        ((uint8_t *)sigs)[2 * uECC_curve_public_key_size(curves[c]) + 1] ^= 0x01;
+        bad = 0;
+        if (uECC_verify_batch(public, 4, &hashes[0][0], 32, &sigs[0][0], &bad, curves[c]) ||
+                bad != 2) {
+            printf("uECC_verify_batch() did not locate the bad signature\n");
+            return 1;
+        }
+    }
+
     return 0;
 }
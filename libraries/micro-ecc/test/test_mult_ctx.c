@@ -0,0 +1,127 @@
+/* Copyright 2026, Cryptnox. Licensed under the BSD 2-clause license. */
+
+#include "uECC.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void vli_print(char *str, uint8_t *vli, unsigned int size) {
+    printf("%s ", str);
+    for(unsigned i=0; i<size; ++i) {
+        printf("%02X ", (unsigned)vli[i]);
+    }
+    printf("\n");
+}
+
+/* Run the ladder to completion in slices of 'slice' bits. */
+static void run_sliced(uECC_mult_ctx *ctx, unsigned slice) {
+    while (!uECC_mult_step(ctx, slice)) {
+    }
+}
+
+int main() {
+    int i, c;
+    uint8_t private1[32] = {0};
+    uint8_t private2[32] = {0};
+    uint8_t public1[64] = {0};
+    uint8_t public2[64] = {0};
+    uint8_t public_computed[64] = {0};
+    uint8_t secret1[32] = {0};
+    uint8_t secret2[32] = {0};
+    uECC_mult_ctx ctx;
+    uECC_Context context;
+
+    const struct uECC_Curve_t * curves[5];
+    int num_curves = 0;
+#if uECC_SUPPORTS_secp160r1
+    curves[num_curves++] = uECC_secp160r1();
+#endif
+#if uECC_SUPPORTS_secp192r1
+    curves[num_curves++] = uECC_secp192r1();
+#endif
+#if uECC_SUPPORTS_secp224r1
+    curves[num_curves++] = uECC_secp224r1();
+#endif
+#if uECC_SUPPORTS_secp256r1
+    curves[num_curves++] = uECC_secp256r1();
+#endif
+#if uECC_SUPPORTS_secp256k1
+    curves[num_curves++] = uECC_secp256k1();
+#endif
+
+    printf("Testing 64 sliced key pairs and shared secrets\n");
+
+    context.rng = uECC_get_rng();
+    for (c = 0; c < num_curves; ++c) {
+        context.curve = curves[c];
+        for (i = 0; i < 64; ++i) {
+            unsigned slice = 1 + i % 37;
+
+            printf(".");
+            fflush(stdout);
+
+            if (!uECC_make_key_start(&ctx, &context)) {
+                printf("uECC_make_key_start() failed\n");
+                return 1;
+            }
+            run_sliced(&ctx, slice);
+            if (!uECC_make_key_finish(&ctx, public1, private1)) {
+                printf("uECC_make_key_finish() failed\n");
+                return 1;
+            }
+
+            if (!uECC_compute_public_key(private1, public_computed, curves[c])) {
+                printf("uECC_compute_public_key() failed\n");
+                return 1;
+            }
+            if (memcmp(public1, public_computed, uECC_curve_public_key_size(curves[c])) != 0) {
+                printf("Sliced public key does not match\n");
+                vli_print("Private key =", private1, uECC_curve_private_key_size(curves[c]));
+                vli_print("Sliced public key =", public1, uECC_curve_public_key_size(curves[c]));
+                vli_print("Computed public key =", public_computed, uECC_curve_public_key_size(curves[c]));
+                return 1;
+            }
+
+            if (!uECC_make_key(public2, private2, curves[c])) {
+                printf("uECC_make_key() failed\n");
+                return 1;
+            }
+
+            if (!uECC_shared_secret_start(&ctx, &context, public2, private1)) {
+                printf("uECC_shared_secret_start() failed\n");
+                return 1;
+            }
+            run_sliced(&ctx, slice);
+            if (!uECC_shared_secret_finish(&ctx, secret1)) {
+                printf("uECC_shared_secret_finish() failed\n");
+                return 1;
+            }
+
+            if (!uECC_shared_secret(public1, private2, secret2, curves[c])) {
+                printf("uECC_shared_secret() failed\n");
+                return 1;
+            }
+
+            if (memcmp(secret1, secret2, uECC_curve_public_key_size(curves[c]) / 2) != 0) {
+                printf("Sliced shared secret does not match\n");
+                vli_print("Sliced secret =", secret1, sizeof(secret1));
+                vli_print("Secret =", secret2, sizeof(secret2));
+                return 1;
+            }
+        }
+        printf("\n");
+    }
+
+    /* A context that was not completed must not produce output */
+    if (!uECC_shared_secret_start(&ctx, &context, public2, private1)) {
+        printf("uECC_shared_secret_start() failed\n");
+        return 1;
+    }
+    uECC_mult_step(&ctx, 8);
+    if (uECC_shared_secret_finish(&ctx, secret1)) {
+        printf("uECC_shared_secret_finish() accepted an incomplete context\n");
+        return 1;
+    }
+
+    return 0;
+}
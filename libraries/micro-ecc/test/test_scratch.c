@@ -0,0 +1,100 @@
+/* Copyright 2026, Cryptnox. Licensed under the BSD 2-clause license. */
+
+#include "uECC.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if uECC_LOW_STACK
+
+int main() {
+    int i, c;
+    uint8_t private1[32] = {0};
+    uint8_t private2[32] = {0};
+    uint8_t public1[64] = {0};
+    uint8_t public2[64] = {0};
+    uint8_t secret1[32] = {0};
+    uint8_t secret2[32] = {0};
+    uint8_t hash[32] = {0};
+    uint8_t sig[64] = {0};
+    /* One extra byte so that the arena can start unaligned */
+    uint8_t scratch[uECC_SCRATCH_SIZE + 1];
+
+    const struct uECC_Curve_t * curves[5];
+    int num_curves = 0;
+#if uECC_SUPPORTS_secp160r1
+    curves[num_curves++] = uECC_secp160r1();
+#endif
+#if uECC_SUPPORTS_secp192r1
+    curves[num_curves++] = uECC_secp192r1();
+#endif
+#if uECC_SUPPORTS_secp224r1
+    curves[num_curves++] = uECC_secp224r1();
+#endif
+#if uECC_SUPPORTS_secp256r1
+    curves[num_curves++] = uECC_secp256r1();
+#endif
+#if uECC_SUPPORTS_secp256k1
+    curves[num_curves++] = uECC_secp256k1();
+#endif
+
+    printf("Testing 32 key pairs, shared secrets and signatures with a scratch arena\n");
+    for (c = 0; c < num_curves; ++c) {
+        for (i = 0; i < 32; ++i) {
+            printf(".");
+            fflush(stdout);
+
+            uECC_set_scratch(scratch + (i & 1), uECC_SCRATCH_SIZE);
+            if (!uECC_make_key(public1, private1, curves[c]) ||
+                !uECC_make_key(public2, private2, curves[c])) {
+                printf("uECC_make_key() failed\n");
+                return 1;
+            }
+            if (!uECC_shared_secret(public2, private1, secret1, curves[c]) ||
+                !uECC_shared_secret(public1, private2, secret2, curves[c])) {
+                printf("uECC_shared_secret() failed\n");
+                return 1;
+            }
+            if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+                printf("Shared secrets are not identical!\n");
+                return 1;
+            }
+
+            memcpy(hash, public1, sizeof(hash));
+            if (!uECC_sign(private1, hash, sizeof(hash), sig, curves[c])) {
+                printf("uECC_sign() failed\n");
+                return 1;
+            }
+            if (!uECC_verify(public1, hash, sizeof(hash), sig, curves[c])) {
+                printf("uECC_verify() failed\n");
+                return 1;
+            }
+        }
+        printf("\n");
+
+        /* Without an arena, or with one too small, operations fail cleanly */
+        uECC_set_scratch(0, 0);
+        if (uECC_make_key(public1, private1, curves[c]) ||
+            uECC_shared_secret(public2, private1, secret1, curves[c]) ||
+            uECC_verify(public1, hash, sizeof(hash), sig, curves[c])) {
+            printf("Operation succeeded without a scratch arena\n");
+            return 1;
+        }
+        uECC_set_scratch(scratch, 16);
+        if (uECC_verify(public1, hash, sizeof(hash), sig, curves[c])) {
+            printf("uECC_verify() succeeded with a too small arena\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#else
+
+int main() {
+    printf("uECC_LOW_STACK is disabled, nothing to test\n");
+    return 0;
+}
+
+#endif /* uECC_LOW_STACK */
@@ -24,7 +24,9 @@
 #endif
 
 #ifndef uECC_ARM_USE_UMAAL
-    #if (uECC_PLATFORM == uECC_arm) && (__ARM_ARCH >= 6)
+    #if (uECC_PLATFORM == uECC_arm_thumb2) && uECC_ARM_V7EM
+        #define uECC_ARM_USE_UMAAL 1
+    #elif (uECC_PLATFORM == uECC_arm) && (__ARM_ARCH >= 6)
         #define uECC_ARM_USE_UMAAL 1
     #elif (uECC_PLATFORM == uECC_arm_thumb2) && (__ARM_ARCH >= 6) && !__ARM_ARCH_7M__
         #define uECC_ARM_USE_UMAAL 1
@@ -33,6 +35,11 @@
     #endif
 #endif
 
+/* UMAAL is part of the ARMv7E-M DSP extension; plain ARMv7-M (Cortex-M3) does not have it. */
+#if uECC_ARM_USE_UMAAL && (uECC_PLATFORM == uECC_arm_thumb2) && defined(__ARM_ARCH_7M__)
+    #error "uECC_ARM_USE_UMAAL requires ARMv7E-M or later on Thumb-2"
+#endif
+
 #ifndef uECC_WORD_SIZE
     #if uECC_PLATFORM == uECC_avr
         #define uECC_WORD_SIZE 1
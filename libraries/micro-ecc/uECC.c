@@ -136,6 +136,24 @@
 #define BITS_TO_WORDS(num_bits) ((num_bits + ((uECC_WORD_SIZE * 8) - 1)) / (uECC_WORD_SIZE * 8))
 #define BITS_TO_BYTES(num_bits) ((num_bits + 7) / 8)
 
+#if uECC_P256_ONLY
+    /* Field elements and scalars all have the secp256r1 width, so the word count passed to the
+       portable arithmetic is replaced by a constant the compiler can specialize on. */
+    #define uECC_FIXED_WORDS(num_words) ((void)(num_words), (wordcount_t)uECC_MAX_WORDS)
+    #define uECC_UNROLLED (uECC_WORD_SIZE != 1)
+#else
+    #define uECC_FIXED_WORDS(num_words) (num_words)
+    #define uECC_UNROLLED 0
+#endif
+
+#if uECC_UNROLLED
+    #include "mult-square-unrolled.inc"
+#endif
+
+#if uECC_P256_ONLY && (uECC_OPTIMIZATION_LEVEL > 0)
+static void vli_mmod_fast_secp256r1(uECC_word_t *result, uECC_word_t *product);
+#endif
+
 struct uECC_Curve_t {
     wordcount_t num_words;
     wordcount_t num_bytes;
@@ -195,6 +213,67 @@ uECC_RNG_Function uECC_get_rng(void) {
     return g_rng_function;
 }
 
+/* Words of the large temporaries, taken from the scratch arena with uECC_LOW_STACK */
+#define uECC_LADDER_WORDS (4 * uECC_MAX_WORDS)
+#define uECC_SHARED_SECRET_WORDS (4 * uECC_MAX_WORDS)
+#define uECC_VERIFY_WORDS (14 * uECC_MAX_WORDS)
+
+#if uECC_LOW_STACK
+static uECC_word_t *g_scratch_top = 0;
+static uECC_word_t *g_scratch_end = 0;
+
+void uECC_set_scratch(void *scratch, unsigned size) {
+    uintptr_t start = ((uintptr_t)scratch + (uECC_WORD_SIZE - 1)) & ~(uintptr_t)(uECC_WORD_SIZE - 1);
+    uintptr_t end = ((uintptr_t)scratch + size) & ~(uintptr_t)(uECC_WORD_SIZE - 1);
+
+    if (!scratch || end <= start) {
+        g_scratch_top = 0;
+        g_scratch_end = 0;
+    } else {
+        g_scratch_top = (uECC_word_t *)start;
+        g_scratch_end = (uECC_word_t *)end;
+    }
+}
+
+/* Returns nonzero if num_words words are free in the scratch arena. */
+static int scratch_room(unsigned num_words) {
+    return g_scratch_top && (unsigned)(g_scratch_end - g_scratch_top) >= num_words;
+}
+
+/* Takes num_words words from the arena; callers check scratch_room() first. */
+static uECC_word_t *scratch_alloc(unsigned num_words) {
+    uECC_word_t *block = g_scratch_top;
+    g_scratch_top += num_words;
+    return block;
+}
+
+static void scratch_free(unsigned num_words) {
+    g_scratch_top -= num_words;
+}
+
+/* Does not compile if uECC_SCRATCH_SIZE is too small for uECC_verify() on the enabled curves. */
+typedef char uECC_scratch_size_check[
+    (uECC_VERIFY_WORDS * uECC_WORD_SIZE + uECC_WORD_SIZE <= uECC_SCRATCH_SIZE) ? 1 : -1];
+
+    #define uECC_TEMP(name, num_words) uECC_word_t *name = scratch_alloc(num_words)
+    #define uECC_TEMP_FREE(num_words) scratch_free(num_words)
+    #define uECC_TEMP_ROOM(num_words) scratch_room(num_words)
+    /* Ladder registers R0 and R1 */
+    #define uECC_LADDER(Rx, Ry)                                                 \
+        uECC_word_t (*Rx)[uECC_MAX_WORDS] =                                     \
+            (uECC_word_t (*)[uECC_MAX_WORDS])scratch_alloc(uECC_LADDER_WORDS);  \
+        uECC_word_t (*Ry)[uECC_MAX_WORDS] = Rx + 2
+    #define uECC_LADDER_FREE() scratch_free(uECC_LADDER_WORDS)
+#else
+    #define uECC_TEMP(name, num_words) uECC_word_t name[num_words]
+    #define uECC_TEMP_FREE(num_words)
+    #define uECC_TEMP_ROOM(num_words) 1
+    #define uECC_LADDER(Rx, Ry)                 \
+        uECC_word_t Rx[2][uECC_MAX_WORDS];      \
+        uECC_word_t Ry[2][uECC_MAX_WORDS]
+    #define uECC_LADDER_FREE()
+#endif /* uECC_LOW_STACK */
+
 int uECC_curve_private_key_size(uECC_Curve curve) {
     return BITS_TO_BYTES(curve->num_n_bits);
 }
@@ -272,7 +351,7 @@ static cmpresult_t uECC_vli_cmp_unsafe(const uECC_word_t *left,
                                        const uECC_word_t *right,
                                        wordcount_t num_words) {
     wordcount_t i;
-    for (i = num_words - 1; i >= 0; --i) {
+    for (i = uECC_FIXED_WORDS(num_words) - 1; i >= 0; --i) {
         if (left[i] > right[i]) {
             return 1;
         } else if (left[i] < right[i]) {
@@ -333,7 +412,7 @@ uECC_VLI_API uECC_word_t uECC_vli_add(uECC_word_t *result,
                                       wordcount_t num_words) {
     uECC_word_t carry = 0;
     wordcount_t i;
-    for (i = 0; i < num_words; ++i) {
+    for (i = 0; i < uECC_FIXED_WORDS(num_words); ++i) {
         uECC_word_t sum = left[i] + right[i] + carry;
         if (sum != left[i]) {
             carry = (sum < left[i]);
@@ -352,7 +431,7 @@ uECC_VLI_API uECC_word_t uECC_vli_sub(uECC_word_t *result,
                                       wordcount_t num_words) {
     uECC_word_t borrow = 0;
     wordcount_t i;
-    for (i = 0; i < num_words; ++i) {
+    for (i = 0; i < uECC_FIXED_WORDS(num_words); ++i) {
         uECC_word_t diff = left[i] - right[i] - borrow;
         if (diff != left[i]) {
             borrow = (diff > left[i]);
@@ -415,6 +494,10 @@ uECC_VLI_API void uECC_vli_mult(uECC_word_t *result,
     uECC_word_t r0 = 0;
     uECC_word_t r1 = 0;
     uECC_word_t r2 = 0;
+#if uECC_UNROLLED
+    (void)num_words;
+    CONCAT(FAST_MULT_C_, uECC_MAX_WORDS)
+#else
     wordcount_t i, k;
 
     /* Compute each digit of result in sequence, maintaining the carries. */
@@ -437,6 +520,7 @@ uECC_VLI_API void uECC_vli_mult(uECC_word_t *result,
         r2 = 0;
     }
     result[num_words * 2 - 1] = r0;
+#endif /* uECC_UNROLLED */
 }
 #endif /* !asm_mult */
 
@@ -496,7 +580,10 @@ uECC_VLI_API void uECC_vli_square(uECC_word_t *result,
     uECC_word_t r0 = 0;
     uECC_word_t r1 = 0;
     uECC_word_t r2 = 0;
-
+#if uECC_UNROLLED
+    (void)num_words;
+    CONCAT(FAST_SQUARE_C_, uECC_MAX_WORDS)
+#else
     wordcount_t i, k;
 
     for (k = 0; k < num_words * 2 - 1; ++k) {
@@ -515,6 +602,7 @@ uECC_VLI_API void uECC_vli_square(uECC_word_t *result,
     }
 
     result[num_words * 2 - 1] = r0;
+#endif /* uECC_UNROLLED */
 }
 #endif /* !asm_square */
 
@@ -620,7 +708,9 @@ uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
                                         uECC_Curve curve) {
     uECC_word_t product[2 * uECC_MAX_WORDS];
     uECC_vli_mult(product, left, right, curve->num_words);
-#if (uECC_OPTIMIZATION_LEVEL > 0)
+#if uECC_P256_ONLY && (uECC_OPTIMIZATION_LEVEL > 0)
+    vli_mmod_fast_secp256r1(result, product);
+#elif (uECC_OPTIMIZATION_LEVEL > 0)
     curve->mmod_fast(result, product);
 #else
     uECC_vli_mmod(result, product, curve->p, curve->num_words);
@@ -646,7 +736,9 @@ uECC_VLI_API void uECC_vli_modSquare_fast(uECC_word_t *result,
                                           uECC_Curve curve) {
     uECC_word_t product[2 * uECC_MAX_WORDS];
     uECC_vli_square(product, left, curve->num_words);
-#if (uECC_OPTIMIZATION_LEVEL > 0)
+#if uECC_P256_ONLY && (uECC_OPTIMIZATION_LEVEL > 0)
+    vli_mmod_fast_secp256r1(result, product);
+#elif (uECC_OPTIMIZATION_LEVEL > 0)
     curve->mmod_fast(result, product);
 #else
     uECC_vli_mmod(result, product, curve->p, curve->num_words);
@@ -737,6 +829,17 @@ uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
 
 #include "curve-specific.inc"
 
+/* Computes result = (1 / input) % curve->p. */
+static void vli_modInv_p(uECC_word_t *result, const uECC_word_t *input, uECC_Curve curve) {
+#if uECC_FERMAT_INVERSE && uECC_SUPPORTS_secp256r1 && (uECC_OPTIMIZATION_LEVEL > 0)
+    if (curve == &curve_secp256r1) {
+        vli_modInv_secp256r1(result, input);
+        return;
+    }
+#endif
+    uECC_vli_modInv(result, input, curve->p, curve->num_words);
+}
+
 /* Returns 1 if 'point' is the point at infinity, 0 otherwise. */
 #define EccPoint_isZero(point, curve) uECC_vli_isZero((point), (curve)->num_words * 2)
 
@@ -812,6 +915,27 @@ static void XYcZ_add(uECC_word_t * X1,
     uECC_vli_set(X2, t5, num_words);
 }
 
+/* Same as XYcZ_add() for the last step of an ECDH ladder: only x1' and x3 are computed,
+   Y1 and Y2 are left undefined. */
+static void XYcZ_add_x(uECC_word_t * X1,
+                       uECC_word_t * Y1,
+                       uECC_word_t * X2,
+                       uECC_word_t * Y2,
+                       uECC_Curve curve) {
+    uECC_word_t t5[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    uECC_vli_modSub(t5, X2, X1, curve->p, num_words); /* t5 = x2 - x1 */
+    uECC_vli_modSquare_fast(t5, t5, curve);                  /* t5 = (x2 - x1)^2 = A */
+    uECC_vli_modMult_fast(X1, X1, t5, curve);                /* t1 = x1*A = B */
+    uECC_vli_modMult_fast(X2, X2, t5, curve);                /* t3 = x2*A = C */
+    uECC_vli_modSub(Y2, Y2, Y1, curve->p, num_words); /* t4 = y2 - y1 */
+    uECC_vli_modSquare_fast(t5, Y2, curve);                  /* t5 = (y2 - y1)^2 = D */
+
+    uECC_vli_modSub(t5, t5, X1, curve->p, num_words); /* t5 = D - B */
+    uECC_vli_modSub(X2, t5, X2, curve->p, num_words); /* t3 = D - B - C = x3 */
+}
+
 /* Input P = (x1, y1, Z), Q = (x2, y2, Z)
    Output P + Q = (x3, y3, Z3), P - Q = (x3', y3', Z3)
    or P => P - Q, Q => P + Q
@@ -853,50 +977,109 @@ static void XYcZ_addC(uECC_word_t * X1,
     uECC_vli_set(X1, t7, num_words);
 }
 
-/* result may overlap point. */
-static void EccPoint_mult(uECC_word_t * result,
-                          const uECC_word_t * point,
-                          const uECC_word_t * scalar,
-                          const uECC_word_t * initial_Z,
-                          bitcount_t num_bits,
-                          uECC_Curve curve) {
-    /* R0 and R1 */
-    uECC_word_t Rx[2][uECC_MAX_WORDS];
-    uECC_word_t Ry[2][uECC_MAX_WORDS];
-    uECC_word_t z[uECC_MAX_WORDS];
-    bitcount_t i;
-    uECC_word_t nb;
+/* The ladder is split in three parts so that uECC_mult_step() can run it in slices:
+   EccPoint_mult_start() loads the point and does the initial doubling,
+   EccPoint_mult_bits() processes scalar bits high down to low + 1, and
+   EccPoint_mult_finish() handles bit 0 and converts back to affine coordinates.
+   With 'x_only' set, the last addition and the conversion skip Y: ECDH only needs the x
+   coordinate of the product, and the Y of the result is then left undefined. */
+static void EccPoint_mult_start(uECC_word_t Rx[2][uECC_MAX_WORDS],
+                                uECC_word_t Ry[2][uECC_MAX_WORDS],
+                                const uECC_word_t * point,
+                                const uECC_word_t * initial_Z,
+                                uECC_Curve curve) {
     wordcount_t num_words = curve->num_words;
 
     uECC_vli_set(Rx[1], point, num_words);
     uECC_vli_set(Ry[1], point + num_words, num_words);
 
     XYcZ_initial_double(Rx[1], Ry[1], Rx[0], Ry[0], initial_Z, curve);
+}
 
-    for (i = num_bits - 2; i > 0; --i) {
+static void EccPoint_mult_bits(uECC_word_t Rx[2][uECC_MAX_WORDS],
+                               uECC_word_t Ry[2][uECC_MAX_WORDS],
+                               const uECC_word_t * scalar,
+                               bitcount_t high,
+                               bitcount_t low,
+                               uECC_Curve curve) {
+    bitcount_t i;
+    uECC_word_t nb;
+
+    for (i = high; i > low; --i) {
         nb = !uECC_vli_testBit(scalar, i);
         XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], curve);
         XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], curve);
     }
+}
+
+/* Processes bit 0 and leaves R0 such that the result is apply_z(R0, u / d). */
+static void EccPoint_mult_finish_z(uECC_word_t Rx[2][uECC_MAX_WORDS],
+                                   uECC_word_t Ry[2][uECC_MAX_WORDS],
+                                   const uECC_word_t * point,
+                                   const uECC_word_t * scalar,
+                                   uECC_word_t * u,
+                                   uECC_word_t * d,
+                                   uECC_word_t x_only,
+                                   uECC_Curve curve) {
+    uECC_word_t nb;
+    wordcount_t num_words = curve->num_words;
 
     nb = !uECC_vli_testBit(scalar, 0);
     XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], curve);
 
-    /* Find final 1/Z value. */
-    uECC_vli_modSub(z, Rx[1], Rx[0], curve->p, num_words); /* X1 - X0 */
-    uECC_vli_modMult_fast(z, z, Ry[1 - nb], curve);               /* Yb * (X1 - X0) */
-    uECC_vli_modMult_fast(z, z, point, curve);                    /* xP * Yb * (X1 - X0) */
-    uECC_vli_modInv(z, z, curve->p, num_words);            /* 1 / (xP * Yb * (X1 - X0)) */
-    /* yP / (xP * Yb * (X1 - X0)) */
-    uECC_vli_modMult_fast(z, z, point + num_words, curve);
-    uECC_vli_modMult_fast(z, z, Rx[1 - nb], curve); /* Xb * yP / (xP * Yb * (X1 - X0)) */
-    /* End 1/Z calculation */
+    /* Final 1/Z value is u / d. */
+    uECC_vli_modSub(d, Rx[1], Rx[0], curve->p, num_words); /* X1 - X0 */
+    uECC_vli_modMult_fast(d, d, Ry[1 - nb], curve);               /* Yb * (X1 - X0) */
+    uECC_vli_modMult_fast(d, d, point, curve);                    /* xP * Yb * (X1 - X0) */
+    uECC_vli_modMult_fast(u, point + num_words, Rx[1 - nb], curve); /* Xb * yP */
 
-    XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], curve);
-    apply_z(Rx[0], Ry[0], z, curve);
+    if (x_only) {
+        XYcZ_add_x(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], curve);
+    } else {
+        XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], curve);
+    }
+}
 
+/* result may overlap point. */
+static void EccPoint_mult_finish(uECC_word_t * result,
+                                 uECC_word_t Rx[2][uECC_MAX_WORDS],
+                                 uECC_word_t Ry[2][uECC_MAX_WORDS],
+                                 const uECC_word_t * point,
+                                 const uECC_word_t * scalar,
+                                 uECC_word_t x_only,
+                                 uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t u[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    EccPoint_mult_finish_z(Rx, Ry, point, scalar, u, z, x_only, curve);
+    vli_modInv_p(z, z, curve); /* 1 / (xP * Yb * (X1 - X0)) */
+    uECC_vli_modMult_fast(z, z, u, curve);      /* Xb * yP / (xP * Yb * (X1 - X0)) */
+    if (x_only) {
+        uECC_vli_modSquare_fast(z, z, curve);          /* z^2 */
+        uECC_vli_modMult_fast(Rx[0], Rx[0], z, curve); /* x0 * z^2 */
+    } else {
+        apply_z(Rx[0], Ry[0], z, curve);
+        uECC_vli_set(result + num_words, Ry[0], num_words);
+    }
     uECC_vli_set(result, Rx[0], num_words);
-    uECC_vli_set(result + num_words, Ry[0], num_words);
+}
+
+/* result may overlap point. */
+static void EccPoint_mult(uECC_word_t * result,
+                          const uECC_word_t * point,
+                          const uECC_word_t * scalar,
+                          const uECC_word_t * initial_Z,
+                          bitcount_t num_bits,
+                          uECC_word_t x_only,
+                          uECC_Curve curve) {
+    /* R0 and R1 */
+    uECC_LADDER(Rx, Ry);
+
+    EccPoint_mult_start(Rx, Ry, point, initial_Z, curve);
+    EccPoint_mult_bits(Rx, Ry, scalar, num_bits - 2, 0, curve);
+    EccPoint_mult_finish(result, Rx, Ry, point, scalar, x_only, curve);
+    uECC_LADDER_FREE();
 }
 
 static uECC_word_t regularize_k(const uECC_word_t * const k,
@@ -912,19 +1095,208 @@ static uECC_word_t regularize_k(const uECC_word_t * const k,
     return carry;
 }
 
-static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
-                                               uECC_word_t *private_key,
-                                               uECC_Curve curve) {
-    uECC_word_t tmp1[uECC_MAX_WORDS];
-    uECC_word_t tmp2[uECC_MAX_WORDS];
-    uECC_word_t *p2[2] = {tmp1, tmp2};
+#if uECC_GENERATOR_TABLE && uECC_SUPPORTS_secp256r1
+
+#if (uECC_PLATFORM == uECC_avr)
+    #error "uECC_GENERATOR_TABLE needs const data in flash, it is not supported on AVR"
+#endif
+
+#include "generator-table.inc"
+
+/* Constant-time lookup of comb entry |digit| (bit 7 is the sign), negated for
+   negative digits. Every entry is read whatever the digit. */
+static void comb_select(uECC_word_t *point, uint8_t digit, uECC_Curve curve) {
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t index = (digit & 0x7F) >> 1;
+    uECC_word_t neg = (uECC_word_t)0 - (uECC_word_t)(digit >> 7);
+    uECC_word_t i;
+    wordcount_t j;
+    wordcount_t num_words = curve->num_words;
+
+    uECC_vli_clear(point, num_words * 2);
+    for (i = 0; i < uECC_COMB_POINTS; ++i) {
+        uECC_word_t diff = i ^ index;
+        /* All ones when i == index, zero otherwise */
+        uECC_word_t mask = ((diff | ((uECC_word_t)0 - diff)) >> (uECC_WORD_BITS - 1)) - 1;
+        for (j = 0; j < num_words * 2; ++j) {
+            point[j] |= secp256r1_comb_table[i][j] & mask;
+        }
+    }
+
+    uECC_vli_sub(tmp, curve->p, point + num_words, num_words); /* -y = p - y */
+    for (j = 0; j < num_words; ++j) {
+        point[num_words + j] ^= (point[num_words + j] ^ tmp[j]) & neg;
+    }
+}
+
+/* (X1, Y1, Z1) => (X1, Y1, Z1) + (x2, y2), Jacobian plus affine.
+   The comb only meets P == Q, P == -Q or infinity with negligible probability, so these
+   cases are handled for correctness but not in constant time. */
+static void EccPoint_add_mixed(uECC_word_t * X1,
+                               uECC_word_t * Y1,
+                               uECC_word_t * Z1,
+                               const uECC_word_t * point,
+                               uECC_Curve curve) {
+    uECC_word_t t1[uECC_MAX_WORDS];
+    uECC_word_t t2[uECC_MAX_WORDS];
+    uECC_word_t t3[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    if (uECC_vli_isZero(Z1, num_words)) {
+        uECC_vli_set(X1, point, num_words);
+        uECC_vli_set(Y1, point + num_words, num_words);
+        uECC_vli_clear(Z1, num_words);
+        Z1[0] = 1;
+        return;
+    }
+
+    uECC_vli_modSquare_fast(t1, Z1, curve);                  /* t1 = z1^2 */
+    uECC_vli_modMult_fast(t2, t1, Z1, curve);                /* t2 = z1^3 */
+    uECC_vli_modMult_fast(t1, t1, point, curve);             /* t1 = x2*z1^2 = U2 */
+    uECC_vli_modMult_fast(t2, t2, point + num_words, curve); /* t2 = y2*z1^3 = S2 */
+    uECC_vli_modSub(t1, t1, X1, curve->p, num_words);        /* t1 = U2 - x1 = H */
+    uECC_vli_modSub(t2, t2, Y1, curve->p, num_words);        /* t2 = S2 - y1 = r */
+
+    if (uECC_vli_isZero(t1, num_words)) {
+        if (uECC_vli_isZero(t2, num_words)) {
+            curve->double_jacobian(X1, Y1, Z1, curve);       /* P == Q */
+        } else {
+            uECC_vli_clear(Z1, num_words);                   /* P == -Q */
+        }
+        return;
+    }
+
+    uECC_vli_modMult_fast(Z1, Z1, t1, curve);                /* z3 = z1*H */
+    uECC_vli_modSquare_fast(t3, t1, curve);                  /* t3 = H^2 */
+    uECC_vli_modMult_fast(t1, t1, t3, curve);                /* t1 = H^3 */
+    uECC_vli_modMult_fast(t3, t3, X1, curve);                /* t3 = x1*H^2 = V */
+    uECC_vli_modMult_fast(Y1, Y1, t1, curve);                /* y1 = y1*H^3 */
+    uECC_vli_modSquare_fast(X1, t2, curve);                  /* x1 = r^2 */
+    uECC_vli_modSub(X1, X1, t1, curve->p, num_words);        /* x1 = r^2 - H^3 */
+    uECC_vli_modSub(X1, X1, t3, curve->p, num_words);
+    uECC_vli_modSub(X1, X1, t3, curve->p, num_words);        /* x3 = r^2 - H^3 - 2V */
+    uECC_vli_modSub(t3, t3, X1, curve->p, num_words);        /* t3 = V - x3 */
+    uECC_vli_modMult_fast(t3, t3, t2, curve);                /* t3 = r*(V - x3) */
+    uECC_vli_modSub(Y1, t3, Y1, curve->p, num_words);        /* y3 = r*(V - x3) - y1*H^3 */
+}
+
+/* result = scalar * G for secp256r1 in Jacobian coordinates (X, Y, z), with 0 < scalar < n.
+   Fixed-base comb with the odd signed digit recoding of Hedabou et al. (as in mbed TLS):
+   every column digit is odd, so each step is one doubling and one addition of a table point,
+   whatever the scalar. */
+static void EccPoint_mult_generator_z(uECC_word_t * result,
+                                      uECC_word_t * z,
+                                      const uECC_word_t * scalar,
+                                      uECC_Curve curve) {
+    uECC_word_t m[uECC_MAX_WORDS];
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t point[uECC_MAX_WORDS * 2];
+    uint8_t digits[uECC_COMB_SPACING + 1];
+    uint8_t carry = 0;
+    uECC_word_t mask;
+    bitcount_t i;
+    wordcount_t j;
+    wordcount_t num_words = curve->num_words;
+    uECC_word_t *X = result;
+    uECC_word_t *Y = result + num_words;
+
+    /* The recoding needs an odd scalar: use n - k for an even k, and negate the result. */
+    mask = (uECC_word_t)0 - (uECC_word_t)(1 - (scalar[0] & 1));
+    uECC_vli_sub(tmp, curve->n, scalar, num_words);
+    for (j = 0; j < num_words; ++j) {
+        m[j] = scalar[j] ^ ((scalar[j] ^ tmp[j]) & mask);
+    }
+
+    /* Comb columns: digit i gathers bits i, i + d, ..., i + (w - 1)d */
+    for (i = 0; i < uECC_COMB_SPACING; ++i) {
+        uint8_t tooth;
+        digits[i] = 0;
+        for (tooth = 0; tooth < uECC_COMB_TEETH; ++tooth) {
+            bitcount_t bit = i + uECC_COMB_SPACING * tooth;
+            if (bit < curve->num_n_bits) {
+                digits[i] |= (uint8_t)((m[bit >> uECC_WORD_BITS_SHIFT] >>
+                                        (bit & uECC_WORD_BITS_MASK)) & 1) << tooth;
+            }
+        }
+    }
+    digits[uECC_COMB_SPACING] = 0;
+
+    /* Make digits 1 .. d odd; a negated digit gets its sign in bit 7 */
+    for (i = 1; i <= uECC_COMB_SPACING; ++i) {
+        uint8_t adjust;
+        uint8_t next = digits[i] & carry;
+        digits[i] ^= carry;
+        carry = next;
+
+        adjust = 1 - (digits[i] & 0x01);
+        carry |= digits[i] & (digits[i - 1] * adjust);
+        digits[i] ^= digits[i - 1] * adjust;
+        digits[i - 1] |= adjust << 7;
+    }
+
+    comb_select(point, digits[uECC_COMB_SPACING], curve);
+    uECC_vli_set(X, point, num_words);
+    uECC_vli_set(Y, point + num_words, num_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+
+    for (i = uECC_COMB_SPACING - 1; i >= 0; --i) {
+        curve->double_jacobian(X, Y, z, curve);
+        comb_select(point, digits[i], curve);
+        EccPoint_add_mixed(X, Y, z, point, curve);
+    }
+
+    /* (n - k) * G = -(k * G) */
+    uECC_vli_sub(tmp, curve->p, Y, num_words);
+    for (j = 0; j < num_words; ++j) {
+        Y[j] ^= (Y[j] ^ tmp[j]) & mask;
+    }
+}
+
+/* result = scalar * G for secp256r1, with 0 < scalar < n. */
+static void EccPoint_mult_generator(uECC_word_t * result,
+                                    const uECC_word_t * scalar,
+                                    uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+
+    EccPoint_mult_generator_z(result, z, scalar, curve);
+    vli_modInv_p(z, z, curve);
+    apply_z(result, result + curve->num_words, z, curve);
+}
+
+#endif /* uECC_GENERATOR_TABLE && uECC_SUPPORTS_secp256r1 */
+
+/* result = scalar * G, with 0 < scalar < n. scalar is overwritten. */
+static void EccPoint_mult_G(uECC_word_t * result, uECC_word_t * scalar, uECC_Curve curve) {
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t *p2[2] = {scalar, tmp};
     uECC_word_t carry;
 
+#if uECC_GENERATOR_TABLE && uECC_SUPPORTS_secp256r1
+    if (curve == &curve_secp256r1) {
+        EccPoint_mult_generator(result, scalar, curve);
+        return;
+    }
+#endif
+
     /* Regularize the bitcount for the private key so that attackers cannot use a side channel
        attack to learn the number of leading zeros. */
-    carry = regularize_k(private_key, tmp1, tmp2, curve);
+    carry = regularize_k(scalar, scalar, tmp, curve);
 
-    EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, curve);
+    EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, 0, curve);
+}
+
+static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
+                                               uECC_word_t *private_key,
+                                               uECC_Curve curve) {
+    uECC_word_t tmp[uECC_MAX_WORDS];
+
+    if (!uECC_TEMP_ROOM(uECC_LADDER_WORDS)) {
+        return 0;
+    }
+
+    uECC_vli_set(tmp, private_key, BITS_TO_WORDS(curve->num_n_bits));
+    EccPoint_mult_G(result, tmp, curve);
 
     if (EccPoint_isZero(result, curve)) {
         return 0;
@@ -975,21 +1347,22 @@ uECC_VLI_API void uECC_vli_bytesToNative(uECC_word_t *native,
 
 #endif /* uECC_WORD_SIZE */
 
-/* Generates a random integer in the range 0 < random < top.
+/* Generates a random integer in the range 0 < random < top using 'rng'.
    Both random and top have num_words words. */
-uECC_VLI_API int uECC_generate_random_int(uECC_word_t *random,
-                                          const uECC_word_t *top,
-                                          wordcount_t num_words) {
+static int random_int(uECC_RNG_Function rng,
+                      uECC_word_t *random,
+                      const uECC_word_t *top,
+                      wordcount_t num_words) {
     uECC_word_t mask = (uECC_word_t)-1;
     uECC_word_t tries;
     bitcount_t num_bits = uECC_vli_numBits(top, num_words);
 
-    if (!g_rng_function) {
+    if (!rng) {
         return 0;
     }
 
     for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
-        if (!g_rng_function((uint8_t *)random, num_words * uECC_WORD_SIZE)) {
+        if (!rng((uint8_t *)random, num_words * uECC_WORD_SIZE)) {
             return 0;
 	    }
         random[num_words - 1] &= mask >> ((bitcount_t)(num_words * uECC_WORD_SIZE * 8 - num_bits));
@@ -1001,9 +1374,28 @@ uECC_VLI_API int uECC_generate_random_int(uECC_word_t *random,
     return 0;
 }
 
+#if uECC_ENABLE_VLI_API
+/* Generates a random integer in the range 0 < random < top.
+   Both random and top have num_words words. */
+uECC_VLI_API int uECC_generate_random_int(uECC_word_t *random,
+                                          const uECC_word_t *top,
+                                          wordcount_t num_words) {
+    return random_int(g_rng_function, random, top, num_words);
+}
+#endif /* uECC_ENABLE_VLI_API */
+
 int uECC_make_key(uint8_t *public_key,
                   uint8_t *private_key,
                   uECC_Curve curve) {
+    uECC_Context context;
+
+    context.curve = curve;
+    context.rng = g_rng_function;
+    return uECC_make_key_ctx(&context, public_key, private_key);
+}
+
+int uECC_make_key_ctx(const uECC_Context *context, uint8_t *public_key, uint8_t *private_key) {
+    uECC_Curve curve = context->curve;
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     uECC_word_t *_private = (uECC_word_t *)private_key;
     uECC_word_t *_public = (uECC_word_t *)public_key;
@@ -1014,7 +1406,7 @@ int uECC_make_key(uint8_t *public_key,
     uECC_word_t tries;
 
     for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
-        if (!uECC_generate_random_int(_private, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
+        if (!random_int(context->rng, _private, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
             return 0;
         }
 
@@ -1031,14 +1423,157 @@ int uECC_make_key(uint8_t *public_key,
     return 0;
 }
 
+/* result = scalar * G in Jacobian coordinates: the affine point is apply_z(result, 1 / d).
+   scalar is overwritten. */
+static void EccPoint_mult_G_z(uECC_word_t * result,
+                              uECC_word_t * d,
+                              uECC_word_t * scalar,
+                              uECC_Curve curve) {
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t *p2[2] = {scalar, tmp};
+    uECC_word_t carry;
+    wordcount_t num_words = curve->num_words;
+
+#if uECC_GENERATOR_TABLE && uECC_SUPPORTS_secp256r1
+    if (curve == &curve_secp256r1) {
+        EccPoint_mult_generator_z(result, d, scalar, curve);
+        return;
+    }
+#endif
+
+    carry = regularize_k(scalar, scalar, tmp, curve);
+    {
+    uECC_LADDER(Rx, Ry);
+
+    EccPoint_mult_start(Rx, Ry, curve->G, 0, curve);
+    EccPoint_mult_bits(Rx, Ry, p2[!carry], curve->num_n_bits - 1, 0, curve);
+    EccPoint_mult_finish_z(Rx, Ry, curve->G, p2[!carry], tmp, d, 0, curve);
+
+    /* 1/Z = u / d: apply u now, 1/d once the batch inversion is done */
+    apply_z(Rx[0], Ry[0], tmp, curve);
+    uECC_vli_set(result, Rx[0], num_words);
+    uECC_vli_set(result + num_words, Ry[0], num_words);
+    uECC_LADDER_FREE();
+    }
+}
+
+int uECC_make_keys_batch(const uECC_Context *context,
+                         unsigned count,
+                         uint8_t *public_keys,
+                         uint8_t *private_keys) {
+    uECC_Curve curve = context->curve;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned public_size = 2 * curve->num_bytes;
+    unsigned private_size = BITS_TO_BYTES(curve->num_n_bits);
+    uECC_word_t d[uECC_BATCH_SIZE][uECC_MAX_WORDS];         /* Z of each key */
+    uECC_word_t prefix[uECC_BATCH_SIZE][uECC_MAX_WORDS];    /* d[0] * ... * d[i] */
+    uECC_word_t _private[uECC_MAX_WORDS];
+    uECC_word_t point[uECC_MAX_WORDS * 2];
+    uECC_word_t inverse[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+
+    if (!uECC_TEMP_ROOM(uECC_LADDER_WORDS)) {
+        return 0;
+    }
+
+    while (count > 0) {
+        unsigned batch = (count < uECC_BATCH_SIZE) ? count : uECC_BATCH_SIZE;
+        unsigned i;
+
+        /* Scalar multiplications, results kept in Jacobian form in the output buffers */
+        for (i = 0; i < batch; ++i) {
+            uint8_t *public_key = public_keys + i * public_size;
+            uECC_word_t tries;
+
+            for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
+                if (!random_int(context->rng, _private, curve->n, num_n_words)) {
+                    return 0;
+                }
+                uECC_vli_set(z, _private, num_n_words);
+                EccPoint_mult_G_z(point, d[i], z, curve);
+                if (!uECC_vli_isZero(d[i], num_words)) {
+                    break;
+                }
+            }
+            if (tries == uECC_RNG_MAX_TRIES) {
+                return 0;
+            }
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(private_keys + i * private_size, (uint8_t *)_private, private_size);
+            bcopy(public_key, (uint8_t *)point, public_size);
+#else
+            uECC_vli_nativeToBytes(private_keys + i * private_size, private_size, _private);
+            uECC_vli_nativeToBytes(public_key, curve->num_bytes, point);
+            uECC_vli_nativeToBytes(public_key + curve->num_bytes, curve->num_bytes, point + num_words);
+#endif
+
+            if (i == 0) {
+                uECC_vli_set(prefix[0], d[0], num_words);
+            } else {
+                uECC_vli_modMult_fast(prefix[i], prefix[i - 1], d[i], curve);
+            }
+        }
+
+        /* Montgomery's trick: one inversion for the whole batch */
+        vli_modInv_p(inverse, prefix[batch - 1], curve);
+        for (i = batch; i-- > 0; ) {
+            uint8_t *public_key = public_keys + i * public_size;
+
+            if (i > 0) {
+                uECC_vli_modMult_fast(z, inverse, prefix[i - 1], curve);    /* 1 / d[i] */
+                uECC_vli_modMult_fast(inverse, inverse, d[i], curve);       /* 1 / prefix[i - 1] */
+            } else {
+                uECC_vli_set(z, inverse, num_words);
+            }
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy((uint8_t *)point, public_key, public_size);
+#else
+            uECC_vli_bytesToNative(point, public_key, curve->num_bytes);
+            uECC_vli_bytesToNative(point + num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+            apply_z(point, point + num_words, z, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(public_key, (uint8_t *)point, public_size);
+#else
+            uECC_vli_nativeToBytes(public_key, curve->num_bytes, point);
+            uECC_vli_nativeToBytes(public_key + curve->num_bytes, curve->num_bytes, point + num_words);
+#endif
+        }
+
+        public_keys += batch * public_size;
+        private_keys += batch * private_size;
+        count -= batch;
+    }
+    return 1;
+}
+
 int uECC_shared_secret(const uint8_t *public_key,
                        const uint8_t *private_key,
                        uint8_t *secret,
                        uECC_Curve curve) {
-    uECC_word_t _public[uECC_MAX_WORDS * 2];
-    uECC_word_t _private[uECC_MAX_WORDS];
-
-    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_Context context;
+
+    context.curve = curve;
+    context.rng = g_rng_function;
+    return uECC_shared_secret_ctx(&context, public_key, private_key, secret);
+}
+
+/* temps holds uECC_SHARED_SECRET_WORDS words. The public key is read from 'native' when it is
+   not 0 (a uECC_PublicKey), from the bytes of 'public_key' otherwise. */
+static int shared_secret(const uECC_Context *context,
+                         const uint8_t *public_key,
+                         const uECC_word_t *native,
+                         const uint8_t *private_key,
+                         uint8_t *secret,
+                         uECC_word_t *temps) {
+    uECC_Curve curve = context->curve;
+    uECC_word_t *_public = temps;
+    uECC_word_t *_private = temps + uECC_MAX_WORDS * 2;
+
+    uECC_word_t *tmp = temps + uECC_MAX_WORDS * 3;
     uECC_word_t *p2[2] = {_private, tmp};
     uECC_word_t *initial_Z = 0;
     uECC_word_t carry;
@@ -1047,12 +1582,20 @@ int uECC_shared_secret(const uint8_t *public_key,
 
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     bcopy((uint8_t *) _private, private_key, num_bytes);
-    bcopy((uint8_t *) _public, public_key, num_bytes*2);
 #else
     uECC_vli_bytesToNative(_private, private_key, BITS_TO_BYTES(curve->num_n_bits));
-    uECC_vli_bytesToNative(_public, public_key, num_bytes);
-    uECC_vli_bytesToNative(_public + num_words, public_key + num_bytes, num_bytes);
 #endif
+    if (native) {
+        uECC_vli_set(_public, native, num_words);
+        uECC_vli_set(_public + num_words, native + num_words, num_words);
+    } else {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy((uint8_t *) _public, public_key, num_bytes*2);
+#else
+        uECC_vli_bytesToNative(_public, public_key, num_bytes);
+        uECC_vli_bytesToNative(_public + num_words, public_key + num_bytes, num_bytes);
+#endif
+    }
 
     /* Regularize the bitcount for the private key so that attackers cannot use a side channel
        attack to learn the number of leading zeros. */
@@ -1060,20 +1603,185 @@ int uECC_shared_secret(const uint8_t *public_key,
 
     /* If an RNG function was specified, try to get a random initial Z value to improve
        protection against side-channel attacks. */
-    if (g_rng_function) {
-        if (!uECC_generate_random_int(p2[carry], curve->p, num_words)) {
+    if (context->rng) {
+        if (!random_int(context->rng, p2[carry], curve->p, num_words)) {
             return 0;
         }
         initial_Z = p2[carry];
     }
 
-    EccPoint_mult(_public, _public, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+    /* The secret is the x coordinate of the product, its Y is not computed. */
+    EccPoint_mult(_public, _public, p2[!carry], initial_Z, curve->num_n_bits + 1, 1, curve);
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     bcopy((uint8_t *) secret, (uint8_t *) _public, num_bytes);
 #else
     uECC_vli_nativeToBytes(secret, num_bytes, _public);
 #endif
-    return !EccPoint_isZero(_public, curve);
+    return !uECC_vli_isZero(_public, num_words);
+}
+
+int uECC_shared_secret_ctx(const uECC_Context *context,
+                           const uint8_t *public_key,
+                           const uint8_t *private_key,
+                           uint8_t *secret) {
+    int result;
+
+    if (!uECC_TEMP_ROOM(uECC_SHARED_SECRET_WORDS + uECC_LADDER_WORDS)) {
+        return 0;
+    }
+    {
+        uECC_TEMP(temps, uECC_SHARED_SECRET_WORDS);
+        result = shared_secret(context, public_key, 0, private_key, secret, temps);
+        uECC_TEMP_FREE(uECC_SHARED_SECRET_WORDS);
+    }
+    return result;
+}
+
+/* Ladder state kept in the opaque storage of uECC_mult_ctx. */
+typedef struct uECC_MultState {
+    uECC_word_t Rx[2][uECC_MAX_WORDS];
+    uECC_word_t Ry[2][uECC_MAX_WORDS];
+    uECC_word_t point[uECC_MAX_WORDS * 2];   /* Input point, then the result */
+    uECC_word_t scalar[uECC_MAX_WORDS];      /* Regularized scalar */
+    uECC_word_t private_key[uECC_MAX_WORDS];
+} uECC_MultState;
+
+/* Does not compile if uECC_MULT_CTX_SIZE is too small for the enabled curves. */
+typedef char uECC_mult_ctx_size_check[(sizeof(uECC_MultState) <= uECC_MULT_CTX_SIZE) ? 1 : -1];
+
+#define uECC_MULT_IDLE   0
+#define uECC_MULT_LADDER 1
+#define uECC_MULT_DONE   2
+
+static void mult_ctx_clear(uECC_mult_ctx *ctx) {
+    volatile uint8_t *state = (volatile uint8_t *)ctx->state;
+    unsigned i;
+
+    for (i = 0; i < sizeof(ctx->state); ++i) {
+        state[i] = 0;
+    }
+    ctx->curve = 0;
+    ctx->bit = 0;
+    ctx->phase = uECC_MULT_IDLE;
+    ctx->x_only = 0;
+}
+
+/* Regularizes 'scalar' and runs the initial doubling of state->point, as
+   uECC_shared_secret() and EccPoint_compute_public_key() do before the ladder.
+   If 'rng' is set it randomizes the initial Z. */
+static int mult_ctx_start(uECC_mult_ctx *ctx,
+                          const uECC_word_t *scalar,
+                          uECC_RNG_Function rng,
+                          uECC_Curve curve) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    uECC_word_t tmp[2][uECC_MAX_WORDS];
+    uECC_word_t *initial_Z = 0;
+    uECC_word_t carry;
+
+    carry = regularize_k(scalar, tmp[0], tmp[1], curve);
+    uECC_vli_set(state->scalar, tmp[!carry], BITS_TO_WORDS(curve->num_n_bits));
+
+    if (rng) {
+        if (!random_int(rng, tmp[carry], curve->p, curve->num_words)) {
+            mult_ctx_clear(ctx);
+            return 0;
+        }
+        initial_Z = tmp[carry];
+    }
+
+    EccPoint_mult_start(state->Rx, state->Ry, state->point, initial_Z, curve);
+    ctx->curve = curve;
+    ctx->bit = curve->num_n_bits - 1;
+    ctx->phase = uECC_MULT_LADDER;
+    return 1;
+}
+
+int uECC_make_key_start(uECC_mult_ctx *ctx, const uECC_Context *context) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    uECC_Curve curve = context->curve;
+
+    mult_ctx_clear(ctx);
+    if (!random_int(context->rng, state->private_key, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
+        return 0;
+    }
+    uECC_vli_set(state->point, curve->G, curve->num_words * 2);
+    return mult_ctx_start(ctx, state->private_key, 0, curve);
+}
+
+int uECC_shared_secret_start(uECC_mult_ctx *ctx,
+                             const uECC_Context *context,
+                             const uint8_t *public_key,
+                             const uint8_t *private_key) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    uECC_Curve curve = context->curve;
+    wordcount_t num_bytes = curve->num_bytes;
+
+    mult_ctx_clear(ctx);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) state->private_key, private_key, num_bytes);
+    bcopy((uint8_t *) state->point, public_key, num_bytes*2);
+#else
+    uECC_vli_bytesToNative(state->private_key, private_key, BITS_TO_BYTES(curve->num_n_bits));
+    uECC_vli_bytesToNative(state->point, public_key, num_bytes);
+    uECC_vli_bytesToNative(state->point + curve->num_words, public_key + num_bytes, num_bytes);
+#endif
+    ctx->x_only = 1;
+    return mult_ctx_start(ctx, state->private_key, context->rng, curve);
+}
+
+int uECC_mult_step(uECC_mult_ctx *ctx, unsigned max_bits) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    bitcount_t low;
+
+    if (ctx->phase == uECC_MULT_LADDER && max_bits > 0) {
+        low = (max_bits < ctx->bit) ? (bitcount_t)(ctx->bit - max_bits) : 0;
+        EccPoint_mult_bits(state->Rx, state->Ry, state->scalar, ctx->bit, low, ctx->curve);
+        ctx->bit = low;
+        if (low == 0) {
+            EccPoint_mult_finish(state->point, state->Rx, state->Ry, state->point,
+                                 state->scalar, ctx->x_only, ctx->curve);
+            ctx->phase = uECC_MULT_DONE;
+        }
+    }
+    return ctx->phase != uECC_MULT_LADDER;
+}
+
+int uECC_make_key_finish(uECC_mult_ctx *ctx, uint8_t *public_key, uint8_t *private_key) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    uECC_Curve curve = ctx->curve;
+    int ret = 0;
+
+    if (ctx->phase == uECC_MULT_DONE && !EccPoint_isZero(state->point, curve)) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy(private_key, (uint8_t *) state->private_key, BITS_TO_BYTES(curve->num_n_bits));
+        bcopy(public_key, (uint8_t *) state->point, curve->num_bytes * 2);
+#else
+        uECC_vli_nativeToBytes(private_key, BITS_TO_BYTES(curve->num_n_bits), state->private_key);
+        uECC_vli_nativeToBytes(public_key, curve->num_bytes, state->point);
+        uECC_vli_nativeToBytes(
+            public_key + curve->num_bytes, curve->num_bytes, state->point + curve->num_words);
+#endif
+        ret = 1;
+    }
+    mult_ctx_clear(ctx);
+    return ret;
+}
+
+int uECC_shared_secret_finish(uECC_mult_ctx *ctx, uint8_t *secret) {
+    uECC_MultState *state = (uECC_MultState *)ctx->state;
+    uECC_Curve curve = ctx->curve;
+    int ret = 0;
+
+    if (ctx->phase == uECC_MULT_DONE) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy(secret, (uint8_t *) state->point, curve->num_bytes);
+#else
+        uECC_vli_nativeToBytes(secret, curve->num_bytes, state->point);
+#endif
+        ret = !uECC_vli_isZero(state->point, curve->num_words);
+    }
+    mult_ctx_clear(ctx);
+    return ret;
 }
 
 #if uECC_SUPPORT_COMPRESSED_POINT
@@ -1234,38 +1942,40 @@ static int uECC_sign_with_k(const uint8_t *private_key,
                             unsigned hash_size,
                             uECC_word_t *k,
                             uint8_t *signature,
+                            uECC_RNG_Function rng,
                             uECC_Curve curve) {
 
     uECC_word_t tmp[uECC_MAX_WORDS];
     uECC_word_t s[uECC_MAX_WORDS];
-    uECC_word_t *k2[2] = {tmp, s};
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     uECC_word_t *p = (uECC_word_t *)signature;
 #else
     uECC_word_t p[uECC_MAX_WORDS * 2];
 #endif
-    uECC_word_t carry;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-    bitcount_t num_n_bits = curve->num_n_bits;
 
     /* Make sure 0 < k < curve_n */
     if (uECC_vli_isZero(k, num_words) || uECC_vli_cmp(curve->n, k, num_n_words) != 1) {
         return 0;
     }
 
-    carry = regularize_k(k, tmp, s, curve);
-    EccPoint_mult(p, curve->G, k2[!carry], 0, num_n_bits + 1, curve);
+    if (!uECC_TEMP_ROOM(uECC_LADDER_WORDS)) {
+        return 0;
+    }
+
+    uECC_vli_set(tmp, k, num_n_words);
+    EccPoint_mult_G(p, tmp, curve);
     if (uECC_vli_isZero(p, num_words)) {
         return 0;
     }
 
     /* If an RNG function was specified, get a random number
        to prevent side channel analysis of k. */
-    if (!g_rng_function) {
+    if (!rng) {
         uECC_vli_clear(tmp, num_n_words);
         tmp[0] = 1;
-    } else if (!uECC_generate_random_int(tmp, curve->n, num_n_words)) {
+    } else if (!random_int(rng, tmp, curve->n, num_n_words)) {
         return 0;
     }
 
@@ -1308,15 +2018,28 @@ int uECC_sign(const uint8_t *private_key,
               unsigned hash_size,
               uint8_t *signature,
               uECC_Curve curve) {
+    uECC_Context context;
+
+    context.curve = curve;
+    context.rng = g_rng_function;
+    return uECC_sign_ctx(&context, private_key, message_hash, hash_size, signature);
+}
+
+int uECC_sign_ctx(const uECC_Context *context,
+                  const uint8_t *private_key,
+                  const uint8_t *message_hash,
+                  unsigned hash_size,
+                  uint8_t *signature) {
+    uECC_Curve curve = context->curve;
     uECC_word_t k[uECC_MAX_WORDS];
     uECC_word_t tries;
 
     for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
-        if (!uECC_generate_random_int(k, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
+        if (!random_int(context->rng, k, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
             return 0;
         }
 
-        if (uECC_sign_with_k(private_key, message_hash, hash_size, k, signature, curve)) {
+        if (uECC_sign_with_k(private_key, message_hash, hash_size, k, signature, context->rng, curve)) {
             return 1;
         }
     }
@@ -1328,6 +2051,10 @@ int uECC_sign(const uint8_t *private_key,
 static void HMAC_init(const uECC_HashContext *hash_context, const uint8_t *K) {
     uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
     unsigned i;
+    if (hash_context->hmac_init) {
+        hash_context->hmac_init(hash_context, K);
+        return;
+    }
     for (i = 0; i < hash_context->result_size; ++i)
         pad[i] = K[i] ^ 0x36;
     for (; i < hash_context->block_size; ++i)
@@ -1348,6 +2075,10 @@ static void HMAC_finish(const uECC_HashContext *hash_context,
                         uint8_t *result) {
     uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
     unsigned i;
+    if (hash_context->hmac_finish) {
+        hash_context->hmac_finish(hash_context, K, result);
+        return;
+    }
     for (i = 0; i < hash_context->result_size; ++i)
         pad[i] = K[i] ^ 0x5c;
     for (; i < hash_context->block_size; ++i)
@@ -1432,7 +2163,7 @@ int uECC_sign_deterministic(const uint8_t *private_key,
                 mask >> ((bitcount_t)(num_n_words * uECC_WORD_SIZE * 8 - num_n_bits));
         }
 
-        if (uECC_sign_with_k(private_key, message_hash, hash_size, T, signature, curve)) {
+        if (uECC_sign_with_k(private_key, message_hash, hash_size, T, signature, g_rng_function, curve)) {
             return 1;
         }
 
@@ -1451,29 +2182,76 @@ static bitcount_t smax(bitcount_t a, bitcount_t b) {
     return (a > b ? a : b);
 }
 
-int uECC_verify(const uint8_t *public_key,
-                const uint8_t *message_hash,
-                unsigned hash_size,
-                const uint8_t *signature,
-                uECC_Curve curve) {
-    uECC_word_t u1[uECC_MAX_WORDS], u2[uECC_MAX_WORDS];
-    uECC_word_t z[uECC_MAX_WORDS];
-    uECC_word_t sum[uECC_MAX_WORDS * 2];
-    uECC_word_t rx[uECC_MAX_WORDS];
-    uECC_word_t ry[uECC_MAX_WORDS];
-    uECC_word_t tx[uECC_MAX_WORDS];
-    uECC_word_t ty[uECC_MAX_WORDS];
-    uECC_word_t tz[uECC_MAX_WORDS];
+/* Slots of the uECC_VERIFY_WORDS temps used by verify_prepare() and verify_prepared().
+   sum and the native public key are shared by every signature under the same key. */
+#define uECC_VERIFY_SUM    3
+#define uECC_VERIFY_PUBLIC 10
+
+/* Computes sum = G + Q, using the z, tx and ty slots of temps. */
+static void verify_sum(uECC_word_t *sum,
+                       const uECC_word_t *_public,
+                       uECC_word_t *temps,
+                       uECC_Curve curve) {
+    uECC_word_t *z = temps + uECC_MAX_WORDS * 2;
+    uECC_word_t *tx = temps + uECC_MAX_WORDS * 7;
+    uECC_word_t *ty = temps + uECC_MAX_WORDS * 8;
+    wordcount_t num_words = curve->num_words;
+
+    uECC_vli_set(sum, _public, num_words);
+    uECC_vli_set(sum + num_words, _public + num_words, num_words);
+    uECC_vli_set(tx, curve->G, num_words);
+    uECC_vli_set(ty, curve->G + num_words, num_words);
+    uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
+    XYcZ_add(tx, ty, sum, sum + num_words, curve);
+    vli_modInv_p(z, z, curve); /* z = 1/z */
+    apply_z(sum, sum + num_words, z, curve);
+}
+
+/* Returns the native public key in temps (or in place with native little-endian arrays). */
+static const uECC_word_t *verify_public(const uint8_t *public_key, uECC_word_t *temps) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    (void)temps;
+    return (const uECC_word_t *)public_key;
+#else
+    (void)public_key;
+    return temps + uECC_MAX_WORDS * uECC_VERIFY_PUBLIC;
+#endif
+}
+
+/* Loads the public key and computes G + Q into temps. */
+static void verify_prepare(const uint8_t *public_key, uECC_word_t *temps, uECC_Curve curve) {
+#if !uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_word_t *_public = temps + uECC_MAX_WORDS * uECC_VERIFY_PUBLIC;
+
+    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(
+        _public + curve->num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+    verify_sum(temps + uECC_MAX_WORDS * uECC_VERIFY_SUM,
+               verify_public(public_key, temps), temps, curve);
+}
+
+/* Verifies one signature with the native public key and G + Q, computed by verify_prepare()
+   in temps or held by a uECC_PublicKey. */
+static int verify_prepared(const uECC_word_t *_public,
+                           const uECC_word_t *sum,
+                           const uint8_t *message_hash,
+                           unsigned hash_size,
+                           const uint8_t *signature,
+                           uECC_word_t *temps,
+                           uECC_Curve curve) {
+    uECC_word_t *u1 = temps, *u2 = temps + uECC_MAX_WORDS;
+    uECC_word_t *z = temps + uECC_MAX_WORDS * 2;
+    uECC_word_t *rx = temps + uECC_MAX_WORDS * 5;
+    uECC_word_t *ry = temps + uECC_MAX_WORDS * 6;
+    uECC_word_t *tx = temps + uECC_MAX_WORDS * 7;
+    uECC_word_t *ty = temps + uECC_MAX_WORDS * 8;
+    uECC_word_t *tz = temps + uECC_MAX_WORDS * 9;
     const uECC_word_t *points[4];
     const uECC_word_t *point;
     bitcount_t num_bits;
     bitcount_t i;
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    uECC_word_t *_public = (uECC_word_t *)public_key;
-#else
-    uECC_word_t _public[uECC_MAX_WORDS * 2];
-#endif    
-    uECC_word_t r[uECC_MAX_WORDS], s[uECC_MAX_WORDS];
+    uECC_word_t *r = temps + uECC_MAX_WORDS * 12, *s = temps + uECC_MAX_WORDS * 13;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
 
@@ -1485,9 +2263,6 @@ int uECC_verify(const uint8_t *public_key,
     bcopy((uint8_t *) r, signature, curve->num_bytes);
     bcopy((uint8_t *) s, signature + curve->num_bytes, curve->num_bytes);
 #else
-    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
-    uECC_vli_bytesToNative(
-        _public + num_words, public_key + curve->num_bytes, curve->num_bytes);
     uECC_vli_bytesToNative(r, signature, curve->num_bytes);
     uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
 #endif
@@ -1510,16 +2285,6 @@ int uECC_verify(const uint8_t *public_key,
     uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
     uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
 
-    /* Calculate sum = G + Q. */
-    uECC_vli_set(sum, _public, num_words);
-    uECC_vli_set(sum + num_words, _public + num_words, num_words);
-    uECC_vli_set(tx, curve->G, num_words);
-    uECC_vli_set(ty, curve->G + num_words, num_words);
-    uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
-    XYcZ_add(tx, ty, sum, sum + num_words, curve);
-    uECC_vli_modInv(z, z, curve->p, num_words); /* z = 1/z */
-    apply_z(sum, sum + num_words, z, curve);
-
     /* Use Shamir's trick to calculate u1*G + u2*Q */
     points[0] = 0;
     points[1] = curve->G;
@@ -1551,7 +2316,7 @@ int uECC_verify(const uint8_t *public_key,
         }
     }
 
-    uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+    vli_modInv_p(z, z, curve); /* Z = 1/Z */
     apply_z(rx, ry, z, curve);
 
     /* v = x1 (mod n) */
@@ -1563,6 +2328,151 @@ int uECC_verify(const uint8_t *public_key,
     return (int)(uECC_vli_equal(rx, r, num_words));
 }
 
+/* temps holds uECC_VERIFY_WORDS words. */
+static int verify(const uint8_t *public_key,
+                  const uint8_t *message_hash,
+                  unsigned hash_size,
+                  const uint8_t *signature,
+                  uECC_word_t *temps,
+                  uECC_Curve curve) {
+    verify_prepare(public_key, temps, curve);
+    return verify_prepared(verify_public(public_key, temps),
+                           temps + uECC_MAX_WORDS * uECC_VERIFY_SUM,
+                           message_hash, hash_size, signature, temps, curve);
+}
+
+int uECC_verify(const uint8_t *public_key,
+                const uint8_t *message_hash,
+                unsigned hash_size,
+                const uint8_t *signature,
+                uECC_Curve curve) {
+    int result;
+
+    if (!uECC_TEMP_ROOM(uECC_VERIFY_WORDS)) {
+        return 0;
+    }
+    {
+        uECC_TEMP(temps, uECC_VERIFY_WORDS);
+        result = verify(public_key, message_hash, hash_size, signature, temps, curve);
+        uECC_TEMP_FREE(uECC_VERIFY_WORDS);
+    }
+    return result;
+}
+
+int uECC_verify_batch(const uint8_t *public_key,
+                      unsigned count,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      unsigned *bad_index,
+                      uECC_Curve curve) {
+    int result = 1;
+    unsigned i;
+
+    if (!uECC_TEMP_ROOM(uECC_VERIFY_WORDS)) {
+        return 0;
+    }
+    if (count == 0) {
+        return 1;
+    }
+    {
+        uECC_TEMP(temps, uECC_VERIFY_WORDS);
+        verify_prepare(public_key, temps, curve);
+        for (i = 0; i < count; ++i) {
+            if (!verify_prepared(verify_public(public_key, temps),
+                                 temps + uECC_MAX_WORDS * uECC_VERIFY_SUM,
+                                 message_hashes + i * hash_size,
+                                 hash_size,
+                                 signatures + i * curve->num_bytes * 2,
+                                 temps,
+                                 curve)) {
+                if (bad_index) {
+                    *bad_index = i;
+                }
+                result = 0;
+                break;
+            }
+        }
+        uECC_TEMP_FREE(uECC_VERIFY_WORDS);
+    }
+    return result;
+}
+
+/* Native public key followed by G + Q, both with the curve's word count. */
+#define uECC_KEY_SUM(key) ((uECC_word_t *)(key)->state + uECC_MAX_WORDS * 2)
+
+/* Does not compile if uECC_PUBLIC_KEY_STATE_SIZE is too small for the enabled curves. */
+typedef char uECC_public_key_size_check[
+    (uECC_MAX_WORDS * 4 * uECC_WORD_SIZE <= uECC_PUBLIC_KEY_STATE_SIZE) ? 1 : -1];
+
+int uECC_public_key_load(uECC_PublicKey *key, const uint8_t *public_key, uECC_Curve curve) {
+    uECC_word_t *_public = (uECC_word_t *)key->state;
+    int result = 0;
+
+    key->curve = 0;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) _public, public_key, curve->num_bytes * 2);
+#else
+    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(
+        _public + curve->num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+    if (!uECC_valid_point(_public, curve)) {
+        return 0;
+    }
+
+    if (uECC_TEMP_ROOM(uECC_VERIFY_WORDS)) {
+        uECC_TEMP(temps, uECC_VERIFY_WORDS);
+        verify_sum(uECC_KEY_SUM(key), _public, temps, curve);
+        uECC_TEMP_FREE(uECC_VERIFY_WORDS);
+        key->curve = curve;
+        result = 1;
+    }
+    return result;
+}
+
+int uECC_verify_loaded(const uECC_PublicKey *key,
+                       const uint8_t *message_hash,
+                       unsigned hash_size,
+                       const uint8_t *signature) {
+    int result;
+
+    if (!key->curve || !uECC_TEMP_ROOM(uECC_VERIFY_WORDS)) {
+        return 0;
+    }
+    {
+        uECC_TEMP(temps, uECC_VERIFY_WORDS);
+        result = verify_prepared((const uECC_word_t *)key->state,
+                                 uECC_KEY_SUM(key),
+                                 message_hash,
+                                 hash_size,
+                                 signature,
+                                 temps,
+                                 key->curve);
+        uECC_TEMP_FREE(uECC_VERIFY_WORDS);
+    }
+    return result;
+}
+
+int uECC_shared_secret_loaded(const uECC_Context *context,
+                              const uECC_PublicKey *key,
+                              const uint8_t *private_key,
+                              uint8_t *secret) {
+    int result;
+
+    if (!key->curve || key->curve != context->curve ||
+            !uECC_TEMP_ROOM(uECC_SHARED_SECRET_WORDS + uECC_LADDER_WORDS)) {
+        return 0;
+    }
+    {
+        uECC_TEMP(temps, uECC_SHARED_SECRET_WORDS);
+        result = shared_secret(context, 0, (const uECC_word_t *)key->state,
+                               private_key, secret, temps);
+        uECC_TEMP_FREE(uECC_SHARED_SECRET_WORDS);
+    }
+    return result;
+}
+
 #if uECC_ENABLE_VLI_API
 
 unsigned uECC_curve_num_words(uECC_Curve curve) {
@@ -1628,7 +2538,7 @@ void uECC_point_mult(uECC_word_t *result,
     uECC_word_t *p2[2] = {tmp1, tmp2};
     uECC_word_t carry = regularize_k(scalar, tmp1, tmp2, curve);
 
-    EccPoint_mult(result, point, p2[!carry], 0, curve->num_n_bits + 1, curve);
+    EccPoint_mult(result, point, p2[!carry], 0, curve->num_n_bits + 1, 0, curve);
 }
 
 #endif /* uECC_ENABLE_VLI_API */
@@ -21,20 +21,33 @@ Possible values for uECC_PLATFORM are defined below: */
 If uECC_WORD_SIZE is not explicitly defined then it will be automatically set based on your
 platform. */
 
+/* uECC_ARM_V7EM - Define as 1 on ARMv7E-M (Thumb-2 with the DSP extension: Cortex-M4 and
+Cortex-M7, e.g. the Renesas RA4M1 of the Arduino Uno R4) to make the defaults below select the
+fully unrolled UMAAL multiply (optimization level 3) and the dedicated UMAAL square routine
+(uECC_SQUARE_FUNC). Defining either option explicitly overrides the profile. Off by default until
+examples/ecc_bench and the test sketches have been run on M4/M7 boards with it. */
+#ifndef uECC_ARM_V7EM
+    #define uECC_ARM_V7EM 0
+#endif
+
 /* Optimization level; trade speed for code size.
    Larger values produce code that is faster but larger.
    Currently supported values are 0 - 4; 0 is unusably slow for most applications.
    Optimization level 4 currently only has an effect ARM platforms where more than one
    curve is enabled. */
 #ifndef uECC_OPTIMIZATION_LEVEL
-    #define uECC_OPTIMIZATION_LEVEL 2
+    #if uECC_ARM_V7EM
+        #define uECC_OPTIMIZATION_LEVEL 3
+    #else
+        #define uECC_OPTIMIZATION_LEVEL 2
+    #endif
 #endif
 
 /* uECC_SQUARE_FUNC - If enabled (defined as nonzero), this will cause a specific function to be
 used for (scalar) squaring instead of the generic multiplication function. This can make things
 faster somewhat faster, but increases the code size. */
 #ifndef uECC_SQUARE_FUNC
-    #define uECC_SQUARE_FUNC 0
+    #define uECC_SQUARE_FUNC uECC_ARM_V7EM
 #endif
 
 /* uECC_VLI_NATIVE_LITTLE_ENDIAN - If enabled (defined as nonzero), this will switch to native
@@ -52,6 +65,37 @@ the same endianness. */
     #define uECC_VLI_NATIVE_LITTLE_ENDIAN 0
 #endif
 
+/* uECC_P256_ONLY - If enabled (defined as nonzero), secp256r1 is the only curve compiled in and
+every big integer has its fixed width: the portable C add, subtract, multiply and square run with
+a constant word count (multiply and square fully unrolled for 32 and 64-bit words, see
+mult-square-unrolled.inc), and field products are reduced by a direct call to the NIST fast
+reduction instead of through the curve structure. On ARM the assembly already unrolls when a
+single curve is enabled. Enabling another curve at the same time is an error. With
+uECC_ENABLE_VLI_API, the uECC_vli_* functions then only accept the secp256r1 word count. */
+#ifndef uECC_P256_ONLY
+    #define uECC_P256_ONLY 0
+#endif
+
+#if uECC_P256_ONLY
+    #if (defined(uECC_SUPPORTS_secp160r1) && uECC_SUPPORTS_secp160r1) || \
+        (defined(uECC_SUPPORTS_secp192r1) && uECC_SUPPORTS_secp192r1) || \
+        (defined(uECC_SUPPORTS_secp224r1) && uECC_SUPPORTS_secp224r1) || \
+        (defined(uECC_SUPPORTS_secp256k1) && uECC_SUPPORTS_secp256k1) || \
+        (defined(uECC_SUPPORTS_secp256r1) && !uECC_SUPPORTS_secp256r1)
+        #error "uECC_P256_ONLY only supports secp256r1"
+    #endif
+    #undef uECC_SUPPORTS_secp160r1
+    #define uECC_SUPPORTS_secp160r1 0
+    #undef uECC_SUPPORTS_secp192r1
+    #define uECC_SUPPORTS_secp192r1 0
+    #undef uECC_SUPPORTS_secp224r1
+    #define uECC_SUPPORTS_secp224r1 0
+    #undef uECC_SUPPORTS_secp256r1
+    #define uECC_SUPPORTS_secp256r1 1
+    #undef uECC_SUPPORTS_secp256k1
+    #define uECC_SUPPORTS_secp256k1 0
+#endif
+
 /* Curve support selection. Set to 0 to remove that curve. */
 #ifndef uECC_SUPPORTS_secp160r1
     #define uECC_SUPPORTS_secp160r1 1
@@ -75,6 +119,50 @@ the same endianness. */
     #define uECC_SUPPORT_COMPRESSED_POINT 1
 #endif
 
+/* uECC_GENERATOR_TABLE - If enabled (defined as nonzero), uECC_make_key(),
+uECC_compute_public_key() and uECC_sign() multiply the secp256r1 generator with a fixed-base comb
+over a precomputed table of 16 points (1 KB of const data, see generator-table.inc) instead of
+the generic Montgomery ladder. This is about 3 times faster, and the table lookup scans every
+entry so it stays constant-time. The table must live in flash, so this is not supported on AVR,
+where const data is copied to RAM. */
+#ifndef uECC_GENERATOR_TABLE
+    #define uECC_GENERATOR_TABLE 0
+#endif
+
+/* uECC_BATCH_SIZE - Number of keys uECC_make_keys_batch() converts to affine coordinates with
+a single modular inversion. Each key of a batch takes two field elements of stack (64 bytes for
+secp256r1); larger requests are processed in batches of this size. */
+#ifndef uECC_BATCH_SIZE
+    #define uECC_BATCH_SIZE 4
+#endif
+
+/* uECC_FERMAT_INVERSE - If enabled (defined as nonzero), secp256r1 field inversions (affine
+conversion after key generation, ECDH and point multiplication, and in uECC_verify()) compute
+x^(p - 2) with a fixed addition chain of 255 squarings and 12 multiplications, instead of the
+binary extended GCD of uECC_vli_modInv() whose running time depends on the input. On 32 and
+64-bit targets the fast squaring and NIST reduction make it as fast or faster; on AVR it is
+several times slower, so it is off there by default. Inversions modulo n are unchanged. */
+#ifndef uECC_FERMAT_INVERSE
+    #if defined(__AVR__)
+        #define uECC_FERMAT_INVERSE 0
+    #else
+        #define uECC_FERMAT_INVERSE 1
+    #endif
+#endif
+
+/* uECC_LOW_STACK - If enabled (defined as nonzero), the large temporaries of key generation,
+ECDH and signature verification (up to 14 big integers for uECC_verify()) are taken from a
+caller-supplied arena set with uECC_set_scratch() instead of the stack, so that they can share
+RAM with other phase-scoped buffers of the application. Functions that run out of scratch space
+fail (return 0) instead of overflowing it. */
+#ifndef uECC_LOW_STACK
+    #define uECC_LOW_STACK 0
+#endif
+
+/* Scratch bytes needed by any uECC_LOW_STACK operation on the supported curves, including room
+to align the arena. */
+#define uECC_SCRATCH_SIZE (14 * 32 + 8)
+
 struct uECC_Curve_t;
 typedef const struct uECC_Curve_t * uECC_Curve;
 
@@ -129,12 +217,40 @@ Inputs:
 */
 void uECC_set_rng(uECC_RNG_Function rng_function);
 
+#if uECC_LOW_STACK
+/* uECC_set_scratch() function.
+Set the arena used for the large temporaries when uECC_LOW_STACK is enabled. Operations take
+their space from the start of the arena and give it back before returning; the content is
+left as is, so wipe the arena once it is no longer lent to uECC.
+
+Inputs:
+    scratch - The arena, or 0 to remove it (operations needing scratch space then fail).
+    size    - Size of the arena in bytes, uECC_SCRATCH_SIZE for any operation.
+*/
+void uECC_set_scratch(void *scratch, unsigned size);
+#endif /* uECC_LOW_STACK */
+
 /* uECC_get_rng() function.
 
 Returns the function that will be used to generate random bytes.
 */
 uECC_RNG_Function uECC_get_rng(void);
 
+/* uECC_Context structure.
+Curve and RNG used by the *_ctx() functions and by the sliced uECC_mult_ctx functions, in place
+of the RNG set with uECC_set_rng(). All other working memory is on the stack, so two tasks each
+using their own context (or sharing a const one with a thread-safe RNG) do not need a lock.
+
+    curve - The curve to use.
+    rng   - The function that will be used to generate random bytes, or 0. Without an RNG,
+            uECC_make_key_ctx() and uECC_sign_ctx() fail and uECC_shared_secret_ctx() runs
+            without the randomized initial Z.
+*/
+typedef struct uECC_Context {
+    uECC_Curve curve;
+    uECC_RNG_Function rng;
+} uECC_Context;
+
 /* uECC_curve_private_key_size() function.
 
 Returns the size of a private key for the curve in bytes.
@@ -165,6 +281,29 @@ Returns 1 if the key pair was generated successfully, 0 if an error occurred.
 */
 int uECC_make_key(uint8_t *public_key, uint8_t *private_key, uECC_Curve curve);
 
+/* uECC_make_key_ctx() function.
+Same as uECC_make_key(), using the curve and RNG of 'context'.
+*/
+int uECC_make_key_ctx(const uECC_Context *context, uint8_t *public_key, uint8_t *private_key);
+
+/* uECC_make_keys_batch() function.
+Create 'count' public/private key pairs, using the curve and RNG of 'context'. The keys are
+computed in Jacobian coordinates and converted to affine with one shared modular inversion per
+uECC_BATCH_SIZE keys (Montgomery's trick), which is cheaper than 'count' uECC_make_key() calls.
+
+Outputs:
+    public_keys  - 'count' public keys, one after the other (uECC_curve_public_key_size() bytes
+                   each).
+    private_keys - 'count' private keys, one after the other (uECC_curve_private_key_size() bytes
+                   each).
+
+Returns 1 if all the key pairs were generated successfully, 0 if an error occurred.
+*/
+int uECC_make_keys_batch(const uECC_Context *context,
+                         unsigned count,
+                         uint8_t *public_keys,
+                         uint8_t *private_keys);
+
 /* uECC_shared_secret() function.
 Compute a shared secret given your secret key and someone else's public key.
 Note: It is recommended that you hash the result of uECC_shared_secret() before using it for
@@ -185,6 +324,82 @@ int uECC_shared_secret(const uint8_t *public_key,
                        uint8_t *secret,
                        uECC_Curve curve);
 
+/* uECC_shared_secret_ctx() function.
+Same as uECC_shared_secret(), using the curve and RNG of 'context'.
+*/
+int uECC_shared_secret_ctx(const uECC_Context *context,
+                           const uint8_t *public_key,
+                           const uint8_t *private_key,
+                           uint8_t *secret);
+
+/* Size in bytes of the ladder state held by uECC_mult_ctx (eight values of up to 32 bytes). */
+#define uECC_MULT_CTX_SIZE 256
+
+/* uECC_mult_ctx structure.
+State of a scalar multiplication run in slices by uECC_mult_step(), so that the caller can do
+other work (polling a reader, refreshing a display) between slices. All ladder steps cost the
+same whatever the key, so slicing does not change the constant-time behaviour; only the slice
+boundaries chosen by the caller are visible.
+
+The members are private. A context holds key material: the _finish() functions wipe it, a
+context that is abandoned before completion should be zeroed by the caller.
+
+Usage:
+    uECC_mult_ctx ctx;
+    if (uECC_shared_secret_start(&ctx, &context, public_key, private_key)) {
+        while (!uECC_mult_step(&ctx, 16)) {
+            ...other work...
+        }
+        ok = uECC_shared_secret_finish(&ctx, secret);
+    }
+*/
+typedef struct uECC_mult_ctx {
+    uECC_Curve curve;
+    uint16_t bit;
+    uint8_t phase;
+    uint8_t x_only;
+    uint64_t state[uECC_MULT_CTX_SIZE / 8];
+} uECC_mult_ctx;
+
+/* uECC_make_key_start() function.
+Generate a private key with the RNG of 'context' and prepare the computation of its public key
+in 'ctx'. 'context' is not referenced after the call.
+Returns 1 if the context is ready for uECC_mult_step(), 0 if the RNG failed.
+*/
+int uECC_make_key_start(uECC_mult_ctx *ctx, const uECC_Context *context);
+
+/* uECC_shared_secret_start() function.
+Prepare the computation of a shared secret in 'ctx'. The inputs are the same as for
+uECC_shared_secret_ctx() and are not referenced after the call.
+Returns 1 if the context is ready for uECC_mult_step(), 0 if the RNG failed.
+*/
+int uECC_shared_secret_start(uECC_mult_ctx *ctx,
+                             const uECC_Context *context,
+                             const uint8_t *public_key,
+                             const uint8_t *private_key);
+
+/* uECC_mult_step() function.
+Process up to 'max_bits' bits of the scalar. The slice that reaches the last bit also performs
+the final modular inversion, so it takes longer than the others.
+
+Returns 0 while bits remain, 1 once the multiplication is complete (or 'ctx' was not started).
+*/
+int uECC_mult_step(uECC_mult_ctx *ctx, unsigned max_bits);
+
+/* uECC_make_key_finish() function.
+Output the key pair of a completed uECC_make_key_start() context, with the same layout as
+uECC_make_key(), and wipe the context.
+Returns 1 if the key pair is valid, 0 if the context was not complete.
+*/
+int uECC_make_key_finish(uECC_mult_ctx *ctx, uint8_t *public_key, uint8_t *private_key);
+
+/* uECC_shared_secret_finish() function.
+Output the secret of a completed uECC_shared_secret_start() context, with the same layout as
+uECC_shared_secret(), and wipe the context.
+Returns 1 if the shared secret is valid, 0 if the context was not complete.
+*/
+int uECC_shared_secret_finish(uECC_mult_ctx *ctx, uint8_t *secret);
+
 #if uECC_SUPPORT_COMPRESSED_POINT
 /* uECC_compress() function.
 Compress a public key.
@@ -261,6 +476,15 @@ int uECC_sign(const uint8_t *private_key,
               uint8_t *signature,
               uECC_Curve curve);
 
+/* uECC_sign_ctx() function.
+Same as uECC_sign(), using the curve and RNG of 'context'.
+*/
+int uECC_sign_ctx(const uECC_Context *context,
+                  const uint8_t *private_key,
+                  const uint8_t *message_hash,
+                  unsigned hash_size,
+                  uint8_t *signature);
+
 /* uECC_HashContext structure.
 This is used to pass in an arbitrary hash function to uECC_sign_deterministic().
 The structure will be used for multiple hash computations; each time a new hash
@@ -308,6 +532,12 @@ typedef struct uECC_HashContext {
     unsigned block_size; /* Hash function block size in bytes, eg 64 for SHA-256. */
     unsigned result_size; /* Hash function result size in bytes, eg 32 for SHA-256. */
     uint8_t *tmp; /* Must point to a buffer of at least (2 * result_size + block_size) bytes. */
+    /* Optional, may be left 0. When set, HMAC computations under the key K (result_size bytes)
+       start with hmac_init() instead of hashing the padded key, and end with hmac_finish(),
+       which writes the HMAC into result (result may be K). This lets the hash keep the inner
+       and outer padded key states while K does not change. Both must be set together. */
+    void (*hmac_init)(const struct uECC_HashContext *context, const uint8_t *K);
+    void (*hmac_finish)(const struct uECC_HashContext *context, const uint8_t *K, uint8_t *result);
 } uECC_HashContext;
 
 /* uECC_sign_deterministic() function.
@@ -358,6 +588,77 @@ int uECC_verify(const uint8_t *public_key,
                 const uint8_t *signature,
                 uECC_Curve curve);
 
+/* uECC_verify_batch() function.
+Verify several ECDSA signatures made with the same key.
+
+The public key is decoded and G + Q is computed once for the whole batch instead
+of once per signature, which saves a modular inversion per signature. Each
+signature is then checked on its own, so the first bad one is reported.
+
+Inputs:
+    public_key     - The signer's public key.
+    count          - The number of signatures.
+    message_hashes - count hashes of hash_size bytes, one after the other.
+    hash_size      - The size of each hash in bytes.
+    signatures     - count signatures, one after the other.
+
+Outputs:
+    bad_index - If not 0, receives the index of the first invalid signature when
+                the function returns 0.
+
+Returns 1 if all the signatures are valid (or count is 0), 0 otherwise.
+*/
+int uECC_verify_batch(const uint8_t *public_key,
+                      unsigned count,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      unsigned *bad_index,
+                      uECC_Curve curve);
+
+/* Size in bytes of the decoded key held by uECC_PublicKey (four values of up to 32 bytes). */
+#define uECC_PUBLIC_KEY_STATE_SIZE 128
+
+/* uECC_PublicKey structure.
+A public key decoded and checked once by uECC_public_key_load(), for a key that is used many
+times (a trusted signer, a peer kept across sessions). It holds the point in native form
+along with G + Q, so each uECC_verify_loaded() skips the decoding and the modular inversion
+that uECC_verify() spends on every call, and uECC_shared_secret_loaded() skips the decoding.
+
+The members are private. The object holds no secret and may be copied.
+*/
+typedef struct uECC_PublicKey {
+    uECC_Curve curve;
+    uint64_t state[uECC_PUBLIC_KEY_STATE_SIZE / 8];
+} uECC_PublicKey;
+
+/* uECC_public_key_load() function.
+Decode and validate a public key (same format as uECC_valid_public_key()) into 'key'.
+
+Returns 1 if the key is valid, 0 otherwise. On failure 'key' is left unusable: the _loaded()
+functions reject it.
+*/
+int uECC_public_key_load(uECC_PublicKey *key, const uint8_t *public_key, uECC_Curve curve);
+
+/* uECC_verify_loaded() function.
+Same as uECC_verify(), with a key prepared by uECC_public_key_load().
+*/
+int uECC_verify_loaded(const uECC_PublicKey *key,
+                       const uint8_t *message_hash,
+                       unsigned hash_size,
+                       const uint8_t *signature);
+
+/* uECC_shared_secret_loaded() function.
+Same as uECC_shared_secret_ctx(), with a key prepared by uECC_public_key_load(). Unlike
+uECC_shared_secret(), the peer point is known to be on the curve.
+
+Returns 0 if the key is not loaded or belongs to another curve than 'context'.
+*/
+int uECC_shared_secret_loaded(const uECC_Context *context,
+                              const uECC_PublicKey *key,
+                              const uint8_t *private_key,
+                              uint8_t *secret);
+
 #ifdef __cplusplus
 } /* end of extern "C" */
 #endif
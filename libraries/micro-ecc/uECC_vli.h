@@ -151,7 +151,8 @@ int uECC_valid_point(const uECC_word_t *point, uECC_Curve curve);
 
 /* Multiplies a point by a scalar. Points are represented by the X coordinate followed by
    the Y coordinate in the same array, both coordinates are curve->num_words long. Note
-   that scalar must be curve->num_n_words long (NOT curve->num_words). */
+   that scalar must be curve->num_n_words long (NOT curve->num_words). With uECC_LOW_STACK,
+   the scratch arena must have room for the ladder (see uECC_set_scratch()). */
 void uECC_point_mult(uECC_word_t *result,
                      const uECC_word_t *point,
                      const uECC_word_t *scalar,